@@ -0,0 +1,402 @@
+/**
+ * @file bench.c
+ * @brief 微基准测试框架：预热、重复采样、中位数/p99统计与CSV/JSON输出
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h>
+#include "bench.h"
+#include "../include/utils.h"
+#include "../include/math_ops.h"
+#include "../include/string_ops.h"
+#include "../include/file_ops.h"
+#include "../include/fingerprint_ops.h"
+#include "../include/number_ops.h"
+#include "../include/csv_ops.h"
+#include "../include/bignum_ops.h"
+#include "../include/matrix_ops.h"
+#include "../include/array_ops.h"
+#include "../include/rope_ops.h"
+#include "../include/pattern_ops.h"
+#include "../include/thread_pool.h"
+#include "../include/allocator.h"
+#include "../include/line_index.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#else
+#define HAVE_RDTSC 0
+#endif
+
+#define MAX_CASES 256
+#define MAX_SAMPLES 1000
+
+typedef struct {
+    long iterations;           /* 每次采样的调用次数 */
+    int samples;
+    double min_ns;
+    double median_ns;
+    double p99_ns;
+    double mean_ns;
+    double stddev_ns;
+    double median_cycles;
+} bench_result;
+
+typedef struct {
+    int warmup;                /* 预热采样次数 */
+    int min_samples;
+    int max_samples;
+    double min_sample_ns;      /* 每次采样的最短时间，不足时增加调用次数 */
+    double case_budget_ns;     /* 单个用例的采样时间预算 */
+    const char* filter;
+    const char* csv_path;
+    const char* json_path;
+    int with_logging;
+} bench_config;
+
+static bench_case cases[MAX_CASES];
+static int case_count = 0;
+static volatile long sink;
+static char temp_dir[64];
+static double tsc_per_ns = 0.0;
+
+void bench_register(const char* group, const char* name, long param,
+                    bench_setup_fn setup, bench_run_fn run, bench_teardown_fn teardown) {
+    if (case_count >= MAX_CASES) {
+        fprintf(stderr, "基准测试用例过多: %s/%s\n", group, name);
+        return;
+    }
+    bench_case* c = &cases[case_count++];
+    c->group = group;
+    c->name = name;
+    c->param = param;
+    c->setup = setup;
+    c->run = run;
+    c->teardown = teardown;
+}
+
+void bench_consume(long value) {
+    sink += value;
+}
+
+const char* bench_temp_path(const char* name) {
+    static char paths[4][128];
+    static int next = 0;
+    char* path = paths[next];
+    next = (next + 1) % 4;
+    snprintf(path, sizeof(paths[0]), "%s/%s", temp_dir, name);
+    return path;
+}
+
+char* bench_make_string(long length, unsigned int seed) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ,.";
+    char* str = (char*)malloc(length + 1);
+    if (str == NULL) {
+        return NULL;
+    }
+    for (long i = 0; i < length; i++) {
+        seed = seed * 1103515245u + 12345u;
+        str[i] = alphabet[(seed >> 16) % (sizeof(alphabet) - 1)];
+    }
+    str[length] = '\0';
+    return str;
+}
+
+static inline double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static inline unsigned long long read_tsc(void) {
+#if HAVE_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/* 用clock_gettime校准TSC频率，用于在报告中同时给出周期数 */
+static void calibrate_tsc(void) {
+    double start_ns = now_ns();
+    unsigned long long start_tsc = read_tsc();
+    while (now_ns() - start_ns < 50e6) {
+    }
+    double elapsed_ns = now_ns() - start_ns;
+    unsigned long long elapsed_tsc = read_tsc() - start_tsc;
+    tsc_per_ns = elapsed_tsc > 0 ? elapsed_tsc / elapsed_ns : 0.0;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* 对已排序的样本取第p百分位（最近秩法） */
+static double percentile(const double* sorted, int n, double p) {
+    int rank = (int)ceil(p / 100.0 * n);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[rank - 1];
+}
+
+static void run_case(const bench_case* c, const bench_config* config, bench_result* result) {
+    void* ctx = c->setup != NULL ? c->setup(c->param) : (void*)c->param;
+    memset(result, 0, sizeof(*result));
+    if (c->setup != NULL && ctx == NULL) {
+        return;
+    }
+
+    // 先调用一次排除首次缺页和缓存冷启动，再找到使单次采样不短于min_sample_ns的调用次数
+    c->run(ctx, 1);
+    long iterations = 1;
+    for (;;) {
+        double start = now_ns();
+        c->run(ctx, iterations);
+        double elapsed = now_ns() - start;
+        if (elapsed >= config->min_sample_ns || iterations >= (1L << 30)) {
+            break;
+        }
+        long scale = elapsed > 0 ? (long)(config->min_sample_ns / elapsed * 1.2) : 16;
+        iterations *= scale < 2 ? 2 : (scale > 16 ? 16 : scale);
+    }
+
+    for (int i = 0; i < config->warmup; i++) {
+        c->run(ctx, iterations);
+    }
+
+    static double ns[MAX_SAMPLES];
+    static double cycles[MAX_SAMPLES];
+    int samples = 0;
+    double total_ns = 0.0;
+    while (samples < config->max_samples &&
+           (samples < config->min_samples || total_ns < config->case_budget_ns)) {
+        unsigned long long tsc_start = read_tsc();
+        double start = now_ns();
+        c->run(ctx, iterations);
+        double elapsed = now_ns() - start;
+        unsigned long long tsc_elapsed = read_tsc() - tsc_start;
+        ns[samples] = elapsed / iterations;
+        cycles[samples] = (double)tsc_elapsed / iterations;
+        total_ns += elapsed;
+        samples++;
+    }
+
+    if (c->teardown != NULL) {
+        c->teardown(ctx);
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < samples; i++) {
+        sum += ns[i];
+    }
+    double mean = sum / samples;
+    double variance = 0.0;
+    for (int i = 0; i < samples; i++) {
+        variance += (ns[i] - mean) * (ns[i] - mean);
+    }
+
+    qsort(ns, samples, sizeof(double), compare_double);
+    qsort(cycles, samples, sizeof(double), compare_double);
+    result->iterations = iterations;
+    result->samples = samples;
+    result->min_ns = ns[0];
+    result->median_ns = percentile(ns, samples, 50.0);
+    result->p99_ns = percentile(ns, samples, 99.0);
+    result->mean_ns = mean;
+    result->stddev_ns = samples > 1 ? sqrt(variance / (samples - 1)) : 0.0;
+    result->median_cycles = HAVE_RDTSC ? percentile(cycles, samples, 50.0) : 0.0;
+}
+
+static int matches_filter(const bench_case* c, const char* filter) {
+    if (filter == NULL) {
+        return 1;
+    }
+    char full_name[128];
+    snprintf(full_name, sizeof(full_name), "%s/%s", c->group, c->name);
+    return strstr(full_name, filter) != NULL;
+}
+
+static void write_csv(const char* path, const bench_result* results) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "无法写入CSV文件: %s\n", path);
+        return;
+    }
+    fprintf(file, "group,function,param,iterations,samples,min_ns,median_ns,p99_ns,mean_ns,stddev_ns,median_cycles\n");
+    for (int i = 0; i < case_count; i++) {
+        const bench_result* r = &results[i];
+        if (r->samples == 0) {
+            continue;
+        }
+        fprintf(file, "%s,%s,%ld,%ld,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.1f\n",
+                cases[i].group, cases[i].name, cases[i].param, r->iterations, r->samples,
+                r->min_ns, r->median_ns, r->p99_ns, r->mean_ns, r->stddev_ns, r->median_cycles);
+    }
+    fclose(file);
+}
+
+static void write_json(const char* path, const bench_result* results, const bench_config* config) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "无法写入JSON文件: %s\n", path);
+        return;
+    }
+    char* timestamp = get_timestamp();
+    fprintf(file, "{\n  \"timestamp\": \"%s\",\n  \"compiler\": \"%s\",\n", timestamp != NULL ? timestamp : "",
+            __VERSION__);
+    fprintf(file, "  \"threads\": %d,\n  \"tsc_ghz\": %.4f,\n  \"logging\": %s,\n",
+            thread_pool_size(NULL), tsc_per_ns, config->with_logging ? "true" : "false");
+    fprintf(file, "  \"results\": [\n");
+    int first = 1;
+    for (int i = 0; i < case_count; i++) {
+        const bench_result* r = &results[i];
+        if (r->samples == 0) {
+            continue;
+        }
+        fprintf(file, "%s    {\"group\": \"%s\", \"function\": \"%s\", \"param\": %ld, \"iterations\": %ld, "
+                      "\"samples\": %d, \"min_ns\": %.2f, \"median_ns\": %.2f, \"p99_ns\": %.2f, "
+                      "\"mean_ns\": %.2f, \"stddev_ns\": %.2f, \"median_cycles\": %.1f}",
+                first ? "" : ",\n", cases[i].group, cases[i].name, cases[i].param, r->iterations,
+                r->samples, r->min_ns, r->median_ns, r->p99_ns, r->mean_ns, r->stddev_ns, r->median_cycles);
+        first = 0;
+    }
+    fprintf(file, "\n  ]\n}\n");
+    fclose(file);
+    mem_free(timestamp);
+}
+
+static void show_usage(void) {
+    printf("用法: bench_runner [选项]\n\n");
+    printf("选项:\n");
+    printf("  --filter TEXT     只运行名称(模块/函数)包含TEXT的用例\n");
+    printf("  --csv FILE        将结果写入CSV文件\n");
+    printf("  --json FILE       将结果写入JSON文件\n");
+    printf("  --warmup N        每个用例的预热采样次数（默认3）\n");
+    printf("  --samples MIN MAX 每个用例的最少/最多采样次数（默认15 200）\n");
+    printf("  --budget MS       每个用例的采样时间预算，毫秒（默认300）\n");
+    printf("  --quick           快速模式，用于冒烟测试\n");
+    printf("  --with-logging    保留调试/错误输出（默认关闭，只测量函数本身）\n");
+    printf("  --list            列出所有用例\n");
+}
+
+int main(int argc, char** argv) {
+    bench_config config = {3, 15, 200, 20e3, 300e6, NULL, NULL, NULL, 0};
+    int list_only = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            config.filter = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            config.csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            config.json_path = argv[++i];
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            config.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 2 < argc) {
+            config.min_samples = atoi(argv[++i]);
+            config.max_samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            config.case_budget_ns = atof(argv[++i]) * 1e6;
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            config.warmup = 1;
+            config.min_samples = 3;
+            config.max_samples = 10;
+            config.case_budget_ns = 10e6;
+        } else if (strcmp(argv[i], "--with-logging") == 0) {
+            config.with_logging = 1;
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list_only = 1;
+        } else {
+            show_usage();
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (config.min_samples < 1) {
+        config.min_samples = 1;
+    }
+    if (config.max_samples > MAX_SAMPLES) {
+        config.max_samples = MAX_SAMPLES;
+    }
+    if (config.max_samples < config.min_samples) {
+        config.max_samples = config.min_samples;
+    }
+
+    set_log_flags(0);
+    if (!initialize_math_ops() || !initialize_string_ops() || !initialize_file_ops() ||
+        !initialize_fingerprint_ops() || !initialize_number_ops() || !initialize_csv_ops() ||
+        !initialize_bignum_ops() || !initialize_matrix_ops() || !initialize_array_ops() ||
+        !initialize_rope_ops() || !initialize_pattern_ops() || !initialize_line_index()) {
+        fprintf(stderr, "初始化失败\n");
+        return 1;
+    }
+
+    register_math_benchmarks();
+    register_string_benchmarks();
+    register_file_benchmarks();
+    register_fingerprint_benchmarks();
+    register_number_benchmarks();
+    register_csv_benchmarks();
+    register_bignum_benchmarks();
+    register_matrix_benchmarks();
+    register_array_benchmarks();
+    register_rope_benchmarks();
+    register_pattern_benchmarks();
+    register_alloc_benchmarks();
+    register_line_index_benchmarks();
+
+    if (list_only) {
+        for (int i = 0; i < case_count; i++) {
+            printf("%s/%s/%ld\n", cases[i].group, cases[i].name, cases[i].param);
+        }
+        return 0;
+    }
+
+    snprintf(temp_dir, sizeof(temp_dir), "/tmp/bench_XXXXXX");
+    if (mkdtemp(temp_dir) == NULL) {
+        fprintf(stderr, "无法创建临时目录\n");
+        return 1;
+    }
+    if (config.with_logging) {
+        set_log_flags(LOG_DEBUG | LOG_ERROR);
+    }
+    calibrate_tsc();
+
+    bench_result* results = (bench_result*)calloc(case_count, sizeof(bench_result));
+    if (results == NULL) {
+        fprintf(stderr, "内存分配失败\n");
+        return 1;
+    }
+
+    printf("%-8s %-24s %10s %10s %7s %12s %12s %12s %12s\n",
+           "group", "function", "param", "iters", "samples", "min(ns)", "median(ns)", "p99(ns)", "cycles");
+    for (int i = 0; i < case_count; i++) {
+        if (!matches_filter(&cases[i], config.filter)) {
+            continue;
+        }
+        run_case(&cases[i], &config, &results[i]);
+        const bench_result* r = &results[i];
+        printf("%-8s %-24s %10ld %10ld %7d %12.1f %12.1f %12.1f %12.0f\n",
+               cases[i].group, cases[i].name, cases[i].param, r->iterations, r->samples,
+               r->min_ns, r->median_ns, r->p99_ns, r->median_cycles);
+        fflush(stdout);
+    }
+
+    if (config.csv_path != NULL) {
+        write_csv(config.csv_path, results);
+    }
+    if (config.json_path != NULL) {
+        write_json(config.json_path, results, &config);
+    }
+
+    free(results);
+    rmdir(temp_dir);
+    thread_pool_shutdown_default();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+/**
+ * @file bench.h
+ * @brief 微基准测试框架接口
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+/**
+ * @brief 准备测试数据
+ * @param param 输入规模参数
+ * @return 传给运行函数的上下文，失败返回NULL
+ */
+typedef void* (*bench_setup_fn)(long param);
+
+/**
+ * @brief 运行被测函数iterations次
+ * @param ctx bench_setup_fn返回的上下文
+ * @param iterations 调用次数
+ */
+typedef void (*bench_run_fn)(void* ctx, long iterations);
+
+/**
+ * @brief 释放测试数据
+ * @param ctx bench_setup_fn返回的上下文
+ */
+typedef void (*bench_teardown_fn)(void* ctx);
+
+/**
+ * @brief 一个基准测试用例：某个函数在某个输入规模下的测量
+ */
+typedef struct {
+    const char* group;           /* 所属模块，如"math" */
+    const char* name;            /* 被测函数名 */
+    long param;                  /* 输入规模参数 */
+    bench_setup_fn setup;        /* 可为NULL，此时上下文为(void*)param */
+    bench_run_fn run;
+    bench_teardown_fn teardown;  /* 可为NULL */
+} bench_case;
+
+/**
+ * @brief 注册一个基准测试用例
+ * @param group 所属模块
+ * @param name 被测函数名
+ * @param param 输入规模参数
+ * @param setup 准备函数，可为NULL
+ * @param run 运行函数
+ * @param teardown 释放函数，可为NULL
+ */
+void bench_register(const char* group, const char* name, long param,
+                    bench_setup_fn setup, bench_run_fn run, bench_teardown_fn teardown);
+
+/**
+ * @brief 防止编译器把被测函数的结果优化掉
+ * @param value 任意结果值
+ */
+void bench_consume(long value);
+
+/**
+ * @brief 返回本次运行使用的临时目录中的文件路径
+ * @param name 文件名
+ * @return 完整路径（静态缓冲区轮换使用，可同时持有4个）
+ */
+const char* bench_temp_path(const char* name);
+
+/**
+ * @brief 生成测试用的可打印字符串
+ * @param length 字符串长度
+ * @param seed 随机种子
+ * @return 新分配的字符串，调用者负责释放内存
+ */
+char* bench_make_string(long length, unsigned int seed);
+
+/**
+ * @brief 注册math_ops.h中所有函数的测试用例
+ */
+void register_math_benchmarks();
+
+/**
+ * @brief 注册string_ops.h中所有函数的测试用例
+ */
+void register_string_benchmarks();
+
+/**
+ * @brief 注册file_ops.h中所有函数的测试用例
+ */
+void register_file_benchmarks();
+
+/**
+ * @brief 注册fingerprint_ops.h中函数的测试用例
+ */
+void register_fingerprint_benchmarks();
+
+/**
+ * @brief 注册number_ops.h中函数的测试用例
+ */
+void register_number_benchmarks();
+
+/**
+ * @brief 注册csv_ops.h中函数的测试用例
+ */
+void register_csv_benchmarks();
+
+/**
+ * @brief 注册bignum_ops.h中函数的测试用例
+ */
+void register_bignum_benchmarks();
+
+/**
+ * @brief 注册matrix_ops.h中函数的测试用例
+ */
+void register_matrix_benchmarks();
+
+/**
+ * @brief 注册array_ops.h中函数的测试用例
+ */
+void register_array_benchmarks();
+
+/**
+ * @brief 注册rope_ops.h中函数的测试用例
+ */
+void register_rope_benchmarks();
+
+/**
+ * @brief 注册pattern_ops.h中函数的测试用例
+ */
+void register_pattern_benchmarks();
+
+/**
+ * @brief 注册allocator.h中函数的测试用例
+ */
+void register_alloc_benchmarks();
+
+/**
+ * @brief 注册line_index.h中函数的测试用例
+ */
+void register_line_index_benchmarks();
+
+#endif /* BENCH_H */
\ No newline at end of file
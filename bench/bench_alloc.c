@@ -0,0 +1,166 @@
+/**
+ * @file bench_alloc.c
+ * @brief allocator.h中函数的基准测试用例
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../include/allocator.h"
+#include "../include/string_ops.h"
+
+/* 短字符串用例的字符串长度 */
+#define SHORT_STRING 24
+
+typedef struct {
+    size_t* sizes;       /* 第i次分配的大小，16~400字节，偏向小块 */
+    void** blocks;       /* 持有的块，轮流释放后重新分配 */
+    long count;
+    char* text;          /* string_duplicate用例的源字符串 */
+    int plain;           /* blocks由malloc分配 */
+} alloc_ctx;
+
+static void teardown_alloc(void* ctx) {
+    alloc_ctx* ac = (alloc_ctx*)ctx;
+    for (long i = 0; i < ac->count; i++) {
+        if (ac->plain) {
+            free(ac->blocks[i]);
+        } else {
+            mem_free(ac->blocks[i]);
+        }
+    }
+    free(ac->blocks);
+    free(ac->sizes);
+    free(ac->text);
+    free(ac);
+    mem_set_mode(MEM_MODE_POOL);
+}
+
+/* 参数为同时持有的块数 */
+static alloc_ctx* setup_blocks(long n, mem_mode mode) {
+    alloc_ctx* ctx = (alloc_ctx*)calloc(1, sizeof(alloc_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->sizes = (size_t*)malloc((size_t)n * sizeof(size_t));
+    ctx->blocks = (void**)calloc((size_t)n, sizeof(void*));
+    if (ctx->sizes == NULL || ctx->blocks == NULL) {
+        teardown_alloc(ctx);
+        return NULL;
+    }
+    unsigned int seed = 13579u;
+    for (long i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned int r = (seed >> 16) & 0xff;
+        ctx->sizes[i] = 16 + (size_t)(r * r) / 170;
+    }
+    ctx->count = n;
+    mem_set_mode(mode);
+    return ctx;
+}
+
+static void* setup_pool_blocks(long n) {
+    return setup_blocks(n, MEM_MODE_POOL);
+}
+
+static void* setup_system_blocks(long n) {
+    return setup_blocks(n, MEM_MODE_SYSTEM);
+}
+
+static void* setup_malloc_blocks(long n) {
+    alloc_ctx* ctx = setup_blocks(n, MEM_MODE_POOL);
+    if (ctx != NULL) {
+        ctx->plain = 1;
+    }
+    return ctx;
+}
+
+/* 每个槽释放后重新分配，并写入首尾字节 */
+static void run_mem_churn(void* ctx, long iterations) {
+    alloc_ctx* ac = (alloc_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (long j = 0; j < ac->count; j++) {
+            mem_free(ac->blocks[j]);
+            char* p = (char*)mem_alloc(ac->sizes[j]);
+            if (p != NULL) {
+                p[0] = (char)j;
+                p[ac->sizes[j] - 1] = (char)i;
+                total += p[0];
+            }
+            ac->blocks[j] = p;
+        }
+    }
+    bench_consume(total);
+}
+
+/* 对照：直接调用malloc/free */
+static void run_malloc_churn(void* ctx, long iterations) {
+    alloc_ctx* ac = (alloc_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (long j = 0; j < ac->count; j++) {
+            free(ac->blocks[j]);
+            char* p = (char*)malloc(ac->sizes[j]);
+            if (p != NULL) {
+                p[0] = (char)j;
+                p[ac->sizes[j] - 1] = (char)i;
+                total += p[0];
+            }
+            ac->blocks[j] = p;
+        }
+    }
+    bench_consume(total);
+}
+
+/* 参数为每次采样复制的字符串数 */
+static alloc_ctx* setup_strings(long n, mem_mode mode) {
+    alloc_ctx* ctx = setup_blocks(n, mode);
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->text = bench_make_string(SHORT_STRING, 8642u);
+    if (ctx->text == NULL) {
+        teardown_alloc(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static void* setup_pool_strings(long n) {
+    return setup_strings(n, MEM_MODE_POOL);
+}
+
+static void* setup_system_strings(long n) {
+    return setup_strings(n, MEM_MODE_SYSTEM);
+}
+
+/* 复制一批短字符串后全部释放，模拟逐条处理命令时的结果字符串 */
+static void run_string_duplicate(void* ctx, long iterations) {
+    alloc_ctx* ac = (alloc_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (long j = 0; j < ac->count; j++) {
+            ac->blocks[j] = string_duplicate(ac->text);
+        }
+        for (long j = 0; j < ac->count; j++) {
+            total += ac->blocks[j] != NULL;
+            mem_free(ac->blocks[j]);
+            ac->blocks[j] = NULL;
+        }
+    }
+    bench_consume(total);
+}
+
+void register_alloc_benchmarks() {
+    static const long blocks[] = {64, 10000};
+    for (size_t i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++) {
+        bench_register("alloc", "mem_churn_pool", blocks[i], setup_pool_blocks, run_mem_churn, teardown_alloc);
+        bench_register("alloc", "mem_churn_system", blocks[i], setup_system_blocks, run_mem_churn, teardown_alloc);
+        bench_register("alloc", "malloc_churn", blocks[i], setup_malloc_blocks, run_malloc_churn, teardown_alloc);
+    }
+    bench_register("alloc", "string_duplicate_pool", 1000, setup_pool_strings, run_string_duplicate,
+                   teardown_alloc);
+    bench_register("alloc", "string_duplicate_system", 1000, setup_system_strings, run_string_duplicate,
+                   teardown_alloc);
+}
\ No newline at end of file
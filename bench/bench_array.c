@@ -0,0 +1,245 @@
+/**
+ * @file bench_array.c
+ * @brief array_ops.h中函数的基准测试用例，参数为元素个数；排序与选择每次迭代都先复制原始数组，
+ *        对照组同样计入复制的开销
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../include/array_ops.h"
+
+/* lower_bound每次迭代查找的键数 */
+#define LOOKUPS 1024
+
+typedef struct {
+    size_t count;
+    int64_t* source;
+    int64_t* work;
+    double* source_double;
+    double* work_double;
+    int32_t* source_int32;
+    int32_t* work_int32;
+    int64_t keys[LOOKUPS];
+} array_ctx;
+
+static uint64_t next_random(uint64_t* state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state ^ *state >> 29;
+}
+
+static void teardown_array(void* ctx) {
+    array_ctx* ac = (array_ctx*)ctx;
+    free(ac->source);
+    free(ac->work);
+    free(ac->source_double);
+    free(ac->work_double);
+    free(ac->source_int32);
+    free(ac->work_int32);
+    free(ac);
+}
+
+static void* setup_array(long n) {
+    array_ctx* ctx = (array_ctx*)calloc(1, sizeof(array_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->count = (size_t)n;
+    ctx->source = (int64_t*)malloc(ctx->count * sizeof(int64_t));
+    ctx->work = (int64_t*)malloc(ctx->count * sizeof(int64_t));
+    ctx->source_double = (double*)malloc(ctx->count * sizeof(double));
+    ctx->work_double = (double*)malloc(ctx->count * sizeof(double));
+    ctx->source_int32 = (int32_t*)malloc(ctx->count * sizeof(int32_t));
+    ctx->work_int32 = (int32_t*)malloc(ctx->count * sizeof(int32_t));
+    if (ctx->source == NULL || ctx->work == NULL || ctx->source_double == NULL || ctx->work_double == NULL ||
+        ctx->source_int32 == NULL || ctx->work_int32 == NULL) {
+        teardown_array(ctx);
+        return NULL;
+    }
+    uint64_t state = 12345;
+    for (size_t i = 0; i < ctx->count; i++) {
+        uint64_t value = next_random(&state);
+        ctx->source[i] = (int64_t)value;
+        ctx->source_int32[i] = (int32_t)(value >> 32);
+        ctx->source_double[i] = (double)(int64_t)value / 1e6;
+    }
+    for (size_t i = 0; i < LOOKUPS; i++) {
+        ctx->keys[i] = (int64_t)next_random(&state);
+    }
+    return ctx;
+}
+
+/* lower_bound的用例需要有序数组 */
+static void* setup_sorted(long n) {
+    array_ctx* ctx = (array_ctx*)setup_array(n);
+    if (ctx != NULL) {
+        array_sort_int64(ctx->source, ctx->count);
+    }
+    return ctx;
+}
+
+static int compare_int64(const void* a, const void* b) {
+    int64_t x = *(const int64_t*)a;
+    int64_t y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_int32(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a;
+    int32_t y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void run_sort_int64(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        memcpy(ac->work, ac->source, ac->count * sizeof(int64_t));
+        array_sort_int64(ac->work, ac->count);
+        total += (long)ac->work[0];
+    }
+    bench_consume(total);
+}
+
+static void run_sort_int32(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        memcpy(ac->work_int32, ac->source_int32, ac->count * sizeof(int32_t));
+        array_sort_int32(ac->work_int32, ac->count);
+        total += ac->work_int32[0];
+    }
+    bench_consume(total);
+}
+
+static void run_sort_double(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        memcpy(ac->work_double, ac->source_double, ac->count * sizeof(double));
+        array_sort_double(ac->work_double, ac->count);
+        total += (long)ac->work_double[0];
+    }
+    bench_consume(total);
+}
+
+/* 对照：标准库qsort */
+static void run_qsort_int64(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        memcpy(ac->work, ac->source, ac->count * sizeof(int64_t));
+        qsort(ac->work, ac->count, sizeof(int64_t), compare_int64);
+        total += (long)ac->work[0];
+    }
+    bench_consume(total);
+}
+
+static void run_qsort_int32(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        memcpy(ac->work_int32, ac->source_int32, ac->count * sizeof(int32_t));
+        qsort(ac->work_int32, ac->count, sizeof(int32_t), compare_int32);
+        total += ac->work_int32[0];
+    }
+    bench_consume(total);
+}
+
+static void run_qsort_double(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        memcpy(ac->work_double, ac->source_double, ac->count * sizeof(double));
+        qsort(ac->work_double, ac->count, sizeof(double), compare_double);
+        total += (long)ac->work_double[0];
+    }
+    bench_consume(total);
+}
+
+static const double tail_percentiles[] = {50.0, 99.0};
+
+static void run_percentiles(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        int64_t results[2];
+        memcpy(ac->work, ac->source, ac->count * sizeof(int64_t));
+        array_percentiles_int64(ac->work, ac->count, tail_percentiles, 2, results);
+        total += (long)(results[0] ^ results[1]);
+    }
+    bench_consume(total);
+}
+
+/* 对照：整体排序后按秩取值 */
+static void run_percentiles_by_sort(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        memcpy(ac->work, ac->source, ac->count * sizeof(int64_t));
+        qsort(ac->work, ac->count, sizeof(int64_t), compare_int64);
+        total += (long)(ac->work[(ac->count + 1) / 2 - 1] ^ ac->work[(ac->count * 99 + 99) / 100 - 1]);
+    }
+    bench_consume(total);
+}
+
+static void run_lower_bound(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < LOOKUPS; j++) {
+            total += (long)array_lower_bound_int64(ac->source, ac->count, ac->keys[j]);
+        }
+    }
+    bench_consume(total);
+}
+
+/* 对照：有分支的二分查找 */
+static void run_binary_search(void* ctx, long iterations) {
+    array_ctx* ac = (array_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < LOOKUPS; j++) {
+            size_t low = 0;
+            size_t high = ac->count;
+            while (low < high) {
+                size_t mid = low + (high - low) / 2;
+                if (ac->source[mid] < ac->keys[j]) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            total += (long)low;
+        }
+    }
+    bench_consume(total);
+}
+
+void register_array_benchmarks() {
+    // 10^4个元素在缓存内排序，10^6个元素走分块并行的MSD分桶路径
+    static const long sizes[] = {10000, 1000000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_register("array", "array_sort_int32", sizes[i], setup_array, run_sort_int32, teardown_array);
+        bench_register("array", "qsort_int32", sizes[i], setup_array, run_qsort_int32, teardown_array);
+        bench_register("array", "array_sort_int64", sizes[i], setup_array, run_sort_int64, teardown_array);
+        bench_register("array", "qsort_int64", sizes[i], setup_array, run_qsort_int64, teardown_array);
+        bench_register("array", "array_sort_double", sizes[i], setup_array, run_sort_double, teardown_array);
+        bench_register("array", "qsort_double", sizes[i], setup_array, run_qsort_double, teardown_array);
+    }
+    bench_register("array", "array_percentiles_int64", 1000000, setup_array, run_percentiles, teardown_array);
+    bench_register("array", "qsort_percentiles_int64", 1000000, setup_array, run_percentiles_by_sort, teardown_array);
+    // 10^3个元素在L1内，10^7个元素远超过L2
+    static const long search_sizes[] = {1000, 100000, 10000000};
+    for (size_t i = 0; i < sizeof(search_sizes) / sizeof(search_sizes[0]); i++) {
+        bench_register("array", "array_lower_bound_int64", search_sizes[i], setup_sorted, run_lower_bound,
+                       teardown_array);
+        bench_register("array", "binary_search_int64", search_sizes[i], setup_sorted, run_binary_search,
+                       teardown_array);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+/**
+ * @file bench_bignum.c
+ * @brief bignum_ops.h中函数的基准测试用例，参数为十进制位数
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../include/bignum_ops.h"
+#include "../include/allocator.h"
+
+typedef struct {
+    bignum a;
+    bignum b;
+    bignum result;
+    char* text;          /* a的十进制文本 */
+    size_t len;
+} bignum_ctx;
+
+static void teardown_bignum(void* ctx) {
+    bignum_ctx* bc = (bignum_ctx*)ctx;
+    bignum_free(&bc->a);
+    bignum_free(&bc->b);
+    bignum_free(&bc->result);
+    free(bc->text);
+    free(bc);
+}
+
+/* 以伪随机数字构造digits位的十进制文本 */
+static char* random_digits(long digits, unsigned int seed) {
+    char* text = (char*)malloc((size_t)digits + 1);
+    if (text == NULL) {
+        return NULL;
+    }
+    for (long i = 0; i < digits; i++) {
+        seed = seed * 1103515245u + 12345u;
+        text[i] = (char)('0' + (seed >> 16) % 10);
+    }
+    text[0] = text[0] == '0' ? '1' : text[0];
+    text[digits] = '\0';
+    return text;
+}
+
+static void* setup_bignum(long digits) {
+    bignum_ctx* ctx = (bignum_ctx*)calloc(1, sizeof(bignum_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    bignum_init(&ctx->a);
+    bignum_init(&ctx->b);
+    bignum_init(&ctx->result);
+    ctx->text = random_digits(digits, 12345u);
+    char* other = random_digits(digits / 2 > 0 ? digits / 2 : 1, 54321u);
+    ctx->len = (size_t)digits;
+    int ok = ctx->text != NULL && other != NULL &&
+             bignum_from_string(&ctx->a, ctx->text, ctx->len) == ERR_OK &&
+             bignum_from_string(&ctx->b, other, (size_t)(digits / 2 > 0 ? digits / 2 : 1)) == ERR_OK;
+    free(other);
+    if (!ok) {
+        teardown_bignum(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static void run_square(void* ctx, long iterations) {
+    bignum_ctx* bc = (bignum_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        bignum_mul(&bc->result, &bc->a, &bc->a);
+        total += (long)bc->result.size;
+    }
+    bench_consume(total);
+}
+
+static void run_divmod(void* ctx, long iterations) {
+    bignum_ctx* bc = (bignum_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        bignum_divmod(&bc->result, NULL, &bc->a, &bc->b);
+        total += (long)bc->result.size;
+    }
+    bench_consume(total);
+}
+
+static void run_to_string(void* ctx, long iterations) {
+    bignum_ctx* bc = (bignum_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        char* text = NULL;
+        size_t len = 0;
+        bignum_to_string(&bc->a, &text, &len);
+        total += (long)len;
+        mem_free(text);
+    }
+    bench_consume(total);
+}
+
+static void run_from_string(void* ctx, long iterations) {
+    bignum_ctx* bc = (bignum_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        bignum_from_string(&bc->result, bc->text, bc->len);
+        total += (long)bc->result.size;
+    }
+    bench_consume(total);
+}
+
+/* 阶乘的参数为n而不是位数，记在len中 */
+static void* setup_factorial(long n) {
+    bignum_ctx* ctx = (bignum_ctx*)setup_bignum(1);
+    if (ctx != NULL) {
+        ctx->len = (size_t)n;
+    }
+    return ctx;
+}
+
+static void run_factorial(void* ctx, long iterations) {
+    bignum_ctx* bc = (bignum_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        bignum_factorial(&bc->result, (uint32_t)bc->len);
+        total += (long)bc->result.size;
+    }
+    bench_consume(total);
+}
+
+void register_bignum_benchmarks() {
+    // 1000位为Karatsuba，10^5位以上为数论变换与牛顿迭代除法
+    static const long sizes[] = {1000, 100000, 1000000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_register("bignum", "bignum_mul_square", sizes[i], setup_bignum, run_square, teardown_bignum);
+        bench_register("bignum", "bignum_divmod", sizes[i], setup_bignum, run_divmod, teardown_bignum);
+        bench_register("bignum", "bignum_to_string", sizes[i], setup_bignum, run_to_string, teardown_bignum);
+        bench_register("bignum", "bignum_from_string", sizes[i], setup_bignum, run_from_string, teardown_bignum);
+    }
+    bench_register("bignum", "bignum_factorial", 100000, setup_factorial, run_factorial, teardown_bignum);
+}
\ No newline at end of file
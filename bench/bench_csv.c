@@ -0,0 +1,111 @@
+/**
+ * @file bench_csv.c
+ * @brief csv_ops.h中函数的基准测试用例，并以string_split逐行、逐字段拆分后atoll/atof作为对照
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../include/csv_ops.h"
+#include "../include/string_ops.h"
+#include "../include/allocator.h"
+
+typedef struct {
+    char* text;          /* 整数、浮点数、短字符串和带引号的字符串四列 */
+    size_t len;
+    csv_table* table;    /* 列统计用例预先解析的表 */
+} csv_ctx;
+
+static void teardown_csv(void* ctx) {
+    csv_ctx* cc = (csv_ctx*)ctx;
+    free(cc->text);
+    csv_free_table(cc->table);
+    free(cc);
+}
+
+static void* setup_csv(long rows) {
+    csv_ctx* ctx = (csv_ctx*)calloc(1, sizeof(csv_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->text = (char*)malloc((size_t)rows * 64 + 64);
+    if (ctx->text == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    size_t pos = (size_t)sprintf(ctx->text, "id,price,city,note\n");
+    static const char* const cities[] = {"Beijing", "Shanghai", "Shenzhen", "Hangzhou"};
+    unsigned int seed = 12345u;
+    for (long i = 0; i < rows; i++) {
+        seed = seed * 1103515245u + 12345u;
+        pos += (size_t)sprintf(ctx->text + pos, "%ld,%u.%02u,%s,\"item %u, lot %u\"\n", i, seed % 100000,
+                               (seed >> 8) % 100, cities[(seed >> 16) % 4], seed % 977, (seed >> 4) % 31);
+    }
+    ctx->len = pos;
+    csv_options options = csv_default_options();
+    if (csv_parse_buffer(ctx->text, ctx->len, &options, &ctx->table) != ERR_OK) {
+        teardown_csv(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static void run_csv_parse(void* ctx, long iterations) {
+    csv_ctx* cc = (csv_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        csv_table* table = NULL;
+        csv_parse_buffer(cc->text, cc->len, NULL, &table);
+        total += table != NULL ? (long)table->row_count : 0;
+        csv_free_table(table);
+    }
+    bench_consume(total);
+}
+
+/* 对照：string_split按行拆分，再按逗号拆分每行并转换数值（带引号的逗号会被拆开，只用于比较耗时） */
+static void run_split_lines(void* ctx, long iterations) {
+    csv_ctx* cc = (csv_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        int line_count = 0;
+        char** lines = string_split(cc->text, "\n", &line_count);
+        for (int l = 1; l < line_count; l++) {
+            int field_count = 0;
+            char** fields = string_split(lines[l], ",", &field_count);
+            if (field_count >= 2) {
+                total += atoll(fields[0]) + (long)atof(fields[1]);
+            }
+            for (int f = 0; f < field_count; f++) {
+                mem_free(fields[f]);
+            }
+            mem_free(fields);
+            mem_free(lines[l]);
+        }
+        if (line_count > 0) {
+            mem_free(lines[0]);
+        }
+        mem_free(lines);
+    }
+    bench_consume(total);
+}
+
+static void run_column_stats(void* ctx, long iterations) {
+    csv_ctx* cc = (csv_ctx*)ctx;
+    csv_stats stats;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        csv_column_stats(cc->table, 1, &stats);
+        total += (long)stats.count;
+    }
+    bench_consume(total);
+}
+
+void register_csv_benchmarks() {
+    // 200000行约8MB，分段并行解析
+    static const long sizes[] = {1000, 200000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_register("csv", "csv_parse_buffer", sizes[i], setup_csv, run_csv_parse, teardown_csv);
+        bench_register("csv", "string_split_lines", sizes[i], setup_csv, run_split_lines, teardown_csv);
+        bench_register("csv", "csv_column_stats", sizes[i], setup_csv, run_column_stats, teardown_csv);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+/**
+ * @file bench_file.c
+ * @brief file_ops.h中函数的基准测试用例
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../include/file_ops.h"
+#include "../include/allocator.h"
+
+typedef struct {
+    char* content;
+    long size;
+    char source[128];
+    char destination[128];
+} file_ctx;
+
+/* 准备指定大小的源文件 */
+static void* setup_file(long size) {
+    file_ctx* ctx = (file_ctx*)malloc(sizeof(file_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->size = size;
+    ctx->content = bench_make_string(size, (unsigned int)size);
+    snprintf(ctx->source, sizeof(ctx->source), "%s", bench_temp_path("source.txt"));
+    snprintf(ctx->destination, sizeof(ctx->destination), "%s", bench_temp_path("destination.txt"));
+    if (ctx->content == NULL || !write_file(ctx->source, ctx->content)) {
+        free(ctx->content);
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static void teardown_file(void* ctx) {
+    file_ctx* fc = (file_ctx*)ctx;
+    unlink(fc->source);
+    unlink(fc->destination);
+    free(fc->content);
+    free(fc);
+}
+
+static void run_read_file(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        char* content = read_file(fc->source);
+        total += content != NULL ? content[0] : 0;
+        mem_free(content);
+    }
+    bench_consume(total);
+}
+
+static void run_write_file(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        total += write_file(fc->destination, fc->content);
+    }
+    bench_consume(total);
+}
+
+static void run_append_file(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    // 每次采样从空文件开始，避免文件无限增长
+    unlink(fc->destination);
+    for (long i = 0; i < iterations; i++) {
+        total += append_file(fc->destination, fc->content);
+    }
+    bench_consume(total);
+}
+
+static void run_file_exists(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        total += file_exists(fc->source);
+    }
+    bench_consume(total);
+}
+
+static void run_get_file_size(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        total += get_file_size(fc->source);
+    }
+    bench_consume(total);
+}
+
+static void run_copy_file(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        total += copy_file(fc->source, fc->destination);
+    }
+    bench_consume(total);
+}
+
+static void run_move_file(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    // 在两个文件名之间来回移动，结束时回到原位置
+    for (long i = 0; i < iterations; i++) {
+        total += move_file(fc->source, fc->destination);
+        total += move_file(fc->destination, fc->source);
+    }
+    bench_consume(total);
+}
+
+static void run_delete_file(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    // 包含创建空文件的开销，无法在不调用被测函数的情况下单独扣除
+    for (long i = 0; i < iterations; i++) {
+        int fd = open(fc->destination, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            close(fd);
+        }
+        total += delete_file(fc->destination);
+    }
+    bench_consume(total);
+}
+
+static void run_read_file_missing(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    // 探测不存在的文件，测量错误路径本身的开销
+    unlink(fc->destination);
+    for (long i = 0; i < iterations; i++) {
+        char* content = NULL;
+        total += read_file_checked(fc->destination, &content);
+    }
+    bench_consume(total);
+}
+
+static void run_get_file_size_missing(void* ctx, long iterations) {
+    file_ctx* fc = (file_ctx*)ctx;
+    long total = 0;
+    unlink(fc->destination);
+    for (long i = 0; i < iterations; i++) {
+        long size = 0;
+        total += get_file_size_checked(fc->destination, &size);
+    }
+    bench_consume(total);
+}
+
+static void run_initialize(void* ctx, long iterations) {
+    (void)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += initialize_file_ops();
+    }
+    bench_consume(sum);
+}
+
+void register_file_benchmarks() {
+    static const long sizes[] = {1024, 65536, 1048576};
+    static const struct {
+        const char* name;
+        bench_run_fn run;
+    } functions[] = {
+        {"read_file", run_read_file},
+        {"write_file", run_write_file},
+        {"append_file", run_append_file},
+        {"copy_file", run_copy_file},
+    };
+    for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++) {
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            bench_register("file", functions[f].name, sizes[i], setup_file, functions[f].run, teardown_file);
+        }
+    }
+
+    // 与文件大小无关的函数只测一种规模；move_file每次迭代移动两次
+    bench_register("file", "file_exists", 1024, setup_file, run_file_exists, teardown_file);
+    bench_register("file", "get_file_size", 1024, setup_file, run_get_file_size, teardown_file);
+    bench_register("file", "move_file", 1024, setup_file, run_move_file, teardown_file);
+    bench_register("file", "delete_file", 0, setup_file, run_delete_file, teardown_file);
+    bench_register("file", "read_file_missing", 0, setup_file, run_read_file_missing, teardown_file);
+    bench_register("file", "get_file_size_missing", 0, setup_file, run_get_file_size_missing, teardown_file);
+    bench_register("file", "initialize_file_ops", 0, NULL, run_initialize, NULL);
+}
\ No newline at end of file
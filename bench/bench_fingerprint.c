@@ -0,0 +1,136 @@
+/**
+ * @file bench_fingerprint.c
+ * @brief fingerprint_ops.h中函数的基准测试用例
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../include/fingerprint_ops.h"
+#include "../include/allocator.h"
+
+typedef struct {
+    char* str;
+    char* edited;   /* str每隔97个字符替换一个字符，用于编辑距离与Hamming距离 */
+    long length;
+} fingerprint_ctx;
+
+static void* setup_fingerprint(long length) {
+    fingerprint_ctx* ctx = (fingerprint_ctx*)malloc(sizeof(fingerprint_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->str = bench_make_string(length, 12345u);
+    ctx->edited = ctx->str != NULL ? strdup(ctx->str) : NULL;
+    if (ctx->str == NULL || ctx->edited == NULL) {
+        free(ctx->str);
+        free(ctx->edited);
+        free(ctx);
+        return NULL;
+    }
+    for (long i = 0; i < length; i += 97) {
+        ctx->edited[i] = ctx->edited[i] == 'x' ? 'y' : 'x';
+    }
+    ctx->length = length;
+    return ctx;
+}
+
+static void teardown_fingerprint(void* ctx) {
+    fingerprint_ctx* fc = (fingerprint_ctx*)ctx;
+    free(fc->str);
+    free(fc->edited);
+    free(fc);
+}
+
+static void run_levenshtein(void* ctx, long iterations) {
+    fingerprint_ctx* fc = (fingerprint_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        total += levenshtein_distance(fc->str, (size_t)fc->length, fc->edited, (size_t)fc->length);
+    }
+    bench_consume(total);
+}
+
+static void run_levenshtein_bounded(void* ctx, long iterations) {
+    fingerprint_ctx* fc = (fingerprint_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        // 上限取实际距离，带状算法要算完整个带
+        total += levenshtein_bounded(fc->str, (size_t)fc->length, fc->edited, (size_t)fc->length,
+                                     fc->length / 97 + 1);
+    }
+    bench_consume(total);
+}
+
+static void run_hamming(void* ctx, long iterations) {
+    fingerprint_ctx* fc = (fingerprint_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        total += (long)hamming_distance(fc->str, fc->edited, (size_t)fc->length);
+    }
+    bench_consume(total);
+}
+
+static void run_cdc_chunk(void* ctx, long iterations) {
+    fingerprint_ctx* fc = (fingerprint_ctx*)ctx;
+    cdc_params params = {2048, 8192, 65536};
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        size_t* sizes = NULL;
+        size_t count = 0;
+        cdc_chunk(fc->str, (size_t)fc->length, &params, &sizes, &count);
+        total += (long)count;
+        mem_free(sizes);
+    }
+    bench_consume(total);
+}
+
+static void run_minhash(void* ctx, long iterations) {
+    fingerprint_ctx* fc = (fingerprint_ctx*)ctx;
+    uint64_t signature[128];
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        minhash_signature(fc->str, (size_t)fc->length, 5, 128, signature);
+        total += (long)(signature[0] & 1);
+    }
+    bench_consume(total);
+}
+
+static void run_rabin_karp(void* ctx, long iterations) {
+    fingerprint_ctx* fc = (fingerprint_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        size_t* positions = NULL;
+        size_t count = 0;
+        rabin_karp_find_all(fc->str, (size_t)fc->length, "#@!", 3, &positions, &count);
+        total += (long)count;
+        mem_free(positions);
+    }
+    bench_consume(total);
+}
+
+void register_fingerprint_benchmarks() {
+    static const long distance_sizes[] = {64, 1024, 16384};
+    for (size_t i = 0; i < sizeof(distance_sizes) / sizeof(distance_sizes[0]); i++) {
+        bench_register("fingerprint", "levenshtein_distance", distance_sizes[i], setup_fingerprint,
+                       run_levenshtein, teardown_fingerprint);
+        bench_register("fingerprint", "levenshtein_bounded", distance_sizes[i], setup_fingerprint,
+                       run_levenshtein_bounded, teardown_fingerprint);
+    }
+
+    static const long sizes[] = {4096, 1048576};
+    static const struct {
+        const char* name;
+        bench_run_fn run;
+    } functions[] = {
+        {"hamming_distance", run_hamming},
+        {"cdc_chunk", run_cdc_chunk},
+        {"minhash_signature", run_minhash},
+        {"rabin_karp_find_all", run_rabin_karp},
+    };
+    for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++) {
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            bench_register("fingerprint", functions[f].name, sizes[i], setup_fingerprint, functions[f].run,
+                           teardown_fingerprint);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+/**
+ * @file bench_line_index.c
+ * @brief line_index.h中函数的基准测试用例，与读取整个文件后逐行查找对照
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../include/line_index.h"
+#include "../include/file_ops.h"
+#include "../include/allocator.h"
+
+/* 每次采样随机读取的行数 */
+#define RANDOM_READS 64
+
+typedef struct {
+    char path[128];
+    char sidecar[160];
+    long lines;
+    line_index* index;
+    unsigned int seed;
+} line_ctx;
+
+static void teardown_lines(void* ctx) {
+    line_ctx* lc = (line_ctx*)ctx;
+    line_index_close(lc->index);
+    unlink(lc->path);
+    unlink(lc->sidecar);
+    free(lc);
+}
+
+/* 参数为行数；行长为8~120字节，并建立索引文件 */
+static void* setup_lines(long lines) {
+    line_ctx* ctx = (line_ctx*)calloc(1, sizeof(line_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->lines = lines;
+    ctx->seed = 24680u;
+    snprintf(ctx->path, sizeof(ctx->path), "%s", bench_temp_path("lines.txt"));
+    snprintf(ctx->sidecar, sizeof(ctx->sidecar), "%s%s", ctx->path, LINE_INDEX_SUFFIX);
+    FILE* fp = fopen(ctx->path, "w");
+    if (fp == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    char* text = bench_make_string(120, 97531u);
+    unsigned int seed = 11u;
+    for (long i = 0; text != NULL && i < lines; i++) {
+        seed = seed * 1103515245u + 12345u;
+        fwrite(text, 1, 8 + (seed >> 16) % 113, fp);
+        fputc('\n', fp);
+    }
+    fclose(fp);
+    free(text);
+    if (text == NULL || line_index_open(ctx->path, LINE_INDEX_REBUILD, &ctx->index) != ERR_OK) {
+        teardown_lines(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static long next_line(line_ctx* lc) {
+    lc->seed = lc->seed * 1103515245u + 12345u;
+    return (long)(((unsigned long)lc->seed * 2654435761u) % (unsigned long)lc->lines);
+}
+
+/* 重新扫描整个文件，不写索引文件 */
+static void run_open_rebuild(void* ctx, long iterations) {
+    line_ctx* lc = (line_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        line_index* idx = NULL;
+        if (line_index_open(lc->path, LINE_INDEX_REBUILD | LINE_INDEX_NO_SAVE, &idx) == ERR_OK) {
+            total += (long)line_index_count(idx);
+        }
+        line_index_close(idx);
+    }
+    bench_consume(total);
+}
+
+/* 载入与文件一致的索引文件 */
+static void run_open_load(void* ctx, long iterations) {
+    line_ctx* lc = (line_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        line_index* idx = NULL;
+        if (line_index_open(lc->path, 0, &idx) == ERR_OK) {
+            total += (long)line_index_count(idx);
+        }
+        line_index_close(idx);
+    }
+    bench_consume(total);
+}
+
+static void run_read_line(void* ctx, long iterations) {
+    line_ctx* lc = (line_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (int k = 0; k < RANDOM_READS; k++) {
+            char* text = NULL;
+            size_t len = 0;
+            if (line_index_read_line(lc->index, (uint64_t)next_line(lc), &text, &len) == ERR_OK) {
+                total += (long)len;
+            }
+            mem_free(text);
+        }
+    }
+    bench_consume(total);
+}
+
+/* 对照：读取整个文件后数换行符找到第N行 */
+static void run_read_file_scan(void* ctx, long iterations) {
+    line_ctx* lc = (line_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        char* content = read_file(lc->path);
+        if (content == NULL) {
+            continue;
+        }
+        for (int k = 0; k < RANDOM_READS; k++) {
+            long line = next_line(lc);
+            const char* p = content;
+            for (long n = 0; n < line && p != NULL; n++) {
+                p = strchr(p, '\n');
+                p = p != NULL ? p + 1 : NULL;
+            }
+            total += p != NULL ? (long)(strchr(p, '\n') - p) : 0;
+        }
+        mem_free(content);
+    }
+    bench_consume(total);
+}
+
+/* 有索引文件时追加一行，包括append_file对索引文件的增量更新 */
+static void run_append_indexed(void* ctx, long iterations) {
+    line_ctx* lc = (line_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        total += append_file(lc->path, "appended line\n");
+    }
+    bench_consume(total);
+}
+
+void register_line_index_benchmarks() {
+    static const long sizes[] = {10000, 200000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_register("lines", "open_rebuild", sizes[i], setup_lines, run_open_rebuild, teardown_lines);
+        bench_register("lines", "open_load", sizes[i], setup_lines, run_open_load, teardown_lines);
+        bench_register("lines", "read_line_x64", sizes[i], setup_lines, run_read_line, teardown_lines);
+        bench_register("lines", "read_file_scan_x64", sizes[i], setup_lines, run_read_file_scan, teardown_lines);
+    }
+    bench_register("lines", "append_indexed", 10000, setup_lines, run_append_indexed, teardown_lines);
+}
\ No newline at end of file
@@ -0,0 +1,244 @@
+/**
+ * @file bench_math.c
+ * @brief math_ops.h中函数的基准测试用例
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../include/math_ops.h"
+#include "../include/allocator.h"
+
+static void run_add(void* ctx, long iterations) {
+    (void)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += add((int)i, 7);
+    }
+    bench_consume(sum);
+}
+
+static void run_subtract(void* ctx, long iterations) {
+    (void)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += subtract((int)i, 7);
+    }
+    bench_consume(sum);
+}
+
+static void run_multiply(void* ctx, long iterations) {
+    (void)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += multiply((int)i, 7);
+    }
+    bench_consume(sum);
+}
+
+static void run_divide(void* ctx, long iterations) {
+    (void)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += divide((int)i, 7);
+    }
+    bench_consume(sum);
+}
+
+static void run_gcd(void* ctx, long iterations) {
+    (void)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += gcd(1134903170 - (int)(i & 1023), 701408733);
+    }
+    bench_consume(sum);
+}
+
+static void run_factorial(void* ctx, long iterations) {
+    int n = (int)(long)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += factorial(n);
+    }
+    bench_consume(sum);
+}
+
+static void run_fibonacci(void* ctx, long iterations) {
+    int n = (int)(long)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += fibonacci(n);
+    }
+    bench_consume(sum);
+}
+
+typedef struct {
+    int* arr;
+    int size;
+} array_ctx;
+
+static void* setup_array(long size) {
+    array_ctx* ctx = (array_ctx*)malloc(sizeof(array_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->size = (int)size;
+    ctx->arr = (int*)malloc(size * sizeof(int));
+    if (ctx->arr == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    for (long i = 0; i < size; i++) {
+        ctx->arr[i] = (int)((i * 2654435761u) & 0xFFFF);
+    }
+    return ctx;
+}
+
+static void teardown_array(void* ctx) {
+    array_ctx* array = (array_ctx*)ctx;
+    free(array->arr);
+    free(array);
+}
+
+static void run_average(void* ctx, long iterations) {
+    array_ctx* array = (array_ctx*)ctx;
+    double sum = 0.0;
+    for (long i = 0; i < iterations; i++) {
+        sum += average(array->arr, array->size);
+    }
+    bench_consume((long)sum);
+}
+
+static void run_find_primes(void* ctx, long iterations) {
+    int end = (int)(long)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        int count = 0;
+        int* primes = find_primes(1, end, &count);
+        total += count;
+        mem_free(primes);
+    }
+    bench_consume(total);
+}
+
+/* 只计数，不生成素数数组；参数为上界 */
+static void run_count_primes(void* ctx, long iterations) {
+    uint64_t hi = (uint64_t)(long)ctx;
+    uint64_t total = 0;
+    for (long i = 0; i < iterations; i++) {
+        total += count_primes(1, hi);
+    }
+    bench_consume((long)total);
+}
+
+/* 1000个指定位数的随机整数 */
+#define FACTOR_BENCH_COUNT 1000
+
+typedef struct {
+    uint64_t values[FACTOR_BENCH_COUNT];
+    prime_factors results[FACTOR_BENCH_COUNT];
+} factor_ctx;
+
+static void* setup_factor(long bits) {
+    factor_ctx* ctx = (factor_ctx*)malloc(sizeof(factor_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < FACTOR_BENCH_COUNT; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        ctx->values[i] = bits >= 64 ? state : state >> (64 - bits);
+    }
+    return ctx;
+}
+
+static void run_factorize(void* ctx, long iterations) {
+    factor_ctx* fc = (factor_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (int j = 0; j < FACTOR_BENCH_COUNT; j++) {
+            factorize_u64(fc->values[j], &fc->results[j]);
+            total += fc->results[j].count;
+        }
+    }
+    bench_consume(total);
+}
+
+static void run_factorize_batch(void* ctx, long iterations) {
+    factor_ctx* fc = (factor_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        factorize_u64_batch(fc->values, FACTOR_BENCH_COUNT, fc->results);
+        total += fc->results[0].count;
+    }
+    bench_consume(total);
+}
+
+/* 对照：逐个试除，只用于32位整数 */
+static void run_trial_division(void* ctx, long iterations) {
+    factor_ctx* fc = (factor_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (int j = 0; j < FACTOR_BENCH_COUNT; j++) {
+            uint64_t n = fc->values[j];
+            for (uint64_t d = 2; d * d <= n; d++) {
+                while (n % d == 0) {
+                    n /= d;
+                    total++;
+                }
+            }
+            total += n > 1;
+        }
+    }
+    bench_consume(total);
+}
+
+static void run_initialize(void* ctx, long iterations) {
+    (void)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += initialize_math_ops();
+    }
+    bench_consume(sum);
+}
+
+void register_math_benchmarks() {
+    bench_register("math", "add", 0, NULL, run_add, NULL);
+    bench_register("math", "subtract", 0, NULL, run_subtract, NULL);
+    bench_register("math", "multiply", 0, NULL, run_multiply, NULL);
+    bench_register("math", "divide", 0, NULL, run_divide, NULL);
+    bench_register("math", "gcd", 0, NULL, run_gcd, NULL);
+
+    static const long factorial_params[] = {5, 12};
+    for (size_t i = 0; i < sizeof(factorial_params) / sizeof(factorial_params[0]); i++) {
+        bench_register("math", "factorial", factorial_params[i], NULL, run_factorial, NULL);
+    }
+
+    static const long fibonacci_params[] = {10, 20, 25};
+    for (size_t i = 0; i < sizeof(fibonacci_params) / sizeof(fibonacci_params[0]); i++) {
+        bench_register("math", "fibonacci", fibonacci_params[i], NULL, run_fibonacci, NULL);
+    }
+
+    static const long average_params[] = {100, 10000, 1000000};
+    for (size_t i = 0; i < sizeof(average_params) / sizeof(average_params[0]); i++) {
+        bench_register("math", "average", average_params[i], setup_array, run_average, teardown_array);
+    }
+
+    static const long primes_params[] = {1000, 100000, 1000000};
+    for (size_t i = 0; i < sizeof(primes_params) / sizeof(primes_params[0]); i++) {
+        bench_register("math", "find_primes", primes_params[i], NULL, run_find_primes, NULL);
+    }
+
+    static const long count_params[] = {1000000, 1000000000L, 100000000000L};
+    for (size_t i = 0; i < sizeof(count_params) / sizeof(count_params[0]); i++) {
+        bench_register("math", "count_primes", count_params[i], NULL, run_count_primes, NULL);
+    }
+
+    // 参数为随机整数的位数，每次分解1000个
+    bench_register("math", "trial_division", 32, setup_factor, run_trial_division, free);
+    bench_register("math", "factorize_u64", 32, setup_factor, run_factorize, free);
+    bench_register("math", "factorize_u64", 64, setup_factor, run_factorize, free);
+    bench_register("math", "factorize_u64_batch", 64, setup_factor, run_factorize_batch, free);
+
+    bench_register("math", "initialize_math_ops", 0, NULL, run_initialize, NULL);
+}
\ No newline at end of file
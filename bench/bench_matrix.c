@@ -0,0 +1,134 @@
+/**
+ * @file bench_matrix.c
+ * @brief matrix_ops.h中函数的基准测试用例，参数为方阵的阶数
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../include/matrix_ops.h"
+
+typedef struct {
+    matrix a;
+    matrix b;
+    matrix c;
+} matrix_ctx;
+
+static void teardown_matrix(void* ctx) {
+    matrix_ctx* mc = (matrix_ctx*)ctx;
+    matrix_free(&mc->a);
+    matrix_free(&mc->b);
+    matrix_free(&mc->c);
+    free(mc);
+}
+
+/* 以伪随机的小整数填充，三种类型的结果都精确 */
+static void fill_random(matrix* m, unsigned int seed) {
+    for (size_t i = 0; i < m->rows; i++) {
+        for (size_t j = 0; j < m->cols; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int value = (int)((seed >> 16) % 17) - 8;
+            if (m->type == MATRIX_INT32) {
+                MATRIX_AT(m, int32_t, i, j) = value;
+            } else if (m->type == MATRIX_INT64) {
+                MATRIX_AT(m, int64_t, i, j) = value;
+            } else {
+                MATRIX_AT(m, double, i, j) = value;
+            }
+        }
+    }
+}
+
+static void* setup_matrix(matrix_type type, long n) {
+    matrix_ctx* ctx = (matrix_ctx*)calloc(1, sizeof(matrix_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    matrix_init(&ctx->a);
+    matrix_init(&ctx->b);
+    matrix_init(&ctx->c);
+    if (matrix_create(&ctx->a, type, (size_t)n, (size_t)n) != ERR_OK ||
+        matrix_create(&ctx->b, type, (size_t)n, (size_t)n) != ERR_OK ||
+        matrix_create(&ctx->c, type, (size_t)n, (size_t)n) != ERR_OK) {
+        teardown_matrix(ctx);
+        return NULL;
+    }
+    fill_random(&ctx->a, 12345u);
+    fill_random(&ctx->b, 54321u);
+    return ctx;
+}
+
+static void* setup_double(long n) {
+    return setup_matrix(MATRIX_DOUBLE, n);
+}
+
+static void* setup_int32(long n) {
+    return setup_matrix(MATRIX_INT32, n);
+}
+
+static void* setup_int64(long n) {
+    return setup_matrix(MATRIX_INT64, n);
+}
+
+static void run_multiply(void* ctx, long iterations) {
+    matrix_ctx* mc = (matrix_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        matrix_multiply(&mc->c, &mc->a, &mc->b);
+        total += (long)mc->c.rows;
+    }
+    bench_consume(total);
+}
+
+/* 对照：未分块的三重循环（ikj顺序） */
+static void run_naive(void* ctx, long iterations) {
+    matrix_ctx* mc = (matrix_ctx*)ctx;
+    size_t n = mc->a.rows;
+    long total = 0;
+    for (long it = 0; it < iterations; it++) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                MATRIX_AT(&mc->c, double, i, j) = 0;
+            }
+            for (size_t p = 0; p < n; p++) {
+                double value = MATRIX_AT(&mc->a, double, i, p);
+                for (size_t j = 0; j < n; j++) {
+                    MATRIX_AT(&mc->c, double, i, j) += value * MATRIX_AT(&mc->b, double, p, j);
+                }
+            }
+        }
+        total += (long)MATRIX_AT(&mc->c, double, 0, 0);
+    }
+    bench_consume(total);
+}
+
+static void* setup_fibonacci(long n) {
+    (void)n;
+    return calloc(1, sizeof(matrix_ctx));
+}
+
+static void teardown_fibonacci(void* ctx) {
+    free(ctx);
+}
+
+static void run_fibonacci(void* ctx, long iterations) {
+    (void)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        uint64_t value = 0;
+        matrix_fibonacci(1000000007ULL + (uint64_t)i, &value);
+        total += (long)(value & 1);
+    }
+    bench_consume(total);
+}
+
+void register_matrix_benchmarks() {
+    // 64阶走分块路径但不并行，256阶起并行，1024阶远超过L2
+    static const long sizes[] = {64, 256, 1024};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_register("matrix", "matrix_multiply_double", sizes[i], setup_double, run_multiply, teardown_matrix);
+        bench_register("matrix", "matrix_multiply_int32", sizes[i], setup_int32, run_multiply, teardown_matrix);
+        bench_register("matrix", "matrix_multiply_int64", sizes[i], setup_int64, run_multiply, teardown_matrix);
+    }
+    bench_register("matrix", "naive_multiply_double", 64, setup_double, run_naive, teardown_matrix);
+    bench_register("matrix", "naive_multiply_double", 256, setup_double, run_naive, teardown_matrix);
+    bench_register("matrix", "matrix_fibonacci", 0, setup_fibonacci, run_fibonacci, teardown_fibonacci);
+}
\ No newline at end of file
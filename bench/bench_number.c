@@ -0,0 +1,228 @@
+/**
+ * @file bench_number.c
+ * @brief number_ops.h中函数的基准测试用例，并以strtoll、strtod和snprintf作为对照
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../include/number_ops.h"
+#include "../include/allocator.h"
+
+typedef struct {
+    int64_t* integers;
+    double* doubles;
+    char* int_text;        /* integers以','分隔、每16个换行的文本 */
+    size_t int_text_len;
+    char* double_text;     /* doubles以format_double格式化后以'\n'分隔的文本 */
+    size_t double_text_len;
+    long count;
+} number_ctx;
+
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void teardown_number(void* ctx) {
+    number_ctx* nc = (number_ctx*)ctx;
+    free(nc->integers);
+    free(nc->doubles);
+    free(nc->int_text);
+    free(nc->double_text);
+    free(nc);
+}
+
+static void* setup_number(long count) {
+    number_ctx* ctx = (number_ctx*)calloc(1, sizeof(number_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->count = count;
+    ctx->integers = (int64_t*)malloc((size_t)count * sizeof(int64_t));
+    ctx->doubles = (double*)malloc((size_t)count * sizeof(double));
+    ctx->int_text = (char*)malloc((size_t)count * (NUMBER_INT_BUFFER + 1));
+    ctx->double_text = (char*)malloc((size_t)count * (NUMBER_DOUBLE_BUFFER + 1));
+    if (ctx->integers == NULL || ctx->doubles == NULL || ctx->int_text == NULL || ctx->double_text == NULL) {
+        teardown_number(ctx);
+        return NULL;
+    }
+    // 整数的位数在1到19之间均匀分布，浮点数为不同数量级的随机值
+    uint64_t state = 88172645463325252ULL;
+    for (long i = 0; i < count; i++) {
+        uint64_t bits = next_random(&state);
+        int digits = (int)(bits % 19) + 1;
+        int64_t value = (int64_t)(next_random(&state) >> 1);
+        for (int d = 19; d > digits; d--) {
+            value /= 10;
+        }
+        ctx->integers[i] = (bits & 0x100) ? -value : value;
+        ctx->doubles[i] = (double)(next_random(&state) >> 11) / 9007199254740992.0 *
+                          __builtin_powi(10.0, (int)((bits >> 32) % 40) - 20);
+    }
+    for (long i = 0; i < count; i++) {
+        ctx->int_text_len += format_int64(ctx->integers[i], ctx->int_text + ctx->int_text_len);
+        ctx->int_text[ctx->int_text_len++] = (i % 16 == 15) ? '\n' : ',';
+        ctx->double_text_len += format_double(ctx->doubles[i], ctx->double_text + ctx->double_text_len);
+        ctx->double_text[ctx->double_text_len++] = '\n';
+    }
+    ctx->int_text[ctx->int_text_len - 1] = '\n';
+    return ctx;
+}
+
+static void run_parse_int64_list(void* ctx, long iterations) {
+    number_ctx* nc = (number_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        int64_t* values = NULL;
+        size_t count = 0;
+        parse_int64_list(nc->int_text, nc->int_text_len, ',', &values, &count);
+        total += (long)count;
+        mem_free(values);
+    }
+    bench_consume(total);
+}
+
+static void run_parse_int64(void* ctx, long iterations) {
+    number_ctx* nc = (number_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        const char* p = nc->int_text;
+        const char* end = nc->int_text + nc->int_text_len;
+        while (p < end) {
+            int64_t value = 0;
+            size_t used = 0;
+            parse_int64(p, (size_t)(end - p), &value, &used);
+            total += (long)value;
+            p += used + 1;
+        }
+    }
+    bench_consume(total);
+}
+
+/* 对照：strtoll，文本以','或'\n'结尾，strtoll在其上停止 */
+static void run_strtoll(void* ctx, long iterations) {
+    number_ctx* nc = (number_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        const char* p = nc->int_text;
+        const char* end = nc->int_text + nc->int_text_len;
+        while (p < end) {
+            char* next = NULL;
+            total += (long)strtoll(p, &next, 10);
+            p = next + 1;
+        }
+    }
+    bench_consume(total);
+}
+
+static void run_parse_double(void* ctx, long iterations) {
+    number_ctx* nc = (number_ctx*)ctx;
+    double total = 0.0;
+    for (long i = 0; i < iterations; i++) {
+        const char* p = nc->double_text;
+        const char* end = nc->double_text + nc->double_text_len;
+        while (p < end) {
+            double value = 0.0;
+            size_t used = 0;
+            parse_double(p, (size_t)(end - p), &value, &used);
+            total += value;
+            p += used + 1;
+        }
+    }
+    bench_consume((long)total);
+}
+
+/* 对照：strtod */
+static void run_strtod(void* ctx, long iterations) {
+    number_ctx* nc = (number_ctx*)ctx;
+    double total = 0.0;
+    for (long i = 0; i < iterations; i++) {
+        const char* p = nc->double_text;
+        const char* end = nc->double_text + nc->double_text_len;
+        while (p < end) {
+            char* next = NULL;
+            total += strtod(p, &next);
+            p = next + 1;
+        }
+    }
+    bench_consume((long)total);
+}
+
+static void run_format_int64(void* ctx, long iterations) {
+    number_ctx* nc = (number_ctx*)ctx;
+    char buffer[NUMBER_INT_BUFFER];
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (long j = 0; j < nc->count; j++) {
+            total += (long)format_int64(nc->integers[j], buffer);
+        }
+    }
+    bench_consume(total);
+}
+
+/* 对照：snprintf("%lld") */
+static void run_snprintf_int(void* ctx, long iterations) {
+    number_ctx* nc = (number_ctx*)ctx;
+    char buffer[NUMBER_INT_BUFFER];
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (long j = 0; j < nc->count; j++) {
+            total += snprintf(buffer, sizeof(buffer), "%lld", (long long)nc->integers[j]);
+        }
+    }
+    bench_consume(total);
+}
+
+static void run_format_double(void* ctx, long iterations) {
+    number_ctx* nc = (number_ctx*)ctx;
+    char buffer[NUMBER_DOUBLE_BUFFER];
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (long j = 0; j < nc->count; j++) {
+            total += (long)format_double(nc->doubles[j], buffer);
+        }
+    }
+    bench_consume(total);
+}
+
+/* 对照：snprintf("%.17g")，能读回但不是最短表示 */
+static void run_snprintf_double(void* ctx, long iterations) {
+    number_ctx* nc = (number_ctx*)ctx;
+    char buffer[NUMBER_DOUBLE_BUFFER];
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (long j = 0; j < nc->count; j++) {
+            total += snprintf(buffer, sizeof(buffer), "%.17g", nc->doubles[j]);
+        }
+    }
+    bench_consume(total);
+}
+
+void register_number_benchmarks() {
+    // 100000个整数的文本约1MB，超过批量解析的并行阈值
+    static const long list_sizes[] = {1000, 100000};
+    for (size_t i = 0; i < sizeof(list_sizes) / sizeof(list_sizes[0]); i++) {
+        bench_register("number", "parse_int64_list", list_sizes[i], setup_number, run_parse_int64_list,
+                       teardown_number);
+    }
+
+    static const struct {
+        const char* name;
+        bench_run_fn run;
+    } functions[] = {
+        {"parse_int64", run_parse_int64},
+        {"strtoll", run_strtoll},
+        {"parse_double", run_parse_double},
+        {"strtod", run_strtod},
+        {"format_int64", run_format_int64},
+        {"snprintf_int", run_snprintf_int},
+        {"format_double", run_format_double},
+        {"snprintf_double", run_snprintf_double},
+    };
+    for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++) {
+        bench_register("number", functions[f].name, 1000, setup_number, functions[f].run, teardown_number);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,213 @@
+/**
+ * @file bench_pattern.c
+ * @brief pattern_ops.h中函数的基准测试用例
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fnmatch.h>
+#include <regex.h>
+#include "bench.h"
+#include "../include/pattern_ops.h"
+
+/* 生成文本的平均行长 */
+#define LINE_LENGTH 64
+/* 约每NEEDLE_EVERY行含一个要查找的字面串 */
+#define NEEDLE_EVERY 100
+
+static const char needle[] = "needle";
+static const char* const name_suffixes[] = {".txt", ".c", ".h", ".tar.gz", ".TXT", ".log"};
+
+typedef struct {
+    const char* glob;        /* 文件名用例的glob */
+    pattern* compiled;
+    regex_t re;
+    int has_re;
+    char* text;
+    size_t length;
+    char** names;
+    long name_count;
+} pattern_ctx;
+
+static void teardown_pattern(void* ctx) {
+    pattern_ctx* pc = (pattern_ctx*)ctx;
+    pattern_free(pc->compiled);
+    if (pc->has_re) {
+        regfree(&pc->re);
+    }
+    for (long i = 0; i < pc->name_count; i++) {
+        free(pc->names[i]);
+    }
+    free(pc->names);
+    free(pc->text);
+    free(pc);
+}
+
+/* 参数为文件名数，文件名形如"abc12.txt"，约六分之一以.txt结尾 */
+static void* setup_names(long n) {
+    pattern_ctx* ctx = (pattern_ctx*)calloc(1, sizeof(pattern_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->glob = "*[0-9].txt";
+    ctx->names = (char**)calloc((size_t)n, sizeof(char*));
+    if (ctx->names == NULL || pattern_compile(ctx->glob, PATTERN_GLOB, &ctx->compiled) != ERR_OK) {
+        teardown_pattern(ctx);
+        return NULL;
+    }
+    for (long i = 0; i < n; i++) {
+        char* stem = bench_make_string(4 + i % 12, 777u + (unsigned int)i);
+        ctx->names[i] = (char*)malloc(32);
+        if (stem == NULL || ctx->names[i] == NULL) {
+            free(stem);
+            ctx->name_count = i + 1;
+            teardown_pattern(ctx);
+            return NULL;
+        }
+        snprintf(ctx->names[i], 32, "%s%ld%s", stem, i % 10,
+                 name_suffixes[i % (sizeof(name_suffixes) / sizeof(name_suffixes[0]))]);
+        free(stem);
+    }
+    ctx->name_count = n;
+    return ctx;
+}
+
+static void run_pattern_glob(void* ctx, long iterations) {
+    pattern_ctx* pc = (pattern_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (long j = 0; j < pc->name_count; j++) {
+            total += pattern_match(pc->compiled, pc->names[j], strlen(pc->names[j]));
+        }
+    }
+    bench_consume(total);
+}
+
+/* 对照：每个文件名调用fnmatch */
+static void run_fnmatch(void* ctx, long iterations) {
+    pattern_ctx* pc = (pattern_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (long j = 0; j < pc->name_count; j++) {
+            total += fnmatch(pc->glob, pc->names[j], 0) == 0;
+        }
+    }
+    bench_consume(total);
+}
+
+/* 参数为文本字节数：随机字符组成的行，约每NEEDLE_EVERY行有一行含needle与数字 */
+static pattern_ctx* setup_text(long n, const char* regex, int flags) {
+    pattern_ctx* ctx = (pattern_ctx*)calloc(1, sizeof(pattern_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->text = bench_make_string(n, 2468u);
+    if (ctx->text == NULL || pattern_compile(regex, flags, &ctx->compiled) != ERR_OK) {
+        teardown_pattern(ctx);
+        return NULL;
+    }
+    ctx->has_re = regcomp(&ctx->re, regex, REG_EXTENDED | REG_NOSUB |
+                                                ((flags & PATTERN_ICASE) ? REG_ICASE : 0)) == 0;
+    ctx->length = (size_t)n;
+    unsigned int seed = 97531u;
+    long line = 0;
+    for (long i = LINE_LENGTH; i < n; i += LINE_LENGTH / 2 + (long)(seed >> 16) % LINE_LENGTH) {
+        ctx->text[i] = '\n';
+        seed = seed * 1103515245u + 12345u;
+        if (++line % NEEDLE_EVERY == 0 && i + 1 + (long)sizeof(needle) + 2 < n) {
+            memcpy(ctx->text + i + 1, needle, sizeof(needle) - 1);
+            ctx->text[i + sizeof(needle)] = (char)('0' + line % 10);
+        }
+    }
+    return ctx;
+}
+
+/* 有字面前缀：needle后跟数字 */
+static void* setup_prefix_text(long n) {
+    return setup_text(n, "needle[0-9]+", 0);
+}
+
+/* 没有字面前缀 */
+static void* setup_class_text(long n) {
+    return setup_text(n, "[0-9][0-9][a-z]x", PATTERN_ICASE);
+}
+
+/* 只有字面串，与memmem对照 */
+static void* setup_literal_text(long n) {
+    return setup_text(n, needle, 0);
+}
+
+static void run_filter_lines(void* ctx, long iterations) {
+    pattern_ctx* pc = (pattern_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        size_t count = 0;
+        pattern_filter_lines(pc->compiled, pc->text, pc->length, NULL, NULL, &count);
+        total += (long)count;
+    }
+    bench_consume(total);
+}
+
+/* 对照：逐行复制为字符串并调用regexec */
+static void run_regexec_lines(void* ctx, long iterations) {
+    pattern_ctx* pc = (pattern_ctx*)ctx;
+    long total = 0;
+    char line[4 * LINE_LENGTH];
+    for (long i = 0; i < iterations && pc->has_re; i++) {
+        const char* p = pc->text;
+        const char* end = pc->text + pc->length;
+        while (p < end) {
+            const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+            size_t len = (size_t)((newline != NULL ? newline : end) - p);
+            if (len >= sizeof(line)) {
+                len = sizeof(line) - 1;
+            }
+            memcpy(line, p, len);
+            line[len] = '\0';
+            total += regexec(&pc->re, line, 0, NULL, 0) == 0;
+            p = newline != NULL ? newline + 1 : end;
+        }
+    }
+    bench_consume(total);
+}
+
+/* 对照：逐行以memmem查找字面串 */
+static void run_memmem_lines(void* ctx, long iterations) {
+    pattern_ctx* pc = (pattern_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        const char* p = pc->text;
+        const char* end = pc->text + pc->length;
+        while (p < end) {
+            const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+            size_t len = (size_t)((newline != NULL ? newline : end) - p);
+            total += memmem(p, len, needle, sizeof(needle) - 1) != NULL;
+            p = newline != NULL ? newline + 1 : end;
+        }
+    }
+    bench_consume(total);
+}
+
+void register_pattern_benchmarks() {
+    static const long names[] = {1000, 100000};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        bench_register("pattern", "pattern_match_glob", names[i], setup_names, run_pattern_glob, teardown_pattern);
+        bench_register("pattern", "fnmatch", names[i], setup_names, run_fnmatch, teardown_pattern);
+    }
+    static const long texts[] = {65536, 4194304};
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+        bench_register("pattern", "filter_lines_prefix", texts[i], setup_prefix_text, run_filter_lines,
+                       teardown_pattern);
+        bench_register("pattern", "regexec_lines_prefix", texts[i], setup_prefix_text, run_regexec_lines,
+                       teardown_pattern);
+        bench_register("pattern", "filter_lines_class", texts[i], setup_class_text, run_filter_lines,
+                       teardown_pattern);
+        bench_register("pattern", "regexec_lines_class", texts[i], setup_class_text, run_regexec_lines,
+                       teardown_pattern);
+        bench_register("pattern", "filter_lines_literal", texts[i], setup_literal_text, run_filter_lines,
+                       teardown_pattern);
+        bench_register("pattern", "memmem_lines_literal", texts[i], setup_literal_text, run_memmem_lines,
+                       teardown_pattern);
+    }
+}
\ No newline at end of file
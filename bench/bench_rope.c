@@ -0,0 +1,209 @@
+/**
+ * @file bench_rope.c
+ * @brief rope_ops.h中函数的基准测试用例
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../include/rope_ops.h"
+#include "../include/string_ops.h"
+#include "../include/file_ops.h"
+#include "../include/allocator.h"
+
+/* 逐行构建文档时每行的内容 */
+static const char line_text[] = "0123456789abcde\n";
+#define LINE_LENGTH (sizeof(line_text) - 1)
+/* 每次编辑插入与删除的字节数 */
+#define EDIT_LENGTH 8
+/* 写出用例在文档上预先做的编辑次数 */
+#define WRITE_EDITS 1000
+
+typedef struct {
+    rope text;
+    char* flat;            /* 对照：连续缓冲区 */
+    size_t length;
+    unsigned int seed;
+    char path[128];
+} rope_ctx;
+
+static size_t next_position(rope_ctx* ctx, size_t limit) {
+    ctx->seed = ctx->seed * 1103515245u + 12345u;
+    return (ctx->seed >> 8) % (limit + 1);
+}
+
+static void teardown_rope(void* ctx) {
+    rope_ctx* rc = (rope_ctx*)ctx;
+    rope_free(&rc->text);
+    unlink(rc->path);
+    free(rc->flat);
+    free(rc);
+}
+
+/* 参数为文档字节数：rope由整个文档一个片段开始，连续缓冲区多留一次插入的空间 */
+static void* setup_document(long n) {
+    rope_ctx* ctx = (rope_ctx*)calloc(1, sizeof(rope_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    rope_init(&ctx->text);
+    ctx->length = (size_t)n;
+    ctx->seed = 12345u;
+    snprintf(ctx->path, sizeof(ctx->path), "%s", bench_temp_path("rope.txt"));
+    ctx->flat = bench_make_string(n + EDIT_LENGTH, 54321u);
+    // 与flat的前n个字符相同，rope以mem_free释放，因此由mem_alloc分配
+    char* owned = (char*)mem_alloc((size_t)n + 1);
+    if (ctx->flat == NULL || owned == NULL) {
+        free(ctx->flat);
+        mem_free(owned);
+        free(ctx);
+        return NULL;
+    }
+    memcpy(owned, ctx->flat, (size_t)n);
+    owned[n] = '\0';
+    // 失败时owned已由rope_append_owned释放
+    if (rope_append_owned(&ctx->text, owned, ctx->length) != ERR_OK) {
+        free(ctx->flat);
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+/* 写出用例的文档已有约两千个片段 */
+static void* setup_edited(long n) {
+    rope_ctx* ctx = (rope_ctx*)setup_document(n);
+    for (int i = 0; ctx != NULL && i < WRITE_EDITS; i++) {
+        size_t pos = next_position(ctx, ctx->text.length);
+        rope_insert(&ctx->text, pos, line_text, EDIT_LENGTH);
+        rope_delete(&ctx->text, next_position(ctx, ctx->text.length - EDIT_LENGTH), EDIT_LENGTH);
+    }
+    return ctx;
+}
+
+static void* setup_empty(long n) {
+    (void)n;
+    rope_ctx* ctx = (rope_ctx*)calloc(1, sizeof(rope_ctx));
+    if (ctx != NULL) {
+        rope_init(&ctx->text);
+    }
+    return ctx;
+}
+
+/* 每次迭代在随机位置插入并在另一随机位置删除EDIT_LENGTH字节，文档长度不变 */
+static void run_rope_edit(void* ctx, long iterations) {
+    rope_ctx* rc = (rope_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        rope_insert(&rc->text, next_position(rc, rc->length), line_text, EDIT_LENGTH);
+        rope_delete(&rc->text, next_position(rc, rc->length), EDIT_LENGTH);
+        total += (long)rc->text.pieces;
+    }
+    bench_consume(total);
+}
+
+/* 对照：在连续缓冲区中以memmove插入与删除 */
+static void run_flat_edit(void* ctx, long iterations) {
+    rope_ctx* rc = (rope_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        size_t pos = next_position(rc, rc->length);
+        memmove(rc->flat + pos + EDIT_LENGTH, rc->flat + pos, rc->length - pos);
+        memcpy(rc->flat + pos, line_text, EDIT_LENGTH);
+        pos = next_position(rc, rc->length);
+        memmove(rc->flat + pos, rc->flat + pos + EDIT_LENGTH, rc->length - pos);
+        total += rc->flat[pos];
+    }
+    bench_consume(total);
+}
+
+/* 参数为行数：逐行追加构建文档 */
+static void run_rope_build(void* ctx, long iterations) {
+    rope_ctx* rc = (rope_ctx*)ctx;
+    long lines = (long)rc->length;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        rope text;
+        rope_init(&text);
+        for (long j = 0; j < lines; j++) {
+            rope_append(&text, line_text, LINE_LENGTH);
+        }
+        const char* flat = NULL;
+        rope_flatten(&text, &flat);
+        total += (long)text.length + (flat != NULL ? flat[0] : 0);
+        rope_free(&text);
+    }
+    bench_consume(total);
+}
+
+/* 对照：每行以string_concatenate生成新字符串 */
+static void run_concatenate_build(void* ctx, long iterations) {
+    rope_ctx* rc = (rope_ctx*)ctx;
+    long lines = (long)rc->length;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        char* text = string_duplicate("");
+        for (long j = 0; j < lines && text != NULL; j++) {
+            char* next = string_concatenate(text, line_text);
+            mem_free(text);
+            text = next;
+        }
+        total += text != NULL ? (long)strlen(text) : 0;
+        mem_free(text);
+    }
+    bench_consume(total);
+}
+
+static void* setup_lines(long n) {
+    rope_ctx* ctx = (rope_ctx*)setup_empty(n);
+    if (ctx != NULL) {
+        ctx->length = (size_t)n;
+    }
+    return ctx;
+}
+
+static void run_rope_write(void* ctx, long iterations) {
+    rope_ctx* rc = (rope_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        total += rope_write_file(&rc->text, rc->path) == ERR_OK;
+    }
+    bench_consume(total);
+}
+
+/* 对照：先复制为连续的字符串再write_file */
+static void run_flat_write(void* ctx, long iterations) {
+    rope_ctx* rc = (rope_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        char* text = (char*)malloc(rc->text.length + 1);
+        if (text != NULL && rope_extract(&rc->text, 0, rc->text.length, text) == ERR_OK) {
+            text[rc->text.length] = '\0';
+            total += write_file(rc->path, text);
+        }
+        free(text);
+    }
+    bench_consume(total);
+}
+
+void register_rope_benchmarks() {
+    static const long documents[] = {65536, 1048576, 16777216};
+    for (size_t i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+        bench_register("rope", "rope_edit", documents[i], setup_document, run_rope_edit, teardown_rope);
+        bench_register("rope", "memmove_edit", documents[i], setup_document, run_flat_edit, teardown_rope);
+    }
+    // string_concatenate逐行构建为O(n^2)
+    static const long lines[] = {1000, 10000};
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+        bench_register("rope", "rope_append_lines", lines[i], setup_lines, run_rope_build, teardown_rope);
+        bench_register("rope", "string_concatenate_lines", lines[i], setup_lines, run_concatenate_build,
+                       teardown_rope);
+    }
+    // 片段平均长度分别约为500字节与8KB
+    static const long written[] = {1048576, 16777216};
+    for (size_t i = 0; i < sizeof(written) / sizeof(written[0]); i++) {
+        bench_register("rope", "rope_write_file", written[i], setup_edited, run_rope_write, teardown_rope);
+        bench_register("rope", "extract_write_file", written[i], setup_edited, run_flat_write, teardown_rope);
+    }
+}
\ No newline at end of file
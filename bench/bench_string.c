@@ -0,0 +1,356 @@
+/**
+ * @file bench_string.c
+ * @brief string_ops.h中函数的基准测试用例
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../include/string_ops.h"
+#include "../include/allocator.h"
+
+typedef struct {
+    char* str;
+    char* second;   /* string_concatenate的第二个参数 */
+} string_ctx;
+
+static void* setup_string(long length) {
+    string_ctx* ctx = (string_ctx*)malloc(sizeof(string_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->str = bench_make_string(length, 12345u);
+    ctx->second = bench_make_string(length, 54321u);
+    if (ctx->str == NULL || ctx->second == NULL) {
+        free(ctx->str);
+        free(ctx->second);
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static void teardown_string(void* ctx) {
+    string_ctx* sc = (string_ctx*)ctx;
+    free(sc->str);
+    free(sc->second);
+    free(sc);
+}
+
+/* 运行返回新字符串的单参数函数并释放结果 */
+static void run_unary(string_transform_fn fn, void* ctx, long iterations) {
+    string_ctx* sc = (string_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        char* result = fn(sc->str);
+        total += result != NULL ? result[0] : 0;
+        mem_free(result);
+    }
+    bench_consume(total);
+}
+
+static void run_duplicate(void* ctx, long iterations) {
+    run_unary(string_duplicate, ctx, iterations);
+}
+
+static void run_to_upper(void* ctx, long iterations) {
+    run_unary(string_to_upper, ctx, iterations);
+}
+
+static void run_to_lower(void* ctx, long iterations) {
+    run_unary(string_to_lower, ctx, iterations);
+}
+
+static void run_reverse(void* ctx, long iterations) {
+    run_unary(string_reverse, ctx, iterations);
+}
+
+static void run_concatenate(void* ctx, long iterations) {
+    string_ctx* sc = (string_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        char* result = string_concatenate(sc->str, sc->second);
+        total += result != NULL ? result[0] : 0;
+        mem_free(result);
+    }
+    bench_consume(total);
+}
+
+static void run_find(void* ctx, long iterations) {
+    string_ctx* sc = (string_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        // 子串不在字母表中，测量完整扫描的最坏情况
+        total += string_find(sc->str, "#@!");
+    }
+    bench_consume(total);
+}
+
+static void run_replace(void* ctx, long iterations) {
+    string_ctx* sc = (string_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        char* result = string_replace(sc->str, "a", "<A>");
+        total += result != NULL ? result[0] : 0;
+        mem_free(result);
+    }
+    bench_consume(total);
+}
+
+static void run_split(void* ctx, long iterations) {
+    string_ctx* sc = (string_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        int count = 0;
+        char** parts = string_split(sc->str, ",", &count);
+        for (int j = 0; parts != NULL && j < count; j++) {
+            mem_free(parts[j]);
+        }
+        mem_free(parts);
+        total += count;
+    }
+    bench_consume(total);
+}
+
+typedef struct {
+    char** strs;
+    int count;
+} batch_ctx;
+
+static void* setup_batch(long count) {
+    batch_ctx* ctx = (batch_ctx*)malloc(sizeof(batch_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->count = (int)count;
+    ctx->strs = (char**)calloc(count, sizeof(char*));
+    if (ctx->strs == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    for (long i = 0; i < count; i++) {
+        ctx->strs[i] = bench_make_string(32, (unsigned int)i);
+    }
+    return ctx;
+}
+
+static void teardown_batch(void* ctx) {
+    batch_ctx* bc = (batch_ctx*)ctx;
+    for (int i = 0; i < bc->count; i++) {
+        free(bc->strs[i]);
+    }
+    free(bc->strs);
+    free(bc);
+}
+
+static void run_transform_batch(void* ctx, long iterations) {
+    batch_ctx* bc = (batch_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        char** results = string_transform_batch((const char* const*)bc->strs, bc->count, string_to_upper);
+        for (int j = 0; results != NULL && j < bc->count; j++) {
+            total += results[j] != NULL;
+            mem_free(results[j]);
+        }
+        mem_free(results);
+    }
+    bench_consume(total);
+}
+
+typedef struct {
+    unsigned char* data;
+    long length;
+    char* texts[4];      /* 以各编码方式编码后的data，下标为string_encoding */
+    size_t text_lens[4];
+    char* out;           /* 流式接口与对照实现的输出缓冲区 */
+} codec_ctx;
+
+static void teardown_codec(void* ctx) {
+    codec_ctx* cc = (codec_ctx*)ctx;
+    for (int e = 0; e < 4; e++) {
+        mem_free(cc->texts[e]);
+    }
+    free(cc->data);
+    free(cc->out);
+    free(cc);
+}
+
+/* 参数为原始数据的字节数，数据为随机字节 */
+static void* setup_codec(long length) {
+    codec_ctx* ctx = (codec_ctx*)calloc(1, sizeof(codec_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->length = length;
+    ctx->data = (unsigned char*)malloc((size_t)length);
+    ctx->out = (char*)malloc((size_t)length * 3 + STRING_CODEC_FINAL_BYTES);
+    if (ctx->data == NULL || ctx->out == NULL) {
+        teardown_codec(ctx);
+        return NULL;
+    }
+    unsigned int seed = 13579u;
+    for (long i = 0; i < length; i++) {
+        seed = seed * 1103515245u + 12345u;
+        ctx->data[i] = (unsigned char)(seed >> 16);
+    }
+    for (int e = 0; e < 4; e++) {
+        if (string_encode_checked((string_encoding)e, ctx->data, (size_t)length, &ctx->texts[e],
+                                  &ctx->text_lens[e]) != ERR_OK) {
+            teardown_codec(ctx);
+            return NULL;
+        }
+    }
+    return ctx;
+}
+
+static void run_encode(string_encoding encoding, void* ctx, long iterations) {
+    codec_ctx* cc = (codec_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        size_t len = 0;
+        char* text = NULL;
+        if (string_encode_checked(encoding, cc->data, (size_t)cc->length, &text, &len) == ERR_OK) {
+            total += (long)len;
+        }
+        mem_free(text);
+    }
+    bench_consume(total);
+}
+
+static void run_decode(string_encoding encoding, void* ctx, long iterations) {
+    codec_ctx* cc = (codec_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        size_t len = 0;
+        char* data = string_decode(encoding, cc->texts[encoding], cc->text_lens[encoding], &len);
+        total += (long)len;
+        mem_free(data);
+    }
+    bench_consume(total);
+}
+
+static void run_encode_base64(void* ctx, long iterations) {
+    run_encode(STRING_BASE64, ctx, iterations);
+}
+
+static void run_decode_base64(void* ctx, long iterations) {
+    run_decode(STRING_BASE64, ctx, iterations);
+}
+
+static void run_encode_hex(void* ctx, long iterations) {
+    run_encode(STRING_HEX, ctx, iterations);
+}
+
+static void run_decode_hex(void* ctx, long iterations) {
+    run_decode(STRING_HEX, ctx, iterations);
+}
+
+static void run_encode_percent(void* ctx, long iterations) {
+    run_encode(STRING_PERCENT, ctx, iterations);
+}
+
+static void run_decode_percent(void* ctx, long iterations) {
+    run_decode(STRING_PERCENT, ctx, iterations);
+}
+
+/* 流式接口写到已分配的缓冲区，不分配内存也不分段并行 */
+static void run_decode_update_base64(void* ctx, long iterations) {
+    codec_ctx* cc = (codec_ctx*)ctx;
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        string_codec codec;
+        size_t len = 0;
+        string_codec_init(&codec, STRING_BASE64);
+        string_decode_update(&codec, cc->texts[STRING_BASE64], cc->text_lens[STRING_BASE64], cc->out, &len);
+        total += (long)len;
+        string_decode_final(&codec, cc->out + len, &len);
+    }
+    bench_consume(total);
+}
+
+/* 对照：逐组查表的标量base64解码，与常见的简单实现相同 */
+static void run_decode_base64_table(void* ctx, long iterations) {
+    static signed char values[256];
+    const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    memset(values, -1, sizeof(values));
+    for (int k = 0; k < 64; k++) {
+        values[(unsigned char)alphabet[k]] = (signed char)k;
+    }
+    codec_ctx* cc = (codec_ctx*)ctx;
+    const unsigned char* text = (const unsigned char*)cc->texts[STRING_BASE64];
+    long total = 0;
+    for (long i = 0; i < iterations; i++) {
+        size_t n = 0;
+        for (size_t k = 0; k + 4 <= cc->text_lens[STRING_BASE64] && text[k + 3] != '='; k += 4) {
+            int a = values[text[k]], b = values[text[k + 1]], c = values[text[k + 2]], d = values[text[k + 3]];
+            if ((a | b | c | d) < 0) {
+                break;
+            }
+            unsigned int v = (unsigned int)(a << 18 | b << 12 | c << 6 | d);
+            cc->out[n++] = (char)(v >> 16);
+            cc->out[n++] = (char)(v >> 8);
+            cc->out[n++] = (char)v;
+        }
+        total += (long)n;
+    }
+    bench_consume(total);
+}
+
+static void run_initialize(void* ctx, long iterations) {
+    (void)ctx;
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += initialize_string_ops();
+    }
+    bench_consume(sum);
+}
+
+void register_string_benchmarks() {
+    static const long sizes[] = {16, 1024, 65536, 1048576};
+    static const struct {
+        const char* name;
+        bench_run_fn run;
+    } functions[] = {
+        {"string_duplicate", run_duplicate},
+        {"string_concatenate", run_concatenate},
+        {"string_to_upper", run_to_upper},
+        {"string_to_lower", run_to_lower},
+        {"string_reverse", run_reverse},
+        {"string_find", run_find},
+        {"string_replace", run_replace},
+        {"string_split", run_split},
+    };
+    for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++) {
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            bench_register("string", functions[f].name, sizes[i], setup_string, functions[f].run, teardown_string);
+        }
+    }
+
+    static const long batch_sizes[] = {16, 1024, 65536};
+    for (size_t i = 0; i < sizeof(batch_sizes) / sizeof(batch_sizes[0]); i++) {
+        bench_register("string", "string_transform_batch", batch_sizes[i], setup_batch, run_transform_batch,
+                       teardown_batch);
+    }
+
+    // 8MB超过分段并行的阈值
+    static const long codec_sizes[] = {1024, 1048576, 8388608};
+    static const struct {
+        const char* name;
+        bench_run_fn run;
+    } codecs[] = {
+        {"string_encode_base64", run_encode_base64},
+        {"string_decode_base64", run_decode_base64},
+        {"string_decode_update_base64", run_decode_update_base64},
+        {"base64_table_decode", run_decode_base64_table},
+        {"string_encode_hex", run_encode_hex},
+        {"string_decode_hex", run_decode_hex},
+        {"string_encode_percent", run_encode_percent},
+        {"string_decode_percent", run_decode_percent},
+    };
+    for (size_t f = 0; f < sizeof(codecs) / sizeof(codecs[0]); f++) {
+        for (size_t i = 0; i < sizeof(codec_sizes) / sizeof(codec_sizes[0]); i++) {
+            bench_register("string", codecs[f].name, codec_sizes[i], setup_codec, codecs[f].run, teardown_codec);
+        }
+    }
+
+    bench_register("string", "initialize_string_ops", 0, NULL, run_initialize, NULL);
+}
\ No newline at end of file
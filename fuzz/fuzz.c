@@ -0,0 +1,482 @@
+/**
+ * @file fuzz.c
+ * @brief 模糊测试框架：输入编解码、目标表、libFuzzer入口与独立驱动程序
+ *
+ * 定义FUZZ_LIBFUZZER时只提供LLVMFuzzerTestOneInput，由FUZZ_TARGET_NAME选择目标；
+ * 否则编译为独立驱动程序，先运行各目标的边界用例，再运行随机输入和对边界用例的随机变异。
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <limits.h>
+#include <time.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "fuzz.h"
+#include "../include/utils.h"
+#include "../include/math_ops.h"
+#include "../include/string_ops.h"
+#include "../include/allocator.h"
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define HAVE_ASAN 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define HAVE_ASAN 1
+#endif
+#ifdef HAVE_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+static const fuzz_target targets[] = {
+    {"string_replace", fuzz_string_replace, seed_string_replace, 1},
+    {"string_split", fuzz_string_split, seed_string_split, 1},
+    {"string_encode", fuzz_string_encode, seed_string_encode, 5},  // 输入可平铺到5MB以覆盖分段并行
+    {"string_decode", fuzz_string_decode, seed_string_decode, 5},
+    {"find_primes", fuzz_find_primes, seed_find_primes, 20},  // 大整数区间逐个试除
+    {"count_primes", fuzz_count_primes, seed_count_primes, 20},  // 参考实现筛到2^22或逐个试除
+    {"factorize", fuzz_factorize, seed_factorize, 2},  // 两个32位素数之积需要约10^5步rho迭代
+    {"fibonacci", fuzz_fibonacci, seed_fibonacci, 1},
+    {"levenshtein", fuzz_levenshtein, seed_levenshtein, 10},  // 参考实现为完整动态规划
+    {"rabin_karp", fuzz_rabin_karp, seed_rabin_karp, 1},
+    {"parse_numbers", fuzz_parse_numbers, seed_parse_numbers, 1},
+    {"format_numbers", fuzz_format_numbers, seed_format_numbers, 1},
+    {"csv", fuzz_csv, seed_csv, 5},  // 正文可重复到数MB
+    {"bignum", fuzz_bignum, seed_bignum, 10},  // 十万位的乘除与十进制转换
+    {"matrix", fuzz_matrix, seed_matrix, 10},  // 参考实现为三重循环
+    {"array", fuzz_array, seed_array, 5},  // 数组可到6万个元素，参考实现为qsort
+    {"rope", fuzz_rope, seed_rope, 5},  // 参考缓冲区可到数MB，每次编辑都memmove
+    {"pattern", fuzz_pattern, seed_pattern, 5},  // 参考实现逐行调用regexec或fnmatch
+    {"allocator", fuzz_allocator, seed_allocator, 2},  // 调试模式下每块内存都要mmap
+    {"line_index", fuzz_line_index, seed_line_index, 10},  // 每个操作都要打开文件、读写索引文件
+    {"command", fuzz_command, seed_command, 5},  // 命令行可到数MB，经临时文件批处理
+};
+
+#define TARGET_COUNT ((int)(sizeof(targets) / sizeof(targets[0])))
+
+/* fuzz_consume_int的边界值 */
+static const int boundary_ints[] = {
+    0, 1, 2, -1, INT_MIN, INT_MAX, 46, 47,
+    1 << 15, 1 << 16, -(1 << 16), 2147117569,  // 2147117569 = 46337 * 46337
+    INT_MAX - (1 << 16), 1000000, 65521, 3,
+};
+
+#define BOUNDARY_COUNT ((int)(sizeof(boundary_ints) / sizeof(boundary_ints[0])))
+
+#ifdef HAVE_ASAN
+/* ASan拦截strstr时每次调用都检查整个源字符串，对长字符串的逐个匹配会变成平方复杂度，
+ * 这里关闭该拦截，内存访问仍由插桩检查 */
+const char* __asan_default_options(void) {
+    return "intercept_strstr=0";
+}
+#endif
+
+/* UBSan报告错误后调用abort，由SIGABRT处理函数保存复现文件 */
+const char* __ubsan_default_options(void) {
+    return "abort_on_error=1:print_stacktrace=1";
+}
+
+/* 当前正在运行的输入，检查失败或检测到内存错误时保存为复现文件 */
+static const fuzz_target* current_target = NULL;
+static const uint8_t* current_data = NULL;
+static size_t current_size = 0;
+
+uint8_t fuzz_consume_u8(fuzz_input* in) {
+    return in->pos < in->size ? in->data[in->pos++] : 0;
+}
+
+uint16_t fuzz_consume_u16(fuzz_input* in) {
+    uint16_t low = fuzz_consume_u8(in);
+    uint16_t high = fuzz_consume_u8(in);
+    return (uint16_t)(low | (high << 8));
+}
+
+int fuzz_consume_int(fuzz_input* in) {
+    uint8_t selector = fuzz_consume_u8(in);
+    if (selector & 0x80) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= (uint32_t)fuzz_consume_u8(in) << (8 * i);
+        }
+        return (int)value;
+    }
+    long value = (long)boundary_ints[selector % BOUNDARY_COUNT] + (int8_t)fuzz_consume_u8(in);
+    if (value > INT_MAX) {
+        return INT_MAX;
+    }
+    return value < INT_MIN ? INT_MIN : (int)value;
+}
+
+char* fuzz_consume_string(fuzz_input* in) {
+    uint8_t header = fuzz_consume_u8(in);
+    size_t chunk_len = header & 0x7f;
+    if (chunk_len > in->size - in->pos) {
+        chunk_len = in->size - in->pos;
+    }
+    const uint8_t* chunk = in->data + in->pos;
+    in->pos += chunk_len;
+    size_t repeat = (header & 0x80) ? fuzz_consume_u16(in) : 1;
+    size_t length = chunk_len * repeat;
+    if (length > FUZZ_MAX_STRING) {
+        length = FUZZ_MAX_STRING;
+    }
+
+    char* str = (char*)malloc(length + 1);
+    if (str == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = chunk[i % chunk_len];
+        str[i] = c != 0 ? (char)c : '\1';
+    }
+    str[length] = '\0';
+    return str;
+}
+
+static void buffer_reserve(fuzz_buffer* out, size_t extra) {
+    if (out->size + extra <= out->capacity) {
+        return;
+    }
+    size_t capacity = out->capacity > 0 ? out->capacity * 2 : 64;
+    while (capacity < out->size + extra) {
+        capacity *= 2;
+    }
+    uint8_t* data = (uint8_t*)realloc(out->data, capacity);
+    if (data == NULL) {
+        fprintf(stderr, "内存分配失败\n");
+        abort();
+    }
+    out->data = data;
+    out->capacity = capacity;
+}
+
+void fuzz_put_u8(fuzz_buffer* out, uint8_t value) {
+    buffer_reserve(out, 1);
+    out->data[out->size++] = value;
+}
+
+void fuzz_put_u16(fuzz_buffer* out, uint16_t value) {
+    fuzz_put_u8(out, (uint8_t)(value & 0xff));
+    fuzz_put_u8(out, (uint8_t)(value >> 8));
+}
+
+void fuzz_put_int(fuzz_buffer* out, int value) {
+    fuzz_put_u8(out, 0x80);
+    for (int i = 0; i < 4; i++) {
+        fuzz_put_u8(out, (uint8_t)((uint32_t)value >> (8 * i)));
+    }
+}
+
+void fuzz_put_string(fuzz_buffer* out, const char* chunk, unsigned int repeat) {
+    size_t chunk_len = strlen(chunk);
+    if (chunk_len > 0x7f) {
+        chunk_len = 0x7f;
+    }
+    fuzz_put_u8(out, (uint8_t)(chunk_len | (repeat != 1 ? 0x80 : 0)));
+    buffer_reserve(out, chunk_len);
+    memcpy(out->data + out->size, chunk, chunk_len);
+    out->size += chunk_len;
+    if (repeat != 1) {
+        fuzz_put_u16(out, (uint16_t)repeat);
+    }
+}
+
+/* 把当前输入写到crash-<目标名>，便于用驱动程序或libFuzzer复现；也在信号处理函数中调用，只用write */
+static void save_current_input() {
+    const fuzz_target* target = current_target;
+    if (target == NULL) {
+        return;
+    }
+    current_target = NULL;
+    char path[128];
+    snprintf(path, sizeof(path), "crash-%s", target->name);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    size_t written = 0;
+    while (written < current_size) {
+        ssize_t n = write(fd, current_data + written, current_size - written);
+        if (n <= 0) {
+            break;
+        }
+        written += (size_t)n;
+    }
+    close(fd);
+    char message[512];
+    int length = snprintf(message, sizeof(message), "输入已保存到%s，复现：fuzz/fuzz_runner --target %s %s\n",
+                          path, target->name, path);
+    if (length > 0 && (size_t)length < sizeof(message)) {
+        ssize_t ignored = write(STDERR_FILENO, message, (size_t)length);
+        (void)ignored;
+    }
+}
+
+void fuzz_fail(const char* file, int line, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "差分测试失败 %s:%d: ", file, line);
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    save_current_input();
+    abort();
+}
+
+static void initialize_fuzzing() {
+    set_log_flags(0);
+    // 模块返回的内存直接由malloc分配，ASan能发现结果的越界访问与释放后使用；内存池由allocator目标测试
+    mem_set_mode(MEM_MODE_SYSTEM);
+    if (!initialize_math_ops() || !initialize_string_ops()) {
+        fprintf(stderr, "初始化失败\n");
+        exit(1);
+    }
+}
+
+#ifdef FUZZ_LIBFUZZER
+
+#ifndef FUZZ_TARGET_NAME
+#error "libFuzzer构建需要用-DFUZZ_TARGET_NAME=\"目标名\"选择目标"
+#endif
+
+static const fuzz_target* libfuzzer_target = NULL;
+
+int LLVMFuzzerInitialize(int* argc, char*** argv) {
+    (void)argc;
+    (void)argv;
+    initialize_fuzzing();
+    for (int i = 0; i < TARGET_COUNT; i++) {
+        if (strcmp(targets[i].name, FUZZ_TARGET_NAME) == 0) {
+            libfuzzer_target = &targets[i];
+        }
+    }
+    if (libfuzzer_target == NULL) {
+        fprintf(stderr, "未知的模糊测试目标: %s\n", FUZZ_TARGET_NAME);
+        exit(1);
+    }
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    libfuzzer_target->run(data, size);
+    return 0;
+}
+
+#else /* 独立驱动程序 */
+
+/* 随机输入的字节偏向这些值，使字符串之间更容易出现重叠匹配 */
+static const uint8_t biased_bytes[] = {'a', 'a', 'b', ',', 0, 0x80, 0xff, 1};
+
+static uint64_t rng_state;
+
+/* 被测函数触发abort（包括UBSan）或段错误时保存当前输入，再按默认方式终止 */
+static void crash_handler(int sig) {
+    save_current_input();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void run_input(const fuzz_target* target, const uint8_t* data, size_t size) {
+    current_target = target;
+    current_data = data;
+    current_size = size;
+    target->run(data, size);
+    current_target = NULL;
+}
+
+static uint64_t next_random() {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static uint8_t random_byte() {
+    uint64_t r = next_random();
+    if (r & 1) {
+        return biased_bytes[(r >> 1) % sizeof(biased_bytes)];
+    }
+    return (uint8_t)(r >> 8);
+}
+
+/* 随机生成输入，或随机变异一个边界用例 */
+static void make_random_input(const fuzz_target* target, int seed_count, size_t max_len, fuzz_buffer* out) {
+    out->size = 0;
+    if (seed_count > 0 && next_random() % 2 == 0) {
+        target->seeds((int)(next_random() % (uint64_t)seed_count), out);
+        if (out->size > 0) {
+            int mutations = 1 + (int)(next_random() % 4);
+            for (int i = 0; i < mutations; i++) {
+                out->data[next_random() % out->size] = random_byte();
+            }
+        }
+        return;
+    }
+    size_t length = (size_t)(next_random() % (max_len + 1));
+    buffer_reserve(out, length);
+    for (size_t i = 0; i < length; i++) {
+        out->data[i] = random_byte();
+    }
+    out->size = length;
+}
+
+static int read_input_file(const char* path, fuzz_buffer* out) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+    out->size = 0;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        buffer_reserve(out, n);
+        memcpy(out->data + out->size, chunk, n);
+        out->size += n;
+    }
+    fclose(file);
+    return 1;
+}
+
+/* 把边界用例写成libFuzzer语料文件 */
+static int write_corpus(const fuzz_target* target, const char* dir, fuzz_buffer* buffer) {
+    int written = 0;
+    for (int i = 0;; i++) {
+        buffer->size = 0;
+        if (!target->seeds(i, buffer)) {
+            break;
+        }
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s-seed-%03d", dir, target->name, i);
+        FILE* file = fopen(path, "wb");
+        if (file == NULL) {
+            fprintf(stderr, "无法写入语料文件: %s\n", path);
+            return 0;
+        }
+        fwrite(buffer->data, 1, buffer->size, file);
+        fclose(file);
+        written++;
+    }
+    printf("%s: 写入%d个语料文件到%s\n", target->name, written, dir);
+    return 1;
+}
+
+static void show_usage() {
+    printf("用法: fuzz_runner [选项] [输入文件...]\n");
+    printf("  --target NAME       只运行指定目标（string_replace、string_split、find_primes、fibonacci）\n");
+    printf("  --iterations N      每个目标的随机输入个数（默认10000，耗时较长的目标按比例减少）\n");
+    printf("  --seed N            随机种子（默认取当前时间）\n");
+    printf("  --max-len N         随机输入的最大字节数（默认64）\n");
+    printf("  --write-corpus DIR  把边界用例写成libFuzzer语料文件后退出\n");
+    printf("指定输入文件时只重放这些文件（例如crash-*复现文件），需要同时指定--target\n");
+}
+
+int main(int argc, char** argv) {
+    const char* only = NULL;
+    const char* corpus_dir = NULL;
+    long iterations = 10000;
+    uint64_t seed = (uint64_t)time(NULL);
+    size_t max_len = 64;
+    int first_file = argc;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-len") == 0 && i + 1 < argc) {
+            max_len = (size_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--write-corpus") == 0 && i + 1 < argc) {
+            corpus_dir = argv[++i];
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            show_usage();
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        } else {
+            first_file = i;
+            break;
+        }
+    }
+
+    const fuzz_target* selected[TARGET_COUNT];
+    int selected_count = 0;
+    for (int i = 0; i < TARGET_COUNT; i++) {
+        if (only == NULL || strcmp(only, targets[i].name) == 0) {
+            selected[selected_count++] = &targets[i];
+        }
+    }
+    if (selected_count == 0 || (first_file < argc && selected_count != 1)) {
+        show_usage();
+        return 1;
+    }
+
+    initialize_fuzzing();
+#ifdef HAVE_ASAN
+    __sanitizer_set_death_callback(save_current_input);
+#endif
+    signal(SIGABRT, crash_handler);
+    signal(SIGSEGV, crash_handler);
+    signal(SIGFPE, crash_handler);
+    fuzz_buffer buffer = {NULL, 0, 0};
+
+    if (corpus_dir != NULL) {
+        for (int t = 0; t < selected_count; t++) {
+            if (!write_corpus(selected[t], corpus_dir, &buffer)) {
+                free(buffer.data);
+                return 1;
+            }
+        }
+        free(buffer.data);
+        return 0;
+    }
+
+    if (first_file < argc) {
+        for (int i = first_file; i < argc; i++) {
+            if (!read_input_file(argv[i], &buffer)) {
+                fprintf(stderr, "无法读取输入文件: %s\n", argv[i]);
+                free(buffer.data);
+                return 1;
+            }
+            run_input(selected[0], buffer.data, buffer.size);
+            printf("%s: %s 通过\n", selected[0]->name, argv[i]);
+        }
+        free(buffer.data);
+        return 0;
+    }
+
+    printf("随机种子: %llu\n", (unsigned long long)seed);
+    rng_state = seed != 0 ? seed : 1;
+    for (int t = 0; t < selected_count; t++) {
+        const fuzz_target* target = selected[t];
+        struct timespec begin, end;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+
+        int seed_count = 0;
+        for (;; seed_count++) {
+            buffer.size = 0;
+            if (!target->seeds(seed_count, &buffer)) {
+                break;
+            }
+            run_input(target, buffer.data, buffer.size);
+        }
+        long count = iterations / target->cost > 0 ? iterations / target->cost : 1;
+        for (long i = 0; i < count; i++) {
+            make_random_input(target, seed_count, max_len, &buffer);
+            run_input(target, buffer.data, buffer.size);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double seconds = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+        printf("%-16s 边界用例 %3d 个，随机输入 %ld 个，全部与参考实现一致（%.2f 秒）\n",
+               target->name, seed_count, count, seconds);
+    }
+    free(buffer.data);
+    return 0;
+}
+
+#endif /* FUZZ_LIBFUZZER */
\ No newline at end of file
@@ -0,0 +1,345 @@
+/**
+ * @file fuzz.h
+ * @brief 模糊测试与差分测试框架接口
+ *
+ * 每个模糊测试目标接收一段任意字节，解码成被测函数的参数，分别调用参考实现（reference.c，
+ * 保留各函数当前标量版本的行为）和src中的实现（以及以后注册的优化版本），结果不一致时终止程序。
+ * 同一组目标既可以链接libFuzzer运行，也可以由fuzz.c中的独立驱动程序以随机与边界输入运行。
+ */
+#ifndef FUZZ_H
+#define FUZZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/error_codes.h"
+#include "../include/math_ops.h"
+#include "../include/matrix_ops.h"
+#include "../include/array_ops.h"
+#include "../include/string_ops.h"
+
+/* 解码出的单个字符串的最大长度 */
+#define FUZZ_MAX_STRING (1 << 20)
+
+/**
+ * @brief 输入解码器，数据不足时各consume函数返回0或空字符串
+ */
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+} fuzz_input;
+
+/**
+ * @brief 输入编码缓冲区，用于构造边界用例，按需增长
+ */
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} fuzz_buffer;
+
+/**
+ * @brief 执行一个模糊测试输入
+ * @param data 输入数据
+ * @param size 输入长度
+ */
+typedef void (*fuzz_run_fn)(const uint8_t* data, size_t size);
+
+/**
+ * @brief 生成第index个边界用例
+ * @param index 用例序号，从0开始
+ * @param out 用例写入的缓冲区（已清空）
+ * @return 生成了用例返回1，没有更多用例返回0
+ */
+typedef int (*fuzz_seed_fn)(int index, fuzz_buffer* out);
+
+/**
+ * @brief 一个模糊测试目标
+ */
+typedef struct {
+    const char* name;
+    fuzz_run_fn run;
+    fuzz_seed_fn seeds;
+    int cost;           /* 单个输入的相对耗时，独立驱动程序的随机输入个数按该值缩小 */
+} fuzz_target;
+
+/**
+ * @brief 检查条件，不成立时输出信息、保存当前输入并终止程序
+ */
+#define FUZZ_CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fuzz_fail(__FILE__, __LINE__, __VA_ARGS__); \
+        } \
+    } while (0)
+
+/**
+ * @brief 报告不一致并终止程序（独立驱动程序会先把当前输入保存为复现文件）
+ * @param file 源文件
+ * @param line 行号
+ * @param format printf格式的说明
+ */
+void fuzz_fail(const char* file, int line, const char* format, ...)
+    __attribute__((noreturn, format(printf, 3, 4)));
+
+/**
+ * @brief 读取一个字节
+ * @param in 解码器
+ * @return 字节值
+ */
+uint8_t fuzz_consume_u8(fuzz_input* in);
+
+/**
+ * @brief 读取一个16位整数（小端）
+ * @param in 解码器
+ * @return 整数值
+ */
+uint16_t fuzz_consume_u16(fuzz_input* in);
+
+/**
+ * @brief 读取一个int，偏向0、±1、INT_MIN、INT_MAX、溢出临界值等边界值附近
+ *
+ * 编码：选择字节最高位为1时后跟4字节原始值；否则以选择字节选取边界值，再加上后一字节的有符号偏移。
+ *
+ * @param in 解码器
+ * @return 整数值
+ */
+int fuzz_consume_int(fuzz_input* in);
+
+/**
+ * @brief 读取一个字符串
+ *
+ * 编码：长度字节的低7位为片段长度，随后是片段内容；长度字节最高位为1时片段后跟16位重复次数，
+ * 片段重复该次数，用很短的输入构造很长的、大量重叠匹配的字符串。'\0'替换为'\1'，
+ * 总长度不超过FUZZ_MAX_STRING。
+ *
+ * @param in 解码器
+ * @return 新分配的字符串，调用者负责释放内存；内存不足时返回NULL
+ */
+char* fuzz_consume_string(fuzz_input* in);
+
+/**
+ * @brief 追加一个字节
+ * @param out 缓冲区
+ * @param value 字节值
+ */
+void fuzz_put_u8(fuzz_buffer* out, uint8_t value);
+
+/**
+ * @brief 追加一个16位整数（小端）
+ * @param out 缓冲区
+ * @param value 整数值
+ */
+void fuzz_put_u16(fuzz_buffer* out, uint16_t value);
+
+/**
+ * @brief 追加一个按原始值编码的int，fuzz_consume_int读回同一个值
+ * @param out 缓冲区
+ * @param value 整数值
+ */
+void fuzz_put_int(fuzz_buffer* out, int value);
+
+/**
+ * @brief 追加一个由片段重复repeat次构成的字符串，fuzz_consume_string读回该字符串
+ * @param out 缓冲区
+ * @param chunk 片段，长度不超过127
+ * @param repeat 重复次数，1到65535
+ */
+void fuzz_put_string(fuzz_buffer* out, const char* chunk, unsigned int repeat);
+
+/**
+ * @brief 参考实现：string_replace_checked当前标量版本的行为
+ */
+error_code reference_string_replace(const char* str, const char* old_substr, const char* new_substr,
+                                    char** result);
+
+/**
+ * @brief 参考实现：string_split_checked当前标量版本的行为
+ */
+error_code reference_string_split(const char* str, const char* delimiter, char*** parts, int* count);
+
+/**
+ * @brief 参考实现：find_primes_checked的行为，以分段埃氏筛计算
+ */
+error_code reference_find_primes(int start, int end, int** primes, int* count);
+
+/**
+ * @brief 参考实现：count_primes_checked的行为，hi不超过2^22时筛出[0, hi]计数，否则逐个试除（区间应较短）
+ */
+error_code reference_count_primes(uint64_t lo, uint64_t hi, uint64_t* count);
+
+/**
+ * @brief 参考实现：判断64位整数是否为素数，以128位取模和前12个素数为底的Miller-Rabin检验计算
+ */
+int reference_is_prime_u64(uint64_t n);
+
+/**
+ * @brief 参考实现：factorize_u64的行为，逐个试除（n应不超过2^40）
+ */
+error_code reference_factorize_u64(uint64_t n, prime_factors* result);
+
+/**
+ * @brief 参考实现：fibonacci_checked的行为，以64位整数迭代计算
+ */
+error_code reference_fibonacci(int n, int* result);
+
+/**
+ * @brief 参考实现：Levenshtein编辑距离，以完整的O(m * n)动态规划计算
+ * @return 编辑距离，内存不足时返回-1
+ */
+long reference_levenshtein(const char* a, size_t a_len, const char* b, size_t b_len);
+
+/**
+ * @brief 参考实现：逐字节统计不同的字节数与比特数
+ */
+void reference_hamming(const void* a, const void* b, size_t len, size_t* bytes, size_t* bits);
+
+/**
+ * @brief 参考实现：parse_int64的行为，逐位累加并检查溢出
+ */
+error_code reference_parse_int64(const char* str, size_t len, int64_t* value, size_t* consumed);
+
+/**
+ * @brief 参考实现：parse_int64_list的行为，先按行、再按分隔符拆分字段后逐个解析
+ */
+error_code reference_parse_int64_list(const char* buffer, size_t len, char delimiter, int64_t** values,
+                                      size_t* count);
+
+/**
+ * @brief 参考实现：csv_parse_buffer的拆分规则，逐字符读取字段
+ * @param fields 输出参数，按行依次存放的所有字段（包括第一行），去掉了引号与转义
+ * @param count 输出参数，字段个数
+ * @param column_count 输出参数，第一个非空行的字段数
+ * @return ERR_OK、ERR_CSV_QUOTE、ERR_CSV_FIELD_COUNT或ERR_CSV_ALLOC
+ */
+error_code reference_csv_split(const char* data, size_t len, char delimiter, char*** fields, size_t* count,
+                               int* column_count);
+
+/**
+ * @brief 释放reference_csv_split输出的字段
+ */
+void reference_free_fields(char** fields, size_t count);
+
+/**
+ * @brief 参考实现：两个十进制整数的精确乘积，按10^9分组的朴素乘法
+ * @param a 可选的'+'或'-'后跟数字，允许前导零
+ * @param b 同a
+ * @return 新分配的乘积文本，没有前导零，0不带符号；内存不足时返回NULL
+ */
+char* reference_bignum_multiply(const char* a, const char* b);
+
+/**
+ * @brief 参考实现：矩阵乘法c = a * b的三重循环，整数按补码回绕
+ * @param type 元素类型
+ * @param m a的行数
+ * @param n b的列数
+ * @param k a的列数
+ * @param a 左矩阵，行距lda个元素
+ * @param b 右矩阵，行距ldb个元素
+ * @param c 结果，行距ldc个元素
+ */
+void reference_matrix_multiply(matrix_type type, size_t m, size_t n, size_t k, const void* a, size_t lda,
+                               const void* b, size_t ldb, void* c, size_t ldc);
+
+/**
+ * @brief 参考实现：逐项迭代计算斐波那契数F(n)模2^64
+ */
+uint64_t reference_fibonacci_u64(uint64_t n);
+
+/**
+ * @brief 参考实现：以qsort升序排序
+ */
+void reference_sort_int32(int32_t* data, size_t count);
+void reference_sort_int64(int64_t* data, size_t count);
+void reference_sort_uint64(uint64_t* data, size_t count);
+
+/**
+ * @brief 参考实现：以qsort按IEEE 754全序升序排序（比较符号位与其余位，-0.0在+0.0之前，NaN按符号排在两端）
+ */
+void reference_sort_double(double* data, size_t count);
+
+/**
+ * @brief 参考实现：逐个比较，返回第一个不小于key的元素的下标
+ */
+size_t reference_lower_bound_int64(const int64_t* data, size_t count, int64_t key);
+
+/**
+ * @brief 参考实现：按位累积的string_encode_checked，结果用free释放
+ */
+char* reference_string_encode(string_encoding encoding, const uint8_t* data, size_t len, size_t* result_len);
+
+/**
+ * @brief 参考实现：先整体检查再逐字符解码的string_decode_checked，包括第一个无效字符的偏移
+ */
+error_code reference_string_decode(string_encoding encoding, const char* text, size_t len, char** result,
+                                   size_t* result_len);
+
+/* fuzz_string.c */
+void fuzz_string_replace(const uint8_t* data, size_t size);
+int seed_string_replace(int index, fuzz_buffer* out);
+void fuzz_string_split(const uint8_t* data, size_t size);
+int seed_string_split(int index, fuzz_buffer* out);
+void fuzz_string_encode(const uint8_t* data, size_t size);
+int seed_string_encode(int index, fuzz_buffer* out);
+void fuzz_string_decode(const uint8_t* data, size_t size);
+int seed_string_decode(int index, fuzz_buffer* out);
+
+/* fuzz_math.c */
+void fuzz_find_primes(const uint8_t* data, size_t size);
+int seed_find_primes(int index, fuzz_buffer* out);
+void fuzz_count_primes(const uint8_t* data, size_t size);
+int seed_count_primes(int index, fuzz_buffer* out);
+void fuzz_factorize(const uint8_t* data, size_t size);
+int seed_factorize(int index, fuzz_buffer* out);
+void fuzz_fibonacci(const uint8_t* data, size_t size);
+int seed_fibonacci(int index, fuzz_buffer* out);
+
+/* fuzz_fingerprint.c */
+void fuzz_levenshtein(const uint8_t* data, size_t size);
+int seed_levenshtein(int index, fuzz_buffer* out);
+void fuzz_rabin_karp(const uint8_t* data, size_t size);
+int seed_rabin_karp(int index, fuzz_buffer* out);
+
+/* fuzz_number.c */
+void fuzz_parse_numbers(const uint8_t* data, size_t size);
+int seed_parse_numbers(int index, fuzz_buffer* out);
+void fuzz_format_numbers(const uint8_t* data, size_t size);
+int seed_format_numbers(int index, fuzz_buffer* out);
+
+/* fuzz_csv.c */
+void fuzz_csv(const uint8_t* data, size_t size);
+int seed_csv(int index, fuzz_buffer* out);
+
+/* fuzz_bignum.c */
+void fuzz_bignum(const uint8_t* data, size_t size);
+int seed_bignum(int index, fuzz_buffer* out);
+
+/* fuzz_matrix.c */
+void fuzz_matrix(const uint8_t* data, size_t size);
+int seed_matrix(int index, fuzz_buffer* out);
+
+/* fuzz_array.c */
+void fuzz_array(const uint8_t* data, size_t size);
+int seed_array(int index, fuzz_buffer* out);
+
+/* fuzz_rope.c */
+void fuzz_rope(const uint8_t* data, size_t size);
+int seed_rope(int index, fuzz_buffer* out);
+
+/* fuzz_pattern.c */
+void fuzz_pattern(const uint8_t* data, size_t size);
+int seed_pattern(int index, fuzz_buffer* out);
+
+/* fuzz_allocator.c */
+void fuzz_allocator(const uint8_t* data, size_t size);
+int seed_allocator(int index, fuzz_buffer* out);
+
+/* fuzz_line_index.c */
+void fuzz_line_index(const uint8_t* data, size_t size);
+int seed_line_index(int index, fuzz_buffer* out);
+
+/* fuzz_command.c */
+void fuzz_command(const uint8_t* data, size_t size);
+int seed_command(int index, fuzz_buffer* out);
+
+#endif /* FUZZ_H */
\ No newline at end of file
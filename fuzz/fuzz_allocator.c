@@ -0,0 +1,206 @@
+/**
+ * @file fuzz_allocator.c
+ * @brief 内存分配模块的模糊测试目标：在三种分配方式间切换执行一串分配、改变大小与释放，
+ *        检查内容不被破坏、对齐，以及释放全部内存后跟踪统计回到初始值
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz.h"
+#include "../include/allocator.h"
+
+/* 一个输入最多执行的操作数 */
+#define MAX_OPS 4096
+/* 同时持有的内存块数 */
+#define SLOT_COUNT 64
+
+/* 操作字节：低2位为操作，第2、3位选择分配方式（3表示不切换），第4位打开跟踪，第5位为大块（否则不超过SMALL_LIMIT），
+   第7位使分配清零 */
+#define OP_ALLOC 0
+#define OP_REALLOC 1
+#define OP_FREE 2
+#define OP_STRDUP 3
+#define OP_TRACK 0x10
+#define OP_LARGE 0x20
+#define OP_ZERO 0x80
+
+/* 小块的大小上限，覆盖内存池的全部级别与其后的malloc */
+#define SMALL_LIMIT 1200
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    uint8_t seed;
+} slot;
+
+static void fill(slot* s) {
+    for (size_t i = 0; i < s->size; i++) {
+        s->data[i] = (unsigned char)(s->seed + i * 31);
+    }
+}
+
+/* 检查前len个字节仍是填充的内容 */
+static void check_fill(const slot* s, size_t len, const char* what) {
+    for (size_t i = 0; i < len; i++) {
+        FUZZ_CHECK(s->data[i] == (unsigned char)(s->seed + i * 31), "%s：%zu字节的块在第%zu个字节被改写", what,
+                   s->size, i);
+    }
+}
+
+static void check_aligned(const void* ptr, const char* what) {
+    FUZZ_CHECK(((uintptr_t)ptr & 15) == 0, "%s返回的地址%p未按16字节对齐", what, ptr);
+}
+
+static size_t consume_size(fuzz_input* in, uint8_t op) {
+    size_t size = fuzz_consume_u16(in);
+    return (op & OP_LARGE) ? size : size % SMALL_LIMIT;
+}
+
+void fuzz_allocator(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    slot slots[SLOT_COUNT];
+    memset(slots, 0, sizeof(slots));
+    mem_stats before;
+    mem_get_stats(&before);
+    mem_mode saved_mode = mem_get_mode();
+    for (int ops = 0; ops < MAX_OPS && in.pos < in.size; ops++) {
+        uint8_t op = fuzz_consume_u8(&in);
+        slot* s = &slots[fuzz_consume_u8(&in) % SLOT_COUNT];
+        if (((op >> 2) & 3) != 3) {
+            mem_set_mode((mem_mode)((op >> 2) & 3));
+        }
+        mem_set_tracking((op & OP_TRACK) != 0);
+        switch (op & 0x03) {
+            case OP_ALLOC: {
+                // 先释放槽中原有的块：块由哪种方式分配与当前方式无关
+                if (s->data != NULL) {
+                    check_fill(s, s->size, "释放前");
+                    mem_free(s->data);
+                }
+                size_t n = consume_size(&in, op);
+                s->data = (op & OP_ZERO) ? (unsigned char*)mem_calloc(n, 1) : (unsigned char*)mem_alloc(n);
+                s->size = n;
+                s->seed = (uint8_t)ops;
+                if (s->data == NULL) {
+                    break;
+                }
+                check_aligned(s->data, "mem_alloc");
+                if (op & OP_ZERO) {
+                    for (size_t i = 0; i < n; i++) {
+                        FUZZ_CHECK(s->data[i] == 0, "mem_calloc(%zu, 1)的第%zu个字节不为0", n, i);
+                    }
+                }
+                fill(s);
+                break;
+            }
+            case OP_REALLOC: {
+                size_t n = consume_size(&in, op);
+                unsigned char* grown = (unsigned char*)mem_realloc(s->data, n);
+                if (grown == NULL) {
+                    break;
+                }
+                check_aligned(grown, "mem_realloc");
+                s->data = grown;
+                size_t kept = s->size < n ? s->size : n;
+                check_fill(s, kept, "mem_realloc后");
+                s->size = n;
+                fill(s);
+                break;
+            }
+            case OP_FREE:
+                if (s->data != NULL) {
+                    check_fill(s, s->size, "释放前");
+                }
+                mem_free(s->data);
+                s->data = NULL;
+                s->size = 0;
+                break;
+            default: {
+                char* text = fuzz_consume_string(&in);
+                if (text == NULL) {
+                    break;
+                }
+                char* copy = mem_strdup(text);
+                if (copy != NULL) {
+                    check_aligned(copy, "mem_strdup");
+                    FUZZ_CHECK(strcmp(copy, text) == 0, "mem_strdup的结果与原字符串不同");
+                    mem_free(copy);
+                }
+                free(text);
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        if (slots[i].data != NULL) {
+            check_fill(&slots[i], slots[i].size, "结束时");
+            mem_free(slots[i].data);
+        }
+    }
+    mem_set_tracking(0);
+    mem_set_mode(saved_mode);
+    mem_stats after;
+    mem_get_stats(&after);
+    FUZZ_CHECK(after.live_bytes == before.live_bytes && after.live_blocks == before.live_blocks,
+               "全部释放后跟踪统计为%zu字节%zu块，开始时为%zu字节%zu块", after.live_bytes, after.live_blocks,
+               before.live_bytes, before.live_blocks);
+}
+
+/* 操作的方式字段 */
+#define MODE(m) ((uint8_t)((m) << 2))
+#define KEEP MODE(3)
+
+/* 边界用例：{操作字节, 槽, 大小} 的序列，以操作字节0xff结束 */
+static const struct {
+    uint8_t op;
+    uint8_t slot;
+    uint16_t size;
+} allocator_seeds[][12] = {
+    // 内存池级别的边界：0字节、恰好放满一级、多出1字节，原地与移动的改变大小
+    {{OP_ALLOC | MODE(MEM_MODE_POOL), 0, 0}, {OP_ALLOC | KEEP, 1, 16}, {OP_ALLOC | KEEP, 2, 17},
+     {OP_REALLOC | KEEP, 1, 15}, {OP_REALLOC | KEEP, 2, 1008}, {OP_REALLOC | KEEP, 2, 1009},
+     {OP_REALLOC | KEEP, 0, 48}, {OP_FREE | KEEP, 1, 0}, {0xff, 0, 0}},
+    // 在一种方式下分配，在另一种方式下改变大小与释放
+    {{OP_ALLOC | MODE(MEM_MODE_DEBUG), 0, 100}, {OP_ALLOC | MODE(MEM_MODE_POOL), 1, 200},
+     {OP_ALLOC | MODE(MEM_MODE_SYSTEM) | OP_LARGE, 2, 50000}, {OP_REALLOC | MODE(MEM_MODE_POOL), 0, 300},
+     {OP_REALLOC | MODE(MEM_MODE_DEBUG), 1, 4000}, {OP_REALLOC | MODE(MEM_MODE_POOL), 2, 10},
+     {OP_FREE | MODE(MEM_MODE_SYSTEM), 0, 0}, {OP_FREE | MODE(MEM_MODE_DEBUG), 2, 0}, {0xff, 0, 0}},
+    // 跟踪与不跟踪的块交替，跟踪关闭后释放跟踪的块
+    {{OP_ALLOC | MODE(MEM_MODE_POOL) | OP_TRACK, 0, 40}, {OP_ALLOC | KEEP, 1, 40},
+     {OP_REALLOC | KEEP | OP_TRACK, 1, 80}, {OP_REALLOC | KEEP, 0, 20},
+     {OP_ALLOC | MODE(MEM_MODE_DEBUG) | OP_TRACK, 2, 7}, {OP_FREE | KEEP, 2, 0}, {OP_FREE | KEEP | OP_TRACK, 0, 0},
+     {OP_STRDUP | KEEP | OP_TRACK, 0, 0}, {0xff, 0, 0}},
+    // 清零分配覆盖复用的块：先写满再释放，同一级别再分配
+    {{OP_ALLOC | MODE(MEM_MODE_POOL), 0, 500}, {OP_FREE | KEEP, 0, 0}, {OP_ALLOC | KEEP | OP_ZERO, 0, 500},
+     {OP_ALLOC | MODE(MEM_MODE_DEBUG) | OP_ZERO, 1, 4096},
+     {OP_ALLOC | MODE(MEM_MODE_SYSTEM) | OP_ZERO, 2, 1}, {0xff, 0, 0}},
+};
+
+int seed_allocator(int index, fuzz_buffer* out) {
+    int seeds = (int)(sizeof(allocator_seeds) / sizeof(allocator_seeds[0]));
+    if (index < seeds) {
+        for (int i = 0; allocator_seeds[index][i].op != 0xff; i++) {
+            uint8_t op = allocator_seeds[index][i].op;
+            fuzz_put_u8(out, op);
+            fuzz_put_u8(out, allocator_seeds[index][i].slot);
+            if ((op & 0x03) == OP_ALLOC || (op & 0x03) == OP_REALLOC) {
+                fuzz_put_u16(out, allocator_seeds[index][i].size);
+            } else if ((op & 0x03) == OP_STRDUP) {
+                fuzz_put_string(out, "strdup", 100);
+            }
+        }
+        return 1;
+    }
+    if (index > seeds) {
+        return 0;
+    }
+    // 内存池中大量分配与释放，每一级都用完一批以上并在槽之间交替
+    for (int i = 0; i < 2000; i++) {
+        fuzz_put_u8(out, (uint8_t)((i % 3 == 2 ? OP_FREE : OP_ALLOC) | MODE(MEM_MODE_POOL)));
+        fuzz_put_u8(out, (uint8_t)(i * 37));
+        if (i % 3 != 2) {
+            fuzz_put_u16(out, (uint16_t)(i % 1024));
+        }
+    }
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,353 @@
+/**
+ * @file fuzz_array.c
+ * @brief 数组算法的模糊测试目标：排序与qsort比较，选择与百分位数与排序后的对应元素比较，
+ *        lower_bound与逐个比较的结果比较
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz.h"
+
+/* 选项字节的低2位选择元素类型 */
+#define TYPE_MASK 0x03
+#define TYPE_INT32 0
+#define TYPE_INT64 1
+#define TYPE_UINT64 2
+#define TYPE_DOUBLE 3
+/* 选项字节的第2、3位选择取值分布 */
+#define SHAPE_SHIFT 2
+#define SHAPE_MASK 0x03
+#define SHAPE_BYTES 0         /* 输入字节本身，只有最低字节不同 */
+#define SHAPE_WIDE 1          /* 输入字节与下标散列到整个取值范围 */
+#define SHAPE_FEW 2           /* 至多4种取值，大量重复 */
+#define SHAPE_RUNS 3          /* 按输入字节递增的有序段 */
+/* 选项字节中的位：元素个数可到LARGE_COUNT，超过缓存内排序与并行的阈值 */
+#define FLAG_LARGE 0x80
+#define SMALL_COUNT 300
+#define LARGE_COUNT 65535
+/* 百分位数的个数上限，超过16个时改为整体排序 */
+#define MAX_PERCENTILES 24
+
+typedef struct {
+    int type;
+    size_t count;
+    size_t size;             /* 元素字节数 */
+    void* values;            /* 原始数组 */
+    void* sorted;            /* 参考实现排序后的数组 */
+} array_case;
+
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/* 按分布生成第i个元素的64位模式 */
+static uint64_t element_bits(int shape, const char* values, size_t len, size_t i) {
+    signed char byte = len > 0 ? (signed char)values[i % len] : 0;
+    switch (shape) {
+        case SHAPE_BYTES:
+            return (uint64_t)(int64_t)byte;
+        case SHAPE_WIDE:
+            return mix((uint64_t)(uint8_t)byte << 32 ^ i);
+        case SHAPE_FEW:
+            return (uint64_t)(int64_t)(byte % 4) << 40;
+        default:
+            return (uint64_t)(i / (len > 0 ? len : 1)) * 256 + (uint8_t)byte;
+    }
+}
+
+static int is_nan(double value) {
+    return value != value;
+}
+
+static int fill_case(array_case* c, int type, int shape, size_t count, const char* values, size_t len) {
+    c->type = type;
+    c->count = count;
+    c->size = type == TYPE_INT32 ? sizeof(int32_t) : sizeof(int64_t);
+    c->values = malloc(count * c->size + 1);
+    c->sorted = malloc(count * c->size + 1);
+    if (c->values == NULL || c->sorted == NULL) {
+        free(c->values);
+        free(c->sorted);
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint64_t bits = element_bits(shape, values, len, i);
+        if (type == TYPE_INT32) {
+            ((int32_t*)c->values)[i] = (int32_t)(uint32_t)(bits ^ bits >> 32);
+        } else if (type == TYPE_DOUBLE && shape != SHAPE_WIDE) {
+            // 整数值的double，含-0.0
+            ((double*)c->values)[i] = bits == 0 && (i & 1) ? -0.0 : (double)(int64_t)bits;
+        } else {
+            memcpy((char*)c->values + i * c->size, &bits, sizeof(bits));
+        }
+    }
+    memcpy(c->sorted, c->values, count * c->size);
+    if (type == TYPE_INT32) {
+        reference_sort_int32((int32_t*)c->sorted, count);
+    } else if (type == TYPE_INT64) {
+        reference_sort_int64((int64_t*)c->sorted, count);
+    } else if (type == TYPE_UINT64) {
+        reference_sort_uint64((uint64_t*)c->sorted, count);
+    } else {
+        reference_sort_double((double*)c->sorted, count);
+    }
+    return 1;
+}
+
+static void check_sort(const array_case* c) {
+    void* work = malloc(c->count * c->size + 1);
+    if (work == NULL) {
+        return;
+    }
+    memcpy(work, c->values, c->count * c->size);
+    error_code code;
+    if (c->type == TYPE_INT32) {
+        code = array_sort_int32((int32_t*)work, c->count);
+    } else if (c->type == TYPE_INT64) {
+        code = array_sort_int64((int64_t*)work, c->count);
+    } else if (c->type == TYPE_UINT64) {
+        code = array_sort_uint64((uint64_t*)work, c->count);
+    } else {
+        code = array_sort_double((double*)work, c->count);
+    }
+    FUZZ_CHECK(code == ERR_OK, "排序返回%s", error_code_name(code));
+    // 全序下相等的元素位模式也相同，可以逐字节比较
+    if (code == ERR_OK && memcmp(work, c->sorted, c->count * c->size) != 0) {
+        size_t i = 0;
+        while (memcmp((char*)work + i * c->size, (char*)c->sorted + i * c->size, c->size) == 0) {
+            i++;
+        }
+        FUZZ_CHECK(0, "排序结果的第%zu个元素与参考实现不同（共%zu个）", i, c->count);
+    }
+    free(work);
+}
+
+/* 第i个元素与参考结果第j个元素比较，返回负数、0或正数 */
+static int compare_at(const array_case* c, const void* data, size_t i, size_t j) {
+    if (c->type == TYPE_INT32) {
+        int32_t x = ((const int32_t*)data)[i];
+        int32_t y = ((const int32_t*)c->sorted)[j];
+        return (x > y) - (x < y);
+    }
+    if (c->type == TYPE_INT64) {
+        int64_t x = ((const int64_t*)data)[i];
+        int64_t y = ((const int64_t*)c->sorted)[j];
+        return (x > y) - (x < y);
+    }
+    if (c->type == TYPE_UINT64) {
+        uint64_t x = ((const uint64_t*)data)[i];
+        uint64_t y = ((const uint64_t*)c->sorted)[j];
+        return (x > y) - (x < y);
+    }
+    double x = ((const double*)data)[i];
+    double y = ((const double*)c->sorted)[j];
+    return (x > y) - (x < y);
+}
+
+static void check_select(const array_case* c, size_t k) {
+    void* work = malloc(c->count * c->size + 1);
+    if (work == NULL) {
+        return;
+    }
+    memcpy(work, c->values, c->count * c->size);
+    error_code code;
+    if (c->type == TYPE_INT32) {
+        code = array_select_int32((int32_t*)work, c->count, k, NULL);
+    } else if (c->type == TYPE_INT64) {
+        code = array_select_int64((int64_t*)work, c->count, k, NULL);
+    } else if (c->type == TYPE_UINT64) {
+        code = array_select_uint64((uint64_t*)work, c->count, k, NULL);
+    } else {
+        code = array_select_double((double*)work, c->count, k, NULL);
+    }
+    FUZZ_CHECK(code == ERR_OK, "选择第%zu小的元素返回%s", k, error_code_name(code));
+    if (code == ERR_OK) {
+        FUZZ_CHECK(compare_at(c, work, k, k) == 0, "第%zu小的元素与参考实现不同（共%zu个）", k, c->count);
+        for (size_t i = 0; i < c->count; i++) {
+            int order = compare_at(c, work, i, k);
+            if (i < k ? order > 0 : i > k && order < 0) {
+                FUZZ_CHECK(0, "选择第%zu小的元素后第%zu个元素在错误的一侧", k, i);
+                break;
+            }
+        }
+    }
+    free(work);
+}
+
+/* 参考秩：percentile为四分之一的整数倍，ceil(p * count / 100)可以用整数精确计算 */
+static size_t reference_rank(double percentile, size_t count) {
+    size_t quarters = (size_t)(percentile * 4.0);
+    size_t rank = (quarters * count + 399) / 400;
+    return rank < 1 ? 0 : rank - 1;
+}
+
+static void check_percentiles(const array_case* c, const double* percentiles, size_t n) {
+    void* work = malloc(c->count * c->size + 1);
+    void* results = malloc(MAX_PERCENTILES * sizeof(int64_t));
+    if (work == NULL || results == NULL) {
+        free(work);
+        free(results);
+        return;
+    }
+    memcpy(work, c->values, c->count * c->size);
+    error_code code;
+    if (c->type == TYPE_INT32) {
+        code = array_percentiles_int32((int32_t*)work, c->count, percentiles, n, (int32_t*)results);
+    } else if (c->type == TYPE_DOUBLE) {
+        code = array_percentiles_double((double*)work, c->count, percentiles, n, (double*)results);
+    } else {
+        // uint64没有百分位数接口，按int64检查
+        code = array_percentiles_int64((int64_t*)work, c->count, percentiles, n, (int64_t*)results);
+    }
+    FUZZ_CHECK(code == ERR_OK, "百分位数返回%s", error_code_name(code));
+    for (size_t i = 0; i < n && code == ERR_OK && c->type != TYPE_UINT64; i++) {
+        size_t rank = reference_rank(percentiles[i], c->count);
+        FUZZ_CHECK(compare_at(c, results, i, rank) == 0, "第%g百分位与参考实现（第%zu小）不同（共%zu个）",
+                   percentiles[i], rank, c->count);
+    }
+    free(work);
+    free(results);
+}
+
+static void check_lower_bound(const array_case* c, const char* values, size_t len) {
+    int64_t* keys64 = (int64_t*)malloc(c->count * sizeof(int64_t) + 1);
+    if (keys64 == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < c->count; i++) {
+        keys64[i] = c->type == TYPE_INT32 ? ((const int32_t*)c->sorted)[i] : ((const int64_t*)c->sorted)[i];
+    }
+    // 查找数组中的元素、相邻的值与两端之外的值
+    size_t probes = len < 32 ? len + 2 : 34;
+    for (size_t p = 0; p < probes; p++) {
+        int64_t key;
+        if (p == 0) {
+            key = c->type == TYPE_INT32 ? INT32_MIN : INT64_MIN;
+        } else if (p == 1) {
+            key = c->type == TYPE_INT32 ? INT32_MAX : INT64_MAX;
+        } else {
+            uint8_t byte = (uint8_t)values[p - 2];
+            key = c->count > 0 ? keys64[(byte * 7919u) % c->count] : byte;
+            key += (int64_t)(byte % 3) - 1;
+        }
+        size_t expected = reference_lower_bound_int64(keys64, c->count, key);
+        size_t actual;
+        if (c->type == TYPE_INT32) {
+            int32_t key32 = key < INT32_MIN ? INT32_MIN : key > INT32_MAX ? INT32_MAX : (int32_t)key;
+            expected = reference_lower_bound_int64(keys64, c->count, key32);
+            actual = array_lower_bound_int32((const int32_t*)c->sorted, c->count, key32);
+        } else {
+            actual = array_lower_bound_int64((const int64_t*)c->sorted, c->count, key);
+        }
+        FUZZ_CHECK(actual == expected, "lower_bound(%lld)返回%zu，应为%zu（共%zu个）", (long long)key, actual,
+                   expected, c->count);
+    }
+    free(keys64);
+}
+
+/* 错误参数：秩越界、百分位数越界或为NaN */
+static void check_errors(const array_case* c) {
+    if (c->type != TYPE_INT64 || c->count == 0) {
+        return;
+    }
+    int64_t* work = (int64_t*)malloc(c->count * sizeof(int64_t));
+    if (work == NULL) {
+        return;
+    }
+    memcpy(work, c->values, c->count * sizeof(int64_t));
+    error_code code = array_select_int64(work, c->count, c->count, NULL);
+    FUZZ_CHECK(code == ERR_ARRAY_RANGE, "秩等于元素个数时返回%s", error_code_name(code));
+    double bad[] = {100.5, -1.0, 0.0 / 0.0};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        int64_t result;
+        code = array_percentiles_int64(work, c->count, &bad[i], 1, &result);
+        FUZZ_CHECK(code == ERR_ARRAY_RANGE, "百分位数%g返回%s", bad[i], error_code_name(code));
+    }
+    free(work);
+}
+
+void fuzz_array(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    size_t count = fuzz_consume_u16(&in) % ((flags & FLAG_LARGE ? LARGE_COUNT : SMALL_COUNT) + 1);
+    size_t k = fuzz_consume_u16(&in);
+    size_t n = fuzz_consume_u8(&in) % (MAX_PERCENTILES + 1);
+    double percentiles[MAX_PERCENTILES];
+    for (size_t i = 0; i < n; i++) {
+        percentiles[i] = (fuzz_consume_u16(&in) % 401) / 4.0;
+    }
+    char* values = fuzz_consume_string(&in);
+    if (values == NULL) {
+        return;
+    }
+    size_t len = strlen(values);
+    int type = flags & TYPE_MASK;
+    array_case c;
+    if (!fill_case(&c, type, (flags >> SHAPE_SHIFT) & SHAPE_MASK, count, values, len)) {
+        free(values);
+        return;
+    }
+    check_sort(&c);
+    if (type == TYPE_DOUBLE) {
+        // 选择与百分位数要求没有NaN
+        for (size_t i = 0; i < count; i++) {
+            if (is_nan(((double*)c.values)[i])) {
+                ((double*)c.values)[i] = (double)i;
+            }
+        }
+        memcpy(c.sorted, c.values, count * c.size);
+        reference_sort_double((double*)c.sorted, count);
+    }
+    if (count > 0) {
+        check_select(&c, k % count);
+        if (n > 0) {
+            check_percentiles(&c, percentiles, n);
+        }
+    }
+    if (type == TYPE_INT32 || type == TYPE_INT64) {
+        check_lower_bound(&c, values, len);
+    }
+    check_errors(&c);
+    free(c.values);
+    free(c.sorted);
+    free(values);
+}
+
+/* 边界用例：{选项字节, 元素个数, 秩, 百分位数个数} */
+static const struct {
+    uint8_t flags;
+    uint16_t count;
+    uint16_t k;
+    uint8_t percentiles;
+} array_seeds[] = {
+    {TYPE_INT64, 0, 0, 0},
+    {TYPE_INT32, 1, 0, 1},
+    {TYPE_INT32 | SHAPE_WIDE << SHAPE_SHIFT, 32, 31, 3},                      // 插入排序的上限
+    {TYPE_INT64 | SHAPE_WIDE << SHAPE_SHIFT, 33, 16, 5},
+    {TYPE_UINT64 | SHAPE_FEW << SHAPE_SHIFT, 300, 150, 2},                    // 大量重复
+    {TYPE_DOUBLE | SHAPE_WIDE << SHAPE_SHIFT, 300, 7, 17},                    // 含NaN与无穷，整体排序
+    {TYPE_DOUBLE | SHAPE_BYTES << SHAPE_SHIFT, 300, 299, 4},                  // 含-0.0
+    {TYPE_INT64 | SHAPE_BYTES << SHAPE_SHIFT | FLAG_LARGE, 8193, 4096, 3},    // 超过缓存内排序的阈值
+    {TYPE_INT32 | SHAPE_WIDE << SHAPE_SHIFT | FLAG_LARGE, 65535, 1000, 6},    // 分桶后桶仍较大
+    {TYPE_INT64 | SHAPE_RUNS << SHAPE_SHIFT | FLAG_LARGE, 20000, 19999, 2},   // 基本有序
+    {TYPE_DOUBLE | SHAPE_FEW << SHAPE_SHIFT | FLAG_LARGE, 30000, 1, 24},
+    {TYPE_UINT64 | SHAPE_WIDE << SHAPE_SHIFT | FLAG_LARGE, 40000, 20000, 1},  // 超过样本选择的阈值
+};
+
+int seed_array(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(array_seeds) / sizeof(array_seeds[0]))) {
+        return 0;
+    }
+    fuzz_put_u8(out, array_seeds[index].flags);
+    fuzz_put_u16(out, array_seeds[index].count);
+    fuzz_put_u16(out, array_seeds[index].k);
+    fuzz_put_u8(out, array_seeds[index].percentiles);
+    static const uint16_t percentiles[] = {200, 396, 0, 400, 399, 4, 1, 100, 300, 360, 397, 398};
+    for (uint8_t i = 0; i < array_seeds[index].percentiles; i++) {
+        fuzz_put_u16(out, percentiles[i % (sizeof(percentiles) / sizeof(percentiles[0]))]);
+    }
+    fuzz_put_string(out, "\x05\xfb\x7f\x80\x01\x02\x03\x10\xf0\x33", 1);
+    return 1;
+}
\ No newline at end of file
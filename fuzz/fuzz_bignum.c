@@ -0,0 +1,279 @@
+/**
+ * @file fuzz_bignum.c
+ * @brief 大整数的模糊测试目标：十进制往返、模2^61-1的同余、除法恒等式，较短时与朴素乘法比较精确乘积
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz.h"
+#include "../include/bignum_ops.h"
+#include "../include/allocator.h"
+
+/* 选项字节中的位：第一个数为负 */
+#define FLAG_A_NEGATIVE 0x80
+/* 选项字节中的位：第二个数为负 */
+#define FLAG_B_NEGATIVE 0x40
+/* 选项字节中的位：非负数带'+'号 */
+#define FLAG_PLUS_SIGN 0x20
+/* 选项字节中的位：在第一个数的数字之后插入非数字字符，解析应失败 */
+#define FLAG_INVALID 0x10
+/* 数字个数的上限，超过数论变换乘法与牛顿迭代除法的阈值 */
+#define MAX_DIGITS 100000
+/* 两个数都不超过该位数时与参考实现比较精确乘积 */
+#define EXACT_DIGITS 2000
+/* 阶乘参数的上限 */
+#define MAX_FACTORIAL 4000
+/* 同余检查的模数2^61-1 */
+#define RESIDUE_MODULUS ((1ULL << 61) - 1)
+
+static const char invalid_chars[] = "x.-+ e";
+
+static uint64_t residue_mul(uint64_t a, uint64_t b) {
+    unsigned __int128 product = (unsigned __int128)a * b;
+    uint64_t value = (uint64_t)(product & RESIDUE_MODULUS) + (uint64_t)(product >> 61);
+    return value >= RESIDUE_MODULUS ? value - RESIDUE_MODULUS : value;
+}
+
+static uint64_t residue_add(uint64_t a, uint64_t b) {
+    uint64_t value = a + b;
+    return value >= RESIDUE_MODULUS ? value - RESIDUE_MODULUS : value;
+}
+
+static uint64_t residue_neg(uint64_t a) {
+    return a == 0 ? 0 : RESIDUE_MODULUS - a;
+}
+
+/* 十进制文本（可带符号）模2^61-1的余数 */
+static uint64_t text_residue(const char* text) {
+    int negative = *text == '-';
+    text += *text == '-' || *text == '+';
+    uint64_t value = 0;
+    for (; *text != '\0'; text++) {
+        value = residue_add(residue_mul(value, 10), (uint64_t)(*text - '0'));
+    }
+    return negative ? residue_neg(value) : value;
+}
+
+/* 去掉前导零与'+'号，0不带符号 */
+static char* canonical_text(const char* text) {
+    int negative = *text == '-';
+    text += *text == '-' || *text == '+';
+    while (text[0] == '0' && text[1] != '\0') {
+        text++;
+    }
+    negative = negative && text[0] != '0';
+    size_t len = strlen(text);
+    char* result = (char*)malloc(len + 2);
+    if (result != NULL) {
+        result[0] = '-';
+        memcpy(result + negative, text, len + 1);
+    }
+    return result;
+}
+
+/* 把字节映射为数字并加上符号，数字为空时为"0" */
+static char* make_operand(char* raw, int negative, int plus) {
+    size_t len = strlen(raw);
+    if (len > MAX_DIGITS) {
+        len = MAX_DIGITS;
+    }
+    char* text = (char*)malloc(len + 3);
+    if (text == NULL) {
+        return NULL;
+    }
+    size_t pos = 0;
+    if (negative || plus) {
+        text[pos++] = negative ? '-' : '+';
+    }
+    for (size_t i = 0; i < len; i++) {
+        text[pos++] = (char)('0' + (unsigned char)(raw[i] - '0') % 10);
+    }
+    if (len == 0) {
+        text[pos++] = '0';
+    }
+    text[pos] = '\0';
+    return text;
+}
+
+/* 检查x转换为文本的结果没有前导零、0不带符号，并返回其模2^61-1的余数 */
+static uint64_t check_residue(const bignum* x, const char* what) {
+    char* text = NULL;
+    size_t len = 0;
+    if (bignum_to_string(x, &text, &len) != ERR_OK) {
+        return 0;
+    }
+    const char* digits = text + (text[0] == '-');
+    FUZZ_CHECK(len == strlen(text) && digits[0] >= '0' && digits[0] <= '9' && (digits[0] != '0' || len == 1),
+               "%s的文本不规范：\"%.40s\"", what, text);
+    uint64_t value = text_residue(text);
+    mem_free(text);
+    return value;
+}
+
+static void check_text(const bignum* x, const char* expected, const char* what) {
+    char* text = NULL;
+    if (bignum_to_string(x, &text, NULL) != ERR_OK) {
+        return;
+    }
+    FUZZ_CHECK(strcmp(text, expected) == 0, "%s为\"%.40s\"（%zu位），应为\"%.40s\"（%zu位）", what, text,
+               strlen(text), expected, strlen(expected));
+    mem_free(text);
+}
+
+static void check_invalid(const char* text, uint16_t where, uint8_t which) {
+    size_t len = strlen(text);
+    size_t first = (size_t)(text[0] == '-' || text[0] == '+') + 1;
+    size_t pos = first + where % (len - first + 1);
+    char* bad = (char*)malloc(len + 2);
+    if (bad == NULL) {
+        return;
+    }
+    memcpy(bad, text, pos);
+    bad[pos] = invalid_chars[which % (sizeof(invalid_chars) - 1)];
+    memcpy(bad + pos + 1, text + pos, len - pos);
+    bignum x;
+    bignum_init(&x);
+    error_code code = bignum_from_string(&x, bad, len + 1);
+    FUZZ_CHECK(code == ERR_BIGNUM_INVALID, "在第%zu个字符处插入'%c'后解析返回%s", pos, bad[pos],
+               error_code_name(code));
+    bignum_free(&x);
+    free(bad);
+}
+
+static void check_divmod(const bignum* a, const bignum* b) {
+    bignum q, r, check;
+    bignum_init(&q);
+    bignum_init(&r);
+    bignum_init(&check);
+    error_code code = bignum_divmod(&q, &r, a, b);
+    if (b->size == 0) {
+        FUZZ_CHECK(code == ERR_BIGNUM_DIVIDE_BY_ZERO, "除数为0时返回%s", error_code_name(code));
+    } else if (code == ERR_OK && bignum_mul(&check, &q, b) == ERR_OK && bignum_add(&check, &check, &r) == ERR_OK) {
+        FUZZ_CHECK(bignum_compare(&check, a) == 0, "商乘除数加余数不等于被除数（%zu个limb除以%zu个limb）", a->size,
+                   b->size);
+        bignum abs_r = r;
+        bignum abs_b = *b;
+        abs_r.negative = 0;
+        abs_b.negative = 0;
+        FUZZ_CHECK(bignum_compare(&abs_r, &abs_b) < 0, "余数的绝对值不小于除数（%zu个limb除以%zu个limb）", a->size,
+                   b->size);
+        FUZZ_CHECK(r.size == 0 || r.negative == a->negative, "余数与被除数不同号");
+    }
+    bignum_free(&q);
+    bignum_free(&r);
+    bignum_free(&check);
+}
+
+static void check_factorial(uint32_t n) {
+    bignum f;
+    bignum_init(&f);
+    if (bignum_factorial(&f, n) == ERR_OK) {
+        uint64_t expected = 1;
+        for (uint32_t i = 2; i <= n; i++) {
+            expected = residue_mul(expected, i);
+        }
+        FUZZ_CHECK(check_residue(&f, "阶乘") == expected, "%u!模2^61-1的余数不正确", n);
+    }
+    bignum_free(&f);
+}
+
+void fuzz_bignum(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    uint16_t extra = fuzz_consume_u16(&in);
+    char* raw_a = fuzz_consume_string(&in);
+    char* raw_b = fuzz_consume_string(&in);
+    char* a_text = raw_a != NULL ? make_operand(raw_a, flags & FLAG_A_NEGATIVE, flags & FLAG_PLUS_SIGN) : NULL;
+    char* b_text = raw_b != NULL ? make_operand(raw_b, flags & FLAG_B_NEGATIVE, flags & FLAG_PLUS_SIGN) : NULL;
+    char* a_canonical = a_text != NULL ? canonical_text(a_text) : NULL;
+    free(raw_a);
+    free(raw_b);
+    bignum a, b, x;
+    bignum_init(&a);
+    bignum_init(&b);
+    bignum_init(&x);
+    if (a_text == NULL || b_text == NULL || a_canonical == NULL ||
+        bignum_from_string(&a, a_text, strlen(a_text)) != ERR_OK ||
+        bignum_from_string(&b, b_text, strlen(b_text)) != ERR_OK) {
+        goto cleanup;
+    }
+
+    check_text(&a, a_canonical, "往返转换");
+    if (flags & FLAG_INVALID) {
+        check_invalid(a_text, extra, flags);
+    }
+
+    uint64_t ra = text_residue(a_text);
+    uint64_t rb = text_residue(b_text);
+    if (bignum_add(&x, &a, &b) == ERR_OK) {
+        FUZZ_CHECK(check_residue(&x, "和") == residue_add(ra, rb), "和模2^61-1的余数不正确");
+    }
+    if (bignum_sub(&x, &a, &b) == ERR_OK) {
+        FUZZ_CHECK(check_residue(&x, "差") == residue_add(ra, residue_neg(rb)), "差模2^61-1的余数不正确");
+    }
+    if (bignum_mul(&x, &a, &b) == ERR_OK) {
+        FUZZ_CHECK(check_residue(&x, "积") == residue_mul(ra, rb), "积模2^61-1的余数不正确（%zu个limb乘%zu个limb）",
+                   a.size, b.size);
+        if (strlen(a_text) <= EXACT_DIGITS && strlen(b_text) <= EXACT_DIGITS) {
+            char* expected = reference_bignum_multiply(a_text, b_text);
+            if (expected != NULL) {
+                check_text(&x, expected, "积");
+                free(expected);
+            }
+        }
+    }
+    // 输出与输入是同一个对象
+    if (bignum_copy(&x, &a) == ERR_OK && bignum_mul(&x, &x, &x) == ERR_OK) {
+        FUZZ_CHECK(check_residue(&x, "平方") == residue_mul(ra, ra), "平方模2^61-1的余数不正确（%zu个limb）",
+                   a.size);
+    }
+    check_divmod(&a, &b);
+    check_divmod(&b, &a);
+    if ((extra & 0xff) == 0) {
+        check_factorial((uint32_t)(extra >> 8) * MAX_FACTORIAL / 256);
+    }
+
+cleanup:
+    bignum_free(&a);
+    bignum_free(&b);
+    bignum_free(&x);
+    free(a_text);
+    free(b_text);
+    free(a_canonical);
+}
+
+/* 边界用例：{第一个数的片段, 重复次数, 第二个数的片段, 重复次数, 选项字节} */
+static const struct {
+    const char* a;
+    unsigned int a_repeat;
+    const char* b;
+    unsigned int b_repeat;
+    uint8_t flags;
+} bignum_seeds[] = {
+    {"0", 1, "0", 1, 0},
+    {"0", 1, "0", 1, FLAG_A_NEGATIVE | FLAG_B_NEGATIVE},      // -0
+    {"", 1, "7", 1, FLAG_PLUS_SIGN},
+    {"18446744073709551615", 1, "1", 1, 0},                    // 2^64 - 1
+    {"18446744073709551616", 1, "18446744073709551615", 1, FLAG_B_NEGATIVE},
+    {"18446744073709551617", 1, "3", 1, FLAG_A_NEGATIVE},
+    {"10000000000000000000", 1, "9999999999999999999", 1, 0},  // 10^19附近
+    {"000000000000000000000000000001", 1, "1", 1, FLAG_PLUS_SIGN},
+    {"9", 600, "9", 300, 0},                                   // 除法结果全为9
+    {"1", 1, "0", 1, 0},
+    {"123", 1, "", 1, FLAG_INVALID},
+    {"9", 25000, "9", 24000, 0},                               // 超过数论变换与牛顿迭代的阈值
+    {"1234567890", 10000, "987654321", 3000, FLAG_A_NEGATIVE},
+    {"1", 1, "31415926535897932384626433832795", 3000, FLAG_B_NEGATIVE},
+    {"10", 1, "0", 100000, FLAG_INVALID},
+};
+
+int seed_bignum(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(bignum_seeds) / sizeof(bignum_seeds[0]))) {
+        return 0;
+    }
+    fuzz_put_u8(out, bignum_seeds[index].flags);
+    // 低8位为0时检查阶乘
+    fuzz_put_u16(out, (uint16_t)(index * 37 << 8));
+    fuzz_put_string(out, bignum_seeds[index].a, bignum_seeds[index].a_repeat);
+    fuzz_put_string(out, bignum_seeds[index].b, bignum_seeds[index].b_repeat);
+    return 1;
+}
\ No newline at end of file
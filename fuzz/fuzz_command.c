@@ -0,0 +1,188 @@
+/**
+ * @file fuzz_command.c
+ * @brief 批处理模式的模糊测试目标：把一串命令行写入临时文件，经command_run_batch执行，
+ *        与按换行符切分后逐行调用command_execute的参考结果比较；超过COMMAND_MAX_LINE的行
+ *        无论在缓冲区扩大前还是扩大后读到换行符，都只得到一个ERR_COMMAND_LINE_TOO_LONG
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "fuzz.h"
+#include "../include/command.h"
+#include "../include/utils.h"
+
+/* 一个输入最多的行数 */
+#define MAX_LINES 32
+/* 命令输入的总长度上限 */
+#define MAX_INPUT (8u << 20)
+
+/* 行字节的低4位选择命令名，第4位表示这是最后一行且没有换行符，高3位为参数重复的次数（0表示没有参数） */
+#define LINE_NAME(op) ((op) & 0x0f)
+#define LINE_FINAL 0x10
+#define LINE_REPEAT(op) ((op) >> 5)
+
+/* 只选不读写文件的命令；" upper"比"upper"长一个字节，用于构造恰好超过上限的行 */
+static const char* const command_names[16] = {
+    "upper", "lower", "reverse", "add", "subtract", "gcd", "divide", "factorial",
+    "fibonacci", "ping", "quit", "#", "", " upper", "\tlower", "nosuch",
+};
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t capacity;
+} text_buffer;
+
+static int text_append(text_buffer* b, const char* data, size_t len) {
+    if (len == 0) {
+        return 1;
+    }
+    if (b->len + len > b->capacity) {
+        size_t capacity = b->capacity > 0 ? b->capacity : 4096;
+        while (capacity < b->len + len) {
+            capacity *= 2;
+        }
+        char* grown = (char*)realloc(b->data, capacity);
+        if (grown == NULL) {
+            return 0;
+        }
+        b->data = grown;
+        b->capacity = capacity;
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+    return 1;
+}
+
+/* 参考实现：按换行符切分，过长的行只输出错误，收到quit后停止 */
+static int reference_batch(const char* input, size_t len, text_buffer* expected) {
+    command_buffer out;
+    command_buffer_init(&out);
+    int ok = 1;
+    size_t start = 0;
+    while (ok && start < len) {
+        const char* newline = (const char*)memchr(input + start, '\n', len - start);
+        size_t line_len = newline != NULL ? (size_t)(newline - (input + start)) : len - start;
+        if (line_len > COMMAND_MAX_LINE) {
+            char error[64];
+            int n = snprintf(error, sizeof(error), "ERR %d %s\n", ERR_COMMAND_LINE_TOO_LONG,
+                             error_code_name(ERR_COMMAND_LINE_TOO_LONG));
+            ok = text_append(expected, error, (size_t)n);
+        } else {
+            out.len = 0;
+            int status = command_execute(input + start, line_len, &out);
+            ok = status >= 0 && text_append(expected, out.data, out.len);
+            if (status == 0) {
+                break;
+            }
+        }
+        start += line_len + 1;
+    }
+    command_buffer_free(&out);
+    return ok;
+}
+
+/* 把文本写入临时文件并回到开头，返回文件描述符 */
+static int temp_fd(const char* data, size_t len) {
+    FILE* file = tmpfile();
+    FUZZ_CHECK(file != NULL, "无法创建临时文件");
+    int fd = dup(fileno(file));
+    fclose(file);
+    FUZZ_CHECK(fd >= 0 && (len == 0 || write(fd, data, len) == (ssize_t)len) && lseek(fd, 0, SEEK_SET) == 0,
+               "无法写入临时文件");
+    return fd;
+}
+
+void fuzz_command(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    text_buffer input = {NULL, 0, 0};
+    for (int lines = 0; lines < MAX_LINES && in.pos < in.size; lines++) {
+        uint8_t op = fuzz_consume_u8(&in);
+        const char* name = command_names[LINE_NAME(op)];
+        int repeat = LINE_REPEAT(op);
+        char* arg = repeat > 0 ? fuzz_consume_string(&in) : NULL;
+        size_t arg_len = arg != NULL ? strlen(arg) : 0;
+        size_t line_len = strlen(name) + (repeat > 0 ? 1 + arg_len * (size_t)repeat : 0);
+        if (input.len + line_len + 1 > MAX_INPUT) {
+            free(arg);
+            break;
+        }
+        int ok = text_append(&input, name, strlen(name));
+        if (repeat > 0) {
+            ok = ok && text_append(&input, " ", 1);
+            for (int i = 0; i < repeat; i++) {
+                ok = ok && text_append(&input, arg, arg_len);
+            }
+        }
+        free(arg);
+        FUZZ_CHECK(ok, "内存分配失败");
+        if (op & LINE_FINAL) {
+            break;
+        }
+        FUZZ_CHECK(text_append(&input, "\n", 1), "内存分配失败");
+    }
+
+    text_buffer expected = {NULL, 0, 0};
+    FUZZ_CHECK(reference_batch(input.data, input.len, &expected), "参考实现内存分配失败");
+
+    int in_fd = temp_fd(input.data, input.len);
+    int out_fd = temp_fd(NULL, 0);
+    FUZZ_CHECK(command_run_batch(in_fd, out_fd) == 1, "command_run_batch失败");
+    struct stat st;
+    FUZZ_CHECK(fstat(out_fd, &st) == 0, "无法获取输出文件信息");
+    size_t actual_len = (size_t)st.st_size;
+    char* actual = (char*)malloc(actual_len + 1);
+    FUZZ_CHECK(actual != NULL && pread(out_fd, actual, actual_len, 0) == (ssize_t)actual_len, "无法读取输出文件");
+    close(in_fd);
+    close(out_fd);
+
+    size_t diff = 0;
+    while (diff < actual_len && diff < expected.len && actual[diff] == expected.data[diff]) {
+        diff++;
+    }
+    FUZZ_CHECK(actual_len == expected.len && diff == actual_len,
+               "批处理输出与逐行执行不同：输入%zu字节，输出%zu字节，应为%zu字节，第%zu字节起不同",
+               input.len, actual_len, expected.len, diff);
+    free(actual);
+    free(expected.data);
+    free(input.data);
+}
+
+/* 边界用例：{行字节, 参数片段, 片段重复次数} 的序列，以行字节0xff结束 */
+static const struct {
+    uint8_t op;
+    const char* chunk;
+    uint16_t repeat;
+} command_seeds[][6] = {
+    // 普通命令、注释、空行与未知命令
+    {{0x20, "hello", 1}, {0x23, "2147483647 1", 1}, {0x2b, " comment", 1}, {0x0c, NULL, 0},
+     {0x2f, "x", 3}, {0xff, NULL, 0}},
+    // 恰好COMMAND_MAX_LINE字节的行照常执行："upper "加上5个209714字节的参数
+    {{0xa0, "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJ", 4559}, {0x09, NULL, 0}, {0xff, NULL, 0}},
+    // 超过上限一个字节的行
+    {{0xad, "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJ", 4559}, {0x09, NULL, 0}, {0xff, NULL, 0}},
+    // 1到2MiB之间、在缓冲区扩大前就读到换行符的行，之后的命令照常执行
+    {{0x60, "xxxxxxxxxx", 50000}, {0x20, "ab", 1}, {0xff, NULL, 0}},
+    // 超过缓冲区、转为丢弃模式的行，以及没有换行符的过长的最后一行
+    {{0xe1, "yyyyyyyyyy", 44500}, {0x20, "cd", 1}, {0x70, "zzzzzzzzzz", 60000}, {0xff, NULL, 0}},
+    // quit之后的行不执行，包括过长的行
+    {{0x09, NULL, 0}, {0x0a, NULL, 0}, {0x60, "qqqqqqqqqqqqqqqqqqqq", 60000}, {0x20, "ef", 1}, {0xff, NULL, 0}},
+};
+
+int seed_command(int index, fuzz_buffer* out) {
+    int seeds = (int)(sizeof(command_seeds) / sizeof(command_seeds[0]));
+    if (index >= seeds) {
+        return 0;
+    }
+    for (int i = 0; command_seeds[index][i].op != 0xff; i++) {
+        uint8_t op = command_seeds[index][i].op;
+        fuzz_put_u8(out, op);
+        if (LINE_REPEAT(op) > 0) {
+            fuzz_put_string(out, command_seeds[index][i].chunk, command_seeds[index][i].repeat);
+        }
+    }
+    return 1;
+}
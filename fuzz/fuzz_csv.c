@@ -0,0 +1,207 @@
+/**
+ * @file fuzz_csv.c
+ * @brief CSV列式读取的模糊测试目标：与逐字符拆分的参考实现比较字段、类型推断与列数组
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "fuzz.h"
+#include "../include/csv_ops.h"
+
+/* 选项字节中的位：把输入字符映射到CSV结构字符较多的字母表 */
+#define FLAG_CSV_ALPHABET 0x80
+/* 选项字节中的位：第一行不是列名 */
+#define FLAG_NO_HEADER 0x40
+/* 选项字节的低2位选择分隔符 */
+#define DELIMITER_MASK 0x03
+/* 正文重复次数的上限，重复后可超过分段并行解析的阈值 */
+#define MAX_BODY_REPEAT 8
+
+static const char csv_alphabet[] = "0123456789,;\t|\"\"\n\n\r .-eEabnx";
+static const char delimiters[] = {',', ';', '\t', '|'};
+
+/* 参考的类型推断：全部是整数为int64，全部是数值或空为double，否则为string */
+static int is_decimal(const char* s) {
+    const char* p = s + (*s == '-' || *s == '+');
+    if (strcasecmp(p, "inf") == 0 || strcasecmp(p, "infinity") == 0 || strcasecmp(p, "nan") == 0) {
+        return 1;
+    }
+    size_t digits = 0;
+    while (*p >= '0' && *p <= '9') {
+        p++;
+        digits++;
+    }
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') {
+            p++;
+            digits++;
+        }
+    }
+    if (digits == 0) {
+        return 0;
+    }
+    if (*p == 'e' || *p == 'E') {
+        const char* exponent = p + 1 + (p[1] == '-' || p[1] == '+');
+        if (*exponent >= '0' && *exponent <= '9') {
+            p = exponent;
+            while (*p >= '0' && *p <= '9') {
+                p++;
+            }
+        }
+    }
+    return *p == '\0';
+}
+
+static csv_type infer_type(char** fields, int columns, size_t first_row, size_t rows, int column) {
+    csv_type type = CSV_INT64;
+    for (size_t r = 0; r < rows; r++) {
+        const char* field = fields[(first_row + r) * (size_t)columns + (size_t)column];
+        int64_t value;
+        size_t used = 0;
+        if (type == CSV_INT64 &&
+            !(reference_parse_int64(field, strlen(field), &value, &used) == ERR_OK && used == strlen(field))) {
+            type = CSV_DOUBLE;
+        }
+        if (type == CSV_DOUBLE && field[0] != '\0' && !is_decimal(field)) {
+            return CSV_STRING;
+        }
+    }
+    return type;
+}
+
+static int same_double(double a, double b) {
+    return (a != a && b != b) || memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static void check_column(const csv_column* column, char** fields, int columns, size_t first_row, size_t rows,
+                         int j) {
+    csv_type expected = infer_type(fields, columns, first_row, rows, j);
+    FUZZ_CHECK(column->type == expected, "第%d列的类型为%s，应为%s", j, csv_type_name(column->type),
+               csv_type_name(expected));
+    for (size_t r = 0; r < rows; r++) {
+        const char* field = fields[(first_row + r) * (size_t)columns + (size_t)j];
+        if (expected == CSV_INT64) {
+            FUZZ_CHECK(column->ints[r] == strtoll(field, NULL, 10), "第%zu行第%d列为%lld，文本为\"%s\"", r, j,
+                       (long long)column->ints[r], field);
+        } else if (expected == CSV_DOUBLE) {
+            double value = field[0] != '\0' ? strtod(field, NULL) : __builtin_nan("");
+            FUZZ_CHECK(same_double(column->doubles[r], value), "第%zu行第%d列为%a，文本为\"%s\"", r, j,
+                       column->doubles[r], field);
+        } else {
+            FUZZ_CHECK(strcmp(column->text + column->offsets[r], field) == 0, "第%zu行第%d列为\"%s\"，应为\"%s\"",
+                       r, j, column->text + column->offsets[r], field);
+        }
+    }
+}
+
+void fuzz_csv(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    int repeat = fuzz_consume_u8(&in) % MAX_BODY_REPEAT + 1;
+    char* head = fuzz_consume_string(&in);
+    char* body = fuzz_consume_string(&in);
+    if (head == NULL || body == NULL) {
+        free(head);
+        free(body);
+        return;
+    }
+    size_t head_len = strlen(head);
+    size_t body_len = strlen(body);
+    size_t len = head_len + body_len * (size_t)repeat;
+    char* text = (char*)malloc(len > 0 ? len : 1);
+    if (text == NULL) {
+        free(head);
+        free(body);
+        return;
+    }
+    memcpy(text, head, head_len);
+    for (int i = 0; i < repeat; i++) {
+        memcpy(text + head_len + body_len * (size_t)i, body, body_len);
+    }
+    free(head);
+    free(body);
+    if (flags & FLAG_CSV_ALPHABET) {
+        for (size_t i = 0; i < len; i++) {
+            text[i] = csv_alphabet[(unsigned char)text[i] % (sizeof(csv_alphabet) - 1)];
+        }
+    }
+
+    csv_options options = csv_default_options();
+    options.delimiter = delimiters[flags & DELIMITER_MASK];
+    options.has_header = !(flags & FLAG_NO_HEADER);
+    csv_table* table = NULL;
+    error_code code = csv_parse_buffer(text, len, &options, &table);
+
+    char** fields = NULL;
+    size_t field_count = 0;
+    int columns = 0;
+    error_code expected = reference_csv_split(text, len, options.delimiter, &fields, &field_count, &columns);
+    if (code == ERR_CSV_ALLOC || expected == ERR_CSV_ALLOC) {
+        csv_free_table(table);
+        reference_free_fields(fields, field_count);
+        free(text);
+        return;
+    }
+    FUZZ_CHECK(code == expected, "csv_parse_buffer返回%s，参考实现返回%s", error_code_name(code),
+               error_code_name(expected));
+    if (code == ERR_OK) {
+        size_t first_row = columns > 0 && options.has_header ? 1 : 0;
+        size_t rows = columns > 0 ? field_count / (size_t)columns - first_row : 0;
+        FUZZ_CHECK(table->column_count == columns && table->row_count == rows, "表为%d列%zu行，应为%d列%zu行",
+                   table->column_count, table->row_count, columns, rows);
+        for (int j = 0; j < columns; j++) {
+            const char* name = options.has_header ? fields[j] : NULL;
+            FUZZ_CHECK(name == NULL || strcmp(table->columns[j].name, name) == 0, "第%d列的列名为\"%s\"，应为\"%s\"",
+                       j, table->columns[j].name, name);
+            check_column(&table->columns[j], fields, columns, first_row, rows, j);
+        }
+    }
+    csv_free_table(table);
+    reference_free_fields(fields, field_count);
+    free(text);
+}
+
+/* 边界用例：{首部, 正文片段, 片段重复次数, 正文重复次数} */
+static const struct {
+    const char* head;
+    const char* body;
+    unsigned int body_repeat;
+    int repeat;
+} csv_seeds[] = {
+    {"", "", 1, 1},
+    {"a,b,c\n", "1,2,3\n", 1, 1},
+    {"a,b\r\n", "1,x\r\n\r\n2,\"y\"\r\n", 1, 1},
+    {"a,b\n", "1,\"q,\n\"\"r\"\"\"\n", 1, 1},
+    {"a,b\n", "1,2\n3\n", 1, 1},                     // 字段数不同
+    {"a,b\n", "1,2,3\n", 1, 1},
+    {"a,b\n", "1,\"x\n", 1, 1},                      // 引号不成对
+    {"a,b\n", "1,x\"y\n", 1, 1},
+    {"a,b\n", "1,\"x\"y\n", 1, 1},
+    {"a\n", "\n\n7\n\n", 1, 1},
+    {"n,v\n", "1,2.5\n2,\n3,inf\n", 1, 1},          // 空字段使整数列变为浮点列
+    {"n\n", "9223372036854775807\n9223372036854775808\n", 1, 1},
+    {"\"h,1\",\"h\"\"2\"\n", "\"1\",\"2\"\n", 1, 1},
+    {"a,b,c\n", "1,2,3", 1, 1},                      // 最后一行没有换行
+    {"a,b,c\n", "12,-7,hello world\n", 5000, 8},     // 超过并行阈值
+    {"a,b\n", "1,\"multi\nline, quoted\"\n", 3000, 8},  // 引号内的换行跨过分段边界
+    {"a,b\n", "-1,2.5e3\n", 9000, 8},
+    {"a,b\n", "1,\"long", 1, 1},
+    {"a,b\n", "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx",
+     12000, 2},                                      // 跨过多个分块的一行
+};
+
+int seed_csv(int index, fuzz_buffer* out) {
+    int count = (int)(sizeof(csv_seeds) / sizeof(csv_seeds[0]));
+    if (index >= count * 2) {
+        return 0;
+    }
+    // 第二轮不把第一行作为列名，并使用分号分隔（不是分隔符的逗号成为普通字符）
+    int seed = index % count;
+    fuzz_put_u8(out, index < count ? 0 : FLAG_NO_HEADER | 1);
+    fuzz_put_u8(out, (uint8_t)(csv_seeds[seed].repeat - 1));
+    fuzz_put_string(out, csv_seeds[seed].head, 1);
+    fuzz_put_string(out, csv_seeds[seed].body, csv_seeds[seed].body_repeat);
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+/**
+ * @file fuzz_fingerprint.c
+ * @brief 编辑距离、Hamming距离、Rabin-Karp查找与内容定义分块的模糊测试目标
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz.h"
+#include "../include/fingerprint_ops.h"
+#include "../include/allocator.h"
+
+/* 选项字节中的位：第二个字符串由第一个字符串经少量编辑得到，覆盖带状算法的小距离路径 */
+#define FLAG_EDIT_SCRIPT 0x80
+/* 编辑距离参考实现为O(m * n)，输入截短到该长度 */
+#define MAX_EDIT_LENGTH 1500
+/* Rabin-Karp与分块输入的最大长度 */
+#define MAX_SCAN_LENGTH (64 << 10)
+
+/* 第二个字符串由编辑脚本生成：每3个字节为一次编辑{类型, 位置, 字符} */
+static char* apply_edits(const char* str, fuzz_input* in) {
+    size_t len = strlen(str);
+    int edits = fuzz_consume_u8(in) % 32;
+    char* out = (char*)malloc(len + (size_t)edits + 1);
+    if (out == NULL) {
+        return NULL;
+    }
+    memcpy(out, str, len + 1);
+    for (int e = 0; e < edits; e++) {
+        uint8_t kind = fuzz_consume_u8(in) % 3;
+        size_t pos = len > 0 ? fuzz_consume_u16(in) % (len + (kind == 0)) : 0;
+        char c = (char)(fuzz_consume_u8(in) | 1);
+        if (kind == 0) {                          // 插入
+            memmove(out + pos + 1, out + pos, len - pos + 1);
+            out[pos] = c;
+            len++;
+        } else if (len > 0 && kind == 1) {        // 删除
+            memmove(out + pos, out + pos + 1, len - pos);
+            len--;
+        } else if (len > 0) {                     // 替换
+            out[pos] = c;
+        }
+    }
+    return out;
+}
+
+void fuzz_levenshtein(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    long bound = fuzz_consume_u8(&in);
+    char* a = fuzz_consume_string(&in);
+    if (a == NULL) {
+        return;
+    }
+    if (strlen(a) > MAX_EDIT_LENGTH) {
+        a[MAX_EDIT_LENGTH] = '\0';
+    }
+    char* b = (flags & FLAG_EDIT_SCRIPT) ? apply_edits(a, &in) : fuzz_consume_string(&in);
+    if (b == NULL) {
+        free(a);
+        return;
+    }
+    if (strlen(b) > MAX_EDIT_LENGTH) {
+        b[MAX_EDIT_LENGTH] = '\0';
+    }
+    size_t a_len = strlen(a);
+    size_t b_len = strlen(b);
+
+    long expected = reference_levenshtein(a, a_len, b, b_len);
+    if (expected >= 0) {
+        long actual = levenshtein_distance(a, a_len, b, b_len);
+        FUZZ_CHECK(actual == expected, "levenshtein_distance(%zu, %zu字节)为%ld，参考实现为%ld",
+                   a_len, b_len, actual, expected);
+        long bounded = levenshtein_bounded(a, a_len, b, b_len, bound);
+        long expected_bounded = expected <= bound ? expected : -1;
+        FUZZ_CHECK(bounded == expected_bounded, "levenshtein_bounded(上限%ld)为%ld，应为%ld",
+                   bound, bounded, expected_bounded);
+    }
+    // 等长部分的Hamming距离
+    size_t common = a_len < b_len ? a_len : b_len;
+    size_t bytes = 0;
+    size_t bits = 0;
+    reference_hamming(a, b, common, &bytes, &bits);
+    FUZZ_CHECK(hamming_distance(a, b, common) == bytes, "hamming_distance(%zu字节)与参考实现不同", common);
+    FUZZ_CHECK(hamming_distance_bits(a, b, common) == bits, "hamming_distance_bits(%zu字节)与参考实现不同",
+               common);
+    free(a);
+    free(b);
+}
+
+void fuzz_rabin_karp(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    cdc_params params;
+    params.min_size = (size_t)fuzz_consume_u8(&in) + 1;
+    params.avg_size = params.min_size + fuzz_consume_u16(&in) % 4096;
+    params.max_size = params.avg_size + fuzz_consume_u16(&in) % 8192;
+    char* text = fuzz_consume_string(&in);
+    char* pattern = fuzz_consume_string(&in);
+    if (text == NULL || pattern == NULL) {
+        free(text);
+        free(pattern);
+        return;
+    }
+    if (strlen(text) > MAX_SCAN_LENGTH) {
+        text[MAX_SCAN_LENGTH] = '\0';
+    }
+    size_t text_len = strlen(text);
+    size_t pattern_len = strlen(pattern);
+
+    size_t* positions = NULL;
+    size_t count = 0;
+    error_code code = rabin_karp_find_all(text, text_len, pattern, pattern_len, &positions, &count);
+    if (pattern_len == 0) {
+        FUZZ_CHECK(code == ERR_FINGERPRINT_INVALID_ARGUMENT, "空模式返回%s", error_code_name(code));
+    } else if (code == ERR_OK) {
+        size_t expected = 0;
+        for (size_t i = 0; i + pattern_len <= text_len; i++) {
+            if (memcmp(text + i, pattern, pattern_len) == 0) {
+                FUZZ_CHECK(expected < count && positions[expected] == i, "rabin_karp_find_all漏掉位置%zu", i);
+                expected++;
+            }
+        }
+        FUZZ_CHECK(count == expected, "rabin_karp_find_all找到%zu个匹配，应为%zu个", count, expected);
+    }
+    mem_free(positions);
+
+    // 分块：块长之和等于输入长度，除最后一块外都在[min_size, max_size]内，且与逐块调用的结果一致
+    size_t* chunks = NULL;
+    size_t chunk_count = 0;
+    code = cdc_chunk(text, text_len, &params, &chunks, &chunk_count);
+    if (code == ERR_OK) {
+        size_t offset = 0;
+        for (size_t i = 0; i < chunk_count; i++) {
+            FUZZ_CHECK(chunks[i] <= params.max_size && (chunks[i] >= params.min_size || i + 1 == chunk_count),
+                       "第%zu块长度%zu超出范围", i, chunks[i]);
+            FUZZ_CHECK(cdc_next_boundary(text + offset, text_len - offset, &params) == chunks[i],
+                       "第%zu块的边界与cdc_next_boundary不同", i);
+            offset += chunks[i];
+        }
+        FUZZ_CHECK(offset == text_len, "块长之和%zu不等于输入长度%zu", offset, text_len);
+    } else {
+        FUZZ_CHECK(code == ERR_FINGERPRINT_INVALID_ARGUMENT || code == ERR_FINGERPRINT_ALLOC,
+                   "cdc_chunk返回%s", error_code_name(code));
+    }
+    mem_free(chunks);
+    free(text);
+    free(pattern);
+}
+
+/* 边界用例：{片段, 重复次数, 第二个字符串的片段, 重复次数} */
+static const struct {
+    const char* a;
+    unsigned int a_repeat;
+    const char* b;
+    unsigned int b_repeat;
+} pair_seeds[] = {
+    {"", 1, "", 1},
+    {"", 1, "abc", 1},
+    {"kitten", 1, "sitting", 1},
+    {"a", 63, "a", 64},                     // 位并行算法的块边界
+    {"a", 64, "b", 64},
+    {"ab", 32, "ba", 33},
+    {"abcdefgh", 16, "abcdefgh", 17},       // 多块
+    {"xyz", 400, "xzy", 400},
+    {"a", 1500, "a", 1499},
+    {"aa", 1, "aaaa", 20000},               // 大量重叠匹配
+    {"abc", 1, "ab", 30000},
+};
+
+static int seed_pairs(int index, fuzz_buffer* out, int with_params) {
+    int count = (int)(sizeof(pair_seeds) / sizeof(pair_seeds[0]));
+    if (index >= count * 2) {
+        return 0;
+    }
+    int seed = index % count;
+    if (with_params) {
+        // 第二轮使用很小的分块参数
+        fuzz_put_u8(out, index < count ? 63 : 0);
+        fuzz_put_u16(out, index < count ? 1024 : 3);
+        fuzz_put_u16(out, index < count ? 2048 : 0);
+        fuzz_put_string(out, pair_seeds[seed].b, pair_seeds[seed].b_repeat);
+        fuzz_put_string(out, pair_seeds[seed].a, pair_seeds[seed].a_repeat);
+    } else {
+        // 第二轮以不同的距离上限比较带状算法
+        fuzz_put_u8(out, 0);
+        fuzz_put_u8(out, index < count ? 255 : 1);
+        fuzz_put_string(out, pair_seeds[seed].a, pair_seeds[seed].a_repeat);
+        fuzz_put_string(out, pair_seeds[seed].b, pair_seeds[seed].b_repeat);
+    }
+    return 1;
+}
+
+int seed_levenshtein(int index, fuzz_buffer* out) {
+    return seed_pairs(index, out, 0);
+}
+
+int seed_rabin_karp(int index, fuzz_buffer* out) {
+    return seed_pairs(index, out, 1);
+}
\ No newline at end of file
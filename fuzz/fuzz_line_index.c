@@ -0,0 +1,352 @@
+/**
+ * @file fuzz_line_index.c
+ * @brief 行索引的模糊测试目标：对一个临时文件执行一串追加（经append_file或直接写入）、改写、
+ *        打开、刷新、损坏与删除索引文件的操作，每次打开或刷新后把行数、各行范围与读出的内容
+ *        和逐字节扫描的参考结果比较，并按索引文件的状态检查索引的来源
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "fuzz.h"
+#include "../include/line_index.h"
+#include "../include/file_ops.h"
+#include "../include/allocator.h"
+
+/* 一个输入最多执行的操作数 */
+#define MAX_OPS 64
+/* 文件的大小上限：不超过索引比较的末尾字节数，改写总能被发现 */
+#define MAX_FILE 4096
+/* 每次检查逐行读取的行数 */
+#define READ_CHECKS 8
+
+/* 操作字节的低3位为操作，第3、4位为打开的选项 */
+#define OP_APPEND 0           /* append_file追加，同时更新索引文件 */
+#define OP_EXTERNAL 1         /* 直接写入追加，不更新索引文件 */
+#define OP_REWRITE 2          /* 改写整个文件后立即打开 */
+#define OP_OPEN 3
+#define OP_REFRESH 4          /* 刷新一直打开的索引，没有时先打开 */
+#define OP_CORRUPT 5          /* 改写索引文件的一个字节 */
+#define OP_DELETE 6           /* 删除索引文件 */
+#define OP_CLOSE 7            /* 关闭一直打开的索引 */
+#define OP_FLAGS(op) (((op) >> 3) & (LINE_INDEX_REBUILD | LINE_INDEX_NO_SAVE))
+
+/* 索引文件相对于文件的状态，决定下一次打开时索引的来源 */
+typedef enum {
+    SIDECAR_NONE,             /* 没有索引文件：重建 */
+    SIDECAR_FRESH,            /* 与文件一致：载入 */
+    SIDECAR_BEHIND,           /* 文件在索引之后有追加：扩展 */
+    SIDECAR_CORRUPT,          /* 内容被损坏：重建 */
+    SIDECAR_UNKNOWN           /* 刷新后可能保存也可能没有保存：不检查来源 */
+} sidecar_state;
+
+static char temp_dir[64];
+static char text_path[128];
+static char sidecar[160];
+/* 改写后设置的修改时间，每次不同，使改写后的文件不会与之前的索引有相同的大小和修改时间 */
+static long rewrite_clock = 1000000000L;
+
+static void remove_temp_dir(void) {
+    unlink(text_path);
+    unlink(sidecar);
+    rmdir(temp_dir);
+}
+
+static void prepare_paths(void) {
+    if (temp_dir[0] != '\0') {
+        return;
+    }
+    snprintf(temp_dir, sizeof(temp_dir), "/tmp/fuzz_line_index_XXXXXX");
+    if (mkdtemp(temp_dir) == NULL) {
+        fprintf(stderr, "无法创建临时目录\n");
+        exit(1);
+    }
+    snprintf(text_path, sizeof(text_path), "%s/text", temp_dir);
+    snprintf(sidecar, sizeof(sidecar), "%s%s", text_path, LINE_INDEX_SUFFIX);
+    atexit(remove_temp_dir);
+}
+
+/* 读取一段追加的内容：部分字节映射为'\n'使随机输入有足够多的行，长度截断到文件上限 */
+static char* consume_chunk(fuzz_input* in, size_t room) {
+    char* text = fuzz_consume_string(in);
+    if (text == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(text);
+    if (len > room) {
+        len = room;
+        text[len] = '\0';
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (((unsigned char)text[i] & 0x0f) == 0x0a) {
+            text[i] = '\n';
+        }
+    }
+    return text;
+}
+
+/* 参考实现：逐字节扫描得到行首与行长 */
+static uint64_t reference_lines(const char* ref, size_t len, uint64_t* starts) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (i == 0 || ref[i - 1] == '\n') {
+            starts[count++] = i;
+        }
+    }
+    return count;
+}
+
+static size_t reference_end(const char* ref, size_t len, uint64_t start) {
+    const char* nl = (const char*)memchr(ref + start, '\n', len - start);
+    return nl != NULL ? (size_t)(nl - ref) : len;
+}
+
+/* 逐行读取的行号由seed生成，不消耗输入，边界用例的编码与文件内容无关 */
+static uint64_t next_random(unsigned int* seed, uint64_t bound) {
+    *seed = *seed * 1103515245u + 12345u;
+    return ((*seed >> 8) & 0xffff) % bound;
+}
+
+static void check_index(const line_index* idx, const char* ref, size_t len, unsigned int seed, const char* what) {
+    static uint64_t starts[MAX_FILE];
+    uint64_t count = reference_lines(ref, len, starts);
+    FUZZ_CHECK(line_index_count(idx) == count, "%s：行数为%llu，应为%llu", what,
+               (unsigned long long)line_index_count(idx), (unsigned long long)count);
+    FUZZ_CHECK(line_index_size(idx) == len, "%s：索引覆盖%llu字节，文件为%zu字节", what,
+               (unsigned long long)line_index_size(idx), len);
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t offset = 0;
+        size_t length = 0;
+        error_code code = line_index_span(idx, i, &offset, &length);
+        size_t end = reference_end(ref, len, starts[i]);
+        FUZZ_CHECK(code == ERR_OK && offset == starts[i] && length == end - starts[i],
+                   "%s：第%llu行的范围为[%llu, +%zu)，应为[%llu, +%zu)", what, (unsigned long long)i,
+                   (unsigned long long)offset, length, (unsigned long long)starts[i], end - starts[i]);
+    }
+    uint64_t offset = 0;
+    size_t length = 0;
+    FUZZ_CHECK(line_index_span(idx, count, &offset, &length) == ERR_LINE_INDEX_RANGE,
+               "%s：超出行数的行号没有返回ERR_LINE_INDEX_RANGE", what);
+    if (count == 0) {
+        return;
+    }
+    for (int k = 0; k < READ_CHECKS; k++) {
+        uint64_t line = k == 0 ? count - 1 : next_random(&seed, count);
+        char* text = NULL;
+        size_t n = 0;
+        error_code code = line_index_read_line(idx, line, &text, &n);
+        size_t end = reference_end(ref, len, starts[line]);
+        FUZZ_CHECK(code == ERR_OK && n == end - starts[line] && memcmp(text, ref + starts[line], n) == 0 &&
+                   text[n] == '\0', "%s：读出的第%llu行与文件不同", what, (unsigned long long)line);
+        mem_free(text);
+    }
+    uint64_t first = next_random(&seed, count);
+    uint64_t lines = next_random(&seed, count - first) + 1;
+    char* text = NULL;
+    size_t n = 0;
+    error_code code = line_index_read_lines(idx, first, lines, &text, &n);
+    size_t end = reference_end(ref, len, starts[first + lines - 1]);
+    FUZZ_CHECK(code == ERR_OK && n == end - starts[first] && memcmp(text, ref + starts[first], n) == 0 &&
+               text[n] == '\0', "%s：读出的第%llu行起的%llu行与文件不同", what, (unsigned long long)first,
+               (unsigned long long)lines);
+    mem_free(text);
+}
+
+static void check_source(const line_index* idx, sidecar_state state, int flags, const char* what) {
+    static const line_index_source expected[] = {LINE_INDEX_BUILT, LINE_INDEX_LOADED, LINE_INDEX_EXTENDED,
+                                                 LINE_INDEX_BUILT};
+    if (state == SIDECAR_UNKNOWN) {
+        return;
+    }
+    line_index_source want = (flags & LINE_INDEX_REBUILD) ? LINE_INDEX_BUILT : expected[state];
+    FUZZ_CHECK(line_index_get_source(idx) == want, "%s：索引的来源为%d，应为%d", what,
+               (int)line_index_get_source(idx), (int)want);
+}
+
+static int sidecar_exists(void) {
+    struct stat st;
+    return stat(sidecar, &st) == 0;
+}
+
+void fuzz_line_index(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    static char ref[MAX_FILE + 1];
+    size_t len = 0;
+    prepare_paths();
+    unlink(sidecar);
+    FUZZ_CHECK(write_file(text_path, ""), "无法创建临时文件");
+    sidecar_state state = SIDECAR_NONE;
+    line_index* held = NULL;
+    int held_flags = 0;
+    for (int ops = 0; ops < MAX_OPS && in.pos < in.size; ops++) {
+        uint8_t op = fuzz_consume_u8(&in);
+        int flags = OP_FLAGS(op);
+        unsigned int seed = (unsigned int)ops * 2654435761u + op;
+        switch (op & 0x07) {
+            case OP_APPEND:
+            case OP_EXTERNAL: {
+                char* chunk = consume_chunk(&in, MAX_FILE - len);
+                if (chunk == NULL) {
+                    break;
+                }
+                size_t n = strlen(chunk);
+                if ((op & 0x07) == OP_APPEND) {
+                    FUZZ_CHECK(append_file(text_path, chunk), "append_file失败");
+                    // 钩子从索引文件记录的位置继续扫描，之前直接写入的部分一并加入
+                    if (n > 0 && state == SIDECAR_BEHIND) {
+                        state = SIDECAR_FRESH;
+                    }
+                } else if (n > 0) {
+                    int fd = open(text_path, O_WRONLY | O_APPEND);
+                    FUZZ_CHECK(fd >= 0 && write(fd, chunk, n) == (ssize_t)n, "无法追加到临时文件");
+                    close(fd);
+                    if (state == SIDECAR_FRESH) {
+                        state = SIDECAR_BEHIND;
+                    }
+                }
+                memcpy(ref + len, chunk, n);
+                len += n;
+                free(chunk);
+                break;
+            }
+            case OP_REWRITE: {
+                char* chunk = consume_chunk(&in, MAX_FILE);
+                if (chunk == NULL) {
+                    break;
+                }
+                FUZZ_CHECK(write_file(text_path, chunk), "write_file失败");
+                len = strlen(chunk);
+                memcpy(ref, chunk, len);
+                free(chunk);
+                struct timespec times[2] = {{rewrite_clock, 0}, {rewrite_clock, 0}};
+                rewrite_clock++;
+                FUZZ_CHECK(utimensat(AT_FDCWD, text_path, times, 0) == 0, "无法设置修改时间");
+                // 索引文件与一直打开的索引都立即与改写后的文件同步，之后的追加不会与改写前的状态混淆
+                line_index* idx = NULL;
+                FUZZ_CHECK(line_index_open(text_path, 0, &idx) == ERR_OK, "改写后打开失败");
+                FUZZ_CHECK(line_index_get_source(idx) != LINE_INDEX_LOADED, "改写后的文件载入了旧的索引");
+                check_index(idx, ref, len, seed, "改写后打开");
+                line_index_close(idx);
+                if (held != NULL) {
+                    FUZZ_CHECK(line_index_refresh(held) == ERR_OK, "改写后刷新失败");
+                    check_index(held, ref, len, seed, "改写后刷新");
+                }
+                state = SIDECAR_FRESH;
+                break;
+            }
+            case OP_OPEN: {
+                line_index* idx = NULL;
+                FUZZ_CHECK(line_index_open(text_path, flags, &idx) == ERR_OK, "line_index_open失败");
+                check_source(idx, state, flags, "打开");
+                check_index(idx, ref, len, seed, "打开");
+                line_index_close(idx);
+                if (!(flags & LINE_INDEX_NO_SAVE)) {
+                    state = SIDECAR_FRESH;
+                }
+                break;
+            }
+            case OP_REFRESH:
+                if (held == NULL) {
+                    held_flags = flags;
+                    FUZZ_CHECK(line_index_open(text_path, held_flags, &held) == ERR_OK, "line_index_open失败");
+                    check_source(held, state, held_flags, "打开");
+                    if (!(held_flags & LINE_INDEX_NO_SAVE)) {
+                        state = SIDECAR_FRESH;
+                    }
+                } else {
+                    FUZZ_CHECK(line_index_refresh(held) == ERR_OK, "line_index_refresh失败");
+                    if (!(held_flags & LINE_INDEX_NO_SAVE)) {
+                        state = SIDECAR_UNKNOWN;
+                    }
+                }
+                check_index(held, ref, len, seed, "刷新");
+                break;
+            case OP_CORRUPT: {
+                uint16_t offset = fuzz_consume_u16(&in);
+                uint8_t mask = fuzz_consume_u8(&in);
+                struct stat st;
+                int fd = open(sidecar, O_RDWR);
+                if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0 || mask == 0) {
+                    if (fd >= 0) {
+                        close(fd);
+                    }
+                    break;
+                }
+                off_t at = (off_t)(offset % st.st_size);
+                uint8_t b = 0;
+                FUZZ_CHECK(pread(fd, &b, 1, at) == 1, "无法读取索引文件");
+                b ^= mask;
+                FUZZ_CHECK(pwrite(fd, &b, 1, at) == 1, "无法写入索引文件");
+                close(fd);
+                state = SIDECAR_CORRUPT;
+                break;
+            }
+            case OP_DELETE:
+                unlink(sidecar);
+                state = SIDECAR_NONE;
+                break;
+            default:
+                line_index_close(held);
+                held = NULL;
+                break;
+        }
+        if (state == SIDECAR_FRESH || state == SIDECAR_BEHIND) {
+            FUZZ_CHECK(sidecar_exists(), "应当存在的索引文件不存在");
+        }
+    }
+    line_index_close(held);
+}
+
+/* 边界用例：{操作字节, 字符串片段, 重复次数} 的序列，以操作字节0xff结束 */
+static const struct {
+    uint8_t op;
+    const char* chunk;
+    uint16_t repeat;
+} line_index_seeds[][10] = {
+    // 建立索引后经append_file追加：补全最后一行、新增的行、以'\n'结尾
+    {{OP_APPEND, "first\nsecond", 1}, {OP_OPEN, NULL, 0}, {OP_APPEND, " line\nthird", 1},
+     {OP_OPEN, NULL, 0}, {OP_APPEND, "\n", 1}, {OP_OPEN, NULL, 0}, {OP_APPEND, "\n\n", 3},
+     {OP_OPEN, NULL, 0}, {0xff, NULL, 0}},
+    // 其他进程追加后扩展索引，跨过64行的检查点，之后刷新一直打开的索引
+    {{OP_REFRESH, NULL, 0}, {OP_EXTERNAL, "ab\n", 63}, {OP_OPEN, NULL, 0}, {OP_EXTERNAL, "x\n", 2},
+     {OP_REFRESH, NULL, 0}, {OP_EXTERNAL, "tail", 1}, {OP_APPEND, "\nmore\n", 1}, {OP_OPEN, NULL, 0},
+     {0xff, NULL, 0}},
+    // 改写为更短、更长的内容，以及只有一行没有换行符的长行
+    {{OP_EXTERNAL, "line\n", 200}, {OP_OPEN, NULL, 0}, {OP_REFRESH, NULL, 0}, {OP_REWRITE, "short\n", 1},
+     {OP_REWRITE, "x", 4000}, {OP_REFRESH, NULL, 0}, {OP_REWRITE, "", 1}, {OP_OPEN, NULL, 0},
+     {0xff, NULL, 0}},
+    // 损坏与删除索引文件，以及重建与不保存的选项
+    {{OP_EXTERNAL, "a\nbb\nccc\n", 20}, {OP_OPEN, NULL, 0}, {OP_CORRUPT, NULL, 0},
+     {OP_OPEN | (LINE_INDEX_NO_SAVE << 3), NULL, 0}, {OP_OPEN, NULL, 0},
+     {OP_OPEN | (LINE_INDEX_REBUILD << 3), NULL, 0}, {OP_DELETE, NULL, 0},
+     {OP_OPEN | (LINE_INDEX_NO_SAVE << 3), NULL, 0}, {OP_APPEND, "d\n", 1}, {0xff, NULL, 0}},
+};
+
+int seed_line_index(int index, fuzz_buffer* out) {
+    int seeds = (int)(sizeof(line_index_seeds) / sizeof(line_index_seeds[0]));
+    if (index >= seeds) {
+        return 0;
+    }
+    for (int i = 0; line_index_seeds[index][i].op != 0xff; i++) {
+        uint8_t op = line_index_seeds[index][i].op;
+        fuzz_put_u8(out, op);
+        switch (op & 0x07) {
+            case OP_APPEND:
+            case OP_EXTERNAL:
+            case OP_REWRITE:
+                fuzz_put_string(out, line_index_seeds[index][i].chunk, line_index_seeds[index][i].repeat);
+                break;
+            case OP_CORRUPT:
+                // 差值序列中的一个字节
+                fuzz_put_u16(out, 80);
+                fuzz_put_u8(out, 0x01);
+                break;
+            default:
+                break;
+        }
+    }
+    return 1;
+}
\ No newline at end of file
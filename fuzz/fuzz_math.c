@@ -0,0 +1,389 @@
+/**
+ * @file fuzz_math.c
+ * @brief find_primes、count_primes与fibonacci的模糊测试目标
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "fuzz.h"
+#include "../include/utils.h"
+#include "../include/math_ops.h"
+#include "../include/allocator.h"
+
+/* 选项字节中的位：交换区间端点（起始值大于结束值） */
+#define FLAG_SWAP_RANGE 0x80
+/* 选项字节中的位：区间长度用16位整数，否则用8位 */
+#define FLAG_WIDE_RANGE 0x40
+/* 选项字节低6位全为1时使用超过并行阈值的区间长度 */
+#define FLAG_LONG_RANGE 0x3f
+/* 超长区间在该长度上再加16位随机长度，覆盖find_primes的并行路径 */
+#define LONG_RANGE_BASE (1L << 16)
+/* count_primes选项字节中的位：上界取32位随机值、区间长度不超过255（分段筛路径），否则上界不超过2^22 */
+#define FLAG_LARGE_BOUND 0x20
+/* 上界不超过2^22时，FLAG_WIDE_RANGE表示直接给出起始值（长区间，Lucy_Hedgehog路径），否则给出区间长度 */
+#define SMALL_BOUND_MAX (1u << 22)
+/* factorize选项字节中的位：各数取低32位，与逐个试除的参考实现比较完整结果 */
+#define FLAG_SMALL_VALUES 0x80
+/* factorize选项字节中的位：各数为两个不小于给定32位值的素数之积（rho最慢的情形） */
+#define FLAG_SEMIPRIME 0x40
+/* factorize选项字节的低3位为个数减1 */
+#define FACTOR_COUNT_MASK 0x07
+/* count_primes选项字节低5位全为1时上界加上COUNT_PRIMES_MAX（超出范围） */
+#define FLAG_TOO_LARGE 0x1f
+
+typedef error_code (*primes_fn)(int start, int end, int** primes, int* count);
+typedef error_code (*fibonacci_fn)(int n, int* result);
+
+static error_code find_primes_legacy(int start, int end, int** primes, int* count) {
+    *primes = find_primes(start, end, count);
+    return *primes != NULL ? ERR_OK : get_last_error();
+}
+
+static error_code fibonacci_legacy(int n, int* result) {
+    *result = fibonacci(n);
+    return *result != -1 ? ERR_OK : get_last_error();
+}
+
+/* 被测实现，与参考实现逐一比较；新的优化版本加在这里 */
+static const struct {
+    const char* name;
+    primes_fn fn;
+} primes_variants[] = {
+    {"find_primes_checked", find_primes_checked},
+    {"find_primes", find_primes_legacy},
+};
+
+static const struct {
+    const char* name;
+    fibonacci_fn fn;
+} fibonacci_variants[] = {
+    {"fibonacci_checked", fibonacci_checked},
+    {"fibonacci", fibonacci_legacy},
+};
+
+void fuzz_find_primes(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    int start = fuzz_consume_int(&in);
+    long span = (flags & FLAG_WIDE_RANGE) ? fuzz_consume_u16(&in) : fuzz_consume_u8(&in);
+    if ((flags & FLAG_LONG_RANGE) == FLAG_LONG_RANGE) {
+        span += LONG_RANGE_BASE;
+    }
+    int end = (long)start + span > INT_MAX ? INT_MAX : (int)(start + span);
+    if ((flags & FLAG_SWAP_RANGE) && start != end) {
+        int tmp = start;
+        start = end;
+        end = tmp;
+    }
+
+    int* expected = NULL;
+    int expected_count = 0;
+    error_code expected_code = reference_find_primes(start, end, &expected, &expected_count);
+    for (size_t v = 0; v < sizeof(primes_variants) / sizeof(primes_variants[0]); v++) {
+        int* actual = NULL;
+        int count = 0;
+        error_code code = primes_variants[v].fn(start, end, &actual, &count);
+        if (expected_code == ERR_MATH_ALLOC || code == ERR_MATH_ALLOC) {
+            mem_free(actual);
+            continue;
+        }
+        FUZZ_CHECK(code == expected_code, "%s(%d, %d)返回%s，参考实现返回%s", primes_variants[v].name,
+                   start, end, error_code_name(code), error_code_name(expected_code));
+        if (code == ERR_OK) {
+            FUZZ_CHECK(count == expected_count, "%s(%d, %d)找到%d个素数，参考实现为%d个",
+                       primes_variants[v].name, start, end, count, expected_count);
+            FUZZ_CHECK(count == 0 || memcmp(actual, expected, (size_t)count * sizeof(int)) == 0,
+                       "%s(%d, %d)的结果与参考实现不同", primes_variants[v].name, start, end);
+        }
+        mem_free(actual);
+    }
+    // 只计数的count_primes与参考实现找到的个数一致
+    if (expected_code == ERR_OK && end >= 0) {
+        uint64_t counted = 0;
+        error_code code = count_primes_checked(start < 0 ? 0 : (uint64_t)start, (uint64_t)end, &counted);
+        FUZZ_CHECK(code == ERR_OK || code == ERR_MATH_ALLOC, "count_primes(%d, %d)返回%s", start, end,
+                   error_code_name(code));
+        FUZZ_CHECK(code != ERR_OK || counted == (uint64_t)expected_count,
+                   "count_primes(%d, %d) = %llu，参考实现为%d", start, end, (unsigned long long)counted,
+                   expected_count);
+    }
+    free(expected);
+}
+
+void fuzz_count_primes(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    uint64_t lo;
+    uint64_t hi;
+    if (flags & FLAG_LARGE_BOUND) {
+        hi = (uint64_t)fuzz_consume_u16(&in) << 16 | fuzz_consume_u16(&in);
+        uint64_t span = fuzz_consume_u8(&in);
+        lo = span > hi ? 0 : hi - span;
+    } else {
+        hi = (uint64_t)(fuzz_consume_u8(&in) & 0x7f) << 16 | fuzz_consume_u16(&in);
+        hi = hi > SMALL_BOUND_MAX ? SMALL_BOUND_MAX : hi;
+        uint64_t value = fuzz_consume_u16(&in);
+        if (flags & FLAG_WIDE_RANGE) {
+            lo = value > hi ? hi : value;
+        } else {
+            lo = value > hi ? 0 : hi - value;
+        }
+    }
+    if ((flags & FLAG_TOO_LARGE) == FLAG_TOO_LARGE) {
+        lo += COUNT_PRIMES_MAX;
+        hi += COUNT_PRIMES_MAX;
+    }
+    if ((flags & FLAG_SWAP_RANGE) && lo != hi) {
+        uint64_t tmp = lo;
+        lo = hi;
+        hi = tmp;
+    }
+
+    uint64_t expected = 0;
+    error_code expected_code = reference_count_primes(lo, hi, &expected);
+    uint64_t actual = 0;
+    error_code code = count_primes_checked(lo, hi, &actual);
+    if (expected_code == ERR_MATH_ALLOC || code == ERR_MATH_ALLOC) {
+        return;
+    }
+    FUZZ_CHECK(code == expected_code, "count_primes_checked(%llu, %llu)返回%s，参考实现返回%s",
+               (unsigned long long)lo, (unsigned long long)hi, error_code_name(code),
+               error_code_name(expected_code));
+    FUZZ_CHECK(code != ERR_OK || actual == expected, "count_primes_checked(%llu, %llu) = %llu，参考实现为%llu",
+               (unsigned long long)lo, (unsigned long long)hi, (unsigned long long)actual,
+               (unsigned long long)expected);
+    // 大上界时区间很短，走分段筛；再用Lucy_Hedgehog路径的π(hi) - π(lo - 1)交叉验证
+    if (code == ERR_OK && (flags & FLAG_LARGE_BOUND) && lo > 0) {
+        uint64_t pi_hi = count_primes(0, hi);
+        uint64_t pi_lo = count_primes(0, lo - 1);
+        FUZZ_CHECK(pi_hi - pi_lo == actual, "π(%llu) - π(%llu) = %llu，区间计数为%llu", (unsigned long long)hi,
+                   (unsigned long long)(lo - 1), (unsigned long long)(pi_hi - pi_lo), (unsigned long long)actual);
+    }
+}
+
+void fuzz_fibonacci(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    int n = fuzz_consume_int(&in);
+
+    int expected = 0;
+    error_code expected_code = reference_fibonacci(n, &expected);
+    for (size_t v = 0; v < sizeof(fibonacci_variants) / sizeof(fibonacci_variants[0]); v++) {
+        int actual = 0;
+        error_code code = fibonacci_variants[v].fn(n, &actual);
+        FUZZ_CHECK(code == expected_code, "%s(%d)返回%s，参考实现返回%s", fibonacci_variants[v].name,
+                   n, error_code_name(code), error_code_name(expected_code));
+        if (code == ERR_OK) {
+            FUZZ_CHECK(actual == expected, "%s(%d) = %d，参考实现为%d", fibonacci_variants[v].name,
+                       n, actual, expected);
+        }
+    }
+}
+
+/* 边界用例：{起始值, 结束值}，区间长度不超过并行阈值的两倍 */
+static const struct {
+    int start;
+    int end;
+} range_seeds[] = {
+    {0, 0}, {1, 1}, {2, 2}, {-10, 10}, {0, 100},
+    {10, 9},                                  // 起始值大于结束值
+    {INT_MIN, INT_MIN}, {INT_MIN, INT_MIN + 1000},
+    {INT_MAX, INT_MAX},                       // INT_MAX是素数
+    {INT_MAX - 1000, INT_MAX},                // 循环变量到达INT_MAX
+    {2147117569 - 100, 2147117569 + 100},     // 46337的平方附近，试除的平方溢出
+    {0, (1 << 16) - 1}, {0, 1 << 16},         // 并行阈值两侧
+    {-5, (1 << 16) + 7},
+    {(1 << 15) - 3, (1 << 15) + (1 << 16)},   // 分块边界
+    {INT_MAX - (1 << 16) - 3, INT_MAX},       // 并行路径到达INT_MAX
+};
+
+int seed_find_primes(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(range_seeds) / sizeof(range_seeds[0]))) {
+        return 0;
+    }
+    long start = range_seeds[index].start;
+    long end = range_seeds[index].end;
+    long span = end >= start ? end - start : start - end;
+    uint8_t flags = end < start ? FLAG_SWAP_RANGE : 0;
+    if (span >= LONG_RANGE_BASE) {
+        flags |= FLAG_LONG_RANGE;
+        span -= LONG_RANGE_BASE;
+    }
+    if (span > 0xff) {
+        flags |= FLAG_WIDE_RANGE;
+    }
+    fuzz_put_u8(out, flags);
+    fuzz_put_int(out, (int)(end >= start ? start : end));
+    if (flags & FLAG_WIDE_RANGE) {
+        fuzz_put_u16(out, (uint16_t)span);
+    } else {
+        fuzz_put_u8(out, (uint8_t)span);
+    }
+    return 1;
+}
+
+static uint64_t consume_u64(fuzz_input* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value = value << 16 | fuzz_consume_u16(in);
+    }
+    return value;
+}
+
+static uint64_t reference_next_prime(uint64_t n) {
+    while (!reference_is_prime_u64(n)) {
+        n++;
+    }
+    return n;
+}
+
+/* 检查分解结果：素因子升序、都是素数、指数为正且乘积等于n */
+static void check_factors(uint64_t n, const prime_factors* f) {
+    unsigned __int128 product = 1;
+    FUZZ_CHECK(f->count >= 0 && f->count <= MAX_PRIME_FACTORS, "%llu的素因子个数为%d", (unsigned long long)n,
+               f->count);
+    for (int i = 0; i < f->count; i++) {
+        FUZZ_CHECK(reference_is_prime_u64(f->primes[i]), "%llu的因子%llu不是素数", (unsigned long long)n,
+                   (unsigned long long)f->primes[i]);
+        FUZZ_CHECK(i == 0 || f->primes[i] > f->primes[i - 1], "%llu的素因子没有按升序排列", (unsigned long long)n);
+        FUZZ_CHECK(f->exponents[i] > 0 && f->exponents[i] < 64, "%llu的因子%llu的指数为%d", (unsigned long long)n,
+                   (unsigned long long)f->primes[i], f->exponents[i]);
+        for (int e = 0; e < f->exponents[i]; e++) {
+            product *= f->primes[i];
+        }
+    }
+    FUZZ_CHECK(product == n, "%llu的素因子之积不等于它", (unsigned long long)n);
+}
+
+void fuzz_factorize(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    int count = (flags & FACTOR_COUNT_MASK) + 1;
+    uint64_t values[FACTOR_COUNT_MASK + 1];
+    prime_factors single[FACTOR_COUNT_MASK + 1];
+    for (int i = 0; i < count; i++) {
+        uint64_t n = consume_u64(&in);
+        if (flags & FLAG_SMALL_VALUES) {
+            n &= 0xffffffffu;
+        } else if (flags & FLAG_SEMIPRIME) {
+            n = reference_next_prime(n >> 32 | 1) * reference_next_prime((n & 0xffffffffu) | 1);
+        }
+        values[i] = n;
+
+        error_code code = factorize_u64(n, &single[i]);
+        FUZZ_CHECK(code == (n == 0 ? ERR_MATH_FACTORIZE_ZERO : ERR_OK), "factorize_u64(%llu)返回%s",
+                   (unsigned long long)n, error_code_name(code));
+        FUZZ_CHECK(is_prime_u64(n) == reference_is_prime_u64(n), "is_prime_u64(%llu)与参考实现不同",
+                   (unsigned long long)n);
+        if (code != ERR_OK) {
+            single[i].count = 0;
+            continue;
+        }
+        check_factors(n, &single[i]);
+        if (flags & FLAG_SMALL_VALUES) {
+            prime_factors expected;
+            reference_factorize_u64(n, &expected);
+            FUZZ_CHECK(expected.count == single[i].count &&
+                       memcmp(expected.primes, single[i].primes, (size_t)expected.count * sizeof(uint64_t)) == 0 &&
+                       memcmp(expected.exponents, single[i].exponents, (size_t)expected.count * sizeof(int)) == 0,
+                       "factorize_u64(%llu)的结果与参考实现不同", (unsigned long long)n);
+        }
+    }
+
+    // 批量分解与逐个分解的结果一致
+    prime_factors batch[FACTOR_COUNT_MASK + 1];
+    error_code code = factorize_u64_batch(values, (size_t)count, batch);
+    int has_zero = 0;
+    for (int i = 0; i < count; i++) {
+        has_zero |= values[i] == 0;
+        FUZZ_CHECK(batch[i].count == single[i].count &&
+                   memcmp(batch[i].primes, single[i].primes, (size_t)batch[i].count * sizeof(uint64_t)) == 0 &&
+                   memcmp(batch[i].exponents, single[i].exponents, (size_t)batch[i].count * sizeof(int)) == 0,
+                   "factorize_u64_batch中%llu的结果与factorize_u64不同", (unsigned long long)values[i]);
+    }
+    FUZZ_CHECK(code == (has_zero ? ERR_MATH_FACTORIZE_ZERO : ERR_OK), "factorize_u64_batch返回%s",
+               error_code_name(code));
+}
+
+static const uint64_t factorize_seeds[] = {
+    0, 1, 2, 3, 4, 561,                           // 561是Carmichael数
+    1021 * 1019, 1031 * 1031, 3 * 1031,           // 试除上界两侧
+    3215031751ULL,                                // 以2、3、5、7为底的强伪素数
+    3825123056546413051ULL,                       // 以2到23为底的强伪素数
+    4611686014132420609ULL,                       // (2^31 - 1)^2
+    18446743979220271189ULL,                      // 两个最大的32位素数之积
+    1ULL << 63, 18446744073709551615ULL,
+    18446744073709551557ULL,                      // 最大的64位素数
+    614889782588491410ULL,                        // 前15个素数之积
+};
+
+int seed_factorize(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(factorize_seeds) / sizeof(factorize_seeds[0]))) {
+        return 0;
+    }
+    uint64_t n = factorize_seeds[index];
+    fuzz_put_u8(out, n <= 0xffffffffu ? FLAG_SMALL_VALUES : 0);
+    for (int shift = 48; shift >= 0; shift -= 16) {
+        fuzz_put_u16(out, (uint16_t)(n >> shift));
+    }
+    return 1;
+}
+
+/* 边界用例：{起始值, 结束值}，结束值不超过2^22时起始值或区间长度不超过65535，否则区间长度不超过255 */
+static const struct {
+    uint64_t lo;
+    uint64_t hi;
+} count_seeds[] = {
+    {0, 0}, {0, 1}, {0, 2}, {2, 2}, {0, 100}, {4, 4},
+    {10, 9},                                      // 起始值大于结束值
+    {0, 1u << 22}, {1, (1u << 22) - 1},           // Lucy_Hedgehog路径
+    {1000, 1u << 22}, {65535, 4000000},
+    {(1u << 22) - 65535, 1u << 22},               // 分段筛路径
+    {4294967040u, 4294967295u},                   // 32位上界
+    {4294836225u - 100, 4294836225u + 100},       // 65535的平方附近
+    {COUNT_PRIMES_MAX, COUNT_PRIMES_MAX + 5},     // 超出范围
+};
+
+int seed_count_primes(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(count_seeds) / sizeof(count_seeds[0]))) {
+        return 0;
+    }
+    uint64_t lo = count_seeds[index].lo;
+    uint64_t hi = count_seeds[index].hi;
+    uint8_t flags = 0;
+    if (lo > hi) {
+        flags |= FLAG_SWAP_RANGE;
+        uint64_t tmp = lo;
+        lo = hi;
+        hi = tmp;
+    }
+    if (hi >= COUNT_PRIMES_MAX) {
+        flags |= FLAG_TOO_LARGE;
+        lo -= COUNT_PRIMES_MAX;
+        hi -= COUNT_PRIMES_MAX;
+    }
+    if (hi > SMALL_BOUND_MAX) {
+        fuzz_put_u8(out, flags | FLAG_LARGE_BOUND);
+        fuzz_put_u16(out, (uint16_t)(hi >> 16));
+        fuzz_put_u16(out, (uint16_t)hi);
+        fuzz_put_u8(out, (uint8_t)(hi - lo));
+    } else {
+        int wide = lo <= 0xffff;
+        fuzz_put_u8(out, flags | (wide ? FLAG_WIDE_RANGE : 0));
+        fuzz_put_u8(out, (uint8_t)(hi >> 16));
+        fuzz_put_u16(out, (uint16_t)hi);
+        fuzz_put_u16(out, (uint16_t)(wide ? lo : hi - lo));
+    }
+    return 1;
+}
+
+static const int fibonacci_seeds[] = {
+    0, 1, 2, 45, 46, 47, 48, -1, INT_MIN, INT_MAX, 100,
+};
+
+int seed_fibonacci(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(fibonacci_seeds) / sizeof(fibonacci_seeds[0]))) {
+        return 0;
+    }
+    fuzz_put_int(out, fibonacci_seeds[index]);
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,276 @@
+/**
+ * @file fuzz_matrix.c
+ * @brief 矩阵乘法的模糊测试目标：与三重循环的参考实现比较乘积、乘加、矩阵幂与斐波那契数
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz.h"
+
+/* 选项字节的低2位选择元素类型（3也为double） */
+#define TYPE_MASK 0x03
+/* 选项字节中的位：各维可到LARGE_DIM，覆盖多个分块与并行路径，否则不超过SMALL_DIM */
+#define FLAG_LARGE 0x80
+/* 选项字节中的位：结果写回左矩阵（此时b为方阵） */
+#define FLAG_ALIAS 0x40
+/* 选项字节中的位：用乘加，累加矩阵的初值也来自输入 */
+#define FLAG_ADD 0x20
+/* 选项字节中的位：另外检查矩阵幂 */
+#define FLAG_POWER 0x10
+/* 选项字节中的位：另外检查斐波那契数 */
+#define FLAG_FIBONACCI 0x08
+#define SMALL_DIM 40
+#define LARGE_DIM 320
+/* 矩阵幂检查的阶数与指数上限；double只用-1、0、1，乘积不超过8^12，保持精确 */
+#define POWER_DIM 8
+#define POWER_MAX_EXPONENT 12
+/* 斐波那契数的索引上限 */
+#define FIBONACCI_MAX (1u << 20)
+
+static const matrix_type types[] = {MATRIX_INT32, MATRIX_INT64, MATRIX_DOUBLE, MATRIX_DOUBLE};
+
+/* 以输入字节循环填充矩阵；整数乘以奇数常数以覆盖回绕 */
+static void fill(matrix* m, const char* values, size_t len, size_t* pos, int unit) {
+    for (size_t i = 0; i < m->rows; i++) {
+        for (size_t j = 0; j < m->cols; j++) {
+            signed char byte = len > 0 ? (signed char)values[(*pos)++ % len] : 1;
+            if (m->type == MATRIX_INT32) {
+                MATRIX_AT(m, uint32_t, i, j) = (uint32_t)byte * 16777619u;
+            } else if (m->type == MATRIX_INT64) {
+                MATRIX_AT(m, uint64_t, i, j) = (uint64_t)(int64_t)byte * 0x9e3779b97f4a7c15ULL;
+            } else {
+                MATRIX_AT(m, double, i, j) = unit ? (double)(byte % 2) : (double)byte;
+            }
+        }
+    }
+}
+
+/* 按行距stride分配并复制矩阵的元素，供参考实现使用 */
+static void* dense_copy(const matrix* m) {
+    size_t bytes = m->rows * m->stride * (m->type == MATRIX_INT32 ? 4 : 8);
+    void* copy = malloc(bytes > 0 ? bytes : 1);
+    if (copy != NULL && bytes > 0) {
+        memcpy(copy, m->data, bytes);
+    }
+    return copy;
+}
+
+static int same_element(matrix_type type, const void* x, const void* y, size_t index) {
+    if (type == MATRIX_INT32) {
+        return ((const uint32_t*)x)[index] == ((const uint32_t*)y)[index];
+    }
+    if (type == MATRIX_INT64) {
+        return ((const uint64_t*)x)[index] == ((const uint64_t*)y)[index];
+    }
+    return ((const double*)x)[index] == ((const double*)y)[index];
+}
+
+/* 比较c与按行距c->stride存放的expected */
+static void check_equal(const matrix* c, const void* expected, const char* what) {
+    for (size_t i = 0; i < c->rows; i++) {
+        for (size_t j = 0; j < c->cols; j++) {
+            size_t index = i * c->stride + j;
+            if (!same_element(c->type, c->data, expected, index)) {
+                FUZZ_CHECK(0, "%s的第%zu行第%zu列与参考实现不同（%zu行%zu列）", what, i, j, c->rows, c->cols);
+                return;
+            }
+        }
+    }
+}
+
+/* a加上参考实现中b * c的结果，整数按无符号运算 */
+static void add_into(matrix_type type, void* sum, const void* addend, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (type == MATRIX_INT32) {
+            ((uint32_t*)sum)[i] += ((const uint32_t*)addend)[i];
+        } else if (type == MATRIX_INT64) {
+            ((uint64_t*)sum)[i] += ((const uint64_t*)addend)[i];
+        } else {
+            ((double*)sum)[i] += ((const double*)addend)[i];
+        }
+    }
+}
+
+static void check_product(matrix_type type, uint8_t flags, size_t m, size_t n, size_t k, const char* values,
+                          size_t len) {
+    matrix a, b, c;
+    matrix_init(&a);
+    matrix_init(&b);
+    matrix_init(&c);
+    size_t pos = 0;
+    if (flags & FLAG_ALIAS) {
+        n = k;
+    }
+    if (matrix_create(&a, type, m, k) != ERR_OK || matrix_create(&b, type, k, n) != ERR_OK ||
+        matrix_create(&c, type, m, n) != ERR_OK) {
+        goto cleanup;
+    }
+    fill(&a, values, len, &pos, 0);
+    fill(&b, values, len, &pos, 0);
+    void* expected = calloc(m * c.stride + 1, 8);
+    void* initial = NULL;
+    if (expected == NULL) {
+        goto cleanup;
+    }
+    reference_matrix_multiply(type, m, n, k, a.data, a.stride, b.data, b.stride, expected, c.stride);
+
+    error_code code;
+    if (flags & FLAG_ADD) {
+        fill(&c, values, len, &pos, 0);
+        initial = dense_copy(&c);
+        if (initial != NULL) {
+            add_into(type, expected, initial, m * c.stride);
+        }
+        code = matrix_multiply_add(&c, &a, &b);
+        FUZZ_CHECK(code == ERR_OK, "matrix_multiply_add返回%s", error_code_name(code));
+        if (code == ERR_OK && initial != NULL) {
+            check_equal(&c, expected, "乘加");
+        }
+    } else if (flags & FLAG_ALIAS) {
+        code = matrix_multiply(&a, &a, &b);
+        FUZZ_CHECK(code == ERR_OK, "matrix_multiply返回%s", error_code_name(code));
+        if (code == ERR_OK) {
+            FUZZ_CHECK(a.rows == m && a.cols == n, "结果为%zu行%zu列，应为%zu行%zu列", a.rows, a.cols, m, n);
+            check_equal(&a, expected, "写回左矩阵的乘积");
+        }
+    } else {
+        code = matrix_multiply(&c, &a, &b);
+        FUZZ_CHECK(code == ERR_OK, "matrix_multiply返回%s", error_code_name(code));
+        if (code == ERR_OK) {
+            check_equal(&c, expected, "乘积");
+        }
+    }
+
+    // 形状不匹配与累加矩阵即乘数
+    matrix wrong;
+    matrix_init(&wrong);
+    if (matrix_create(&wrong, type, k + 1, n) == ERR_OK) {
+        code = matrix_multiply(&c, &a, &wrong);
+        FUZZ_CHECK(code == ERR_MATRIX_SHAPE, "形状不匹配时返回%s", error_code_name(code));
+    }
+    if (m == k && matrix_create(&wrong, type, k, k) == ERR_OK && matrix_copy(&c, &a) == ERR_OK) {
+        code = matrix_multiply_add(&c, &c, &wrong);
+        FUZZ_CHECK(code == ERR_MATRIX_ALIAS, "累加矩阵即乘数时返回%s", error_code_name(code));
+    }
+    matrix_free(&wrong);
+    free(expected);
+    free(initial);
+
+cleanup:
+    matrix_free(&a);
+    matrix_free(&b);
+    matrix_free(&c);
+}
+
+static void check_power(matrix_type type, size_t dim, unsigned int exponent, const char* values, size_t len) {
+    matrix a, r;
+    matrix_init(&a);
+    matrix_init(&r);
+    size_t pos = 0;
+    if (matrix_create(&a, type, dim, dim) != ERR_OK || matrix_identity(&r, type, dim) != ERR_OK) {
+        goto cleanup;
+    }
+    fill(&a, values, len, &pos, 1);
+    // 参考：从单位矩阵起逐次右乘a
+    size_t count = dim * a.stride;
+    void* expected = dense_copy(&r);
+    void* next = calloc(count + 1, 8);
+    if (expected == NULL || next == NULL) {
+        free(expected);
+        free(next);
+        goto cleanup;
+    }
+    for (unsigned int e = 0; e < exponent; e++) {
+        reference_matrix_multiply(type, dim, dim, dim, expected, a.stride, a.data, a.stride, next, a.stride);
+        void* swap = expected;
+        expected = next;
+        next = swap;
+    }
+    error_code code = matrix_power(&a, &a, exponent);
+    FUZZ_CHECK(code == ERR_OK, "matrix_power返回%s", error_code_name(code));
+    if (code == ERR_OK) {
+        check_equal(&a, expected, "矩阵幂");
+    }
+    free(expected);
+    free(next);
+
+cleanup:
+    matrix_free(&a);
+    matrix_free(&r);
+}
+
+static void check_fibonacci(uint64_t n) {
+    uint64_t value = 0;
+    error_code code = matrix_fibonacci(n, &value);
+    uint64_t expected = reference_fibonacci_u64(n);
+    FUZZ_CHECK(code == ERR_OK && value == expected, "matrix_fibonacci(%llu)返回%s，值为%llu，应为%llu",
+               (unsigned long long)n, error_code_name(code), (unsigned long long)value,
+               (unsigned long long)expected);
+    int small = 0;
+    if (n <= 46 && fibonacci_checked((int)n, &small) == ERR_OK) {
+        FUZZ_CHECK((uint64_t)small == value, "F(%llu)与fibonacci_checked的结果%d不同", (unsigned long long)n, small);
+    }
+}
+
+void fuzz_matrix(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    size_t limit = flags & FLAG_LARGE ? LARGE_DIM : SMALL_DIM;
+    size_t m = fuzz_consume_u16(&in) % (limit + 1);
+    size_t n = fuzz_consume_u16(&in) % (limit + 1);
+    size_t k = fuzz_consume_u16(&in) % (limit + 1);
+    uint8_t exponent = fuzz_consume_u8(&in);
+    uint32_t index = ((uint32_t)fuzz_consume_u16(&in) << 16 | fuzz_consume_u16(&in)) % FIBONACCI_MAX;
+    char* values = fuzz_consume_string(&in);
+    if (values == NULL) {
+        return;
+    }
+    size_t len = strlen(values);
+    matrix_type type = types[flags & TYPE_MASK];
+    check_product(type, flags, m, n, k, values, len);
+    if (flags & FLAG_POWER) {
+        check_power(type, m % POWER_DIM + 1, exponent % (POWER_MAX_EXPONENT + 1), values, len);
+    }
+    if (flags & FLAG_FIBONACCI) {
+        check_fibonacci(index);
+    }
+    free(values);
+}
+
+/* 边界用例：{选项字节, m, n, k, 指数, 斐波那契索引} */
+static const struct {
+    uint8_t flags;
+    uint16_t m;
+    uint16_t n;
+    uint16_t k;
+    uint8_t exponent;
+    uint32_t index;
+} matrix_seeds[] = {
+    {0, 0, 0, 0, 0, 0},
+    {2 | FLAG_FIBONACCI, 1, 1, 1, 0, 1},
+    {2 | FLAG_POWER | FLAG_FIBONACCI, 3, 3, 3, 0, 2},
+    {1 | FLAG_FIBONACCI, 4, 5, 6, 0, 93},                       // F(93)超过2^63
+    {0 | FLAG_POWER | FLAG_FIBONACCI, 7, 7, 7, 12, 94},         // F(94)超过2^64，回绕
+    {2 | FLAG_LARGE, 48, 48, 48, 0, 0},                         // 三重循环与分块的分界
+    {2 | FLAG_LARGE, 49, 49, 49, 0, 0},
+    {0 | FLAG_LARGE, 97, 33, 257, 0, 0},                        // 边缘块与k方向的第二段
+    {1 | FLAG_LARGE | FLAG_ADD, 130, 130, 130, 0, 0},           // 超过并行阈值
+    {2 | FLAG_LARGE | FLAG_ALIAS, 200, 0, 300, 0, 0},
+    {2 | FLAG_LARGE, 320, 1, 320, 0, 0},                        // 单列
+    {0 | FLAG_LARGE | FLAG_ADD, 1, 320, 320, 0, 0},             // 单行
+    {1 | FLAG_POWER | FLAG_FIBONACCI, 8, 8, 8, 12, 1000000},
+};
+
+int seed_matrix(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(matrix_seeds) / sizeof(matrix_seeds[0]))) {
+        return 0;
+    }
+    fuzz_put_u8(out, matrix_seeds[index].flags);
+    fuzz_put_u16(out, matrix_seeds[index].m);
+    fuzz_put_u16(out, matrix_seeds[index].n);
+    fuzz_put_u16(out, matrix_seeds[index].k);
+    fuzz_put_u8(out, matrix_seeds[index].exponent);
+    fuzz_put_u16(out, (uint16_t)(matrix_seeds[index].index >> 16));
+    fuzz_put_u16(out, (uint16_t)matrix_seeds[index].index);
+    fuzz_put_string(out, "\x01\xff\x7f\x80\x03\xfd\x42", 1);
+    return 1;
+}
\ No newline at end of file
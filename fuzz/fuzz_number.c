@@ -0,0 +1,213 @@
+/**
+ * @file fuzz_number.c
+ * @brief 数值解析与格式化的模糊测试目标，浮点部分以libc的strtod和snprintf为参考
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz.h"
+#include "../include/number_ops.h"
+#include "../include/allocator.h"
+
+/* 选项字节中的位：把输入字符映射到数字相关的字母表，否则保留任意字节 */
+#define FLAG_NUMERIC_ALPHABET 0x80
+/* 选项字节的低2位选择批量解析的分隔符 */
+#define DELIMITER_MASK 0x03
+
+static const char numeric_alphabet[] = "0123456789000999+-.eE ,;\t\n\rinfa";
+static const char delimiters[] = {',', ';', '\t', '|'};
+
+static int same_double(double a, double b) {
+    if (a != a && b != b) {
+        return 1;
+    }
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+/* strtod读取前len个字符 */
+static double strtod_prefix(const char* str, size_t len, size_t* consumed) {
+    char* copy = (char*)malloc(len + 1);
+    if (copy == NULL) {
+        *consumed = 0;
+        return 0.0;
+    }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    char* end = copy;
+    double value = strtod(copy, &end);
+    *consumed = (size_t)(end - copy);
+    free(copy);
+    return value;
+}
+
+void fuzz_parse_numbers(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    char* text = fuzz_consume_string(&in);
+    if (text == NULL) {
+        return;
+    }
+    size_t len = strlen(text);
+    if (flags & FLAG_NUMERIC_ALPHABET) {
+        for (size_t i = 0; i < len; i++) {
+            text[i] = numeric_alphabet[(unsigned char)text[i] % (sizeof(numeric_alphabet) - 1)];
+        }
+    }
+
+    // 整数：与逐位累加的参考实现比较
+    int64_t expected = 0;
+    int64_t actual = 0;
+    size_t expected_used = 0;
+    size_t used = 0;
+    error_code expected_code = reference_parse_int64(text, len, &expected, &expected_used);
+    error_code code = parse_int64(text, len, &actual, &used);
+    FUZZ_CHECK(code == expected_code, "parse_int64返回%s，参考实现返回%s", error_code_name(code),
+               error_code_name(expected_code));
+    if (code == ERR_OK) {
+        FUZZ_CHECK(actual == expected && used == expected_used, "parse_int64的结果%lld（%zu个字符）应为%lld（%zu个字符）",
+                   (long long)actual, used, (long long)expected, expected_used);
+    }
+
+    // 浮点：strtod接受而本模块不接受的只有前导空白、十六进制和nan(...)，这些输入跳过
+    double value = 0.0;
+    code = parse_double(text, len, &value, &used);
+    int skipped = len > 0 && (text[0] == ' ' || text[0] == '\t' || text[0] == '\n' || text[0] == '\r' ||
+                              text[0] == '\f' || text[0] == '\v');
+    size_t digits_start = len > 0 && (text[0] == '-' || text[0] == '+') ? 1 : 0;
+    skipped |= len > digits_start + 1 && text[digits_start] == '0' && (text[digits_start + 1] | 0x20) == 'x';
+    if (!skipped) {
+        size_t reference_used = 0;
+        double reference = strtod_prefix(text, len, &reference_used);
+        if (code == ERR_OK) {
+            int is_nan = value != value;
+            FUZZ_CHECK(is_nan || same_double(value, reference), "parse_double(\"%.40s\")为%a，strtod为%a",
+                       text, value, reference);
+            FUZZ_CHECK(is_nan || used == reference_used, "parse_double使用%zu个字符，strtod使用%zu个",
+                       used, reference_used);
+        } else {
+            FUZZ_CHECK(code == ERR_NUMBER_INVALID && reference_used == 0, "parse_double返回%s，strtod读取了%zu个字符",
+                       error_code_name(code), reference_used);
+        }
+    }
+
+    // 批量解析：与按行、按分隔符逐个字段解析的参考实现比较
+    char delimiter = delimiters[flags & DELIMITER_MASK];
+    int64_t* values = NULL;
+    size_t count = 0;
+    int64_t* expected_values = NULL;
+    size_t expected_count = 0;
+    code = parse_int64_list(text, len, delimiter, &values, &count);
+    expected_code = reference_parse_int64_list(text, len, delimiter, &expected_values, &expected_count);
+    if (code != ERR_NUMBER_ALLOC && expected_code != ERR_NUMBER_ALLOC) {
+        FUZZ_CHECK(code == expected_code, "parse_int64_list返回%s，参考实现返回%s", error_code_name(code),
+                   error_code_name(expected_code));
+        if (code == ERR_OK) {
+            FUZZ_CHECK(count == expected_count, "parse_int64_list得到%zu个数，参考实现为%zu个", count, expected_count);
+            FUZZ_CHECK(count == 0 || memcmp(values, expected_values, count * sizeof(int64_t)) == 0,
+                       "parse_int64_list的结果与参考实现不同");
+        }
+    }
+    mem_free(values);
+    free(expected_values);
+    free(text);
+}
+
+void fuzz_format_numbers(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint64_t bits = 0;
+    for (int i = 0; i < 4; i++) {
+        bits |= (uint64_t)fuzz_consume_u16(&in) << (16 * i);
+    }
+
+    char buffer[NUMBER_DOUBLE_BUFFER];
+    char reference[64];
+    size_t len = format_int64((int64_t)bits, buffer);
+    snprintf(reference, sizeof(reference), "%lld", (long long)(int64_t)bits);
+    FUZZ_CHECK(strcmp(buffer, reference) == 0 && len == strlen(reference), "format_int64输出%s，应为%s",
+               buffer, reference);
+    format_uint64(bits, buffer);
+    snprintf(reference, sizeof(reference), "%llu", (unsigned long long)bits);
+    FUZZ_CHECK(strcmp(buffer, reference) == 0, "format_uint64输出%s，应为%s", buffer, reference);
+
+    // 浮点：读回得到同一个值，且有效数字不多于能读回的最短%.*e表示
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    len = format_double(value, buffer);
+    FUZZ_CHECK(len == strlen(buffer) && len < NUMBER_DOUBLE_BUFFER, "format_double的长度错误");
+    double back = strtod(buffer, NULL);
+    FUZZ_CHECK(same_double(back, value), "format_double(%a)输出%s，读回%a", value, buffer, back);
+    double parsed = 0.0;
+    size_t used = 0;
+    FUZZ_CHECK(parse_double(buffer, len, &parsed, &used) == ERR_OK && used == len && same_double(parsed, value),
+               "parse_double读不回format_double的输出%s", buffer);
+    if (value == value && value - value == 0.0 && value != 0.0) {
+        int shortest = 1;
+        for (; shortest < 17; shortest++) {
+            snprintf(reference, sizeof(reference), "%.*e", shortest - 1, value);
+            if (strtod(reference, NULL) == value) {
+                break;
+            }
+        }
+        // 数出有效数字：去掉指数、前导零和整数末尾补的零
+        int digits = 0;
+        int pending_zeros = 0;
+        int started = 0;
+        for (const char* c = buffer; *c != '\0' && *c != 'e'; c++) {
+            if (*c < '0' || *c > '9') {
+                continue;
+            }
+            if (*c == '0') {
+                pending_zeros += started;
+                continue;
+            }
+            started = 1;
+            digits += pending_zeros + 1;
+            pending_zeros = 0;
+        }
+        FUZZ_CHECK(digits <= shortest, "format_double输出%s有%d位有效数字，最短表示%s只有%d位", buffer, digits,
+                   reference, shortest);
+    }
+}
+
+/* 边界用例：整数与浮点的溢出临界值、舍入的中间值、次正规数和批量解析的格式 */
+static const char* const number_seeds[] = {
+    "", "0", "-0", "+7", "-", "+", "00000000000000000000000000012",
+    "9223372036854775807", "9223372036854775808", "-9223372036854775808", "-9223372036854775809",
+    "18446744073709551615", "18446744073709551616", "99999999999999999999",
+    "12345678", "1234567890123456", "123456789012345678x",
+    "0.1", "5.", ".5", ".", "-.e1", "1e", "1e+", "1e-400", "1e400", "4.9e-324",
+    "2.4703282292062327e-324", "2.4703282292062328e-324", "2.2250738585072011e-308",
+    "1.7976931348623157e308", "1.7976931348623159e308", "9007199254740993", "1e23",
+    "7.2057594037927933e16", "123456789012345678901234567890e-10",
+    "1.00000000000000011102230246251565404236316680908203125", "inf", "-Infinity", "nan",
+    "1,2,3\n4,5,6\n", "1,,2", "1,2,", " 7 , 8 \r\n\n9", "1;2;3", "1\t2\t3\n", "1|2|x",
+};
+
+int seed_parse_numbers(int index, fuzz_buffer* out) {
+    int count = (int)(sizeof(number_seeds) / sizeof(number_seeds[0]));
+    if (index >= count * 4) {
+        return 0;
+    }
+    // 每个用例以四种分隔符各测一次
+    fuzz_put_u8(out, (uint8_t)(index / count));
+    fuzz_put_string(out, number_seeds[index % count], 1);
+    return 1;
+}
+
+static const uint64_t format_seeds[] = {
+    0x0000000000000000ULL, 0x8000000000000000ULL, 0x0000000000000001ULL, 0x000FFFFFFFFFFFFFULL,
+    0x0010000000000000ULL, 0x7FEFFFFFFFFFFFFFULL, 0x7FF0000000000000ULL, 0xFFF0000000000000ULL,
+    0x7FF8000000000000ULL, 0x3FF0000000000000ULL, 0x3FB999999999999AULL, 0x4340000000000000ULL,
+    0x4350000000000000ULL, 0x44B52D02C7E14AF6ULL, 0x7FFFFFFFFFFFFFFFULL, 0x0000000005F5E100ULL,
+    0x00000002540BE3FFULL, 0x002386F26FC10000ULL, 0x8AC7230489E80000ULL,
+};
+
+int seed_format_numbers(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(format_seeds) / sizeof(format_seeds[0]))) {
+        return 0;
+    }
+    for (int i = 0; i < 4; i++) {
+        fuzz_put_u16(out, (uint16_t)(format_seeds[index] >> (16 * i)));
+    }
+    return 1;
+}
\ No newline at end of file
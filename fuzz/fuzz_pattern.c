@@ -0,0 +1,330 @@
+/**
+ * @file fuzz_pattern.c
+ * @brief 模式匹配的模糊测试目标：glob与fnmatch比较，按语法生成的正则表达式的匹配范围与
+ *        regcomp(REG_EXTENDED)/regexec比较，逐行过滤与逐行参考匹配比较，任意字节的模式只检查健壮性
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <fnmatch.h>
+#include <regex.h>
+#include "fuzz.h"
+#include "../include/pattern_ops.h"
+
+/* 选项字节的低2位选择模式的来源 */
+#define MODE_MASK 0x03
+#define MODE_GLOB 0           /* 由glob字母表组成的模式，与fnmatch比较 */
+#define MODE_REGEX 1          /* 按语法生成的正则表达式，与regexec比较 */
+#define MODE_RAW 2            /* 任意字节作为正则表达式 */
+#define MODE_RAW_GLOB 3       /* 任意字节作为glob */
+/* 选项字节中的位：忽略大小写 */
+#define FLAG_ICASE 0x04
+/* 正则表达式生成的嵌套层数与各层的规模 */
+#define MAX_GEN_DEPTH 3
+#define MAX_BRANCHES 3
+#define MAX_PIECES 4
+/* 参与逐个位置比较的文本长度上限，参考实现逐次调用regexec */
+#define MAX_SEARCH_TEXT 512
+#define MAX_SEARCHES 64
+
+static const char glob_alphabet[] = "ab*?[]!^-\\";
+static const char glob_text_alphabet[] = "abAB[]!^-\\*?";
+static const char regex_text_alphabet[] = "abcabcAB";
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} text_buffer;
+
+static int append(text_buffer* b, const char* s) {
+    size_t n = strlen(s);
+    if (b->len + n + 1 > b->cap) {
+        size_t cap = b->cap > 0 ? b->cap * 2 : 64;
+        while (cap < b->len + n + 1) {
+            cap *= 2;
+        }
+        char* grown = (char*)realloc(b->data, cap);
+        if (grown == NULL) {
+            return 0;
+        }
+        b->data = grown;
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, s, n + 1);
+    b->len += n;
+    return 1;
+}
+
+static int gen_alternation(fuzz_input* in, text_buffer* out, int depth, int repeated);
+
+/* 原子后可跟一个量词；^与$不加量词，也不出现在加了量词的分组中：glibc展开{m,n}后的^会在文本中间匹配 */
+static int gen_piece(fuzz_input* in, text_buffer* out, int depth, int repeated) {
+    static const char* const atoms[] = {"a", "b", "c", "a", "b", ".", "[ab]", "[^a]", "[a-c]", "[^bc]"};
+    static const char* const quantifiers[] = {"*", "+", "?", "{2}", "{1,}", "{0,2}", "{1,3}", "{0,1}"};
+    uint8_t choice = fuzz_consume_u8(in);
+    int ok;
+    repeated |= (choice & 0x80) != 0;
+    if (choice % 16 < 10) {
+        ok = append(out, atoms[choice % 16]);
+    } else if (choice % 16 < 13 && depth < MAX_GEN_DEPTH) {
+        ok = append(out, "(") && gen_alternation(in, out, depth + 1, repeated) && append(out, ")");
+    } else if (choice % 16 == 13 && !repeated) {
+        return append(out, "^");
+    } else if (choice % 16 == 14 && !repeated) {
+        return append(out, "$");
+    } else {
+        ok = append(out, atoms[choice % 5]);
+    }
+    if (ok && (choice & 0x80)) {
+        ok = append(out, quantifiers[(choice >> 4) & 0x07]);
+    }
+    return ok;
+}
+
+static int gen_alternation(fuzz_input* in, text_buffer* out, int depth, int repeated) {
+    int branches = 1 + fuzz_consume_u8(in) % MAX_BRANCHES;
+    for (int b = 0; b < branches; b++) {
+        if (b > 0 && !append(out, "|")) {
+            return 0;
+        }
+        int pieces = 1 + fuzz_consume_u8(in) % MAX_PIECES;
+        for (int i = 0; i < pieces; i++) {
+            if (!gen_piece(in, out, depth, repeated)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/* 把字符串的每个字节映射到字母表中；newline时约七分之一的字节映射为换行符以分行 */
+static void map_alphabet(char* s, const char* alphabet, int newline) {
+    size_t n = strlen(alphabet);
+    for (char* p = s; *p != '\0'; p++) {
+        unsigned int c = (unsigned char)*p;
+        *p = newline && c % 7 == 0 ? '\n' : alphabet[c % n];
+    }
+}
+
+typedef struct {
+    const char* text;
+    size_t next;             /* 下一行的起始位置 */
+    size_t lines;
+    const char* pattern;
+} line_check;
+
+static error_code check_line(const char* line, size_t len, void* ctx) {
+    line_check* lc = (line_check*)ctx;
+    FUZZ_CHECK(line >= lc->text + lc->next, "模式%s：逐行过滤的行不是递增的", lc->pattern);
+    FUZZ_CHECK(line == lc->text || line[-1] == '\n', "模式%s：逐行过滤的行不在行首", lc->pattern);
+    FUZZ_CHECK(line[len] == '\n' || line[len] == '\0', "模式%s：逐行过滤的行不在行尾结束", lc->pattern);
+    lc->next = (size_t)(line - lc->text) + len;
+    lc->lines++;
+    return ERR_OK;
+}
+
+/* 参考：逐行调用reference_match，行以'\0'结尾 */
+typedef int (*line_reference)(const void* ref, const char* line);
+
+static void check_lines(const pattern* p, const char* source, char* text, line_reference reference,
+                        const void* ref) {
+    size_t expected = 0;
+    char* line = text;
+    for (;;) {
+        char* newline = strchr(line, '\n');
+        if (newline != NULL) {
+            *newline = '\0';
+        }
+        int match = reference(ref, line);
+        FUZZ_CHECK(pattern_match(p, line, strlen(line)) == match, "模式%s：行\"%s\"的匹配结果应为%d",
+                   source, line, match);
+        expected += (size_t)match;
+        if (newline == NULL) {
+            break;
+        }
+        *newline = '\n';
+        line = newline + 1;
+    }
+    // 末尾的换行符之后没有行，空文本没有行
+    size_t len = strlen(text);
+    if (len == 0 || text[len - 1] == '\n') {
+        expected -= (size_t)reference(ref, "");
+    }
+    line_check lc = {text, 0, 0, source};
+    size_t count = 0;
+    error_code code = pattern_filter_lines(p, text, len, check_line, &lc, &count);
+    FUZZ_CHECK(code == ERR_OK, "模式%s：逐行过滤返回%s", source, error_code_name(code));
+    FUZZ_CHECK(count == expected && lc.lines == expected, "模式%s：逐行过滤匹配%zu行，应为%zu行", source, count,
+               expected);
+}
+
+typedef struct {
+    int flags;
+    const char* source;
+} glob_ref;
+
+static int glob_line_reference(const void* ref, const char* line) {
+    const glob_ref* g = (const glob_ref*)ref;
+    return fnmatch(g->source, line, g->flags) == 0;
+}
+
+static void check_glob(char* source, char* text, int icase) {
+    map_alphabet(source, glob_alphabet, 0);
+    map_alphabet(text, glob_text_alphabet, 1);
+    pattern* p = NULL;
+    error_code code = pattern_compile(source, PATTERN_GLOB | (icase ? PATTERN_ICASE : 0), &p);
+    if (code == ERR_PATTERN_TOO_LARGE) {
+        return;
+    }
+    FUZZ_CHECK(code == ERR_OK, "glob %s：编译返回%s", source, error_code_name(code));
+    glob_ref ref = {icase ? FNM_CASEFOLD : 0, source};
+    check_lines(p, source, text, glob_line_reference, &ref);
+    pattern_free(p);
+}
+
+static int regex_line_reference(const void* ref, const char* line) {
+    return regexec((const regex_t*)ref, line, 0, NULL, 0) == 0;
+}
+
+/* 从text的各个位置依次查找，与regexec（起点之后^不匹配）的整体匹配范围比较 */
+static void check_search(const pattern* p, const char* source, const regex_t* re, const char* text) {
+    size_t len = strlen(text);
+    size_t from = 0;
+    for (int i = 0; i < MAX_SEARCHES && from <= len; i++) {
+        regmatch_t m;
+        int expected = regexec(re, text + from, 1, &m, from > 0 ? REG_NOTBOL : 0) == 0;
+        pattern_span span = {0, 0};
+        int found = pattern_search(p, text, len, from, &span);
+        FUZZ_CHECK(found == expected, "模式%s：在\"%s\"中从%zu查找的结果应为%d", source, text, from, expected);
+        FUZZ_CHECK(pattern_search(p, text, len, from, NULL) == expected, "模式%s：不求范围的查找结果不同",
+                   source);
+        if (!expected) {
+            break;
+        }
+        size_t start = from + (size_t)m.rm_so;
+        size_t end = from + (size_t)m.rm_eo;
+        FUZZ_CHECK(span.start == start && span.end == end, "模式%s：在\"%s\"中从%zu查找的范围为[%zu, %zu)，应为[%zu, %zu)",
+                   source, text, from, span.start, span.end, start, end);
+        from = end > start ? end : end + 1;
+    }
+}
+
+static void check_regex(fuzz_input* in, char* text, int icase) {
+    text_buffer source = {NULL, 0, 0};
+    if (!append(&source, "") || !gen_alternation(in, &source, 0, 0)) {
+        free(source.data);
+        return;
+    }
+    regex_t re;
+    if (regcomp(&re, source.data, REG_EXTENDED | (icase ? REG_ICASE : 0)) != 0) {
+        free(source.data);
+        return;
+    }
+    pattern* p = NULL;
+    error_code code = pattern_compile(source.data, icase ? PATTERN_ICASE : 0, &p);
+    if (code == ERR_PATTERN_TOO_LARGE) {
+        regfree(&re);
+        free(source.data);
+        return;
+    }
+    FUZZ_CHECK(code == ERR_OK, "模式%s：编译返回%s", source.data, error_code_name(code));
+    map_alphabet(text, regex_text_alphabet, 1);
+    // 查找只比较第一行，regexec的.可以匹配换行符
+    char* newline = strchr(text, '\n');
+    size_t first = newline != NULL ? (size_t)(newline - text) : strlen(text);
+    if (first > MAX_SEARCH_TEXT) {
+        first = MAX_SEARCH_TEXT;
+    }
+    char saved = text[first];
+    text[first] = '\0';
+    check_search(p, source.data, &re, text);
+    text[first] = saved;
+    check_lines(p, source.data, text, regex_line_reference, &re);
+    pattern_free(p);
+    regfree(&re);
+    free(source.data);
+}
+
+/* 任意字节的模式：编译可以失败，成功时匹配与查找的结果必须自洽 */
+static void check_raw(const char* source, const char* text, int flags) {
+    pattern* p = NULL;
+    error_code code = pattern_compile(source, flags, &p);
+    FUZZ_CHECK(code == ERR_OK || code == ERR_PATTERN_SYNTAX || code == ERR_PATTERN_TOO_LARGE,
+               "模式%s：编译返回%s", source, error_code_name(code));
+    if (code != ERR_OK) {
+        FUZZ_CHECK(p == NULL, "模式%s：编译失败时输出不为NULL", source);
+        return;
+    }
+    size_t len = strlen(text);
+    pattern_span span = {0, 0};
+    int found = pattern_search(p, text, len, 0, &span);
+    FUZZ_CHECK(found == pattern_match(p, text, len), "模式%s：查找与匹配的结果不同", source);
+    if (found) {
+        FUZZ_CHECK(span.start <= span.end && span.end <= len, "模式%s：匹配范围[%zu, %zu)无效", source, span.start,
+                   span.end);
+    }
+    size_t count = 0;
+    FUZZ_CHECK(pattern_filter_lines(p, text, len, NULL, NULL, &count) == ERR_OK, "模式%s：逐行过滤失败", source);
+    pattern_free(p);
+}
+
+void fuzz_pattern(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    int icase = (flags & FLAG_ICASE) != 0;
+    char* source = fuzz_consume_string(&in);
+    char* text = fuzz_consume_string(&in);
+    if (source != NULL && text != NULL) {
+        switch (flags & MODE_MASK) {
+        case MODE_GLOB:
+            check_glob(source, text, icase);
+            break;
+        case MODE_REGEX: {
+            // 正则表达式按其余输入生成，source只用作生成的字节
+            fuzz_input gen = {(const uint8_t*)source, strlen(source), 0};
+            check_regex(&gen, text, icase);
+            break;
+        }
+        default:
+            check_raw(source, text, ((flags & MODE_MASK) == MODE_RAW_GLOB ? PATTERN_GLOB : 0) |
+                                        (icase ? PATTERN_ICASE : 0));
+            break;
+        }
+    }
+    pattern* p = NULL;
+    FUZZ_CHECK(pattern_compile(NULL, 0, &p) == ERR_PATTERN_NULL, "空模式应返回ERR_PATTERN_NULL");
+    free(source);
+    free(text);
+}
+
+/* 边界用例：{选项字节, 模式, 文本片段, 重复次数} */
+static const struct {
+    uint8_t flags;
+    const char* source;
+    const char* text;
+    uint16_t repeat;
+} pattern_seeds[] = {
+    {MODE_RAW_GLOB, "*.c", "main.c\nmain.h\n.c\n", 1},
+    {MODE_RAW_GLOB, "[!a-c]x[[:digit:]]", "dx1\nax1\n[x2\n", 1},
+    {MODE_RAW_GLOB, "[a", "[a\na\n", 1},                              // 没有结束的方括号
+    {MODE_RAW, "(a|ab)(c|bcd)(d*)", "abcd", 1},
+    {MODE_RAW, "^(ab|a)*b$", "ab", 2000},                             // 长文本，状态很少
+    {MODE_RAW, "x[a-z]{3}y|needle", "haystack without it; ", 3000},  // 字面前缀不存在
+    {MODE_RAW, "(a|b)*a(a|b){12}", "ab", 500},                        // DFA状态数随长度指数增长
+    {MODE_RAW, "a{1000}{1000}", "a", 10},                             // 展开后过大
+    {MODE_RAW, "(((a)", "a", 1},                                      // 括号不匹配
+    {MODE_RAW | FLAG_ICASE, "[^a]b\\w+$", "Ab\nxBcd\n", 1},
+    {MODE_REGEX, "\x11\x05\x8b\x03\x20", "abcab", 4},
+    {MODE_GLOB, "\x01\x02\x03\x04\x05\x06", "\x01\x02", 20},
+};
+
+int seed_pattern(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(pattern_seeds) / sizeof(pattern_seeds[0]))) {
+        return 0;
+    }
+    fuzz_put_u8(out, pattern_seeds[index].flags);
+    fuzz_put_string(out, pattern_seeds[index].source, 1);
+    fuzz_put_string(out, pattern_seeds[index].text, pattern_seeds[index].repeat);
+    return 1;
+}
\ No newline at end of file
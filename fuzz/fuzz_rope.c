@@ -0,0 +1,292 @@
+/**
+ * @file fuzz_rope.c
+ * @brief 文本编辑结构的模糊测试目标：对两个rope执行一串编辑，与以memmove编辑的连续缓冲区比较
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fuzz.h"
+#include "../include/rope_ops.h"
+#include "../include/allocator.h"
+
+/* 一个输入最多执行的操作数 */
+#define MAX_OPS 4096
+/* 参考缓冲区的长度上限，超过时跳过插入 */
+#define MAX_TEXT (4 << 20)
+
+/* 操作字节的低3位为操作，第3位选择对另一个rope操作 */
+#define OP_INSERT 0
+#define OP_APPEND 1
+#define OP_DELETE 2
+#define OP_APPEND_OWNED 3
+#define OP_CONCAT 4
+#define OP_FLATTEN 5
+#define OP_EXTRACT 6
+#define OP_ERRORS 7
+#define OP_OTHER 0x08
+
+/* rope与作为参考的连续缓冲区 */
+typedef struct {
+    rope text;
+    char* expected;
+    size_t len;
+} edit_pair;
+
+static int reserve(edit_pair* p, size_t add) {
+    char* grown = (char*)realloc(p->expected, p->len + add + 1);
+    if (grown == NULL) {
+        return 0;
+    }
+    p->expected = grown;
+    return 1;
+}
+
+static void check_same(const edit_pair* p, const char* actual, size_t len, const char* what) {
+    FUZZ_CHECK(len == p->len, "%s的长度为%zu，应为%zu", what, len, p->len);
+    if (memcmp(actual, p->expected, len) != 0) {
+        size_t i = 0;
+        while (actual[i] == p->expected[i]) {
+            i++;
+        }
+        FUZZ_CHECK(0, "%s在第%zu个字节与参考结果不同（共%zu个）", what, i, len);
+    }
+}
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t pieces;
+} gathered;
+
+static error_code gather_piece(const char* data, size_t len, void* ctx) {
+    gathered* g = (gathered*)ctx;
+    FUZZ_CHECK(len > 0, "rope_for_each_piece给出空片段");
+    memcpy(g->data + g->len, data, len);
+    g->len += len;
+    g->pieces++;
+    return ERR_OK;
+}
+
+/* 逐片段读出与写入文件两种方式都与参考结果比较 */
+static void check_contents(edit_pair* p) {
+    FUZZ_CHECK(p->text.length == p->len, "rope长度为%zu，应为%zu", p->text.length, p->len);
+    gathered g = {(char*)malloc(p->len + 1), 0, 0};
+    if (g.data == NULL) {
+        return;
+    }
+    error_code code = rope_for_each_piece(&p->text, gather_piece, &g);
+    FUZZ_CHECK(code == ERR_OK, "rope_for_each_piece返回%s", error_code_name(code));
+    check_same(p, g.data, g.len, "逐片段读出的文本");
+    FUZZ_CHECK(g.pieces == p->text.pieces, "片段数为%zu，记录的为%zu", g.pieces, p->text.pieces);
+
+    FILE* file = tmpfile();
+    if (file != NULL) {
+        code = rope_write_fd(&p->text, fileno(file));
+        FUZZ_CHECK(code == ERR_OK, "rope_write_fd返回%s", error_code_name(code));
+        size_t read_len = 0;
+        if (lseek(fileno(file), 0, SEEK_SET) == 0) {
+            ssize_t n;
+            while (read_len < p->len && (n = read(fileno(file), g.data + read_len, p->len - read_len)) > 0) {
+                read_len += (size_t)n;
+            }
+        }
+        check_same(p, g.data, read_len, "写出的文件");
+        fclose(file);
+    }
+    free(g.data);
+}
+
+static void do_insert(edit_pair* p, size_t pos, const char* text, size_t len, int append) {
+    if (p->len + len > MAX_TEXT || !reserve(p, len)) {
+        return;
+    }
+    error_code code = append ? rope_append(&p->text, text, len) : rope_insert(&p->text, pos, text, len);
+    FUZZ_CHECK(code == ERR_OK, "插入%zu字节返回%s", len, error_code_name(code));
+    memmove(p->expected + pos + len, p->expected + pos, p->len - pos);
+    memcpy(p->expected + pos, text, len);
+    p->len += len;
+}
+
+static void do_extract(const edit_pair* p, size_t pos, size_t len) {
+    char* out = (char*)malloc(len + 1);
+    if (out == NULL) {
+        return;
+    }
+    error_code code = rope_extract(&p->text, pos, len, out);
+    FUZZ_CHECK(code == ERR_OK, "读取[%zu, %zu)返回%s", pos, pos + len, error_code_name(code));
+    FUZZ_CHECK(memcmp(out, p->expected + pos, len) == 0, "读取的[%zu, %zu)与参考结果不同", pos, pos + len);
+    free(out);
+}
+
+static void do_errors(edit_pair* p, edit_pair* other) {
+    error_code code = rope_insert(&p->text, p->len + 1, "x", 1);
+    FUZZ_CHECK(code == ERR_ROPE_RANGE, "在末尾之后插入返回%s", error_code_name(code));
+    code = rope_delete(&p->text, p->len, 1);
+    FUZZ_CHECK(code == ERR_ROPE_RANGE, "删除末尾之后的字节返回%s", error_code_name(code));
+    code = rope_delete(&p->text, 1, (size_t)-1);
+    FUZZ_CHECK(code == ERR_ROPE_RANGE, "删除长度溢出时返回%s", error_code_name(code));
+    code = rope_concat(&p->text, &p->text);
+    FUZZ_CHECK(code == ERR_ROPE_ALIAS, "拼接到自身返回%s", error_code_name(code));
+    code = rope_extract(&other->text, 0, other->len + 1, p->expected);
+    FUZZ_CHECK(code == ERR_ROPE_RANGE, "读取超出末尾返回%s", error_code_name(code));
+}
+
+void fuzz_rope(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    edit_pair pairs[2];
+    for (int i = 0; i < 2; i++) {
+        rope_init(&pairs[i].text);
+        pairs[i].expected = (char*)malloc(1);
+        pairs[i].len = 0;
+        if (pairs[i].expected == NULL) {
+            free(pairs[0].expected);
+            return;
+        }
+    }
+    for (int ops = 0; ops < MAX_OPS && in.pos < in.size; ops++) {
+        uint8_t op = fuzz_consume_u8(&in);
+        edit_pair* p = &pairs[(op & OP_OTHER) ? 1 : 0];
+        edit_pair* other = &pairs[(op & OP_OTHER) ? 0 : 1];
+        switch (op & 0x07) {
+            case OP_INSERT:
+            case OP_APPEND: {
+                size_t pos = (op & 0x07) == OP_APPEND ? p->len : fuzz_consume_u16(&in) % (p->len + 1);
+                char* text = fuzz_consume_string(&in);
+                if (text != NULL) {
+                    do_insert(p, pos, text, strlen(text), (op & 0x07) == OP_APPEND);
+                    free(text);
+                }
+                break;
+            }
+            case OP_DELETE: {
+                size_t pos = fuzz_consume_u16(&in) % (p->len + 1);
+                size_t len = fuzz_consume_u16(&in) % (p->len - pos + 1);
+                error_code code = rope_delete(&p->text, pos, len);
+                FUZZ_CHECK(code == ERR_OK, "删除[%zu, %zu)返回%s", pos, pos + len, error_code_name(code));
+                memmove(p->expected + pos, p->expected + pos + len, p->len - pos - len);
+                p->len -= len;
+                break;
+            }
+            case OP_APPEND_OWNED: {
+                char* input = fuzz_consume_string(&in);
+                if (input == NULL) {
+                    break;
+                }
+                size_t len = strlen(input);
+                // rope以mem_free释放缓冲区
+                char* text = p->len + len <= MAX_TEXT && reserve(p, len) ? (char*)mem_alloc(len + 1) : NULL;
+                if (text == NULL) {
+                    free(input);
+                    break;
+                }
+                memcpy(text, input, len + 1);
+                free(input);
+                memcpy(p->expected + p->len, text, len);
+                p->len += len;
+                error_code code = rope_append_owned(&p->text, text, len);
+                FUZZ_CHECK(code == ERR_OK, "追加缓冲区返回%s", error_code_name(code));
+                break;
+            }
+            case OP_CONCAT:
+                if (p->len + other->len <= MAX_TEXT && reserve(p, other->len)) {
+                    error_code code = rope_concat(&p->text, &other->text);
+                    FUZZ_CHECK(code == ERR_OK, "拼接返回%s", error_code_name(code));
+                    FUZZ_CHECK(other->text.length == 0 && other->text.pieces == 0, "拼接后源文本不为空");
+                    memcpy(p->expected + p->len, other->expected, other->len);
+                    p->len += other->len;
+                    other->len = 0;
+                }
+                break;
+            case OP_FLATTEN: {
+                const char* text = NULL;
+                error_code code = rope_flatten(&p->text, &text);
+                FUZZ_CHECK(code == ERR_OK, "展平返回%s", error_code_name(code));
+                check_same(p, text, strlen(text), "展平的文本");
+                FUZZ_CHECK(p->text.pieces <= 1, "展平后有%zu个片段", p->text.pieces);
+                break;
+            }
+            case OP_EXTRACT: {
+                size_t pos = fuzz_consume_u16(&in) % (p->len + 1);
+                do_extract(p, pos, fuzz_consume_u16(&in) % (p->len - pos + 1));
+                break;
+            }
+            default:
+                do_errors(p, other);
+                break;
+        }
+        FUZZ_CHECK(p->text.length == p->len, "操作%d后长度为%zu，应为%zu", op & 0x07, p->text.length, p->len);
+    }
+    for (int i = 0; i < 2; i++) {
+        check_contents(&pairs[i]);
+        rope_free(&pairs[i].text);
+        free(pairs[i].expected);
+    }
+}
+
+/* 边界用例：{操作字节, 位置, 长度或重复次数, 片段} 的序列，以操作字节0xff结束 */
+static const struct {
+    uint8_t op;
+    uint16_t pos;
+    uint16_t n;
+    const char* chunk;
+} rope_seeds[][12] = {
+    // 逐字符输入：连续追加只延长同一个片段
+    {{OP_APPEND, 0, 1, "a"}, {OP_APPEND, 0, 1, "b"}, {OP_INSERT, 2, 1, "c"}, {OP_INSERT, 1, 1, "x"},
+     {OP_FLATTEN, 0, 0, NULL}, {0xff, 0, 0, NULL}},
+    // 大文件中分散的小编辑
+    {{OP_APPEND_OWNED, 0, 5000, "0123456789abcdef"}, {OP_INSERT, 100, 1, "<ins>"}, {OP_DELETE, 7, 300, NULL},
+     {OP_INSERT, 65535, 1, "tail"}, {OP_DELETE, 40000, 9000, NULL}, {OP_EXTRACT, 50, 20000, NULL},
+     {OP_INSERT, 0, 1, "head"}, {0xff, 0, 0, NULL}},
+    // 超过半个追加块的插入单独占一个块
+    {{OP_APPEND, 0, 3000, "0123456789abcdef"}, {OP_INSERT, 17, 3000, "ZYXWVUTSRQPONMLK"},
+     {OP_DELETE, 0, 65535, NULL}, {OP_FLATTEN, 0, 0, NULL}, {0xff, 0, 0, NULL}},
+    // 拼接、展平后再编辑，源文本在拼接后继续使用
+    {{OP_APPEND | OP_OTHER, 0, 10, "other"}, {OP_APPEND, 0, 10, "main"}, {OP_CONCAT, 0, 0, NULL},
+     {OP_APPEND | OP_OTHER, 0, 1, "again"}, {OP_CONCAT, 0, 0, NULL}, {OP_FLATTEN, 0, 0, NULL},
+     {OP_INSERT, 3, 1, "!"}, {OP_CONCAT | OP_OTHER, 0, 0, NULL}, {OP_ERRORS, 0, 0, NULL}, {0xff, 0, 0, NULL}},
+    // 删除全部文本、空文本上的操作
+    {{OP_ERRORS, 0, 0, NULL}, {OP_FLATTEN, 0, 0, NULL}, {OP_APPEND, 0, 2, "xy"}, {OP_DELETE, 0, 4, NULL},
+     {OP_EXTRACT, 0, 0, NULL}, {OP_CONCAT, 0, 0, NULL}, {0xff, 0, 0, NULL}},
+};
+
+static void put_op(fuzz_buffer* out, uint8_t op, uint16_t pos, uint16_t n, const char* chunk) {
+    fuzz_put_u8(out, op);
+    switch (op & 0x07) {
+        case OP_INSERT:
+            fuzz_put_u16(out, pos);
+            fuzz_put_string(out, chunk, n);
+            break;
+        case OP_APPEND:
+        case OP_APPEND_OWNED:
+            fuzz_put_string(out, chunk, n);
+            break;
+        case OP_DELETE:
+        case OP_EXTRACT:
+            fuzz_put_u16(out, pos);
+            fuzz_put_u16(out, n);
+            break;
+        default:
+            break;
+    }
+}
+
+int seed_rope(int index, fuzz_buffer* out) {
+    int seeds = (int)(sizeof(rope_seeds) / sizeof(rope_seeds[0]));
+    if (index < seeds) {
+        for (int i = 0; rope_seeds[index][i].op != 0xff; i++) {
+            put_op(out, rope_seeds[index][i].op, rope_seeds[index][i].pos, rope_seeds[index][i].n,
+                   rope_seeds[index][i].chunk);
+        }
+        return 1;
+    }
+    if (index > seeds) {
+        return 0;
+    }
+    // 大量交替的小插入与删除，片段数超过writev一批的个数
+    for (int i = 0; i < 1500; i++) {
+        put_op(out, OP_INSERT, (uint16_t)(i * 7919), 1, i % 2 ? "ab" : "xyz");
+        put_op(out, OP_DELETE, (uint16_t)(i * 104729), 1, NULL);
+    }
+    return 1;
+}
\ No newline at end of file
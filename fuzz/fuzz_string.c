@@ -0,0 +1,501 @@
+/**
+ * @file fuzz_string.c
+ * @brief string_replace、string_split与编码、解码的模糊测试目标
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz.h"
+#include "../include/utils.h"
+#include "../include/string_ops.h"
+#include "../include/allocator.h"
+
+/* 选项字节中的位：把某个参数替换为NULL，低2位选择参数 */
+#define FLAG_NULL_ARGUMENT 0x80
+/* 替换结果的最大长度，超过时截短新子字符串 */
+#define MAX_REPLACE_RESULT (16 << 20)
+
+typedef error_code (*replace_fn)(const char* str, const char* old_substr, const char* new_substr,
+                                 char** result);
+typedef error_code (*split_fn)(const char* str, const char* delimiter, char*** parts, int* count);
+
+static error_code replace_legacy(const char* str, const char* old_substr, const char* new_substr,
+                                 char** result) {
+    *result = string_replace(str, old_substr, new_substr);
+    return *result != NULL ? ERR_OK : get_last_error();
+}
+
+static error_code split_legacy(const char* str, const char* delimiter, char*** parts, int* count) {
+    *parts = string_split(str, delimiter, count);
+    return *parts != NULL ? ERR_OK : get_last_error();
+}
+
+/* 被测实现，与参考实现逐一比较；新的优化版本加在这里 */
+static const struct {
+    const char* name;
+    replace_fn fn;
+} replace_variants[] = {
+    {"string_replace_checked", string_replace_checked},
+    {"string_replace", replace_legacy},
+};
+
+static const struct {
+    const char* name;
+    split_fn fn;
+} split_variants[] = {
+    {"string_split_checked", string_split_checked},
+    {"string_split", split_legacy},
+};
+
+/* 被测函数的结果用mem_free释放，参考实现的结果用free释放 */
+static void free_parts(char** parts, int count, void (*release)(void*)) {
+    for (int i = 0; parts != NULL && i < count; i++) {
+        release(parts[i]);
+    }
+    release(parts);
+}
+
+void fuzz_string_replace(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    char* str = fuzz_consume_string(&in);
+    char* old_substr = fuzz_consume_string(&in);
+    char* new_substr = fuzz_consume_string(&in);
+    if (str == NULL || old_substr == NULL || new_substr == NULL) {
+        free(str);
+        free(old_substr);
+        free(new_substr);
+        return;
+    }
+    // 每个位置都匹配时结果长度约为(str_len / old_len) * new_len，限制在MAX_REPLACE_RESULT以内
+    size_t old_len = strlen(old_substr);
+    size_t max_matches = old_len > 0 ? strlen(str) / old_len + 1 : 1;
+    if (strlen(new_substr) > MAX_REPLACE_RESULT / max_matches) {
+        new_substr[MAX_REPLACE_RESULT / max_matches] = '\0';
+    }
+    const char* args[3] = {str, old_substr, new_substr};
+    if (flags & FLAG_NULL_ARGUMENT) {
+        args[(flags & 3) % 3] = NULL;
+    }
+
+    char* expected = NULL;
+    error_code expected_code = reference_string_replace(args[0], args[1], args[2], &expected);
+    for (size_t v = 0; v < sizeof(replace_variants) / sizeof(replace_variants[0]); v++) {
+        char* actual = NULL;
+        error_code code = replace_variants[v].fn(args[0], args[1], args[2], &actual);
+        if (expected_code == ERR_STRING_REPLACE_ALLOC || code == ERR_STRING_REPLACE_ALLOC) {
+            mem_free(actual);
+            continue;
+        }
+        FUZZ_CHECK(code == expected_code, "%s返回%s，参考实现返回%s", replace_variants[v].name,
+                   error_code_name(code), error_code_name(expected_code));
+        if (code == ERR_OK) {
+            FUZZ_CHECK(actual != NULL && strcmp(actual, expected) == 0,
+                       "%s的结果与参考实现不同（长度%zu，参考长度%zu）", replace_variants[v].name,
+                       actual != NULL ? strlen(actual) : 0, strlen(expected));
+        } else {
+            FUZZ_CHECK(actual == NULL, "%s失败时没有把结果置为NULL", replace_variants[v].name);
+        }
+        mem_free(actual);
+    }
+    free(expected);
+    free(str);
+    free(old_substr);
+    free(new_substr);
+}
+
+void fuzz_string_split(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    char* str = fuzz_consume_string(&in);
+    char* delimiter = fuzz_consume_string(&in);
+    if (str == NULL || delimiter == NULL) {
+        free(str);
+        free(delimiter);
+        return;
+    }
+    const char* args[2] = {str, delimiter};
+    if (flags & FLAG_NULL_ARGUMENT) {
+        args[flags & 1] = NULL;
+    }
+
+    char** expected = NULL;
+    int expected_count = 0;
+    error_code expected_code = reference_string_split(args[0], args[1], &expected, &expected_count);
+    for (size_t v = 0; v < sizeof(split_variants) / sizeof(split_variants[0]); v++) {
+        char** actual = NULL;
+        int count = -1;
+        error_code code = split_variants[v].fn(args[0], args[1], &actual, &count);
+        if (expected_code == ERR_STRING_SPLIT_ALLOC || code == ERR_STRING_SPLIT_ALLOC) {
+            free_parts(actual, count, mem_free);
+            continue;
+        }
+        FUZZ_CHECK(code == expected_code, "%s返回%s，参考实现返回%s", split_variants[v].name,
+                   error_code_name(code), error_code_name(expected_code));
+        FUZZ_CHECK(count == expected_count, "%s分割出%d个部分，参考实现为%d个",
+                   split_variants[v].name, count, expected_count);
+        if (code == ERR_OK) {
+            for (int i = 0; i < count; i++) {
+                FUZZ_CHECK(strcmp(actual[i], expected[i]) == 0, "%s的第%d个部分与参考实现不同",
+                           split_variants[v].name, i);
+            }
+        } else {
+            FUZZ_CHECK(actual == NULL, "%s失败时没有把结果置为NULL", split_variants[v].name);
+        }
+        free_parts(actual, count, mem_free);
+    }
+    free_parts(expected, expected_count, free);
+    free(str);
+    free(delimiter);
+}
+
+/* 边界用例：{源字符串片段, 重复次数, 旧子字符串/分隔符, 新子字符串} */
+static const struct {
+    const char* chunk;
+    unsigned int repeat;
+    const char* pattern;
+    const char* replacement;
+} string_seeds[] = {
+    {"", 1, "", ""},
+    {"abc", 1, "", "x"},                    // 空模式
+    {"", 1, "a", "b"},                      // 空源字符串
+    {"aaaa", 1, "aa", "b"},                 // 重叠匹配
+    {"aaaaa", 1, "aa", "aaa"},
+    {"abababa", 1, "aba", "X"},
+    {"a,b,,c,", 1, ",", ""},                // 连续与末尾的分隔符
+    {",", 1, ",", ","},
+    {"abc", 1, "abc", ""},                  // 整串匹配
+    {"abc", 1, "abcd", "z"},                // 模式比源字符串长
+    {"a", 65535, "aa", "b"},                // 很长的字符串与大量重叠匹配
+    {"a", 65535, "a", "bbbbbbbb"},          // 结果增长
+    {"ab", 32768, "ab", ""},                // 结果收缩为空
+    {"xyz", 20000, "zx", "--"},             // 跨片段边界的匹配
+    {"abcdefghijklmnopqrstuvwxyz0123456789", 29000, "9a", "|"},
+};
+
+static int seed_strings(int index, fuzz_buffer* out, int with_replacement) {
+    int count = (int)(sizeof(string_seeds) / sizeof(string_seeds[0]));
+    // 每个用例再以NULL参数各测一次
+    int arguments = with_replacement ? 3 : 2;
+    if (index >= count * (arguments + 1)) {
+        return 0;
+    }
+    int seed = index % count;
+    int null_argument = index / count - 1;
+    fuzz_put_u8(out, null_argument >= 0 ? (uint8_t)(FLAG_NULL_ARGUMENT | null_argument) : 0);
+    fuzz_put_string(out, string_seeds[seed].chunk, string_seeds[seed].repeat);
+    fuzz_put_string(out, string_seeds[seed].pattern, 1);
+    if (with_replacement) {
+        fuzz_put_string(out, string_seeds[seed].replacement, 1);
+    }
+    return 1;
+}
+
+int seed_string_replace(int index, fuzz_buffer* out) {
+    return seed_strings(index, out, 1);
+}
+
+int seed_string_split(int index, fuzz_buffer* out) {
+    return seed_strings(index, out, 0);
+}
+
+/* 编码与解码的选项字节：低2位选择编码方式 */
+#define CODEC_ENCODING_MASK 0x03
+/* 输入平铺为CODEC_TILES份，使1MB的字符串超过分段并行的阈值 */
+#define FLAG_CODEC_TILE 0x20
+/* 解码：文本为字符串编码后的结果，再改写其中一个字节 */
+#define FLAG_CODEC_ENCODED 0x40
+#define CODEC_TILES 5
+
+/* 复制copies份，每个字节异或mask；结果用free释放 */
+static uint8_t* codec_input(const char* str, size_t len, uint8_t mask, int copies) {
+    uint8_t* data = (uint8_t*)malloc(len * (size_t)copies + 1);
+    for (size_t i = 0; data != NULL && i < len * (size_t)copies; i++) {
+        data[i] = (uint8_t)str[i % len] ^ mask;
+    }
+    return data;
+}
+
+/* 流式处理时下一段的长度，由输入中的16位整数决定；输入用完后为剩余的全部 */
+static size_t next_piece(fuzz_input* in, size_t remaining) {
+    if (in->pos >= in->size) {
+        return remaining;
+    }
+    size_t piece = fuzz_consume_u16(in);
+    return piece < remaining ? piece : remaining;
+}
+
+/* 用流式接口分段编码或解码，每段的输出写到恰好为上界大小的缓冲区中；*result用free释放 */
+static error_code codec_stream(string_encoding encoding, int decode, const uint8_t* data, size_t len,
+                               fuzz_input* in, char** result, size_t* result_len, uint64_t* error_offset) {
+    size_t capacity = decode ? string_decode_bound(encoding, len) : string_encode_bound(encoding, len);
+    char* all = (char*)malloc(capacity + STRING_CODEC_FINAL_BYTES + 1);
+    string_codec codec;
+    string_codec_init(&codec, encoding);
+    error_code code = all != NULL ? ERR_OK : ERR_STRING_CODEC_ALLOC;
+    size_t total = 0;
+    for (size_t pos = 0; code == ERR_OK && pos < len;) {
+        size_t piece = next_piece(in, len - pos);
+        size_t bound = decode ? string_decode_bound(encoding, piece) : string_encode_bound(encoding, piece);
+        char* out = (char*)malloc(bound > 0 ? bound : 1);
+        size_t produced = 0;
+        if (out == NULL) {
+            code = ERR_STRING_CODEC_ALLOC;
+            break;
+        }
+        code = decode ? string_decode_update(&codec, (const char*)data + pos, piece, out, &produced)
+                      : string_encode_update(&codec, data + pos, piece, out, &produced);
+        FUZZ_CHECK(produced <= bound, "第%zu字节起的%zu字节输出了%zu字节，超过上界%zu", pos, piece, produced, bound);
+        memcpy(all + total, out, produced);
+        free(out);
+        total += produced;
+        pos += piece;
+    }
+    if (code == ERR_OK) {
+        char tail[STRING_CODEC_FINAL_BYTES];
+        size_t produced = 0;
+        code = decode ? string_decode_final(&codec, tail, &produced) : string_encode_final(&codec, tail, &produced);
+        memcpy(all + total, tail, produced);
+        total += produced;
+    }
+    *error_offset = codec.error_offset;
+    if (code != ERR_OK) {
+        free(all);
+        return code;
+    }
+    all[total] = '\0';
+    *result = all;
+    *result_len = total;
+    return ERR_OK;
+}
+
+void fuzz_string_encode(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    uint8_t mask = fuzz_consume_u8(&in);
+    char* str = fuzz_consume_string(&in);
+    if (str == NULL) {
+        return;
+    }
+    string_encoding encoding = (string_encoding)(flags & CODEC_ENCODING_MASK);
+    int copies = (flags & FLAG_CODEC_TILE) ? CODEC_TILES : 1;
+    size_t len = strlen(str) * (size_t)copies;
+    // 异或掩码使输入可以包含'\0'与高位字节
+    uint8_t* bytes = codec_input(str, strlen(str), mask, copies);
+    free(str);
+    if (bytes == NULL) {
+        return;
+    }
+    char* actual = NULL;
+    size_t actual_len = 0;
+    if (flags & FLAG_NULL_ARGUMENT) {
+        error_code code = string_encode_checked(encoding, NULL, len + 1, &actual, &actual_len);
+        FUZZ_CHECK(code == ERR_STRING_CODEC_INVALID && actual == NULL, "数据为NULL时string_encode_checked返回%s",
+                   error_code_name(code));
+        free(bytes);
+        return;
+    }
+
+    size_t expected_len = 0;
+    char* expected = reference_string_encode(encoding, bytes, len, &expected_len);
+    error_code code = string_encode_checked(encoding, bytes, len, &actual, &actual_len);
+    if (expected != NULL && code != ERR_STRING_CODEC_ALLOC) {
+        FUZZ_CHECK(code == ERR_OK, "string_encode_checked返回%s", error_code_name(code));
+        FUZZ_CHECK(actual_len == expected_len && memcmp(actual, expected, expected_len) == 0 &&
+                   actual[actual_len] == '\0',
+                   "string_encode_checked的结果与参考实现不同（长度%zu，参考长度%zu）", actual_len, expected_len);
+        char* legacy = string_encode(encoding, bytes, len);
+        FUZZ_CHECK(legacy == NULL || strcmp(legacy, expected) == 0, "string_encode的结果与参考实现不同");
+        mem_free(legacy);
+
+        char* streamed = NULL;
+        size_t streamed_len = 0;
+        uint64_t offset = 0;
+        code = codec_stream(encoding, 0, bytes, len, &in, &streamed, &streamed_len, &offset);
+        FUZZ_CHECK(code == ERR_STRING_CODEC_ALLOC ||
+                   (code == ERR_OK && streamed_len == expected_len && memcmp(streamed, expected, expected_len) == 0),
+                   "分段编码返回%s，结果与参考实现不同（长度%zu，参考长度%zu）", error_code_name(code), streamed_len,
+                   expected_len);
+        free(streamed);
+
+        char* decoded = NULL;
+        size_t decoded_len = 0;
+        code = string_decode_checked(encoding, actual, actual_len, &decoded, &decoded_len);
+        FUZZ_CHECK(code == ERR_STRING_CODEC_ALLOC ||
+                   (code == ERR_OK && decoded_len == len && memcmp(decoded, bytes, len) == 0),
+                   "解码编码的结果返回%s，没有得到原来的%zu字节", error_code_name(code), len);
+        mem_free(decoded);
+    }
+    mem_free(actual);
+    free(expected);
+    free(bytes);
+}
+
+void fuzz_string_decode(const uint8_t* data, size_t size) {
+    fuzz_input in = {data, size, 0};
+    uint8_t flags = fuzz_consume_u8(&in);
+    char* str = fuzz_consume_string(&in);
+    if (str == NULL) {
+        return;
+    }
+    string_encoding encoding = (string_encoding)(flags & CODEC_ENCODING_MASK);
+    int copies = (flags & FLAG_CODEC_TILE) ? CODEC_TILES : 1;
+    size_t text_len = strlen(str) * (size_t)copies;
+    char* text = (char*)codec_input(str, strlen(str), 0, copies);
+    free(str);
+    if (text != NULL && (flags & FLAG_CODEC_ENCODED)) {
+        // 改写编码结果中的一个字节，位置与字节来自输入，字节为0时不改写
+        char* encoded = reference_string_encode(encoding, (const uint8_t*)text, text_len, &text_len);
+        free(text);
+        text = encoded;
+        size_t where = fuzz_consume_u16(&in);
+        uint8_t value = fuzz_consume_u8(&in);
+        if (text != NULL && text_len > 0 && value != 0) {
+            text[where * text_len >> 16] = (char)value;
+        }
+    }
+    if (text == NULL) {
+        return;
+    }
+    char* actual = NULL;
+    size_t actual_len = 0;
+    if (flags & FLAG_NULL_ARGUMENT) {
+        error_code code = string_decode_checked(encoding, NULL, text_len + 1, &actual, &actual_len);
+        FUZZ_CHECK(code == ERR_STRING_CODEC_INVALID && actual == NULL, "文本为NULL时string_decode_checked返回%s",
+                   error_code_name(code));
+        free(text);
+        return;
+    }
+
+    char* expected = NULL;
+    size_t expected_len = 0;
+    error_code expected_code = reference_string_decode(encoding, text, text_len, &expected, &expected_len);
+    error_code code = string_decode_checked(encoding, text, text_len, &actual, &actual_len);
+    if (expected_code != ERR_STRING_CODEC_ALLOC && code != ERR_STRING_CODEC_ALLOC) {
+        FUZZ_CHECK(code == expected_code, "string_decode_checked返回%s，参考实现返回%s", error_code_name(code),
+                   error_code_name(expected_code));
+        if (code == ERR_OK) {
+            FUZZ_CHECK(actual_len == expected_len && memcmp(actual, expected, expected_len) == 0 &&
+                       actual[actual_len] == '\0',
+                       "string_decode_checked的结果与参考实现不同（长度%zu，参考长度%zu）", actual_len, expected_len);
+            size_t legacy_len = 0;
+            char* legacy = string_decode(encoding, text, text_len, &legacy_len);
+            FUZZ_CHECK(legacy == NULL || (legacy_len == expected_len && memcmp(legacy, expected, expected_len) == 0),
+                       "string_decode的结果与参考实现不同");
+            mem_free(legacy);
+        } else {
+            FUZZ_CHECK(actual == NULL && actual_len == expected_len,
+                       "string_decode_checked报告的无效位置为%zu，参考实现为%zu", actual_len, expected_len);
+        }
+
+        char* streamed = NULL;
+        size_t streamed_len = 0;
+        uint64_t offset = 0;
+        code = codec_stream(encoding, 1, (const uint8_t*)text, text_len, &in, &streamed, &streamed_len, &offset);
+        if (code != ERR_STRING_CODEC_ALLOC) {
+            FUZZ_CHECK(code == expected_code, "分段解码返回%s，参考实现返回%s", error_code_name(code),
+                       error_code_name(expected_code));
+            FUZZ_CHECK(code != ERR_OK ||
+                       (streamed_len == expected_len && memcmp(streamed, expected, expected_len) == 0),
+                       "分段解码的结果与参考实现不同（长度%zu，参考长度%zu）", streamed_len, expected_len);
+            FUZZ_CHECK(code == ERR_OK || offset == expected_len, "分段解码报告的无效位置为%llu，参考实现为%zu",
+                       (unsigned long long)offset, expected_len);
+        }
+        free(streamed);
+    }
+    mem_free(actual);
+    free(expected);
+    free(text);
+}
+
+/* 分段长度：逐字节、空段、跨SIMD块与跨组的长度 */
+static const uint16_t codec_pieces[] = {1, 0, 2, 5, 31, 47, 64, 1000};
+
+static void put_codec_pieces(fuzz_buffer* out) {
+    for (size_t i = 0; i < sizeof(codec_pieces) / sizeof(codec_pieces[0]); i++) {
+        fuzz_put_u16(out, codec_pieces[i]);
+    }
+}
+
+/* 编码的边界用例，每个用例以四种编码方式各测一次：{片段, 重复次数, 异或掩码, 选项} */
+static const struct {
+    const char* chunk;
+    unsigned int repeat;
+    uint8_t mask;
+    uint8_t flags;
+} encode_seeds[] = {
+    {"", 1, 0, 0},
+    {"f", 1, 0, 0},                         // RFC 4648的测试向量
+    {"fo", 1, 0, 0},
+    {"foo", 1, 0, 0},
+    {"foobar", 1, 0, 0},
+    {"\x01\x02\x03", 1, 0x01, 0},           // 含'\0'
+    {"abc~-._ /?#[]@!$&'()*+,;=%", 1, 0, 0},
+    {"\xe4\xb8\xad\xe6\x96\x87", 1, 0, 0},  // UTF-8
+    {"0123456789abcdefghijklmnopqrstuvwxyz", 9, 0x80, 0},
+    {"\xfb\xff\xbf", 100, 0, 0},            // 编码为'+'、'/'与'-'、'_'
+    {"0123456789abcdefghijklmnopqrstuvwxyz!@#$%^&*()", 30000, 0, FLAG_CODEC_TILE},
+    {"x", 1, 0, FLAG_NULL_ARGUMENT},
+};
+
+int seed_string_encode(int index, fuzz_buffer* out) {
+    int count = (int)(sizeof(encode_seeds) / sizeof(encode_seeds[0]));
+    if (index >= count * 4) {
+        return 0;
+    }
+    int seed = index / 4;
+    fuzz_put_u8(out, (uint8_t)(encode_seeds[seed].flags | (index % 4)));
+    fuzz_put_u8(out, encode_seeds[seed].mask);
+    fuzz_put_string(out, encode_seeds[seed].chunk, encode_seeds[seed].repeat);
+    put_codec_pieces(out);
+    return 1;
+}
+
+/* 解码的边界用例：{选项与编码方式, 片段, 重复次数, 改写的位置, 改写的字节} */
+static const struct {
+    uint8_t flags;
+    const char* chunk;
+    unsigned int repeat;
+    uint16_t where;
+    uint8_t value;
+} decode_seeds[] = {
+    {STRING_BASE64, "Zm9vYmFy", 1, 0, 0},
+    {STRING_BASE64, "Zm9vYg==", 1, 0, 0},
+    {STRING_BASE64, "Zm9vYg=", 1, 0, 0},          // '='不足
+    {STRING_BASE64, "Zm9vYh==", 1, 0, 0},         // 多余的位不为0
+    {STRING_BASE64, "Zm9vYmE", 1, 0, 0},          // 标准base64必须补齐
+    {STRING_BASE64, "Zm9v YmFy", 1, 0, 0},        // 空白也是无效字符
+    {STRING_BASE64, "Zg==Zg==", 1, 0, 0},         // '='之后还有字符
+    {STRING_BASE64, "Z===", 1, 0, 0},
+    {STRING_BASE64, "QUJDREVGR0hJSktMTU5PUFFSU1RVVldY", 8, 0, 0},
+    {STRING_BASE64_URL, "Zm9vYg", 1, 0, 0},       // URL安全的base64可以省略'='
+    {STRING_BASE64_URL, "Zm9vYh", 1, 0, 0},
+    {STRING_BASE64_URL, "Zm9vY", 1, 0, 0},        // 只剩一个字符
+    {STRING_BASE64_URL, "-_-_+/+/", 1, 0, 0},
+    {STRING_HEX, "DeadBeef00", 1, 0, 0},
+    {STRING_HEX, "abc", 1, 0, 0},
+    {STRING_HEX, "0123456789abcdefABCDEFgh", 4, 0, 0},
+    {STRING_PERCENT, "a%20b%2fc+d", 1, 0, 0},      // '+'不转换为空格
+    {STRING_PERCENT, "100%", 1, 0, 0},
+    {STRING_PERCENT, "%4", 1, 0, 0},
+    {STRING_PERCENT, "%zz", 1, 0, 0},
+    {FLAG_CODEC_ENCODED | STRING_BASE64, "any carnal pleasure.", 3000, 40000, '*'},
+    {FLAG_CODEC_ENCODED | FLAG_CODEC_TILE | STRING_BASE64, "0123456789abcdefghijklmnopqrstuvwxyz", 30000, 65535, '='},
+    {FLAG_CODEC_ENCODED | FLAG_CODEC_TILE | STRING_HEX, "0123456789abcdefghijklmnopqrstuvwxyz", 30000, 30000, 'G'},
+    {FLAG_CODEC_ENCODED | FLAG_CODEC_TILE | STRING_BASE64_URL, "The quick brown fox", 50000, 0, 0},
+    {FLAG_CODEC_ENCODED | STRING_PERCENT, "a b/c?d=e", 2000, 100, '%'},
+    {FLAG_NULL_ARGUMENT | STRING_HEX, "00", 1, 0, 0},
+};
+
+int seed_string_decode(int index, fuzz_buffer* out) {
+    if (index >= (int)(sizeof(decode_seeds) / sizeof(decode_seeds[0]))) {
+        return 0;
+    }
+    fuzz_put_u8(out, decode_seeds[index].flags);
+    fuzz_put_string(out, decode_seeds[index].chunk, decode_seeds[index].repeat);
+    if (decode_seeds[index].flags & FLAG_CODEC_ENCODED) {
+        fuzz_put_u16(out, decode_seeds[index].where);
+        fuzz_put_u8(out, decode_seeds[index].value);
+    }
+    put_codec_pieces(out);
+    return 1;
+}
\ No newline at end of file
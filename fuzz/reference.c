@@ -0,0 +1,875 @@
+/**
+ * @file reference.c
+ * @brief 差分测试的参考实现
+ *
+ * 按逐字节比较、分段筛法等最直接的方式重新实现被测函数的当前行为（包括错误代码），
+ * 不调用src中的实现，src中的函数改写为SIMD或其他优化版本后仍以这里为准。
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "fuzz.h"
+
+error_code reference_string_replace(const char* str, const char* old_substr, const char* new_substr,
+                                    char** result) {
+    if (str == NULL || old_substr == NULL || new_substr == NULL || result == NULL) {
+        return ERR_STRING_REPLACE_NULL;
+    }
+    size_t str_len = strlen(str);
+    size_t old_len = strlen(old_substr);
+    size_t new_len = strlen(new_substr);
+
+    // 先按最坏情况（每个位置都匹配）分配，避免二次扫描
+    size_t capacity = str_len + 1;
+    if (old_len > 0 && new_len > old_len) {
+        capacity += (str_len / old_len) * (new_len - old_len);
+    }
+    char* out = (char*)malloc(capacity);
+    if (out == NULL) {
+        return ERR_STRING_REPLACE_ALLOC;
+    }
+    size_t length = 0;
+    size_t i = 0;
+    while (i < str_len) {
+        // 空的旧子字符串不匹配任何位置；匹配后从匹配末尾继续，重叠的匹配不替换
+        if (old_len > 0 && str_len - i >= old_len && memcmp(str + i, old_substr, old_len) == 0) {
+            memcpy(out + length, new_substr, new_len);
+            length += new_len;
+            i += old_len;
+        } else {
+            out[length++] = str[i++];
+        }
+    }
+    out[length] = '\0';
+    *result = out;
+    return ERR_OK;
+}
+
+error_code reference_string_split(const char* str, const char* delimiter, char*** parts, int* count) {
+    if (count != NULL) {
+        *count = 0;
+    }
+    if (str == NULL || delimiter == NULL || parts == NULL || count == NULL) {
+        return ERR_STRING_SPLIT_NULL;
+    }
+    *parts = NULL;
+    size_t delimiter_len = strlen(delimiter);
+    if (delimiter_len == 0) {
+        return ERR_STRING_SPLIT_EMPTY_DELIMITER;
+    }
+    size_t str_len = strlen(str);
+
+    // 每个分隔符至少占一个字符，部分数不超过str_len + 1
+    char** result = (char**)malloc((str_len + 1) * sizeof(char*));
+    if (result == NULL) {
+        return ERR_STRING_SPLIT_ALLOC;
+    }
+    int part_count = 0;
+    size_t part_start = 0;
+    size_t i = 0;
+    for (;;) {
+        int at_end = i >= str_len;
+        int at_delimiter = !at_end && str_len - i >= delimiter_len &&
+                           memcmp(str + i, delimiter, delimiter_len) == 0;
+        if (!at_end && !at_delimiter) {
+            i++;
+            continue;
+        }
+        size_t part_len = i - part_start;
+        char* part = (char*)malloc(part_len + 1);
+        if (part == NULL) {
+            for (int j = 0; j < part_count; j++) {
+                free(result[j]);
+            }
+            free(result);
+            return ERR_STRING_SPLIT_ALLOC;
+        }
+        memcpy(part, str + part_start, part_len);
+        part[part_len] = '\0';
+        result[part_count++] = part;
+        if (at_end) {
+            break;
+        }
+        i += delimiter_len;
+        part_start = i;
+    }
+    *parts = result;
+    *count = part_count;
+    return ERR_OK;
+}
+
+error_code reference_find_primes(int start, int end, int** primes, int* count) {
+    if (primes == NULL || count == NULL) {
+        return ERR_MATH_NULL_ARGUMENT;
+    }
+    if (start > end) {
+        return ERR_MATH_INVALID_RANGE;
+    }
+    long lo = start < 2 ? 2 : start;
+    long hi = end;
+    long length = hi >= lo ? hi - lo + 1 : 0;
+
+    // 不超过sqrt(hi)的素数
+    long limit = 1;
+    while ((limit + 1) * (limit + 1) <= hi) {
+        limit++;
+    }
+    char* composite_small = (char*)calloc((size_t)limit + 1, 1);
+    char* composite = (char*)calloc((size_t)length + 1, 1);
+    int* result = (int*)malloc(((size_t)length + 1) * sizeof(int));
+    if (composite_small == NULL || composite == NULL || result == NULL) {
+        free(composite_small);
+        free(composite);
+        free(result);
+        return ERR_MATH_ALLOC;
+    }
+    for (long p = 2; p <= limit; p++) {
+        if (composite_small[p]) {
+            continue;
+        }
+        for (long m = p * p; m <= limit; m += p) {
+            composite_small[m] = 1;
+        }
+        // 在[lo, hi]中划掉p的倍数（p本身除外）
+        long first = (lo + p - 1) / p * p;
+        if (first < p * p) {
+            first = p * p;
+        }
+        for (long m = first; m <= hi; m += p) {
+            composite[m - lo] = 1;
+        }
+    }
+    int found = 0;
+    for (long i = 0; i < length; i++) {
+        if (!composite[i]) {
+            result[found++] = (int)(lo + i);
+        }
+    }
+    free(composite_small);
+    free(composite);
+    *primes = result;
+    *count = found;
+    return ERR_OK;
+}
+
+error_code reference_count_primes(uint64_t lo, uint64_t hi, uint64_t* count) {
+    if (count == NULL) {
+        return ERR_MATH_NULL_ARGUMENT;
+    }
+    if (lo > hi) {
+        return ERR_MATH_INVALID_RANGE;
+    }
+    if (hi > COUNT_PRIMES_MAX) {
+        return ERR_MATH_RANGE_TOO_LARGE;
+    }
+    uint64_t found = 0;
+    if (hi <= (1u << 22)) {
+        char* composite = (char*)calloc((size_t)hi + 1, 1);
+        if (composite == NULL) {
+            return ERR_MATH_ALLOC;
+        }
+        for (uint64_t i = 2; i <= hi; i++) {
+            if (!composite[i]) {
+                found += i >= lo;
+                for (uint64_t m = i * i; m <= hi; m += i) {
+                    composite[m] = 1;
+                }
+            }
+        }
+        free(composite);
+    } else {
+        for (uint64_t n = lo; n <= hi; n++) {
+            int prime = n >= 2;
+            for (uint64_t d = 2; prime && d * d <= n; d++) {
+                prime = n % d != 0;
+            }
+            found += prime;
+        }
+    }
+    *count = found;
+    return ERR_OK;
+}
+
+static uint64_t mod_pow_u64(uint64_t base, uint64_t exponent, uint64_t n) {
+    uint64_t result = 1 % n;
+    base %= n;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result = (uint64_t)((unsigned __int128)result * base % n);
+        }
+        base = (uint64_t)((unsigned __int128)base * base % n);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+int reference_is_prime_u64(uint64_t n) {
+    static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        if (n % bases[i] == 0) {
+            return n == bases[i];
+        }
+    }
+    if (n < 41 * 41) {
+        return n > 1;
+    }
+    uint64_t odd = n - 1;
+    int shift = 0;
+    while ((odd & 1) == 0) {
+        odd >>= 1;
+        shift++;
+    }
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        uint64_t x = mod_pow_u64(bases[i], odd, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        int composite = 1;
+        for (int s = 1; s < shift && composite; s++) {
+            x = (uint64_t)((unsigned __int128)x * x % n);
+            composite = x != n - 1;
+        }
+        if (composite) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+error_code reference_factorize_u64(uint64_t n, prime_factors* result) {
+    if (result == NULL) {
+        return ERR_MATH_NULL_ARGUMENT;
+    }
+    if (n == 0) {
+        return ERR_MATH_FACTORIZE_ZERO;
+    }
+    result->count = 0;
+    for (uint64_t d = 2; d * d <= n; d++) {
+        if (n % d == 0) {
+            result->primes[result->count] = d;
+            result->exponents[result->count] = 0;
+            while (n % d == 0) {
+                n /= d;
+                result->exponents[result->count]++;
+            }
+            result->count++;
+        }
+    }
+    if (n > 1) {
+        result->primes[result->count] = n;
+        result->exponents[result->count] = 1;
+        result->count++;
+    }
+    return ERR_OK;
+}
+
+error_code reference_fibonacci(int n, int* result) {
+    if (result == NULL) {
+        return ERR_MATH_NULL_ARGUMENT;
+    }
+    if (n < 0) {
+        return ERR_MATH_NEGATIVE_FIBONACCI;
+    }
+    long long previous = 0;
+    long long current = 1;
+    for (int i = 0; i < n; i++) {
+        long long next = previous + current;
+        previous = current;
+        current = next;
+        if (previous > INT_MAX) {
+            return ERR_MATH_OVERFLOW;
+        }
+    }
+    *result = (int)previous;
+    return ERR_OK;
+}
+
+long reference_levenshtein(const char* a, size_t a_len, const char* b, size_t b_len) {
+    long* row = (long*)malloc((b_len + 1) * sizeof(long));
+    if (row == NULL) {
+        return -1;
+    }
+    for (size_t j = 0; j <= b_len; j++) {
+        row[j] = (long)j;
+    }
+    for (size_t i = 1; i <= a_len; i++) {
+        long diagonal = row[0];
+        row[0] = (long)i;
+        for (size_t j = 1; j <= b_len; j++) {
+            long value = diagonal + (a[i - 1] != b[j - 1]);
+            if (row[j] + 1 < value) {
+                value = row[j] + 1;
+            }
+            if (row[j - 1] + 1 < value) {
+                value = row[j - 1] + 1;
+            }
+            diagonal = row[j];
+            row[j] = value;
+        }
+    }
+    long distance = row[b_len];
+    free(row);
+    return distance;
+}
+
+void reference_hamming(const void* a, const void* b, size_t len, size_t* bytes, size_t* bits) {
+    const unsigned char* x = (const unsigned char*)a;
+    const unsigned char* y = (const unsigned char*)b;
+    *bytes = 0;
+    *bits = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char differ = x[i] ^ y[i];
+        *bytes += differ != 0;
+        for (; differ != 0; differ &= differ - 1) {
+            (*bits)++;
+        }
+    }
+}
+
+error_code reference_parse_int64(const char* str, size_t len, int64_t* value, size_t* consumed) {
+    size_t pos = 0;
+    int negative = 0;
+    if (pos < len && (str[pos] == '-' || str[pos] == '+')) {
+        negative = str[pos] == '-';
+        pos++;
+    }
+    size_t start = pos;
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t magnitude = 0;
+    int overflow = 0;
+    for (; pos < len && str[pos] >= '0' && str[pos] <= '9'; pos++) {
+        uint64_t digit = (uint64_t)(str[pos] - '0');
+        if (magnitude > (limit - digit) / 10) {
+            overflow = 1;
+        } else {
+            magnitude = magnitude * 10 + digit;
+        }
+    }
+    if (pos == start) {
+        return ERR_NUMBER_INVALID;
+    }
+    if (overflow) {
+        return ERR_NUMBER_OVERFLOW;
+    }
+    *value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    if (consumed != NULL) {
+        *consumed = pos;
+    }
+    return ERR_OK;
+}
+
+static int reference_is_blank(char c, char delimiter) {
+    return (c == ' ' || c == '\t' || c == '\r') && c != delimiter;
+}
+
+error_code reference_parse_int64_list(const char* buffer, size_t len, char delimiter, int64_t** values,
+                                      size_t* count) {
+    *values = NULL;
+    *count = 0;
+    int64_t* result = (int64_t*)malloc((len / 2 + 1) * sizeof(int64_t));
+    if (result == NULL) {
+        return ERR_NUMBER_ALLOC;
+    }
+    size_t found = 0;
+    size_t line_start = 0;
+    while (line_start < len) {
+        const char* newline = (const char*)memchr(buffer + line_start, '\n', len - line_start);
+        size_t line_end = newline != NULL ? (size_t)(newline - buffer) : len;
+        size_t first = line_start;
+        while (first < line_end && reference_is_blank(buffer[first], delimiter)) {
+            first++;
+        }
+        // 空行跳过，其余的行按分隔符拆成字段，每个字段去掉两侧空白后必须恰好是一个整数
+        size_t field_start = line_start;
+        while (first < line_end) {
+            const char* next = (const char*)memchr(buffer + field_start, delimiter, line_end - field_start);
+            size_t field_end = next != NULL ? (size_t)(next - buffer) : line_end;
+            size_t begin = field_start;
+            size_t end = field_end;
+            while (begin < end && reference_is_blank(buffer[begin], delimiter)) {
+                begin++;
+            }
+            while (end > begin && reference_is_blank(buffer[end - 1], delimiter)) {
+                end--;
+            }
+            size_t used = 0;
+            error_code code = reference_parse_int64(buffer + begin, end - begin, &result[found], &used);
+            if (code == ERR_OK && used != end - begin) {
+                code = ERR_NUMBER_INVALID;
+            }
+            if (code != ERR_OK) {
+                free(result);
+                return code;
+            }
+            found++;
+            if (next == NULL) {
+                break;
+            }
+            field_start = field_end + 1;
+        }
+        line_start = line_end + 1;
+    }
+    if (found == 0) {
+        free(result);
+        result = NULL;
+    }
+    *values = result;
+    *count = found;
+    return ERR_OK;
+}
+
+/* 追加一个字段：内容复制为以'\0'结尾的字符串 */
+static int reference_push_field(char*** fields, size_t* count, size_t* capacity, const char* text, size_t len) {
+    if (*count == *capacity) {
+        size_t grown_capacity = *capacity > 0 ? *capacity * 2 : 16;
+        char** grown = (char**)realloc(*fields, grown_capacity * sizeof(char*));
+        if (grown == NULL) {
+            return 0;
+        }
+        *fields = grown;
+        *capacity = grown_capacity;
+    }
+    char* copy = (char*)malloc(len + 1);
+    if (copy == NULL) {
+        return 0;
+    }
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    (*fields)[(*count)++] = copy;
+    return 1;
+}
+
+void reference_free_fields(char** fields, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(fields[i]);
+    }
+    free(fields);
+}
+
+error_code reference_csv_split(const char* data, size_t len, char delimiter, char*** fields, size_t* count,
+                               int* column_count) {
+    *fields = NULL;
+    *count = 0;
+    *column_count = 0;
+    size_t capacity = 0;
+    char* value = (char*)malloc(len + 1);
+    if (value == NULL) {
+        return ERR_CSV_ALLOC;
+    }
+    error_code code = ERR_OK;
+    size_t pos = 0;
+    int column = 0;
+    while (pos < len || column > 0) {
+        // 读一个字段到value：带引号的字段逐字符处理""转义，无引号的字段读到分隔符或换行
+        if (*column_count > 0 && column >= *column_count) {
+            code = ERR_CSV_FIELD_COUNT;
+            break;
+        }
+        size_t value_len = 0;
+        int quoted = pos < len && data[pos] == '"';
+        if (quoted) {
+            pos++;
+            for (;;) {
+                if (pos >= len) {
+                    code = ERR_CSV_QUOTE;
+                    break;
+                }
+                if (data[pos] == '"') {
+                    if (pos + 1 < len && data[pos + 1] == '"') {
+                        value[value_len++] = '"';
+                        pos += 2;
+                        continue;
+                    }
+                    pos++;
+                    break;
+                }
+                value[value_len++] = data[pos++];
+            }
+            if (code == ERR_OK && pos < len && data[pos] == '\r' && (pos + 1 == len || data[pos + 1] == '\n')) {
+                pos++;
+            }
+            if (code == ERR_OK && pos < len && data[pos] != delimiter && data[pos] != '\n') {
+                code = ERR_CSV_QUOTE;
+            }
+        } else {
+            while (pos < len && data[pos] != delimiter && data[pos] != '\n') {
+                if (data[pos] == '"') {
+                    code = ERR_CSV_QUOTE;
+                    break;
+                }
+                value[value_len++] = data[pos++];
+            }
+            if (code == ERR_OK && (pos == len || data[pos] == '\n') && value_len > 0 &&
+                value[value_len - 1] == '\r') {
+                value_len--;
+            }
+        }
+        if (code != ERR_OK) {
+            break;
+        }
+        int row_end = pos == len || data[pos] == '\n';
+        if (row_end && column == 0 && value_len == 0 && !quoted) {
+            pos++;    // 空行
+            continue;
+        }
+        if (!reference_push_field(fields, count, &capacity, value, value_len)) {
+            code = ERR_CSV_ALLOC;
+            break;
+        }
+        column++;
+        if (row_end) {
+            if (*column_count == 0) {
+                *column_count = column;
+            } else if (column != *column_count) {
+                code = ERR_CSV_FIELD_COUNT;
+                break;
+            }
+            column = 0;
+        }
+        pos++;
+    }
+    free(value);
+    if (code != ERR_OK) {
+        reference_free_fields(*fields, *count);
+        *fields = NULL;
+        *count = 0;
+    }
+    return code;
+}
+
+/* 十进制文本按10^9分组，低位在前 */
+static uint32_t* decimal_groups(const char* digits, size_t len, size_t* count) {
+    *count = (len + 8) / 9;
+    uint32_t* groups = (uint32_t*)calloc(*count > 0 ? *count : 1, sizeof(uint32_t));
+    if (groups == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < *count; i++) {
+        size_t end = len - i * 9;
+        size_t begin = end >= 9 ? end - 9 : 0;
+        uint32_t value = 0;
+        for (size_t k = begin; k < end; k++) {
+            value = value * 10 + (uint32_t)(digits[k] - '0');
+        }
+        groups[i] = value;
+    }
+    return groups;
+}
+
+char* reference_bignum_multiply(const char* a, const char* b) {
+    int negative = (*a == '-') != (*b == '-');
+    a += *a == '-' || *a == '+';
+    b += *b == '-' || *b == '+';
+    size_t an = 0;
+    size_t bn = 0;
+    uint32_t* ag = decimal_groups(a, strlen(a), &an);
+    uint32_t* bg = decimal_groups(b, strlen(b), &bn);
+    uint64_t* product = (uint64_t*)calloc(an + bn + 1, sizeof(uint64_t));
+    char* text = (char*)malloc((an + bn) * 9 + 2);
+    if (ag == NULL || bg == NULL || product == NULL || text == NULL) {
+        free(ag);
+        free(bg);
+        free(product);
+        free(text);
+        return NULL;
+    }
+    // 每加一行立即进位，各组不超过10^9 + 10^18
+    for (size_t i = 0; i < an; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < bn; j++) {
+            uint64_t value = product[i + j] + (uint64_t)ag[i] * bg[j] + carry;
+            product[i + j] = value % 1000000000u;
+            carry = value / 1000000000u;
+        }
+        product[i + bn] += carry;
+    }
+    size_t top = an + bn;
+    while (top > 0 && product[top - 1] == 0) {
+        top--;
+    }
+    size_t pos = 0;
+    if (top == 0) {
+        text[pos++] = '0';
+    } else {
+        if (negative) {
+            text[pos++] = '-';
+        }
+        for (size_t i = top; i-- > 0;) {
+            char group[10];
+            for (int k = 8; k >= 0; k--) {
+                group[k] = (char)('0' + product[i] % 10);
+                product[i] /= 10;
+            }
+            // 最高组去掉前导零
+            int first = 0;
+            while (i == top - 1 && first < 8 && group[first] == '0') {
+                first++;
+            }
+            memcpy(text + pos, group + first, (size_t)(9 - first));
+            pos += (size_t)(9 - first);
+        }
+    }
+    text[pos] = '\0';
+    free(ag);
+    free(bg);
+    free(product);
+    return text;
+}
+
+void reference_matrix_multiply(matrix_type type, size_t m, size_t n, size_t k, const void* a, size_t lda,
+                               const void* b, size_t ldb, void* c, size_t ldc) {
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if (type == MATRIX_DOUBLE) {
+                double sum = 0.0;
+                for (size_t p = 0; p < k; p++) {
+                    sum += ((const double*)a)[i * lda + p] * ((const double*)b)[p * ldb + j];
+                }
+                ((double*)c)[i * ldc + j] = sum;
+            } else if (type == MATRIX_INT32) {
+                uint32_t sum = 0;
+                for (size_t p = 0; p < k; p++) {
+                    sum += ((const uint32_t*)a)[i * lda + p] * ((const uint32_t*)b)[p * ldb + j];
+                }
+                ((uint32_t*)c)[i * ldc + j] = sum;
+            } else {
+                uint64_t sum = 0;
+                for (size_t p = 0; p < k; p++) {
+                    sum += ((const uint64_t*)a)[i * lda + p] * ((const uint64_t*)b)[p * ldb + j];
+                }
+                ((uint64_t*)c)[i * ldc + j] = sum;
+            }
+        }
+    }
+}
+
+uint64_t reference_fibonacci_u64(uint64_t n) {
+    uint64_t current = 0;
+    uint64_t next = 1;
+    for (uint64_t i = 0; i < n; i++) {
+        uint64_t sum = current + next;
+        current = next;
+        next = sum;
+    }
+    return current;
+}
+
+static int compare_int32(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a;
+    int32_t y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_int64(const void* a, const void* b) {
+    int64_t x = *(const int64_t*)a;
+    int64_t y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_uint64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* 全序：符号位为1的排在前面，其中其余位大的在前；符号位为0的其余位小的在前 */
+static int compare_double_total(const void* a, const void* b) {
+    uint64_t x, y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    int x_negative = (int)(x >> 63);
+    int y_negative = (int)(y >> 63);
+    if (x_negative != y_negative) {
+        return x_negative ? -1 : 1;
+    }
+    int order = (x > y) - (x < y);
+    return x_negative ? -order : order;
+}
+
+void reference_sort_int32(int32_t* data, size_t count) {
+    if (count > 1) {
+        qsort(data, count, sizeof(int32_t), compare_int32);
+    }
+}
+
+void reference_sort_int64(int64_t* data, size_t count) {
+    if (count > 1) {
+        qsort(data, count, sizeof(int64_t), compare_int64);
+    }
+}
+
+void reference_sort_uint64(uint64_t* data, size_t count) {
+    if (count > 1) {
+        qsort(data, count, sizeof(uint64_t), compare_uint64);
+    }
+}
+
+void reference_sort_double(double* data, size_t count) {
+    if (count > 1) {
+        qsort(data, count, sizeof(double), compare_double_total);
+    }
+}
+
+size_t reference_lower_bound_int64(const int64_t* data, size_t count, int64_t key) {
+    size_t index = 0;
+    while (index < count && data[index] < key) {
+        index++;
+    }
+    return index;
+}
+
+static const char reference_base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* 字母表中字符的值，不在字母表中返回-1 */
+static int reference_base64_value(string_encoding encoding, char c) {
+    if (encoding == STRING_BASE64_URL && (c == '+' || c == '/')) {
+        return -1;
+    }
+    if (encoding == STRING_BASE64_URL && (c == '-' || c == '_')) {
+        return c == '-' ? 62 : 63;
+    }
+    const char* p = c != '\0' ? strchr(reference_base64_alphabet, c) : NULL;
+    return p != NULL ? (int)(p - reference_base64_alphabet) : -1;
+}
+
+static int reference_hex_value(char c) {
+    const char* digits = "0123456789abcdef";
+    const char* p = c != '\0' ? strchr(digits, c >= 'A' && c <= 'F' ? c - 'A' + 'a' : c) : NULL;
+    return p != NULL ? (int)(p - digits) : -1;
+}
+
+char* reference_string_encode(string_encoding encoding, const uint8_t* data, size_t len, size_t* result_len) {
+    char* result = (char*)malloc(len * 3 + 5);
+    size_t n = 0;
+    if (result == NULL) {
+        return NULL;
+    }
+    if (encoding == STRING_HEX || encoding == STRING_PERCENT) {
+        for (size_t i = 0; i < len; i++) {
+            int c = data[i];
+            if (encoding == STRING_HEX) {
+                result[n++] = "0123456789abcdef"[c >> 4];
+                result[n++] = "0123456789abcdef"[c & 15];
+            } else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                       c == '-' || c == '.' || c == '_' || c == '~') {
+                result[n++] = (char)c;
+            } else {
+                result[n++] = '%';
+                result[n++] = "0123456789ABCDEF"[c >> 4];
+                result[n++] = "0123456789ABCDEF"[c & 15];
+            }
+        }
+    } else {
+        // 按位累积，每满6位输出一个字符
+        uint32_t bits = 0;
+        int count = 0;
+        for (size_t i = 0; i < len; i++) {
+            bits = bits << 8 | data[i];
+            count += 8;
+            while (count >= 6) {
+                count -= 6;
+                result[n++] = reference_base64_alphabet[(bits >> count) & 63];
+            }
+        }
+        if (count > 0) {
+            result[n++] = reference_base64_alphabet[(bits << (6 - count)) & 63];
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (encoding == STRING_BASE64_URL && (result[i] == '+' || result[i] == '/')) {
+                result[i] = result[i] == '+' ? '-' : '_';
+            }
+        }
+        while (encoding == STRING_BASE64 && n % 4 != 0) {
+            result[n++] = '=';
+        }
+    }
+    result[n] = '\0';
+    *result_len = n;
+    return result;
+}
+
+/* 解码失败：结果长度为第一个无效字符的偏移 */
+static error_code reference_decode_error(char* result, size_t offset, char** out, size_t* result_len) {
+    free(result);
+    *out = NULL;
+    *result_len = offset;
+    return ERR_STRING_DECODE_INVALID;
+}
+
+error_code reference_string_decode(string_encoding encoding, const char* text, size_t len, char** out,
+                                   size_t* result_len) {
+    char* result = (char*)malloc(len + 1);
+    size_t n = 0;
+    if (result == NULL) {
+        return ERR_STRING_CODEC_ALLOC;
+    }
+    if (encoding == STRING_HEX) {
+        for (size_t i = 0; i < len; i++) {
+            if (reference_hex_value(text[i]) < 0) {
+                return reference_decode_error(result, i, out, result_len);
+            }
+        }
+        if (len % 2 != 0) {
+            return reference_decode_error(result, len, out, result_len);
+        }
+        for (size_t i = 0; i < len; i += 2) {
+            result[n++] = (char)(reference_hex_value(text[i]) << 4 | reference_hex_value(text[i + 1]));
+        }
+    } else if (encoding == STRING_PERCENT) {
+        for (size_t i = 0; i < len; i++) {
+            if (text[i] != '%') {
+                result[n++] = text[i];
+                continue;
+            }
+            for (size_t k = 1; k <= 2; k++) {
+                if (i + k >= len || reference_hex_value(text[i + k]) < 0) {
+                    return reference_decode_error(result, i + k < len ? i + k : len, out, result_len);
+                }
+            }
+            result[n++] = (char)(reference_hex_value(text[i + 1]) << 4 | reference_hex_value(text[i + 2]));
+            i += 2;
+        }
+    } else {
+        size_t data_end = 0;
+        while (data_end < len && reference_base64_value(encoding, text[data_end]) >= 0) {
+            data_end++;
+        }
+        size_t rest = data_end % 4;
+        size_t end = data_end;
+        if (data_end < len) {
+            // 之后只能是补齐最后一组的'='
+            if (text[data_end] != '=' || rest < 2) {
+                return reference_decode_error(result, data_end, out, result_len);
+            }
+            while (end < len && end - data_end < 4 - rest && text[end] == '=') {
+                end++;
+            }
+            if (end - data_end < 4 - rest) {
+                return reference_decode_error(result, end, out, result_len);
+            }
+        } else if (rest == 1 || (rest > 0 && encoding == STRING_BASE64)) {
+            return reference_decode_error(result, len, out, result_len);
+        }
+        // 最后一个字符多出的位必须为0
+        if (rest > 0 && (reference_base64_value(encoding, text[data_end - 1]) & (rest == 2 ? 0x0f : 0x03)) != 0) {
+            return reference_decode_error(result, data_end - 1, out, result_len);
+        }
+        if (end < len) {
+            return reference_decode_error(result, end, out, result_len);
+        }
+        uint32_t bits = 0;
+        int count = 0;
+        for (size_t i = 0; i < data_end; i++) {
+            bits = bits << 6 | (uint32_t)reference_base64_value(encoding, text[i]);
+            count += 6;
+            if (count >= 8) {
+                count -= 8;
+                result[n++] = (char)(bits >> count);
+            }
+        }
+    }
+    result[n] = '\0';
+    *out = result;
+    *result_len = n;
+    return ERR_OK;
+}
\ No newline at end of file
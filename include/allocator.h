@@ -0,0 +1,134 @@
+/**
+ * @file allocator.h
+ * @brief 内存分配接口：各模块返回给调用者的字符串与数组都由这里分配，调用者用mem_free释放
+ *
+ * 支持三种分配方式，可在运行时随时切换，切换前分配的内存仍可正常释放：
+ * 直接使用malloc；每个线程按大小分级缓存小块内存的内存池（默认）；
+ * 每块内存独占页并在其后放置保护页的调试模式。另外可以打开分配跟踪，
+ * 统计未释放的字节数与峰值，并在进程退出时列出未释放的内存。
+ */
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 分配方式
+ */
+typedef enum {
+    MEM_MODE_SYSTEM = 0,   /* 直接使用malloc/realloc/free */
+    MEM_MODE_POOL,         /* 不超过MEM_POOL_MAX_SIZE的内存从线程本地的分级空闲链表中分配，更大的使用malloc */
+    MEM_MODE_DEBUG         /* 每块内存用mmap单独映射，末尾紧接不可访问的保护页，释放时检查越界写；
+                              最近释放的1024块保留为不可访问（块头只读），之后解除映射 */
+} mem_mode;
+
+/* 内存池分配的最大块（含块头），更大的请求直接使用malloc */
+#define MEM_POOL_MAX_SIZE 1024
+
+/**
+ * @brief 分配统计，字节数与块数只包含打开跟踪后分配的内存
+ */
+typedef struct {
+    size_t live_bytes;            /* 尚未释放的字节数（按请求的大小计） */
+    size_t live_blocks;           /* 尚未释放的块数 */
+    size_t peak_bytes;            /* live_bytes的最大值 */
+    uint64_t total_allocations;   /* 分配次数（mem_realloc移动内存时也计一次） */
+    size_t pool_reserved_bytes;   /* 内存池向系统申请的字节数，不论是否打开跟踪 */
+} mem_stats;
+
+/**
+ * @brief 按当前分配方式分配内存
+ *
+ * 返回的内存按16字节对齐，内容未初始化。不记录调试信息，适合在循环中调用。
+ *
+ * @param size 字节数，为0时按1字节分配
+ * @return 内存，失败返回NULL
+ */
+void* mem_alloc(size_t size);
+
+/**
+ * @brief 分配count * size字节并清零
+ * @param count 元素个数
+ * @param size 每个元素的字节数
+ * @return 内存，乘积溢出或分配失败返回NULL
+ */
+void* mem_calloc(size_t count, size_t size);
+
+/**
+ * @brief 改变已分配内存的大小，内容保留到新旧大小中较小的一个
+ *
+ * 内存池中的块在原有的级别放得下时原地返回；由malloc分配且未被跟踪的块直接使用realloc。
+ *
+ * @param ptr mem_alloc系列函数返回的内存，为NULL时等同于mem_alloc
+ * @param size 新的字节数
+ * @return 新的内存，失败返回NULL且ptr保持不变
+ */
+void* mem_realloc(void* ptr, size_t size);
+
+/**
+ * @brief 释放mem_alloc系列函数返回的内存
+ *
+ * 按内存分配时的方式释放，与当前的分配方式无关。块头损坏、重复释放或调试模式下发现越界写时
+ * 记录错误（ERR_MEM_BAD_POINTER或ERR_MEM_OVERRUN）；当前为调试模式时随后调用abort。
+ * 调试模式分配的块在之后1024次调试模式的释放之内重复释放都能检查到，更早释放的块已解除映射。
+ *
+ * @param ptr 内存，可为NULL
+ */
+void mem_free(void* ptr);
+
+/**
+ * @brief 复制字符串
+ * @param str 源字符串
+ * @return 副本，用mem_free释放；str为NULL或分配失败返回NULL
+ */
+char* mem_strdup(const char* str);
+
+/**
+ * @brief 切换分配方式，可在任意线程中调用，只影响之后的分配
+ * @param mode 分配方式
+ */
+void mem_set_mode(mem_mode mode);
+
+/**
+ * @brief 获取当前的分配方式
+ * @return 分配方式
+ */
+mem_mode mem_get_mode();
+
+/**
+ * @brief 按名称解析分配方式
+ * @param name "system"、"pool"或"debug"
+ * @param mode 输出参数，分配方式
+ * @return 成功返回1，名称无效返回0
+ */
+int mem_parse_mode(const char* name, mem_mode* mode);
+
+/**
+ * @brief 打开或关闭分配跟踪
+ *
+ * 跟踪的内存块在块头前多占16字节并记录在全局链表中，分配与释放需要加锁。
+ * 第一次打开时注册退出处理函数，进程正常退出时调用mem_print_report。
+ *
+ * @param enabled 非0打开，0关闭；关闭后已跟踪的块在释放时仍会更新统计
+ */
+void mem_set_tracking(int enabled);
+
+/**
+ * @brief 获取分配统计
+ * @param stats 输出参数，统计
+ */
+void mem_get_stats(mem_stats* stats);
+
+/**
+ * @brief 打印分配统计与未释放的内存（最多列出前20块，显示大小与开头的内容）
+ */
+void mem_print_report();
+
+/**
+ * @brief 初始化内存分配模块；分配函数在初始化之前也可以使用
+ * @return 成功返回1，失败返回0
+ */
+int initialize_allocator();
+
+#endif /* ALLOCATOR_H */
\ No newline at end of file
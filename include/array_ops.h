@@ -0,0 +1,96 @@
+/**
+ * @file array_ops.h
+ * @brief 数组算法接口：基数排序（大数组先按最高字节分桶并行，桶内在缓存中LSD）、Floyd-Rivest选择与百分位数、
+ *        有序数组的SIMD lower_bound
+ */
+#ifndef ARRAY_OPS_H
+#define ARRAY_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+/* array_percentiles_*一次最多计算的百分位数个数 */
+#define ARRAY_MAX_PERCENTILES 64
+
+/**
+ * @brief 升序排序（基数排序，每趟8位，所有元素该字节相同的趟会跳过）
+ *
+ * 超出缓存的数组先按最高的不同字节分桶，各桶再在缓存中按低字节排序，主存只读写约两遍；
+ * 需要与数组同样大小的临时内存，元素较多时在线程池上按块并行。
+ *
+ * @param data 数组，count为0时可为NULL
+ * @param count 元素个数
+ * @return ERR_OK，或ERR_ARRAY_NULL、ERR_ARRAY_ALLOC
+ */
+error_code array_sort_int32(int32_t* data, size_t count);
+error_code array_sort_uint32(uint32_t* data, size_t count);
+error_code array_sort_int64(int64_t* data, size_t count);
+error_code array_sort_uint64(uint64_t* data, size_t count);
+
+/**
+ * @brief 升序排序double数组，顺序与按位比较IEEE 754全序相同：-0.0排在+0.0之前，
+ *        符号位为1的NaN排在最前，其余NaN排在最后
+ * @param data 数组，count为0时可为NULL
+ * @param count 元素个数
+ * @return ERR_OK，或ERR_ARRAY_NULL、ERR_ARRAY_ALLOC
+ */
+error_code array_sort_double(double* data, size_t count);
+
+/**
+ * @brief 选择第k小的元素（从0起），不完全排序，平均O(n)
+ *
+ * 以Floyd-Rivest算法划分；划分轮数超过限度时对剩余区间改用基数排序，最坏情况也是O(n)。
+ * 返回后data[k]即为结果，其左侧的元素都不大于它，右侧的都不小于它。double数组不能含NaN。
+ *
+ * @param data 数组，会被重新排列
+ * @param count 元素个数
+ * @param k 秩，小于count
+ * @param result 输出参数，第k小的元素，可为NULL
+ * @return ERR_OK，或ERR_ARRAY_NULL、ERR_ARRAY_RANGE（k不小于count）、ERR_ARRAY_ALLOC
+ */
+error_code array_select_int32(int32_t* data, size_t count, size_t k, int32_t* result);
+error_code array_select_int64(int64_t* data, size_t count, size_t k, int64_t* result);
+error_code array_select_uint64(uint64_t* data, size_t count, size_t k, uint64_t* result);
+error_code array_select_double(double* data, size_t count, size_t k, double* result);
+
+/**
+ * @brief 一次计算多个百分位数（最近秩法：第p百分位为第ceil(p / 100 * count)小的元素，至少为最小值）
+ *
+ * 按秩从小到大依次在剩余的右侧区间中选择，不排序整个数组；百分位数较多时改为整体排序。
+ *
+ * @param data 数组，会被重新排列
+ * @param count 元素个数，大于0
+ * @param percentiles 百分位数，取值0到100，不必有序
+ * @param n 百分位数个数，不超过ARRAY_MAX_PERCENTILES
+ * @param results 输出参数，与percentiles一一对应
+ * @return ERR_OK，或ERR_ARRAY_NULL、ERR_ARRAY_RANGE（count为0、n过大或百分位数超出范围）、ERR_ARRAY_ALLOC
+ */
+error_code array_percentiles_int32(int32_t* data, size_t count, const double* percentiles, size_t n,
+                                   int32_t* results);
+error_code array_percentiles_int64(int64_t* data, size_t count, const double* percentiles, size_t n,
+                                   int64_t* results);
+error_code array_percentiles_double(double* data, size_t count, const double* percentiles, size_t n,
+                                    double* results);
+
+/**
+ * @brief 在升序数组中查找第一个不小于key的元素的下标
+ *
+ * 无分支的二分查找（预取下两种可能的探测位置）把范围缩小到一个缓存行，再以AVX2一次比较
+ * 整个缓存行；不支持AVX2时逐个比较。不记录调试信息，适合在循环中调用。
+ *
+ * @param data 升序数组，count为0时可为NULL
+ * @param count 元素个数
+ * @param key 要查找的值
+ * @return 下标，所有元素都小于key时为count
+ */
+size_t array_lower_bound_int32(const int32_t* data, size_t count, int32_t key);
+size_t array_lower_bound_int64(const int64_t* data, size_t count, int64_t key);
+
+/**
+ * @brief 初始化数组算法模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_array_ops();
+
+#endif /* ARRAY_OPS_H */
\ No newline at end of file
@@ -0,0 +1,144 @@
+/**
+ * @file bignum_ops.h
+ * @brief 任意精度整数接口：64位limb向量表示，按规模选择朴素、Karatsuba或数论变换乘法，
+ *        分治的十进制转换，临时空间来自按线程缓存的内存池
+ */
+#ifndef BIGNUM_OPS_H
+#define BIGNUM_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+/**
+ * @brief 任意精度整数，绝对值为sum(limbs[i] * 2^(64*i))
+ *
+ * 最高的limb不为0，0的size为0且negative为0。用bignum_init初始化后使用，用bignum_free释放。
+ * 运算的输出参数可以与输入参数是同一个对象。
+ */
+typedef struct {
+    uint64_t* limbs;       /* 小端序 */
+    size_t size;           /* 有效limb数 */
+    size_t capacity;       /* limbs已分配的个数 */
+    int negative;          /* 负数为1 */
+} bignum;
+
+/**
+ * @brief 初始化为0
+ * @param x 大整数
+ */
+void bignum_init(bignum* x);
+
+/**
+ * @brief 释放大整数占用的内存，之后x为0
+ * @param x 大整数，可为NULL
+ */
+void bignum_free(bignum* x);
+
+/**
+ * @brief 赋值为int64_t
+ * @param x 大整数
+ * @param value 值
+ * @return ERR_OK，或ERR_BIGNUM_NULL、ERR_BIGNUM_ALLOC
+ */
+error_code bignum_set_int64(bignum* x, int64_t value);
+
+/**
+ * @brief 复制
+ * @param dst 目标
+ * @param src 源
+ * @return ERR_OK，或ERR_BIGNUM_NULL、ERR_BIGNUM_ALLOC
+ */
+error_code bignum_copy(bignum* dst, const bignum* src);
+
+/**
+ * @brief 比较两个大整数
+ * @param a 第一个数
+ * @param b 第二个数
+ * @return a < b返回负数，相等返回0，a > b返回正数
+ */
+int bignum_compare(const bignum* a, const bignum* b);
+
+/**
+ * @brief 加法 r = a + b
+ * @param r 结果
+ * @param a 第一个加数
+ * @param b 第二个加数
+ * @return ERR_OK，或ERR_BIGNUM_NULL、ERR_BIGNUM_ALLOC
+ */
+error_code bignum_add(bignum* r, const bignum* a, const bignum* b);
+
+/**
+ * @brief 减法 r = a - b
+ * @param r 结果
+ * @param a 被减数
+ * @param b 减数
+ * @return ERR_OK，或ERR_BIGNUM_NULL、ERR_BIGNUM_ALLOC
+ */
+error_code bignum_sub(bignum* r, const bignum* a, const bignum* b);
+
+/**
+ * @brief 乘法 r = a * b
+ *
+ * 较短的乘数不足32个limb时用朴素乘法，两个乘数都较长时用模2^64-2^32+1的数论变换，
+ * 其间用Karatsuba；长度相差较大时把较长的乘数分段。
+ *
+ * @param r 结果
+ * @param a 第一个乘数
+ * @param b 第二个乘数
+ * @return ERR_OK，或ERR_BIGNUM_NULL、ERR_BIGNUM_ALLOC
+ */
+error_code bignum_mul(bignum* r, const bignum* a, const bignum* b);
+
+/**
+ * @brief 带余除法，商向0取整，余数与被除数同号（与C的/和%相同）
+ *
+ * 除数较短时用Knuth算法D，否则以牛顿迭代求除数的倒数，把除法化为乘法。
+ *
+ * @param q 商，可为NULL
+ * @param r 余数，可为NULL，不能与q是同一个对象
+ * @param a 被除数
+ * @param b 除数
+ * @return ERR_OK，或ERR_BIGNUM_NULL、ERR_BIGNUM_DIVIDE_BY_ZERO、ERR_BIGNUM_ALLOC
+ */
+error_code bignum_divmod(bignum* q, bignum* r, const bignum* a, const bignum* b);
+
+/**
+ * @brief 从十进制文本解析
+ *
+ * 文本为可选的'+'或'-'后跟一个或多个数字。长文本按10^(19*2^k)分治，转换代价与乘法同阶。
+ *
+ * @param x 结果
+ * @param str 文本，不要求以'\0'结尾
+ * @param len 文本长度
+ * @return ERR_OK，或ERR_BIGNUM_NULL、ERR_BIGNUM_INVALID、ERR_BIGNUM_ALLOC
+ */
+error_code bignum_from_string(bignum* x, const char* str, size_t len);
+
+/**
+ * @brief 转换为十进制文本
+ *
+ * 以缓存的10^(19*2^k)及其倒数分治，转换代价与乘法同阶。
+ *
+ * @param x 大整数
+ * @param str 输出参数，新分配的以'\0'结尾的文本，调用者释放
+ * @param len 输出参数，文本长度，可为NULL
+ * @return ERR_OK，或ERR_BIGNUM_NULL、ERR_BIGNUM_ALLOC
+ */
+error_code bignum_to_string(const bignum* x, char** str, size_t* len);
+
+/**
+ * @brief 计算阶乘 r = n!，以乘积树使各次乘法的乘数长度接近
+ * @param r 结果
+ * @param n 非负整数
+ * @return ERR_OK，或ERR_BIGNUM_NULL、ERR_BIGNUM_ALLOC
+ */
+error_code bignum_factorial(bignum* r, uint32_t n);
+
+/**
+ * @brief 初始化大整数模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_bignum_ops();
+
+#endif /* BIGNUM_OPS_H */
\ No newline at end of file
@@ -0,0 +1,94 @@
+/**
+ * @file command.h
+ * @brief 命令协议接口：批处理模式与Unix域套接字服务
+ *
+ * 协议为按行分隔的文本命令，每条命令对应一行响应，响应顺序与命令顺序一致：
+ *   成功：OK <结果>
+ *   失败：ERR <错误代码> <错误代码名称>
+ * 客户端可以不等响应连续发送多条命令（流水线）。
+ */
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stddef.h>
+
+/* 单行命令的最大长度（不含换行符），超过时返回ERR_COMMAND_LINE_TOO_LONG */
+#define COMMAND_MAX_LINE (1 << 20)
+
+/**
+ * @brief 响应缓冲区，按需增长
+ */
+typedef struct {
+    char* data;
+    size_t len;
+    size_t capacity;
+} command_buffer;
+
+/**
+ * @brief 初始化响应缓冲区
+ * @param buffer 缓冲区
+ */
+void command_buffer_init(command_buffer* buffer);
+
+/**
+ * @brief 释放响应缓冲区
+ * @param buffer 缓冲区
+ */
+void command_buffer_free(command_buffer* buffer);
+
+/**
+ * @brief 执行一条命令，把响应行追加到out
+ *
+ * 支持的命令：ping、add/subtract/multiply/divide/gcd A B、factorial N、fibonacci N、
+ * primes START END（返回素数个数）、upper/lower/reverse TEXT、exists FILE、size FILE、
+ * hash FILE [crc32c|xxh32|xxh3|sha256]、quit。
+ *
+ * @param line 命令文本，不含换行符，不要求以'\0'结尾
+ * @param len 命令长度
+ * @param out 响应缓冲区
+ * @return 继续处理返回1，收到quit返回0，响应缓冲区内存分配失败返回-1
+ */
+int command_execute(const char* line, size_t len, command_buffer* out);
+
+/**
+ * @brief 批处理模式：逐行读取命令，流式写出响应
+ *
+ * 每读到一批输入就处理其中所有完整的行，响应攒满缓冲区或本批处理完时写出，
+ * 交互使用时每条命令都能及时得到响应，管道输入时按大块写出。
+ *
+ * @param in_fd 命令输入
+ * @param out_fd 响应输出
+ * @return 输入结束或收到quit返回1，读写失败返回0
+ */
+int command_run_batch(int in_fd, int out_fd);
+
+/**
+ * @brief 批处理模式：从文件读取命令，响应写到标准输出
+ * @param filename 命令文件，NULL或"-"表示标准输入
+ * @return 成功返回1，失败返回0
+ */
+int command_run_batch_file(const char* filename);
+
+/**
+ * @brief 在Unix域套接字上提供命令服务，阻塞直到收到SIGINT/SIGTERM或调用command_server_stop
+ *
+ * 单线程epoll事件循环，每个连接独立缓冲，支持流水线请求；
+ * 某个连接的待发送响应过多时暂停读取该连接，直到对方读走响应。
+ *
+ * @param socket_path 套接字路径，已存在的同名套接字文件会被替换
+ * @return 正常停止返回1，失败返回0
+ */
+int command_serve_unix(const char* socket_path);
+
+/**
+ * @brief 请求正在运行的command_serve_unix停止，可在任意线程或信号处理函数中调用
+ */
+void command_server_stop();
+
+/**
+ * @brief 初始化命令模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_command();
+
+#endif /* COMMAND_H */
\ No newline at end of file
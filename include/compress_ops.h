@@ -0,0 +1,123 @@
+/**
+ * @file compress_ops.h
+ * @brief 压缩文件流式读写接口（LZ4帧格式与zstd）
+ */
+#ifndef COMPRESS_OPS_H
+#define COMPRESS_OPS_H
+
+#include <stddef.h>
+
+/**
+ * @brief 压缩格式
+ */
+typedef enum {
+    COMPRESS_NONE = 0,   /* 不压缩，按原始字节读写 */
+    COMPRESS_LZ4 = 1,    /* LZ4帧格式（.lz4） */
+    COMPRESS_ZSTD = 2,   /* zstd帧格式（.zst） */
+    COMPRESS_AUTO = 3    /* 写入时按扩展名选择，读取时按文件头魔数识别 */
+} compress_format;
+
+/* 默认压缩级别，传0时使用 */
+#define COMPRESS_DEFAULT_LEVEL 0
+
+typedef struct compressed_writer compressed_writer;
+typedef struct compressed_reader compressed_reader;
+
+/**
+ * @brief 根据文件扩展名推断压缩格式
+ * @param filename 文件名
+ * @return .lz4返回COMPRESS_LZ4，.zst返回COMPRESS_ZSTD，否则返回COMPRESS_NONE
+ */
+compress_format compress_format_from_filename(const char* filename);
+
+/**
+ * @brief 打开流式写入器
+ * @param filename 文件名
+ * @param format 压缩格式，COMPRESS_AUTO表示按扩展名选择
+ * @param level 压缩级别，0表示默认级别（LZ4忽略此参数）
+ * @param num_threads 压缩线程数，0表示使用在线CPU数，1表示单线程
+ * @return 写入器，失败返回NULL
+ */
+compressed_writer* compressed_writer_open(const char* filename, compress_format format, int level, int num_threads);
+
+/**
+ * @brief 写入数据
+ * @param writer 写入器
+ * @param data 数据
+ * @param len 数据长度
+ * @return 成功返回1，失败返回0
+ */
+int compressed_writer_write(compressed_writer* writer, const void* data, size_t len);
+
+/**
+ * @brief 刷新剩余数据、写入帧尾并关闭写入器
+ * @param writer 写入器
+ * @return 成功返回1，失败返回0
+ */
+int compressed_writer_close(compressed_writer* writer);
+
+/**
+ * @brief 打开流式读取器，内存占用与文件大小无关
+ * @param filename 文件名
+ * @param format 压缩格式，COMPRESS_AUTO表示按文件头识别
+ * @return 读取器，失败返回NULL
+ */
+compressed_reader* compressed_reader_open(const char* filename, compress_format format);
+
+/**
+ * @brief 读取解压后的数据
+ * @param reader 读取器
+ * @param buffer 输出缓冲区
+ * @param size 缓冲区大小
+ * @return 读取的字节数，文件结束返回0，出错返回-1
+ */
+long compressed_reader_read(compressed_reader* reader, void* buffer, size_t size);
+
+/**
+ * @brief 关闭读取器
+ * @param reader 读取器
+ */
+void compressed_reader_close(compressed_reader* reader);
+
+/**
+ * @brief 读取（可能压缩的）文件的全部内容
+ * @param filename 文件名
+ * @param format 压缩格式，COMPRESS_AUTO表示按文件头识别
+ * @return 解压后的内容字符串，用mem_free释放
+ */
+char* read_file_compressed(const char* filename, compress_format format);
+
+/**
+ * @brief 将字符串写入（可能压缩的）文件
+ * @param filename 文件名
+ * @param content 要写入的内容
+ * @param format 压缩格式，COMPRESS_AUTO表示按扩展名选择
+ * @return 成功返回1，失败返回0
+ */
+int write_file_compressed(const char* filename, const char* content, compress_format format);
+
+/**
+ * @brief 压缩文件
+ * @param source 源文件
+ * @param destination 目标文件
+ * @param format 压缩格式，COMPRESS_AUTO表示按目标文件扩展名选择
+ * @param level 压缩级别，0表示默认级别
+ * @return 成功返回1，失败返回0
+ */
+int compress_file(const char* source, const char* destination, compress_format format, int level);
+
+/**
+ * @brief 解压文件
+ * @param source 源文件，格式按文件头识别
+ * @param destination 目标文件
+ * @return 成功返回1，失败返回0
+ */
+int decompress_file(const char* source, const char* destination);
+
+/**
+ * @brief 初始化压缩库
+ * @return 成功返回1，失败返回0
+ */
+int initialize_compress_ops();
+
+#endif /* COMPRESS_OPS_H */
\ No newline at end of file
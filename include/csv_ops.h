@@ -0,0 +1,128 @@
+/**
+ * @file csv_ops.h
+ * @brief CSV列式读取接口：内存映射输入、每次64字节的结构字符扫描、分块并行解析，输出按列存放的类型化数组
+ */
+#ifndef CSV_OPS_H
+#define CSV_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+/**
+ * @brief 列的类型，由该列的所有字段推断
+ */
+typedef enum {
+    CSV_INT64,      /* 所有字段都是int64_t范围内的整数 */
+    CSV_DOUBLE,     /* 所有字段都是数值（或为空，读作NaN），且至少一个不是整数 */
+    CSV_STRING      /* 其余情况 */
+} csv_type;
+
+/**
+ * @brief 一列数据，按type只有一个数组有效，各数组长度都是表的行数
+ */
+typedef struct {
+    char* name;             /* 列名：表头中的名称，无表头时为"column1"、"column2"…… */
+    csv_type type;
+    int64_t* ints;          /* CSV_INT64 */
+    double* doubles;        /* CSV_DOUBLE，空字段为NaN */
+    char* text;             /* CSV_STRING：所有字段去掉引号后依次存放，各以'\0'结尾 */
+    size_t* offsets;        /* CSV_STRING：第i个字段为text + offsets[i] */
+} csv_column;
+
+/**
+ * @brief 按列存放的表
+ */
+typedef struct {
+    int column_count;
+    size_t row_count;
+    csv_column* columns;
+} csv_table;
+
+/**
+ * @brief 读取选项
+ */
+typedef struct {
+    char delimiter;         /* 字段分隔符，默认',' */
+    int has_header;         /* 第一行是否为列名，默认1 */
+} csv_options;
+
+/**
+ * @brief 数值列的统计结果，NaN不参与统计
+ */
+typedef struct {
+    size_t count;           /* 参与统计的值的个数 */
+    double sum;
+    double min;
+    double max;
+    double mean;
+} csv_stats;
+
+/**
+ * @brief 默认选项：逗号分隔，有表头
+ * @return 选项
+ */
+csv_options csv_default_options();
+
+/**
+ * @brief 解析内存中的CSV文本
+ *
+ * 格式按RFC 4180：字段以分隔符隔开，行以"\n"或"\r\n"结束，空行被跳过；含分隔符、换行或引号的字段放在双引号中，
+ * 字段内的引号写作两个引号。每行的字段数必须与第一行相同。结构字符以SIMD每次扫描64字节，
+ * 大文本按行边界分段后在线程池上并行解析（各段起点的引号状态由各段引号个数的前缀异或得到）。
+ *
+ * @param data 文本，不要求以'\0'结尾
+ * @param len 文本长度
+ * @param options 读取选项，NULL表示默认选项
+ * @param table 输出参数，新分配的表，调用者用csv_free_table释放
+ * @return ERR_OK，或ERR_CSV_NULL、ERR_CSV_INVALID_ARGUMENT（分隔符为引号、'\r'、换行或'\0'）、
+ *         ERR_CSV_QUOTE（引号不成对或引号后有多余字符）、ERR_CSV_FIELD_COUNT（字段数与第一行不同）、ERR_CSV_ALLOC
+ */
+error_code csv_parse_buffer(const char* data, size_t len, const csv_options* options, csv_table** table);
+
+/**
+ * @brief 以内存映射读取并解析CSV文件
+ * @param filename 文件名
+ * @param options 读取选项，NULL表示默认选项
+ * @param table 输出参数，新分配的表，调用者用csv_free_table释放
+ * @return ERR_OK，ERR_CSV_OPEN（无法打开或映射文件），或csv_parse_buffer的错误代码
+ */
+error_code csv_read_file(const char* filename, const csv_options* options, csv_table** table);
+
+/**
+ * @brief 按列名查找列
+ * @param table 表
+ * @param name 列名
+ * @return 列序号，找不到返回-1
+ */
+int csv_find_column(const csv_table* table, const char* name);
+
+/**
+ * @brief 并行统计数值列的个数、和、最小值、最大值与平均值
+ * @param table 表
+ * @param column 列序号
+ * @param stats 输出参数，统计结果
+ * @return ERR_OK，或ERR_CSV_NULL、ERR_CSV_INVALID_ARGUMENT（列序号超出范围或不是数值列）
+ */
+error_code csv_column_stats(const csv_table* table, int column, csv_stats* stats);
+
+/**
+ * @brief 获取类型名称
+ * @param type 类型
+ * @return "int64"、"double"或"string"
+ */
+const char* csv_type_name(csv_type type);
+
+/**
+ * @brief 释放表
+ * @param table 表，可为NULL
+ */
+void csv_free_table(csv_table* table);
+
+/**
+ * @brief 初始化CSV模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_csv_ops();
+
+#endif /* CSV_OPS_H */
\ No newline at end of file
@@ -0,0 +1,106 @@
+/**
+ * @file dir_ops.h
+ * @brief 目录遍历与批量文件操作接口
+ */
+#ifndef DIR_OPS_H
+#define DIR_OPS_H
+
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+/* 访问回调的返回值 */
+#define DIR_WALK_CONTINUE 0   /* 继续遍历 */
+#define DIR_WALK_SKIP     1   /* 不进入该目录（仅对目录有效） */
+#define DIR_WALK_ABORT   -1   /* 中止整个遍历 */
+
+/* 遍历标志 */
+#define DIR_WALK_STAT     0x1 /* 对每个条目执行fstatat，回调中的st有效 */
+
+/**
+ * @brief 遍历进度计数器，可在遍历过程中由其他线程读取
+ */
+typedef struct {
+    atomic_ullong files;   /* 已处理的文件数 */
+    atomic_ullong dirs;    /* 已发现的目录数 */
+    atomic_ullong bytes;   /* 已处理文件的总字节数（需要stat信息） */
+    atomic_ullong errors;  /* 遇到的错误数 */
+} dir_progress;
+
+/**
+ * @brief 遍历选项
+ */
+typedef struct {
+    int num_threads;         /* 工作线程数，0表示使用共享的默认线程池 */
+    int flags;               /* DIR_WALK_* 标志 */
+    const char* pattern;     /* 文件名glob过滤（语法同fnmatch，flags为0），仅作用于非目录条目，NULL表示不过滤 */
+    dir_progress* progress;  /* 进度计数器，可为NULL */
+} dir_walk_options;
+
+/**
+ * @brief 传递给访问回调的条目信息
+ */
+typedef struct {
+    int dirfd;               /* 条目所在目录的文件描述符 */
+    const char* name;        /* 条目名称，相对于dirfd */
+    const char* path;        /* 条目相对于根目录的路径 */
+    int depth;               /* 深度，根目录的直接子项为1 */
+    int is_dir;              /* 是否为目录（不跟随符号链接） */
+    const struct stat* st;   /* 仅在设置DIR_WALK_STAT时有效，否则为NULL */
+} dir_entry_info;
+
+/**
+ * @brief 访问回调，会被多个线程并发调用
+ * @note 目录条目的回调一定先于其子项的回调执行
+ * @return DIR_WALK_CONTINUE、DIR_WALK_SKIP或DIR_WALK_ABORT
+ */
+typedef int (*dir_visit_fn)(const dir_entry_info* entry, void* ctx);
+
+/**
+ * @brief 将进度计数器清零
+ * @param progress 进度计数器
+ */
+void dir_progress_reset(dir_progress* progress);
+
+/**
+ * @brief 并行递归遍历目录树（不包括根目录本身）
+ * @param root 根目录
+ * @param options 遍历选项，可为NULL
+ * @param visit 访问回调
+ * @param ctx 传递给回调的上下文
+ * @return 成功返回1；失败、被中止或有条目无法打开、读取或stat（记录ERR_DIR_WALK_PARTIAL，
+ *         无论是否设置了progress）时返回0，此时其余条目仍已访问
+ */
+int dir_walk(const char* root, const dir_walk_options* options, dir_visit_fn visit, void* ctx);
+
+/**
+ * @brief 计算目录树中文件的总大小（表观大小，类似du --apparent-size）
+ * @param root 根目录
+ * @param options 遍历选项，可为NULL
+ * @return 总字节数；失败或有条目无法读取（结果不完整，记录ERR_DIR_WALK_PARTIAL）时返回-1
+ */
+long long dir_total_size(const char* root, const dir_walk_options* options);
+
+/**
+ * @brief 递归复制目录树，文件内容使用copy_file_range在内核中复制
+ * @param source 源目录
+ * @param destination 目标目录，不存在时自动创建
+ * @param options 遍历选项，可为NULL
+ * @return 成功返回1；失败、有条目复制失败或源目录中有条目无法读取（有子树未复制）时返回0
+ */
+int dir_copy(const char* source, const char* destination, const dir_walk_options* options);
+
+/**
+ * @brief 递归删除目录树
+ * @param root 根目录
+ * @param options 遍历选项，可为NULL；设置pattern时只删除匹配的文件，保留目录
+ * @return 成功返回1，失败返回0
+ */
+int dir_delete(const char* root, const dir_walk_options* options);
+
+/**
+ * @brief 初始化目录操作库
+ * @return 成功返回1，失败返回0
+ */
+int initialize_dir_ops();
+
+#endif /* DIR_OPS_H */
\ No newline at end of file
@@ -0,0 +1,211 @@
+/**
+ * @file error_codes.h
+ * @brief 错误代码定义：各模块的数字错误代码，千位表示所属模块
+ */
+#ifndef ERROR_CODES_H
+#define ERROR_CODES_H
+
+/*
+ * 所有错误代码的列表，X(名称, 数值)。
+ * 新增错误代码时只需在对应模块末尾追加一行，枚举值与error_code_name同步生成。
+ */
+#define ERROR_CODE_LIST(X) \
+    /* math_ops: 1xxx */ \
+    X(ERR_MATH_DIVIDE_BY_ZERO,          1001) /* 除数为零 */ \
+    X(ERR_MATH_NEGATIVE_FACTORIAL,      1002) /* 阶乘参数为负数 */ \
+    X(ERR_MATH_NEGATIVE_FIBONACCI,      1003) /* 斐波那契索引为负数 */ \
+    X(ERR_MATH_EMPTY_ARRAY,             1004) /* 数组大小不大于零 */ \
+    X(ERR_MATH_INVALID_RANGE,           1005) /* 起始值大于结束值 */ \
+    X(ERR_MATH_ALLOC,                   1006) /* 内存分配失败 */ \
+    X(ERR_MATH_INIT_UTILS,              1007) /* 初始化工具库失败 */ \
+    X(ERR_MATH_INIT_THREAD_POOL,        1008) /* 初始化线程池失败 */ \
+    X(ERR_MATH_OVERFLOW,                1009) /* 结果超出int范围 */ \
+    X(ERR_MATH_NULL_ARGUMENT,           1010) /* 数组或输出参数为NULL */ \
+    X(ERR_MATH_RANGE_TOO_LARGE,         1011) /* 素数计数的上界超过COUNT_PRIMES_MAX */ \
+    X(ERR_MATH_FACTORIZE_ZERO,          1012) /* 要分解的数为0 */ \
+    /* string_ops: 2xxx */ \
+    X(ERR_STRING_DUPLICATE_NULL,        2001) \
+    X(ERR_STRING_DUPLICATE_ALLOC,       2002) \
+    X(ERR_STRING_CONCATENATE_NULL,      2003) \
+    X(ERR_STRING_CONCATENATE_ALLOC,     2004) \
+    X(ERR_STRING_TO_UPPER_NULL,         2005) \
+    X(ERR_STRING_TO_LOWER_NULL,         2006) \
+    X(ERR_STRING_REVERSE_NULL,          2007) \
+    X(ERR_STRING_REVERSE_ALLOC,         2008) \
+    X(ERR_STRING_FIND_NULL,             2009) \
+    X(ERR_STRING_REPLACE_NULL,          2010) \
+    X(ERR_STRING_REPLACE_ALLOC,         2011) \
+    X(ERR_STRING_SPLIT_NULL,            2012) \
+    X(ERR_STRING_SPLIT_EMPTY_DELIMITER, 2013) \
+    X(ERR_STRING_SPLIT_ALLOC,           2014) \
+    X(ERR_STRING_INIT_UTILS,            2015) \
+    X(ERR_STRING_BATCH_INVALID,         2016) \
+    X(ERR_STRING_BATCH_ALLOC,           2017) \
+    X(ERR_STRING_INIT_THREAD_POOL,      2018) \
+    X(ERR_STRING_CODEC_INVALID,         2019) \
+    X(ERR_STRING_CODEC_ALLOC,           2020) \
+    X(ERR_STRING_DECODE_INVALID,        2021) \
+    /* file_ops: 3xxx */ \
+    X(ERR_FILE_READ_NULL,               3001) \
+    X(ERR_FILE_READ_OPEN,               3002) \
+    X(ERR_FILE_READ_ALLOC,              3003) \
+    X(ERR_FILE_WRITE_NULL,              3004) \
+    X(ERR_FILE_WRITE_OPEN,              3005) \
+    X(ERR_FILE_WRITE_FAILED,            3006) \
+    X(ERR_FILE_APPEND_NULL,             3007) \
+    X(ERR_FILE_APPEND_OPEN,             3008) \
+    X(ERR_FILE_APPEND_FAILED,           3009) \
+    X(ERR_FILE_EXISTS_NULL,             3010) \
+    X(ERR_FILE_SIZE_NULL,               3011) \
+    X(ERR_FILE_SIZE_STAT,               3012) \
+    X(ERR_FILE_COPY_NULL,               3013) \
+    X(ERR_FILE_MOVE_NULL,               3014) \
+    X(ERR_FILE_DELETE_NULL,             3015) \
+    X(ERR_FILE_DELETE_FAILED,           3016) \
+    X(ERR_FILE_INIT_UTILS,              3017) \
+    X(ERR_FILE_INIT_STRING_OPS,         3018) \
+    /* dir_ops: 4xxx */ \
+    X(ERR_DIR_NULL,                     4001) \
+    X(ERR_DIR_OPEN,                     4002) \
+    X(ERR_DIR_ALLOC,                    4003) \
+    X(ERR_DIR_POOL_CREATE,              4004) \
+    X(ERR_DIR_MKDIR,                    4005) \
+    X(ERR_DIR_COPY_PARTIAL,             4006) \
+    X(ERR_DIR_REMOVE_PARTIAL,           4007) \
+    X(ERR_DIR_INIT_FILE_OPS,            4008) \
+    X(ERR_DIR_INIT_THREAD_POOL,         4009) \
+    X(ERR_DIR_INIT_PATTERN,             4010) \
+    X(ERR_DIR_WALK_PARTIAL,             4011) \
+    /* hash_ops: 5xxx */ \
+    X(ERR_HASH_INVALID_ARGUMENT,        5001) \
+    X(ERR_HASH_ALLOC,                   5002) \
+    X(ERR_HASH_READ,                    5003) \
+    X(ERR_HASH_NULL,                    5004) \
+    X(ERR_HASH_MAP,                     5005) \
+    X(ERR_HASH_COPY_NULL,               5006) \
+    X(ERR_HASH_COPY_OPEN,               5007) \
+    X(ERR_HASH_COPY_FAILED,             5008) \
+    X(ERR_HASH_COMPARE_NULL,            5009) \
+    X(ERR_HASH_COMPARE_STAT,            5010) \
+    X(ERR_HASH_INIT_UTILS,              5011) \
+    X(ERR_HASH_INIT_THREAD_POOL,        5012) \
+    X(ERR_HASH_COMPARE_NOT_FILE,        5013) \
+    /* compress_ops: 6xxx */ \
+    X(ERR_COMPRESS_NULL,                6001) \
+    X(ERR_COMPRESS_OPEN,                6002) \
+    X(ERR_COMPRESS_ALLOC,               6003) \
+    X(ERR_COMPRESS_ZSTD,                6004) \
+    X(ERR_COMPRESS_WRITE,               6005) \
+    X(ERR_COMPRESS_CORRUPT,             6006) \
+    X(ERR_COMPRESS_READ,                6007) \
+    X(ERR_COMPRESS_CHECKSUM,            6008) \
+    X(ERR_COMPRESS_INIT_HASH,           6009) \
+    X(ERR_COMPRESS_UNSUPPORTED,         6010) \
+    /* thread_pool: 7xxx */ \
+    X(ERR_POOL_ALLOC,                   7001) \
+    X(ERR_POOL_THREAD_CREATE,           7002) \
+    X(ERR_POOL_INVALID_ARGUMENT,        7003) \
+    X(ERR_POOL_INIT_UTILS,              7004) \
+    /* metrics: 8xxx */ \
+    X(ERR_METRICS_ALLOC,                8001) \
+    X(ERR_METRICS_OPEN,                 8002) \
+    X(ERR_METRICS_WRITE,                8003) \
+    X(ERR_METRICS_INIT_UTILS,           8004) \
+    /* command: 9xxx */ \
+    X(ERR_COMMAND_UNKNOWN,              9001) /* 未知命令 */ \
+    X(ERR_COMMAND_BAD_ARGUMENT,         9002) /* 参数个数或格式错误 */ \
+    X(ERR_COMMAND_LINE_TOO_LONG,        9003) /* 命令超过COMMAND_MAX_LINE */ \
+    X(ERR_COMMAND_ALLOC,                9004) /* 内存分配失败 */ \
+    X(ERR_COMMAND_IO,                   9005) /* 读取命令或写出响应失败 */ \
+    X(ERR_COMMAND_SOCKET,               9006) /* 创建、绑定或监听套接字失败 */ \
+    X(ERR_COMMAND_INIT,                 9007) /* 初始化依赖模块失败 */ \
+    /* fingerprint_ops: 10xxx */ \
+    X(ERR_FINGERPRINT_NULL,             10001) /* 参数为NULL */ \
+    X(ERR_FINGERPRINT_INVALID_ARGUMENT, 10002) /* 窗口、分块参数、签名长度或阈值不合法 */ \
+    X(ERR_FINGERPRINT_ALLOC,            10003) /* 内存分配失败 */ \
+    X(ERR_FINGERPRINT_INIT_UTILS,       10004) /* 初始化工具库失败 */ \
+    X(ERR_FINGERPRINT_INIT_THREAD_POOL, 10005) /* 初始化线程池失败 */ \
+    /* number_ops: 11xxx */ \
+    X(ERR_NUMBER_NULL,                  11001) /* 参数为NULL */ \
+    X(ERR_NUMBER_INVALID,               11002) /* 不是数值、有多余字符或空字段 */ \
+    X(ERR_NUMBER_OVERFLOW,              11003) /* 超出目标类型的范围 */ \
+    X(ERR_NUMBER_ALLOC,                 11004) /* 内存分配失败 */ \
+    X(ERR_NUMBER_INIT_UTILS,            11005) /* 初始化工具库失败 */ \
+    X(ERR_NUMBER_INIT_THREAD_POOL,      11006) /* 初始化线程池失败 */ \
+    /* csv_ops: 12xxx */ \
+    X(ERR_CSV_NULL,                     12001) /* 参数为NULL */ \
+    X(ERR_CSV_INVALID_ARGUMENT,         12002) /* 分隔符或列序号无效 */ \
+    X(ERR_CSV_OPEN,                     12003) /* 无法打开或映射文件 */ \
+    X(ERR_CSV_QUOTE,                    12004) /* 引号不成对或引号外有多余字符 */ \
+    X(ERR_CSV_FIELD_COUNT,              12005) /* 字段数与第一行不同 */ \
+    X(ERR_CSV_ALLOC,                    12006) /* 内存分配失败 */ \
+    X(ERR_CSV_INIT_NUMBER,              12007) /* 初始化数值库失败 */ \
+    X(ERR_CSV_INIT_THREAD_POOL,         12008) /* 初始化线程池失败 */ \
+    /* bignum_ops: 13xxx */ \
+    X(ERR_BIGNUM_NULL,                  13001) /* 参数为NULL */ \
+    X(ERR_BIGNUM_INVALID,               13002) /* 不是整数，或商与余数是同一个对象 */ \
+    X(ERR_BIGNUM_DIVIDE_BY_ZERO,        13003) /* 除数为0 */ \
+    X(ERR_BIGNUM_ALLOC,                 13004) /* 内存分配失败 */ \
+    X(ERR_BIGNUM_INIT_UTILS,            13005) /* 初始化工具库失败 */ \
+    /* matrix_ops: 14xxx */ \
+    X(ERR_MATRIX_NULL,                  14001) /* 参数为NULL */ \
+    X(ERR_MATRIX_TYPE,                  14002) /* 元素类型无效或两个矩阵的元素类型不同 */ \
+    X(ERR_MATRIX_SHAPE,                 14003) /* 行数、列数不匹配或不是方阵 */ \
+    X(ERR_MATRIX_ALIAS,                 14004) /* 乘加的累加矩阵与乘数是同一个矩阵 */ \
+    X(ERR_MATRIX_ALLOC,                 14005) /* 内存分配失败或矩阵过大 */ \
+    X(ERR_MATRIX_INIT_UTILS,            14006) /* 初始化工具库失败 */ \
+    X(ERR_MATRIX_INIT_THREAD_POOL,      14007) /* 初始化线程池失败 */ \
+    /* array_ops: 15xxx */ \
+    X(ERR_ARRAY_NULL,                   15001) /* 参数为NULL */ \
+    X(ERR_ARRAY_RANGE,                  15002) /* 秩或百分位数超出范围 */ \
+    X(ERR_ARRAY_ALLOC,                  15003) /* 内存分配失败或数组过大 */ \
+    X(ERR_ARRAY_INIT_UTILS,             15004) /* 初始化工具库失败 */ \
+    X(ERR_ARRAY_INIT_THREAD_POOL,       15005) /* 初始化线程池失败 */ \
+    /* rope_ops: 16xxx */ \
+    X(ERR_ROPE_NULL,                    16001) /* 参数为NULL */ \
+    X(ERR_ROPE_RANGE,                   16002) /* 位置或范围超出文本长度 */ \
+    X(ERR_ROPE_ALIAS,                   16003) /* 拼接的源与目标是同一个文本 */ \
+    X(ERR_ROPE_ALLOC,                   16004) /* 内存分配失败 */ \
+    X(ERR_ROPE_OPEN,                    16005) /* 无法打开文件 */ \
+    X(ERR_ROPE_WRITE,                   16006) /* 写入失败 */ \
+    X(ERR_ROPE_INIT_UTILS,              16007) /* 初始化工具库失败 */ \
+    /* pattern_ops: 17xxx */ \
+    X(ERR_PATTERN_NULL,                 17001) /* 参数为NULL */ \
+    X(ERR_PATTERN_SYNTAX,               17002) /* 模式语法错误 */ \
+    X(ERR_PATTERN_TOO_LARGE,            17003) /* 重复次数、嵌套层数或展开后的NFA过大 */ \
+    X(ERR_PATTERN_ALLOC,                17004) /* 内存分配失败 */ \
+    X(ERR_PATTERN_INIT_UTILS,           17005) /* 初始化工具库失败 */ \
+    /* allocator: 18xxx */ \
+    X(ERR_MEM_BAD_POINTER,              18001) /* 释放的指针不是由mem_alloc分配的、已被释放或块头损坏 */ \
+    X(ERR_MEM_OVERRUN,                  18002) /* 调试模式检测到写越界 */ \
+    X(ERR_MEM_INIT_UTILS,               18003) /* 初始化工具库失败 */ \
+    /* line_index: 19xxx */ \
+    X(ERR_LINE_INDEX_NULL,              19001) /* 参数为NULL */ \
+    X(ERR_LINE_INDEX_OPEN,              19002) /* 无法打开文件或文件不是普通文件 */ \
+    X(ERR_LINE_INDEX_RANGE,             19003) /* 行号超出范围 */ \
+    X(ERR_LINE_INDEX_ALLOC,             19004) /* 内存分配或映射文件失败 */ \
+    X(ERR_LINE_INDEX_READ,              19005) /* 读取失败或文件已被截断 */ \
+    X(ERR_LINE_INDEX_SAVE,              19006) /* 写入索引文件失败 */ \
+    X(ERR_LINE_INDEX_INIT_HASH,         19007) /* 初始化哈希库失败 */ \
+    X(ERR_LINE_INDEX_INIT_THREAD_POOL,  19008) /* 初始化线程池失败 */
+
+#define ERROR_CODE_ENUM_ENTRY(name, value) name = value,
+
+/**
+ * @brief 错误代码，数值与日志中输出的错误代码一致
+ */
+typedef enum {
+    ERR_OK = 0,
+    ERROR_CODE_LIST(ERROR_CODE_ENUM_ENTRY)
+} error_code;
+
+#undef ERROR_CODE_ENUM_ENTRY
+
+/**
+ * @brief 获取错误代码的名称
+ * @param code 错误代码
+ * @return 名称字符串（如"ERR_MATH_DIVIDE_BY_ZERO"），未知代码返回"ERR_UNKNOWN"
+ */
+const char* error_code_name(error_code code);
+
+#endif /* ERROR_CODES_H */
\ No newline at end of file
@@ -5,10 +5,12 @@
 #ifndef FILE_OPS_H
 #define FILE_OPS_H
 
+#include "error_codes.h"
+
 /**
  * @brief 读取文件内容
  * @param filename 文件名
- * @return 文件内容字符串，调用者负责释放内存
+ * @return 文件内容字符串，用mem_free释放
  */
 char* read_file(const char* filename);
 
@@ -65,6 +67,75 @@ int move_file(const char* source, const char* destination);
  */
 int delete_file(const char* filename);
 
+/*
+ * 以下为返回错误代码的版本：成功返回ERR_OK，失败时返回错误代码（同时记为当前线程的最近错误）。
+ * 文件不存在等预期内的失败可以直接比较返回值，不需要解析日志；未启用LOG_ERROR时
+ * 错误路径不会格式化任何消息。copy_file_checked与move_file_checked返回内部步骤的错误代码。
+ */
+
+/**
+ * @brief 读取文件内容
+ * @param filename 文件名
+ * @param content 输出参数，文件内容字符串，用mem_free释放，失败时为NULL
+ * @return ERR_OK，或ERR_FILE_READ_NULL、ERR_FILE_READ_OPEN、ERR_FILE_READ_ALLOC
+ */
+error_code read_file_checked(const char* filename, char** content);
+
+/**
+ * @brief 写入文件内容
+ * @param filename 文件名
+ * @param content 要写入的内容
+ * @return ERR_OK，或ERR_FILE_WRITE_NULL、ERR_FILE_WRITE_OPEN、ERR_FILE_WRITE_FAILED
+ */
+error_code write_file_checked(const char* filename, const char* content);
+
+/**
+ * @brief 追加文件内容
+ * @param filename 文件名
+ * @param content 要追加的内容
+ * @return ERR_OK，或ERR_FILE_APPEND_NULL、ERR_FILE_APPEND_OPEN、ERR_FILE_APPEND_FAILED
+ */
+error_code append_file_checked(const char* filename, const char* content);
+
+/**
+ * @brief 检查文件是否存在
+ * @param filename 文件名
+ * @param exists 输出参数，存在为1，不存在为0（不算错误）
+ * @return ERR_OK，或ERR_FILE_EXISTS_NULL
+ */
+error_code file_exists_checked(const char* filename, int* exists);
+
+/**
+ * @brief 获取文件大小
+ * @param filename 文件名
+ * @param size 输出参数，文件大小（字节）
+ * @return ERR_OK，或ERR_FILE_SIZE_NULL、ERR_FILE_SIZE_STAT
+ */
+error_code get_file_size_checked(const char* filename, long* size);
+
+/**
+ * @brief 复制文件
+ * @param source 源文件
+ * @param destination 目标文件
+ * @return ERR_OK，ERR_FILE_COPY_NULL，或读取、写入步骤的错误代码
+ */
+error_code copy_file_checked(const char* source, const char* destination);
+
+/**
+ * @brief 移动文件
+ * @param source 源文件
+ * @param destination 目标文件
+ * @return ERR_OK，ERR_FILE_MOVE_NULL，或复制、删除步骤的错误代码
+ */
+error_code move_file_checked(const char* source, const char* destination);
+
+/**
+ * @brief 删除文件
+ * @param filename 文件名
+ * @return ERR_OK，或ERR_FILE_DELETE_NULL、ERR_FILE_DELETE_FAILED
+ */
+error_code delete_file_checked(const char* filename);
+
 /**
  * @brief 初始化文件操作库
  * @return 成功返回1，失败返回0
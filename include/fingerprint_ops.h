@@ -0,0 +1,231 @@
+/**
+ * @file fingerprint_ops.h
+ * @brief 内容指纹与近似匹配接口：Rabin-Karp滚动哈希、内容定义分块（FastCDC）、
+ *        MinHash相似度与近重复检测、Hamming距离与Levenshtein编辑距离
+ */
+#ifndef FINGERPRINT_OPS_H
+#define FINGERPRINT_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+/* MinHash签名的最大长度 */
+#define MINHASH_MAX_HASHES 1024
+
+/**
+ * @brief Rabin-Karp滚动哈希状态，模2^61-1的多项式哈希
+ */
+typedef struct {
+    uint64_t hash;
+    uint64_t out_factor;   /* base^(window-1)，用于移出窗口最左侧的字节 */
+    size_t window;
+} rolling_hash;
+
+/**
+ * @brief 内容定义分块参数，min_size <= avg_size <= max_size
+ */
+typedef struct {
+    size_t min_size;
+    size_t avg_size;       /* 期望的平均块大小，按2的幂取整 */
+    size_t max_size;
+} cdc_params;
+
+/**
+ * @brief 近重复文档对
+ */
+typedef struct {
+    int first;
+    int second;            /* first < second */
+    double similarity;     /* MinHash估计的Jaccard相似度 */
+} fingerprint_pair;
+
+/**
+ * @brief 计算一段数据的滚动哈希值
+ * @param data 数据
+ * @param len 数据长度
+ * @return 哈希值，与对同样内容的窗口滚动得到的值相同
+ */
+uint64_t rolling_hash_of(const void* data, size_t len);
+
+/**
+ * @brief 以data开头的window个字节初始化滚动哈希
+ * @param state 滚动哈希状态
+ * @param data 窗口内容
+ * @param window 窗口长度，大于0
+ */
+void rolling_hash_init(rolling_hash* state, const void* data, size_t window);
+
+/**
+ * @brief 窗口右移一个字节
+ * @param state 滚动哈希状态
+ * @param out 移出窗口的字节
+ * @param in 移入窗口的字节
+ * @return 新窗口的哈希值
+ */
+uint64_t rolling_hash_roll(rolling_hash* state, unsigned char out, unsigned char in);
+
+/**
+ * @brief 计算所有长度为window的窗口的哈希值
+ * @param data 数据
+ * @param len 数据长度
+ * @param window 窗口长度
+ * @param hashes 输出参数，新分配的数组，第i项为data[i, i + window)的哈希值，用mem_free释放
+ * @param count 输出参数，窗口个数（len < window时为0）
+ * @return ERR_OK，或ERR_FINGERPRINT_NULL、ERR_FINGERPRINT_INVALID_ARGUMENT、ERR_FINGERPRINT_ALLOC
+ */
+error_code rolling_hash_windows(const void* data, size_t len, size_t window, uint64_t** hashes,
+                                size_t* count);
+
+/**
+ * @brief Rabin-Karp查找所有匹配位置（包括重叠的匹配），哈希相同时逐字节确认
+ * @param text 文本
+ * @param text_len 文本长度
+ * @param pattern 模式
+ * @param pattern_len 模式长度，大于0
+ * @param positions 输出参数，新分配的匹配位置数组（升序），没有匹配时为NULL，用mem_free释放
+ * @param count 输出参数，匹配个数
+ * @return ERR_OK，或ERR_FINGERPRINT_NULL、ERR_FINGERPRINT_INVALID_ARGUMENT、ERR_FINGERPRINT_ALLOC
+ */
+error_code rabin_karp_find_all(const void* text, size_t text_len, const void* pattern, size_t pattern_len,
+                               size_t** positions, size_t* count);
+
+/**
+ * @brief 检查分块参数
+ * @param params 分块参数
+ * @return 合法返回1，否则返回0
+ */
+int cdc_params_valid(const cdc_params* params);
+
+/**
+ * @brief 查找下一个分块边界（FastCDC：gear哈希、跳过最小块长度、平均长度前后使用不同掩码）
+ *
+ * 边界只取决于块内的内容，插入或删除数据只影响附近的块，适合去重和增量同步。
+ *
+ * @param data 剩余数据
+ * @param len 剩余数据长度
+ * @param params 分块参数，须满足cdc_params_valid
+ * @return 下一个块的长度，len为0时返回0
+ */
+size_t cdc_next_boundary(const void* data, size_t len, const cdc_params* params);
+
+/**
+ * @brief 把数据切分为内容定义的块
+ * @param data 数据
+ * @param len 数据长度
+ * @param params 分块参数
+ * @param chunk_sizes 输出参数，新分配的块长度数组，用mem_free释放
+ * @param count 输出参数，块个数
+ * @return ERR_OK，或ERR_FINGERPRINT_NULL、ERR_FINGERPRINT_INVALID_ARGUMENT、ERR_FINGERPRINT_ALLOC
+ */
+error_code cdc_chunk(const void* data, size_t len, const cdc_params* params, size_t** chunk_sizes,
+                     size_t* count);
+
+/**
+ * @brief 计算MinHash签名：对所有长度为shingle_size的片段（shingle）取num_hashes个哈希函数的最小值
+ *
+ * 数据短于shingle_size时整段作为一个片段；两个签名中相同位置相等的比例估计两者片段集合的Jaccard相似度。
+ *
+ * @param data 数据
+ * @param len 数据长度
+ * @param shingle_size 片段长度，大于0
+ * @param num_hashes 签名长度，1到MINHASH_MAX_HASHES
+ * @param signature 输出参数，长度为num_hashes
+ * @return ERR_OK，或ERR_FINGERPRINT_NULL、ERR_FINGERPRINT_INVALID_ARGUMENT、ERR_FINGERPRINT_ALLOC
+ */
+error_code minhash_signature(const void* data, size_t len, size_t shingle_size, int num_hashes,
+                             uint64_t* signature);
+
+/**
+ * @brief 在线程池上并行计算多个文档的MinHash签名
+ * @param docs 文档数组
+ * @param lens 各文档长度
+ * @param count 文档个数
+ * @param shingle_size 片段长度
+ * @param num_hashes 签名长度
+ * @param signatures 输出参数，count * num_hashes个元素，第i个文档的签名从signatures[i * num_hashes]开始
+ * @return ERR_OK，或ERR_FINGERPRINT_NULL、ERR_FINGERPRINT_INVALID_ARGUMENT、ERR_FINGERPRINT_ALLOC
+ */
+error_code minhash_signatures(const void* const* docs, const size_t* lens, int count, size_t shingle_size,
+                              int num_hashes, uint64_t* signatures);
+
+/**
+ * @brief 由两个MinHash签名估计Jaccard相似度
+ * @param a 签名
+ * @param b 签名
+ * @param num_hashes 签名长度
+ * @return 0.0到1.0
+ */
+double minhash_similarity(const uint64_t* a, const uint64_t* b, int num_hashes);
+
+/**
+ * @brief 近重复检测：以LSH分带找出候选文档对，再按签名相似度筛选
+ *
+ * 签名分为bands段，任意一段完全相同的两个文档成为候选对，只比较候选对而不是所有文档对。
+ * 相似度为s的文档对成为候选的概率为1 - (1 - s^r)^bands，r = num_hashes / bands。
+ *
+ * @param signatures 签名，布局同minhash_signatures
+ * @param count 文档个数
+ * @param num_hashes 签名长度
+ * @param bands 分带数，1到num_hashes
+ * @param threshold 相似度阈值，0.0到1.0
+ * @param pairs 输出参数，新分配的文档对数组（按first、second排序），没有结果时为NULL，用mem_free释放
+ * @param pair_count 输出参数，文档对个数
+ * @return ERR_OK，或ERR_FINGERPRINT_NULL、ERR_FINGERPRINT_INVALID_ARGUMENT、ERR_FINGERPRINT_ALLOC
+ */
+error_code minhash_near_duplicates(const uint64_t* signatures, int count, int num_hashes, int bands,
+                                   double threshold, fingerprint_pair** pairs, int* pair_count);
+
+/**
+ * @brief 统计两段等长数据中不同字节的个数，支持AVX2时每次比较32字节
+ * @param a 数据
+ * @param b 数据
+ * @param len 长度
+ * @return 不同字节的个数
+ */
+size_t hamming_distance(const void* a, const void* b, size_t len);
+
+/**
+ * @brief 统计两段等长数据中不同比特的个数（用于比较二进制指纹）
+ * @param a 数据
+ * @param b 数据
+ * @param len 长度（字节）
+ * @return 不同比特的个数
+ */
+size_t hamming_distance_bits(const void* a, const void* b, size_t len);
+
+/**
+ * @brief 计算Levenshtein编辑距离（插入、删除、替换各计1）
+ *
+ * 使用Myers/Hyyrö位并行算法，每次处理较短字符串的64个字符，时间O(ceil(m / 64) * n)。
+ *
+ * @param a 字符串
+ * @param a_len 长度
+ * @param b 字符串
+ * @param b_len 长度
+ * @return 编辑距离，内存分配失败返回-1
+ */
+long levenshtein_distance(const char* a, size_t a_len, const char* b, size_t b_len);
+
+/**
+ * @brief 计算不超过max_distance的Levenshtein编辑距离
+ *
+ * 只计算主对角线两侧max_distance以内的带状区域，某一行全部超过max_distance时提前结束，
+ * 时间O(max_distance * n)；带宽超过位并行算法的代价时改用levenshtein_distance。
+ *
+ * @param a 字符串
+ * @param a_len 长度
+ * @param b 字符串
+ * @param b_len 长度
+ * @param max_distance 距离上限，不小于0
+ * @return 编辑距离，超过max_distance或内存分配失败时返回-1
+ */
+long levenshtein_bounded(const char* a, size_t a_len, const char* b, size_t b_len, long max_distance);
+
+/**
+ * @brief 初始化指纹模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_fingerprint_ops();
+
+#endif /* FINGERPRINT_OPS_H */
\ No newline at end of file
@@ -0,0 +1,176 @@
+/**
+ * @file hash_ops.h
+ * @brief 内容哈希与校验函数接口
+ */
+#ifndef HASH_OPS_H
+#define HASH_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 摘要的最大长度（SHA-256） */
+#define HASH_MAX_DIGEST_SIZE 32
+
+/**
+ * @brief 支持的哈希算法
+ */
+typedef enum {
+    HASH_CRC32C = 0,   /* CRC32C，支持SSE4.2时使用crc32指令，摘要4字节 */
+    HASH_XXH3 = 1,     /* xxHash3 64位，摘要8字节 */
+    HASH_SHA256 = 2,   /* SHA-256，支持SHA-NI时使用硬件指令，摘要32字节 */
+    HASH_XXH32 = 3     /* xxHash32（种子为0），LZ4帧格式使用，摘要4字节 */
+} hash_algorithm;
+
+/**
+ * @brief 流式哈希状态
+ */
+typedef struct {
+    hash_algorithm algorithm;
+    uint64_t total_len;
+    union {
+        uint32_t crc;
+        struct {
+            uint32_t v[4];
+            uint8_t buffer[16];
+            size_t buffered;
+        } xxh32;
+        struct {
+            uint64_t acc[8];
+            uint8_t buffer[256];
+            size_t buffered;
+            size_t stripes_so_far;
+        } xxh3;
+        struct {
+            uint32_t state[8];
+            uint8_t buffer[64];
+            size_t buffered;
+        } sha256;
+    } u;
+} hash_state;
+
+/**
+ * @brief 计算CRC32C
+ * @param crc 之前的CRC值，首次调用传0
+ * @param data 数据
+ * @param len 数据长度
+ * @return 更新后的CRC值
+ */
+uint32_t crc32c(uint32_t crc, const void* data, size_t len);
+
+/**
+ * @brief 计算xxHash3 64位哈希（种子为0）
+ * @param data 数据
+ * @param len 数据长度
+ * @return 哈希值
+ */
+uint64_t xxh3_64(const void* data, size_t len);
+
+/**
+ * @brief 计算xxHash32哈希
+ * @param data 数据
+ * @param len 数据长度
+ * @param seed 种子
+ * @return 哈希值
+ */
+uint32_t xxh32(const void* data, size_t len, uint32_t seed);
+
+/**
+ * @brief 计算SHA-256摘要
+ * @param data 数据
+ * @param len 数据长度
+ * @param digest 输出缓冲区，至少32字节
+ */
+void sha256(const void* data, size_t len, unsigned char* digest);
+
+/**
+ * @brief 获取算法的摘要长度
+ * @param algorithm 哈希算法
+ * @return 摘要字节数
+ */
+size_t hash_digest_size(hash_algorithm algorithm);
+
+/**
+ * @brief 初始化流式哈希状态
+ * @param state 哈希状态
+ * @param algorithm 哈希算法
+ */
+void hash_init(hash_state* state, hash_algorithm algorithm);
+
+/**
+ * @brief 向流式哈希追加数据
+ * @param state 哈希状态
+ * @param data 数据
+ * @param len 数据长度
+ */
+void hash_update(hash_state* state, const void* data, size_t len);
+
+/**
+ * @brief 结束流式哈希并输出摘要（大端字节序）
+ * @param state 哈希状态
+ * @param digest 输出缓冲区，至少hash_digest_size()字节
+ * @return 摘要字节数
+ */
+size_t hash_final(hash_state* state, unsigned char* digest);
+
+/**
+ * @brief 对内存缓冲区（例如mmap视图）计算摘要
+ * @param data 数据
+ * @param len 数据长度
+ * @param algorithm 哈希算法
+ * @param digest 输出缓冲区
+ * @return 摘要字节数
+ */
+size_t hash_buffer(const void* data, size_t len, hash_algorithm algorithm, unsigned char* digest);
+
+/**
+ * @brief 从已打开的文件描述符的当前位置流式读取到末尾并计算摘要
+ * @param fd 文件描述符
+ * @param algorithm 哈希算法
+ * @param digest 输出缓冲区
+ * @return 成功返回1，失败返回0
+ */
+int hash_fd(int fd, hash_algorithm algorithm, unsigned char* digest);
+
+/**
+ * @brief 计算文件摘要，内部使用mmap视图
+ * @param filename 文件名
+ * @param algorithm 哈希算法
+ * @param digest 输出缓冲区
+ * @return 成功返回1，失败返回0
+ */
+int hash_file(const char* filename, hash_algorithm algorithm, unsigned char* digest);
+
+/**
+ * @brief 将摘要转换为十六进制字符串
+ * @param digest 摘要
+ * @param len 摘要长度
+ * @return 十六进制字符串，用mem_free释放
+ */
+char* hash_to_hex(const unsigned char* digest, size_t len);
+
+/**
+ * @brief 复制文件并在同一次读取中计算源文件摘要
+ * @param source 源文件
+ * @param destination 目标文件
+ * @param algorithm 哈希算法
+ * @param digest 输出缓冲区，可为NULL（此时等同于普通复制）
+ * @return 成功返回1，失败返回0
+ */
+int copy_file_hashed(const char* source, const char* destination, hash_algorithm algorithm,
+                     unsigned char* digest);
+
+/**
+ * @brief 比较两个文件内容是否相同：先比较大小，再映射两个文件并行分块逐字节比较
+ * @param file1 第一个文件
+ * @param file2 第二个文件
+ * @return 相同返回1，不同返回0，出错（包括任一个不是普通文件）返回-1
+ */
+int files_equal(const char* file1, const char* file2);
+
+/**
+ * @brief 初始化哈希库
+ * @return 成功返回1，失败返回0
+ */
+int initialize_hash_ops();
+
+#endif /* HASH_OPS_H */
\ No newline at end of file
@@ -0,0 +1,149 @@
+/**
+ * @file line_index.h
+ * @brief 行偏移索引接口：为大文本文件建立每行起始位置的索引并保存在旁路文件中，
+ *        之后以O(1)的代价按行号读取任意一行或连续的若干行
+ *
+ * 索引保存为与文件同目录的"<文件名>.lidx"：文件头记录建立索引时文件的大小、修改时间、
+ * 末尾4KB的哈希与文件头自身的哈希，随后是相邻行起始位置之差的varint序列。
+ * 文件只在末尾增长时（append_file或其他进程追加），只扫描新增的部分并追加到索引文件中。
+ */
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+/* 忽略已有的索引文件，重新扫描整个文件 */
+#define LINE_INDEX_REBUILD 0x01
+/* 不创建或更新索引文件（例如目录只读时） */
+#define LINE_INDEX_NO_SAVE 0x02
+
+/* 索引文件名的后缀 */
+#define LINE_INDEX_SUFFIX ".lidx"
+
+/**
+ * @brief 行索引，可被多个线程同时用于读取；line_index_refresh不能与读取同时进行
+ */
+typedef struct line_index line_index;
+
+/**
+ * @brief 索引的来源
+ */
+typedef enum {
+    LINE_INDEX_LOADED = 0,   /* 索引文件与文件一致，直接载入 */
+    LINE_INDEX_EXTENDED,     /* 文件在索引之后有追加，只扫描了新增部分 */
+    LINE_INDEX_BUILT         /* 没有可用的索引文件，扫描了整个文件 */
+} line_index_source;
+
+/**
+ * @brief 打开文件并载入、更新或建立行索引
+ *
+ * 行以'\n'分隔，返回的行不含'\n'；文件末尾没有换行符时最后一行同样计入，空文件没有行。
+ * 建立索引时以内存映射读取文件，SIMD查找换行符，大文件分段并行扫描。
+ * 索引文件只根据大小、修改时间和末尾4KB判断文件是否改变：在已索引的范围内原地修改、
+ * 且大小与修改时间都不变的文件需要用LINE_INDEX_REBUILD重建。
+ *
+ * @param filename 文件名
+ * @param flags LINE_INDEX_REBUILD、LINE_INDEX_NO_SAVE的组合
+ * @param out 输出参数，索引，用line_index_close释放
+ * @return ERR_OK，或ERR_LINE_INDEX_NULL、ERR_LINE_INDEX_OPEN、ERR_LINE_INDEX_ALLOC；
+ *         无法写入索引文件不算错误
+ */
+error_code line_index_open(const char* filename, int flags, line_index** out);
+
+/**
+ * @brief 关闭文件并释放索引
+ * @param index 索引，可为NULL
+ */
+void line_index_close(line_index* index);
+
+/**
+ * @brief 获取行数
+ * @param index 索引
+ * @return 行数
+ */
+uint64_t line_index_count(const line_index* index);
+
+/**
+ * @brief 获取索引覆盖的字节数，即打开或最近一次刷新时文件的大小
+ * @param index 索引
+ * @return 字节数
+ */
+uint64_t line_index_size(const line_index* index);
+
+/**
+ * @brief 获取索引的来源
+ * @param index 索引
+ * @return 打开或最近一次刷新时索引的来源
+ */
+line_index_source line_index_get_source(const line_index* index);
+
+/**
+ * @brief 获取一行在文件中的范围，最多解码63个varint，不读文件
+ *
+ * 不记录调试信息，适合在循环中调用。
+ *
+ * @param index 索引
+ * @param line 行号，从0开始
+ * @param offset 输出参数，行首的偏移
+ * @param length 输出参数，行的字节数（不含'\n'）
+ * @return ERR_OK，或ERR_LINE_INDEX_NULL、ERR_LINE_INDEX_RANGE
+ */
+error_code line_index_span(const line_index* index, uint64_t line, uint64_t* offset, size_t* length);
+
+/**
+ * @brief 以一次pread读取一行
+ * @param index 索引
+ * @param line 行号，从0开始
+ * @param text 输出参数，以'\0'结尾的行，用mem_free释放
+ * @param length 输出参数，行的字节数，可为NULL
+ * @return ERR_OK，或ERR_LINE_INDEX_NULL、ERR_LINE_INDEX_RANGE、ERR_LINE_INDEX_ALLOC、
+ *         ERR_LINE_INDEX_READ（读取失败或文件被截断）
+ */
+error_code line_index_read_line(const line_index* index, uint64_t line, char** text, size_t* length);
+
+/**
+ * @brief 以一次pread读取连续的若干行
+ * @param index 索引
+ * @param first 第一行的行号，从0开始
+ * @param count 行数，大于0
+ * @param text 输出参数，从第一行行首到最后一行行尾（不含最后的'\n'）的内容，以'\0'结尾，用mem_free释放
+ * @param length 输出参数，内容的字节数，可为NULL
+ * @return ERR_OK，或ERR_LINE_INDEX_NULL、ERR_LINE_INDEX_RANGE、ERR_LINE_INDEX_ALLOC、ERR_LINE_INDEX_READ
+ */
+error_code line_index_read_lines(const line_index* index, uint64_t first, uint64_t count, char** text,
+                                 size_t* length);
+
+/**
+ * @brief 把文件在索引之后追加的内容加入索引，并按打开时的选项更新索引文件
+ *
+ * 文件被截断或已索引的末尾被改写时重新扫描整个文件。
+ *
+ * @param index 索引
+ * @return ERR_OK，或ERR_LINE_INDEX_NULL、ERR_LINE_INDEX_OPEN、ERR_LINE_INDEX_ALLOC
+ */
+error_code line_index_refresh(line_index* index);
+
+/**
+ * @brief 文件有索引文件时，把追加的内容加入索引文件，只扫描新增的部分
+ *
+ * 由append_file在追加成功后调用；没有索引文件时只有一次失败的open。
+ * 文件不是在末尾增长时不重建（留给下一次line_index_open），以免追加变慢。
+ * 失败时只返回错误代码，不记录错误，append_file成功返回后get_last_error不受影响。
+ * 不需要初始化任何模块（用到的默认线程池在第一次并行扫描时创建），可在模块初始化之前调用，
+ * 因此file_ops不声明对line_index的依赖。
+ *
+ * @param filename 文件名
+ * @return ERR_OK（包括没有索引文件或索引文件已失效），或ERR_LINE_INDEX_NULL、ERR_LINE_INDEX_ALLOC、
+ *         ERR_LINE_INDEX_SAVE
+ */
+error_code line_index_update_sidecar(const char* filename);
+
+/**
+ * @brief 初始化行索引模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_line_index();
+
+#endif /* LINE_INDEX_H */
\ No newline at end of file
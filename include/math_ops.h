@@ -5,11 +5,29 @@
 #ifndef MATH_OPS_H
 #define MATH_OPS_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+/* count_primes支持的最大上界 */
+#define COUNT_PRIMES_MAX 100000000000000ULL
+/* 64位整数至多有15个不同的素因子（前16个素数之积超过2^64） */
+#define MAX_PRIME_FACTORS 15
+
+/**
+ * @brief 素因子分解结果：n = primes[0]^exponents[0] * ... * primes[count-1]^exponents[count-1]
+ */
+typedef struct {
+    int count;                              /* 不同素因子的个数，n为1时为0 */
+    uint64_t primes[MAX_PRIME_FACTORS];     /* 升序 */
+    int exponents[MAX_PRIME_FACTORS];
+} prime_factors;
+
 /**
  * @brief 计算两数之和
  * @param a 第一个数
  * @param b 第二个数
- * @return 两数之和
+ * @return 两数之和，结果溢出时返回0
  */
 int add(int a, int b);
 
@@ -17,7 +35,7 @@ int add(int a, int b);
  * @brief 计算两数之差
  * @param a 第一个数
  * @param b 第二个数
- * @return a-b的结果
+ * @return a-b的结果，结果溢出时返回0
  */
 int subtract(int a, int b);
 
@@ -25,7 +43,7 @@ int subtract(int a, int b);
  * @brief 计算两数之积
  * @param a 第一个数
  * @param b 第二个数
- * @return 两数之积
+ * @return 两数之积，结果溢出时返回0
  */
 int multiply(int a, int b);
 
@@ -33,21 +51,21 @@ int multiply(int a, int b);
  * @brief 计算两数之商
  * @param a 第一个数
  * @param b 第二个数
- * @return a/b的结果，如果b为0则返回0
+ * @return a/b的结果，如果b为0或结果溢出则返回0
  */
 int divide(int a, int b);
 
 /**
  * @brief 计算一个数的阶乘
  * @param n 要计算阶乘的数
- * @return n的阶乘
+ * @return n的阶乘，n为负数或结果超出int范围时返回-1
  */
 int factorial(int n);
 
 /**
  * @brief 计算斐波那契数列的第n项
  * @param n 要计算的项
- * @return 斐波那契数列的第n项
+ * @return 斐波那契数列的第n项，n为负数或结果超出int范围时返回-1
  */
 int fibonacci(int n);
 
@@ -55,7 +73,7 @@ int fibonacci(int n);
  * @brief 计算最大公约数
  * @param a 第一个数
  * @param b 第二个数
- * @return a和b的最大公约数
+ * @return a和b的最大公约数（非负），结果超出int范围（如gcd(INT_MIN, 0)）时返回-1
  */
 int gcd(int a, int b);
 
@@ -72,10 +90,146 @@ double average(int arr[], int size);
  * @param start 起始值
  * @param end 结束值
  * @param count 输出参数，返回找到的素数个数
- * @return 素数数组，调用者负责释放内存
+ * @return 素数数组，用mem_free释放
  */
 int* find_primes(int start, int end, int* count);
 
+/**
+ * @brief 计算闭区间[lo, hi]内的素数个数，不生成素数数组
+ * @param lo 起始值
+ * @param hi 结束值，不超过COUNT_PRIMES_MAX
+ * @return 素数个数，参数无效时返回0
+ */
+uint64_t count_primes(uint64_t lo, uint64_t hi);
+
+/**
+ * @brief 判断64位整数是否为素数（小素数试除后做确定性的Miller-Rabin检验）
+ * @param n 要判断的数
+ * @return 是素数返回1，否则返回0
+ */
+int is_prime_u64(uint64_t n);
+
+/*
+ * 以下为返回错误代码的版本：成功返回ERR_OK并通过输出参数返回结果，
+ * 失败时返回错误代码（同时记为当前线程的最近错误），输出参数保持不变。
+ * 与上面的函数不同，整数运算会检查溢出。
+ */
+
+/**
+ * @brief 计算两数之和，检查溢出
+ * @param a 第一个数
+ * @param b 第二个数
+ * @param result 输出参数，两数之和
+ * @return ERR_OK，或ERR_MATH_OVERFLOW、ERR_MATH_NULL_ARGUMENT
+ */
+error_code add_checked(int a, int b, int* result);
+
+/**
+ * @brief 计算两数之差，检查溢出
+ * @param a 第一个数
+ * @param b 第二个数
+ * @param result 输出参数，a-b的结果
+ * @return ERR_OK，或ERR_MATH_OVERFLOW、ERR_MATH_NULL_ARGUMENT
+ */
+error_code subtract_checked(int a, int b, int* result);
+
+/**
+ * @brief 计算两数之积，检查溢出
+ * @param a 第一个数
+ * @param b 第二个数
+ * @param result 输出参数，两数之积
+ * @return ERR_OK，或ERR_MATH_OVERFLOW、ERR_MATH_NULL_ARGUMENT
+ */
+error_code multiply_checked(int a, int b, int* result);
+
+/**
+ * @brief 计算两数之商
+ * @param a 第一个数
+ * @param b 第二个数
+ * @param result 输出参数，a/b的结果
+ * @return ERR_OK，或ERR_MATH_DIVIDE_BY_ZERO、ERR_MATH_OVERFLOW、ERR_MATH_NULL_ARGUMENT
+ */
+error_code divide_checked(int a, int b, int* result);
+
+/**
+ * @brief 计算一个数的阶乘
+ * @param n 要计算阶乘的数
+ * @param result 输出参数，n的阶乘
+ * @return ERR_OK，或ERR_MATH_NEGATIVE_FACTORIAL、ERR_MATH_OVERFLOW、ERR_MATH_NULL_ARGUMENT
+ */
+error_code factorial_checked(int n, int* result);
+
+/**
+ * @brief 计算斐波那契数列的第n项
+ * @param n 要计算的项
+ * @param result 输出参数，斐波那契数列的第n项
+ * @return ERR_OK，或ERR_MATH_NEGATIVE_FIBONACCI、ERR_MATH_OVERFLOW、ERR_MATH_NULL_ARGUMENT
+ */
+error_code fibonacci_checked(int n, int* result);
+
+/**
+ * @brief 计算最大公约数
+ * @param a 第一个数
+ * @param b 第二个数
+ * @param result 输出参数，a和b的最大公约数（非负）
+ * @return ERR_OK，或ERR_MATH_OVERFLOW（结果为2^31）、ERR_MATH_NULL_ARGUMENT
+ */
+error_code gcd_checked(int a, int b, int* result);
+
+/**
+ * @brief 计算数组的平均值
+ * @param arr 整数数组
+ * @param size 数组大小
+ * @param result 输出参数，数组元素的平均值
+ * @return ERR_OK，或ERR_MATH_EMPTY_ARRAY、ERR_MATH_NULL_ARGUMENT
+ */
+error_code average_checked(const int arr[], int size, double* result);
+
+/**
+ * @brief 计算指定范围内的所有素数
+ * @param start 起始值
+ * @param end 结束值
+ * @param primes 输出参数，素数数组，用mem_free释放
+ * @param count 输出参数，找到的素数个数
+ * @return ERR_OK，或ERR_MATH_INVALID_RANGE、ERR_MATH_ALLOC、ERR_MATH_NULL_ARGUMENT
+ */
+error_code find_primes_checked(int start, int end, int** primes, int* count);
+
+/**
+ * @brief 计算闭区间[lo, hi]内的素数个数，不生成素数数组
+ *
+ * 较长的区间用Lucy_Hedgehog算法（Legendre筛的φ函数按⌊hi/k⌋的取值递推）求π(hi) - π(lo - 1)，
+ * 时间约为O(hi^{3/4})，空间为O(hi^{1/2})，每个素数的筛除更新在线程池上并行；
+ * 较短的区间用分段筛并行统计。
+ *
+ * @param lo 起始值
+ * @param hi 结束值，不超过COUNT_PRIMES_MAX
+ * @param count 输出参数，素数个数
+ * @return ERR_OK，或ERR_MATH_INVALID_RANGE、ERR_MATH_RANGE_TOO_LARGE、ERR_MATH_ALLOC、ERR_MATH_NULL_ARGUMENT
+ */
+error_code count_primes_checked(uint64_t lo, uint64_t hi, uint64_t* count);
+
+/**
+ * @brief 分解64位整数的素因子
+ *
+ * 先用小素数表试除（以模2^64的乘法逆元判断整除），剩余部分用确定性的Miller-Rabin检验判断素性，
+ * 合数用Pollard-Brent rho拆分：模运算使用Montgomery乘法，多步的差连乘后才做一次GCD。
+ *
+ * @param n 要分解的数
+ * @param result 输出参数，分解结果
+ * @return ERR_OK，或ERR_MATH_FACTORIZE_ZERO、ERR_MATH_NULL_ARGUMENT
+ */
+error_code factorize_u64(uint64_t n, prime_factors* result);
+
+/**
+ * @brief 分解数组中每个数的素因子，数组较大时在线程池上并行
+ * @param values 要分解的数
+ * @param count 个数
+ * @param results 输出参数，与values等长，值为0的位置count为0
+ * @return ERR_OK，或ERR_MATH_FACTORIZE_ZERO（数组中有0，其余各数仍被分解）、ERR_MATH_NULL_ARGUMENT
+ */
+error_code factorize_u64_batch(const uint64_t* values, size_t count, prime_factors* results);
+
 /**
  * @brief 初始化数学运算库
  * @return 成功返回1，失败返回0
@@ -0,0 +1,139 @@
+/**
+ * @file matrix_ops.h
+ * @brief 稠密矩阵接口：行主序、按缓存行对齐的矩阵，分块打包与SIMD微内核的矩阵乘法（按C的分块并行），
+ *        以反复平方计算矩阵幂
+ */
+#ifndef MATRIX_OPS_H
+#define MATRIX_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+/* 矩阵数据与每行行首的对齐字节数 */
+#define MATRIX_ALIGNMENT 64
+
+/**
+ * @brief 元素类型；整数运算按补码回绕（模2^32或2^64），不报告溢出
+ */
+typedef enum {
+    MATRIX_INT32,
+    MATRIX_INT64,
+    MATRIX_DOUBLE
+} matrix_type;
+
+/**
+ * @brief 行主序矩阵，第i行第j列的元素为((T*)data)[i * stride + j]
+ *
+ * 用matrix_init初始化为空矩阵，或用matrix_create分配；用matrix_free释放。
+ */
+typedef struct {
+    matrix_type type;
+    size_t rows;
+    size_t cols;
+    size_t stride;      /* 相邻两行的间隔（元素个数），使每行行首按MATRIX_ALIGNMENT对齐 */
+    void* data;         /* 行数或列数为0时为NULL */
+} matrix;
+
+/* 按元素类型T访问第i行第j列的元素 */
+#define MATRIX_AT(m, T, i, j) (((T*)(m)->data)[(size_t)(i) * (m)->stride + (size_t)(j)])
+
+/**
+ * @brief 分配按MATRIX_ALIGNMENT对齐的内存
+ * @param size 字节数
+ * @return 内存，用free释放；size为0或分配失败返回NULL
+ */
+void* matrix_aligned_alloc(size_t size);
+
+/**
+ * @brief 初始化为0行0列的空矩阵
+ * @param m 矩阵
+ */
+void matrix_init(matrix* m);
+
+/**
+ * @brief 释放矩阵的数据，之后m为空矩阵
+ * @param m 矩阵，可为NULL
+ */
+void matrix_free(matrix* m);
+
+/**
+ * @brief 分配rows行cols列、元素全为0的矩阵，m原有的数据会被释放
+ * @param m 矩阵，已初始化
+ * @param type 元素类型
+ * @param rows 行数
+ * @param cols 列数
+ * @return ERR_OK，或ERR_MATRIX_NULL、ERR_MATRIX_TYPE、ERR_MATRIX_ALLOC
+ */
+error_code matrix_create(matrix* m, matrix_type type, size_t rows, size_t cols);
+
+/**
+ * @brief 分配n阶单位矩阵
+ * @param m 矩阵，已初始化
+ * @param type 元素类型
+ * @param n 阶数
+ * @return ERR_OK，或ERR_MATRIX_NULL、ERR_MATRIX_TYPE、ERR_MATRIX_ALLOC
+ */
+error_code matrix_identity(matrix* m, matrix_type type, size_t n);
+
+/**
+ * @brief 复制
+ * @param dst 目标，已初始化
+ * @param src 源
+ * @return ERR_OK，或ERR_MATRIX_NULL、ERR_MATRIX_ALLOC
+ */
+error_code matrix_copy(matrix* dst, const matrix* src);
+
+/**
+ * @brief 矩阵乘法 c = a * b
+ *
+ * 按缓存大小把a、b分块并打包成连续的条带，由寄存器分块的微内核（AVX-512、AVX2/FMA或标量，
+ * 按CPU选择）计算；运算量较大时按C的分块在线程池上并行。
+ *
+ * @param c 结果，已初始化，可以与a或b是同一个对象
+ * @param a 左矩阵，m行k列
+ * @param b 右矩阵，k行n列，元素类型与a相同
+ * @return ERR_OK，或ERR_MATRIX_NULL、ERR_MATRIX_TYPE、ERR_MATRIX_SHAPE、ERR_MATRIX_ALLOC
+ */
+error_code matrix_multiply(matrix* c, const matrix* a, const matrix* b);
+
+/**
+ * @brief 乘加 c += a * b
+ * @param c 累加的矩阵，m行n列，不能与a或b是同一个对象
+ * @param a 左矩阵，m行k列
+ * @param b 右矩阵，k行n列
+ * @return ERR_OK，或ERR_MATRIX_NULL、ERR_MATRIX_TYPE、ERR_MATRIX_SHAPE、ERR_MATRIX_ALIAS、ERR_MATRIX_ALLOC
+ */
+error_code matrix_multiply_add(matrix* c, const matrix* a, const matrix* b);
+
+/**
+ * @brief 方阵的幂 r = a^n，以反复平方计算，约2*log2(n)次乘法
+ * @param r 结果，已初始化，可以与a是同一个对象
+ * @param a 方阵
+ * @param n 指数，为0时结果为单位矩阵
+ * @return ERR_OK，或ERR_MATRIX_NULL、ERR_MATRIX_SHAPE、ERR_MATRIX_ALLOC
+ */
+error_code matrix_power(matrix* r, const matrix* a, uint64_t n);
+
+/**
+ * @brief 以[[1, 1], [1, 0]]^n计算斐波那契数F(n)模2^64，O(log n)
+ * @param n 索引
+ * @param result 输出参数，F(n) mod 2^64
+ * @return ERR_OK，或ERR_MATRIX_NULL、ERR_MATRIX_ALLOC
+ */
+error_code matrix_fibonacci(uint64_t n, uint64_t* result);
+
+/**
+ * @brief 获取某种元素类型的矩阵乘法所用微内核的名称
+ * @param type 元素类型
+ * @return 例如"avx512 12x16"，类型无效时返回"unknown"
+ */
+const char* matrix_kernel_name(matrix_type type);
+
+/**
+ * @brief 初始化矩阵模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_matrix_ops();
+
+#endif /* MATRIX_OPS_H */
\ No newline at end of file
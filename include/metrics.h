@@ -0,0 +1,132 @@
+/**
+ * @file metrics.h
+ * @brief 运行时指标接口：函数调用计数、错误计数与文件操作延迟直方图
+ */
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+/**
+ * @brief 被统计调用次数的公开函数
+ */
+typedef enum {
+    /* math_ops */
+    METRIC_ADD = 0,
+    METRIC_SUBTRACT,
+    METRIC_MULTIPLY,
+    METRIC_DIVIDE,
+    METRIC_FACTORIAL,
+    METRIC_FIBONACCI,
+    METRIC_GCD,
+    METRIC_AVERAGE,
+    METRIC_FIND_PRIMES,
+    METRIC_COUNT_PRIMES,
+    METRIC_FACTORIZE,
+    /* string_ops */
+    METRIC_STRING_DUPLICATE,
+    METRIC_STRING_CONCATENATE,
+    METRIC_STRING_TO_UPPER,
+    METRIC_STRING_TO_LOWER,
+    METRIC_STRING_REVERSE,
+    METRIC_STRING_FIND,
+    METRIC_STRING_REPLACE,
+    METRIC_STRING_SPLIT,
+    METRIC_STRING_TRANSFORM_BATCH,
+    METRIC_STRING_ENCODE,
+    METRIC_STRING_DECODE,
+    /* file_ops，同时记录延迟直方图，必须从METRIC_FIRST_FILE_OP开始连续排列 */
+    METRIC_READ_FILE,
+    METRIC_WRITE_FILE,
+    METRIC_APPEND_FILE,
+    METRIC_FILE_EXISTS,
+    METRIC_GET_FILE_SIZE,
+    METRIC_COPY_FILE,
+    METRIC_MOVE_FILE,
+    METRIC_DELETE_FILE,
+    METRIC_FUNCTION_COUNT
+} metric_function;
+
+#define METRIC_FIRST_FILE_OP METRIC_READ_FILE
+#define METRIC_FILE_OP_COUNT (METRIC_FUNCTION_COUNT - METRIC_FIRST_FILE_OP)
+
+/**
+ * @brief 记录一次函数调用
+ * @param function 被调用的函数
+ */
+void metrics_count_call(metric_function function);
+
+/**
+ * @brief 记录一次错误，由error_log调用
+ * @param code 错误代码
+ */
+void metrics_count_error(int code);
+
+/**
+ * @brief 获取单调时钟的当前时间，用于计算延迟
+ * @return 纳秒
+ */
+uint64_t metrics_now_ns();
+
+/**
+ * @brief 记录一次文件操作的调用及其延迟
+ * @param function 文件操作函数（METRIC_READ_FILE到METRIC_DELETE_FILE）
+ * @param start_ns 开始时间（metrics_now_ns的返回值）
+ */
+void metrics_record_latency(metric_function function, uint64_t start_ns);
+
+/**
+ * @brief 启用或禁用指标采集（默认启用），禁用后记录函数立即返回
+ * @param enabled 非0表示启用
+ */
+void metrics_set_enabled(int enabled);
+
+/**
+ * @brief 获取函数的累计调用次数（合并所有线程）
+ * @param function 函数
+ * @return 调用次数
+ */
+unsigned long long metrics_get_calls(metric_function function);
+
+/**
+ * @brief 获取错误代码的累计次数（合并所有线程）
+ * @param code 错误代码
+ * @return 出现次数
+ */
+unsigned long long metrics_get_errors(int code);
+
+/**
+ * @brief 根据延迟直方图估算文件操作延迟的分位数
+ * @param function 文件操作函数
+ * @param quantile 分位数，取值0到1
+ * @return 延迟（纳秒），没有样本时返回0
+ */
+uint64_t metrics_latency_quantile(metric_function function, double quantile);
+
+/**
+ * @brief 获取函数名
+ * @param function 函数
+ * @return 函数名字符串
+ */
+const char* metrics_function_name(metric_function function);
+
+/**
+ * @brief 以Prometheus文本格式导出所有指标
+ * @return 指标文本，用mem_free释放
+ */
+char* metrics_dump_prometheus();
+
+/**
+ * @brief 以Prometheus文本格式将所有指标写入文件
+ * @param filename 文件名，NULL表示写到标准输出
+ * @return 成功返回1，失败返回0
+ */
+int metrics_write_prometheus(const char* filename);
+
+/**
+ * @brief 初始化指标库
+ * @return 成功返回1，失败返回0
+ */
+int initialize_metrics();
+
+#endif /* METRICS_H */
\ No newline at end of file
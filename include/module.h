@@ -0,0 +1,88 @@
+/**
+ * @file module.h
+ * @brief 模块注册表：声明模块间的依赖，按需初始化并记录初始化耗时
+ *
+ * 各模块的initialize_*函数通过module_init_once执行自身的初始化：先按注册表初始化依赖模块，
+ * 再在该模块的锁内执行一次初始化函数。已初始化的模块再次调用只有一次原子读取，不输出日志。
+ * 程序只初始化实际用到的模块，未用到的模块不产生任何开销。
+ */
+#ifndef MODULE_H
+#define MODULE_H
+
+#include <stdint.h>
+
+/**
+ * @brief 注册的模块
+ */
+typedef enum {
+    MODULE_UTILS = 0,
+    MODULE_METRICS,
+    MODULE_THREAD_POOL,
+    MODULE_MATH,
+    MODULE_STRING,
+    MODULE_FILE,
+    MODULE_DIR,
+    MODULE_HASH,
+    MODULE_COMPRESS,
+    MODULE_NUMBER,
+    MODULE_COMMAND,
+    MODULE_FINGERPRINT,
+    MODULE_CSV,
+    MODULE_BIGNUM,
+    MODULE_MATRIX,
+    MODULE_ARRAY,
+    MODULE_ROPE,
+    MODULE_PATTERN,
+    MODULE_ALLOCATOR,
+    MODULE_LINE_INDEX,
+    MODULE_COUNT
+} module_id;
+
+/**
+ * @brief 模块自身的初始化函数，调用时依赖模块均已初始化
+ * @return 成功返回1，失败返回0
+ */
+typedef int (*module_init_fn)(void);
+
+/**
+ * @brief 初始化模块（及其依赖），整个进程中只执行一次，可在多个线程中并发调用
+ * @param id 模块
+ * @param init 模块自身的初始化函数
+ * @return 模块已就绪返回1，初始化失败返回0（失败后不会重试）
+ */
+int module_init_once(module_id id, module_init_fn init);
+
+/**
+ * @brief 按模块编号调用对应的initialize_*函数
+ * @param id 模块
+ * @return 成功返回1，失败返回0
+ */
+int module_require(module_id id);
+
+/**
+ * @brief 查询模块是否已经初始化成功
+ * @param id 模块
+ * @return 已就绪返回1，否则返回0
+ */
+int module_is_ready(module_id id);
+
+/**
+ * @brief 获取模块名
+ * @param id 模块
+ * @return 模块名字符串
+ */
+const char* module_name(module_id id);
+
+/**
+ * @brief 获取模块自身初始化函数的耗时（不含依赖模块）
+ * @param id 模块
+ * @return 纳秒，未初始化时返回0
+ */
+uint64_t module_init_time_ns(module_id id);
+
+/**
+ * @brief 按初始化顺序打印各模块的初始化耗时，未用到的模块标记为未初始化
+ */
+void module_print_startup_report();
+
+#endif /* MODULE_H */
\ No newline at end of file
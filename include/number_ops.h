@@ -0,0 +1,117 @@
+/**
+ * @file number_ops.h
+ * @brief 数值解析与格式化接口：带溢出检查的整数解析、Eisel-Lemire浮点解析、
+ *        jeaiii风格的整数格式化、Schubfach最短往返浮点格式化，以及分隔文本的批量解析
+ */
+#ifndef NUMBER_OPS_H
+#define NUMBER_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+/* format_int64/format_uint64所需的缓冲区大小（"-9223372036854775808"加结尾的'\0'） */
+#define NUMBER_INT_BUFFER 21
+/* format_double所需的缓冲区大小 */
+#define NUMBER_DOUBLE_BUFFER 32
+
+/**
+ * @brief 解析十进制整数：可选的'+'或'-'，随后至少一位数字，不跳过空白
+ * @param str 文本，不要求以'\0'结尾
+ * @param len 文本长度
+ * @param value 输出参数，解析出的值
+ * @param consumed 输出参数，可为NULL，使用的字符数（数字之后的字符不属于该数）
+ * @return ERR_OK，或ERR_NUMBER_NULL、ERR_NUMBER_INVALID（没有数字）、ERR_NUMBER_OVERFLOW（超出int64_t范围）
+ */
+error_code parse_int64(const char* str, size_t len, int64_t* value, size_t* consumed);
+
+/**
+ * @brief 把整个字符串解析为int，用于命令行参数等需要报告格式错误的场合（atoi不检查错误）
+ * @param str 以'\0'结尾的字符串，整个字符串必须是一个整数
+ * @param value 输出参数，解析出的值
+ * @return ERR_OK，或ERR_NUMBER_NULL、ERR_NUMBER_INVALID（为空或有多余的字符）、ERR_NUMBER_OVERFLOW（超出int范围）
+ */
+error_code parse_int(const char* str, int* value);
+
+/**
+ * @brief 解析十进制浮点数，结果与strtod按最近偶数舍入的结果相同
+ *
+ * 格式：可选符号，数字与可选的小数部分（至少一位数字），可选的e/E指数；也接受inf、infinity、nan（不区分大小写）。
+ * 有效数字不超过19位时用Clinger快速路径或Eisel-Lemire算法直接得到正确舍入的结果，其余情况交给strtod。
+ *
+ * @param str 文本，不要求以'\0'结尾
+ * @param len 文本长度
+ * @param value 输出参数，解析出的值，超出范围时为±inf或±0
+ * @param consumed 输出参数，可为NULL，使用的字符数
+ * @return ERR_OK，或ERR_NUMBER_NULL、ERR_NUMBER_INVALID
+ */
+error_code parse_double(const char* str, size_t len, double* value, size_t* consumed);
+
+/**
+ * @brief 判断整段文本是否恰好是一个int64_t整数并解析，不记录错误，用于需要推断字段类型的场合
+ * @param str 文本，不要求以'\0'结尾
+ * @param len 文本长度
+ * @param value 输出参数，解析出的值
+ * @return 是返回1，不是整数、有多余字符或超出范围返回0
+ */
+int try_parse_int64(const char* str, size_t len, int64_t* value);
+
+/**
+ * @brief 判断整段文本是否恰好是一个浮点数并解析，不记录错误
+ * @param str 文本，不要求以'\0'结尾
+ * @param len 文本长度
+ * @param value 输出参数，解析出的值
+ * @return 是返回1，否则返回0
+ */
+int try_parse_double(const char* str, size_t len, double* value);
+
+/**
+ * @brief 把整数格式化为十进制，每次乘法取出两位数字，不做除法
+ * @param value 整数
+ * @param buffer 输出缓冲区，至少NUMBER_INT_BUFFER字节，结果以'\0'结尾
+ * @return 写入的字符数（不含'\0'）
+ */
+size_t format_int64(int64_t value, char* buffer);
+
+/**
+ * @brief 把无符号整数格式化为十进制
+ * @param value 整数
+ * @param buffer 输出缓冲区，至少NUMBER_INT_BUFFER字节，结果以'\0'结尾
+ * @return 写入的字符数（不含'\0'）
+ */
+size_t format_uint64(uint64_t value, char* buffer);
+
+/**
+ * @brief 把浮点数格式化为能精确读回的最短十进制表示
+ *
+ * 十进制指数在-5到16之间时用定点表示（如"0.1"、"123.45"、"12345678901234567"），否则用科学计数法（如"1.5e-07"）；
+ * 非有限值输出"inf"、"-inf"、"nan"。结果经parse_double或strtod读回得到同一个值。
+ *
+ * @param value 浮点数
+ * @param buffer 输出缓冲区，至少NUMBER_DOUBLE_BUFFER字节，结果以'\0'结尾
+ * @return 写入的字符数（不含'\0'）
+ */
+size_t format_double(double value, char* buffer);
+
+/**
+ * @brief 把分隔文本中的所有整数解析为数组
+ *
+ * 字段之间以delimiter或换行分隔，字段两侧的空格、制表符（不是分隔符时）和'\r'被忽略，空行被跳过。
+ * 数字串以SSE2每次检查16字节、SWAR每次转换8位数字；大缓冲区在线程池上按字段边界分段并行解析。
+ *
+ * @param buffer 文本，不要求以'\0'结尾
+ * @param len 文本长度
+ * @param delimiter 字段分隔符，如','或'\t'，不能是数字、符号、空格、'\r'或换行
+ * @param values 输出参数，新分配的数组，没有数值时为NULL，用mem_free释放
+ * @param count 输出参数，数值个数
+ * @return ERR_OK，或ERR_NUMBER_NULL、ERR_NUMBER_INVALID（空字段或非数字字段）、ERR_NUMBER_OVERFLOW、ERR_NUMBER_ALLOC
+ */
+error_code parse_int64_list(const char* buffer, size_t len, char delimiter, int64_t** values, size_t* count);
+
+/**
+ * @brief 初始化数值模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_number_ops();
+
+#endif /* NUMBER_OPS_H */
\ No newline at end of file
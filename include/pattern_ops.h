@@ -0,0 +1,110 @@
+/**
+ * @file pattern_ops.h
+ * @brief 模式匹配接口：glob与正则表达式子集编译为NFA，匹配时按需构造并缓存DFA，
+ *        字面前缀用SIMD预筛选；编译后的模式可被多个线程同时使用
+ */
+#ifndef PATTERN_OPS_H
+#define PATTERN_OPS_H
+
+#include <stddef.h>
+#include "error_codes.h"
+
+/* 按glob语法编译（与fnmatch(pattern, name, 0)相同：*、?、[...]、\转义，匹配整个文本） */
+#define PATTERN_GLOB 0x01
+/* 忽略ASCII字母的大小写 */
+#define PATTERN_ICASE 0x02
+
+/**
+ * @brief 编译后的模式，只读，可被多个线程同时用于匹配
+ */
+typedef struct pattern pattern;
+
+/**
+ * @brief 匹配的范围[start, end)
+ */
+typedef struct {
+    size_t start;
+    size_t end;
+} pattern_span;
+
+/**
+ * @brief 逐行过滤的回调
+ * @param line 匹配的行，不含换行符，不以'\0'结尾
+ * @param len 行的字节数
+ * @param ctx 调用者的上下文
+ * @return 继续返回ERR_OK，返回其他值时停止并由pattern_filter_lines返回该值
+ */
+typedef error_code (*pattern_line_fn)(const char* line, size_t len, void* ctx);
+
+/**
+ * @brief 编译模式
+ *
+ * 正则表达式支持：字面字符、.（除换行外的任意字节）、[...]与[^...]（可含范围、[:alpha:]等POSIX类和\转义）、
+ * \d \w \s \D \W \S \n \t与其他字符的转义、^与$（文本开头与结尾）、( )与(?: )分组、|、
+ * *、+、?、{m}、{m,}、{m,n}（连续的量词依次作用，a+?与(a+)?相同）。匹配按字节进行，
+ * 匹配的范围按POSIX的最左最长规则确定。
+ *
+ * @param source 模式文本
+ * @param flags PATTERN_GLOB、PATTERN_ICASE的组合
+ * @param out 输出参数，编译后的模式，用pattern_free释放
+ * @return ERR_OK，或ERR_PATTERN_NULL、ERR_PATTERN_SYNTAX、ERR_PATTERN_TOO_LARGE（展开后过大，或glob超过4096字节）、
+ *         ERR_PATTERN_ALLOC
+ */
+error_code pattern_compile(const char* source, int flags, pattern** out);
+
+/**
+ * @brief 释放模式，之后不能再有线程使用它
+ * @param p 模式，可为NULL
+ */
+void pattern_free(pattern* p);
+
+/**
+ * @brief 判断文本是否匹配：glob要求匹配整个文本，正则表达式只要文本中某处匹配
+ *
+ * 找到第一个匹配即返回，不计算匹配范围。不记录调试信息，适合在循环中调用。
+ *
+ * @param p 模式
+ * @param text 文本，不必以'\0'结尾
+ * @param len 文本字节数
+ * @return 匹配返回1，否则返回0
+ */
+int pattern_match(const pattern* p, const char* text, size_t len);
+
+/**
+ * @brief 在text[from, len)中查找最左最长的匹配（与POSIX regexec的整体匹配相同）
+ *
+ * 先以DFA向前扫描确定一个最左匹配的结尾，再以反向DFA求最左的起点，最后从起点向前求最长的结尾。
+ * from大于0时^不匹配。不记录调试信息，适合在循环中调用。
+ *
+ * @param p 模式
+ * @param text 文本，不必以'\0'结尾
+ * @param len 文本字节数
+ * @param from 查找的起始位置，不大于len
+ * @param span 输出参数，匹配的范围，可为NULL
+ * @return 找到返回1，否则返回0
+ */
+int pattern_search(const pattern* p, const char* text, size_t len, size_t from, pattern_span* span);
+
+/**
+ * @brief 逐行匹配文本（以'\n'分行），对每个匹配的行调用回调
+ *
+ * 模式有字面前缀时先在整个缓冲区中查找前缀，只匹配含候选位置的行。
+ *
+ * @param p 模式，^与$匹配行首与行尾
+ * @param text 文本
+ * @param len 文本字节数
+ * @param fn 回调，可为NULL（只计数）
+ * @param ctx 传给回调的上下文
+ * @param count 输出参数，匹配的行数，可为NULL
+ * @return ERR_OK，回调返回的错误代码，或ERR_PATTERN_NULL
+ */
+error_code pattern_filter_lines(const pattern* p, const char* text, size_t len, pattern_line_fn fn, void* ctx,
+                                size_t* count);
+
+/**
+ * @brief 初始化模式匹配模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_pattern_ops();
+
+#endif /* PATTERN_OPS_H */
\ No newline at end of file
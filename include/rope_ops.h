@@ -0,0 +1,154 @@
+/**
+ * @file rope_ops.h
+ * @brief 文本编辑结构接口：片段表（piece table），片段按文本位置组织为隐式treap，
+ *        插入、删除与拼接为O(log n)，按需展平为连续缓冲区，以writev直接写出各片段
+ */
+#ifndef ROPE_OPS_H
+#define ROPE_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+typedef struct rope_node rope_node;
+typedef struct rope_chunk rope_chunk;
+
+/**
+ * @brief 可编辑的文本
+ *
+ * 文本由若干片段依次组成，每个片段引用某个只读文本块中的一段；插入的文本复制到当前的追加块中，
+ * 紧接在上一次插入之后的插入只延长已有片段。用rope_init初始化后使用，用rope_free释放。
+ * 同一个rope不能被多个线程同时修改；不同的rope可以共享文本块，分别在不同线程中使用。
+ * 编辑与读取函数不记录调试信息，适合在循环中调用。
+ */
+typedef struct {
+    rope_node* root;
+    size_t length;         /* 文本总字节数 */
+    size_t pieces;         /* 片段数 */
+    rope_chunk* tail;      /* 当前追加块，可为NULL */
+    uint64_t seed;         /* 节点优先级的随机数状态 */
+} rope;
+
+/**
+ * @brief 逐片段访问文本的回调
+ * @param data 片段内容，不以'\0'结尾
+ * @param len 片段字节数，大于0
+ * @param ctx 调用者的上下文
+ * @return 继续返回ERR_OK，返回其他值时停止并由rope_for_each_piece返回该值
+ */
+typedef error_code (*rope_piece_fn)(const char* data, size_t len, void* ctx);
+
+/**
+ * @brief 初始化为空文本
+ * @param r 文本
+ */
+void rope_init(rope* r);
+
+/**
+ * @brief 释放文本，不再被引用的文本块随之释放；之后r为空文本
+ * @param r 文本，可为NULL
+ */
+void rope_free(rope* r);
+
+/**
+ * @brief 在pos处插入文本（复制）
+ * @param r 文本
+ * @param pos 插入位置，不大于r->length
+ * @param text 要插入的文本，len为0时可为NULL
+ * @param len 字节数
+ * @return ERR_OK，或ERR_ROPE_NULL、ERR_ROPE_RANGE、ERR_ROPE_ALLOC；失败时r不变
+ */
+error_code rope_insert(rope* r, size_t pos, const char* text, size_t len);
+
+/**
+ * @brief 在末尾追加文本（复制），相当于rope_insert(r, r->length, text, len)
+ * @return ERR_OK，或ERR_ROPE_NULL、ERR_ROPE_ALLOC；失败时r不变
+ */
+error_code rope_append(rope* r, const char* text, size_t len);
+
+/**
+ * @brief 在末尾追加已分配的缓冲区，不复制，之后由r负责释放
+ *
+ * 适合read_file的结果：整个文件成为一个片段，之后的编辑不会复制原文。
+ *
+ * @param r 文本
+ * @param text mem_alloc分配的缓冲区，至少有len + 1字节；失败时也会被释放
+ * @param len 文本字节数
+ * @return ERR_OK，或ERR_ROPE_NULL、ERR_ROPE_ALLOC；失败时r不变
+ */
+error_code rope_append_owned(rope* r, char* text, size_t len);
+
+/**
+ * @brief 删除[pos, pos + len)
+ * @param r 文本
+ * @param pos 起始位置
+ * @param len 字节数，pos + len不大于r->length
+ * @return ERR_OK，或ERR_ROPE_NULL、ERR_ROPE_RANGE、ERR_ROPE_ALLOC；失败时r不变
+ */
+error_code rope_delete(rope* r, size_t pos, size_t len);
+
+/**
+ * @brief 把src拼接到dst末尾，不复制文本；之后src为空文本
+ * @param dst 目标
+ * @param src 源，不能与dst相同
+ * @return ERR_OK，或ERR_ROPE_NULL、ERR_ROPE_ALIAS
+ */
+error_code rope_concat(rope* dst, rope* src);
+
+/**
+ * @brief 复制[pos, pos + len)到out，不追加'\0'
+ * @param r 文本
+ * @param pos 起始位置
+ * @param len 字节数，pos + len不大于r->length
+ * @param out 至少len字节的缓冲区
+ * @return ERR_OK，或ERR_ROPE_NULL、ERR_ROPE_RANGE
+ */
+error_code rope_extract(const rope* r, size_t pos, size_t len, char* out);
+
+/**
+ * @brief 展平为以'\0'结尾的连续缓冲区
+ *
+ * 有多个片段时把全部文本复制到一个新块中，之后r只有一个片段；只有一个片段且其后还能写入'\0'时
+ * （如rope_append_owned的缓冲区）不复制。
+ *
+ * @param r 文本
+ * @param text 输出参数，文本内容，在r下一次被修改或释放前有效
+ * @return ERR_OK，或ERR_ROPE_NULL、ERR_ROPE_ALLOC
+ */
+error_code rope_flatten(rope* r, const char** text);
+
+/**
+ * @brief 按顺序访问各片段
+ * @param r 文本
+ * @param fn 回调
+ * @param ctx 传给回调的上下文
+ * @return ERR_OK，回调返回的错误代码，或ERR_ROPE_NULL
+ */
+error_code rope_for_each_piece(const rope* r, rope_piece_fn fn, void* ctx);
+
+/**
+ * @brief 写入文件描述符，以writev一次提交多个片段，不展平
+ *
+ * 长片段直接从所在的文本块写出，相邻的短片段先合并到64KB的暂存区再写出。
+ *
+ * @param r 文本
+ * @param fd 文件描述符
+ * @return ERR_OK，或ERR_ROPE_NULL、ERR_ROPE_ALLOC、ERR_ROPE_WRITE
+ */
+error_code rope_write_fd(const rope* r, int fd);
+
+/**
+ * @brief 写入文件（覆盖），与write_file相同但不展平
+ * @param r 文本
+ * @param filename 文件名
+ * @return ERR_OK，或ERR_ROPE_NULL、ERR_ROPE_OPEN、ERR_ROPE_ALLOC、ERR_ROPE_WRITE
+ */
+error_code rope_write_file(const rope* r, const char* filename);
+
+/**
+ * @brief 初始化文本编辑模块
+ * @return 成功返回1，失败返回0
+ */
+int initialize_rope_ops();
+
+#endif /* ROPE_OPS_H */
\ No newline at end of file
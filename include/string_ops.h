@@ -5,10 +5,49 @@
 #ifndef STRING_OPS_H
 #define STRING_OPS_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "error_codes.h"
+
+/**
+ * @brief 编码方式
+ */
+typedef enum {
+    STRING_BASE64 = 0,       /* RFC 4648 base64，编码时补'='，解码时要求补齐 */
+    STRING_BASE64_URL,       /* URL安全的base64（'-'、'_'），编码时不补'='，解码时可有可无 */
+    STRING_HEX,              /* 十六进制，编码输出小写，解码大小写都接受 */
+    STRING_PERCENT           /* 百分号编码，只保留RFC 3986的非保留字符，编码输出大写十六进制 */
+} string_encoding;
+
+/* string_encode_final、string_decode_final最多输出的字节数 */
+#define STRING_CODEC_FINAL_BYTES 4
+
+/**
+ * @brief 流式编码或解码的状态，由string_codec_init初始化，一个状态只用于一个方向
+ */
+typedef struct {
+    string_encoding encoding;
+    int direction;           /* 0：未使用，1：编码，2：解码 */
+    int failed;              /* 遇到过无效输入，之后的调用都失败 */
+    int padding;             /* base64解码：当前四字符组中'='的个数 */
+    int finished;            /* base64解码：已读到补齐的四字符组，之后不能再有字符 */
+    size_t pending_len;
+    uint8_t pending[4];      /* 上一次调用剩下的不完整的一组 */
+    uint64_t position;       /* 已读取的输入字节数 */
+    uint64_t error_offset;   /* 第一个无效字节在整个输入中的位置（解码结尾不完整时为输入长度） */
+} string_codec;
+
+/**
+ * @brief 字符串转换函数，如string_to_upper
+ * @param str 源字符串
+ * @return 转换后的新字符串，用mem_free释放
+ */
+typedef char* (*string_transform_fn)(const char* str);
+
 /**
  * @brief 复制字符串
  * @param source 源字符串
- * @return 新分配的字符串副本，调用者负责释放内存
+ * @return 新分配的字符串副本，用mem_free释放
  */
 char* string_duplicate(const char* source);
 
@@ -16,28 +55,28 @@ char* string_duplicate(const char* source);
  * @brief 连接两个字符串
  * @param str1 第一个字符串
  * @param str2 第二个字符串
- * @return 连接后的新字符串，调用者负责释放内存
+ * @return 连接后的新字符串，用mem_free释放
  */
 char* string_concatenate(const char* str1, const char* str2);
 
 /**
  * @brief 将字符串转换为大写
  * @param str 源字符串
- * @return 转换后的新字符串，调用者负责释放内存
+ * @return 转换后的新字符串，用mem_free释放
  */
 char* string_to_upper(const char* str);
 
 /**
  * @brief 将字符串转换为小写
  * @param str 源字符串
- * @return 转换后的新字符串，调用者负责释放内存
+ * @return 转换后的新字符串，用mem_free释放
  */
 char* string_to_lower(const char* str);
 
 /**
  * @brief 翻转字符串
  * @param str 源字符串
- * @return 翻转后的新字符串，调用者负责释放内存
+ * @return 翻转后的新字符串，用mem_free释放
  */
 char* string_reverse(const char* str);
 
@@ -52,21 +91,234 @@ int string_find(const char* str, const char* substr);
 /**
  * @brief 替换字符串中的子字符串
  * @param str 源字符串
- * @param old_substr 要替换的子字符串
+ * @param old_substr 要替换的子字符串，为空字符串时不替换
  * @param new_substr 替换的新子字符串
- * @return 替换后的新字符串，调用者负责释放内存
+ * @return 替换后的新字符串，用mem_free释放
  */
 char* string_replace(const char* str, const char* old_substr, const char* new_substr);
 
 /**
- * @brief 分割字符串
+ * @brief 分割字符串（可重入），相邻分隔符之间得到空字符串
  * @param str 源字符串
- * @param delimiter 分隔符
+ * @param delimiter 分隔符，按完整字符串匹配
  * @param count 输出参数，返回分割后的部分数量
- * @return 分割后的字符串数组，调用者负责释放内存
+ * @return 分割后的字符串数组，每个元素和数组本身都用mem_free释放
  */
 char** string_split(const char* str, const char* delimiter, int* count);
 
+/**
+ * @brief 使用线程池对一批字符串并行执行同一转换
+ * @param strs 源字符串数组，NULL元素对应的结果为NULL
+ * @param count 字符串个数
+ * @param fn 转换函数，必须是线程安全的
+ * @return 结果数组（与strs一一对应），每个元素和数组本身都用mem_free释放
+ */
+char** string_transform_batch(const char* const* strs, int count, string_transform_fn fn);
+
+/*
+ * 以下为返回错误代码的版本：成功返回ERR_OK并通过输出参数返回结果，
+ * 失败时返回错误代码（同时记为当前线程的最近错误），输出的指针被置为NULL。
+ */
+
+/**
+ * @brief 复制字符串
+ * @param source 源字符串
+ * @param result 输出参数，新分配的字符串副本，用mem_free释放
+ * @return ERR_OK，或ERR_STRING_DUPLICATE_NULL、ERR_STRING_DUPLICATE_ALLOC
+ */
+error_code string_duplicate_checked(const char* source, char** result);
+
+/**
+ * @brief 连接两个字符串
+ * @param str1 第一个字符串
+ * @param str2 第二个字符串
+ * @param result 输出参数，连接后的新字符串，用mem_free释放
+ * @return ERR_OK，或ERR_STRING_CONCATENATE_NULL、ERR_STRING_CONCATENATE_ALLOC
+ */
+error_code string_concatenate_checked(const char* str1, const char* str2, char** result);
+
+/**
+ * @brief 将字符串转换为大写
+ * @param str 源字符串
+ * @param result 输出参数，转换后的新字符串，用mem_free释放
+ * @return ERR_OK，或ERR_STRING_TO_UPPER_NULL、ERR_STRING_DUPLICATE_ALLOC
+ */
+error_code string_to_upper_checked(const char* str, char** result);
+
+/**
+ * @brief 将字符串转换为小写
+ * @param str 源字符串
+ * @param result 输出参数，转换后的新字符串，用mem_free释放
+ * @return ERR_OK，或ERR_STRING_TO_LOWER_NULL、ERR_STRING_DUPLICATE_ALLOC
+ */
+error_code string_to_lower_checked(const char* str, char** result);
+
+/**
+ * @brief 翻转字符串
+ * @param str 源字符串
+ * @param result 输出参数，翻转后的新字符串，用mem_free释放
+ * @return ERR_OK，或ERR_STRING_REVERSE_NULL、ERR_STRING_REVERSE_ALLOC
+ */
+error_code string_reverse_checked(const char* str, char** result);
+
+/**
+ * @brief 查找子字符串
+ * @param str 源字符串
+ * @param substr 要查找的子字符串
+ * @param index 输出参数，子字符串第一次出现的位置，未找到时为-1（不算错误）
+ * @return ERR_OK，或ERR_STRING_FIND_NULL
+ */
+error_code string_find_checked(const char* str, const char* substr, int* index);
+
+/**
+ * @brief 替换字符串中的所有子字符串
+ * @param str 源字符串
+ * @param old_substr 要替换的子字符串，为空字符串时不替换，返回源字符串的副本
+ * @param new_substr 替换成的字符串
+ * @param result 输出参数，替换后的新字符串，用mem_free释放
+ * @return ERR_OK，或ERR_STRING_REPLACE_NULL、ERR_STRING_REPLACE_ALLOC、ERR_STRING_DUPLICATE_ALLOC
+ */
+error_code string_replace_checked(const char* str, const char* old_substr, const char* new_substr,
+                                  char** result);
+
+/**
+ * @brief 按分隔符分割字符串
+ * @param str 源字符串
+ * @param delimiter 分隔符
+ * @param parts 输出参数，分割后的字符串数组，每个元素和数组本身都用mem_free释放
+ * @param count 输出参数，分割后的部分数量，失败时为0
+ * @return ERR_OK，或ERR_STRING_SPLIT_NULL、ERR_STRING_SPLIT_EMPTY_DELIMITER、ERR_STRING_SPLIT_ALLOC
+ */
+error_code string_split_checked(const char* str, const char* delimiter, char*** parts, int* count);
+
+/**
+ * @brief 使用线程池对一批字符串并行执行同一转换
+ * @param strs 源字符串数组，NULL元素对应的结果为NULL
+ * @param count 字符串个数
+ * @param fn 转换函数，必须是线程安全的
+ * @param results 输出参数，结果数组（与strs一一对应），每个元素和数组本身都用mem_free释放
+ * @return ERR_OK，或ERR_STRING_BATCH_INVALID、ERR_STRING_BATCH_ALLOC
+ */
+error_code string_transform_batch_checked(const char* const* strs, int count, string_transform_fn fn,
+                                          char*** results);
+
+/**
+ * @brief 编码一段字节
+ * @param encoding 编码方式
+ * @param data 数据，可含'\0'
+ * @param len 数据的字节数
+ * @return 以'\0'结尾的编码结果，失败返回NULL，用mem_free释放
+ */
+char* string_encode(string_encoding encoding, const void* data, size_t len);
+
+/**
+ * @brief 解码一段文本
+ * @param encoding 编码方式
+ * @param text 文本，不必以'\0'结尾
+ * @param len 文本的字节数
+ * @param result_len 输出参数，解码出的字节数，可为NULL
+ * @return 解码出的字节（后跟一个'\0'），输入无效或失败返回NULL，用mem_free释放
+ */
+char* string_decode(string_encoding encoding, const char* text, size_t len, size_t* result_len);
+
+/**
+ * @brief 编码一段字节，按CPU选择AVX2、SSSE3或标量实现，大输入分段并行
+ * @param encoding 编码方式
+ * @param data 数据
+ * @param len 数据的字节数
+ * @param result 输出参数，以'\0'结尾的编码结果，用mem_free释放
+ * @param result_len 输出参数，编码结果的字节数，可为NULL
+ * @return ERR_OK，或ERR_STRING_CODEC_INVALID、ERR_STRING_CODEC_ALLOC
+ */
+error_code string_encode_checked(string_encoding encoding, const void* data, size_t len, char** result,
+                                 size_t* result_len);
+
+/**
+ * @brief 解码一段文本，在解码的同时检查输入，不单独扫描一遍
+ *
+ * base64拒绝空白、多余的'='、'='之后的字符以及最后一组中不为0的多余位；
+ * 百分号编码只检查'%'之后是否为两个十六进制数字，其他字节原样输出（'+'不解码为空格）。
+ *
+ * @param encoding 编码方式
+ * @param text 文本
+ * @param len 文本的字节数
+ * @param result 输出参数，解码出的字节（后跟一个'\0'），用mem_free释放
+ * @param result_len 输出参数，解码出的字节数；返回ERR_STRING_DECODE_INVALID时为第一个无效字节的位置，可为NULL
+ * @return ERR_OK，或ERR_STRING_CODEC_INVALID、ERR_STRING_CODEC_ALLOC、ERR_STRING_DECODE_INVALID
+ */
+error_code string_decode_checked(string_encoding encoding, const char* text, size_t len, char** result,
+                                 size_t* result_len);
+
+/**
+ * @brief 编码len字节时一次string_encode_update最多输出的字节数（包括上次剩下的字节）
+ * @param encoding 编码方式
+ * @param len 输入的字节数
+ * @return 输出缓冲区需要的字节数
+ */
+size_t string_encode_bound(string_encoding encoding, size_t len);
+
+/**
+ * @brief 解码len字节时一次string_decode_update最多写入的字节数（包括上次剩下的字节）
+ * @param encoding 编码方式
+ * @param len 输入的字节数
+ * @return 输出缓冲区需要的字节数
+ */
+size_t string_decode_bound(string_encoding encoding, size_t len);
+
+/**
+ * @brief 初始化流式编码或解码的状态
+ * @param codec 状态
+ * @param encoding 编码方式
+ */
+void string_codec_init(string_codec* codec, string_encoding encoding);
+
+/**
+ * @brief 编码一段输入，不完整的一组留到下一次调用或string_encode_final
+ *
+ * 不记录调试信息，适合在读取文件的循环中调用。
+ *
+ * @param codec 状态
+ * @param data 数据
+ * @param len 数据的字节数
+ * @param out 输出缓冲区，至少string_encode_bound(encoding, len)字节，不以'\0'结尾
+ * @param out_len 输出参数，写入的字节数
+ * @return ERR_OK，或ERR_STRING_CODEC_INVALID（参数为NULL或状态已用于解码）
+ */
+error_code string_encode_update(string_codec* codec, const void* data, size_t len, char* out, size_t* out_len);
+
+/**
+ * @brief 输出剩下的不完整的一组（base64补'='）
+ * @param codec 状态
+ * @param out 输出缓冲区，至少STRING_CODEC_FINAL_BYTES字节
+ * @param out_len 输出参数，写入的字节数
+ * @return ERR_OK，或ERR_STRING_CODEC_INVALID
+ */
+error_code string_encode_final(string_codec* codec, char* out, size_t* out_len);
+
+/**
+ * @brief 解码一段输入，不完整的一组留到下一次调用或string_decode_final
+ *
+ * 不记录调试信息，适合在读取文件的循环中调用。输入无效时out_len为无效字节之前解码出的字节数，
+ * codec->error_offset为无效字节在整个输入中的位置。
+ *
+ * @param codec 状态
+ * @param text 文本
+ * @param len 文本的字节数
+ * @param out 输出缓冲区，至少string_decode_bound(encoding, len)字节
+ * @param out_len 输出参数，写入的字节数
+ * @return ERR_OK，或ERR_STRING_CODEC_INVALID、ERR_STRING_DECODE_INVALID
+ */
+error_code string_decode_update(string_codec* codec, const char* text, size_t len, void* out, size_t* out_len);
+
+/**
+ * @brief 结束解码，检查输入在完整的一组处结束（URL安全的base64可以省略'='）
+ * @param codec 状态
+ * @param out 输出缓冲区，至少STRING_CODEC_FINAL_BYTES字节
+ * @param out_len 输出参数，写入的字节数
+ * @return ERR_OK，或ERR_STRING_CODEC_INVALID、ERR_STRING_DECODE_INVALID
+ */
+error_code string_decode_final(string_codec* codec, void* out, size_t* out_len);
+
 /**
  * @brief 初始化字符串操作库
  * @return 成功返回1，失败返回0
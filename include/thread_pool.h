@@ -0,0 +1,160 @@
+/**
+ * @file thread_pool.h
+ * @brief 工作窃取线程池接口，供各模块共享
+ */
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+typedef struct thread_pool thread_pool;
+typedef struct task_future task_future;
+
+/**
+ * @brief 任务函数
+ * @param arg 任务参数
+ */
+typedef void (*task_fn)(void* arg);
+
+/**
+ * @brief 带返回值的任务函数，用于task_future
+ * @param arg 任务参数
+ * @return 任务结果
+ */
+typedef void* (*future_fn)(void* arg);
+
+/**
+ * @brief parallel_for的区间处理函数，处理[begin, end)
+ * @param begin 起始下标
+ * @param end 结束下标（不含）
+ * @param ctx 用户上下文
+ */
+typedef void (*range_fn)(long begin, long end, void* ctx);
+
+/**
+ * @brief 线程池选项
+ */
+typedef struct {
+    int num_threads;   /* 工作线程数，0表示使用在线CPU数 */
+    int pin_threads;   /* 非0时把第i个工作线程绑定到第(cpu_offset + i)个可用CPU */
+    int cpu_offset;    /* 绑定CPU时的起始偏移 */
+} thread_pool_options;
+
+/**
+ * @brief 等待组，用于等待一批任务完成
+ */
+typedef struct {
+    atomic_long count;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} wait_group;
+
+/**
+ * @brief 创建线程池
+ * @param options 选项，可为NULL
+ * @return 线程池，失败返回NULL
+ */
+thread_pool* thread_pool_create(const thread_pool_options* options);
+
+/**
+ * @brief 等待已提交的任务全部执行完毕后销毁线程池
+ * @param pool 线程池
+ */
+void thread_pool_destroy(thread_pool* pool);
+
+/**
+ * @brief 获取进程共享的默认线程池（首次调用时创建，线程数为在线CPU数）
+ * @return 默认线程池，创建失败返回NULL
+ */
+thread_pool* thread_pool_default();
+
+/**
+ * @brief 销毁默认线程池，之后再调用thread_pool_default()不会重新创建
+ */
+void thread_pool_shutdown_default();
+
+/**
+ * @brief 获取线程池的工作线程数
+ * @param pool 线程池，NULL表示默认线程池
+ * @return 工作线程数
+ */
+int thread_pool_size(thread_pool* pool);
+
+/**
+ * @brief 提交任务；在工作线程内提交时放入本线程的队列，其余线程可以窃取
+ * @param pool 线程池，NULL表示默认线程池
+ * @param fn 任务函数
+ * @param arg 任务参数
+ * @param wg 任务完成时通知的等待组，可为NULL
+ * @return 成功返回1，失败返回0
+ */
+int thread_pool_submit(thread_pool* pool, task_fn fn, void* arg, wait_group* wg);
+
+/**
+ * @brief 等待等待组归零；等待期间当前线程会帮助执行队列中的任务，可在任务内部嵌套调用
+ * @param pool 线程池，NULL表示默认线程池
+ * @param wg 等待组
+ */
+void thread_pool_wait(thread_pool* pool, wait_group* wg);
+
+/**
+ * @brief 并行处理区间[begin, end)，按grain大小切块，调用线程同样参与计算
+ * @param pool 线程池，NULL表示默认线程池
+ * @param begin 起始下标
+ * @param end 结束下标（不含）
+ * @param grain 每块的大小，小于等于0时自动选择
+ * @param fn 区间处理函数，会被多个线程并发调用
+ * @param ctx 用户上下文
+ * @return 成功返回1，失败返回0（线程池不可用时会在当前线程串行完成）
+ */
+int parallel_for(thread_pool* pool, long begin, long end, long grain, range_fn fn, void* ctx);
+
+/**
+ * @brief 异步执行带返回值的任务
+ * @param pool 线程池，NULL表示默认线程池
+ * @param fn 任务函数
+ * @param arg 任务参数
+ * @return future，失败返回NULL
+ */
+task_future* thread_pool_async(thread_pool* pool, future_fn fn, void* arg);
+
+/**
+ * @brief 等待任务完成并取得结果，同时释放future
+ * @param future future
+ * @return 任务结果
+ */
+void* task_future_get(task_future* future);
+
+/**
+ * @brief 初始化等待组
+ * @param wg 等待组
+ */
+void wait_group_init(wait_group* wg);
+
+/**
+ * @brief 增加等待组计数
+ * @param wg 等待组
+ * @param n 增加的数量
+ */
+void wait_group_add(wait_group* wg, long n);
+
+/**
+ * @brief 等待组计数减一，归零时唤醒等待者
+ * @param wg 等待组
+ */
+void wait_group_done(wait_group* wg);
+
+/**
+ * @brief 销毁等待组
+ * @param wg 等待组
+ */
+void wait_group_destroy(wait_group* wg);
+
+/**
+ * @brief 初始化线程池库（默认线程池在首次使用时创建）
+ * @return 成功返回1，失败返回0
+ */
+int initialize_thread_pool();
+
+#endif /* THREAD_POOL_H */
\ No newline at end of file
@@ -5,6 +5,12 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include "error_codes.h"
+
+/* 日志输出标志，见set_log_flags */
+#define LOG_DEBUG 0x1   /* 输出debug_print的调试信息 */
+#define LOG_ERROR 0x2   /* 输出error_log的错误信息 */
+
 /**
  * @brief 打印调试信息
  * @param message 调试消息
@@ -12,15 +18,66 @@
 void debug_print(const char* message);
 
 /**
- * @brief 打印错误信息
- * @param error_code 错误代码
- * @param message 错误消息
+ * @brief 记录错误：保存为当前线程的最近错误，并在启用LOG_ERROR时打印
+ *
+ * 只保存消息指针，不复制也不格式化，未启用LOG_ERROR时开销只有几次赋值。
+ *
+ * @param code 错误代码
+ * @param message 错误消息，必须是字符串常量等在程序运行期间一直有效的字符串
+ */
+void error_log(error_code code, const char* message);
+
+/**
+ * @brief 记录带附加信息（如文件名）的错误
+ *
+ * 附加信息只在启用LOG_ERROR时拼接到输出中，调用者不需要事先用snprintf格式化。
+ *
+ * @param code 错误代码
+ * @param message 错误消息，要求同error_log
+ * @param detail 附加信息，可为NULL，只在本次调用期间使用
+ */
+void error_log_detail(error_code code, const char* message, const char* detail);
+
+/**
+ * @brief 记录错误并返回错误代码，便于在返回error_code的函数中写成return error_raise(...)
+ * @param code 错误代码
+ * @param message 错误消息，要求同error_log
+ * @return code
+ */
+error_code error_raise(error_code code, const char* message);
+
+/**
+ * @brief 获取当前线程最近一次记录的错误代码
+ * @return 错误代码，没有错误时返回ERR_OK
+ */
+error_code get_last_error();
+
+/**
+ * @brief 获取当前线程最近一次记录的错误消息
+ * @return 错误消息（不含附加信息），没有错误时为空字符串
+ */
+const char* get_last_error_message();
+
+/**
+ * @brief 清除当前线程的最近错误
+ */
+void clear_last_error();
+
+/**
+ * @brief 设置日志输出标志，可在任意线程中调用
+ * @param flags LOG_DEBUG与LOG_ERROR的组合，0表示关闭所有输出
+ */
+void set_log_flags(int flags);
+
+/**
+ * @brief 获取当前的日志输出标志
+ * @return LOG_DEBUG与LOG_ERROR的组合
  */
-void error_log(int error_code, const char* message);
+int get_log_flags();
 
 /**
  * @brief 获取当前时间戳
- * @return 返回当前时间戳字符串
+ * @return 返回当前时间戳字符串，用mem_free释放
  */
 char* get_timestamp();
 
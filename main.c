@@ -5,10 +5,29 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
 #include "include/utils.h"
 #include "include/math_ops.h"
 #include "include/string_ops.h"
 #include "include/file_ops.h"
+#include "include/dir_ops.h"
+#include "include/hash_ops.h"
+#include "include/compress_ops.h"
+#include "include/thread_pool.h"
+#include "include/metrics.h"
+#include "include/command.h"
+#include "include/fingerprint_ops.h"
+#include "include/number_ops.h"
+#include "include/csv_ops.h"
+#include "include/bignum_ops.h"
+#include "include/matrix_ops.h"
+#include "include/array_ops.h"
+#include "include/pattern_ops.h"
+#include "include/allocator.h"
+#include "include/line_index.h"
+#include "include/module.h"
 
 // 测试函数前向声明
 void test_math_functions();
@@ -19,6 +38,66 @@ void cleanup_memory(void** resources, int count);
 int process_command_line(int argc, char** argv);
 void show_help();
 void print_calculation_result(const char* operation, int result);
+void print_dir_progress(const dir_progress* progress);
+int run_stress_test(int max_threads, int iterations);
+int run_workload(int rounds);
+int print_similarity(const char* file1, const char* file2);
+int print_prime_count(const char* lo_text, const char* hi_text);
+int print_factorizations(int count, char** texts);
+int print_factorial(const char* text);
+int print_int_list_summary(const char* filename, char delimiter);
+int print_percentiles(const char* filename, char delimiter);
+int print_csv_summary(const char* filename, char delimiter);
+error_code print_matching_line(const char* line, size_t len, void* ctx);
+int print_matching_lines(const char* source, const char* filename);
+int print_matmul(const char* text);
+int print_lines(const char* filename, const char* first_text, const char* count_text);
+int transcode_file(const char* format, const char* input, const char* output, int decode);
+int parse_int_argument(const char* text, int* value);
+void run_default_tests();
+int require_modules(unsigned int modules);
+int require_option_modules(const char* option);
+
+#define MODULE_BIT(id) (1u << (id))
+#define ALL_MODULES ((1u << MODULE_COUNT) - 1)
+/* 默认测试用到的模块 */
+#define DEFAULT_TEST_MODULES (MODULE_BIT(MODULE_MATH) | MODULE_BIT(MODULE_STRING) | \
+                              MODULE_BIT(MODULE_FILE) | MODULE_BIT(MODULE_HASH))
+
+/* 各命令行选项用到的模块，依赖的模块由模块注册表自动初始化 */
+static const struct {
+    const char* option;
+    unsigned int modules;
+} option_modules[] = {
+    {"--math", MODULE_BIT(MODULE_MATH)},
+    {"--string", MODULE_BIT(MODULE_STRING)},
+    {"--file", MODULE_BIT(MODULE_FILE) | MODULE_BIT(MODULE_HASH)},
+    {"--add", MODULE_BIT(MODULE_MATH) | MODULE_BIT(MODULE_NUMBER)},
+    {"--factorial", MODULE_BIT(MODULE_BIGNUM) | MODULE_BIT(MODULE_NUMBER)},
+    {"--count-primes", MODULE_BIT(MODULE_MATH) | MODULE_BIT(MODULE_NUMBER)},
+    {"--factorize", MODULE_BIT(MODULE_MATH) | MODULE_BIT(MODULE_NUMBER)},
+    {"--hash", MODULE_BIT(MODULE_HASH)},
+    {"--compare", MODULE_BIT(MODULE_HASH)},
+    {"--similarity", MODULE_BIT(MODULE_FILE) | MODULE_BIT(MODULE_FINGERPRINT)},
+    {"--parse-ints", MODULE_BIT(MODULE_FILE) | MODULE_BIT(MODULE_NUMBER)},
+    {"--csv", MODULE_BIT(MODULE_FILE) | MODULE_BIT(MODULE_CSV)},
+    {"--grep", MODULE_BIT(MODULE_FILE) | MODULE_BIT(MODULE_PATTERN)},
+    {"--percentiles", MODULE_BIT(MODULE_FILE) | MODULE_BIT(MODULE_NUMBER) | MODULE_BIT(MODULE_ARRAY)},
+    {"--line", MODULE_BIT(MODULE_LINE_INDEX)},
+    {"--encode", MODULE_BIT(MODULE_STRING)},
+    {"--decode", MODULE_BIT(MODULE_STRING)},
+    {"--matmul", MODULE_BIT(MODULE_MATRIX) | MODULE_BIT(MODULE_NUMBER)},
+    {"--compress", MODULE_BIT(MODULE_COMPRESS) | MODULE_BIT(MODULE_NUMBER)},
+    {"--decompress", MODULE_BIT(MODULE_COMPRESS)},
+    {"--batch", MODULE_BIT(MODULE_COMMAND)},
+    {"--serve", MODULE_BIT(MODULE_COMMAND)},
+    {"--stress", ALL_MODULES},
+    {"--workload", MODULE_BIT(MODULE_MATH) | MODULE_BIT(MODULE_STRING) | MODULE_BIT(MODULE_HASH) |
+                   MODULE_BIT(MODULE_COMMAND) | MODULE_BIT(MODULE_NUMBER)},
+    {"--du", MODULE_BIT(MODULE_DIR)},
+    {"--copy-dir", MODULE_BIT(MODULE_DIR)},
+    {"--delete-dir", MODULE_BIT(MODULE_DIR)},
+};
 
 /**
  * @brief 主函数
@@ -27,36 +106,43 @@ void print_calculation_result(const char* operation, int result);
  * @return 程序退出状态码
  */
 int main(int argc, char** argv) {
-    printf("C语言函数调用关系演示\n");
-    printf("wwwwww\n\n");
-    
-    // 初始化各模块
-    if (!initialize_utils()) {
-        fprintf(stderr, "初始化工具库失败\n");
-        return 1;
-    }
-    
-    if (!initialize_math_ops()) {
-        fprintf(stderr, "初始化数学运算库失败\n");
-        return 1;
-    }
-    
-    if (!initialize_string_ops()) {
-        fprintf(stderr, "初始化字符串操作库失败\n");
-        return 1;
+    // 批处理和服务模式的标准输出只包含命令响应，错误通过响应返回，关闭日志输出；
+    // 前面可以有--alloc等与其他选项组合的选项
+    int service_mode = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--batch") == 0 || strcmp(argv[i], "--serve") == 0) {
+            service_mode = 1;
+        }
     }
-    
-    if (!initialize_file_ops()) {
-        fprintf(stderr, "初始化文件操作库失败\n");
-        return 1;
+    if (service_mode) {
+        set_log_flags(0);
+    } else {
+        printf("C语言函数调用关系演示\n");
+        printf("wwwwww\n\n");
     }
     
+    // 模块在用到时才初始化：各选项通过require_modules初始化自己用到的模块
     // 处理命令行参数
     if (argc > 1) {
         return process_command_line(argc, argv);
     }
     
     // 执行默认测试
+    run_default_tests();
+    
+    thread_pool_shutdown_default();
+    printf("\n程序执行完毕\n");
+    return 0;
+}
+
+/**
+ * @brief 依次执行所有测试并生成报告
+ */
+void run_default_tests() {
+    if (!require_modules(DEFAULT_TEST_MODULES)) {
+        return;
+    }
+    
     printf("执行数学函数测试...\n");
     test_math_functions();
     
@@ -69,9 +155,6 @@ int main(int argc, char** argv) {
     // 生成报告
     printf("\n生成测试报告...\n");
     generate_report("test_report.txt");
-    
-    printf("\n程序执行完毕\n");
-    return 0;
 }
 
 /**
@@ -87,6 +170,14 @@ void test_math_functions() {
     print_calculation_result("乘法", multiply(a, b));
     print_calculation_result("除法", divide(a, b));
     
+    // 测试返回错误代码的版本
+    printf("\n错误代码测试:\n");
+    int result;
+    error_code code = divide_checked(a, 0, &result);
+    printf("divide_checked(%d, 0): %s\n", a, error_code_name(code));
+    code = factorial_checked(13, &result);
+    printf("factorial_checked(13): %s\n", error_code_name(code));
+    
     // 测试阶乘
     int n = 5;
     printf("\n阶乘测试:\n");
@@ -118,8 +209,18 @@ void test_math_functions() {
             printf("%d ", primes[i]);
         }
         printf("\n");
-        free(primes);
+        mem_free(primes);
+    }
+    
+    // 大范围时按分块在线程池中并行查找
+    primes = find_primes(1, 1000000, &count);
+    if (primes != NULL) {
+        printf("1到1000000之间的素数个数: %d，最大的素数: %d\n", count, primes[count - 1]);
+        mem_free(primes);
     }
+
+    // 只需要个数时用亚线性的素数计数，不生成素数数组
+    printf("1到10^10之间的素数个数: %llu\n", (unsigned long long)count_primes(1, 10000000000ULL));
 }
 
 /**
@@ -178,9 +279,23 @@ void test_string_functions() {
         printf("字符串分割 '%s':\n", split_str);
         for (int i = 0; i < parts_count; i++) {
             printf("  部分 %d: %s\n", i + 1, parts[i]);
-            free(parts[i]);
+            mem_free(parts[i]);
+        }
+        mem_free(parts);
+    }
+    
+    // 测试批量转换
+    const char* batch[] = {"alpha", "beta", "gamma", "delta"};
+    int batch_count = sizeof(batch) / sizeof(batch[0]);
+    char** batch_upper = string_transform_batch(batch, batch_count, string_to_upper);
+    if (batch_upper != NULL) {
+        printf("批量转换为大写:");
+        for (int i = 0; i < batch_count; i++) {
+            printf(" %s", batch_upper[i] != NULL ? batch_upper[i] : "(null)");
+            mem_free(batch_upper[i]);
         }
-        free(parts);
+        printf("\n");
+        mem_free(batch_upper);
     }
     
     // 清理内存
@@ -209,6 +324,12 @@ void test_file_functions() {
         printf("文件存在: %s\n", test_filename);
     }
     
+    // 探测不存在的文件：直接比较返回的错误代码，不需要解析日志
+    long missing_size;
+    if (get_file_size_checked("missing_file.txt", &missing_size) == ERR_FILE_SIZE_STAT) {
+        printf("文件不存在: missing_file.txt (%s)\n", error_code_name(get_last_error()));
+    }
+    
     // 测试获取文件大小
     long size = get_file_size(test_filename);
     printf("文件大小: %ld 字节\n", size);
@@ -217,7 +338,7 @@ void test_file_functions() {
     char* content = read_file(test_filename);
     if (content != NULL) {
         printf("文件内容:\n%s\n", content);
-        free(content);
+        mem_free(content);
     }
     
     // 测试追加文件
@@ -234,11 +355,26 @@ void test_file_functions() {
         printf("文件复制成功\n");
     }
     
+    // 测试复制结果校验
+    if (files_equal(test_filename, copy_filename) == 1) {
+        printf("复制文件内容一致\n");
+    }
+    
+    // 测试复制时计算摘要
+    unsigned char digest[HASH_MAX_DIGEST_SIZE];
+    if (copy_file_hashed(test_filename, copy_filename, HASH_SHA256, digest)) {
+        char* hex = hash_to_hex(digest, hash_digest_size(HASH_SHA256));
+        if (hex != NULL) {
+            printf("复制文件SHA-256: %s\n", hex);
+            mem_free(hex);
+        }
+    }
+    
     // 测试读取复制的文件
     content = read_file(copy_filename);
     if (content != NULL) {
         printf("复制文件内容:\n%s\n", content);
-        free(content);
+        mem_free(content);
     }
     
     // 测试删除文件
@@ -269,14 +405,14 @@ void generate_report(const char* filename) {
              "所有测试均已成功执行。\n",
              timestamp);
     
-    // 写入报告文件
-    if (write_file(filename, report)) {
+    // 写入报告文件，文件名以.lz4或.zst结尾时自动压缩
+    if (write_file_compressed(filename, report, COMPRESS_AUTO)) {
         printf("测试报告已保存到: %s\n", filename);
     } else {
         printf("无法保存测试报告\n");
     }
     
-    free(timestamp);
+    mem_free(timestamp);
 }
 
 /**
@@ -287,7 +423,7 @@ void generate_report(const char* filename) {
 void cleanup_memory(void** resources, int count) {
     for (int i = 0; i < count; i++) {
         if (resources[i] != NULL) {
-            free(resources[i]);
+            mem_free(resources[i]);
             resources[i] = NULL;
         }
     }
@@ -300,7 +436,71 @@ void cleanup_memory(void** resources, int count) {
  * @return 程序退出状态码
  */
 int process_command_line(int argc, char** argv) {
+    // --stats [FILE]和--startup可以与其他选项组合，先从参数中取出，执行完其余选项后输出；
+    // --alloc MODE和--mem-report同样先取出，在其余选项初始化模块之前生效
+    int stats = 0;
+    int startup = 0;
+    int memory = 0;
+    const char* stats_file = NULL;
+    int kept = 1;
     for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            stats = 1;
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+                stats_file = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--startup") == 0) {
+            startup = 1;
+        } else if (strcmp(argv[i], "--alloc") == 0 && i + 1 < argc) {
+            mem_mode mode;
+            if (!mem_parse_mode(argv[++i], &mode)) {
+                printf("未知的分配方式: %s（可选system、pool、debug）\n", argv[i]);
+                return 1;
+            }
+            mem_set_mode(mode);
+            memory = 1;
+        } else if (strcmp(argv[i], "--mem-report") == 0) {
+            // 进程退出时由分配模块输出统计与未释放的内存
+            mem_set_tracking(1);
+            memory = 1;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    if (memory && !require_modules(MODULE_BIT(MODULE_ALLOCATOR))) {
+        return 1;
+    }
+    if (memory && kept == 1 && !stats && !startup) {
+        run_default_tests();
+        thread_pool_shutdown_default();
+        return 0;
+    }
+    argc = kept;
+    if (stats || startup) {
+        int status = 0;
+        if (kept > 1) {
+            status = process_command_line(kept, argv);
+        } else {
+            run_default_tests();
+        }
+        if (startup) {
+            module_print_startup_report();
+        }
+        if (stats) {
+            if (!require_modules(MODULE_BIT(MODULE_METRICS)) || !metrics_write_prometheus(stats_file)) {
+                return status != 0 ? status : 1;
+            }
+            if (stats_file != NULL) {
+                printf("指标已导出到: %s\n", stats_file);
+            }
+        }
+        return status;
+    }
+    
+    for (int i = 1; i < argc; i++) {
+        if (!require_option_modules(argv[i])) {
+            return 1;
+        }
         if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             show_help();
             return 0;
@@ -314,14 +514,130 @@ int process_command_line(int argc, char** argv) {
             test_file_functions();
             return 0;
         } else if (strcmp(argv[i], "--add") == 0 && i + 2 < argc) {
-            int a = atoi(argv[i + 1]);
-            int b = atoi(argv[i + 2]);
-            printf("%d + %d = %d\n", a, b, add(a, b));
+            int a, b;
+            if (!parse_int_argument(argv[i + 1], &a) || !parse_int_argument(argv[i + 2], &b)) {
+                return 1;
+            }
+            int sum;
+            if (add_checked(a, b, &sum) != ERR_OK) {
+                fprintf(stderr, "计算失败: %s\n", get_last_error_message());
+                return 1;
+            }
+            char result[NUMBER_INT_BUFFER];
+            format_int64(sum, result);
+            printf("%s + %s = %s\n", argv[i + 1], argv[i + 2], result);
             return 0;
         } else if (strcmp(argv[i], "--factorial") == 0 && i + 1 < argc) {
-            int n = atoi(argv[i + 1]);
-            printf("%d! = %d\n", n, factorial(n));
+            return print_factorial(argv[i + 1]) ? 0 : 1;
+        } else if (strcmp(argv[i], "--count-primes") == 0 && i + 2 < argc) {
+            return print_prime_count(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        } else if (strcmp(argv[i], "--factorize") == 0 && i + 1 < argc) {
+            return print_factorizations(argc - i - 1, argv + i + 1) ? 0 : 1;
+        } else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            hash_algorithm algorithm = HASH_SHA256;
+            if (i + 2 < argc && strcmp(argv[i + 2], "crc32c") == 0) {
+                algorithm = HASH_CRC32C;
+            } else if (i + 2 < argc && strcmp(argv[i + 2], "xxh3") == 0) {
+                algorithm = HASH_XXH3;
+            } else if (i + 2 < argc && strcmp(argv[i + 2], "xxh32") == 0) {
+                algorithm = HASH_XXH32;
+            }
+            unsigned char digest[HASH_MAX_DIGEST_SIZE];
+            if (!hash_file(argv[i + 1], algorithm, digest)) {
+                return 1;
+            }
+            char* hex = hash_to_hex(digest, hash_digest_size(algorithm));
+            if (hex == NULL) {
+                return 1;
+            }
+            printf("%s  %s\n", hex, argv[i + 1]);
+            mem_free(hex);
+            return 0;
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+            int equal = files_equal(argv[i + 1], argv[i + 2]);
+            if (equal < 0) {
+                return 2;
+            }
+            printf("%s\n", equal ? "相同" : "不同");
+            return equal ? 0 : 1;
+        } else if (strcmp(argv[i], "--similarity") == 0 && i + 2 < argc) {
+            return print_similarity(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        } else if (strcmp(argv[i], "--parse-ints") == 0 && i + 1 < argc) {
+            return print_int_list_summary(argv[i + 1], i + 2 < argc ? argv[i + 2][0] : ',') ? 0 : 1;
+        } else if (strcmp(argv[i], "--percentiles") == 0 && i + 1 < argc) {
+            return print_percentiles(argv[i + 1], i + 2 < argc ? argv[i + 2][0] : ',') ? 0 : 1;
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            return print_csv_summary(argv[i + 1], i + 2 < argc ? argv[i + 2][0] : ',') ? 0 : 1;
+        } else if (strcmp(argv[i], "--grep") == 0 && i + 2 < argc) {
+            return print_matching_lines(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        } else if (strcmp(argv[i], "--line") == 0 && i + 2 < argc) {
+            return print_lines(argv[i + 1], argv[i + 2], i + 3 < argc ? argv[i + 3] : NULL) ? 0 : 1;
+        } else if (strcmp(argv[i], "--encode") == 0 && i + 3 < argc) {
+            return transcode_file(argv[i + 1], argv[i + 2], argv[i + 3], 0) ? 0 : 1;
+        } else if (strcmp(argv[i], "--decode") == 0 && i + 3 < argc) {
+            return transcode_file(argv[i + 1], argv[i + 2], argv[i + 3], 1) ? 0 : 1;
+        } else if (strcmp(argv[i], "--matmul") == 0 && i + 1 < argc) {
+            return print_matmul(argv[i + 1]) ? 0 : 1;
+        } else if (strcmp(argv[i], "--compress") == 0 && i + 2 < argc) {
+            int level = COMPRESS_DEFAULT_LEVEL;
+            if (i + 3 < argc && !parse_int_argument(argv[i + 3], &level)) {
+                return 1;
+            }
+            return compress_file(argv[i + 1], argv[i + 2], COMPRESS_AUTO, level) ? 0 : 1;
+        } else if (strcmp(argv[i], "--decompress") == 0 && i + 2 < argc) {
+            return decompress_file(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            int ok = command_run_batch_file(i + 1 < argc ? argv[i + 1] : NULL);
+            if (!ok) {
+                fprintf(stderr, "批处理失败: [%d] %s\n", get_last_error(), get_last_error_message());
+            }
+            return ok ? 0 : 1;
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            int ok = command_serve_unix(argv[i + 1]);
+            if (!ok) {
+                fprintf(stderr, "命令服务失败: [%d] %s\n", get_last_error(), get_last_error_message());
+            }
+            return ok ? 0 : 1;
+        } else if (strcmp(argv[i], "--stress") == 0) {
+            int threads = 8;
+            int iterations = 1000;
+            if ((i + 1 < argc && !parse_int_argument(argv[i + 1], &threads)) ||
+                (i + 2 < argc && !parse_int_argument(argv[i + 2], &iterations))) {
+                return 1;
+            }
+            return run_stress_test(threads, iterations) ? 0 : 1;
+        } else if (strcmp(argv[i], "--workload") == 0) {
+            int rounds = 20;
+            if (i + 1 < argc && !parse_int_argument(argv[i + 1], &rounds)) {
+                return 1;
+            }
+            return run_workload(rounds) ? 0 : 1;
+        } else if (strcmp(argv[i], "--du") == 0 && i + 1 < argc) {
+            dir_progress progress;
+            dir_progress_reset(&progress);
+            dir_walk_options options = {0, 0, i + 2 < argc ? argv[i + 2] : NULL, &progress};
+            long long total = dir_total_size(argv[i + 1], &options);
+            if (total < 0) {
+                print_dir_progress(&progress);
+                return 1;
+            }
+            printf("%lld\t%s\n", total, argv[i + 1]);
+            print_dir_progress(&progress);
             return 0;
+        } else if (strcmp(argv[i], "--copy-dir") == 0 && i + 2 < argc) {
+            dir_progress progress;
+            dir_progress_reset(&progress);
+            dir_walk_options options = {0, 0, i + 3 < argc ? argv[i + 3] : NULL, &progress};
+            int ok = dir_copy(argv[i + 1], argv[i + 2], &options);
+            print_dir_progress(&progress);
+            return ok ? 0 : 1;
+        } else if (strcmp(argv[i], "--delete-dir") == 0 && i + 1 < argc) {
+            dir_progress progress;
+            dir_progress_reset(&progress);
+            dir_walk_options options = {0, 0, i + 2 < argc ? argv[i + 2] : NULL, &progress};
+            int ok = dir_delete(argv[i + 1], &options);
+            print_dir_progress(&progress);
+            return ok ? 0 : 1;
         }
     }
     
@@ -329,6 +645,543 @@ int process_command_line(int argc, char** argv) {
     return 1;
 }
 
+/**
+ * @brief 输出两个文件的MinHash相似度估计，文件都不超过64KB时同时输出编辑距离
+ * @param file1 文件名
+ * @param file2 文件名
+ * @return 成功返回1，失败返回0
+ */
+int print_similarity(const char* file1, const char* file2) {
+    char* first = read_file(file1);
+    char* second = read_file(file2);
+    if (first == NULL || second == NULL) {
+        mem_free(first);
+        mem_free(second);
+        return 0;
+    }
+    const void* docs[2] = {first, second};
+    size_t lens[2] = {strlen(first), strlen(second)};
+    uint64_t signatures[2 * 128];
+    int ok = minhash_signatures(docs, lens, 2, 5, 128, signatures) == ERR_OK;
+    if (ok) {
+        printf("相似度(MinHash, 5字节片段): %.3f\n", minhash_similarity(signatures, signatures + 128, 128));
+        if (lens[0] <= 65536 && lens[1] <= 65536) {
+            printf("编辑距离: %ld\n", levenshtein_distance(first, lens[0], second, lens[1]));
+        }
+    }
+    mem_free(first);
+    mem_free(second);
+    return ok;
+}
+
+/**
+ * @brief 解析整数命令行参数，格式错误或超出int范围时输出错误信息
+ * @param text 参数
+ * @param value 输出参数，解析出的值
+ * @return 成功返回1，失败返回0
+ */
+int parse_int_argument(const char* text, int* value) {
+    error_code code = parse_int(text, value);
+    if (code != ERR_OK) {
+        fprintf(stderr, "%s: %s\n", code == ERR_NUMBER_OVERFLOW ? "整数超出范围" : "参数不是整数", text);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 计算区间内的素数个数并输出耗时
+ * @param lo_text 起始值
+ * @param hi_text 结束值
+ * @return 成功返回1，失败返回0
+ */
+int print_prime_count(const char* lo_text, const char* hi_text) {
+    int64_t lo, hi;
+    if (!try_parse_int64(lo_text, strlen(lo_text), &lo) || !try_parse_int64(hi_text, strlen(hi_text), &hi) ||
+        lo < 0 || hi < 0) {
+        fprintf(stderr, "区间端点必须是非负整数: %s %s\n", lo_text, hi_text);
+        return 0;
+    }
+    uint64_t count = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    error_code code = count_primes_checked((uint64_t)lo, (uint64_t)hi, &count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (code != ERR_OK) {
+        fprintf(stderr, "计算失败: [%d] %s\n", code, get_last_error_message());
+        return 0;
+    }
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    char count_text[NUMBER_INT_BUFFER];
+    format_int64((int64_t)count, count_text);
+    printf("[%s, %s]内的素数个数: %s, 耗时: %.3f 秒\n", lo_text, hi_text, count_text, seconds);
+    return 1;
+}
+
+/**
+ * @brief 批量分解整数的素因子并逐行输出
+ * @param count 整数个数
+ * @param texts 整数的文本
+ * @return 成功返回1，失败返回0
+ */
+int print_factorizations(int count, char** texts) {
+    uint64_t* values = (uint64_t*)calloc((size_t)count, sizeof(uint64_t));
+    prime_factors* results = (prime_factors*)malloc((size_t)count * sizeof(prime_factors));
+    int ok = values != NULL && results != NULL;
+    for (int i = 0; ok && i < count; i++) {
+        // 按无符号数解析，允许超过INT64_MAX
+        char* end = NULL;
+        errno = 0;
+        values[i] = strtoull(texts[i], &end, 10);
+        if (texts[i][0] < '0' || texts[i][0] > '9' || *end != '\0' || errno != 0 || values[i] == 0) {
+            fprintf(stderr, "参数不是正整数: %s\n", texts[i]);
+            ok = 0;
+        }
+    }
+    if (ok && factorize_u64_batch(values, (size_t)count, results) != ERR_OK) {
+        fprintf(stderr, "分解失败: %s\n", get_last_error_message());
+        ok = 0;
+    }
+    char text[NUMBER_INT_BUFFER];
+    for (int i = 0; ok && i < count; i++) {
+        format_uint64(values[i], text);
+        printf("%s =", text);
+        for (int j = 0; j < results[i].count; j++) {
+            format_uint64(results[i].primes[j], text);
+            printf(j == 0 ? " %s" : " * %s", text);
+            if (results[i].exponents[j] > 1) {
+                printf("^%d", results[i].exponents[j]);
+            }
+        }
+        printf(results[i].count == 0 ? " 1\n" : "\n");
+    }
+    free(values);
+    free(results);
+    return ok;
+}
+
+/**
+ * @brief 以任意精度计算阶乘并输出全部十进制数字
+ * @param text 非负整数的文本
+ * @return 成功返回1，失败返回0
+ */
+int print_factorial(const char* text) {
+    int n;
+    if (!parse_int_argument(text, &n)) {
+        return 0;
+    }
+    if (n < 0) {
+        fprintf(stderr, "参数不是非负整数: %s\n", text);
+        return 0;
+    }
+    bignum result;
+    bignum_init(&result);
+    char* digits = NULL;
+    int ok = bignum_factorial(&result, (uint32_t)n) == ERR_OK && bignum_to_string(&result, &digits, NULL) == ERR_OK;
+    if (ok) {
+        printf("%s! = %s\n", text, digits);
+    } else {
+        fprintf(stderr, "计算失败: %s\n", get_last_error_message());
+    }
+    mem_free(digits);
+    bignum_free(&result);
+    return ok;
+}
+
+/**
+ * @brief 批量解析文件中的整数并输出个数、最小值、最大值和解析吞吐量
+ * @param filename 文件名
+ * @param delimiter 字段分隔符
+ * @return 成功返回1，失败返回0
+ */
+int print_int_list_summary(const char* filename, char delimiter) {
+    char* content = read_file(filename);
+    if (content == NULL) {
+        return 0;
+    }
+    size_t len = strlen(content);
+    int64_t* values = NULL;
+    size_t count = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    error_code code = parse_int64_list(content, len, delimiter, &values, &count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    mem_free(content);
+    if (code != ERR_OK) {
+        fprintf(stderr, "解析失败: [%d] %s\n", code, get_last_error_message());
+        return 0;
+    }
+    int64_t min = count > 0 ? values[0] : 0;
+    int64_t max = min;
+    for (size_t i = 1; i < count; i++) {
+        min = values[i] < min ? values[i] : min;
+        max = values[i] > max ? values[i] : max;
+    }
+    mem_free(values);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    char min_text[NUMBER_INT_BUFFER], max_text[NUMBER_INT_BUFFER];
+    format_int64(min, min_text);
+    format_int64(max, max_text);
+    printf("数值个数: %zu, 最小值: %s, 最大值: %s, 解析耗时: %.3f 秒 (%.1f MB/s)\n", count, min_text, max_text,
+           seconds, seconds > 0 ? len / seconds / 1e6 : 0.0);
+    return 1;
+}
+
+/**
+ * @brief 解析文件中的整数列表，输出中位数与尾部百分位数（不排序整个数组）和选择耗时
+ * @param filename 文件名
+ * @param delimiter 分隔符
+ * @return 成功返回1，失败返回0
+ */
+int print_percentiles(const char* filename, char delimiter) {
+    char* content = read_file(filename);
+    if (content == NULL) {
+        return 0;
+    }
+    int64_t* values = NULL;
+    size_t count = 0;
+    error_code code = parse_int64_list(content, strlen(content), delimiter, &values, &count);
+    mem_free(content);
+    if (code != ERR_OK) {
+        fprintf(stderr, "解析失败: [%d] %s\n", code, get_last_error_message());
+        return 0;
+    }
+    static const double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+    enum { PERCENTILE_COUNT = sizeof(percentiles) / sizeof(percentiles[0]) };
+    int64_t results[PERCENTILE_COUNT];
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    code = array_percentiles_int64(values, count, percentiles, PERCENTILE_COUNT, results);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    mem_free(values);
+    if (code != ERR_OK) {
+        fprintf(stderr, "计算百分位数失败: [%d] %s\n", code, get_last_error_message());
+        return 0;
+    }
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("数值个数: %zu, 选择耗时: %.3f 秒\n", count, seconds);
+    for (int i = 0; i < PERCENTILE_COUNT; i++) {
+        char text[NUMBER_INT_BUFFER];
+        format_int64(results[i], text);
+        printf("  p%-5g %s\n", percentiles[i], text);
+    }
+    return 1;
+}
+
+/**
+ * @brief 读取CSV文件并输出行数、各列的类型和数值列的统计结果，以及读取吞吐量
+ * @param filename 文件名
+ * @param delimiter 字段分隔符
+ * @return 成功返回1，失败返回0
+ */
+int print_csv_summary(const char* filename, char delimiter) {
+    csv_options options = csv_default_options();
+    options.delimiter = delimiter;
+    csv_table* table = NULL;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    error_code code = csv_read_file(filename, &options, &table);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (code != ERR_OK) {
+        fprintf(stderr, "读取CSV失败: [%d] %s\n", code, get_last_error_message());
+        return 0;
+    }
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    long size = get_file_size(filename);
+    printf("行数: %zu, 列数: %d, 读取耗时: %.3f 秒 (%.1f MB/s)\n", table->row_count, table->column_count,
+           seconds, seconds > 0 && size > 0 ? size / seconds / 1e6 : 0.0);
+    for (int j = 0; j < table->column_count; j++) {
+        csv_stats stats;
+        if (table->columns[j].type != CSV_STRING && csv_column_stats(table, j, &stats) == ERR_OK &&
+            stats.count > 0) {
+            printf("  %-20s %-6s  个数 %zu, 最小值 %g, 最大值 %g, 平均值 %g\n", table->columns[j].name,
+                   csv_type_name(table->columns[j].type), stats.count, stats.min, stats.max, stats.mean);
+        } else {
+            printf("  %-20s %s\n", table->columns[j].name, csv_type_name(table->columns[j].type));
+        }
+    }
+    csv_free_table(table);
+    return 1;
+}
+
+/**
+ * @brief pattern_filter_lines的回调：输出匹配的行
+ * @param line 行，不以'\0'结尾
+ * @param len 行的字节数
+ * @param ctx 未使用
+ * @return ERR_OK
+ */
+error_code print_matching_line(const char* line, size_t len, void* ctx) {
+    (void)ctx;
+    printf("%.*s\n", (int)len, line);
+    return ERR_OK;
+}
+
+/**
+ * @brief 输出文件中匹配正则表达式的行，以及匹配的行数和匹配吞吐量
+ * @param source 正则表达式
+ * @param filename 文件名
+ * @return 有匹配的行返回1，没有匹配或失败返回0
+ */
+int print_matching_lines(const char* source, const char* filename) {
+    pattern* p = NULL;
+    error_code code = pattern_compile(source, 0, &p);
+    if (code != ERR_OK) {
+        fprintf(stderr, "编译模式失败: [%d] %s\n", code, get_last_error_message());
+        return 0;
+    }
+    char* content = read_file(filename);
+    if (content == NULL) {
+        pattern_free(p);
+        return 0;
+    }
+    size_t len = strlen(content);
+    size_t count = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pattern_filter_lines(p, content, len, print_matching_line, NULL, &count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    mem_free(content);
+    pattern_free(p);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("匹配行数: %zu, 耗时: %.3f 秒 (%.1f MB/s)\n", count, seconds, seconds > 0 ? len / seconds / 1e6 : 0.0);
+    return count > 0;
+}
+
+/**
+ * @brief 用行索引输出文件中从第N行起的若干行，以及行数、索引的来源和打开索引的耗时
+ * @param filename 文件名
+ * @param first_text 第一行的行号的文本，从1开始
+ * @param count_text 行数的文本，为NULL时输出1行
+ * @return 成功返回1，失败返回0
+ */
+int print_lines(const char* filename, const char* first_text, const char* count_text) {
+    static const char* source_names[] = {"载入", "扩展", "重建"};
+    int64_t first, count = 1;
+    if (!try_parse_int64(first_text, strlen(first_text), &first) || first < 1 ||
+        (count_text != NULL && (!try_parse_int64(count_text, strlen(count_text), &count) || count < 1))) {
+        fprintf(stderr, "行号和行数必须是正整数\n");
+        return 0;
+    }
+    line_index* index = NULL;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    error_code code = line_index_open(filename, 0, &index);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (code != ERR_OK) {
+        fprintf(stderr, "打开行索引失败: [%d] %s\n", code, get_last_error_message());
+        return 0;
+    }
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    uint64_t lines = line_index_count(index);
+    printf("行数: %llu, 索引: %s, 耗时: %.3f 秒\n", (unsigned long long)lines,
+           source_names[line_index_get_source(index)], seconds);
+    // 超出文件末尾的部分不输出
+    uint64_t available = (uint64_t)(first - 1) < lines ? lines - (uint64_t)(first - 1) : 0;
+    if (available == 0) {
+        fprintf(stderr, "行号超出范围: %lld\n", (long long)first);
+        line_index_close(index);
+        return 0;
+    }
+    char* text = NULL;
+    size_t len = 0;
+    uint64_t wanted = (uint64_t)count < available ? (uint64_t)count : available;
+    code = line_index_read_lines(index, (uint64_t)(first - 1), wanted, &text, &len);
+    line_index_close(index);
+    if (code != ERR_OK) {
+        fprintf(stderr, "读取行失败: [%d] %s\n", code, get_last_error_message());
+        return 0;
+    }
+    fwrite(text, 1, len, stdout);
+    printf("\n");
+    mem_free(text);
+    return 1;
+}
+
+/**
+ * @brief 以1MB为块流式编码或解码文件，输出字节数、耗时与吞吐量
+ * @param format 编码方式的名称：base64、base64url、hex或percent
+ * @param input 输入文件名
+ * @param output 输出文件名
+ * @param decode 为1时解码，为0时编码
+ * @return 成功返回1，失败返回0
+ */
+int transcode_file(const char* format, const char* input, const char* output, int decode) {
+    static const struct {
+        const char* name;
+        string_encoding encoding;
+    } formats[] = {
+        {"base64", STRING_BASE64},
+        {"base64url", STRING_BASE64_URL},
+        {"hex", STRING_HEX},
+        {"percent", STRING_PERCENT},
+    };
+    const size_t block = 1 << 20;
+    size_t f = 0;
+    while (f < sizeof(formats) / sizeof(formats[0]) && strcmp(format, formats[f].name) != 0) {
+        f++;
+    }
+    if (f == sizeof(formats) / sizeof(formats[0])) {
+        fprintf(stderr, "未知的编码方式: %s\n", format);
+        return 0;
+    }
+    string_encoding encoding = formats[f].encoding;
+    FILE* in = fopen(input, "rb");
+    FILE* out = in != NULL ? fopen(output, "wb") : NULL;
+    size_t bound = decode ? string_decode_bound(encoding, block) : string_encode_bound(encoding, block);
+    char* src = (char*)malloc(block);
+    char* dst = (char*)malloc(bound + STRING_CODEC_FINAL_BYTES);
+    if (in == NULL || out == NULL || src == NULL || dst == NULL) {
+        fprintf(stderr, "无法打开文件或分配内存: %s\n", in == NULL ? input : output);
+        if (in != NULL) {
+            fclose(in);
+        }
+        if (out != NULL) {
+            fclose(out);
+        }
+        free(src);
+        free(dst);
+        return 0;
+    }
+    string_codec codec;
+    string_codec_init(&codec, encoding);
+    error_code code = ERR_OK;
+    size_t read_total = 0, written = 0, got, produced = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (code == ERR_OK && (got = fread(src, 1, block, in)) > 0) {
+        code = decode ? string_decode_update(&codec, src, got, dst, &produced)
+                      : string_encode_update(&codec, src, got, dst, &produced);
+        written += fwrite(dst, 1, produced, out);
+        read_total += got;
+    }
+    if (code == ERR_OK) {
+        code = decode ? string_decode_final(&codec, dst, &produced) : string_encode_final(&codec, dst, &produced);
+        written += fwrite(dst, 1, produced, out);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    int failed = ferror(in) || ferror(out);
+    fclose(in);
+    failed |= fclose(out) != 0;
+    free(src);
+    free(dst);
+    if (code != ERR_OK) {
+        fprintf(stderr, "%s失败: [%d] %s，偏移: %llu\n", decode ? "解码" : "编码", code, get_last_error_message(),
+                (unsigned long long)codec.error_offset);
+        return 0;
+    }
+    if (failed) {
+        fprintf(stderr, "读写文件失败\n");
+        return 0;
+    }
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("读取: %zu 字节, 写入: %zu 字节, 耗时: %.3f 秒 (%.1f MB/s)\n", read_total, written, seconds,
+           seconds > 0 ? read_total / seconds / 1e6 : 0.0);
+    return 1;
+}
+
+/**
+ * @brief 对每种元素类型计算一次N阶方阵的乘法，输出耗时、吞吐量和所用的微内核
+ * @param text 阶数的文本
+ * @return 成功返回1，失败返回0
+ */
+int print_matmul(const char* text) {
+    int n;
+    if (!parse_int_argument(text, &n)) {
+        return 0;
+    }
+    if (n <= 0) {
+        fprintf(stderr, "阶数必须是正整数: %s\n", text);
+        return 0;
+    }
+    static const struct {
+        matrix_type type;
+        const char* name;
+    } types[] = {{MATRIX_DOUBLE, "double"}, {MATRIX_INT32, "int32"}, {MATRIX_INT64, "int64"}};
+    int ok = 1;
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]) && ok; t++) {
+        matrix a, b, c;
+        matrix_init(&a);
+        matrix_init(&b);
+        matrix_init(&c);
+        ok = matrix_create(&a, types[t].type, (size_t)n, (size_t)n) == ERR_OK &&
+             matrix_create(&b, types[t].type, (size_t)n, (size_t)n) == ERR_OK;
+        if (ok) {
+            // 对角线为1的矩阵，乘积等于b，便于校验
+            for (int i = 0; i < n; i++) {
+                for (int j = 0; j < n; j++) {
+                    int value = (i * 7 + j * 3) % 11 - 5;
+                    if (types[t].type == MATRIX_DOUBLE) {
+                        MATRIX_AT(&a, double, i, j) = i == j;
+                        MATRIX_AT(&b, double, i, j) = value;
+                    } else if (types[t].type == MATRIX_INT32) {
+                        MATRIX_AT(&a, int32_t, i, j) = i == j;
+                        MATRIX_AT(&b, int32_t, i, j) = value;
+                    } else {
+                        MATRIX_AT(&a, int64_t, i, j) = i == j;
+                        MATRIX_AT(&b, int64_t, i, j) = value;
+                    }
+                }
+            }
+            struct timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            error_code code = matrix_multiply(&c, &a, &b);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            ok = code == ERR_OK;
+            if (ok) {
+                double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+                double ops = 2.0 * n * n * n;
+                size_t last = (size_t)n - 1;
+                int matches = types[t].type == MATRIX_DOUBLE
+                                  ? MATRIX_AT(&c, double, last, last) == MATRIX_AT(&b, double, last, last)
+                                  : types[t].type == MATRIX_INT32
+                                        ? MATRIX_AT(&c, int32_t, last, last) == MATRIX_AT(&b, int32_t, last, last)
+                                        : MATRIX_AT(&c, int64_t, last, last) == MATRIX_AT(&b, int64_t, last, last);
+                printf("%-6s %d阶: 耗时 %.3f 秒, %.2f GFLOPS, 微内核 %s%s\n", types[t].name, n, seconds,
+                       seconds > 0 ? ops / seconds / 1e9 : 0.0, matrix_kernel_name(types[t].type),
+                       matches ? "" : "（结果校验失败）");
+                ok = matches;
+            }
+        }
+        if (!ok) {
+            fprintf(stderr, "计算失败: %s\n", get_last_error_message());
+        }
+        matrix_free(&a);
+        matrix_free(&b);
+        matrix_free(&c);
+    }
+    return ok;
+}
+
+/**
+ * @brief 初始化一组模块（及其依赖）
+ * @param modules MODULE_BIT的组合
+ * @return 全部成功返回1，否则返回0
+ */
+int require_modules(unsigned int modules) {
+    for (int id = 0; id < MODULE_COUNT; id++) {
+        if ((modules & MODULE_BIT(id)) && !module_require((module_id)id)) {
+            fprintf(stderr, "初始化模块%s失败\n", module_name((module_id)id));
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief 初始化命令行选项用到的模块
+ * @param option 命令行选项
+ * @return 成功（或该选项不需要任何模块）返回1，失败返回0
+ */
+int require_option_modules(const char* option) {
+    for (size_t i = 0; i < sizeof(option_modules) / sizeof(option_modules[0]); i++) {
+        if (strcmp(option, option_modules[i].option) == 0) {
+            return require_modules(option_modules[i].modules);
+        }
+    }
+    return 1;
+}
+
 /**
  * @brief 显示帮助信息
  */
@@ -340,7 +1193,33 @@ void show_help() {
     printf("  --string        运行字符串函数测试\n");
     printf("  --file          运行文件函数测试\n");
     printf("  --add X Y       计算X+Y的结果\n");
-    printf("  --factorial N   计算N的阶乘\n");
+    printf("  --factorial N   计算N的阶乘（任意精度）\n");
+    printf("  --count-primes LO HI        计算[LO, HI]内的素数个数（HI不超过10^14）并输出耗时\n");
+    printf("  --factorize N...            分解一个或多个正整数（不超过2^64 - 1）的素因子\n");
+    printf("  --hash FILE [crc32c|xxh32|xxh3|sha256]  计算文件摘要，默认sha256\n");
+    printf("  --compare FILE1 FILE2       比较两个文件内容是否相同\n");
+    printf("  --similarity FILE1 FILE2    估计两个文件内容的相似度（MinHash）与编辑距离\n");
+    printf("  --parse-ints FILE [DELIM]   解析FILE中以DELIM（默认逗号）或换行分隔的整数，输出个数、最小值、最大值和吞吐量\n");
+    printf("  --percentiles FILE [DELIM]  解析FILE中的整数，输出p50、p90、p99、p99.9（最近秩法）与选择耗时\n");
+    printf("  --csv FILE [DELIM]          按列读取CSV文件（第一行为列名），输出各列的类型与统计结果和读取吞吐量\n");
+    printf("  --grep REGEX FILE           输出FILE中匹配正则表达式REGEX的行、匹配的行数和吞吐量\n");
+    printf("  --line FILE N [COUNT]       按行索引（FILE.lidx）输出FILE从第N行起的COUNT行（默认1行），以及行数和索引的来源\n");
+    printf("  --encode FMT IN OUT         以FMT（base64|base64url|hex|percent）流式编码文件IN写到OUT，输出吞吐量\n");
+    printf("  --decode FMT IN OUT         流式解码文件IN写到OUT，输入无效时输出第一个无效字符的偏移\n");
+    printf("  --matmul N                  分别以double、int32、int64计算N阶方阵的乘法，输出耗时与吞吐量\n");
+    printf("  --compress IN OUT [LEVEL]   压缩文件，按OUT的扩展名(.lz4/.zst)选择格式\n");
+    printf("  --decompress IN OUT         解压文件，按文件头识别格式\n");
+    printf("  --du DIR [GLOB]             统计目录中（匹配GLOB的）文件总大小\n");
+    printf("  --copy-dir SRC DST [GLOB]   递归复制目录\n");
+    printf("  --delete-dir DIR [GLOB]     递归删除目录，指定GLOB时只删除匹配的文件\n");
+    printf("  --stress [THREADS] [ITERS]  多线程并发调用各模块并校验结果，输出1到THREADS个线程的吞吐量\n");
+    printf("  --workload [ROUNDS]         运行标准负载（默认20轮）并输出耗时，用于PGO训练与比较构建\n");
+    printf("  --stats [FILE]              执行其余选项（无其他选项时执行默认测试）后以Prometheus格式输出指标\n");
+    printf("  --batch [FILE]              逐行执行FILE（默认标准输入）中的命令，响应写到标准输出\n");
+    printf("  --serve SOCKET              在Unix域套接字上提供同样的命令协议，Ctrl+C停止\n");
+    printf("  --startup                   执行其余选项后输出各模块的初始化耗时\n");
+    printf("  --alloc system|pool|debug   模块返回的字符串与数组改用malloc、线程本地内存池（默认）或带保护页的调试分配\n");
+    printf("  --mem-report                跟踪模块返回的内存，退出时输出未释放的字节数、峰值与未释放的内存\n");
 }
 
 /**
@@ -350,4 +1229,357 @@ void show_help() {
  */
 void print_calculation_result(const char* operation, int result) {
     printf("%s结果: %d\n", operation, result);
+}
+
+/**
+ * @brief 打印目录操作的进度计数
+ * @param progress 进度计数器
+ */
+void print_dir_progress(const dir_progress* progress) {
+    printf("文件: %llu, 目录: %llu, 字节: %llu, 错误: %llu\n",
+           atomic_load(&progress->files), atomic_load(&progress->dirs),
+           atomic_load(&progress->bytes), atomic_load(&progress->errors));
+}
+
+#define STRESS_SHARED_FILE "stress_shared.tmp"
+#define STRESS_RECORD_SIZE 14
+
+/**
+ * @brief 并发压力测试中每个线程的参数和统计
+ */
+typedef struct {
+    int id;
+    int iterations;
+    const pattern* shared_pattern;  /* 所有线程共用的模式，DFA状态在匹配时并发构造 */
+    long calls;
+    long failures;
+} stress_worker;
+
+/**
+ * @brief 记录一次检查的结果
+ * @param worker 线程统计
+ * @param ok 检查是否通过
+ */
+static void stress_check(stress_worker* worker, int ok) {
+    worker->calls++;
+    if (!ok) {
+        worker->failures++;
+    }
+}
+
+/**
+ * @brief 检查结果字符串并释放
+ * @param worker 线程统计
+ * @param result 函数返回的字符串
+ * @param expected 期望的字符串
+ */
+static void stress_check_string(stress_worker* worker, char* result, const char* expected) {
+    stress_check(worker, result != NULL && strcmp(result, expected) == 0);
+    mem_free(result);
+}
+
+/**
+ * @brief 压力测试线程：反复调用字符串、数学和文件函数并校验结果
+ * @param arg stress_worker
+ * @return NULL
+ */
+static void* stress_thread(void* arg) {
+    stress_worker* worker = (stress_worker*)arg;
+    char own_file[64], copy_file_name[64], record[32];
+    snprintf(own_file, sizeof(own_file), "stress_%d.tmp", worker->id);
+    snprintf(copy_file_name, sizeof(copy_file_name), "stress_%d_copy.tmp", worker->id);
+    
+    for (int iter = 0; iter < worker->iterations; iter++) {
+        // 字符串函数
+        stress_check_string(worker, string_concatenate("Hello, ", "World!"), "Hello, World!");
+        stress_check_string(worker, string_to_upper("Hello, World!"), "HELLO, WORLD!");
+        stress_check_string(worker, string_to_lower("Hello, World!"), "hello, world!");
+        stress_check_string(worker, string_reverse("Hello, World!"), "!dlroW ,olleH");
+        stress_check_string(worker, string_replace("a,b,,c", ",", ";"), "a;b;;c");
+        stress_check(worker, string_find("Hello, World!", "World") == 7);
+        
+        int parts_count = 0;
+        char** parts = string_split("one,two,,four", ",", &parts_count);
+        stress_check(worker, parts != NULL && parts_count == 4 && strcmp(parts[1], "two") == 0 &&
+                             parts[2][0] == '\0' && strcmp(parts[3], "four") == 0);
+        for (int i = 0; parts != NULL && i < parts_count; i++) {
+            mem_free(parts[i]);
+        }
+        mem_free(parts);
+        stress_check_string(worker, string_encode(STRING_BASE64, "Hello, World!", 13), "SGVsbG8sIFdvcmxkIQ==");
+        stress_check_string(worker, string_decode(STRING_HEX, "48656c6c6f", 10, NULL), "Hello");
+        
+        // 数学函数
+        int arr[] = {1, 2, 3, 4, 5};
+        stress_check(worker, add(iter, worker->id) == iter + worker->id);
+        stress_check(worker, gcd(48, 18) == 6);
+        stress_check(worker, factorial(10) == 3628800);
+        stress_check(worker, fibonacci(15) == 610);
+        stress_check(worker, average(arr, 5) == 3.0);
+        int count = 0;
+        int* primes = find_primes(1, 100, &count);
+        stress_check(worker, primes != NULL && count == 25 && primes[24] == 97);
+        mem_free(primes);
+        
+        // 错误代码按线程保存，不受其他线程影响
+        clear_last_error();
+        divide(iter, 0);
+        stress_check(worker, get_last_error() == ERR_MATH_DIVIDE_BY_ZERO);
+        clear_last_error();
+        
+        // 文件函数：每个线程使用自己的文件
+        snprintf(record, sizeof(record), "%04d:%08d\n", worker->id % 10000, iter);
+        stress_check(worker, write_file(own_file, record));
+        stress_check(worker, append_file(own_file, record));
+        stress_check(worker, get_file_size(own_file) == 2 * STRESS_RECORD_SIZE);
+        stress_check(worker, copy_file(own_file, copy_file_name));
+        char* content = read_file(copy_file_name);
+        stress_check(worker, content != NULL && strlen(content) == 2 * STRESS_RECORD_SIZE &&
+                             strncmp(content, record, STRESS_RECORD_SIZE) == 0);
+        mem_free(content);
+        stress_check(worker, delete_file(copy_file_name));
+        
+        // 模式匹配：最左最长的匹配是"ab"和线程编号
+        int text_length = snprintf(record, sizeof(record), "%d-ab%dcd%d", iter, worker->id, iter % 97);
+        size_t match_start = (size_t)(strchr(record, '-') - record) + 1;
+        pattern_span span = {0, 0};
+        stress_check(worker, pattern_search(worker->shared_pattern, record, (size_t)text_length, 0, &span) &&
+                             span.start == match_start &&
+                             span.end == match_start + 2 + (size_t)snprintf(NULL, 0, "%d", worker->id));
+        
+        // 所有线程同时追加同一个文件，每条记录必须完整
+        snprintf(record, sizeof(record), "%04d:%08d\n", worker->id % 10000, iter);
+        stress_check(worker, append_file(STRESS_SHARED_FILE, record));
+    }
+    
+    delete_file(own_file);
+    return NULL;
+}
+
+/**
+ * @brief 检查共享文件中的记录是否完整、没有交错
+ * @param expected_records 期望的记录数
+ * @return 损坏的记录数，无法读取时返回-1
+ */
+static long verify_shared_records(long expected_records) {
+    char* content = read_file(STRESS_SHARED_FILE);
+    if (content == NULL) {
+        return -1;
+    }
+    long bad = 0;
+    size_t len = strlen(content);
+    if (len != (size_t)expected_records * STRESS_RECORD_SIZE) {
+        bad++;
+    }
+    for (size_t offset = 0; offset + STRESS_RECORD_SIZE <= len; offset += STRESS_RECORD_SIZE) {
+        if (content[offset + 4] != ':' || content[offset + STRESS_RECORD_SIZE - 1] != '\n') {
+            bad++;
+        }
+    }
+    mem_free(content);
+    return bad;
+}
+
+/**
+ * @brief 多线程并发压力测试，线程数从1开始每次翻倍直到max_threads
+ * @param max_threads 最大线程数
+ * @param iterations 每个线程的迭代次数
+ * @return 全部校验通过返回1，否则返回0
+ */
+int run_stress_test(int max_threads, int iterations) {
+    if (max_threads <= 0 || iterations <= 0) {
+        printf("线程数和迭代次数必须大于零\n");
+        return 0;
+    }
+    
+    // 关闭日志输出，避免所有线程在stdout/stderr的锁上串行化
+    int saved_flags = get_log_flags();
+    set_log_flags(0);
+    
+    stress_worker* workers = (stress_worker*)calloc(max_threads, sizeof(stress_worker));
+    pthread_t* threads = (pthread_t*)calloc(max_threads, sizeof(pthread_t));
+    if (workers == NULL || threads == NULL) {
+        free(workers);
+        free(threads);
+        set_log_flags(saved_flags);
+        printf("内存分配失败\n");
+        return 0;
+    }
+    
+    int passed = 1;
+    double base_rate = 0.0;
+    for (int num_threads = 1;; num_threads = num_threads * 2 < max_threads ? num_threads * 2 : max_threads) {
+        remove(STRESS_SHARED_FILE);
+        // 每轮重新编译，各线程从空的DFA缓存开始
+        pattern* shared_pattern = NULL;
+        if (pattern_compile("(ab|cd)[0-9]+", 0, &shared_pattern) != ERR_OK) {
+            passed = 0;
+            break;
+        }
+        struct timespec begin, end;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        
+        int started = 0;
+        for (int i = 0; i < num_threads; i++) {
+            workers[i].id = i;
+            workers[i].iterations = iterations;
+            workers[i].shared_pattern = shared_pattern;
+            workers[i].calls = 0;
+            workers[i].failures = 0;
+            if (pthread_create(&threads[i], NULL, stress_thread, &workers[i]) != 0) {
+                break;
+            }
+            started++;
+        }
+        long calls = 0, failures = started == num_threads ? 0 : 1;
+        for (int i = 0; i < started; i++) {
+            pthread_join(threads[i], NULL);
+            calls += workers[i].calls;
+            failures += workers[i].failures;
+        }
+        pattern_free(shared_pattern);
+        
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double seconds = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+        long bad_records = verify_shared_records((long)started * iterations);
+        remove(STRESS_SHARED_FILE);
+        
+        double rate = seconds > 0 ? calls / seconds : 0.0;
+        if (num_threads == 1) {
+            base_rate = rate;
+        }
+        printf("线程数 %3d: %ld 次调用, %.3f 秒, %.0f 次/秒, 加速比 %.2f, 校验失败 %ld, 损坏记录 %ld\n",
+               num_threads, calls, seconds, rate, base_rate > 0 ? rate / base_rate : 0.0,
+               failures, bad_records);
+        if (failures != 0 || bad_records != 0) {
+            passed = 0;
+        }
+        if (num_threads == max_threads) {
+            break;
+        }
+    }
+    
+    free(workers);
+    free(threads);
+    set_log_flags(saved_flags);
+    printf("压力测试%s\n", passed ? "通过" : "失败");
+    return passed;
+}
+
+/* 标准负载中逐条执行的命令，覆盖命令解析和各模块的常用路径 */
+static const char* const workload_commands[] = {
+    "add 12345 67890", "multiply 1234 5678", "divide 1000000 7", "gcd 1071 462",
+    "factorial 12", "fibonacci 40", "primes 1 2000", "upper hello world",
+    "lower HELLO WORLD", "reverse abcdefghijklmnopqrstuvwxyz", "ping", "unknown command",
+};
+
+#define WORKLOAD_TEXT_LENGTH (1 << 16)
+#define WORKLOAD_COMMAND_REPEAT 200
+
+/**
+ * @brief 运行标准负载：默认测试中数学、字符串、哈希函数的计算部分与命令协议，不含文件I/O
+ *
+ * 各构建（-O0、-O2、PGO+LTO）在同一负载上比较耗时；输出的校验和在各构建之间应当相同。
+ *
+ * @param rounds 轮数
+ * @return 成功返回1，失败返回0
+ */
+int run_workload(int rounds) {
+    if (rounds <= 0) {
+        printf("轮数必须大于零\n");
+        return 0;
+    }
+    int saved_flags = get_log_flags();
+    set_log_flags(0);
+    
+    static const char words[] = "alpha,beta,gamma,delta,epsilon,";
+    char* text = (char*)malloc(WORKLOAD_TEXT_LENGTH + 1);
+    int* values = (int*)malloc(WORKLOAD_TEXT_LENGTH * sizeof(int));
+    command_buffer buffer;
+    command_buffer_init(&buffer);
+    if (text == NULL || values == NULL) {
+        free(text);
+        free(values);
+        set_log_flags(saved_flags);
+        printf("内存分配失败\n");
+        return 0;
+    }
+    for (int i = 0; i < WORKLOAD_TEXT_LENGTH; i++) {
+        text[i] = words[i % (sizeof(words) - 1)];
+        values[i] = i % 1000;
+    }
+    text[WORKLOAD_TEXT_LENGTH] = '\0';
+    
+    unsigned long checksum = 0;
+    int ok = 1;
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int round = 0; round < rounds && ok; round++) {
+        // 数学函数
+        for (int n = 0; n <= 12; n++) {
+            checksum += (unsigned long)factorial(n);
+        }
+        for (int n = 0; n <= 46; n++) {
+            checksum += (unsigned long)fibonacci(n);
+        }
+        for (int a = 1; a <= 2000; a++) {
+            checksum += (unsigned long)gcd(a * 7919, 104729 * (a % 7 + 1));
+        }
+        int prime_count = 0;
+        int* primes = find_primes(1, 100000, &prime_count);
+        mem_free(primes);
+        checksum += (unsigned long)prime_count;
+        checksum += (unsigned long)average(values, WORKLOAD_TEXT_LENGTH);
+        
+        // 字符串函数
+        char* replaced = string_replace(text, "beta", "BETA!");
+        char* upper = string_to_upper(text);
+        char* reversed = string_reverse(text);
+        int part_count = 0;
+        char** parts = string_split(text, ",", &part_count);
+        if (replaced == NULL || upper == NULL || reversed == NULL || parts == NULL) {
+            ok = 0;
+        } else {
+            checksum += strlen(replaced) + (unsigned long)upper[7] + (unsigned long)reversed[0];
+            checksum += (unsigned long)part_count + (unsigned long)string_find(text, "epsilon,alpha");
+        }
+        for (int i = 0; i < part_count; i++) {
+            mem_free(parts[i]);
+        }
+        mem_free(parts);
+        mem_free(replaced);
+        mem_free(upper);
+        mem_free(reversed);
+        
+        // 哈希函数
+        unsigned char digest[32];
+        sha256(text, WORKLOAD_TEXT_LENGTH, digest);
+        checksum += crc32c(0, text, WORKLOAD_TEXT_LENGTH) + xxh32(text, WORKLOAD_TEXT_LENGTH, 0) +
+                    (unsigned long)xxh3_64(text, WORKLOAD_TEXT_LENGTH) + digest[0];
+        
+        // 命令协议
+        for (int repeat = 0; repeat < WORKLOAD_COMMAND_REPEAT && ok; repeat++) {
+            for (size_t c = 0; c < sizeof(workload_commands) / sizeof(workload_commands[0]); c++) {
+                buffer.len = 0;
+                if (command_execute(workload_commands[c], strlen(workload_commands[c]), &buffer) < 0) {
+                    ok = 0;
+                    break;
+                }
+                checksum += buffer.len;
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+    
+    command_buffer_free(&buffer);
+    free(text);
+    free(values);
+    set_log_flags(saved_flags);
+    if (!ok) {
+        printf("标准负载执行失败\n");
+        return 0;
+    }
+    printf("标准负载: %d 轮, %.3f 秒, 校验和 %lu\n", rounds, seconds, checksum);
+    return 1;
 }
\ No newline at end of file
@@ -0,0 +1,597 @@
+/**
+ * @file allocator.c
+ * @brief 内存分配实现：小块内存按大小分级，线程本地的空闲链表与全局链表之间成批交换；
+ *        调试模式每块内存单独映射并在其后放置保护页
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include "../include/allocator.h"
+#include "../include/module.h"
+#include "../include/utils.h"
+
+/* 块头与跟踪链接各占16字节，返回给调用者的内存保持16字节对齐 */
+#define HEADER_SIZE 16
+#define TRACK_SIZE 16
+#define ALIGNMENT 16
+
+#define MEM_MAGIC 0x4D454D21u
+#define MEM_FREED 0x46524545u
+
+/* 块的来源，跟踪的块另外带有KIND_TRACKED */
+#define KIND_SYSTEM 1
+#define KIND_POOL 2
+#define KIND_GUARDED 3
+#define KIND_MASK 0xffu
+#define KIND_TRACKED 0x100u
+/* 池中的块在kind的高位记录大小级别，释放时不必重新计算 */
+#define KIND_CLASS_SHIFT 16
+
+/* 大小级别：32到128字节每16字节一级，之后每个2的幂区间分4级，直到MEM_POOL_MAX_SIZE */
+#define LINEAR_CLASSES 7
+#define CLASS_COUNT 19
+/* 内存池每次向系统申请的字节数，开头16字节用于串起所有slab */
+#define SLAB_SIZE (64 * 1024)
+/* 线程缓存与全局链表之间每批交换约这么多字节，线程缓存超过两批时归还一批 */
+#define BATCH_BYTES 8192
+/* 单次请求的上限，避免加上块头与对齐后溢出 */
+#define MAX_REQUEST (SIZE_MAX / 2)
+/* 报告最多列出的块数与每块显示的字节数 */
+#define REPORT_BLOCKS 20
+#define REPORT_PREVIEW 32
+/* 调试模式中对齐填充的字节，释放时检查是否被改写 */
+#define CANARY_BYTE 0xFD
+/* 调试模式中保留映射的已释放块数，超过时解除最早的块的映射（每块占用几个映射区，受vm.max_map_count限制） */
+#define QUARANTINE_BLOCKS 1024
+
+typedef struct {
+    size_t size;        /* 请求的字节数；池中空闲块的链表指针会覆盖这里 */
+    uint32_t kind;      /* KIND_*、KIND_TRACKED与池中块的大小级别 */
+    uint32_t magic;     /* 使用中为MEM_MAGIC，释放后为MEM_FREED */
+} block_header;
+
+_Static_assert(sizeof(block_header) == HEADER_SIZE, "块头必须为16字节");
+
+typedef struct track_link {
+    struct track_link* prev;
+    struct track_link* next;
+} track_link;
+
+typedef struct free_block {
+    struct free_block* next;
+} free_block;
+
+typedef struct {
+    free_block* head;
+    int count;
+} free_list;
+
+static const char* const mode_names[] = {"system", "pool", "debug"};
+
+static atomic_int current_mode = MEM_MODE_POOL;
+static atomic_int tracking = 0;
+static atomic_int report_registered = 0;
+
+/* 全局空闲链表与slab链表共用一把锁，线程只在整批交换时才加锁 */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static free_block* central_head[CLASS_COUNT];
+static int central_count[CLASS_COUNT];
+static void* slabs = NULL;
+static size_t pool_reserved = 0;
+
+/* 每个级别一批交换的块数 */
+static int class_batch[CLASS_COUNT];
+
+static pthread_key_t cache_key;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static __thread free_list thread_cache[CLASS_COUNT];
+static __thread int cache_registered = 0;
+
+/* 跟踪的块组成双向循环链表 */
+static pthread_mutex_t track_lock = PTHREAD_MUTEX_INITIALIZER;
+static track_link tracked_blocks = {&tracked_blocks, &tracked_blocks};
+static size_t live_bytes = 0;
+static size_t live_blocks = 0;
+static size_t peak_bytes = 0;
+static uint64_t total_allocations = 0;
+
+static size_t page_size = 0;
+
+/* ---------- 大小级别 ---------- */
+
+static int size_class(size_t n) {
+    if (n <= 128) {
+        return n <= 32 ? 0 : (int)((n + 15) >> 4) - 2;
+    }
+    int shift = 63 - __builtin_clzll((unsigned long long)(n - 1));
+    return LINEAR_CLASSES + (shift - 7) * 4 + (int)((n - 1 - ((size_t)1 << shift)) >> (shift - 2));
+}
+
+static size_t class_size(int c) {
+    if (c < LINEAR_CLASSES) {
+        return 32 + 16 * (size_t)c;
+    }
+    int shift = 7 + (c - LINEAR_CLASSES) / 4;
+    return ((size_t)1 << shift) + ((size_t)((c - LINEAR_CLASSES) % 4 + 1) << (shift - 2));
+}
+
+static int batch_count(int c) {
+    int n = BATCH_BYTES / (int)class_size(c);
+    return n < 4 ? 4 : (n > 64 ? 64 : n);
+}
+
+/* ---------- 线程缓存 ---------- */
+
+/* 把链表接到全局链表的开头，调用时持有pool_lock */
+static void central_push(int c, free_block* head, free_block* tail, int count) {
+    tail->next = central_head[c];
+    central_head[c] = head;
+    central_count[c] += count;
+}
+
+/* 线程退出时把缓存的块全部交给全局链表，供其他线程使用 */
+static void release_cache(void* unused) {
+    (void)unused;
+    pthread_mutex_lock(&pool_lock);
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        free_list* list = &thread_cache[c];
+        if (list->head != NULL) {
+            free_block* tail = list->head;
+            while (tail->next != NULL) {
+                tail = tail->next;
+            }
+            central_push(c, list->head, tail, list->count);
+            list->head = NULL;
+            list->count = 0;
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+    cache_registered = 0;
+}
+
+static void create_cache_key(void) {
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        class_batch[c] = batch_count(c);
+    }
+    pthread_key_create(&cache_key, release_cache);
+    page_size = (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static void register_cache(void) {
+    pthread_once(&key_once, create_cache_key);
+    // 值只用于让线程退出时调用release_cache，缓存本身在线程本地变量中
+    pthread_setspecific(cache_key, thread_cache);
+    cache_registered = 1;
+}
+
+/* 申请一个slab并切分为c级别的块放入全局链表，调用时持有pool_lock */
+static int carve_slab(int c) {
+    char* slab = (char*)malloc(SLAB_SIZE);
+    if (slab == NULL) {
+        return 0;
+    }
+    *(void**)slab = slabs;
+    slabs = slab;
+    pool_reserved += SLAB_SIZE;
+    size_t size = class_size(c);
+    int count = (int)((SLAB_SIZE - ALIGNMENT) / size);
+    char* first = slab + ALIGNMENT;
+    for (int i = 0; i < count - 1; i++) {
+        ((free_block*)(first + (size_t)i * size))->next = (free_block*)(first + (size_t)(i + 1) * size);
+    }
+    central_push(c, (free_block*)first, (free_block*)(first + (size_t)(count - 1) * size), count);
+    return 1;
+}
+
+/* 从全局链表取一批块放入线程缓存 */
+static int refill(int c) {
+    if (!cache_registered) {
+        register_cache();
+    }
+    int want = class_batch[c];
+    pthread_mutex_lock(&pool_lock);
+    if (central_head[c] == NULL && !carve_slab(c)) {
+        pthread_mutex_unlock(&pool_lock);
+        return 0;
+    }
+    free_block* head = central_head[c];
+    free_block* tail = head;
+    int taken = 1;
+    while (taken < want && tail->next != NULL) {
+        tail = tail->next;
+        taken++;
+    }
+    central_head[c] = tail->next;
+    central_count[c] -= taken;
+    pthread_mutex_unlock(&pool_lock);
+    tail->next = NULL;
+    thread_cache[c].head = head;
+    thread_cache[c].count = taken;
+    return 1;
+}
+
+static void* pool_pop(int c) {
+    free_list* list = &thread_cache[c];
+    if (list->head == NULL && !refill(c)) {
+        return NULL;
+    }
+    free_block* block = list->head;
+    list->head = block->next;
+    list->count--;
+    return block;
+}
+
+/* 释放的块放回当前线程的缓存，缓存过多时把一批归还全局链表 */
+static void pool_push(int c, void* ptr) {
+    if (!cache_registered) {
+        register_cache();
+    }
+    free_list* list = &thread_cache[c];
+    free_block* block = (free_block*)ptr;
+    block->next = list->head;
+    list->head = block;
+    int want = class_batch[c];
+    if (++list->count <= 2 * want) {
+        return;
+    }
+    free_block* tail = list->head;
+    for (int i = 1; i < want; i++) {
+        tail = tail->next;
+    }
+    free_block* head = list->head;
+    list->head = tail->next;
+    list->count -= want;
+    pthread_mutex_lock(&pool_lock);
+    central_push(c, head, tail, want);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+/* ---------- 调试模式 ---------- */
+
+static size_t round_up(size_t n, size_t unit) {
+    return (n + unit - 1) / unit * unit;
+}
+
+/* 映射足够的页使内存的末尾（按16字节对齐后）紧贴保护页，对齐填充写入CANARY_BYTE */
+static void* guarded_alloc(size_t size, size_t prefix) {
+    pthread_once(&key_once, create_cache_key);
+    size_t payload = round_up(size, ALIGNMENT);
+    size_t span = round_up(prefix + payload, page_size);
+    char* map = (char*)mmap(NULL, span + page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    if (mprotect(map + span, page_size, PROT_NONE) != 0) {
+        munmap(map, span + page_size);
+        return NULL;
+    }
+    char* user = map + span - payload;
+    memset(user + size, CANARY_BYTE, payload - size);
+    return user - prefix;
+}
+
+static int guarded_intact(const char* user, size_t size) {
+    size_t payload = round_up(size, ALIGNMENT);
+    for (size_t i = size; i < payload; i++) {
+        if ((unsigned char)user[i] != CANARY_BYTE) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* 最近释放的块：块头所在的页只读，其余页不可访问并归还物理内存 */
+static struct {
+    char* map;
+    size_t length;
+} quarantine[QUARANTINE_BLOCKS];
+static size_t quarantine_next = 0;
+static pthread_mutex_t quarantine_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* 不立即解除映射，重复释放时仍能读到块头中的MEM_FREED，释放后的读写触发SIGSEGV */
+static void guarded_free(void* base, const char* user, size_t size) {
+    char* map = (char*)((uintptr_t)base & ~(uintptr_t)(page_size - 1));
+    char* guard = (char*)user + round_up(size, ALIGNMENT);
+    size_t length = (size_t)(guard - map) + page_size;
+    char* header_page = (char*)((uintptr_t)(user - HEADER_SIZE) & ~(uintptr_t)(page_size - 1));
+    if (header_page > map) {
+        madvise(map, (size_t)(header_page - map), MADV_DONTNEED);
+    }
+    if (header_page + page_size < guard) {
+        madvise(header_page + page_size, (size_t)(guard - header_page - page_size), MADV_DONTNEED);
+    }
+    mprotect(map, length, PROT_NONE);
+    mprotect(header_page, page_size, PROT_READ);
+
+    pthread_mutex_lock(&quarantine_lock);
+    if (quarantine[quarantine_next].map != NULL) {
+        munmap(quarantine[quarantine_next].map, quarantine[quarantine_next].length);
+    }
+    quarantine[quarantine_next].map = map;
+    quarantine[quarantine_next].length = length;
+    quarantine_next = (quarantine_next + 1) % QUARANTINE_BLOCKS;
+    pthread_mutex_unlock(&quarantine_lock);
+}
+
+/* ---------- 跟踪 ---------- */
+
+static void track_insert(track_link* link, size_t size) {
+    pthread_mutex_lock(&track_lock);
+    link->next = tracked_blocks.next;
+    link->prev = &tracked_blocks;
+    tracked_blocks.next->prev = link;
+    tracked_blocks.next = link;
+    live_bytes += size;
+    live_blocks++;
+    total_allocations++;
+    if (live_bytes > peak_bytes) {
+        peak_bytes = live_bytes;
+    }
+    pthread_mutex_unlock(&track_lock);
+}
+
+static void track_remove(track_link* link, size_t size) {
+    pthread_mutex_lock(&track_lock);
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    live_bytes -= size;
+    live_blocks--;
+    pthread_mutex_unlock(&track_lock);
+}
+
+static void report_at_exit(void) {
+    mem_print_report();
+}
+
+/* ---------- 分配与释放 ---------- */
+
+static void report_bad_block(error_code code, const char* message) {
+    error_log(code, message);
+    if (atomic_load_explicit(&current_mode, memory_order_relaxed) == MEM_MODE_DEBUG) {
+        abort();
+    }
+}
+
+static block_header* header_of(const void* ptr) {
+    return (block_header*)((char*)ptr - HEADER_SIZE);
+}
+
+void* mem_alloc(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    if (size > MAX_REQUEST) {
+        return NULL;
+    }
+    uint32_t tracked = atomic_load_explicit(&tracking, memory_order_relaxed) ? KIND_TRACKED : 0;
+    size_t prefix = HEADER_SIZE + (tracked ? TRACK_SIZE : 0);
+    char* base;
+    uint32_t kind;
+    int c;
+    switch ((mem_mode)atomic_load_explicit(&current_mode, memory_order_relaxed)) {
+    case MEM_MODE_DEBUG:
+        base = (char*)guarded_alloc(size, prefix);
+        kind = KIND_GUARDED;
+        break;
+    case MEM_MODE_POOL:
+        if (size + prefix <= MEM_POOL_MAX_SIZE) {
+            c = size_class(size + prefix);
+            base = (char*)pool_pop(c);
+            kind = KIND_POOL | ((uint32_t)c << KIND_CLASS_SHIFT);
+            break;
+        }
+        // 大块直接使用malloc
+        /* fall through */
+    default:
+        base = (char*)malloc(size + prefix);
+        kind = KIND_SYSTEM;
+        break;
+    }
+    if (base == NULL) {
+        return NULL;
+    }
+    if (tracked) {
+        track_insert((track_link*)base, size);
+    }
+    block_header* header = (block_header*)(base + prefix - HEADER_SIZE);
+    header->size = size;
+    header->kind = kind | tracked;
+    header->magic = MEM_MAGIC;
+    return base + prefix;
+}
+
+void* mem_calloc(size_t count, size_t size) {
+    if (size != 0 && count > MAX_REQUEST / size) {
+        return NULL;
+    }
+    void* ptr = mem_alloc(count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void mem_free(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    block_header* header = header_of(ptr);
+    if (header->magic == MEM_FREED) {
+        report_bad_block(ERR_MEM_BAD_POINTER, "重复释放内存");
+        return;
+    }
+    if (header->magic != MEM_MAGIC) {
+        report_bad_block(ERR_MEM_BAD_POINTER, "释放的内存不是由mem_alloc分配的，或已被释放");
+        return;
+    }
+    uint32_t kind = header->kind;
+    size_t size = header->size;
+    size_t prefix = HEADER_SIZE + ((kind & KIND_TRACKED) ? TRACK_SIZE : 0);
+    char* base = (char*)ptr - prefix;
+    uint32_t source = kind & KIND_MASK;
+    if ((source != KIND_POOL || (kind >> KIND_CLASS_SHIFT) >= CLASS_COUNT) && source != KIND_SYSTEM &&
+        source != KIND_GUARDED) {
+        report_bad_block(ERR_MEM_BAD_POINTER, "内存块头已损坏");
+        return;
+    }
+    if ((kind & KIND_MASK) == KIND_GUARDED && !guarded_intact((const char*)ptr, size)) {
+        report_bad_block(ERR_MEM_OVERRUN, "内存块末尾之后被改写");
+    }
+    if (kind & KIND_TRACKED) {
+        track_remove((track_link*)base, size);
+    }
+    header->magic = MEM_FREED;
+    switch (kind & KIND_MASK) {
+    case KIND_POOL:
+        pool_push((int)(kind >> KIND_CLASS_SHIFT), base);
+        break;
+    case KIND_GUARDED:
+        guarded_free(base, (const char*)ptr, size);
+        break;
+    default:
+        free(base);
+        break;
+    }
+}
+
+void* mem_realloc(void* ptr, size_t size) {
+    if (ptr == NULL) {
+        return mem_alloc(size);
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    if (size > MAX_REQUEST) {
+        return NULL;
+    }
+    block_header* header = header_of(ptr);
+    if (header->magic != MEM_MAGIC) {
+        report_bad_block(ERR_MEM_BAD_POINTER, "调整大小的内存不是由mem_alloc分配的，或已被释放");
+        return NULL;
+    }
+    // 未跟踪的块不需要更新链表：malloc的块交给realloc，池中的块在同一级别内原地调整
+    if (header->kind == KIND_SYSTEM) {
+        block_header* moved = (block_header*)realloc(header, size + HEADER_SIZE);
+        if (moved == NULL) {
+            return NULL;
+        }
+        moved->size = size;
+        return (char*)moved + HEADER_SIZE;
+    }
+    if ((header->kind & (KIND_MASK | KIND_TRACKED)) == KIND_POOL && size + HEADER_SIZE <= MEM_POOL_MAX_SIZE &&
+        size_class(size + HEADER_SIZE) == (int)(header->kind >> KIND_CLASS_SHIFT)) {
+        header->size = size;
+        return ptr;
+    }
+    void* moved = mem_alloc(size);
+    if (moved == NULL) {
+        return NULL;
+    }
+    memcpy(moved, ptr, size < header->size ? size : header->size);
+    mem_free(ptr);
+    return moved;
+}
+
+char* mem_strdup(const char* str) {
+    if (str == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(str) + 1;
+    char* copy = (char*)mem_alloc(len);
+    if (copy != NULL) {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
+
+/* ---------- 设置与统计 ---------- */
+
+void mem_set_mode(mem_mode mode) {
+    atomic_store(&current_mode, (int)mode);
+}
+
+mem_mode mem_get_mode() {
+    return (mem_mode)atomic_load(&current_mode);
+}
+
+int mem_parse_mode(const char* name, mem_mode* mode) {
+    if (name == NULL || mode == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(mode_names) / sizeof(mode_names[0]); i++) {
+        if (strcmp(name, mode_names[i]) == 0) {
+            *mode = (mem_mode)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void mem_set_tracking(int enabled) {
+    atomic_store(&tracking, enabled != 0);
+    if (enabled && atomic_exchange(&report_registered, 1) == 0) {
+        atexit(report_at_exit);
+    }
+}
+
+void mem_get_stats(mem_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&track_lock);
+    stats->live_bytes = live_bytes;
+    stats->live_blocks = live_blocks;
+    stats->peak_bytes = peak_bytes;
+    stats->total_allocations = total_allocations;
+    pthread_mutex_unlock(&track_lock);
+    pthread_mutex_lock(&pool_lock);
+    stats->pool_reserved_bytes = pool_reserved;
+    pthread_mutex_unlock(&pool_lock);
+}
+
+void mem_print_report() {
+    mem_stats stats;
+    mem_get_stats(&stats);
+    printf("\n内存分配统计（分配方式: %s）:\n", mode_names[mem_get_mode()]);
+    printf("  未释放: %zu 字节 / %zu 块，峰值: %zu 字节，分配次数: %llu\n", stats.live_bytes,
+           stats.live_blocks, stats.peak_bytes, (unsigned long long)stats.total_allocations);
+    printf("  内存池向系统申请: %zu 字节\n", stats.pool_reserved_bytes);
+    if (stats.live_blocks == 0) {
+        return;
+    }
+    printf("未释放的内存:\n");
+    pthread_mutex_lock(&track_lock);
+    size_t listed = 0;
+    for (track_link* link = tracked_blocks.next; link != &tracked_blocks && listed < REPORT_BLOCKS;
+         link = link->next, listed++) {
+        const block_header* header = (const block_header*)((char*)link + TRACK_SIZE);
+        const unsigned char* data = (const unsigned char*)header + HEADER_SIZE;
+        // 大多数输出是字符串，显示到'\0'为止，不可打印的字节显示为'.'
+        char preview[REPORT_PREVIEW + 1];
+        size_t n = 0;
+        while (n < REPORT_PREVIEW && n < header->size && data[n] != '\0') {
+            preview[n] = data[n] >= 0x20 && data[n] < 0x7f ? (char)data[n] : '.';
+            n++;
+        }
+        preview[n] = '\0';
+        printf("  %p: %zu 字节 \"%s\"\n", (const void*)data, header->size, preview);
+    }
+    if (stats.live_blocks > listed) {
+        printf("  ……另有 %zu 块\n", stats.live_blocks - listed);
+    }
+    pthread_mutex_unlock(&track_lock);
+}
+
+static int module_init(void) {
+    pthread_once(&key_once, create_cache_key);
+    debug_print("内存分配模块初始化成功");
+    return 1;
+}
+
+int initialize_allocator() {
+    return module_init_once(MODULE_ALLOCATOR, module_init);
+}
\ No newline at end of file
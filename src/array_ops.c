@@ -0,0 +1,667 @@
+/**
+ * @file array_ops.c
+ * @brief 数组算法实现
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <immintrin.h>
+#include "../include/array_ops.h"
+#include "../include/module.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+
+/* 元素个数不超过该值时用插入排序 */
+#define SMALL_SORT 32
+/* 元素个数达到该值时按块并行 */
+#define PARALLEL_SORT 131072
+/* 不超过该字节数的区间直接在缓存中做LSD，否则先按最高的字节分桶 */
+#define CACHE_SORT_BYTES (64 * 1024)
+/* 并行时的最大块数 */
+#define MAX_SORT_CHUNKS 64
+/* 每趟排序的位数 */
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+/* 分发时每个数字先攒满一个缓存行再写出，减少分散写入造成的TLB与缓存缺失 */
+#define WRITE_COMBINE_BYTES 64
+/* Floyd-Rivest在区间长于该值时先在样本中递归选择，使划分元素接近第k小 */
+#define SAMPLE_SELECT 600
+/* 百分位数超过该个数时整体排序，不再逐个选择 */
+#define PERCENTILES_BY_SELECT 16
+/* lower_bound最后一次比较的元素个数，为一个缓存行 */
+#define SEARCH_BLOCK_32 16
+#define SEARCH_BLOCK_64 8
+
+#define SIGN_32 0x80000000u
+#define SIGN_64 0x8000000000000000ULL
+
+/* 以无符号整数读写int32_t、int64_t与double数组的元素 */
+typedef uint32_t key32 __attribute__((may_alias));
+typedef uint64_t key64 __attribute__((may_alias));
+
+/* 元素到无符号键的变换，使键的无符号顺序与元素的顺序相同 */
+typedef enum {
+    KEY_UNSIGNED,
+    KEY_SIGNED,       /* 翻转符号位 */
+    KEY_FLOAT         /* 负数翻转所有位，非负数翻转符号位 */
+} key_kind;
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+static int has_avx2 = 0;
+
+static void init_tables(void) {
+    __builtin_cpu_init();
+    has_avx2 = __builtin_cpu_supports("avx2");
+}
+
+static inline void ensure_tables(void) {
+    pthread_once(&tables_once, init_tables);
+}
+
+/* ---------- 基数排序 ---------- */
+
+static inline key32 encode_32(key32 value, key_kind kind) {
+    return kind == KEY_SIGNED ? value ^ SIGN_32 : value;
+}
+
+static inline key32 decode_32(key32 key, key_kind kind) {
+    return encode_32(key, kind);
+}
+
+static inline key64 encode_64(key64 value, key_kind kind) {
+    if (kind == KEY_FLOAT) {
+        return value ^ ((key64)((int64_t)value >> 63) | SIGN_64);
+    }
+    return kind == KEY_SIGNED ? value ^ SIGN_64 : value;
+}
+
+static inline key64 decode_64(key64 key, key_kind kind) {
+    if (kind == KEY_FLOAT) {
+        return key ^ (((key >> 63) - 1) | SIGN_64);
+    }
+    return kind == KEY_SIGNED ? key ^ SIGN_64 : key;
+}
+
+typedef struct {
+    void* data;              /* 待排序的数组 */
+    void* buffer;            /* 同样大小的临时区 */
+    size_t count;
+    long chunks;
+    key_kind kind;
+    int top;                 /* 首趟按其分桶的字节：所有键中最高的取值不全相同的字节 */
+    uint64_t* key_or;        /* [chunks]，各块所有键的按位或 */
+    uint64_t* key_and;       /* [chunks]，各块所有键的按位与 */
+    size_t* counts;          /* [chunks][RADIX_SIZE]，各块首趟各数字的个数 */
+    size_t* offsets;         /* [chunks][RADIX_SIZE]，各块首趟每个数字的写入位置 */
+    size_t* buckets;         /* [RADIX_SIZE + 1]，首趟后各桶在临时区中的起始位置 */
+} radix_job;
+
+/* 第t块的起始下标，各块的元素个数至多相差1 */
+static size_t chunk_begin(const radix_job* job, long t) {
+    size_t base = job->count / (size_t)job->chunks;
+    size_t extra = job->count % (size_t)job->chunks;
+    return (size_t)t * base + ((size_t)t < extra ? (size_t)t : extra);
+}
+
+static void run_chunks(radix_job* job, long tasks, range_fn fn) {
+    if (job->chunks > 1) {
+        parallel_for(NULL, 0, tasks, 1, fn, job);
+    } else {
+        fn(0, tasks, job);
+    }
+}
+
+/* 按当前的写入位置分发一个键，每个数字先攒满一个缓存行再写出 */
+#define SCATTER_LINE(U, key, d, lines, fill, offset, dst)          \
+    do {                                                          \
+        (lines)[d][(fill)[d]++] = (key);                          \
+        if ((fill)[d] == WRITE_COMBINE_BYTES / sizeof(U)) {       \
+            memcpy((dst) + (offset)[d], (lines)[d], WRITE_COMBINE_BYTES); \
+            (offset)[d] += WRITE_COMBINE_BYTES / sizeof(U);       \
+            (fill)[d] = 0;                                        \
+        }                                                         \
+    } while (0)
+
+/*
+ * 按键的宽度生成基数排序。整体先把元素变换为键，求出所有键中最高的取值不全相同的字节，按该字节
+ * 分桶（MSD一趟，大数组时各块并行统计与分发）；之后各桶（可并行）在缓存中按剩余的低字节做LSD，
+ * 桶仍然过大时再按下一个字节分桶。相比对整个数组做LSD，主存只需读写约两遍
+ */
+#define DEFINE_RADIX(W, U)                                                                           \
+    static void insertion_sort_##W(U* keys, size_t n) {                                              \
+        for (size_t i = 1; i < n; i++) {                                                             \
+            U key = keys[i];                                                                         \
+            size_t j = i;                                                                            \
+            for (; j > 0 && keys[j - 1] > key; j--) {                                                \
+                keys[j] = keys[j - 1];                                                               \
+            }                                                                                        \
+            keys[j] = key;                                                                           \
+        }                                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    /* 在缓存中对keys[0..n)按第0..top字节做LSD，跳过取值全相同的字节；结果在keys中 */               \
+    static void lsd_sort_##W(U* keys, U* scratch, size_t n, int top) {                               \
+        uint32_t counts[sizeof(U)][RADIX_SIZE];                                                      \
+        memset(counts, 0, (size_t)(top + 1) * sizeof(counts[0]));                                    \
+        for (size_t i = 0; i < n; i++) {                                                             \
+            for (int b = 0; b <= top; b++) {                                                         \
+                counts[b][(keys[i] >> (b * RADIX_BITS)) & (RADIX_SIZE - 1)]++;                       \
+            }                                                                                        \
+        }                                                                                            \
+        U* src = keys;                                                                               \
+        U* dst = scratch;                                                                            \
+        for (int b = 0; b <= top; b++) {                                                             \
+            int shift = b * RADIX_BITS;                                                              \
+            if (counts[b][(src[0] >> shift) & (RADIX_SIZE - 1)] == n) {                              \
+                continue;                                                                            \
+            }                                                                                        \
+            size_t offset[RADIX_SIZE];                                                               \
+            size_t sum = 0;                                                                          \
+            for (size_t d = 0; d < RADIX_SIZE; d++) {                                                \
+                offset[d] = sum;                                                                     \
+                sum += counts[b][d];                                                                 \
+            }                                                                                        \
+            for (size_t i = 0; i < n; i++) {                                                         \
+                U key = src[i];                                                                      \
+                dst[offset[(key >> shift) & (RADIX_SIZE - 1)]++] = key;                              \
+            }                                                                                        \
+            U* swap = src;                                                                           \
+            src = dst;                                                                               \
+            dst = swap;                                                                              \
+        }                                                                                            \
+        if (src != keys) {                                                                           \
+            memcpy(keys, src, n * sizeof(U));                                                        \
+        }                                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    /*                                                                                               \
+     * 按第0..top字节排序keys[0..n)中的键，scratch为同样大小的临时区；to_scratch为0时结果在keys中， \
+     * 否则在scratch中                                                                               \
+     */                                                                                              \
+    static void sort_keys_##W(U* keys, U* scratch, size_t n, int top, int to_scratch) {              \
+        if (n <= SMALL_SORT || top < 0 || n * sizeof(U) <= CACHE_SORT_BYTES) {                       \
+            if (n <= SMALL_SORT) {                                                                   \
+                insertion_sort_##W(keys, n);                                                         \
+            } else if (top >= 0) {                                                                   \
+                lsd_sort_##W(keys, scratch, n, top);                                                 \
+            }                                                                                        \
+            if (to_scratch) {                                                                        \
+                memcpy(scratch, keys, n * sizeof(U));                                                \
+            }                                                                                        \
+            return;                                                                                  \
+        }                                                                                            \
+        int shift = top * RADIX_BITS;                                                                \
+        size_t offset[RADIX_SIZE] = {0};                                                             \
+        for (size_t i = 0; i < n; i++) {                                                             \
+            offset[(keys[i] >> shift) & (RADIX_SIZE - 1)]++;                                         \
+        }                                                                                            \
+        if (offset[(keys[0] >> shift) & (RADIX_SIZE - 1)] == n) {                                    \
+            sort_keys_##W(keys, scratch, n, top - 1, to_scratch);                                    \
+            return;                                                                                  \
+        }                                                                                            \
+        size_t starts[RADIX_SIZE + 1];                                                               \
+        size_t sum = 0;                                                                              \
+        for (size_t d = 0; d < RADIX_SIZE; d++) {                                                    \
+            starts[d] = sum;                                                                         \
+            sum += offset[d];                                                                        \
+            offset[d] = starts[d];                                                                   \
+        }                                                                                            \
+        starts[RADIX_SIZE] = n;                                                                      \
+        _Alignas(WRITE_COMBINE_BYTES) U lines[RADIX_SIZE][WRITE_COMBINE_BYTES / sizeof(U)];          \
+        unsigned int fill[RADIX_SIZE] = {0};                                                         \
+        for (size_t i = 0; i < n; i++) {                                                             \
+            U key = keys[i];                                                                         \
+            size_t d = (key >> shift) & (RADIX_SIZE - 1);                                            \
+            SCATTER_LINE(U, key, d, lines, fill, offset, scratch);                                   \
+        }                                                                                            \
+        for (size_t d = 0; d < RADIX_SIZE; d++) {                                                    \
+            memcpy(scratch + offset[d], lines[d], fill[d] * sizeof(U));                              \
+        }                                                                                            \
+        /* 各桶现在在scratch中，交换两个区的角色 */                                                  \
+        for (size_t d = 0; d < RADIX_SIZE; d++) {                                                    \
+            size_t start = starts[d];                                                                \
+            sort_keys_##W(scratch + start, keys + start, starts[d + 1] - start, top - 1, !to_scratch); \
+        }                                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    /* 把各块的元素变换为键，并求键的按位或与按位与 */                                               \
+    static void radix_encode_##W(long begin, long end, void* ctx) {                                  \
+        radix_job* job = (radix_job*)ctx;                                                            \
+        U* data = (U*)job->data;                                                                     \
+        for (long t = begin; t < end; t++) {                                                         \
+            U key_or = 0;                                                                            \
+            U key_and = (U)~(U)0;                                                                    \
+            size_t hi = chunk_begin(job, t + 1);                                                     \
+            for (size_t i = chunk_begin(job, t); i < hi; i++) {                                      \
+                U key = encode_##W(data[i], job->kind);                                              \
+                data[i] = key;                                                                       \
+                key_or |= key;                                                                       \
+                key_and &= key;                                                                      \
+            }                                                                                        \
+            job->key_or[t] = key_or;                                                                 \
+            job->key_and[t] = key_and;                                                               \
+        }                                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    static void radix_count_##W(long begin, long end, void* ctx) {                                   \
+        radix_job* job = (radix_job*)ctx;                                                            \
+        const U* data = (const U*)job->data;                                                         \
+        int shift = job->top * RADIX_BITS;                                                           \
+        for (long t = begin; t < end; t++) {                                                         \
+            size_t* counts = job->counts + (size_t)t * RADIX_SIZE;                                   \
+            memset(counts, 0, RADIX_SIZE * sizeof(size_t));                                          \
+            size_t hi = chunk_begin(job, t + 1);                                                     \
+            for (size_t i = chunk_begin(job, t); i < hi; i++) {                                      \
+                counts[(data[i] >> shift) & (RADIX_SIZE - 1)]++;                                     \
+            }                                                                                        \
+        }                                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    static void radix_scatter_##W(long begin, long end, void* ctx) {                                 \
+        radix_job* job = (radix_job*)ctx;                                                            \
+        const U* data = (const U*)job->data;                                                         \
+        U* buffer = (U*)job->buffer;                                                                 \
+        int shift = job->top * RADIX_BITS;                                                           \
+        _Alignas(WRITE_COMBINE_BYTES) U lines[RADIX_SIZE][WRITE_COMBINE_BYTES / sizeof(U)];          \
+        for (long t = begin; t < end; t++) {                                                         \
+            size_t offset[RADIX_SIZE];                                                               \
+            unsigned int fill[RADIX_SIZE] = {0};                                                     \
+            memcpy(offset, job->offsets + (size_t)t * RADIX_SIZE, sizeof(offset));                   \
+            size_t hi = chunk_begin(job, t + 1);                                                     \
+            for (size_t i = chunk_begin(job, t); i < hi; i++) {                                      \
+                U key = data[i];                                                                     \
+                size_t d = (key >> shift) & (RADIX_SIZE - 1);                                        \
+                SCATTER_LINE(U, key, d, lines, fill, offset, buffer);                                \
+            }                                                                                        \
+            for (size_t d = 0; d < RADIX_SIZE; d++) {                                                \
+                memcpy(buffer + offset[d], lines[d], fill[d] * sizeof(U));                           \
+            }                                                                                        \
+        }                                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    /* 排序临时区中的各桶，结果写回原数组并变换回元素 */                                             \
+    static void radix_buckets_##W(long begin, long end, void* ctx) {                                 \
+        radix_job* job = (radix_job*)ctx;                                                            \
+        U* data = (U*)job->data;                                                                     \
+        U* buffer = (U*)job->buffer;                                                                 \
+        for (long d = begin; d < end; d++) {                                                         \
+            size_t start = job->buckets[d];                                                          \
+            size_t n = job->buckets[d + 1] - start;                                                  \
+            sort_keys_##W(buffer + start, data + start, n, job->top - 1, 1);                         \
+            if (job->kind != KEY_UNSIGNED) {                                                         \
+                for (size_t i = start; i < start + n; i++) {                                         \
+                    data[i] = decode_##W(data[i], job->kind);                                        \
+                }                                                                                    \
+            }                                                                                        \
+        }                                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    static error_code radix_sort_##W(U* data, size_t count, key_kind kind) {                         \
+        if (count <= SMALL_SORT) {                                                                   \
+            for (size_t i = 0; i < count; i++) {                                                     \
+                data[i] = encode_##W(data[i], kind);                                                 \
+            }                                                                                        \
+            insertion_sort_##W(data, count);                                                         \
+            for (size_t i = 0; i < count; i++) {                                                     \
+                data[i] = decode_##W(data[i], kind);                                                 \
+            }                                                                                        \
+            return ERR_OK;                                                                           \
+        }                                                                                            \
+        int threads = count >= PARALLEL_SORT ? thread_pool_size(NULL) : 1;                           \
+        radix_job job;                                                                               \
+        memset(&job, 0, sizeof(job));                                                                \
+        job.data = data;                                                                             \
+        job.count = count;                                                                           \
+        job.chunks = threads < 1 ? 1 : threads > MAX_SORT_CHUNKS ? MAX_SORT_CHUNKS : threads;        \
+        job.kind = kind;                                                                             \
+        size_t tables = (size_t)job.chunks * (2 * RADIX_SIZE + 2) + RADIX_SIZE + 1;                  \
+        if (count > (SIZE_MAX - tables * sizeof(size_t)) / sizeof(U)) {                              \
+            return error_raise(ERR_ARRAY_ALLOC, "数组过大");                                         \
+        }                                                                                            \
+        size_t* memory = (size_t*)malloc(tables * sizeof(size_t) + count * sizeof(U));               \
+        if (memory == NULL) {                                                                        \
+            return error_raise(ERR_ARRAY_ALLOC, "排序缓冲区分配失败");                               \
+        }                                                                                            \
+        job.counts = memory;                                                                         \
+        job.offsets = job.counts + (size_t)job.chunks * RADIX_SIZE;                                  \
+        job.key_or = (uint64_t*)(job.offsets + (size_t)job.chunks * RADIX_SIZE);                     \
+        job.key_and = job.key_or + job.chunks;                                                       \
+        job.buckets = (size_t*)(job.key_and + job.chunks);                                           \
+        job.buffer = job.buckets + RADIX_SIZE + 1;                                                   \
+        run_chunks(&job, job.chunks, radix_encode_##W);                                              \
+        uint64_t varying = 0;                                                                        \
+        for (long t = 0; t < job.chunks; t++) {                                                      \
+            varying |= (job.key_or[t] ^ job.key_and[t]) | (job.key_or[t] ^ job.key_or[0]);           \
+        }                                                                                            \
+        job.top = varying != 0 ? (63 - __builtin_clzll(varying)) / RADIX_BITS : -1;                  \
+        if (count * sizeof(U) <= CACHE_SORT_BYTES) {                                                 \
+            sort_keys_##W(data, (U*)job.buffer, count, job.top, 0);                                  \
+            for (size_t i = 0; i < count && kind != KEY_UNSIGNED; i++) {                             \
+                data[i] = decode_##W(data[i], kind);                                                 \
+            }                                                                                        \
+        } else if (varying != 0) {                                                                   \
+            run_chunks(&job, job.chunks, radix_count_##W);                                           \
+            size_t sum = 0;                                                                          \
+            for (size_t d = 0; d < RADIX_SIZE; d++) {                                                \
+                job.buckets[d] = sum;                                                                \
+                for (long t = 0; t < job.chunks; t++) {                                              \
+                    job.offsets[(size_t)t * RADIX_SIZE + d] = sum;                                   \
+                    sum += job.counts[(size_t)t * RADIX_SIZE + d];                                   \
+                }                                                                                    \
+            }                                                                                        \
+            job.buckets[RADIX_SIZE] = count;                                                         \
+            run_chunks(&job, job.chunks, radix_scatter_##W);                                         \
+            run_chunks(&job, RADIX_SIZE, radix_buckets_##W);                                         \
+        } else if (kind != KEY_UNSIGNED) {                                                           \
+            for (size_t i = 0; i < count; i++) {                                                     \
+                data[i] = decode_##W(data[i], kind);                                                 \
+            }                                                                                        \
+        }                                                                                            \
+        free(memory);                                                                                \
+        return ERR_OK;                                                                               \
+    }
+
+DEFINE_RADIX(32, key32)
+DEFINE_RADIX(64, key64)
+
+static error_code sort_int32(int32_t* data, size_t count) {
+    return radix_sort_32((key32*)data, count, KEY_SIGNED);
+}
+
+static error_code sort_int64(int64_t* data, size_t count) {
+    return radix_sort_64((key64*)data, count, KEY_SIGNED);
+}
+
+static error_code sort_uint64(uint64_t* data, size_t count) {
+    return radix_sort_64((key64*)data, count, KEY_UNSIGNED);
+}
+
+static error_code sort_double(double* data, size_t count) {
+    return radix_sort_64((key64*)data, count, KEY_FLOAT);
+}
+
+error_code array_sort_int32(int32_t* data, size_t count) {
+    debug_print("排序int32数组");
+    if (data == NULL && count > 0) {
+        return error_raise(ERR_ARRAY_NULL, "数组为NULL");
+    }
+    return sort_int32(data, count);
+}
+
+error_code array_sort_uint32(uint32_t* data, size_t count) {
+    debug_print("排序uint32数组");
+    if (data == NULL && count > 0) {
+        return error_raise(ERR_ARRAY_NULL, "数组为NULL");
+    }
+    return radix_sort_32((key32*)data, count, KEY_UNSIGNED);
+}
+
+error_code array_sort_int64(int64_t* data, size_t count) {
+    debug_print("排序int64数组");
+    if (data == NULL && count > 0) {
+        return error_raise(ERR_ARRAY_NULL, "数组为NULL");
+    }
+    return sort_int64(data, count);
+}
+
+error_code array_sort_uint64(uint64_t* data, size_t count) {
+    debug_print("排序uint64数组");
+    if (data == NULL && count > 0) {
+        return error_raise(ERR_ARRAY_NULL, "数组为NULL");
+    }
+    return sort_uint64(data, count);
+}
+
+error_code array_sort_double(double* data, size_t count) {
+    debug_print("排序double数组");
+    if (data == NULL && count > 0) {
+        return error_raise(ERR_ARRAY_NULL, "数组为NULL");
+    }
+    return sort_double(data, count);
+}
+
+/* ---------- 选择与百分位数 ---------- */
+
+#define SWAP(T, x, y)   \
+    do {                \
+        T swap_ = (x);  \
+        (x) = (y);      \
+        (y) = swap_;    \
+    } while (0)
+
+#define LN_2 0.6931471805599453
+
+/*
+ * v（不小于1）的degree次方根：从不小于根的2的幂起做牛顿迭代。只用于确定Floyd-Rivest的样本区间，
+ * 不必精确，也避免依赖libm
+ */
+static double approx_root(double v, int degree) {
+    int bits = 0;
+    while (bits < 63 && (double)(1ULL << bits) < v) {
+        bits++;
+    }
+    double x = (double)(1ULL << ((bits + degree - 1) / degree));
+    for (int i = 0; i < 6; i++) {
+        double power = degree == 2 ? x : x * x;
+        x = ((degree - 1) * x + v / power) / degree;
+    }
+    return x;
+}
+
+/*
+ * 在a[left..right]中选择第k小的元素（Floyd-Rivest）：区间较长时先在约n^(2/3)个元素的样本中
+ * 递归选择，使划分元素以很高的概率紧挨第k小；每轮至少缩小一个元素，轮数超过2*log2(n)+4时
+ * 说明划分元素一直选得不好，剩余区间改用基数排序
+ */
+#define DEFINE_SELECT(name, T, sort_fn)                                                           \
+    static error_code select_##name(T* a, long left, long right, long k) {                       \
+        int rounds = 0;                                                                           \
+        int max_rounds = 2 * (63 - __builtin_clzl((unsigned long)(right - left + 1))) + 4;        \
+        while (right > left) {                                                                    \
+            if (++rounds > max_rounds) {                                                          \
+                return sort_fn(a + left, (size_t)(right - left + 1));                             \
+            }                                                                                     \
+            if (right - left > SAMPLE_SELECT) {                                                   \
+                double n = (double)(right - left + 1);                                            \
+                double i = (double)(k - left + 1);                                                \
+                double z = LN_2 * (63 - __builtin_clzl((unsigned long)(right - left + 1)));       \
+                double cube_root = approx_root(n, 3);                                             \
+                double s = 0.5 * cube_root * cube_root;                                           \
+                double sd = 0.5 * approx_root(z * s * (n - s) / n, 2) * (i < n / 2 ? -1.0 : 1.0); \
+                long sample_left = (long)((double)k - i * s / n + sd);                            \
+                long sample_right = (long)((double)k + (n - i) * s / n + sd);                     \
+                error_code code = select_##name(a, sample_left > left ? sample_left : left,       \
+                                                sample_right < right ? sample_right : right, k);  \
+                if (code != ERR_OK) {                                                             \
+                    return code;                                                                  \
+                }                                                                                 \
+            }                                                                                     \
+            T pivot = a[k];                                                                       \
+            long i = left;                                                                        \
+            long j = right;                                                                       \
+            SWAP(T, a[left], a[k]);                                                               \
+            if (a[right] > pivot) {                                                               \
+                SWAP(T, a[right], a[left]);                                                       \
+            }                                                                                     \
+            while (i < j) {                                                                       \
+                SWAP(T, a[i], a[j]);                                                              \
+                i++;                                                                              \
+                j--;                                                                              \
+                while (a[i] < pivot) {                                                            \
+                    i++;                                                                          \
+                }                                                                                 \
+                while (a[j] > pivot) {                                                            \
+                    j--;                                                                          \
+                }                                                                                 \
+            }                                                                                     \
+            if (a[left] == pivot) {                                                               \
+                SWAP(T, a[left], a[j]);                                                           \
+            } else {                                                                              \
+                j++;                                                                              \
+                SWAP(T, a[j], a[right]);                                                          \
+            }                                                                                     \
+            if (j <= k) {                                                                         \
+                left = j + 1;                                                                     \
+            }                                                                                     \
+            if (k <= j) {                                                                         \
+                right = j - 1;                                                                    \
+            }                                                                                     \
+        }                                                                                         \
+        return ERR_OK;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    error_code array_select_##name(T* data, size_t count, size_t k, T* result) {                 \
+        debug_print("选择第k小的元素");                                                           \
+        if (data == NULL) {                                                                       \
+            return error_raise(ERR_ARRAY_NULL, "数组为NULL");                                     \
+        }                                                                                         \
+        if (k >= count) {                                                                         \
+            return error_raise(ERR_ARRAY_RANGE, "秩不小于元素个数");                              \
+        }                                                                                         \
+        error_code code = select_##name(data, 0, (long)count - 1, (long)k);                       \
+        if (code == ERR_OK && result != NULL) {                                                   \
+            *result = data[k];                                                                    \
+        }                                                                                         \
+        return code;                                                                              \
+    }
+
+DEFINE_SELECT(int32, int32_t, sort_int32)
+DEFINE_SELECT(int64, int64_t, sort_int64)
+DEFINE_SELECT(uint64, uint64_t, sort_uint64)
+DEFINE_SELECT(double, double, sort_double)
+
+/* 把百分位数换算为秩（从0起），order按秩升序排列百分位数的下标 */
+static error_code percentile_ranks(size_t count, const double* percentiles, size_t n, size_t* ranks,
+                                   size_t* order) {
+    for (size_t i = 0; i < n; i++) {
+        double p = percentiles[i];
+        if (!(p >= 0.0 && p <= 100.0)) {
+            return error_raise(ERR_ARRAY_RANGE, "百分位数不在0到100之间");
+        }
+        // 先乘后除，p * count为整数时没有舍入误差；秩为其向上取整，至少为1
+        double exact = p * (double)count / 100.0;
+        size_t rank = (size_t)exact;
+        rank += (double)rank < exact;
+        ranks[i] = rank < 1 ? 0 : rank >= count ? count - 1 : rank - 1;
+        size_t j = i;
+        for (; j > 0 && ranks[order[j - 1]] > ranks[i]; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+    return ERR_OK;
+}
+
+/*
+ * 按秩从小到大选择：选出第k小后，其右侧恰为最大的count - k - 1个元素，下一个秩只需在右侧选择。
+ * 之后的选择会重新排列右侧，所以每选出一个就立即取出结果
+ */
+#define DEFINE_PERCENTILES(name, T, sort_fn)                                                      \
+    error_code array_percentiles_##name(T* data, size_t count, const double* percentiles, size_t n, \
+                                        T* results) {                                             \
+        debug_print("计算百分位数");                                                              \
+        if ((data == NULL && count > 0) || percentiles == NULL || results == NULL) {              \
+            return error_raise(ERR_ARRAY_NULL, "参数为NULL");                                     \
+        }                                                                                         \
+        if (count == 0 || n > ARRAY_MAX_PERCENTILES) {                                            \
+            return error_raise(ERR_ARRAY_RANGE, "数组为空或百分位数过多");                        \
+        }                                                                                         \
+        size_t ranks[ARRAY_MAX_PERCENTILES];                                                      \
+        size_t order[ARRAY_MAX_PERCENTILES];                                                      \
+        error_code code = percentile_ranks(count, percentiles, n, ranks, order);                  \
+        if (code != ERR_OK) {                                                                     \
+            return code;                                                                          \
+        }                                                                                         \
+        if (n > PERCENTILES_BY_SELECT) {                                                          \
+            code = sort_fn(data, count);                                                          \
+            for (size_t i = 0; i < n && code == ERR_OK; i++) {                                    \
+                results[i] = data[ranks[i]];                                                      \
+            }                                                                                     \
+            return code;                                                                          \
+        }                                                                                         \
+        size_t left = 0;                                                                          \
+        for (size_t i = 0; i < n && code == ERR_OK; i++) {                                        \
+            size_t k = ranks[order[i]];                                                           \
+            if (k >= left) {                                                                      \
+                code = select_##name(data, (long)left, (long)count - 1, (long)k);                 \
+                left = k + 1;                                                                     \
+            }                                                                                     \
+            results[order[i]] = data[k];                                                          \
+        }                                                                                         \
+        return code;                                                                              \
+    }
+
+DEFINE_PERCENTILES(int32, int32_t, sort_int32)
+DEFINE_PERCENTILES(int64, int64_t, sort_int64)
+DEFINE_PERCENTILES(double, double, sort_double)
+
+/* ---------- 有序查找 ---------- */
+
+/* p[0..15]中小于key的元素对应的位 */
+__attribute__((target("avx2")))
+static uint32_t less_mask_32_avx2(const int32_t* p, int32_t key) {
+    __m256i k = _mm256_set1_epi32(key);
+    __m256i lo = _mm256_cmpgt_epi32(k, _mm256_loadu_si256((const __m256i*)p));
+    __m256i hi = _mm256_cmpgt_epi32(k, _mm256_loadu_si256((const __m256i*)(p + 8)));
+    return (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(lo)) |
+           (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(hi)) << 8;
+}
+
+/* p[0..7]中小于key的元素对应的位 */
+__attribute__((target("avx2")))
+static uint32_t less_mask_64_avx2(const int64_t* p, int64_t key) {
+    __m256i k = _mm256_set1_epi64x(key);
+    __m256i lo = _mm256_cmpgt_epi64(k, _mm256_loadu_si256((const __m256i*)p));
+    __m256i hi = _mm256_cmpgt_epi64(k, _mm256_loadu_si256((const __m256i*)(p + 4)));
+    return (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(lo)) |
+           (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(hi)) << 4;
+}
+
+/*
+ * 无分支地二分，保持结果在[base, base + n]中：base[half] < key时结果至少为base + half + 1，
+ * 否则不超过base + half。n不超过block后，结果为base加上base[0..n)中小于key的个数。
+ * 每轮预取下一轮两种可能的探测位置，使访存与比较重叠
+ */
+#define DEFINE_LOWER_BOUND(name, T, block, less_mask)                                            \
+    size_t array_lower_bound_##name(const T* data, size_t count, T key) {                        \
+        if (data == NULL) {                                                                      \
+            return 0;                                                                            \
+        }                                                                                        \
+        ensure_tables();                                                                         \
+        const T* base = data;                                                                    \
+        size_t n = count;                                                                        \
+        while (n > block) {                                                                      \
+            size_t half = n / 2;                                                                 \
+            size_t next = (n - half) / 2;                                                        \
+            __builtin_prefetch(base + next);                                                     \
+            __builtin_prefetch(base + half + next);                                              \
+            base = base[half] < key ? base + half : base;                                        \
+            n -= half;                                                                           \
+        }                                                                                        \
+        size_t index = (size_t)(base - data);                                                    \
+        if (has_avx2 && count >= block) {                                                        \
+            /* 比较以base起的整个块，块超出数组末尾时向前移，再屏蔽不在[base, base + n)中的位 */ \
+            size_t start = index + block <= count ? index : count - block;                       \
+            uint32_t valid = (uint32_t)((1ULL << n) - 1) << (index - start);                     \
+            return index + (size_t)__builtin_popcount(less_mask(data + start, key) & valid);     \
+        }                                                                                        \
+        size_t less = 0;                                                                         \
+        for (size_t i = 0; i < n; i++) {                                                         \
+            less += base[i] < key;                                                               \
+        }                                                                                        \
+        return index + less;                                                                     \
+    }
+
+DEFINE_LOWER_BOUND(int32, int32_t, SEARCH_BLOCK_32, less_mask_32_avx2)
+DEFINE_LOWER_BOUND(int64, int64_t, SEARCH_BLOCK_64, less_mask_64_avx2)
+
+static int module_init(void) {
+    ensure_tables();
+    debug_print(has_avx2 ? "有序查找使用AVX2比较" : "有序查找使用标量比较");
+    debug_print("数组算法模块初始化成功");
+    return 1;
+}
+
+int initialize_array_ops() {
+    return module_init_once(MODULE_ARRAY, module_init);
+}
\ No newline at end of file
@@ -0,0 +1,1273 @@
+/**
+ * @file bignum_ops.c
+ * @brief 任意精度整数实现
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../include/bignum_ops.h"
+#include "../include/module.h"
+#include "../include/utils.h"
+#include "../include/allocator.h"
+
+typedef unsigned __int128 u128;
+
+/* 较短的乘数达到该limb数时用Karatsuba */
+#define KARATSUBA_THRESHOLD 32
+/* 两个乘数都达到该limb数时用数论变换 */
+#define NTT_THRESHOLD 1000
+/* 除数与商都达到该limb数时以牛顿迭代求倒数，把除法化为乘法 */
+#define NEWTON_THRESHOLD 400
+
+/* 数论变换的模数p = 2^64 - 2^32 + 1，2^64 ≡ 2^32 - 1 (mod p)，乘法群的生成元为7 */
+#define NTT_PRIME 0xffffffff00000001ULL
+#define NTT_EPSILON 0xffffffffULL
+#define NTT_GENERATOR 7
+/* p - 1 = 2^32 * (2^32 - 1)，变换长度不超过2^32 */
+#define NTT_MAX_LOG 32
+/* 乘数拆成的每段的最大位数 */
+#define NTT_MAX_PIECE_BITS 30
+#define NTT_MIN_PIECE_BITS 8
+
+/* 每个limb对应的十进制位数，10^19 < 2^64 */
+#define DECIMAL_DIGITS 19
+#define DECIMAL_BASE 10000000000000000000ULL
+/* 十进制转换中不超过该limb数的部分逐次除以（乘以）10^19 */
+#define DECIMAL_BASECASE 32
+/* 十进制转换缓存的10^(19*2^k)的级数上限 */
+#define DECIMAL_LEVELS 48
+
+/* 阶乘的乘积树中不超过该个数的因子直接逐个相乘 */
+#define FACTORIAL_LEAF 64
+
+/* 内存池按块长2^level分级，每级每个线程最多缓存POOL_MAX_CACHED块，不缓存超过2^POOL_MAX_LEVEL个limb的块 */
+#define POOL_LEVELS 60
+#define POOL_MAX_CACHED 4
+#define POOL_MAX_LEVEL 22
+
+/* ---------- 临时空间内存池 ---------- */
+
+typedef struct {
+    uint64_t* free_blocks[POOL_LEVELS];   /* 空闲块以第一个limb串成链表 */
+    int cached[POOL_LEVELS];
+    uint64_t* roots[2];                   /* 数论变换的单位根表（正、逆），见ntt_root_table */
+    size_t root_length;
+} limb_pool;
+
+static pthread_key_t pool_key;
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static __thread limb_pool* thread_limb_pool = NULL;
+
+static void release_pool(void* arg) {
+    limb_pool* pool = (limb_pool*)arg;
+    for (int level = 0; level < POOL_LEVELS; level++) {
+        uint64_t* block = pool->free_blocks[level];
+        while (block != NULL) {
+            uint64_t* next = (uint64_t*)(uintptr_t)block[0];
+            free(block - 1);
+            block = next;
+        }
+    }
+    free(pool->roots[0]);
+    free(pool->roots[1]);
+    free(pool);
+    thread_limb_pool = NULL;
+}
+
+static void create_pool_key(void) {
+    pthread_key_create(&pool_key, release_pool);
+}
+
+static limb_pool* current_pool(void) {
+    if (thread_limb_pool == NULL) {
+        pthread_once(&pool_once, create_pool_key);
+        thread_limb_pool = (limb_pool*)calloc(1, sizeof(limb_pool));
+        if (thread_limb_pool != NULL) {
+            pthread_setspecific(pool_key, thread_limb_pool);
+        }
+    }
+    return thread_limb_pool;
+}
+
+/* 分配至少n个limb的临时空间，块前的一个limb记录块的级别；失败返回NULL */
+static uint64_t* pool_alloc(size_t n) {
+    int level = n <= 1 ? 0 : 64 - __builtin_clzll((unsigned long long)(n - 1));
+    if (level >= POOL_LEVELS) {
+        return NULL;
+    }
+    limb_pool* pool = current_pool();
+    if (pool != NULL && pool->free_blocks[level] != NULL) {
+        uint64_t* block = pool->free_blocks[level];
+        pool->free_blocks[level] = (uint64_t*)(uintptr_t)block[0];
+        pool->cached[level]--;
+        return block;
+    }
+    uint64_t* block = (uint64_t*)malloc((((size_t)1 << level) + 1) * sizeof(uint64_t));
+    if (block == NULL) {
+        return NULL;
+    }
+    block[0] = (uint64_t)level;
+    return block + 1;
+}
+
+static void pool_free(uint64_t* block) {
+    if (block == NULL) {
+        return;
+    }
+    int level = (int)block[-1];
+    limb_pool* pool = current_pool();
+    if (pool == NULL || level > POOL_MAX_LEVEL || pool->cached[level] >= POOL_MAX_CACHED) {
+        free(block - 1);
+        return;
+    }
+    block[0] = (uint64_t)(uintptr_t)pool->free_blocks[level];
+    pool->free_blocks[level] = block;
+    pool->cached[level]++;
+}
+
+/* ---------- limb向量的基本运算 ---------- */
+
+static size_t limbs_normalize(const uint64_t* a, size_t n) {
+    while (n > 0 && a[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+/* 去掉了高位0的limb向量的二进制位数 */
+static size_t limbs_bits(const uint64_t* a, size_t n) {
+    return n > 0 ? n * 64 - (size_t)__builtin_clzll(a[n - 1]) : 0;
+}
+
+/* 比较两个去掉了高位0的limb向量 */
+static int limbs_cmp(const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    if (an != bn) {
+        return an < bn ? -1 : 1;
+    }
+    for (size_t i = an; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/* r[0..an) = a + b，an >= bn，返回进位；r可以与a或b相同 */
+static uint64_t limbs_add(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < bn; i++) {
+        u128 sum = (u128)a[i] + b[i] + carry;
+        r[i] = (uint64_t)sum;
+        carry = (uint64_t)(sum >> 64);
+    }
+    for (; i < an; i++) {
+        uint64_t sum = a[i] + carry;
+        carry = sum < carry;
+        r[i] = sum;
+    }
+    return carry;
+}
+
+/* r[0..an) = a - b，an >= bn，返回借位；r可以与a或b相同 */
+static uint64_t limbs_sub(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < bn; i++) {
+        uint64_t x = a[i], y = b[i];
+        uint64_t diff = x - y - borrow;
+        borrow = (x < y) | ((x - y) < borrow);
+        r[i] = diff;
+    }
+    for (; i < an; i++) {
+        uint64_t x = a[i];
+        r[i] = x - borrow;
+        borrow = x < borrow;
+    }
+    return borrow;
+}
+
+/* r[0..n) = a * m + add，返回最高的limb；r可以与a相同 */
+static uint64_t limbs_mul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m, uint64_t add) {
+    uint64_t carry = add;
+    for (size_t i = 0; i < n; i++) {
+        u128 t = (u128)a[i] * m + carry;
+        r[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+    return carry;
+}
+
+/* r[0..n) += a * m，返回进位 */
+static uint64_t limbs_addmul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        u128 t = (u128)a[i] * m + r[i] + carry;
+        r[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+    return carry;
+}
+
+/* r[0..n) -= a * m，返回借位 */
+static uint64_t limbs_submul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        u128 t = (u128)a[i] * m + borrow;
+        uint64_t lo = (uint64_t)t;
+        borrow = (uint64_t)(t >> 64) + (r[i] < lo);
+        r[i] -= lo;
+    }
+    return borrow;
+}
+
+/* r[0..n) = a << shift，0 <= shift < 64，返回移出的高位 */
+static uint64_t limbs_shift_left(uint64_t* r, const uint64_t* a, size_t n, int shift) {
+    if (shift == 0) {
+        memmove(r, a, n * sizeof(uint64_t));
+        return 0;
+    }
+    uint64_t out = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t x = a[i];
+        r[i] = (x << shift) | out;
+        out = x >> (64 - shift);
+    }
+    return out;
+}
+
+/* r[0..n) = a >> shift，0 <= shift < 64 */
+static void limbs_shift_right(uint64_t* r, const uint64_t* a, size_t n, int shift) {
+    if (shift == 0) {
+        memmove(r, a, n * sizeof(uint64_t));
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        r[i] = (a[i] >> shift) | (i + 1 < n ? a[i + 1] << (64 - shift) : 0);
+    }
+}
+
+/* 128位除以64位，要求hi < d */
+static inline uint64_t div_2by1(uint64_t hi, uint64_t lo, uint64_t d, uint64_t* rem) {
+#if defined(__x86_64__)
+    uint64_t q;
+    __asm__("divq %4" : "=a"(q), "=d"(*rem) : "a"(lo), "d"(hi), "rm"(d));
+    return q;
+#else
+    u128 n = ((u128)hi << 64) | lo;
+    *rem = (uint64_t)(n % d);
+    return (uint64_t)(n / d);
+#endif
+}
+
+/* q[0..n) = a / d，返回余数；q可以与a相同 */
+static uint64_t limbs_divrem_1(uint64_t* q, const uint64_t* a, size_t n, uint64_t d) {
+    uint64_t rem = 0;
+    for (size_t i = n; i-- > 0;) {
+        q[i] = div_2by1(rem, a[i], d, &rem);
+    }
+    return rem;
+}
+
+/* ---------- 乘法 ---------- */
+
+static int limbs_mul(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn);
+
+/* 朴素乘法，r有an + bn个limb */
+static void mul_basecase(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    r[an] = limbs_mul_1(r, a, an, b[0], 0);
+    for (size_t j = 1; j < bn; j++) {
+        r[an + j] = limbs_addmul_1(r + j, a, an, b[j]);
+    }
+}
+
+/*
+ * Karatsuba：以h = ceil(an/2)拆分a = a1*β^h + a0、b = b1*β^h + b0（β = 2^64），
+ * a*b = z2*β^(2h) + ((a0+a1)(b0+b1) - z0 - z2)*β^h + z0，三次递归乘法。要求an >= bn > h。
+ */
+static int mul_karatsuba(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    size_t h = (an + 1) / 2;
+    size_t zn = 2 * h + 2;
+    uint64_t* temp = pool_alloc(2 * (h + 1) + zn);
+    if (temp == NULL) {
+        return 0;
+    }
+    uint64_t* sa = temp;
+    uint64_t* sb = sa + h + 1;
+    uint64_t* z1 = sb + h + 1;
+    sa[h] = limbs_add(sa, a, h, a + h, an - h);
+    sb[h] = limbs_add(sb, b, h, b + h, bn - h);
+    size_t san = limbs_normalize(sa, h + 1);
+    size_t sbn = limbs_normalize(sb, h + 1);
+    int ok = limbs_mul(r, a, h, b, h) && limbs_mul(r + 2 * h, a + h, an - h, b + h, bn - h) &&
+             limbs_mul(z1, sa, san, sb, sbn);
+    if (ok) {
+        memset(z1 + san + sbn, 0, (zn - san - sbn) * sizeof(uint64_t));
+        limbs_sub(z1, z1, zn, r, 2 * h);
+        limbs_sub(z1, z1, zn, r + 2 * h, an + bn - 2 * h);
+        limbs_add(r + h, r + h, an + bn - h, z1, limbs_normalize(z1, zn));
+    }
+    pool_free(temp);
+    return ok;
+}
+
+/* 长度相差较大时把a按bn个limb分段，各段乘以b后累加；an >= bn */
+static int mul_unbalanced(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    uint64_t* temp = pool_alloc(2 * bn);
+    if (temp == NULL) {
+        return 0;
+    }
+    int ok = limbs_mul(r, a, bn, b, bn);
+    memset(r + 2 * bn, 0, (an - bn) * sizeof(uint64_t));
+    for (size_t done = bn; ok && done < an; done += bn) {
+        size_t chunk = an - done < bn ? an - done : bn;
+        ok = limbs_mul(temp, a + done, chunk, b, bn);
+        if (ok) {
+            limbs_add(r + done, r + done, an + bn - done, temp, chunk + bn);
+        }
+    }
+    pool_free(temp);
+    return ok;
+}
+
+/* 模p约简128位的值；进位与借位的修正写成掩码，随机数据上没有难以预测的分支 */
+static inline uint64_t ntt_reduce(u128 x) {
+    uint64_t lo = (uint64_t)x;
+    uint64_t hi = (uint64_t)(x >> 64);
+    uint64_t hi_hi = hi >> 32;
+    uint64_t hi_lo = hi & NTT_EPSILON;
+    // x = lo + hi_lo*2^64 + hi_hi*2^96，2^64 ≡ 2^32 - 1，2^96 ≡ -1
+    uint64_t t = lo - hi_hi;
+    t -= NTT_EPSILON & (0 - (uint64_t)(lo < hi_hi));
+    uint64_t u = hi_lo * NTT_EPSILON;
+    uint64_t s = t + u;
+    s += NTT_EPSILON & (0 - (uint64_t)(s < u));
+    return s >= NTT_PRIME ? s - NTT_PRIME : s;
+}
+
+static inline uint64_t ntt_mul(uint64_t a, uint64_t b) {
+    return ntt_reduce((u128)a * b);
+}
+
+/* a + b - p，不够减时加回p */
+static inline uint64_t ntt_add(uint64_t a, uint64_t b) {
+    uint64_t c = NTT_PRIME - b;
+    return a - c + (NTT_PRIME & (0 - (uint64_t)(a < c)));
+}
+
+static inline uint64_t ntt_sub(uint64_t a, uint64_t b) {
+    return a - b + (NTT_PRIME & (0 - (uint64_t)(a < b)));
+}
+
+static uint64_t ntt_pow(uint64_t base, uint64_t exponent) {
+    uint64_t result = 1;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result = ntt_mul(result, base);
+        }
+        base = ntt_mul(base, base);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+/* 按级连续存放的单位根：roots[len + j] = w^j，w为2*len次单位根（逆变换用其逆元），0 <= j < len */
+static void ntt_roots(uint64_t* roots, size_t n, int inverse) {
+    uint64_t w = ntt_pow(NTT_GENERATOR, (NTT_PRIME - 1) / n);
+    if (inverse) {
+        w = ntt_pow(w, NTT_PRIME - 2);
+    }
+    size_t half = n / 2;
+    roots[half] = 1;
+    for (size_t j = 1; j < half; j++) {
+        roots[half + j] = ntt_mul(roots[half + j - 1], w);
+    }
+    for (size_t len = half / 2; len >= 1; len /= 2) {
+        for (size_t j = 0; j < len; j++) {
+            roots[len + j] = roots[2 * len + 2 * j];
+        }
+    }
+}
+
+/* 本线程缓存的单位根表；roots[len + j]与变换长度无关，长为n的表可用于所有不超过n的变换 */
+static const uint64_t* ntt_root_table(size_t n, int inverse) {
+    limb_pool* pool = current_pool();
+    if (pool == NULL) {
+        return NULL;
+    }
+    if (pool->root_length < n) {
+        uint64_t* forward = (uint64_t*)malloc(n * sizeof(uint64_t));
+        uint64_t* backward = (uint64_t*)malloc(n * sizeof(uint64_t));
+        if (forward == NULL || backward == NULL) {
+            free(forward);
+            free(backward);
+            return NULL;
+        }
+        ntt_roots(forward, n, 0);
+        ntt_roots(backward, n, 1);
+        free(pool->roots[0]);
+        free(pool->roots[1]);
+        pool->roots[0] = forward;
+        pool->roots[1] = backward;
+        pool->root_length = n;
+    }
+    return pool->roots[inverse];
+}
+
+/* 频域抽取的正变换，输入为自然顺序，输出为位反转顺序 */
+static void ntt_forward(uint64_t* x, size_t n, const uint64_t* roots) {
+    for (size_t len = n / 2; len >= 1; len /= 2) {
+        const uint64_t* w = roots + len;
+        for (size_t s = 0; s < n; s += 2 * len) {
+            uint64_t* lo = x + s;
+            uint64_t* hi = lo + len;
+            for (size_t j = 0; j < len; j++) {
+                uint64_t u = lo[j], v = hi[j];
+                lo[j] = ntt_add(u, v);
+                hi[j] = ntt_mul(ntt_sub(u, v), w[j]);
+            }
+        }
+    }
+}
+
+/* 时域抽取的逆变换，输入为位反转顺序，输出为自然顺序（未除以n） */
+static void ntt_inverse(uint64_t* x, size_t n, const uint64_t* roots) {
+    for (size_t len = 1; len < n; len *= 2) {
+        const uint64_t* w = roots + len;
+        for (size_t s = 0; s < n; s += 2 * len) {
+            uint64_t* lo = x + s;
+            uint64_t* hi = lo + len;
+            for (size_t j = 0; j < len; j++) {
+                uint64_t u = lo[j], v = ntt_mul(hi[j], w[j]);
+                lo[j] = ntt_add(u, v);
+                hi[j] = ntt_sub(u, v);
+            }
+        }
+    }
+}
+
+/* 选择每段的位数：卷积的每一项小于min(段数) * 2^(2*bits)，须小于p；不可行返回0 */
+static int ntt_piece_bits(size_t an, size_t bn, size_t* length) {
+    for (int bits = NTT_MAX_PIECE_BITS; bits >= NTT_MIN_PIECE_BITS; bits--) {
+        size_t pa = (an * 64 + (size_t)bits - 1) / (size_t)bits;
+        size_t pb = (bn * 64 + (size_t)bits - 1) / (size_t)bits;
+        size_t shorter = pa < pb ? pa : pb;
+        if (shorter > ((size_t)1 << (63 - 2 * bits))) {
+            continue;
+        }
+        size_t n = 1;
+        while (n < pa + pb - 1) {
+            n <<= 1;
+        }
+        if (n > ((size_t)1 << NTT_MAX_LOG)) {
+            return 0;
+        }
+        *length = n;
+        return bits;
+    }
+    return 0;
+}
+
+/* 把a拆成pieces段、每段bits位，写入out[0..n)，其余补0 */
+static void ntt_split(uint64_t* out, size_t n, const uint64_t* a, size_t an, int bits) {
+    uint64_t mask = ((uint64_t)1 << bits) - 1;
+    size_t pieces = (an * 64 + (size_t)bits - 1) / (size_t)bits;
+    size_t bit = 0;
+    for (size_t i = 0; i < pieces; i++, bit += (size_t)bits) {
+        size_t limb = bit >> 6;
+        unsigned int offset = (unsigned int)(bit & 63);
+        uint64_t value = a[limb] >> offset;
+        if (offset + (unsigned int)bits > 64 && limb + 1 < an) {
+            value |= a[limb + 1] << (64 - offset);
+        }
+        out[i] = value & mask;
+    }
+    memset(out + pieces, 0, (n - pieces) * sizeof(uint64_t));
+}
+
+/* 卷积结果c[i]的权为2^(i*bits)，进位后写入r[0..rn) */
+static void ntt_combine(uint64_t* r, size_t rn, const uint64_t* c, size_t count, int bits) {
+    uint64_t mask = ((uint64_t)1 << bits) - 1;
+    memset(r, 0, rn * sizeof(uint64_t));
+    u128 carry = 0;
+    size_t bit = 0;
+    for (size_t i = 0; bit < rn * 64; i++, bit += (size_t)bits) {
+        if (i < count) {
+            carry += c[i];
+        } else if (carry == 0) {
+            break;
+        }
+        uint64_t piece = (uint64_t)carry & mask;
+        carry >>= bits;
+        size_t limb = bit >> 6;
+        unsigned int offset = (unsigned int)(bit & 63);
+        r[limb] |= piece << offset;
+        if (offset + (unsigned int)bits > 64 && limb + 1 < rn) {
+            r[limb + 1] |= piece >> (64 - offset);
+        }
+    }
+}
+
+/* 模p的数论变换乘法：乘数拆成bits位一段，卷积的各项不超过p，不需要中国剩余定理；平方只做一次正变换 */
+static int mul_ntt(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn, int bits, size_t n) {
+    int square = a == b && an == bn;
+    uint64_t* fa = pool_alloc(n);
+    uint64_t* fb = square ? fa : pool_alloc(n);
+    const uint64_t* roots = ntt_root_table(n, 0);
+    const uint64_t* inverse_roots = ntt_root_table(n, 1);
+    if (fa == NULL || fb == NULL || roots == NULL || inverse_roots == NULL) {
+        pool_free(fa);
+        if (!square) {
+            pool_free(fb);
+        }
+        return 0;
+    }
+    ntt_split(fa, n, a, an, bits);
+    ntt_forward(fa, n, roots);
+    if (!square) {
+        ntt_split(fb, n, b, bn, bits);
+        ntt_forward(fb, n, roots);
+    }
+    uint64_t scale = ntt_pow((uint64_t)n, NTT_PRIME - 2);
+    for (size_t i = 0; i < n; i++) {
+        fa[i] = ntt_mul(ntt_mul(fa[i], fb[i]), scale);
+    }
+    ntt_inverse(fa, n, inverse_roots);
+    size_t pieces = (an * 64 + (size_t)bits - 1) / (size_t)bits + (bn * 64 + (size_t)bits - 1) / (size_t)bits - 1;
+    ntt_combine(r, an + bn, fa, pieces, bits);
+    pool_free(fa);
+    if (!square) {
+        pool_free(fb);
+    }
+    return 1;
+}
+
+/* r[0..an+bn) = a * b，r不能与a或b重叠；内存分配失败返回0 */
+static int limbs_mul(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    if (an < bn) {
+        const uint64_t* t = a;
+        a = b;
+        b = t;
+        size_t tn = an;
+        an = bn;
+        bn = tn;
+    }
+    if (bn == 0) {
+        memset(r, 0, an * sizeof(uint64_t));
+        return 1;
+    }
+    if (bn < KARATSUBA_THRESHOLD) {
+        mul_basecase(r, a, an, b, bn);
+        return 1;
+    }
+    size_t length = 0;
+    int bits = bn >= NTT_THRESHOLD ? ntt_piece_bits(an, bn, &length) : 0;
+    if (bits > 0) {
+        return mul_ntt(r, a, an, b, bn, bits, length);
+    }
+    if (bn <= (an + 1) / 2) {
+        return mul_unbalanced(r, a, an, b, bn);
+    }
+    return mul_karatsuba(r, a, an, b, bn);
+}
+
+/* ---------- 除法 ---------- */
+
+/* Knuth算法D：q[0..an-bn] = a / b，rem[0..bn) = a % b；an >= bn >= 2，b的最高limb不为0 */
+static int divrem_knuth(uint64_t* q, uint64_t* rem, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    uint64_t* u = pool_alloc(an + 1 + bn);
+    if (u == NULL) {
+        return 0;
+    }
+    uint64_t* v = u + an + 1;
+    int shift = __builtin_clzll(b[bn - 1]);
+    limbs_shift_left(v, b, bn, shift);
+    u[an] = limbs_shift_left(u, a, an, shift);
+    uint64_t vtop = v[bn - 1], vnext = v[bn - 2];
+    for (size_t j = an - bn + 1; j-- > 0;) {
+        uint64_t qhat, rhat;
+        int check = 1;
+        if (u[j + bn] >= vtop) {
+            // 余数的最高limb等于除数的最高limb，商的估计为β-1
+            qhat = UINT64_MAX;
+            rhat = u[j + bn - 1] + vtop;
+            check = rhat >= vtop;
+        } else {
+            qhat = div_2by1(u[j + bn], u[j + bn - 1], vtop, &rhat);
+        }
+        while (check && (u128)qhat * vnext > (((u128)rhat << 64) | u[j + bn - 2])) {
+            qhat--;
+            rhat += vtop;
+            check = rhat >= vtop;
+        }
+        uint64_t borrow = limbs_submul_1(u + j, v, bn, qhat);
+        uint64_t top = u[j + bn];
+        u[j + bn] = top - borrow;
+        if (top < borrow) {
+            qhat--;
+            u[j + bn] += limbs_add(u + j, u + j, bn, v, bn);
+        }
+        q[j] = qhat;
+    }
+    limbs_shift_right(rem, u, bn, shift);
+    pool_free(u);
+    return 1;
+}
+
+/*
+ * inv[0..n]近似floor((β^(2n) - 1) / b)，相差不超过几个单位；b有n个limb且最高limb不为0。
+ * 以b的高h个limb的倒数top为初值x = top*β^(n-h)，做一次牛顿迭代x' = x + x*(β^(2n) - b*x)/β^(2n)。
+ * 初值的相对误差约为β^(1-h)，迭代后平方，h取n/2 + 2时绝对误差只剩几个单位；修正项只用误差的高位，
+ * 每级代价为一次n*n/2和一次n/2*n/2的乘法。
+ */
+static int limbs_reciprocal(uint64_t* inv, const uint64_t* b, size_t n) {
+    if (n < NEWTON_THRESHOLD) {
+        uint64_t* ones = pool_alloc(3 * n);
+        if (ones == NULL) {
+            return 0;
+        }
+        memset(ones, 0xff, 2 * n * sizeof(uint64_t));
+        int ok = 1;
+        if (n == 1) {
+            limbs_divrem_1(inv, ones, 2, b[0]);
+        } else {
+            ok = divrem_knuth(inv, ones + 2 * n, ones, 2 * n, b, n);
+        }
+        pool_free(ones);
+        return ok;
+    }
+    size_t h = n / 2 + 2;
+    size_t low = n - h;
+    size_t pn = n + h + 1;
+    uint64_t* top = pool_alloc(h + 1);
+    uint64_t* prod = pool_alloc(pn);             // b * top
+    uint64_t* corr = pool_alloc(h + 1 + pn);     // top * err
+    uint64_t* x = pool_alloc(n + 2);
+    int ok = top != NULL && prod != NULL && corr != NULL && x != NULL && limbs_reciprocal(top, b + low, h) &&
+             limbs_mul(prod, b, n, top, h + 1);
+    if (ok) {
+        // b*x = prod*β^low，err = |β^(n+h) - prod|，x*(β^(2n) - b*x)/β^(2n) = ±top*err/β^(2h)
+        int above = prod[n + h] != 0;
+        if (above) {
+            prod[n + h] -= 1;
+        } else {
+            for (size_t i = 0; i < n + h; i++) {
+                prod[i] = ~prod[i];
+            }
+            limbs_add(prod, prod, n + h + 1, (const uint64_t[]){1}, 1);
+        }
+        // 舍去err的低h-2个limb，引入的误差小于1
+        size_t skip = h - 2;
+        size_t en = limbs_normalize(prod + skip, pn - skip);
+        memset(x, 0, (n + 2) * sizeof(uint64_t));
+        memcpy(x + low, top, (h + 1) * sizeof(uint64_t));
+        if (en > 0) {
+            ok = limbs_mul(corr, top, h + 1, prod + skip, en);
+        }
+        if (ok && en > 0) {
+            size_t cn = limbs_normalize(corr, h + 1 + en);
+            size_t shift = 2 * h - skip;
+            size_t dn = cn > shift ? cn - shift : 0;
+            if (above) {
+                limbs_sub(x, x, n + 2, corr + shift, dn);
+                limbs_sub(x, x, n + 2, (const uint64_t[]){1}, 1);
+            } else {
+                limbs_add(x, x, n + 2, corr + shift, dn);
+            }
+        }
+    }
+    if (ok) {
+        if (x[n + 1] != 0) {
+            // 真值不超过β^(n+1) - 1
+            memset(inv, 0xff, (n + 1) * sizeof(uint64_t));
+        } else {
+            memcpy(inv, x, (n + 1) * sizeof(uint64_t));
+        }
+    }
+    pool_free(top);
+    pool_free(prod);
+    pool_free(corr);
+    pool_free(x);
+    return ok;
+}
+
+/*
+ * 以近似倒数inv做除法：a有an <= 2n个limb且a < b*β^n，q[0..n] = a / b，rem[0..n) = a % b。
+ * 商的估计floor(floor(a/β^(n-1)) * inv / β^(n+1))与真值相差几个单位，由余数双向修正。
+ */
+static int divrem_reciprocal(uint64_t* q, uint64_t* rem, const uint64_t* a, size_t an, const uint64_t* b,
+                             size_t n, const uint64_t* inv) {
+    memset(q, 0, (n + 1) * sizeof(uint64_t));
+    an = limbs_normalize(a, an);
+    if (an < n) {
+        memmove(rem, a, an * sizeof(uint64_t));
+        memset(rem + an, 0, (n - an) * sizeof(uint64_t));
+        return 1;
+    }
+    size_t hn = an - (n - 1);
+    uint64_t* prod = pool_alloc(hn + n + 1);
+    uint64_t* r = pool_alloc(an + 1);
+    int ok = prod != NULL && r != NULL && limbs_mul(prod, a + n - 1, hn, inv, n + 1);
+    size_t mn = 0;
+    if (ok) {
+        size_t qn = limbs_normalize(prod + n + 1, hn);
+        memcpy(q, prod + n + 1, qn * sizeof(uint64_t));
+        if (qn > 0) {
+            ok = limbs_mul(prod, q, qn, b, n);
+            mn = limbs_normalize(prod, qn + n);
+        }
+    }
+    if (ok) {
+        while (limbs_cmp(prod, mn, a, an) > 0) {
+            limbs_sub(prod, prod, mn, b, n);
+            mn = limbs_normalize(prod, mn);
+            limbs_sub(q, q, n + 1, (const uint64_t[]){1}, 1);
+        }
+        memcpy(r, a, an * sizeof(uint64_t));
+        limbs_sub(r, r, an, prod, mn);
+        size_t rn = limbs_normalize(r, an);
+        while (limbs_cmp(r, rn, b, n) >= 0) {
+            limbs_sub(r, r, rn, b, n);
+            rn = limbs_normalize(r, rn);
+            limbs_add(q, q, n + 1, (const uint64_t[]){1}, 1);
+        }
+        memcpy(rem, r, rn * sizeof(uint64_t));
+        memset(rem + rn, 0, (n - rn) * sizeof(uint64_t));
+    }
+    pool_free(prod);
+    pool_free(r);
+    return ok;
+}
+
+/* q[0..an-bn] = a / b，rem[0..bn) = a % b；an >= bn >= 1，b的最高limb不为0 */
+static int limbs_divrem(uint64_t* q, uint64_t* rem, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    if (bn == 1) {
+        rem[0] = limbs_divrem_1(q, a, an, b[0]);
+        return 1;
+    }
+    if (bn < NEWTON_THRESHOLD || an - bn < NEWTON_THRESHOLD) {
+        return divrem_knuth(q, rem, a, an, b, bn);
+    }
+    // 以β^bn为基数做长除法，每一步是2bn个limb除以bn个limb
+    size_t qn = an - bn + 1;
+    uint64_t* inv = pool_alloc(bn + 1);
+    uint64_t* cur = pool_alloc(2 * bn);
+    uint64_t* part = pool_alloc(bn + 1);
+    int ok = inv != NULL && cur != NULL && part != NULL && limbs_reciprocal(inv, b, bn);
+    size_t chunks = (an + bn - 1) / bn;
+    size_t curn = 0;
+    for (size_t i = chunks; ok && i-- > 0;) {
+        size_t offset = i * bn;
+        size_t len = an - offset < bn ? an - offset : bn;
+        memmove(cur + bn, cur, curn * sizeof(uint64_t));
+        memcpy(cur, a + offset, len * sizeof(uint64_t));
+        memset(cur + len, 0, (bn - len) * sizeof(uint64_t));
+        ok = divrem_reciprocal(part, cur, cur, limbs_normalize(cur, bn + curn), b, bn, inv);
+        curn = bn;
+        if (ok && offset < qn) {
+            size_t keep = qn - offset < bn ? qn - offset : bn;
+            memcpy(q + offset, part, keep * sizeof(uint64_t));
+        }
+    }
+    if (ok) {
+        memcpy(rem, cur, bn * sizeof(uint64_t));
+    }
+    pool_free(inv);
+    pool_free(cur);
+    pool_free(part);
+    return ok;
+}
+
+/* ---------- bignum ---------- */
+
+/* 以新分配的limbs替换x的内容 */
+static void bignum_take(bignum* x, uint64_t* limbs, size_t size, size_t capacity, int negative) {
+    free(x->limbs);
+    x->limbs = limbs;
+    x->capacity = capacity;
+    x->size = limbs_normalize(limbs, size);
+    x->negative = x->size > 0 ? negative : 0;
+}
+
+void bignum_init(bignum* x) {
+    if (x != NULL) {
+        x->limbs = NULL;
+        x->size = 0;
+        x->capacity = 0;
+        x->negative = 0;
+    }
+}
+
+void bignum_free(bignum* x) {
+    if (x != NULL) {
+        free(x->limbs);
+        bignum_init(x);
+    }
+}
+
+error_code bignum_set_int64(bignum* x, int64_t value) {
+    if (x == NULL) {
+        return error_raise(ERR_BIGNUM_NULL, "大整数为NULL");
+    }
+    uint64_t* limbs = (uint64_t*)malloc(sizeof(uint64_t));
+    if (limbs == NULL) {
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    limbs[0] = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    bignum_take(x, limbs, 1, 1, value < 0);
+    return ERR_OK;
+}
+
+error_code bignum_copy(bignum* dst, const bignum* src) {
+    if (dst == NULL || src == NULL) {
+        return error_raise(ERR_BIGNUM_NULL, "大整数为NULL");
+    }
+    if (dst == src) {
+        return ERR_OK;
+    }
+    uint64_t* limbs = (uint64_t*)malloc((src->size > 0 ? src->size : 1) * sizeof(uint64_t));
+    if (limbs == NULL) {
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    if (src->size > 0) {
+        memcpy(limbs, src->limbs, src->size * sizeof(uint64_t));
+    }
+    bignum_take(dst, limbs, src->size, src->size > 0 ? src->size : 1, src->negative);
+    return ERR_OK;
+}
+
+int bignum_compare(const bignum* a, const bignum* b) {
+    if (a->negative != b->negative) {
+        return a->negative ? -1 : 1;
+    }
+    int c = limbs_cmp(a->limbs, a->size, b->limbs, b->size);
+    return a->negative ? -c : c;
+}
+
+/* r = a + (-1)^b_negative * |b| */
+static error_code add_signed(bignum* r, const bignum* a, const bignum* b, int b_negative) {
+    if (r == NULL || a == NULL || b == NULL) {
+        return error_raise(ERR_BIGNUM_NULL, "大整数为NULL");
+    }
+    const bignum* x = a;
+    const bignum* y = b;
+    int negative = a->negative;
+    if (a->negative == b_negative) {
+        if (x->size < y->size) {
+            x = b;
+            y = a;
+        }
+    } else if (limbs_cmp(a->limbs, a->size, b->limbs, b->size) < 0) {
+        x = b;
+        y = a;
+        negative = b_negative;
+    }
+    size_t n = x->size + 1;
+    uint64_t* limbs = (uint64_t*)malloc(n * sizeof(uint64_t));
+    if (limbs == NULL) {
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    if (a->negative == b_negative) {
+        limbs[x->size] = limbs_add(limbs, x->limbs, x->size, y->limbs, y->size);
+    } else {
+        limbs[x->size] = 0;
+        limbs_sub(limbs, x->limbs, x->size, y->limbs, y->size);
+    }
+    bignum_take(r, limbs, n, n, negative);
+    return ERR_OK;
+}
+
+error_code bignum_add(bignum* r, const bignum* a, const bignum* b) {
+    return add_signed(r, a, b, b != NULL && b->negative);
+}
+
+error_code bignum_sub(bignum* r, const bignum* a, const bignum* b) {
+    return add_signed(r, a, b, b != NULL && b->size > 0 && !b->negative);
+}
+
+error_code bignum_mul(bignum* r, const bignum* a, const bignum* b) {
+    if (r == NULL || a == NULL || b == NULL) {
+        return error_raise(ERR_BIGNUM_NULL, "大整数为NULL");
+    }
+    size_t n = a->size + b->size;
+    uint64_t* limbs = (uint64_t*)malloc((n > 0 ? n : 1) * sizeof(uint64_t));
+    if (limbs == NULL) {
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    if (a->size > 0 && b->size > 0 && !limbs_mul(limbs, a->limbs, a->size, b->limbs, b->size)) {
+        free(limbs);
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    bignum_take(r, limbs, a->size > 0 && b->size > 0 ? n : 0, n > 0 ? n : 1, a->negative ^ b->negative);
+    return ERR_OK;
+}
+
+error_code bignum_divmod(bignum* q, bignum* r, const bignum* a, const bignum* b) {
+    if (a == NULL || b == NULL) {
+        return error_raise(ERR_BIGNUM_NULL, "大整数为NULL");
+    }
+    if (q != NULL && q == r) {
+        return error_raise(ERR_BIGNUM_INVALID, "商和余数不能是同一个对象");
+    }
+    if (b->size == 0) {
+        return error_raise(ERR_BIGNUM_DIVIDE_BY_ZERO, "除数为0");
+    }
+    size_t qn = a->size >= b->size ? a->size - b->size + 1 : 1;
+    uint64_t* quotient = (uint64_t*)malloc(qn * sizeof(uint64_t));
+    uint64_t* remainder = (uint64_t*)malloc((a->size > 0 ? a->size : 1) * sizeof(uint64_t));
+    int ok = quotient != NULL && remainder != NULL;
+    size_t rn = b->size;
+    if (ok && limbs_cmp(a->limbs, a->size, b->limbs, b->size) < 0) {
+        quotient[0] = 0;
+        qn = 1;
+        rn = a->size;
+        if (rn > 0) {
+            memcpy(remainder, a->limbs, rn * sizeof(uint64_t));
+        }
+    } else if (ok) {
+        ok = limbs_divrem(quotient, remainder, a->limbs, a->size, b->limbs, b->size);
+    }
+    if (!ok) {
+        free(quotient);
+        free(remainder);
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    int q_negative = a->negative ^ b->negative;
+    int r_negative = a->negative;
+    if (q != NULL) {
+        bignum_take(q, quotient, qn, qn, q_negative);
+    } else {
+        free(quotient);
+    }
+    if (r != NULL) {
+        bignum_take(r, remainder, rn, a->size > 0 ? a->size : 1, r_negative);
+    } else {
+        free(remainder);
+    }
+    return ERR_OK;
+}
+
+/* ---------- 十进制转换 ---------- */
+
+/* 10^(19*2^k)及其倒数，按需逐级生成，转换结束后释放 */
+typedef struct {
+    int count;
+    uint64_t* powers[DECIMAL_LEVELS];
+    size_t sizes[DECIMAL_LEVELS];
+    uint64_t* inverses[DECIMAL_LEVELS];   /* 尚未计算为NULL */
+} decimal_powers;
+
+static void free_decimal_powers(decimal_powers* table) {
+    for (int k = 0; k < table->count; k++) {
+        pool_free(table->powers[k]);
+        pool_free(table->inverses[k]);
+    }
+    table->count = 0;
+}
+
+/* 生成到第level级；失败返回0 */
+static int decimal_power_level(decimal_powers* table, int level) {
+    if (level >= DECIMAL_LEVELS) {
+        return 0;
+    }
+    while (table->count <= level) {
+        int k = table->count;
+        uint64_t* power;
+        if (k == 0) {
+            power = pool_alloc(1);
+            if (power == NULL) {
+                return 0;
+            }
+            power[0] = DECIMAL_BASE;
+            table->sizes[0] = 1;
+        } else {
+            size_t n = table->sizes[k - 1];
+            power = pool_alloc(2 * n);
+            if (power == NULL || !limbs_mul(power, table->powers[k - 1], n, table->powers[k - 1], n)) {
+                pool_free(power);
+                return 0;
+            }
+            table->sizes[k] = limbs_normalize(power, 2 * n);
+        }
+        table->powers[k] = power;
+        table->inverses[k] = NULL;
+        table->count++;
+    }
+    return 1;
+}
+
+/* 把x（第0级时不超过1个limb）写成恰好19*2^level位十进制数字，不足时补前导0；x < 10^(19*2^level)，会被改写 */
+static int decimal_write(decimal_powers* table, uint64_t* x, size_t n, int level, char* out) {
+    size_t digits = (size_t)DECIMAL_DIGITS << level;
+    n = limbs_normalize(x, n);
+    if (n <= DECIMAL_BASECASE || level == 0) {
+        char* p = out + digits;
+        while (n > 0) {
+            uint64_t chunk = limbs_divrem_1(x, x, n, DECIMAL_BASE);
+            n = limbs_normalize(x, n);
+            for (int i = 0; i < DECIMAL_DIGITS; i++) {
+                *--p = (char)('0' + chunk % 10);
+                chunk /= 10;
+            }
+        }
+        memset(out, '0', (size_t)(p - out));
+        return 1;
+    }
+    // x = q * 10^(19*2^(level-1)) + r，高半部分写q，低半部分写r
+    const uint64_t* power = table->powers[level - 1];
+    size_t pn = table->sizes[level - 1];
+    if (limbs_cmp(x, n, power, pn) < 0) {
+        memset(out, '0', digits / 2);
+        return decimal_write(table, x, n, level - 1, out + digits / 2);
+    }
+    uint64_t* q = pool_alloc(pn + 1);
+    uint64_t* r = pool_alloc(pn);
+    int ok = q != NULL && r != NULL;
+    if (ok && pn >= NEWTON_THRESHOLD) {
+        if (table->inverses[level - 1] == NULL) {
+            table->inverses[level - 1] = pool_alloc(pn + 1);
+            ok = table->inverses[level - 1] != NULL && limbs_reciprocal(table->inverses[level - 1], power, pn);
+            if (!ok) {
+                pool_free(table->inverses[level - 1]);
+                table->inverses[level - 1] = NULL;
+            }
+        }
+        ok = ok && divrem_reciprocal(q, r, x, n, power, pn, table->inverses[level - 1]);
+    } else if (ok) {
+        ok = limbs_divrem(q, r, x, n, power, pn);
+    }
+    ok = ok && decimal_write(table, q, n - pn + 1 < pn ? n - pn + 1 : pn, level - 1, out) &&
+         decimal_write(table, r, pn, level - 1, out + digits / 2);
+    pool_free(q);
+    pool_free(r);
+    return ok;
+}
+
+/* len个十进制数字的值所需的limb数上限 */
+static size_t decimal_limbs(size_t len) {
+    return len / DECIMAL_DIGITS + 2;
+}
+
+/* 把len个十进制数字转换为r[0..*rn)，r至少有decimal_limbs(len)个limb */
+static int decimal_read(decimal_powers* table, const char* s, size_t len, uint64_t* r, size_t* rn) {
+    if (len <= (size_t)DECIMAL_DIGITS * DECIMAL_BASECASE) {
+        size_t n = 0;
+        size_t first = len % DECIMAL_DIGITS != 0 ? len % DECIMAL_DIGITS : DECIMAL_DIGITS;
+        for (size_t pos = 0; pos < len; pos = pos == 0 ? first : pos + DECIMAL_DIGITS) {
+            size_t end = pos == 0 ? first : pos + DECIMAL_DIGITS;
+            uint64_t chunk = 0;
+            for (size_t i = pos; i < end; i++) {
+                chunk = chunk * 10 + (uint64_t)(s[i] - '0');
+            }
+            uint64_t carry = limbs_mul_1(r, r, n, DECIMAL_BASE, chunk);
+            if (carry != 0) {
+                r[n++] = carry;
+            }
+        }
+        *rn = n;
+        return 1;
+    }
+    // 低19*2^k位与高位分别转换，r = high * 10^(19*2^k) + low，19*2^k < len <= 19*2^(k+1)
+    int level = 0;
+    while (((size_t)DECIMAL_DIGITS << (level + 1)) < len) {
+        level++;
+    }
+    size_t low_len = (size_t)DECIMAL_DIGITS << level;
+    if (!decimal_power_level(table, level)) {
+        return 0;
+    }
+    uint64_t* high = pool_alloc(decimal_limbs(len - low_len));
+    uint64_t* low = pool_alloc(decimal_limbs(low_len));
+    size_t hn = 0, ln = 0;
+    int ok = high != NULL && low != NULL && decimal_read(table, s, len - low_len, high, &hn) &&
+             decimal_read(table, s + len - low_len, low_len, low, &ln);
+    if (ok) {
+        size_t pn = table->sizes[level];
+        if (hn > 0) {
+            ok = limbs_mul(r, table->powers[level], pn, high, hn);
+        } else {
+            memset(r, 0, pn * sizeof(uint64_t));
+        }
+        if (ok) {
+            size_t n = pn + hn;
+            limbs_add(r, r, n, low, ln);
+            *rn = limbs_normalize(r, n);
+        }
+    }
+    pool_free(high);
+    pool_free(low);
+    return ok;
+}
+
+error_code bignum_from_string(bignum* x, const char* str, size_t len) {
+    debug_print("解析大整数");
+    if (x == NULL || str == NULL) {
+        return error_raise(ERR_BIGNUM_NULL, "大整数或文本为NULL");
+    }
+    int negative = 0;
+    size_t pos = 0;
+    if (len > 0 && (str[0] == '-' || str[0] == '+')) {
+        negative = str[0] == '-';
+        pos = 1;
+    }
+    if (pos == len) {
+        return error_raise(ERR_BIGNUM_INVALID, "不是整数");
+    }
+    for (size_t i = pos; i < len; i++) {
+        if (str[i] < '0' || str[i] > '9') {
+            return error_raise(ERR_BIGNUM_INVALID, "不是整数");
+        }
+    }
+    while (pos + 1 < len && str[pos] == '0') {
+        pos++;
+    }
+    size_t capacity = decimal_limbs(len - pos);
+    uint64_t* limbs = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+    if (limbs == NULL) {
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    decimal_powers table = {0};
+    size_t n = 0;
+    int ok = decimal_read(&table, str + pos, len - pos, limbs, &n);
+    free_decimal_powers(&table);
+    if (!ok) {
+        free(limbs);
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    bignum_take(x, limbs, n, capacity, negative);
+    return ERR_OK;
+}
+
+error_code bignum_to_string(const bignum* x, char** str, size_t* len) {
+    debug_print("大整数转换为十进制");
+    if (x == NULL || str == NULL) {
+        return error_raise(ERR_BIGNUM_NULL, "大整数或输出参数为NULL");
+    }
+    // 取10^(19*2^level) > x，先补足19*2^level位再去掉前导0；由位数能判断P^2 > x时不必算出P^2
+    decimal_powers table = {0};
+    int level = 0;
+    int ok = 1;
+    size_t x_bits = limbs_bits(x->limbs, x->size);
+    for (;;) {
+        ok = decimal_power_level(&table, level);
+        if (!ok || limbs_cmp(table.powers[level], table.sizes[level], x->limbs, x->size) > 0) {
+            break;
+        }
+        level++;
+        if (2 * limbs_bits(table.powers[level - 1], table.sizes[level - 1]) - 1 > x_bits) {
+            break;
+        }
+    }
+    size_t digits = (size_t)DECIMAL_DIGITS << level;
+    char* text = ok ? (char*)mem_alloc(digits + 2) : NULL;
+    uint64_t* work = pool_alloc(x->size);
+    ok = text != NULL && work != NULL;
+    if (ok) {
+        if (x->size > 0) {
+            memcpy(work, x->limbs, x->size * sizeof(uint64_t));
+        }
+        ok = decimal_write(&table, work, x->size, level, text + 1);
+    }
+    free_decimal_powers(&table);
+    pool_free(work);
+    if (!ok) {
+        mem_free(text);
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    size_t start = 1;
+    while (start < digits && text[start] == '0') {
+        start++;
+    }
+    if (x->negative) {
+        text[--start] = '-';
+    }
+    size_t length = digits + 1 - start;
+    memmove(text, text + start, length);
+    text[length] = '\0';
+    *str = text;
+    if (len != NULL) {
+        *len = length;
+    }
+    return ERR_OK;
+}
+
+/* ---------- 阶乘 ---------- */
+
+/* 乘积lo * (lo+1) * ... * hi写入新分配的临时空间*r */
+static int product_range(uint32_t lo, uint32_t hi, uint64_t** r, size_t* rn) {
+    if (hi - lo < FACTORIAL_LEAF) {
+        size_t cap = (size_t)(hi - lo) / 2 + 2;
+        uint64_t* limbs = pool_alloc(cap);
+        if (limbs == NULL) {
+            return 0;
+        }
+        limbs[0] = 1;
+        size_t n = 1;
+        uint64_t acc = 1;
+        // 把乘积不超过64位的连续因子合并后再乘入
+        for (uint64_t v = lo; v <= hi; v++) {
+            if (acc > UINT64_MAX / v) {
+                uint64_t carry = limbs_mul_1(limbs, limbs, n, acc, 0);
+                if (carry != 0) {
+                    limbs[n++] = carry;
+                }
+                acc = 1;
+            }
+            acc *= v;
+        }
+        uint64_t carry = limbs_mul_1(limbs, limbs, n, acc, 0);
+        if (carry != 0) {
+            limbs[n++] = carry;
+        }
+        *r = limbs;
+        *rn = n;
+        return 1;
+    }
+    uint32_t mid = lo + (hi - lo) / 2;
+    uint64_t* left = NULL;
+    uint64_t* right = NULL;
+    size_t ln = 0, rgn = 0;
+    int ok = product_range(lo, mid, &left, &ln) && product_range(mid + 1, hi, &right, &rgn);
+    uint64_t* limbs = ok ? pool_alloc(ln + rgn) : NULL;
+    ok = limbs != NULL && limbs_mul(limbs, left, ln, right, rgn);
+    pool_free(left);
+    pool_free(right);
+    if (!ok) {
+        pool_free(limbs);
+        return 0;
+    }
+    *r = limbs;
+    *rn = limbs_normalize(limbs, ln + rgn);
+    return 1;
+}
+
+error_code bignum_factorial(bignum* r, uint32_t n) {
+    debug_print("计算大整数阶乘");
+    if (r == NULL) {
+        return error_raise(ERR_BIGNUM_NULL, "大整数为NULL");
+    }
+    uint64_t* product = NULL;
+    size_t size = 0;
+    uint64_t* limbs = NULL;
+    if (product_range(1, n > 0 ? n : 1, &product, &size)) {
+        limbs = (uint64_t*)malloc(size * sizeof(uint64_t));
+    }
+    if (limbs == NULL) {
+        pool_free(product);
+        return error_raise(ERR_BIGNUM_ALLOC, "内存分配失败");
+    }
+    memcpy(limbs, product, size * sizeof(uint64_t));
+    pool_free(product);
+    bignum_take(r, limbs, size, size, 0);
+    return ERR_OK;
+}
+
+static int module_init(void) {
+    debug_print("大整数模块初始化成功");
+    return 1;
+}
+
+int initialize_bignum_ops() {
+    return module_init_once(MODULE_BIGNUM, module_init);
+}
\ No newline at end of file
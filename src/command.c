@@ -0,0 +1,888 @@
+/**
+ * @file command.c
+ * @brief 命令协议实现：批处理模式与基于epoll的Unix域套接字服务
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "../include/command.h"
+#include "../include/module.h"
+#include "../include/math_ops.h"
+#include "../include/string_ops.h"
+#include "../include/file_ops.h"
+#include "../include/hash_ops.h"
+#include "../include/number_ops.h"
+#include "../include/utils.h"
+#include "../include/allocator.h"
+
+#define READ_CHUNK_SIZE (64 * 1024)
+/* 批处理模式下响应攒到该大小就写出 */
+#define OUTPUT_FLUSH_SIZE (64 * 1024)
+/* 服务模式下单个连接待发送的响应超过该值时暂停读取该连接 */
+#define OUTPUT_HIGH_WATER (1024 * 1024)
+#define MAX_ARGS 4
+#define MAX_EVENTS 64
+/* 文件名等短参数复制到栈上，超过时才分配内存 */
+#define ARG_STACK_SIZE 4096
+
+/* 收到停止请求时写入的eventfd，服务未运行时为-1 */
+static atomic_int stop_fd = -1;
+
+typedef struct {
+    const char* ptr;
+    size_t len;
+} token;
+
+typedef struct {
+    token argv[MAX_ARGS];
+    int argc;              /* 命令名之后的参数个数 */
+    const char* text;      /* 命令名之后的整段文本（保留中间的空格） */
+    size_t text_len;
+} command_args;
+
+/**
+ * @brief 命令处理函数，把结果追加到out（调用前已写入"OK "）
+ * @return ERR_OK或错误代码
+ */
+typedef error_code (*command_handler)(const command_args* args, command_buffer* out);
+
+typedef struct {
+    const char* name;
+    int min_args;
+    int max_args;             /* -1表示不限，参数作为整段文本使用 */
+    command_handler handler;
+} command_entry;
+
+/* 按行切分的输入缓冲区，批处理和每个连接各有一个 */
+typedef struct {
+    char* data;
+    size_t len;
+    size_t capacity;
+    int discarding;   /* 当前行过长，丢弃到下一个换行符为止 */
+} command_input;
+
+void command_buffer_init(command_buffer* buffer) {
+    buffer->data = NULL;
+    buffer->len = 0;
+    buffer->capacity = 0;
+}
+
+void command_buffer_free(command_buffer* buffer) {
+    free(buffer->data);
+    command_buffer_init(buffer);
+}
+
+static int buffer_reserve(command_buffer* buffer, size_t extra) {
+    if (buffer->len + extra <= buffer->capacity) {
+        return 1;
+    }
+    size_t capacity = buffer->capacity > 0 ? buffer->capacity : 4096;
+    while (capacity < buffer->len + extra) {
+        capacity *= 2;
+    }
+    char* data = (char*)realloc(buffer->data, capacity);
+    if (data == NULL) {
+        return 0;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+static int buffer_append(command_buffer* buffer, const char* data, size_t len) {
+    if (!buffer_reserve(buffer, len)) {
+        return 0;
+    }
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+    return 1;
+}
+
+static int buffer_append_long(command_buffer* buffer, long long value) {
+    char digits[NUMBER_INT_BUFFER];
+    return buffer_append(buffer, digits, format_int64(value, digits));
+}
+
+static int parse_int_token(const token* t, int* value) {
+    int64_t parsed = 0;
+    size_t consumed = 0;
+    if (parse_int64(t->ptr, t->len, &parsed, &consumed) != ERR_OK || consumed != t->len ||
+        parsed < INT_MIN || parsed > INT_MAX) {
+        return 0;
+    }
+    *value = (int)parsed;
+    return 1;
+}
+
+/* 返回以'\0'结尾的副本，短参数使用调用者提供的栈缓冲区 */
+static char* token_cstr(const char* ptr, size_t len, char* stack_buffer) {
+    char* str = len < ARG_STACK_SIZE ? stack_buffer : (char*)malloc(len + 1);
+    if (str != NULL) {
+        memcpy(str, ptr, len);
+        str[len] = '\0';
+    }
+    return str;
+}
+
+static void token_cstr_free(char* str, char* stack_buffer) {
+    if (str != stack_buffer) {
+        free(str);
+    }
+}
+
+static error_code handle_ping(const command_args* args, command_buffer* out) {
+    (void)args;
+    return buffer_append(out, "pong", 4) ? ERR_OK : ERR_COMMAND_ALLOC;
+}
+
+static error_code handle_binary(const command_args* args, command_buffer* out,
+                                error_code (*fn)(int, int, int*)) {
+    int a, b, result;
+    if (!parse_int_token(&args->argv[0], &a) || !parse_int_token(&args->argv[1], &b)) {
+        return ERR_COMMAND_BAD_ARGUMENT;
+    }
+    error_code code = fn(a, b, &result);
+    if (code != ERR_OK) {
+        return code;
+    }
+    return buffer_append_long(out, result) ? ERR_OK : ERR_COMMAND_ALLOC;
+}
+
+static error_code handle_add(const command_args* args, command_buffer* out) {
+    return handle_binary(args, out, add_checked);
+}
+
+static error_code handle_subtract(const command_args* args, command_buffer* out) {
+    return handle_binary(args, out, subtract_checked);
+}
+
+static error_code handle_multiply(const command_args* args, command_buffer* out) {
+    return handle_binary(args, out, multiply_checked);
+}
+
+static error_code handle_divide(const command_args* args, command_buffer* out) {
+    return handle_binary(args, out, divide_checked);
+}
+
+static error_code handle_gcd(const command_args* args, command_buffer* out) {
+    return handle_binary(args, out, gcd_checked);
+}
+
+static error_code handle_unary(const command_args* args, command_buffer* out,
+                               error_code (*fn)(int, int*)) {
+    int n, result;
+    if (!parse_int_token(&args->argv[0], &n)) {
+        return ERR_COMMAND_BAD_ARGUMENT;
+    }
+    error_code code = fn(n, &result);
+    if (code != ERR_OK) {
+        return code;
+    }
+    return buffer_append_long(out, result) ? ERR_OK : ERR_COMMAND_ALLOC;
+}
+
+static error_code handle_factorial(const command_args* args, command_buffer* out) {
+    return handle_unary(args, out, factorial_checked);
+}
+
+static error_code handle_fibonacci(const command_args* args, command_buffer* out) {
+    return handle_unary(args, out, fibonacci_checked);
+}
+
+static error_code handle_primes(const command_args* args, command_buffer* out) {
+    int start, end;
+    if (!parse_int_token(&args->argv[0], &start) || !parse_int_token(&args->argv[1], &end)) {
+        return ERR_COMMAND_BAD_ARGUMENT;
+    }
+    if (start > end) {
+        return ERR_MATH_INVALID_RANGE;
+    }
+    // 只需要个数，不生成素数数组；负数部分没有素数
+    uint64_t count = 0;
+    if (end >= 2) {
+        error_code code = count_primes_checked(start < 0 ? 0 : (uint64_t)start, (uint64_t)end, &count);
+        if (code != ERR_OK) {
+            return code;
+        }
+    }
+    return buffer_append_long(out, (long)count) ? ERR_OK : ERR_COMMAND_ALLOC;
+}
+
+static error_code handle_text(const command_args* args, command_buffer* out,
+                              error_code (*fn)(const char*, char**)) {
+    char stack_buffer[ARG_STACK_SIZE];
+    char* text = token_cstr(args->text, args->text_len, stack_buffer);
+    if (text == NULL) {
+        return ERR_COMMAND_ALLOC;
+    }
+    char* result = NULL;
+    error_code code = fn(text, &result);
+    token_cstr_free(text, stack_buffer);
+    if (code != ERR_OK) {
+        return code;
+    }
+    int ok = buffer_append(out, result, strlen(result));
+    mem_free(result);
+    return ok ? ERR_OK : ERR_COMMAND_ALLOC;
+}
+
+static error_code handle_upper(const command_args* args, command_buffer* out) {
+    return handle_text(args, out, string_to_upper_checked);
+}
+
+static error_code handle_lower(const command_args* args, command_buffer* out) {
+    return handle_text(args, out, string_to_lower_checked);
+}
+
+static error_code handle_reverse(const command_args* args, command_buffer* out) {
+    return handle_text(args, out, string_reverse_checked);
+}
+
+static error_code handle_exists(const command_args* args, command_buffer* out) {
+    char stack_buffer[ARG_STACK_SIZE];
+    char* filename = token_cstr(args->argv[0].ptr, args->argv[0].len, stack_buffer);
+    if (filename == NULL) {
+        return ERR_COMMAND_ALLOC;
+    }
+    int exists = 0;
+    error_code code = file_exists_checked(filename, &exists);
+    token_cstr_free(filename, stack_buffer);
+    if (code != ERR_OK) {
+        return code;
+    }
+    return buffer_append_long(out, exists) ? ERR_OK : ERR_COMMAND_ALLOC;
+}
+
+static error_code handle_size(const command_args* args, command_buffer* out) {
+    char stack_buffer[ARG_STACK_SIZE];
+    char* filename = token_cstr(args->argv[0].ptr, args->argv[0].len, stack_buffer);
+    if (filename == NULL) {
+        return ERR_COMMAND_ALLOC;
+    }
+    long size = 0;
+    error_code code = get_file_size_checked(filename, &size);
+    token_cstr_free(filename, stack_buffer);
+    if (code != ERR_OK) {
+        return code;
+    }
+    return buffer_append_long(out, size) ? ERR_OK : ERR_COMMAND_ALLOC;
+}
+
+static int token_equals(const token* t, const char* str) {
+    size_t len = strlen(str);
+    return t->len == len && memcmp(t->ptr, str, len) == 0;
+}
+
+static error_code handle_hash(const command_args* args, command_buffer* out) {
+    hash_algorithm algorithm = HASH_SHA256;
+    if (args->argc > 1) {
+        if (token_equals(&args->argv[1], "crc32c")) {
+            algorithm = HASH_CRC32C;
+        } else if (token_equals(&args->argv[1], "xxh3")) {
+            algorithm = HASH_XXH3;
+        } else if (token_equals(&args->argv[1], "xxh32")) {
+            algorithm = HASH_XXH32;
+        } else if (!token_equals(&args->argv[1], "sha256")) {
+            return ERR_COMMAND_BAD_ARGUMENT;
+        }
+    }
+    char stack_buffer[ARG_STACK_SIZE];
+    char* filename = token_cstr(args->argv[0].ptr, args->argv[0].len, stack_buffer);
+    if (filename == NULL) {
+        return ERR_COMMAND_ALLOC;
+    }
+    unsigned char digest[HASH_MAX_DIGEST_SIZE];
+    int ok = hash_file(filename, algorithm, digest);
+    token_cstr_free(filename, stack_buffer);
+    if (!ok) {
+        return get_last_error();
+    }
+    char* hex = hash_to_hex(digest, hash_digest_size(algorithm));
+    if (hex == NULL) {
+        return get_last_error();
+    }
+    ok = buffer_append(out, hex, strlen(hex));
+    mem_free(hex);
+    return ok ? ERR_OK : ERR_COMMAND_ALLOC;
+}
+
+static const command_entry commands[] = {
+    {"add", 2, 2, handle_add},
+    {"subtract", 2, 2, handle_subtract},
+    {"multiply", 2, 2, handle_multiply},
+    {"divide", 2, 2, handle_divide},
+    {"gcd", 2, 2, handle_gcd},
+    {"factorial", 1, 1, handle_factorial},
+    {"fibonacci", 1, 1, handle_fibonacci},
+    {"primes", 2, 2, handle_primes},
+    {"upper", 0, -1, handle_upper},
+    {"lower", 0, -1, handle_lower},
+    {"reverse", 0, -1, handle_reverse},
+    {"exists", 1, 1, handle_exists},
+    {"size", 1, 1, handle_size},
+    {"hash", 1, 2, handle_hash},
+    {"ping", 0, 0, handle_ping},
+};
+
+static int is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+/* 切分参数，返回参数个数，超过MAX_ARGS时返回MAX_ARGS + 1 */
+static int tokenize(const char* p, const char* end, token* argv) {
+    int argc = 0;
+    for (;;) {
+        while (p < end && is_space(*p)) {
+            p++;
+        }
+        if (p == end) {
+            return argc;
+        }
+        if (argc == MAX_ARGS) {
+            return MAX_ARGS + 1;
+        }
+        const char* start = p;
+        while (p < end && !is_space(*p)) {
+            p++;
+        }
+        argv[argc].ptr = start;
+        argv[argc].len = (size_t)(p - start);
+        argc++;
+    }
+}
+
+static int append_error(command_buffer* out, error_code code) {
+    const char* name = error_code_name(code);
+    return buffer_append(out, "ERR ", 4) &&
+           buffer_append_long(out, code) &&
+           buffer_append(out, " ", 1) &&
+           buffer_append(out, name, strlen(name)) &&
+           buffer_append(out, "\n", 1);
+}
+
+int command_execute(const char* line, size_t len, command_buffer* out) {
+    const char* end = line + len;
+    if (len > 0 && end[-1] == '\r') {
+        end--;
+    }
+    const char* p = line;
+    while (p < end && is_space(*p)) {
+        p++;
+    }
+    // 空行和注释行不产生响应
+    if (p == end || *p == '#') {
+        return 1;
+    }
+
+    token name;
+    name.ptr = p;
+    while (p < end && !is_space(*p)) {
+        p++;
+    }
+    name.len = (size_t)(p - name.ptr);
+
+    if (token_equals(&name, "quit")) {
+        return 0;
+    }
+
+    const command_entry* entry = NULL;
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (token_equals(&name, commands[i].name)) {
+            entry = &commands[i];
+            break;
+        }
+    }
+    if (entry == NULL) {
+        error_log(ERR_COMMAND_UNKNOWN, "未知命令");
+        return append_error(out, ERR_COMMAND_UNKNOWN) ? 1 : -1;
+    }
+
+    command_args args;
+    args.text = p < end ? p + 1 : end;
+    args.text_len = (size_t)(end - args.text);
+    args.argc = tokenize(p, end, args.argv);
+    if (args.argc < entry->min_args || (entry->max_args >= 0 && args.argc > entry->max_args)) {
+        error_log(ERR_COMMAND_BAD_ARGUMENT, "命令参数个数错误");
+        return append_error(out, ERR_COMMAND_BAD_ARGUMENT) ? 1 : -1;
+    }
+
+    size_t mark = out->len;
+    if (!buffer_append(out, "OK ", 3)) {
+        return -1;
+    }
+    error_code code = entry->handler(&args, out);
+    if (code == ERR_OK) {
+        return buffer_append(out, "\n", 1) ? 1 : -1;
+    }
+    if (code == ERR_COMMAND_BAD_ARGUMENT) {
+        error_log(ERR_COMMAND_BAD_ARGUMENT, "命令参数格式错误");
+    }
+    out->len = mark;
+    return append_error(out, code) ? 1 : -1;
+}
+
+static int input_init(command_input* in) {
+    in->data = (char*)malloc(READ_CHUNK_SIZE);
+    in->len = 0;
+    in->capacity = READ_CHUNK_SIZE;
+    in->discarding = 0;
+    return in->data != NULL;
+}
+
+static void input_free(command_input* in) {
+    free(in->data);
+    in->data = NULL;
+}
+
+/* 保证输入缓冲区至少还能读入READ_CHUNK_SIZE/2字节，行过长时转为丢弃模式 */
+static int input_make_room(command_input* in, command_buffer* out) {
+    if (in->capacity - in->len >= READ_CHUNK_SIZE / 2) {
+        return 1;
+    }
+    if (in->len > COMMAND_MAX_LINE) {
+        // 缓冲区中只剩一个未结束的行，已超过长度上限
+        in->len = 0;
+        if (!in->discarding) {
+            in->discarding = 1;
+            error_log(ERR_COMMAND_LINE_TOO_LONG, "命令过长");
+            return append_error(out, ERR_COMMAND_LINE_TOO_LONG);
+        }
+        return 1;
+    }
+    char* data = (char*)realloc(in->data, in->capacity * 2);
+    if (data == NULL) {
+        return 0;
+    }
+    in->data = data;
+    in->capacity *= 2;
+    return 1;
+}
+
+/* 执行一行；缓冲区扩大前就已读到换行符的过长行在这里拒绝 */
+static int input_execute(const char* line, size_t len, command_buffer* out) {
+    if (len > COMMAND_MAX_LINE) {
+        error_log(ERR_COMMAND_LINE_TOO_LONG, "命令过长");
+        return append_error(out, ERR_COMMAND_LINE_TOO_LONG) ? 1 : -1;
+    }
+    return command_execute(line, len, out);
+}
+
+/**
+ * @brief 执行缓冲区中所有完整的行，未结束的行移到缓冲区开头
+ * @param final 输入已结束，最后一行即使没有换行符也执行
+ * @return 继续返回1，收到quit返回0，内存分配失败返回-1
+ */
+static int input_process(command_input* in, command_buffer* out, int final) {
+    size_t start = 0;
+    int status = 1;
+    while (status == 1 && start < in->len) {
+        char* newline = (char*)memchr(in->data + start, '\n', in->len - start);
+        if (newline == NULL) {
+            break;
+        }
+        size_t line_len = (size_t)(newline - (in->data + start));
+        if (in->discarding) {
+            in->discarding = 0;
+        } else {
+            status = input_execute(in->data + start, line_len, out);
+        }
+        start += line_len + 1;
+    }
+    if (status == 1 && final && start < in->len && !in->discarding) {
+        status = input_execute(in->data + start, in->len - start, out);
+        start = in->len;
+    }
+    if (start > 0) {
+        memmove(in->data, in->data + start, in->len - start);
+        in->len -= start;
+    }
+    return status;
+}
+
+static int write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return 0;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+int command_run_batch(int in_fd, int out_fd) {
+    debug_print("进入批处理模式");
+    command_input in;
+    command_buffer out;
+    command_buffer_init(&out);
+    if (!input_init(&in) || !buffer_reserve(&out, OUTPUT_FLUSH_SIZE)) {
+        input_free(&in);
+        command_buffer_free(&out);
+        error_log(ERR_COMMAND_ALLOC, "内存分配失败");
+        return 0;
+    }
+
+    int ok = 1;
+    int status = 1;
+    while (status == 1) {
+        if (!input_make_room(&in, &out)) {
+            error_log(ERR_COMMAND_ALLOC, "内存分配失败");
+            ok = 0;
+            break;
+        }
+        ssize_t n = read(in_fd, in.data + in.len, in.capacity - in.len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            error_log(ERR_COMMAND_IO, "读取命令失败");
+            ok = 0;
+            break;
+        }
+        in.len += (size_t)n;
+        status = input_process(&in, &out, n == 0);
+        if (status < 0) {
+            error_log(ERR_COMMAND_ALLOC, "内存分配失败");
+            ok = 0;
+        }
+        if (n == 0) {
+            status = 0;
+        }
+        // 每批输入处理完就写出，交互使用时不会因为缓冲而看不到响应
+        if (out.len > 0) {
+            if (!write_all(out_fd, out.data, out.len)) {
+                error_log(ERR_COMMAND_IO, "写出响应失败");
+                ok = 0;
+                break;
+            }
+            out.len = 0;
+        }
+    }
+
+    input_free(&in);
+    command_buffer_free(&out);
+    return ok;
+}
+
+int command_run_batch_file(const char* filename) {
+    if (filename == NULL || strcmp(filename, "-") == 0) {
+        return command_run_batch(STDIN_FILENO, STDOUT_FILENO);
+    }
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error_log_detail(ERR_COMMAND_IO, "无法打开命令文件", filename);
+        return 0;
+    }
+    int ok = command_run_batch(fd, STDOUT_FILENO);
+    close(fd);
+    return ok;
+}
+
+typedef struct connection connection;
+
+struct connection {
+    int fd;
+    command_input in;
+    command_buffer out;
+    size_t out_sent;      /* out中已发送的字节数 */
+    int closing;          /* 收到quit或对方关闭写端，发完响应后关闭 */
+    unsigned int events;  /* 当前注册的epoll事件 */
+    connection* prev;     /* 所有连接组成的双向链表，停止服务时逐个关闭 */
+    connection* next;
+};
+
+/* epoll中监听套接字和停止事件的标记，连接使用connection指针 */
+static int listener_tag;
+static int stop_tag;
+
+static void connection_close(int epoll_fd, connection** head, connection* conn) {
+    if (conn->prev != NULL) {
+        conn->prev->next = conn->next;
+    } else {
+        *head = conn->next;
+    }
+    if (conn->next != NULL) {
+        conn->next->prev = conn->prev;
+    }
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    input_free(&conn->in);
+    command_buffer_free(&conn->out);
+    free(conn);
+}
+
+/* 尽量发送待发送的响应，返回0表示连接已失效 */
+static int connection_flush(connection* conn) {
+    while (conn->out_sent < conn->out.len) {
+        ssize_t n = send(conn->fd, conn->out.data + conn->out_sent, conn->out.len - conn->out_sent,
+                         MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (n < 0) {
+            return 0;
+        }
+        conn->out_sent += (size_t)n;
+    }
+    if (conn->out_sent == conn->out.len) {
+        conn->out.len = 0;
+        conn->out_sent = 0;
+    }
+    return 1;
+}
+
+/* 根据连接状态更新关注的事件：有待发送数据时关注可写，积压过多时暂停读取 */
+static int connection_update(int epoll_fd, connection* conn) {
+    size_t pending = conn->out.len - conn->out_sent;
+    if (conn->closing && pending == 0) {
+        return 0;
+    }
+    unsigned int events = 0;
+    if (!conn->closing && pending < OUTPUT_HIGH_WATER) {
+        events |= EPOLLIN;
+    }
+    if (pending > 0) {
+        events |= EPOLLOUT;
+    }
+    if (events != conn->events) {
+        struct epoll_event ev;
+        ev.events = events;
+        ev.data.ptr = conn;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev) != 0) {
+            return 0;
+        }
+        conn->events = events;
+    }
+    return 1;
+}
+
+static int connection_read(connection* conn) {
+    if (!input_make_room(&conn->in, &conn->out)) {
+        return 0;
+    }
+    ssize_t n = recv(conn->fd, conn->in.data + conn->in.len, conn->in.capacity - conn->in.len, 0);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    conn->in.len += (size_t)n;
+    // 流水线：一次读入的所有完整命令连续执行，响应合并发送
+    int status = input_process(&conn->in, &conn->out, n == 0);
+    if (status < 0) {
+        return 0;
+    }
+    if (status == 0 || n == 0) {
+        conn->closing = 1;
+    }
+    return 1;
+}
+
+static void accept_connections(int epoll_fd, int listen_fd, connection** head) {
+    for (;;) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        connection* conn = (connection*)calloc(1, sizeof(connection));
+        if (conn == NULL || !input_init(&conn->in)) {
+            error_log(ERR_COMMAND_ALLOC, "内存分配失败");
+            free(conn);
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        command_buffer_init(&conn->out);
+        conn->events = EPOLLIN;
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            input_free(&conn->in);
+            free(conn);
+            close(fd);
+            continue;
+        }
+        conn->next = *head;
+        if (*head != NULL) {
+            (*head)->prev = conn;
+        }
+        *head = conn;
+    }
+}
+
+static void handle_stop_signal(int sig) {
+    (void)sig;
+    command_server_stop();
+}
+
+void command_server_stop() {
+    int fd = atomic_load(&stop_fd);
+    if (fd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+static int open_listener(const char* socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        error_log_detail(ERR_COMMAND_SOCKET, "套接字路径过长", socket_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    // 替换上次运行遗留的套接字文件，但不删除普通文件
+    struct stat st;
+    if (lstat(socket_path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(socket_path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error_log(ERR_COMMAND_SOCKET, "创建套接字失败");
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        error_log_detail(ERR_COMMAND_SOCKET, "无法监听套接字", socket_path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int command_serve_unix(const char* socket_path) {
+    debug_print("启动命令服务");
+    if (socket_path == NULL) {
+        error_log(ERR_COMMAND_SOCKET, "套接字路径为NULL");
+        return 0;
+    }
+
+    int listen_fd = open_listener(socket_path);
+    if (listen_fd < 0) {
+        return 0;
+    }
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || event_fd < 0) {
+        error_log(ERR_COMMAND_SOCKET, "创建事件循环失败");
+        if (epoll_fd >= 0) {
+            close(epoll_fd);
+        }
+        if (event_fd >= 0) {
+            close(event_fd);
+        }
+        close(listen_fd);
+        unlink(socket_path);
+        return 0;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &listener_tag;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.events = EPOLLIN;
+    ev.data.ptr = &stop_tag;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &ev);
+
+    // 信号处理函数只写eventfd，由事件循环在安全的位置退出
+    atomic_store(&stop_fd, event_fd);
+    struct sigaction action, old_int, old_term;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &old_int);
+    sigaction(SIGTERM, &action, &old_term);
+
+    connection* conns = NULL;
+
+    struct epoll_event events[MAX_EVENTS];
+    int running = 1;
+    while (running) {
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error_log(ERR_COMMAND_SOCKET, "等待事件失败");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            void* tag = events[i].data.ptr;
+            if (tag == NULL) {
+                continue;
+            }
+            if (tag == &stop_tag) {
+                running = 0;
+                continue;
+            }
+            if (tag == &listener_tag) {
+                accept_connections(epoll_fd, listen_fd, &conns);
+                continue;
+            }
+            connection* conn = (connection*)tag;
+            int alive = 1;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                alive = connection_read(conn);
+            }
+            if (alive) {
+                alive = connection_flush(conn) && connection_update(epoll_fd, conn);
+            }
+            if (!alive) {
+                connection_close(epoll_fd, &conns, conn);
+                // 关闭的连接可能在本批的后续事件中再次出现
+                for (int j = i + 1; j < n; j++) {
+                    if (events[j].data.ptr == conn) {
+                        events[j].data.ptr = NULL;
+                    }
+                }
+            }
+        }
+    }
+    while (conns != NULL) {
+        connection_close(epoll_fd, &conns, conns);
+    }
+
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    atomic_store(&stop_fd, -1);
+    close(event_fd);
+    close(epoll_fd);
+    close(listen_fd);
+    unlink(socket_path);
+    debug_print("命令服务已停止");
+    return 1;
+}
+
+static int module_init(void) {
+    debug_print("命令模块初始化成功");
+    return 1;
+}
+
+int initialize_command() {
+    return module_init_once(MODULE_COMMAND, module_init);
+}
\ No newline at end of file
@@ -0,0 +1,1077 @@
+/**
+ * @file compress_ops.c
+ * @brief 压缩文件流式读写实现
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include "../include/compress_ops.h"
+#include "../include/module.h"
+#include "../include/hash_ops.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+#include "../include/allocator.h"
+#include "../third_party/zstd/lib/zstd.h"
+
+#define LZ4_MAGIC 0x184D2204U
+#define LZ4_SKIPPABLE_MASK 0xFFFFFFF0U
+#define LZ4_SKIPPABLE_MAGIC 0x184D2A50U
+#define ZSTD_FRAME_MAGIC 0xFD2FB528U
+
+#define LZ4_BLOCK_SIZE (4 * 1024 * 1024)     /* 写入时的块大小（BD=7） */
+#define LZ4_WINDOW_SIZE (64 * 1024)          /* 块依赖模式下可引用的历史长度 */
+#define LZ4_HASH_LOG 16
+#define LZ4_MIN_MATCH 4
+#define LZ4_MFLIMIT 12
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MAX_THREADS 8                    /* 每次刷新最多并行压缩的块数 */
+
+#define READ_BUFFER_SIZE (128 * 1024)
+#define COPY_BUFFER_SIZE (256 * 1024)
+
+struct compressed_writer {
+    compress_format format;
+    int fd;
+    int failed;
+    /* LZ4：先暂存若干个块，再并行压缩后按顺序写出 */
+    int num_threads;
+    uint8_t* staging;
+    size_t staged;
+    uint8_t** outputs;
+    size_t* output_sizes;
+    uint32_t** tables;
+    hash_state content_hash;
+    /* zstd */
+    ZSTD_CCtx* cctx;
+    uint8_t* zout;
+    size_t zout_size;
+};
+
+struct compressed_reader {
+    compress_format format;
+    int fd;
+    int eof;
+    int failed;
+    /* 原始输入缓冲 */
+    uint8_t* in;
+    size_t in_pos;
+    size_t in_len;
+    /* LZ4：输出缓冲前LZ4_WINDOW_SIZE字节保存上一个块的尾部，用于块依赖模式 */
+    int in_frame;
+    int block_checksum;
+    int content_checksum;
+    int block_independent;
+    size_t block_max;
+    uint8_t* block_in;
+    uint8_t* block_out;
+    size_t history;
+    size_t out_pos;
+    size_t out_len;
+    hash_state content_hash;
+    /* zstd */
+    ZSTD_DStream* dstream;
+    int zstd_frame_done;
+};
+
+static inline uint32_t read_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void write_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static int write_all(int fd, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return 0;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+static int resolve_threads(int num_threads) {
+    if (num_threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = online > 0 ? (int)online : 1;
+    }
+    return num_threads;
+}
+
+compress_format compress_format_from_filename(const char* filename) {
+    if (filename == NULL) {
+        return COMPRESS_NONE;
+    }
+    size_t len = strlen(filename);
+    if (len >= 4 && strcmp(filename + len - 4, ".lz4") == 0) {
+        return COMPRESS_LZ4;
+    }
+    if (len >= 4 && strcmp(filename + len - 4, ".zst") == 0) {
+        return COMPRESS_ZSTD;
+    }
+    return COMPRESS_NONE;
+}
+
+/* ---------- LZ4块格式 ---------- */
+
+static inline size_t lz4_compress_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+static inline uint32_t lz4_hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+static inline uint32_t read_u32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint8_t* lz4_write_length(uint8_t* op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static uint8_t* lz4_emit_literals(uint8_t* op, uint8_t* token, const uint8_t* literals, size_t len) {
+    if (len >= 15) {
+        *token = 15 << 4;
+        op = lz4_write_length(op, len - 15);
+    } else {
+        *token = (uint8_t)(len << 4);
+    }
+    memcpy(op, literals, len);
+    return op + len;
+}
+
+/* 贪心哈希匹配，table需要(1 << LZ4_HASH_LOG)个元素 */
+static size_t lz4_compress_block(const uint8_t* src, size_t n, uint8_t* dst, uint32_t* table) {
+    uint8_t* op = dst;
+    size_t anchor = 0;
+
+    if (n > LZ4_MFLIMIT) {
+        memset(table, 0, sizeof(uint32_t) << LZ4_HASH_LOG);
+        size_t mflimit = n - LZ4_MFLIMIT;
+        size_t match_limit = n - LZ4_LAST_LITERALS;
+        size_t ip = 0;
+        unsigned misses = 0;
+
+        while (ip < mflimit) {
+            uint32_t sequence = read_u32(src + ip);
+            uint32_t h = lz4_hash(sequence);
+            size_t ref = table[h];
+            table[h] = (uint32_t)ip + 1;
+
+            if (ref == 0 || ip - (ref - 1) > 65535 || read_u32(src + ref - 1) != sequence) {
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            size_t match = ref - 1;
+            while (ip > anchor && match > 0 && src[ip - 1] == src[match - 1]) {
+                ip--;
+                match--;
+            }
+            size_t len = LZ4_MIN_MATCH;
+            while (ip + len < match_limit && src[ip + len] == src[match + len]) {
+                len++;
+            }
+
+            uint8_t* token = op++;
+            op = lz4_emit_literals(op, token, src + anchor, ip - anchor);
+            size_t offset = ip - match;
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            if (len - LZ4_MIN_MATCH >= 15) {
+                *token |= 15;
+                op = lz4_write_length(op, len - LZ4_MIN_MATCH - 15);
+            } else {
+                *token |= (uint8_t)(len - LZ4_MIN_MATCH);
+            }
+
+            ip += len;
+            anchor = ip;
+            if (ip - 2 < mflimit) {
+                table[lz4_hash(read_u32(src + ip - 2))] = (uint32_t)(ip - 2) + 1;
+            }
+        }
+    }
+
+    uint8_t* token = op++;
+    op = lz4_emit_literals(op, token, src + anchor, n - anchor);
+    return (size_t)(op - dst);
+}
+
+/* 输出写到base + prefix处，匹配最远可以引用到base（块依赖模式的历史数据） */
+static long lz4_decompress_block(const uint8_t* src, size_t src_len, uint8_t* base, size_t prefix,
+                                 size_t capacity) {
+    const uint8_t* ip = src;
+    const uint8_t* iend = src + src_len;
+    uint8_t* op = base + prefix;
+    uint8_t* oend = op + capacity;
+
+    for (;;) {
+        if (ip >= iend) {
+            return -1;
+        }
+        unsigned token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            unsigned b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                literals += b;
+            } while (b == 255);
+        }
+        if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op)) {
+            return -1;
+        }
+        memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+
+        if (ip == iend) {
+            break; // 最后一个序列只有字面量
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - base)) {
+            return -1;
+        }
+
+        size_t len = token & 15;
+        if (len == 15) {
+            unsigned b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+        len += LZ4_MIN_MATCH;
+        if (len > (size_t)(oend - op)) {
+            return -1;
+        }
+
+        const uint8_t* match = op - offset;
+        if (offset >= len) {
+            memcpy(op, match, len);
+            op += len;
+        } else {
+            for (size_t i = 0; i < len; i++) {
+                *op++ = *match++; // 重叠复制用于重复模式
+            }
+        }
+    }
+
+    return (long)(op - (base + prefix));
+}
+
+/* ---------- LZ4帧写入 ---------- */
+
+typedef struct {
+    compressed_writer* writer;
+    const uint8_t* data;
+    size_t len;
+} lz4_job;
+
+static void lz4_compress_range(long begin, long end, void* ctx) {
+    lz4_job* jobs = (lz4_job*)ctx;
+    for (long i = begin; i < end; i++) {
+        compressed_writer* w = jobs[i].writer;
+        w->output_sizes[i] = lz4_compress_block(jobs[i].data, jobs[i].len, w->outputs[i], w->tables[i]);
+    }
+}
+
+static int lz4_write_header(compressed_writer* w) {
+    uint8_t header[7];
+    write_le32(header, LZ4_MAGIC);
+    header[4] = 0x64;   /* 版本01，块独立，包含内容校验和 */
+    header[5] = 0x70;   /* 块最大4MB */
+    header[6] = (uint8_t)((xxh32(header + 4, 2, 0) >> 8) & 0xFF);
+    return write_all(w->fd, header, sizeof(header));
+}
+
+static int lz4_flush_blocks(compressed_writer* w) {
+    if (w->staged == 0) {
+        return 1;
+    }
+
+    int blocks = (int)((w->staged + LZ4_BLOCK_SIZE - 1) / LZ4_BLOCK_SIZE);
+    lz4_job jobs[LZ4_MAX_THREADS];
+    for (int i = 0; i < blocks; i++) {
+        size_t offset = (size_t)i * LZ4_BLOCK_SIZE;
+        jobs[i].writer = w;
+        jobs[i].data = w->staging + offset;
+        jobs[i].len = w->staged - offset < LZ4_BLOCK_SIZE ? w->staged - offset : LZ4_BLOCK_SIZE;
+    }
+    // 各块相互独立，在共享线程池中并行压缩
+    parallel_for(NULL, 0, blocks, 1, lz4_compress_range, jobs);
+
+    for (int i = 0; i < blocks; i++) {
+        uint8_t size_field[4];
+        const uint8_t* payload = w->outputs[i];
+        size_t payload_len = w->output_sizes[i];
+        if (payload_len >= jobs[i].len) {
+            // 不可压缩的块按原样存储
+            payload = jobs[i].data;
+            payload_len = jobs[i].len;
+            write_le32(size_field, (uint32_t)payload_len | 0x80000000U);
+        } else {
+            write_le32(size_field, (uint32_t)payload_len);
+        }
+        if (!write_all(w->fd, size_field, 4) || !write_all(w->fd, payload, payload_len)) {
+            return 0;
+        }
+    }
+
+    w->staged = 0;
+    return 1;
+}
+
+static int lz4_writer_init(compressed_writer* w) {
+    if (w->num_threads > LZ4_MAX_THREADS) {
+        w->num_threads = LZ4_MAX_THREADS;
+    }
+    w->staging = (uint8_t*)malloc((size_t)w->num_threads * LZ4_BLOCK_SIZE);
+    w->outputs = (uint8_t**)calloc((size_t)w->num_threads, sizeof(uint8_t*));
+    w->output_sizes = (size_t*)calloc((size_t)w->num_threads, sizeof(size_t));
+    w->tables = (uint32_t**)calloc((size_t)w->num_threads, sizeof(uint32_t*));
+    if (w->staging == NULL || w->outputs == NULL || w->output_sizes == NULL || w->tables == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < w->num_threads; i++) {
+        w->outputs[i] = (uint8_t*)malloc(lz4_compress_bound(LZ4_BLOCK_SIZE));
+        w->tables[i] = (uint32_t*)malloc(sizeof(uint32_t) << LZ4_HASH_LOG);
+        if (w->outputs[i] == NULL || w->tables[i] == NULL) {
+            return 0;
+        }
+    }
+    hash_init(&w->content_hash, HASH_XXH32);
+    return lz4_write_header(w);
+}
+
+static int lz4_writer_write(compressed_writer* w, const uint8_t* p, size_t len) {
+    size_t capacity = (size_t)w->num_threads * LZ4_BLOCK_SIZE;
+    hash_update(&w->content_hash, p, len);
+    while (len > 0) {
+        size_t n = capacity - w->staged;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(w->staging + w->staged, p, n);
+        w->staged += n;
+        p += n;
+        len -= n;
+        if (w->staged == capacity && !lz4_flush_blocks(w)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int lz4_writer_finish(compressed_writer* w) {
+    if (!lz4_flush_blocks(w)) {
+        return 0;
+    }
+    uint8_t trailer[8];
+    unsigned char digest[4];
+    hash_final(&w->content_hash, digest);
+    write_le32(trailer, 0); /* 结束标记 */
+    write_le32(trailer + 4, ((uint32_t)digest[0] << 24) | ((uint32_t)digest[1] << 16) |
+                            ((uint32_t)digest[2] << 8) | digest[3]);
+    return write_all(w->fd, trailer, sizeof(trailer));
+}
+
+/* ---------- zstd写入 ---------- */
+
+static int zstd_writer_init(compressed_writer* w, int level) {
+    w->cctx = ZSTD_createCCtx();
+    w->zout_size = ZSTD_CStreamOutSize();
+    w->zout = (uint8_t*)malloc(w->zout_size);
+    if (w->cctx == NULL || w->zout == NULL) {
+        return 0;
+    }
+    ZSTD_CCtx_setParameter(w->cctx, ZSTD_c_compressionLevel, level != 0 ? level : ZSTD_CLEVEL_DEFAULT);
+    ZSTD_CCtx_setParameter(w->cctx, ZSTD_c_checksumFlag, 1);
+    if (w->num_threads > 1) {
+        // zstd只在输入足够大时才会真正切分任务，小输出不受影响
+        ZSTD_CCtx_setParameter(w->cctx, ZSTD_c_nbWorkers, w->num_threads);
+    }
+    return 1;
+}
+
+static int zstd_writer_stream(compressed_writer* w, const void* data, size_t len, ZSTD_EndDirective mode) {
+    ZSTD_inBuffer in = {data, len, 0};
+    for (;;) {
+        ZSTD_outBuffer out = {w->zout, w->zout_size, 0};
+        size_t remaining = ZSTD_compressStream2(w->cctx, &out, &in, mode);
+        if (ZSTD_isError(remaining)) {
+            error_log(ERR_COMPRESS_ZSTD, ZSTD_getErrorName(remaining));
+            return 0;
+        }
+        if (out.pos > 0 && !write_all(w->fd, w->zout, out.pos)) {
+            return 0;
+        }
+        if (mode == ZSTD_e_end ? remaining == 0 : in.pos == in.size) {
+            return 1;
+        }
+    }
+}
+
+/* ---------- 写入器 ---------- */
+
+static void writer_free(compressed_writer* w) {
+    if (w->outputs != NULL) {
+        for (int i = 0; i < w->num_threads; i++) {
+            free(w->outputs[i]);
+        }
+    }
+    if (w->tables != NULL) {
+        for (int i = 0; i < w->num_threads; i++) {
+            free(w->tables[i]);
+        }
+    }
+    free(w->outputs);
+    free(w->tables);
+    free(w->output_sizes);
+    free(w->staging);
+    free(w->zout);
+    ZSTD_freeCCtx(w->cctx);
+    free(w);
+}
+
+compressed_writer* compressed_writer_open(const char* filename, compress_format format, int level, int num_threads) {
+    debug_print("打开压缩写入器");
+    if (filename == NULL) {
+        error_log(ERR_COMPRESS_NULL, "文件名为NULL");
+        return NULL;
+    }
+
+    compressed_writer* w = (compressed_writer*)calloc(1, sizeof(compressed_writer));
+    if (w == NULL) {
+        error_log(ERR_COMPRESS_ALLOC, "内存分配失败");
+        return NULL;
+    }
+    w->format = format == COMPRESS_AUTO ? compress_format_from_filename(filename) : format;
+    w->num_threads = resolve_threads(num_threads);
+    w->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (w->fd < 0) {
+        error_log_detail(ERR_COMPRESS_OPEN, "无法打开文件", filename);
+        free(w);
+        return NULL;
+    }
+
+    int ok = 1;
+    if (w->format == COMPRESS_LZ4) {
+        ok = lz4_writer_init(w);
+    } else if (w->format == COMPRESS_ZSTD) {
+        ok = zstd_writer_init(w, level);
+    }
+    if (!ok) {
+        error_log(ERR_COMPRESS_ALLOC, "初始化压缩写入器失败");
+        close(w->fd);
+        writer_free(w);
+        return NULL;
+    }
+    return w;
+}
+
+int compressed_writer_write(compressed_writer* writer, const void* data, size_t len) {
+    if (writer == NULL || (data == NULL && len > 0)) {
+        error_log(ERR_COMPRESS_NULL, "写入器或数据为NULL");
+        return 0;
+    }
+    if (writer->failed) {
+        return 0;
+    }
+
+    int ok;
+    if (writer->format == COMPRESS_LZ4) {
+        ok = lz4_writer_write(writer, (const uint8_t*)data, len);
+    } else if (writer->format == COMPRESS_ZSTD) {
+        ok = zstd_writer_stream(writer, data, len, ZSTD_e_continue);
+    } else {
+        ok = write_all(writer->fd, data, len);
+    }
+    if (!ok) {
+        error_log(ERR_COMPRESS_WRITE, "写入压缩数据失败");
+        writer->failed = 1;
+    }
+    return ok;
+}
+
+int compressed_writer_close(compressed_writer* writer) {
+    debug_print("关闭压缩写入器");
+    if (writer == NULL) {
+        error_log(ERR_COMPRESS_NULL, "写入器为NULL");
+        return 0;
+    }
+
+    int ok = !writer->failed;
+    if (ok && writer->format == COMPRESS_LZ4) {
+        ok = lz4_writer_finish(writer);
+    } else if (ok && writer->format == COMPRESS_ZSTD) {
+        ok = zstd_writer_stream(writer, NULL, 0, ZSTD_e_end);
+    }
+    if (close(writer->fd) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        error_log(ERR_COMPRESS_WRITE, "写入压缩数据失败");
+    }
+    writer_free(writer);
+    return ok;
+}
+
+/* ---------- 读取器 ---------- */
+
+/* 从输入缓冲读取恰好len字节，返回实际读取的字节数，出错返回-1 */
+static long reader_read_raw(compressed_reader* r, void* dst, size_t len) {
+    uint8_t* out = (uint8_t*)dst;
+    size_t done = 0;
+    while (done < len) {
+        if (r->in_pos == r->in_len) {
+            ssize_t n = read(r->fd, r->in, READ_BUFFER_SIZE);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                return -1;
+            }
+            if (n == 0) {
+                break;
+            }
+            r->in_pos = 0;
+            r->in_len = (size_t)n;
+        }
+        size_t n = r->in_len - r->in_pos;
+        if (n > len - done) {
+            n = len - done;
+        }
+        memcpy(out + done, r->in + r->in_pos, n);
+        r->in_pos += n;
+        done += n;
+    }
+    return (long)done;
+}
+
+static int reader_read_exact(compressed_reader* r, void* dst, size_t len) {
+    return reader_read_raw(r, dst, len) == (long)len;
+}
+
+static int lz4_reader_corrupt(compressed_reader* r, const char* message) {
+    error_log(ERR_COMPRESS_CORRUPT, message);
+    r->failed = 1;
+    return 0;
+}
+
+/* 读取下一个LZ4帧头，跳过可跳过帧；没有更多帧时设置eof */
+static int lz4_next_frame(compressed_reader* r) {
+    for (;;) {
+        uint8_t magic_bytes[4];
+        long n = reader_read_raw(r, magic_bytes, 4);
+        if (n == 0) {
+            r->eof = 1;
+            return 1;
+        }
+        if (n != 4) {
+            return lz4_reader_corrupt(r, "LZ4帧头不完整");
+        }
+
+        uint32_t magic = read_le32(magic_bytes);
+        if ((magic & LZ4_SKIPPABLE_MASK) == LZ4_SKIPPABLE_MAGIC) {
+            uint8_t size_bytes[4];
+            if (!reader_read_exact(r, size_bytes, 4)) {
+                return lz4_reader_corrupt(r, "LZ4可跳过帧不完整");
+            }
+            uint8_t skip[256];
+            for (uint32_t left = read_le32(size_bytes); left > 0;) {
+                uint32_t step = left < sizeof(skip) ? left : (uint32_t)sizeof(skip);
+                if (!reader_read_exact(r, skip, step)) {
+                    return lz4_reader_corrupt(r, "LZ4可跳过帧不完整");
+                }
+                left -= step;
+            }
+            continue;
+        }
+        if (magic != LZ4_MAGIC) {
+            return lz4_reader_corrupt(r, "不是LZ4帧");
+        }
+
+        uint8_t descriptor[11];
+        if (!reader_read_exact(r, descriptor, 2)) {
+            return lz4_reader_corrupt(r, "LZ4帧描述符不完整");
+        }
+        uint8_t flags = descriptor[0];
+        uint8_t bd = descriptor[1];
+        if ((flags >> 6) != 1 || (flags & 0x02) || (bd & 0x8F) != 0 || ((bd >> 4) & 7) < 4) {
+            return lz4_reader_corrupt(r, "不支持的LZ4帧描述符");
+        }
+        if (flags & 0x01) {
+            error_log(ERR_COMPRESS_UNSUPPORTED, "不支持带字典的LZ4帧");
+            r->failed = 1;
+            return 0;
+        }
+
+        size_t descriptor_len = 2;
+        if (flags & 0x08) {
+            if (!reader_read_exact(r, descriptor + 2, 8)) {
+                return lz4_reader_corrupt(r, "LZ4帧描述符不完整");
+            }
+            descriptor_len += 8; // 内容大小仅用于校验头部，不影响流式解压
+        }
+        uint8_t header_checksum;
+        if (!reader_read_exact(r, &header_checksum, 1) ||
+            header_checksum != (uint8_t)((xxh32(descriptor, descriptor_len, 0) >> 8) & 0xFF)) {
+            return lz4_reader_corrupt(r, "LZ4帧头校验失败");
+        }
+
+        size_t block_max = (size_t)64 * 1024 << (2 * (((bd >> 4) & 7) - 4));
+        if (block_max > r->block_max) {
+            free(r->block_in);
+            free(r->block_out);
+            r->block_in = (uint8_t*)malloc(block_max);
+            r->block_out = (uint8_t*)malloc(LZ4_WINDOW_SIZE + block_max);
+            if (r->block_in == NULL || r->block_out == NULL) {
+                error_log(ERR_COMPRESS_ALLOC, "内存分配失败");
+                r->failed = 1;
+                return 0;
+            }
+            r->block_max = block_max;
+        }
+
+        r->block_independent = (flags & 0x20) != 0;
+        r->block_checksum = (flags & 0x10) != 0;
+        r->content_checksum = (flags & 0x04) != 0;
+        r->history = 0;
+        r->out_pos = 0;
+        r->out_len = 0;
+        r->in_frame = 1;
+        hash_init(&r->content_hash, HASH_XXH32);
+        return 1;
+    }
+}
+
+/* 解码下一个块到block_out；帧结束时处理校验和并进入下一帧 */
+static int lz4_next_block(compressed_reader* r) {
+    while (!r->eof) {
+        if (!r->in_frame) {
+            if (!lz4_next_frame(r)) {
+                return 0;
+            }
+            continue;
+        }
+
+        uint8_t size_bytes[4];
+        if (!reader_read_exact(r, size_bytes, 4)) {
+            return lz4_reader_corrupt(r, "LZ4块头不完整");
+        }
+        uint32_t size_field = read_le32(size_bytes);
+
+        if (size_field == 0) {
+            if (r->content_checksum) {
+                uint8_t checksum[4];
+                unsigned char digest[4];
+                if (!reader_read_exact(r, checksum, 4)) {
+                    return lz4_reader_corrupt(r, "LZ4内容校验和不完整");
+                }
+                hash_final(&r->content_hash, digest);
+                uint32_t expected = ((uint32_t)digest[0] << 24) | ((uint32_t)digest[1] << 16) |
+                                    ((uint32_t)digest[2] << 8) | digest[3];
+                if (read_le32(checksum) != expected) {
+                    error_log(ERR_COMPRESS_CHECKSUM, "LZ4内容校验和不匹配");
+                    r->failed = 1;
+                    return 0;
+                }
+            }
+            r->in_frame = 0;
+            continue;
+        }
+
+        int stored = (size_field & 0x80000000U) != 0;
+        size_t size = size_field & 0x7FFFFFFFU;
+        if (size > r->block_max) {
+            return lz4_reader_corrupt(r, "LZ4块大小超过上限");
+        }
+        if (!reader_read_exact(r, r->block_in, size)) {
+            return lz4_reader_corrupt(r, "LZ4块数据不完整");
+        }
+        if (r->block_checksum) {
+            uint8_t checksum[4];
+            if (!reader_read_exact(r, checksum, 4)) {
+                return lz4_reader_corrupt(r, "LZ4块校验和不完整");
+            }
+            if (read_le32(checksum) != xxh32(r->block_in, size, 0)) {
+                error_log(ERR_COMPRESS_CHECKSUM, "LZ4块校验和不匹配");
+                r->failed = 1;
+                return 0;
+            }
+        }
+
+        // 块依赖模式下保留上一个块最后64KB作为匹配窗口
+        if (r->block_independent) {
+            r->history = 0;
+        } else if (r->out_len > 0) {
+            size_t keep = r->history + r->out_len;
+            if (keep > LZ4_WINDOW_SIZE) {
+                keep = LZ4_WINDOW_SIZE;
+            }
+            memmove(r->block_out, r->block_out + r->history + r->out_len - keep, keep);
+            r->history = keep;
+        }
+
+        long produced;
+        if (stored) {
+            memcpy(r->block_out + r->history, r->block_in, size);
+            produced = (long)size;
+        } else {
+            produced = lz4_decompress_block(r->block_in, size, r->block_out, r->history, r->block_max);
+            if (produced < 0) {
+                return lz4_reader_corrupt(r, "LZ4块数据损坏");
+            }
+        }
+
+        r->out_pos = 0;
+        r->out_len = (size_t)produced;
+        if (r->content_checksum) {
+            hash_update(&r->content_hash, r->block_out + r->history, r->out_len);
+        }
+        if (r->out_len > 0) {
+            return 1;
+        }
+    }
+    return 1;
+}
+
+static long lz4_reader_read(compressed_reader* r, uint8_t* dst, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        if (r->out_pos == r->out_len) {
+            if (r->eof || !lz4_next_block(r)) {
+                break;
+            }
+            if (r->out_pos == r->out_len) {
+                break;
+            }
+        }
+        size_t n = r->out_len - r->out_pos;
+        if (n > size - done) {
+            n = size - done;
+        }
+        memcpy(dst + done, r->block_out + r->history + r->out_pos, n);
+        r->out_pos += n;
+        done += n;
+    }
+    return r->failed ? -1 : (long)done;
+}
+
+static long zstd_reader_read(compressed_reader* r, uint8_t* dst, size_t size) {
+    ZSTD_outBuffer out = {dst, size, 0};
+    while (out.pos < out.size && !r->eof) {
+        if (r->in_pos == r->in_len) {
+            ssize_t n = read(r->fd, r->in, READ_BUFFER_SIZE);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                error_log(ERR_COMPRESS_READ, "读取压缩文件失败");
+                r->failed = 1;
+                return -1;
+            }
+            if (n == 0) {
+                if (!r->zstd_frame_done) {
+                    error_log(ERR_COMPRESS_CORRUPT, "zstd数据不完整");
+                    r->failed = 1;
+                    return -1;
+                }
+                r->eof = 1;
+                break;
+            }
+            r->in_pos = 0;
+            r->in_len = (size_t)n;
+        }
+
+        ZSTD_inBuffer in = {r->in, r->in_len, r->in_pos};
+        size_t ret = ZSTD_decompressStream(r->dstream, &out, &in);
+        r->in_pos = in.pos;
+        if (ZSTD_isError(ret)) {
+            error_log(ERR_COMPRESS_CORRUPT, ZSTD_getErrorName(ret));
+            r->failed = 1;
+            return -1;
+        }
+        r->zstd_frame_done = ret == 0;
+    }
+    return (long)out.pos;
+}
+
+compressed_reader* compressed_reader_open(const char* filename, compress_format format) {
+    debug_print("打开压缩读取器");
+    if (filename == NULL) {
+        error_log(ERR_COMPRESS_NULL, "文件名为NULL");
+        return NULL;
+    }
+
+    compressed_reader* r = (compressed_reader*)calloc(1, sizeof(compressed_reader));
+    if (r == NULL || (r->in = (uint8_t*)malloc(READ_BUFFER_SIZE)) == NULL) {
+        error_log(ERR_COMPRESS_ALLOC, "内存分配失败");
+        free(r);
+        return NULL;
+    }
+    r->fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (r->fd < 0) {
+        error_log_detail(ERR_COMPRESS_OPEN, "无法打开文件", filename);
+        free(r->in);
+        free(r);
+        return NULL;
+    }
+    posix_fadvise(r->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if (format == COMPRESS_AUTO) {
+        // 预读文件头识别格式，预读的数据保留在输入缓冲中
+        while (r->in_len < 4) {
+            ssize_t n = read(r->fd, r->in + r->in_len, READ_BUFFER_SIZE - r->in_len);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            r->in_len += (size_t)n;
+        }
+        format = COMPRESS_NONE;
+        if (r->in_len >= 4) {
+            uint32_t magic = read_le32(r->in);
+            if (magic == LZ4_MAGIC || (magic & LZ4_SKIPPABLE_MASK) == LZ4_SKIPPABLE_MAGIC) {
+                format = COMPRESS_LZ4;
+            } else if (magic == ZSTD_FRAME_MAGIC) {
+                format = COMPRESS_ZSTD;
+            }
+        }
+    }
+    r->format = format;
+
+    if (format == COMPRESS_ZSTD) {
+        r->dstream = ZSTD_createDStream();
+        if (r->dstream == NULL) {
+            error_log(ERR_COMPRESS_ALLOC, "内存分配失败");
+            compressed_reader_close(r);
+            return NULL;
+        }
+        ZSTD_initDStream(r->dstream);
+    }
+    return r;
+}
+
+long compressed_reader_read(compressed_reader* reader, void* buffer, size_t size) {
+    if (reader == NULL || buffer == NULL) {
+        error_log(ERR_COMPRESS_NULL, "读取器或缓冲区为NULL");
+        return -1;
+    }
+    if (reader->failed) {
+        return -1;
+    }
+
+    if (reader->format == COMPRESS_LZ4) {
+        return lz4_reader_read(reader, (uint8_t*)buffer, size);
+    }
+    if (reader->format == COMPRESS_ZSTD) {
+        return zstd_reader_read(reader, (uint8_t*)buffer, size);
+    }
+
+    long n = reader_read_raw(reader, buffer, size);
+    if (n < 0) {
+        error_log(ERR_COMPRESS_READ, "读取文件失败");
+        reader->failed = 1;
+    }
+    return n;
+}
+
+void compressed_reader_close(compressed_reader* reader) {
+    if (reader == NULL) {
+        return;
+    }
+    close(reader->fd);
+    ZSTD_freeDStream(reader->dstream);
+    free(reader->block_in);
+    free(reader->block_out);
+    free(reader->in);
+    free(reader);
+}
+
+/* ---------- 文件级接口 ---------- */
+
+char* read_file_compressed(const char* filename, compress_format format) {
+    debug_print("读取压缩文件内容");
+    compressed_reader* r = compressed_reader_open(filename, format);
+    if (r == NULL) {
+        return NULL;
+    }
+
+    size_t capacity = COPY_BUFFER_SIZE;
+    size_t length = 0;
+    char* content = (char*)mem_alloc(capacity + 1);
+    if (content == NULL) {
+        error_log(ERR_COMPRESS_ALLOC, "内存分配失败");
+        compressed_reader_close(r);
+        return NULL;
+    }
+
+    for (;;) {
+        if (length == capacity) {
+            char* grown = (char*)mem_realloc(content, capacity * 2 + 1);
+            if (grown == NULL) {
+                error_log(ERR_COMPRESS_ALLOC, "内存分配失败");
+                mem_free(content);
+                compressed_reader_close(r);
+                return NULL;
+            }
+            content = grown;
+            capacity *= 2;
+        }
+        long n = compressed_reader_read(r, content + length, capacity - length);
+        if (n < 0) {
+            mem_free(content);
+            compressed_reader_close(r);
+            return NULL;
+        }
+        if (n == 0) {
+            break;
+        }
+        length += (size_t)n;
+    }
+
+    content[length] = '\0';
+    compressed_reader_close(r);
+    return content;
+}
+
+int write_file_compressed(const char* filename, const char* content, compress_format format) {
+    debug_print("写入压缩文件内容");
+    if (filename == NULL || content == NULL) {
+        error_log(ERR_COMPRESS_NULL, "文件名或内容为NULL");
+        return 0;
+    }
+
+    compressed_writer* w = compressed_writer_open(filename, format, COMPRESS_DEFAULT_LEVEL, 0);
+    if (w == NULL) {
+        return 0;
+    }
+    int ok = compressed_writer_write(w, content, strlen(content));
+    return compressed_writer_close(w) && ok;
+}
+
+int compress_file(const char* source, const char* destination, compress_format format, int level) {
+    debug_print("压缩文件");
+    if (source == NULL || destination == NULL) {
+        error_log(ERR_COMPRESS_NULL, "源文件或目标文件为NULL");
+        return 0;
+    }
+
+    compressed_reader* r = compressed_reader_open(source, COMPRESS_NONE);
+    if (r == NULL) {
+        return 0;
+    }
+    compressed_writer* w = compressed_writer_open(destination, format, level, 0);
+    if (w == NULL) {
+        compressed_reader_close(r);
+        return 0;
+    }
+
+    int ok = 1;
+    char* buffer = (char*)malloc(COPY_BUFFER_SIZE);
+    if (buffer == NULL) {
+        error_log(ERR_COMPRESS_ALLOC, "内存分配失败");
+        ok = 0;
+    }
+    while (ok) {
+        long n = compressed_reader_read(r, buffer, COPY_BUFFER_SIZE);
+        if (n <= 0) {
+            ok = n == 0;
+            break;
+        }
+        ok = compressed_writer_write(w, buffer, (size_t)n);
+    }
+
+    free(buffer);
+    compressed_reader_close(r);
+    return compressed_writer_close(w) && ok;
+}
+
+int decompress_file(const char* source, const char* destination) {
+    debug_print("解压文件");
+    if (source == NULL || destination == NULL) {
+        error_log(ERR_COMPRESS_NULL, "源文件或目标文件为NULL");
+        return 0;
+    }
+
+    compressed_reader* r = compressed_reader_open(source, COMPRESS_AUTO);
+    if (r == NULL) {
+        return 0;
+    }
+    compressed_writer* w = compressed_writer_open(destination, COMPRESS_NONE, 0, 1);
+    if (w == NULL) {
+        compressed_reader_close(r);
+        return 0;
+    }
+
+    int ok = 1;
+    char* buffer = (char*)malloc(COPY_BUFFER_SIZE);
+    if (buffer == NULL) {
+        error_log(ERR_COMPRESS_ALLOC, "内存分配失败");
+        ok = 0;
+    }
+    while (ok) {
+        long n = compressed_reader_read(r, buffer, COPY_BUFFER_SIZE);
+        if (n <= 0) {
+            ok = n == 0;
+            break;
+        }
+        ok = compressed_writer_write(w, buffer, (size_t)n);
+    }
+
+    free(buffer);
+    compressed_reader_close(r);
+    return compressed_writer_close(w) && ok;
+}
+
+static int module_init(void) {
+    debug_print("压缩库初始化成功");
+    return 1;
+}
+
+int initialize_compress_ops() {
+    return module_init_once(MODULE_COMPRESS, module_init);
+}
\ No newline at end of file
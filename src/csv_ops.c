@@ -0,0 +1,957 @@
+/**
+ * @file csv_ops.c
+ * @brief CSV列式读取实现
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <immintrin.h>
+#include "../include/csv_ops.h"
+#include "../include/module.h"
+#include "../include/number_ops.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+
+/* 结构字符扫描的块大小，每块得到一个64位掩码 */
+#define CSV_BLOCK 64
+/* 超过该长度的文本分段并行解析 */
+#define CSV_PARALLEL_THRESHOLD (1 << 20)
+#define CSV_MIN_SEGMENT (256 * 1024)
+/* 每段列数组的初始行数，之后按两倍增长 */
+#define CSV_INITIAL_ROWS 1024
+/* 列统计时每个任务处理的值的个数 */
+#define STATS_BLOCK 65536
+
+/* ---------- 结构字符扫描 ---------- */
+
+typedef struct {
+    uint64_t quote;
+    uint64_t delimiter;
+    uint64_t newline;
+} block_masks;
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+static int has_avx2 = 0;
+
+static void init_tables(void) {
+    __builtin_cpu_init();
+    has_avx2 = __builtin_cpu_supports("avx2");
+}
+
+static inline void ensure_tables(void) {
+    pthread_once(&tables_once, init_tables);
+}
+
+__attribute__((target("avx2")))
+static void scan_block_avx2(const uint8_t* p, char delimiter, block_masks* m) {
+    __m256i lo = _mm256_loadu_si256((const __m256i*)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)(p + 32));
+    __m256i quote = _mm256_set1_epi8('"');
+    __m256i delim = _mm256_set1_epi8(delimiter);
+    __m256i newline = _mm256_set1_epi8('\n');
+    m->quote = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote)) |
+               (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)) << 32;
+    m->delimiter = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, delim)) |
+                   (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, delim)) << 32;
+    m->newline = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline)) |
+                 (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)) << 32;
+}
+
+static void scan_block_sse2(const uint8_t* p, char delimiter, block_masks* m) {
+    __m128i quote = _mm_set1_epi8('"');
+    __m128i delim = _mm_set1_epi8(delimiter);
+    __m128i newline = _mm_set1_epi8('\n');
+    m->quote = 0;
+    m->delimiter = 0;
+    m->newline = 0;
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+        m->quote |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << (16 * i);
+        m->delimiter |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, delim)) << (16 * i);
+        m->newline |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)) << (16 * i);
+    }
+}
+
+/* 扫描data[pos, pos + available)开头的一块，不足一块时只有前available位有效 */
+static inline void scan_block(const char* data, size_t pos, size_t available, char delimiter, block_masks* m) {
+    const uint8_t* p = (const uint8_t*)data + pos;
+    uint8_t padded[CSV_BLOCK];
+    if (available < CSV_BLOCK) {
+        memset(padded, 0, sizeof(padded));
+        memcpy(padded, p, available);
+        p = padded;
+    }
+    if (has_avx2) {
+        scan_block_avx2(p, delimiter, m);
+    } else {
+        scan_block_sse2(p, delimiter, m);
+    }
+    if (available < CSV_BLOCK) {
+        uint64_t valid = (1ULL << available) - 1;
+        m->quote &= valid;
+        m->delimiter &= valid;
+        m->newline &= valid;
+    }
+}
+
+/* 每一位为该位及之前引号个数的奇偶，即该位是否在引号内（开引号计入，闭引号不计入） */
+static inline uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/* 按块扫描[begin, end)，依次取出引号外的分隔符与换行 */
+typedef struct {
+    const char* data;
+    size_t block;            /* 当前块的起点 */
+    size_t end;
+    char delimiter;
+    uint64_t pending;        /* 当前块中尚未取出的结构字符 */
+    uint64_t newlines;       /* 当前块中引号外的换行 */
+    uint64_t quotes;         /* 当前块中的引号 */
+    uint64_t inside;         /* 当前块结束时在引号内为全1，否则为0 */
+    size_t quotes_before;    /* 当前块之前的引号个数 */
+} csv_scanner;
+
+static void scanner_load(csv_scanner* s) {
+    size_t available = s->end - s->block;
+    block_masks m;
+    scan_block(s->data, s->block, available < CSV_BLOCK ? available : CSV_BLOCK, s->delimiter, &m);
+    uint64_t in_quotes = prefix_xor(m.quote) ^ s->inside;
+    s->inside = (uint64_t)((int64_t)in_quotes >> 63);
+    s->quotes = m.quote;
+    s->newlines = m.newline & ~in_quotes;
+    s->pending = (m.delimiter | m.newline) & ~in_quotes;
+}
+
+static void scanner_init(csv_scanner* s, const char* data, size_t begin, size_t end, char delimiter, int inside) {
+    s->data = data;
+    s->block = begin;
+    s->end = end;
+    s->delimiter = delimiter;
+    s->pending = 0;
+    s->newlines = 0;
+    s->quotes = 0;
+    s->inside = inside ? ~0ULL : 0;
+    s->quotes_before = 0;
+    if (begin < end) {
+        scanner_load(s);
+    }
+}
+
+/* 取出下一个结构字符的位置，没有时返回end；*newline为1表示该字符是换行 */
+static inline size_t scanner_next(csv_scanner* s, int* newline) {
+    while (s->pending == 0) {
+        if (s->end - s->block <= CSV_BLOCK) {
+            *newline = 0;
+            return s->end;
+        }
+        s->quotes_before += (size_t)__builtin_popcountll(s->quotes);
+        s->block += CSV_BLOCK;
+        scanner_load(s);
+    }
+    int bit = __builtin_ctzll(s->pending);
+    s->pending &= s->pending - 1;
+    *newline = (int)((s->newlines >> bit) & 1);
+    return s->block + (size_t)bit;
+}
+
+/* 扫描起点到position（不超过当前块的末尾）之间的引号个数 */
+static inline size_t scanner_quotes(const csv_scanner* s, size_t position) {
+    if (s->quotes == 0) {
+        return s->quotes_before;
+    }
+    size_t bit = position - s->block;
+    uint64_t below = bit >= CSV_BLOCK ? ~0ULL : (1ULL << bit) - 1;
+    return s->quotes_before + (size_t)__builtin_popcountll(s->quotes & below);
+}
+
+/* ---------- 字段 ---------- */
+
+typedef struct {
+    size_t begin;        /* 内容的起点（带引号字段不含开引号） */
+    size_t end;
+    size_t quotes;       /* 字段中的引号个数 */
+} csv_field;
+
+/* 检查字段的引号并去掉两侧的引号：无引号字段原样使用，带引号字段内部的引号必须成对 */
+static int field_unquote(const char* data, csv_field* f) {
+    if (f->quotes == 0) {
+        return 1;
+    }
+    if (f->end - f->begin < 2 || data[f->begin] != '"' || data[f->end - 1] != '"') {
+        return 0;
+    }
+    f->begin++;
+    f->end--;
+    for (size_t i = f->begin; f->quotes > 2 && i < f->end; i++) {
+        if (data[i] == '"') {
+            if (i + 1 >= f->end || data[i + 1] != '"') {
+                return 0;
+            }
+            i++;
+        }
+    }
+    return 1;
+}
+
+/* 去掉转义后的长度 */
+static inline size_t field_length(const csv_field* f) {
+    size_t len = f->end - f->begin;
+    return f->quotes > 2 ? len - (f->quotes - 2) / 2 : len;
+}
+
+/* 复制去掉转义的内容并加上'\0'，返回写入的字节数 */
+static size_t field_copy(const char* data, const csv_field* f, char* out) {
+    size_t len = f->end - f->begin;
+    if (f->quotes <= 2) {
+        memcpy(out, data + f->begin, len);
+        out[len] = '\0';
+        return len + 1;
+    }
+    size_t written = 0;
+    for (size_t i = f->begin; i < f->end; i++) {
+        out[written++] = data[i];
+        if (data[i] == '"') {
+            i++;
+        }
+    }
+    out[written] = '\0';
+    return written + 1;
+}
+
+/* ---------- 分段解析 ---------- */
+
+typedef struct {
+    csv_type type;           /* 本段中的字段推断出的类型 */
+    uint64_t* slots;         /* CSV_INT64时存int64_t，CSV_DOUBLE时存double的位模式，CSV_STRING时为NULL */
+    size_t text_bytes;       /* 按字符串存放时需要的字节数（含'\0'） */
+} segment_column;
+
+typedef struct {
+    size_t begin;            /* 段的起点是行首，终点是行尾（换行之后）或文本末尾 */
+    size_t end;
+    size_t rows;
+    size_t capacity;
+    segment_column* columns;
+    error_code error;
+    size_t error_offset;
+} csv_segment;
+
+typedef struct {
+    const char* data;
+    size_t len;
+    char delimiter;
+    int column_count;
+    int segment_count;
+    const size_t* chunk_starts;    /* 分段前的等长分块：第i块为[chunk_starts[i], chunk_starts[i + 1]) */
+    size_t* chunk_quotes;          /* 各块中的引号个数 */
+    csv_segment* segments;
+    csv_table* table;
+    size_t* first_rows;            /* 各段第一行在表中的行号 */
+    size_t* text_starts;           /* [段 * column_count + 列]：该段字符串在列text中的起点 */
+} csv_job;
+
+static inline void store_double(uint64_t* slot, double value) {
+    memcpy(slot, &value, sizeof(value));
+}
+
+static void column_to_string(segment_column* c) {
+    free(c->slots);
+    c->slots = NULL;
+    c->type = CSV_STRING;
+}
+
+/* 整数列遇到非整数时转为浮点列，已有的值原地转换（int64_t到double按最近偶数舍入，与解析十进制文本的结果相同） */
+static void column_to_double(segment_column* c, size_t rows) {
+    for (size_t i = 0; i < rows; i++) {
+        store_double(&c->slots[i], (double)(int64_t)c->slots[i]);
+    }
+    c->type = CSV_DOUBLE;
+}
+
+static void store_field(const char* data, const csv_field* f, segment_column* c, size_t row) {
+    c->text_bytes += field_length(f) + 1;
+    if (c->type == CSV_STRING) {
+        return;
+    }
+    if (f->quotes > 2) {
+        column_to_string(c);
+        return;
+    }
+    const char* text = data + f->begin;
+    size_t len = f->end - f->begin;
+    if (c->type == CSV_INT64) {
+        int64_t value;
+        if (try_parse_int64(text, len, &value)) {
+            c->slots[row] = (uint64_t)value;
+            return;
+        }
+        column_to_double(c, row);
+    }
+    double value = __builtin_nan("");
+    if (len > 0 && !try_parse_double(text, len, &value)) {
+        column_to_string(c);
+        return;
+    }
+    store_double(&c->slots[row], value);
+}
+
+static int segment_grow(csv_segment* seg, int column_count) {
+    size_t capacity = seg->capacity > 0 ? seg->capacity * 2 : CSV_INITIAL_ROWS;
+    for (int j = 0; j < column_count; j++) {
+        segment_column* c = &seg->columns[j];
+        if (c->type == CSV_STRING) {
+            continue;
+        }
+        uint64_t* grown = (uint64_t*)realloc(c->slots, capacity * sizeof(uint64_t));
+        if (grown == NULL) {
+            return 0;
+        }
+        c->slots = grown;
+    }
+    seg->capacity = capacity;
+    return 1;
+}
+
+static void segment_fail(csv_segment* seg, error_code code, size_t offset) {
+    seg->error = code;
+    seg->error_offset = offset;
+}
+
+/*
+ * 逐行解析一段。第一遍（copy_strings为0）检查格式、推断类型并保存数值；
+ * 第二遍只把最终类型为字符串的列复制到表中，格式已在第一遍检查过
+ */
+static void parse_segment(csv_job* job, csv_segment* seg, int copy_strings, size_t first_row) {
+    const char* data = job->data;
+    csv_scanner s;
+    scanner_init(&s, data, seg->begin, seg->end, job->delimiter, 0);
+    csv_field f = {seg->begin, seg->begin, 0};
+    size_t quotes_start = 0;
+    size_t row_start = seg->begin;
+    size_t row = 0;
+    int column = 0;
+    for (;;) {
+        int newline;
+        size_t sep = scanner_next(&s, &newline);
+        int row_end = newline || sep == seg->end;
+        size_t quotes_end = scanner_quotes(&s, sep);
+        f.end = sep;
+        f.quotes = quotes_end - quotes_start;
+        if (row_end && f.end > f.begin && data[f.end - 1] == '\r') {
+            f.end--;
+        }
+        if (row_end && column == 0 && f.end == f.begin) {
+            // 空行，或最后一行的换行之后
+            if (sep == seg->end) {
+                break;
+            }
+        } else {
+            if (column >= job->column_count) {
+                segment_fail(seg, ERR_CSV_FIELD_COUNT, row_start);
+                return;
+            }
+            if (!copy_strings) {
+                if (!field_unquote(data, &f)) {
+                    segment_fail(seg, ERR_CSV_QUOTE, f.begin);
+                    return;
+                }
+                if (column == 0 && row == seg->capacity && !segment_grow(seg, job->column_count)) {
+                    segment_fail(seg, ERR_CSV_ALLOC, row_start);
+                    return;
+                }
+                store_field(data, &f, &seg->columns[column], row);
+            } else {
+                csv_column* out = &job->table->columns[column];
+                if (out->type == CSV_STRING) {
+                    field_unquote(data, &f);
+                    size_t* next = &job->text_starts[(seg - job->segments) * job->column_count + column];
+                    out->offsets[first_row + row] = *next;
+                    *next += field_copy(data, &f, out->text + *next);
+                }
+            }
+            column++;
+            if (row_end) {
+                if (column != job->column_count) {
+                    segment_fail(seg, ERR_CSV_FIELD_COUNT, row_start);
+                    return;
+                }
+                row++;
+                column = 0;
+            }
+            if (sep == seg->end) {
+                break;
+            }
+        }
+        f.begin = sep + 1;
+        quotes_start = quotes_end;
+        if (row_end) {
+            row_start = sep + 1;
+        }
+    }
+    if (s.inside) {
+        segment_fail(seg, ERR_CSV_QUOTE, row_start);
+        return;
+    }
+    seg->rows = row;
+}
+
+static void count_chunk_quotes(long begin, long end, void* ctx) {
+    csv_job* job = (csv_job*)ctx;
+    for (long i = begin; i < end; i++) {
+        size_t count = 0;
+        for (size_t pos = job->chunk_starts[i]; pos < job->chunk_starts[i + 1]; pos += CSV_BLOCK) {
+            size_t available = job->chunk_starts[i + 1] - pos;
+            block_masks m;
+            scan_block(job->data, pos, available < CSV_BLOCK ? available : CSV_BLOCK, job->delimiter, &m);
+            count += (size_t)__builtin_popcountll(m.quote);
+        }
+        job->chunk_quotes[i] = count;
+    }
+}
+
+/* 第i段从第i块中（按该块起点的引号状态）第一个引号外的换行之后开始 */
+static void find_segment_starts(long begin, long end, void* ctx) {
+    csv_job* job = (csv_job*)ctx;
+    for (long i = begin; i < end; i++) {
+        csv_scanner s;
+        scanner_init(&s, job->data, job->chunk_starts[i], job->len, job->delimiter,
+                     (int)(job->chunk_quotes[i] & 1));
+        int newline = 0;
+        size_t pos;
+        do {
+            pos = scanner_next(&s, &newline);
+        } while (!newline && pos < job->len);
+        job->segments[i].begin = newline ? pos + 1 : job->len;
+    }
+}
+
+static void parse_segments(long begin, long end, void* ctx) {
+    csv_job* job = (csv_job*)ctx;
+    for (long i = begin; i < end; i++) {
+        parse_segment(job, &job->segments[i], 0, 0);
+    }
+}
+
+/* 第二遍：把各段的数值复制（或转换）到表的列数组，并复制字符串列 */
+static void fill_segments(long begin, long end, void* ctx) {
+    csv_job* job = (csv_job*)ctx;
+    for (long i = begin; i < end; i++) {
+        csv_segment* seg = &job->segments[i];
+        size_t first = job->first_rows[i];
+        int has_strings = 0;
+        for (int j = 0; j < job->column_count; j++) {
+            csv_column* out = &job->table->columns[j];
+            const segment_column* c = &seg->columns[j];
+            if (out->type == CSV_STRING) {
+                has_strings = 1;
+            } else if (seg->rows == 0 || c->slots == NULL) {
+                continue;    // 只有一段时列数组已直接取自该段
+            } else if (out->type == c->type) {
+                memcpy(out->type == CSV_INT64 ? (void*)(out->ints + first) : (void*)(out->doubles + first),
+                       c->slots, seg->rows * sizeof(uint64_t));
+            } else {
+                for (size_t r = 0; r < seg->rows; r++) {
+                    out->doubles[first + r] = (double)(int64_t)c->slots[r];
+                }
+            }
+        }
+        if (has_strings && seg->rows > 0) {
+            parse_segment(job, seg, 1, first);
+        }
+    }
+}
+
+/* ---------- 表 ---------- */
+
+const char* csv_type_name(csv_type type) {
+    switch (type) {
+        case CSV_INT64: return "int64";
+        case CSV_DOUBLE: return "double";
+        default: return "string";
+    }
+}
+
+csv_options csv_default_options() {
+    csv_options options = {',', 1};
+    return options;
+}
+
+void csv_free_table(csv_table* table) {
+    if (table == NULL) {
+        return;
+    }
+    for (int j = 0; j < table->column_count; j++) {
+        free(table->columns[j].name);
+        free(table->columns[j].ints);
+        free(table->columns[j].doubles);
+        free(table->columns[j].text);
+        free(table->columns[j].offsets);
+    }
+    free(table->columns);
+    free(table);
+}
+
+int csv_find_column(const csv_table* table, const char* name) {
+    if (table == NULL || name == NULL) {
+        return -1;
+    }
+    for (int j = 0; j < table->column_count; j++) {
+        if (strcmp(table->columns[j].name, name) == 0) {
+            return j;
+        }
+    }
+    return -1;
+}
+
+/* 读取第一个非空行：确定列数，有表头时取出列名；*data_start为数据的起点 */
+static error_code read_first_row(const char* data, size_t len, const csv_options* options, csv_table* table,
+                                 size_t* data_start) {
+    csv_scanner s;
+    scanner_init(&s, data, 0, len, options->delimiter, 0);
+    csv_field fields_inline[16];
+    csv_field* fields = fields_inline;
+    int capacity = 16;
+    int count = 0;
+    csv_field f = {0, 0, 0};
+    size_t quotes_start = 0;
+    size_t row_start = 0;
+    error_code code = ERR_OK;
+    for (;;) {
+        int newline;
+        size_t sep = scanner_next(&s, &newline);
+        int row_end = newline || sep == len;
+        size_t quotes_end = scanner_quotes(&s, sep);
+        f.end = sep;
+        f.quotes = quotes_end - quotes_start;
+        if (row_end && f.end > f.begin && data[f.end - 1] == '\r') {
+            f.end--;
+        }
+        if (!(row_end && count == 0 && f.end == f.begin)) {
+            if (!field_unquote(data, &f)) {
+                code = ERR_CSV_QUOTE;
+                break;
+            }
+            if (count == capacity) {
+                csv_field* grown = (csv_field*)malloc((size_t)capacity * 2 * sizeof(csv_field));
+                if (grown == NULL) {
+                    code = ERR_CSV_ALLOC;
+                    break;
+                }
+                memcpy(grown, fields, (size_t)count * sizeof(csv_field));
+                if (fields != fields_inline) {
+                    free(fields);
+                }
+                fields = grown;
+                capacity *= 2;
+            }
+            fields[count++] = f;
+        }
+        f.begin = sep + 1;
+        quotes_start = quotes_end;
+        if (row_end && count > 0) {
+            *data_start = options->has_header ? (sep < len ? sep + 1 : len) : row_start;
+            break;
+        }
+        if (sep == len) {
+            *data_start = len;
+            break;
+        }
+        if (row_end) {
+            row_start = sep + 1;
+        }
+    }
+
+    if (code == ERR_OK && count > 0) {
+        table->columns = (csv_column*)calloc((size_t)count, sizeof(csv_column));
+        if (table->columns == NULL) {
+            code = ERR_CSV_ALLOC;
+        } else {
+            table->column_count = count;
+            for (int j = 0; j < count && code == ERR_OK; j++) {
+                char generated[32];
+                size_t length = options->has_header ? field_length(&fields[j]) + 1
+                                                    : (size_t)snprintf(generated, sizeof(generated), "column%d",
+                                                                       j + 1) + 1;
+                table->columns[j].name = (char*)malloc(length);
+                if (table->columns[j].name == NULL) {
+                    code = ERR_CSV_ALLOC;
+                } else if (options->has_header) {
+                    field_copy(data, &fields[j], table->columns[j].name);
+                } else {
+                    memcpy(table->columns[j].name, generated, length);
+                }
+            }
+        }
+    }
+    if (fields != fields_inline) {
+        free(fields);
+    }
+    return code;
+}
+
+/* 把文本[start, len)划分为按行对齐的段 */
+static error_code plan_segments(csv_job* job, size_t start) {
+    size_t size = job->len - start;
+    int count = 1;
+    if (size >= CSV_PARALLEL_THRESHOLD) {
+        count = thread_pool_size(NULL) * 4;
+        if ((size_t)count > size / CSV_MIN_SEGMENT) {
+            count = (int)(size / CSV_MIN_SEGMENT);
+        }
+    }
+    job->segment_count = count;
+    job->segments = (csv_segment*)calloc((size_t)count, sizeof(csv_segment));
+    if (job->segments == NULL) {
+        return ERR_CSV_ALLOC;
+    }
+    job->segments[0].begin = start;
+    if (count > 1) {
+        size_t* chunk_starts = (size_t*)malloc(((size_t)count + 1) * sizeof(size_t));
+        size_t* chunk_quotes = (size_t*)malloc(((size_t)count + 1) * sizeof(size_t));
+        if (chunk_starts == NULL || chunk_quotes == NULL) {
+            free(chunk_starts);
+            free(chunk_quotes);
+            return ERR_CSV_ALLOC;
+        }
+        for (int i = 0; i <= count; i++) {
+            chunk_starts[i] = start + size / (size_t)count * (size_t)i;
+        }
+        chunk_starts[count] = job->len;
+        job->chunk_starts = chunk_starts;
+        job->chunk_quotes = chunk_quotes;
+        // 各块的引号个数并行统计，前缀和的奇偶即各块起点是否在引号内
+        parallel_for(NULL, 0, count, 1, count_chunk_quotes, job);
+        size_t prefix = 0;
+        for (int i = 0; i < count; i++) {
+            size_t quotes = chunk_quotes[i];
+            chunk_quotes[i] = prefix;
+            prefix += quotes;
+        }
+        parallel_for(NULL, 1, count, 1, find_segment_starts, job);
+        free(chunk_starts);
+        free(chunk_quotes);
+        job->chunk_starts = NULL;
+        job->chunk_quotes = NULL;
+    }
+    // 一行跨过多个块时，中间的段为空
+    for (int i = 1; i < count; i++) {
+        if (job->segments[i].begin < job->segments[i - 1].begin) {
+            job->segments[i].begin = job->segments[i - 1].begin;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        job->segments[i].end = i + 1 < count ? job->segments[i + 1].begin : job->len;
+    }
+    return ERR_OK;
+}
+
+static void free_segments(csv_job* job) {
+    for (int i = 0; i < job->segment_count && job->segments != NULL; i++) {
+        if (job->segments[i].columns != NULL) {
+            for (int j = 0; j < job->column_count; j++) {
+                free(job->segments[i].columns[j].slots);
+            }
+            free(job->segments[i].columns);
+        }
+    }
+    free(job->segments);
+    free(job->first_rows);
+    free(job->text_starts);
+}
+
+/* 合并各段：确定各列的最终类型并分配列数组，只有一段时数值列直接取用该段的数组 */
+static error_code allocate_columns(csv_job* job) {
+    csv_table* table = job->table;
+    int columns = job->column_count;
+    job->first_rows = (size_t*)malloc((size_t)job->segment_count * sizeof(size_t));
+    job->text_starts = (size_t*)malloc((size_t)job->segment_count * (size_t)columns * sizeof(size_t));
+    if (job->first_rows == NULL || job->text_starts == NULL) {
+        return ERR_CSV_ALLOC;
+    }
+    size_t rows = 0;
+    for (int i = 0; i < job->segment_count; i++) {
+        job->first_rows[i] = rows;
+        rows += job->segments[i].rows;
+    }
+    table->row_count = rows;
+    for (int j = 0; j < columns; j++) {
+        csv_column* out = &table->columns[j];
+        out->type = CSV_INT64;
+        size_t text_bytes = 0;
+        for (int i = 0; i < job->segment_count; i++) {
+            const segment_column* c = &job->segments[i].columns[j];
+            job->text_starts[i * columns + j] = text_bytes;
+            text_bytes += c->text_bytes;
+            if (job->segments[i].rows > 0 && c->type > out->type) {
+                out->type = c->type;
+            }
+        }
+        if (rows == 0) {
+            continue;
+        }
+        if (out->type == CSV_STRING) {
+            out->text = (char*)malloc(text_bytes);
+            out->offsets = (size_t*)malloc(rows * sizeof(size_t));
+            if (out->text == NULL || out->offsets == NULL) {
+                return ERR_CSV_ALLOC;
+            }
+            continue;
+        }
+        segment_column* only = job->segment_count == 1 ? &job->segments[0].columns[j] : NULL;
+        if (only != NULL && only->type == out->type) {
+            // 交出该段的数组，由表负责释放
+            void* slots = only->slots;
+            only->slots = NULL;
+            if (out->type == CSV_INT64) {
+                out->ints = (int64_t*)slots;
+            } else {
+                out->doubles = (double*)slots;
+            }
+            continue;
+        }
+        if (out->type == CSV_INT64) {
+            out->ints = (int64_t*)malloc(rows * sizeof(int64_t));
+        } else {
+            out->doubles = (double*)malloc(rows * sizeof(double));
+        }
+        if (out->ints == NULL && out->doubles == NULL) {
+            return ERR_CSV_ALLOC;
+        }
+    }
+    return ERR_OK;
+}
+
+static error_code csv_fail(error_code code, size_t offset) {
+    char detail[32];
+    snprintf(detail, sizeof(detail), "偏移%zu", offset);
+    const char* message = code == ERR_CSV_QUOTE ? "引号不成对或引号外有多余字符"
+                        : code == ERR_CSV_FIELD_COUNT ? "字段数与第一行不同"
+                        : "内存分配失败";
+    error_log_detail(code, message, detail);
+    return code;
+}
+
+error_code csv_parse_buffer(const char* data, size_t len, const csv_options* options, csv_table** table) {
+    debug_print("解析CSV");
+    if (table == NULL || (data == NULL && len > 0)) {
+        return error_raise(ERR_CSV_NULL, "文本或输出参数为NULL");
+    }
+    *table = NULL;
+    csv_options defaults = csv_default_options();
+    if (options == NULL) {
+        options = &defaults;
+    }
+    char delimiter = options->delimiter;
+    if (delimiter == '"' || delimiter == '\n' || delimiter == '\r' || delimiter == '\0') {
+        return error_raise(ERR_CSV_INVALID_ARGUMENT, "分隔符不能是引号、'\\r'、换行或'\\0'");
+    }
+    ensure_tables();
+
+    csv_table* result = (csv_table*)calloc(1, sizeof(csv_table));
+    if (result == NULL) {
+        return error_raise(ERR_CSV_ALLOC, "内存分配失败");
+    }
+    size_t data_start = 0;
+    error_code code = read_first_row(data, len, options, result, &data_start);
+    if (code != ERR_OK) {
+        csv_free_table(result);
+        return csv_fail(code, 0);
+    }
+    if (result->column_count == 0) {
+        *table = result;
+        return ERR_OK;
+    }
+
+    csv_job job;
+    memset(&job, 0, sizeof(job));
+    job.data = data;
+    job.len = len;
+    job.delimiter = delimiter;
+    job.column_count = result->column_count;
+    job.table = result;
+    code = plan_segments(&job, data_start);
+    for (int i = 0; i < job.segment_count && code == ERR_OK; i++) {
+        job.segments[i].columns = (segment_column*)calloc((size_t)job.column_count, sizeof(segment_column));
+        if (job.segments[i].columns == NULL) {
+            code = ERR_CSV_ALLOC;
+        }
+    }
+    size_t error_offset = 0;
+    if (code == ERR_OK) {
+        if (job.segment_count > 1) {
+            parallel_for(NULL, 0, job.segment_count, 1, parse_segments, &job);
+        } else {
+            parse_segments(0, 1, &job);
+        }
+        // 按文本顺序报告第一个错误
+        for (int i = 0; i < job.segment_count && code == ERR_OK; i++) {
+            code = job.segments[i].error;
+            error_offset = job.segments[i].error_offset;
+        }
+    }
+    if (code == ERR_OK) {
+        code = allocate_columns(&job);
+    }
+    if (code == ERR_OK) {
+        if (job.segment_count > 1) {
+            parallel_for(NULL, 0, job.segment_count, 1, fill_segments, &job);
+        } else {
+            fill_segments(0, 1, &job);
+        }
+    }
+    free_segments(&job);
+    if (code != ERR_OK) {
+        csv_free_table(result);
+        return csv_fail(code, error_offset);
+    }
+    *table = result;
+    return ERR_OK;
+}
+
+/* 将文件映射为只读视图，空文件返回NULL且size为0 */
+static int map_file(const char* filename, const char** data, size_t* size) {
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return 0;
+    }
+    *size = (size_t)st.st_size;
+    *data = NULL;
+    if (*size > 0) {
+        void* mapped = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            return 0;
+        }
+        // madvise的建议值是编号而不是标志位，每种建议单独调用一次
+        madvise(mapped, *size, MADV_SEQUENTIAL);
+        madvise(mapped, *size, MADV_WILLNEED);
+        *data = (const char*)mapped;
+    }
+    close(fd);
+    return 1;
+}
+
+error_code csv_read_file(const char* filename, const csv_options* options, csv_table** table) {
+    debug_print("读取CSV文件");
+    if (filename == NULL || table == NULL) {
+        return error_raise(ERR_CSV_NULL, "文件名或输出参数为NULL");
+    }
+    *table = NULL;
+    const char* data = NULL;
+    size_t size = 0;
+    if (!map_file(filename, &data, &size)) {
+        error_log_detail(ERR_CSV_OPEN, "无法打开或映射文件", filename);
+        return ERR_CSV_OPEN;
+    }
+    error_code code = csv_parse_buffer(data, size, options, table);
+    if (data != NULL) {
+        munmap((void*)data, size);
+    }
+    return code;
+}
+
+/* ---------- 列统计 ---------- */
+
+typedef struct {
+    const csv_column* column;
+    size_t rows;
+    csv_stats* partials;     /* 每STATS_BLOCK个值一个部分结果，按顺序合并使结果与线程数无关 */
+} stats_job;
+
+static void stats_range(long begin, long end, void* ctx) {
+    stats_job* job = (stats_job*)ctx;
+    for (long b = begin; b < end; b++) {
+        size_t first = (size_t)b * STATS_BLOCK;
+        size_t last = first + STATS_BLOCK < job->rows ? first + STATS_BLOCK : job->rows;
+        csv_stats s = {0, 0.0, __builtin_inf(), -__builtin_inf(), 0.0};
+        if (job->column->type == CSV_INT64) {
+            const int64_t* values = job->column->ints;
+            int64_t min = values[first];
+            int64_t max = values[first];
+            for (size_t i = first; i < last; i++) {
+                s.sum += (double)values[i];
+                min = values[i] < min ? values[i] : min;
+                max = values[i] > max ? values[i] : max;
+            }
+            s.count = last - first;
+            s.min = (double)min;
+            s.max = (double)max;
+        } else {
+            const double* values = job->column->doubles;
+            for (size_t i = first; i < last; i++) {
+                double v = values[i];
+                if (v != v) {
+                    continue;
+                }
+                s.count++;
+                s.sum += v;
+                s.min = v < s.min ? v : s.min;
+                s.max = v > s.max ? v : s.max;
+            }
+        }
+        job->partials[b] = s;
+    }
+}
+
+error_code csv_column_stats(const csv_table* table, int column, csv_stats* stats) {
+    debug_print("统计CSV列");
+    if (table == NULL || stats == NULL) {
+        return error_raise(ERR_CSV_NULL, "表或输出参数为NULL");
+    }
+    if (column < 0 || column >= table->column_count || table->columns[column].type == CSV_STRING) {
+        return error_raise(ERR_CSV_INVALID_ARGUMENT, "列序号超出范围或不是数值列");
+    }
+    csv_stats result = {0, 0.0, 0.0, 0.0, 0.0};
+    long blocks = (long)((table->row_count + STATS_BLOCK - 1) / STATS_BLOCK);
+    csv_stats* partials = (csv_stats*)malloc((size_t)(blocks > 0 ? blocks : 1) * sizeof(csv_stats));
+    if (partials == NULL) {
+        return error_raise(ERR_CSV_ALLOC, "内存分配失败");
+    }
+    stats_job job = {&table->columns[column], table->row_count, partials};
+    parallel_for(NULL, 0, blocks, 1, stats_range, &job);
+    for (long b = 0; b < blocks; b++) {
+        if (partials[b].count == 0) {
+            continue;
+        }
+        if (result.count == 0 || partials[b].min < result.min) {
+            result.min = partials[b].min;
+        }
+        if (result.count == 0 || partials[b].max > result.max) {
+            result.max = partials[b].max;
+        }
+        result.count += partials[b].count;
+        result.sum += partials[b].sum;
+    }
+    free(partials);
+    result.mean = result.count > 0 ? result.sum / (double)result.count : 0.0;
+    *stats = result;
+    return ERR_OK;
+}
+
+static int module_init(void) {
+    ensure_tables();
+    debug_print(has_avx2 ? "CSV结构扫描使用AVX2指令" : "CSV结构扫描使用SSE2指令");
+    debug_print("CSV库初始化成功");
+    return 1;
+}
+
+int initialize_csv_ops() {
+    return module_init_once(MODULE_CSV, module_init);
+}
\ No newline at end of file
@@ -0,0 +1,582 @@
+/**
+ * @file dir_ops.c
+ * @brief 目录遍历与批量文件操作实现
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <stdatomic.h>
+#include "../include/dir_ops.h"
+#include "../include/module.h"
+#include "../include/file_ops.h"
+#include "../include/pattern_ops.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+
+// 同时保持打开的目录描述符上限，超过后按路径延迟打开
+#define MAX_OPEN_DIR_FDS 512
+#define DENTS_BUFFER_SIZE (32 * 1024)
+
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+typedef struct walker walker;
+
+typedef struct {
+    walker* w;
+    int fd;        /* 已打开的目录描述符，-1表示需要按路径重新打开 */
+    int depth;
+    char path[];   /* 相对根目录的路径，根目录为"" */
+} dir_task;
+
+struct walker {
+    int root_fd;
+    int flags;
+    pattern* filter;         /* 编译后的文件名glob，各线程共用 */
+    dir_visit_fn visit;
+    void* ctx;
+    dir_progress* progress;
+    thread_pool* pool;
+    wait_group pending;      /* 已提交但尚未处理完的目录 */
+    atomic_int aborted;
+    atomic_int open_fds;
+    atomic_ullong errors;    /* 无法打开、读取或stat的条目数，与progress无关 */
+};
+
+static void count_error(walker* w) {
+    atomic_fetch_add_explicit(&w->errors, 1, memory_order_relaxed);
+    if (w->progress != NULL) {
+        atomic_fetch_add_explicit(&w->progress->errors, 1, memory_order_relaxed);
+    }
+}
+
+static void directory_task(void* arg);
+
+static void schedule_task(walker* w, dir_task* task) {
+    if (!thread_pool_submit(w->pool, directory_task, task, &w->pending)) {
+        // 线程池不可用时在当前线程中处理
+        directory_task(task);
+    }
+}
+
+static void process_directory(walker* w, dir_task* task) {
+    int fd = task->fd;
+    if (fd < 0) {
+        fd = openat(w->root_fd, task->path[0] ? task->path : ".",
+                    O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0) {
+            count_error(w);
+            return;
+        }
+    } else {
+        atomic_fetch_sub(&w->open_fds, 1);
+    }
+
+    size_t base_len = strlen(task->path);
+    char child_path[PATH_MAX];
+    memcpy(child_path, task->path, base_len);
+    if (base_len > 0) {
+        child_path[base_len++] = '/';
+    }
+
+    char buffer[DENTS_BUFFER_SIZE] __attribute__((aligned(8)));
+    for (;;) {
+        long nread = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+        if (nread == 0) {
+            break;
+        }
+        if (nread < 0) {
+            count_error(w);
+            break;
+        }
+
+        for (long offset = 0; offset < nread;) {
+            struct linux_dirent64* ent = (struct linux_dirent64*)(buffer + offset);
+            offset += ent->d_reclen;
+
+            const char* name = ent->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+            if (atomic_load_explicit(&w->aborted, memory_order_relaxed)) {
+                close(fd);
+                return;
+            }
+
+            struct stat st;
+            const struct stat* stp = NULL;
+            int is_dir = ent->d_type == DT_DIR;
+            if ((w->flags & DIR_WALK_STAT) || ent->d_type == DT_UNKNOWN) {
+                if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                    count_error(w);
+                    continue;
+                }
+                is_dir = S_ISDIR(st.st_mode);
+                if (w->flags & DIR_WALK_STAT) {
+                    stp = &st;
+                }
+            }
+
+            if (!is_dir && w->filter != NULL && !pattern_match(w->filter, name, strlen(name))) {
+                continue;
+            }
+
+            size_t name_len = strlen(name);
+            if (base_len + name_len >= sizeof(child_path)) {
+                count_error(w);
+                continue;
+            }
+            memcpy(child_path + base_len, name, name_len + 1);
+
+            dir_entry_info info = {fd, name, child_path, task->depth + 1, is_dir, stp};
+            int action = w->visit != NULL ? w->visit(&info, w->ctx) : DIR_WALK_CONTINUE;
+            if (action == DIR_WALK_ABORT) {
+                atomic_store(&w->aborted, 1);
+                close(fd);
+                return;
+            }
+
+            if (!is_dir) {
+                if (w->progress != NULL) {
+                    atomic_fetch_add_explicit(&w->progress->files, 1, memory_order_relaxed);
+                    if (stp != NULL) {
+                        atomic_fetch_add_explicit(&w->progress->bytes, (unsigned long long)stp->st_size,
+                                                  memory_order_relaxed);
+                    }
+                }
+                continue;
+            }
+
+            if (w->progress != NULL) {
+                atomic_fetch_add_explicit(&w->progress->dirs, 1, memory_order_relaxed);
+            }
+            if (action == DIR_WALK_SKIP) {
+                continue;
+            }
+
+            dir_task* child = (dir_task*)malloc(sizeof(dir_task) + base_len + name_len + 1);
+            if (child == NULL) {
+                count_error(w);
+                continue;
+            }
+            child->w = w;
+            child->depth = task->depth + 1;
+            memcpy(child->path, child_path, base_len + name_len + 1);
+            child->fd = -1;
+            if (atomic_fetch_add(&w->open_fds, 1) < MAX_OPEN_DIR_FDS) {
+                child->fd = openat(fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            }
+            if (child->fd < 0) {
+                atomic_fetch_sub(&w->open_fds, 1);
+            }
+            schedule_task(w, child);
+        }
+    }
+
+    close(fd);
+}
+
+/* 线程池任务：处理一个目录，子目录作为新任务提交，由空闲的工作线程窃取 */
+static void directory_task(void* arg) {
+    dir_task* task = (dir_task*)arg;
+    walker* w = task->w;
+    if (atomic_load_explicit(&w->aborted, memory_order_relaxed)) {
+        // 中止后仍会取到已提交的任务，只需释放资源
+        if (task->fd >= 0) {
+            close(task->fd);
+            atomic_fetch_sub(&w->open_fds, 1);
+        }
+    } else {
+        process_directory(w, task);
+    }
+    free(task);
+}
+
+void dir_progress_reset(dir_progress* progress) {
+    if (progress == NULL) {
+        return;
+    }
+    atomic_store(&progress->files, 0);
+    atomic_store(&progress->dirs, 0);
+    atomic_store(&progress->bytes, 0);
+    atomic_store(&progress->errors, 0);
+}
+
+static int walk_fd(int root_fd, const dir_walk_options* options, int extra_flags,
+                   dir_visit_fn visit, void* ctx) {
+    walker w;
+    memset(&w, 0, sizeof(w));
+    w.root_fd = root_fd;
+    w.flags = (options != NULL ? options->flags : 0) | extra_flags;
+    w.progress = options != NULL ? options->progress : NULL;
+    w.visit = visit;
+    w.ctx = ctx;
+    atomic_init(&w.aborted, 0);
+    atomic_init(&w.open_fds, 0);
+    atomic_init(&w.errors, 0);
+
+    // 文件名过滤编译一次，遍历中每个条目只需扫描一遍文件名
+    if (options != NULL && options->pattern != NULL &&
+        pattern_compile(options->pattern, PATTERN_GLOB, &w.filter) != ERR_OK) {
+        return 0;
+    }
+
+    // 指定线程数时使用独立的线程池，否则使用共享的默认线程池
+    thread_pool* own_pool = NULL;
+    if (options != NULL && options->num_threads > 0) {
+        thread_pool_options pool_options = {options->num_threads, 0, 0};
+        own_pool = thread_pool_create(&pool_options);
+        if (own_pool == NULL) {
+            error_log(ERR_DIR_POOL_CREATE, "创建遍历线程池失败");
+            pattern_free(w.filter);
+            return 0;
+        }
+    }
+    w.pool = own_pool != NULL ? own_pool : thread_pool_default();
+
+    dir_task* root_task = (dir_task*)malloc(sizeof(dir_task) + 1);
+    if (root_task == NULL) {
+        error_log(ERR_DIR_ALLOC, "内存分配失败");
+        thread_pool_destroy(own_pool);
+        pattern_free(w.filter);
+        return 0;
+    }
+    root_task->w = &w;
+    root_task->fd = -1;
+    root_task->depth = 0;
+    root_task->path[0] = '\0';
+
+    wait_group_init(&w.pending);
+    schedule_task(&w, root_task);
+    thread_pool_wait(w.pool, &w.pending);
+    wait_group_destroy(&w.pending);
+    thread_pool_destroy(own_pool);
+    pattern_free(w.filter);
+
+    if (atomic_load(&w.aborted)) {
+        return 0;
+    }
+    // 跳过的子树或条目会让结果不完整，不能当作成功
+    if (atomic_load(&w.errors) > 0) {
+        error_log(ERR_DIR_WALK_PARTIAL, "遍历目录时部分条目无法读取");
+        return 0;
+    }
+    return 1;
+}
+
+static int open_root(const char* root, error_code code) {
+    int fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        error_log_detail(code, "无法打开目录", root);
+    }
+    return fd;
+}
+
+int dir_walk(const char* root, const dir_walk_options* options, dir_visit_fn visit, void* ctx) {
+    debug_print("遍历目录");
+    if (root == NULL) {
+        error_log(ERR_DIR_NULL, "根目录为NULL");
+        return 0;
+    }
+
+    int root_fd = open_root(root, ERR_DIR_OPEN);
+    if (root_fd < 0) {
+        return 0;
+    }
+
+    int result = walk_fd(root_fd, options, 0, visit, ctx);
+    close(root_fd);
+    return result;
+}
+
+static int size_visitor(const dir_entry_info* entry, void* ctx) {
+    if (!entry->is_dir) {
+        atomic_fetch_add_explicit((atomic_llong*)ctx, (long long)entry->st->st_size, memory_order_relaxed);
+    }
+    return DIR_WALK_CONTINUE;
+}
+
+long long dir_total_size(const char* root, const dir_walk_options* options) {
+    debug_print("计算目录大小");
+    if (root == NULL) {
+        error_log(ERR_DIR_NULL, "根目录为NULL");
+        return -1;
+    }
+
+    int root_fd = open_root(root, ERR_DIR_OPEN);
+    if (root_fd < 0) {
+        return -1;
+    }
+
+    atomic_llong total;
+    atomic_init(&total, 0);
+    int ok = walk_fd(root_fd, options, DIR_WALK_STAT, size_visitor, &total);
+    close(root_fd);
+    return ok ? atomic_load(&total) : -1;
+}
+
+typedef struct {
+    int dest_fd;
+    atomic_int failed;
+} copy_context;
+
+static int copy_fd_contents(int in_fd, int out_fd, off_t size) {
+    off_t remaining = size;
+    int use_read_write = 0;
+
+    while (remaining > 0 && !use_read_write) {
+        ssize_t copied = copy_file_range(in_fd, NULL, out_fd, NULL, (size_t)remaining, 0);
+        if (copied < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP) {
+                use_read_write = 1;
+                break;
+            }
+            return 0;
+        }
+        if (copied == 0) {
+            break; // 文件在复制过程中被截断
+        }
+        remaining -= copied;
+    }
+
+    if (!use_read_write) {
+        return 1;
+    }
+
+    // 内核不支持跨文件系统copy_file_range时退回到read/write
+    char buffer[64 * 1024];
+    for (;;) {
+        ssize_t n = read(in_fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return 0;
+        }
+        if (n == 0) {
+            return 1;
+        }
+        for (ssize_t done = 0; done < n;) {
+            ssize_t w = write(out_fd, buffer + done, (size_t)(n - done));
+            if (w < 0 && errno == EINTR) {
+                continue;
+            }
+            if (w < 0) {
+                return 0;
+            }
+            done += w;
+        }
+    }
+}
+
+static int copy_visitor(const dir_entry_info* entry, void* ctx) {
+    copy_context* cc = (copy_context*)ctx;
+    const struct stat* st = entry->st;
+
+    if (entry->is_dir) {
+        if (mkdirat(cc->dest_fd, entry->path, (st->st_mode & 07777) | S_IRWXU) != 0 && errno != EEXIST) {
+            atomic_store(&cc->failed, 1);
+            return DIR_WALK_SKIP;
+        }
+        return DIR_WALK_CONTINUE;
+    }
+
+    if (S_ISLNK(st->st_mode)) {
+        char target[PATH_MAX];
+        ssize_t len = readlinkat(entry->dirfd, entry->name, target, sizeof(target) - 1);
+        if (len < 0) {
+            atomic_store(&cc->failed, 1);
+            return DIR_WALK_CONTINUE;
+        }
+        target[len] = '\0';
+        if (symlinkat(target, cc->dest_fd, entry->path) != 0 && errno != EEXIST) {
+            atomic_store(&cc->failed, 1);
+        }
+        return DIR_WALK_CONTINUE;
+    }
+
+    if (!S_ISREG(st->st_mode)) {
+        return DIR_WALK_CONTINUE; // 设备、FIFO和套接字不复制
+    }
+
+    int in_fd = openat(entry->dirfd, entry->name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (in_fd < 0) {
+        atomic_store(&cc->failed, 1);
+        return DIR_WALK_CONTINUE;
+    }
+    int out_fd = openat(cc->dest_fd, entry->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                        st->st_mode & 07777);
+    if (out_fd < 0) {
+        close(in_fd);
+        atomic_store(&cc->failed, 1);
+        return DIR_WALK_CONTINUE;
+    }
+
+    if (!copy_fd_contents(in_fd, out_fd, st->st_size)) {
+        atomic_store(&cc->failed, 1);
+    }
+    close(in_fd);
+    if (close(out_fd) != 0) {
+        atomic_store(&cc->failed, 1);
+    }
+    return DIR_WALK_CONTINUE;
+}
+
+int dir_copy(const char* source, const char* destination, const dir_walk_options* options) {
+    debug_print("复制目录");
+    if (source == NULL || destination == NULL) {
+        error_log(ERR_DIR_NULL, "源目录或目标目录为NULL");
+        return 0;
+    }
+
+    int src_fd = open_root(source, ERR_DIR_OPEN);
+    if (src_fd < 0) {
+        return 0;
+    }
+
+    if (mkdir(destination, 0755) != 0 && errno != EEXIST) {
+        error_log_detail(ERR_DIR_MKDIR, "无法创建目录", destination);
+        close(src_fd);
+        return 0;
+    }
+    int dest_fd = open_root(destination, ERR_DIR_MKDIR);
+    if (dest_fd < 0) {
+        close(src_fd);
+        return 0;
+    }
+
+    copy_context cc;
+    cc.dest_fd = dest_fd;
+    atomic_init(&cc.failed, 0);
+    int ok = walk_fd(src_fd, options, DIR_WALK_STAT, copy_visitor, &cc);
+    close(src_fd);
+    close(dest_fd);
+
+    if (!ok || atomic_load(&cc.failed)) {
+        error_log(ERR_DIR_COPY_PARTIAL, "复制目录时部分条目失败");
+        return 0;
+    }
+    return 1;
+}
+
+typedef struct {
+    char* path;
+    int depth;
+} pending_dir;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pending_dir* dirs;
+    size_t count;
+    size_t capacity;
+    atomic_int failed;
+} delete_context;
+
+static int delete_visitor(const dir_entry_info* entry, void* ctx) {
+    delete_context* dc = (delete_context*)ctx;
+
+    if (!entry->is_dir) {
+        if (unlinkat(entry->dirfd, entry->name, 0) != 0 && errno != ENOENT) {
+            atomic_store(&dc->failed, 1);
+        }
+        return DIR_WALK_CONTINUE;
+    }
+
+    // 目录需要等子项全部删除后按深度从深到浅删除
+    char* path = strdup(entry->path);
+    if (path == NULL) {
+        atomic_store(&dc->failed, 1);
+        return DIR_WALK_ABORT;
+    }
+    pthread_mutex_lock(&dc->lock);
+    if (dc->count == dc->capacity) {
+        size_t new_capacity = dc->capacity ? dc->capacity * 2 : 64;
+        pending_dir* dirs = (pending_dir*)realloc(dc->dirs, new_capacity * sizeof(pending_dir));
+        if (dirs == NULL) {
+            pthread_mutex_unlock(&dc->lock);
+            free(path);
+            atomic_store(&dc->failed, 1);
+            return DIR_WALK_ABORT;
+        }
+        dc->dirs = dirs;
+        dc->capacity = new_capacity;
+    }
+    dc->dirs[dc->count].path = path;
+    dc->dirs[dc->count].depth = entry->depth;
+    dc->count++;
+    pthread_mutex_unlock(&dc->lock);
+    return DIR_WALK_CONTINUE;
+}
+
+static int compare_depth_desc(const void* a, const void* b) {
+    return ((const pending_dir*)b)->depth - ((const pending_dir*)a)->depth;
+}
+
+int dir_delete(const char* root, const dir_walk_options* options) {
+    debug_print("删除目录");
+    if (root == NULL) {
+        error_log(ERR_DIR_NULL, "根目录为NULL");
+        return 0;
+    }
+
+    int root_fd = open_root(root, ERR_DIR_OPEN);
+    if (root_fd < 0) {
+        return 0;
+    }
+
+    delete_context dc;
+    memset(&dc, 0, sizeof(dc));
+    pthread_mutex_init(&dc.lock, NULL);
+    atomic_init(&dc.failed, 0);
+
+    int ok = walk_fd(root_fd, options, 0, delete_visitor, &dc);
+    int keep_dirs = options != NULL && options->pattern != NULL;
+
+    qsort(dc.dirs, dc.count, sizeof(pending_dir), compare_depth_desc);
+    for (size_t i = 0; i < dc.count; i++) {
+        if (ok && !keep_dirs && unlinkat(root_fd, dc.dirs[i].path, AT_REMOVEDIR) != 0) {
+            atomic_store(&dc.failed, 1);
+        }
+        free(dc.dirs[i].path);
+    }
+    free(dc.dirs);
+    pthread_mutex_destroy(&dc.lock);
+    close(root_fd);
+
+    if (ok && !keep_dirs && rmdir(root) != 0) {
+        atomic_store(&dc.failed, 1);
+    }
+
+    if (!ok || atomic_load(&dc.failed)) {
+        error_log(ERR_DIR_REMOVE_PARTIAL, "删除目录时部分条目失败");
+        return 0;
+    }
+    return 1;
+}
+
+static int module_init(void) {
+    debug_print("目录操作库初始化成功");
+    return 1;
+}
+
+int initialize_dir_ops() {
+    return module_init_once(MODULE_DIR, module_init);
+}
\ No newline at end of file
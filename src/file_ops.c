@@ -6,62 +6,88 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include "../include/file_ops.h"
+#include "../include/module.h"
 #include "../include/utils.h"
+#include "../include/metrics.h"
 #include "../include/string_ops.h"
+#include "../include/allocator.h"
+#include "../include/line_index.h"
 
-static int is_initialized = 0;
-
-char* read_file(const char* filename) {
+static error_code read_file_impl(const char* filename, char** content) {
     debug_print("读取文件内容");
-    if (filename == NULL) {
-        error_log(3001, "文件名为NULL");
-        return NULL;
+    if (filename == NULL || content == NULL) {
+        return error_raise(ERR_FILE_READ_NULL, "文件名为NULL");
     }
+    *content = NULL;
     
-    FILE* file = fopen(filename, "rb");
-    if (file == NULL) {
-        char error_msg[100];
-        snprintf(error_msg, sizeof(error_msg), "无法打开文件: %s", filename);
-        error_log(3002, error_msg);
-        return NULL;
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error_log_detail(ERR_FILE_READ_OPEN, "无法打开文件", filename);
+        return ERR_FILE_READ_OPEN;
     }
     
     // 获取文件大小
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        st.st_size = 0;
+    }
+    size_t file_size = (size_t)st.st_size;
     
     // 分配内存
-    char* buffer = (char*)malloc(file_size + 1);
+    char* buffer = (char*)mem_alloc(file_size + 1);
     if (buffer == NULL) {
-        error_log(3003, "内存分配失败");
-        fclose(file);
-        return NULL;
+        close(fd);
+        return error_raise(ERR_FILE_READ_ALLOC, "内存分配失败");
     }
     
-    // 读取文件内容
-    size_t bytes_read = fread(buffer, 1, file_size, file);
+    // 读取文件内容；其他线程同时截断文件时只返回已读到的部分
+    size_t bytes_read = 0;
+    while (bytes_read < file_size) {
+        ssize_t n = read(fd, buffer + bytes_read, file_size - bytes_read);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        bytes_read += (size_t)n;
+    }
     buffer[bytes_read] = '\0';
     
-    fclose(file);
-    return buffer;
+    close(fd);
+    *content = buffer;
+    return ERR_OK;
 }
 
-int write_file(const char* filename, const char* content) {
+error_code read_file_checked(const char* filename, char** content) {
+    uint64_t start = metrics_now_ns();
+    error_code code = read_file_impl(filename, content);
+    metrics_record_latency(METRIC_READ_FILE, start);
+    return code;
+}
+
+char* read_file(const char* filename) {
+    char* content = NULL;
+    read_file_checked(filename, &content);
+    return content;
+}
+
+static error_code write_file_impl(const char* filename, const char* content) {
     debug_print("写入文件内容");
     if (filename == NULL || content == NULL) {
-        error_log(3004, "文件名或内容为NULL");
-        return 0;
+        return error_raise(ERR_FILE_WRITE_NULL, "文件名或内容为NULL");
     }
     
     FILE* file = fopen(filename, "wb");
     if (file == NULL) {
-        char error_msg[100];
-        snprintf(error_msg, sizeof(error_msg), "无法打开文件: %s", filename);
-        error_log(3005, error_msg);
-        return 0;
+        error_log_detail(ERR_FILE_WRITE_OPEN, "无法打开文件", filename);
+        return ERR_FILE_WRITE_OPEN;
     }
     
     size_t content_len = strlen(content);
@@ -70,143 +96,219 @@ int write_file(const char* filename, const char* content) {
     fclose(file);
     
     if (bytes_written != content_len) {
-        error_log(3006, "写入文件失败");
-        return 0;
+        return error_raise(ERR_FILE_WRITE_FAILED, "写入文件失败");
     }
     
-    return 1;
+    return ERR_OK;
 }
 
-int append_file(const char* filename, const char* content) {
+error_code write_file_checked(const char* filename, const char* content) {
+    uint64_t start = metrics_now_ns();
+    error_code code = write_file_impl(filename, content);
+    metrics_record_latency(METRIC_WRITE_FILE, start);
+    return code;
+}
+
+int write_file(const char* filename, const char* content) {
+    return write_file_checked(filename, content) == ERR_OK;
+}
+
+static error_code append_file_impl(const char* filename, const char* content) {
     debug_print("追加文件内容");
     if (filename == NULL || content == NULL) {
-        error_log(3007, "文件名或内容为NULL");
-        return 0;
+        return error_raise(ERR_FILE_APPEND_NULL, "文件名或内容为NULL");
     }
     
-    FILE* file = fopen(filename, "ab");
-    if (file == NULL) {
-        char error_msg[100];
-        snprintf(error_msg, sizeof(error_msg), "无法打开文件: %s", filename);
-        error_log(3008, error_msg);
-        return 0;
+    int fd = open(filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        error_log_detail(ERR_FILE_APPEND_OPEN, "无法打开文件", filename);
+        return ERR_FILE_APPEND_OPEN;
     }
     
+    // O_APPEND下每次write都原子地追加到文件末尾，整段内容一次写入，
+    // 多个线程同时追加同一文件时各自的内容不会交错
     size_t content_len = strlen(content);
-    size_t bytes_written = fwrite(content, 1, content_len, file);
+    size_t bytes_written = 0;
+    while (bytes_written < content_len) {
+        ssize_t n = write(fd, content + bytes_written, content_len - bytes_written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        bytes_written += (size_t)n;
+    }
     
-    fclose(file);
+    close(fd);
     
     if (bytes_written != content_len) {
-        error_log(3009, "追加文件失败");
-        return 0;
+        return error_raise(ERR_FILE_APPEND_FAILED, "追加文件失败");
     }
     
-    return 1;
+    // 文件有行索引时只把新增的行加入索引文件；更新失败不影响追加本身，也不记录错误
+    if (content_len > 0) {
+        line_index_update_sidecar(filename);
+    }
+    
+    return ERR_OK;
 }
 
-int file_exists(const char* filename) {
+error_code append_file_checked(const char* filename, const char* content) {
+    uint64_t start = metrics_now_ns();
+    error_code code = append_file_impl(filename, content);
+    metrics_record_latency(METRIC_APPEND_FILE, start);
+    return code;
+}
+
+int append_file(const char* filename, const char* content) {
+    return append_file_checked(filename, content) == ERR_OK;
+}
+
+static error_code file_exists_impl(const char* filename, int* exists) {
     debug_print("检查文件是否存在");
-    if (filename == NULL) {
-        error_log(3010, "文件名为NULL");
-        return 0;
+    if (filename == NULL || exists == NULL) {
+        return error_raise(ERR_FILE_EXISTS_NULL, "文件名为NULL");
     }
     
-    return access(filename, F_OK) == 0;
+    *exists = access(filename, F_OK) == 0;
+    return ERR_OK;
 }
 
-long get_file_size(const char* filename) {
+error_code file_exists_checked(const char* filename, int* exists) {
+    uint64_t start = metrics_now_ns();
+    error_code code = file_exists_impl(filename, exists);
+    metrics_record_latency(METRIC_FILE_EXISTS, start);
+    return code;
+}
+
+int file_exists(const char* filename) {
+    int exists = 0;
+    file_exists_checked(filename, &exists);
+    return exists;
+}
+
+static error_code get_file_size_impl(const char* filename, long* size) {
     debug_print("获取文件大小");
-    if (filename == NULL) {
-        error_log(3011, "文件名为NULL");
-        return -1;
+    if (filename == NULL || size == NULL) {
+        return error_raise(ERR_FILE_SIZE_NULL, "文件名为NULL");
     }
     
     struct stat st;
     if (stat(filename, &st) != 0) {
-        char error_msg[100];
-        snprintf(error_msg, sizeof(error_msg), "无法获取文件信息: %s", filename);
-        error_log(3012, error_msg);
-        return -1;
+        error_log_detail(ERR_FILE_SIZE_STAT, "无法获取文件信息", filename);
+        return ERR_FILE_SIZE_STAT;
     }
     
-    return st.st_size;
+    *size = st.st_size;
+    return ERR_OK;
 }
 
-int copy_file(const char* source, const char* destination) {
+error_code get_file_size_checked(const char* filename, long* size) {
+    uint64_t start = metrics_now_ns();
+    error_code code = get_file_size_impl(filename, size);
+    metrics_record_latency(METRIC_GET_FILE_SIZE, start);
+    return code;
+}
+
+long get_file_size(const char* filename) {
+    long size = -1;
+    get_file_size_checked(filename, &size);
+    return size;
+}
+
+static error_code copy_file_impl(const char* source, const char* destination) {
     debug_print("复制文件");
     if (source == NULL || destination == NULL) {
-        error_log(3013, "源文件或目标文件为NULL");
-        return 0;
+        return error_raise(ERR_FILE_COPY_NULL, "源文件或目标文件为NULL");
     }
     
     // 读取源文件内容
-    char* content = read_file(source);
-    if (content == NULL) {
-        return 0;
+    char* content = NULL;
+    error_code code = read_file_checked(source, &content);
+    if (code != ERR_OK) {
+        return code;
     }
     
     // 写入目标文件
-    int result = write_file(destination, content);
-    free(content);
+    code = write_file_checked(destination, content);
+    mem_free(content);
     
-    return result;
+    return code;
 }
 
-int move_file(const char* source, const char* destination) {
+error_code copy_file_checked(const char* source, const char* destination) {
+    uint64_t start = metrics_now_ns();
+    error_code code = copy_file_impl(source, destination);
+    metrics_record_latency(METRIC_COPY_FILE, start);
+    return code;
+}
+
+int copy_file(const char* source, const char* destination) {
+    return copy_file_checked(source, destination) == ERR_OK;
+}
+
+static error_code move_file_impl(const char* source, const char* destination) {
     debug_print("移动文件");
     if (source == NULL || destination == NULL) {
-        error_log(3014, "源文件或目标文件为NULL");
-        return 0;
+        return error_raise(ERR_FILE_MOVE_NULL, "源文件或目标文件为NULL");
     }
     
     // 首先尝试直接重命名
     if (rename(source, destination) == 0) {
-        return 1;
+        return ERR_OK;
     }
     
     // 如果重命名失败（例如跨文件系统），则复制后删除
-    if (copy_file(source, destination)) {
-        return delete_file(source);
+    error_code code = copy_file_checked(source, destination);
+    if (code != ERR_OK) {
+        return code;
     }
     
-    return 0;
+    return delete_file_checked(source);
 }
 
-int delete_file(const char* filename) {
+error_code move_file_checked(const char* source, const char* destination) {
+    uint64_t start = metrics_now_ns();
+    error_code code = move_file_impl(source, destination);
+    metrics_record_latency(METRIC_MOVE_FILE, start);
+    return code;
+}
+
+int move_file(const char* source, const char* destination) {
+    return move_file_checked(source, destination) == ERR_OK;
+}
+
+static error_code delete_file_impl(const char* filename) {
     debug_print("删除文件");
     if (filename == NULL) {
-        error_log(3015, "文件名为NULL");
-        return 0;
+        return error_raise(ERR_FILE_DELETE_NULL, "文件名为NULL");
     }
     
     if (remove(filename) != 0) {
-        char error_msg[100];
-        snprintf(error_msg, sizeof(error_msg), "无法删除文件: %s", filename);
-        error_log(3016, error_msg);
-        return 0;
+        error_log_detail(ERR_FILE_DELETE_FAILED, "无法删除文件", filename);
+        return ERR_FILE_DELETE_FAILED;
     }
     
-    return 1;
+    return ERR_OK;
 }
 
-int initialize_file_ops() {
-    if (is_initialized) {
-        debug_print("文件操作库已经初始化");
-        return 1;
-    }
-    
-    if (!initialize_utils()) {
-        error_log(3017, "初始化工具库失败");
-        return 0;
-    }
-    
-    if (!initialize_string_ops()) {
-        error_log(3018, "初始化字符串操作库失败");
-        return 0;
-    }
-    
+error_code delete_file_checked(const char* filename) {
+    uint64_t start = metrics_now_ns();
+    error_code code = delete_file_impl(filename);
+    metrics_record_latency(METRIC_DELETE_FILE, start);
+    return code;
+}
+
+int delete_file(const char* filename) {
+    return delete_file_checked(filename) == ERR_OK;
+}
+
+static int module_init(void) {
     debug_print("文件操作库初始化成功");
-    is_initialized = 1;
     return 1;
-} 
\ No newline at end of file
+}
+
+int initialize_file_ops() {
+    return module_init_once(MODULE_FILE, module_init);
+}
\ No newline at end of file
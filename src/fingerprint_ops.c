@@ -0,0 +1,753 @@
+/**
+ * @file fingerprint_ops.c
+ * @brief 内容指纹与近似匹配实现
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <immintrin.h>
+#include "../include/fingerprint_ops.h"
+#include "../include/module.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+#include "../include/allocator.h"
+
+/* 滚动哈希取模2^61-1（梅森素数），乘法用128位整数后折叠 */
+#define RH_MOD ((1ULL << 61) - 1)
+#define RH_BASE 0x1F35A7BD3ULL
+
+/* ---------- 查找表与CPU特性检测 ---------- */
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+static int has_avx2 = 0;
+static int has_popcnt = 0;
+static uint64_t gear_table[256];
+static uint64_t minhash_mul[MINHASH_MAX_HASHES];
+static uint64_t minhash_add[MINHASH_MAX_HASHES];
+
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void init_tables(void) {
+    __builtin_cpu_init();
+    has_avx2 = __builtin_cpu_supports("avx2");
+    has_popcnt = __builtin_cpu_supports("popcnt");
+
+    // 固定种子，分块边界和签名在不同进程、不同机器之间保持一致
+    uint64_t seed = 0x6765617263646321ULL;
+    for (int i = 0; i < 256; i++) {
+        gear_table[i] = splitmix64(&seed);
+    }
+    for (int i = 0; i < MINHASH_MAX_HASHES; i++) {
+        minhash_mul[i] = splitmix64(&seed) | 1;
+        minhash_add[i] = splitmix64(&seed);
+    }
+}
+
+static inline void ensure_tables(void) {
+    pthread_once(&tables_once, init_tables);
+}
+
+/* ---------- Rabin-Karp滚动哈希 ---------- */
+
+static inline uint64_t mod_mul(uint64_t a, uint64_t b) {
+    __uint128_t product = (__uint128_t)a * b;
+    uint64_t r = (uint64_t)(product & RH_MOD) + (uint64_t)(product >> 61);
+    return r >= RH_MOD ? r - RH_MOD : r;
+}
+
+static inline uint64_t mod_add(uint64_t a, uint64_t b) {
+    uint64_t r = a + b;
+    return r >= RH_MOD ? r - RH_MOD : r;
+}
+
+uint64_t rolling_hash_of(const void* data, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t hash = 0;
+    for (size_t i = 0; i < len; i++) {
+        // 字节值加1，使前导的0字节也影响哈希值
+        hash = mod_add(mod_mul(hash, RH_BASE), (uint64_t)p[i] + 1);
+    }
+    return hash;
+}
+
+void rolling_hash_init(rolling_hash* state, const void* data, size_t window) {
+    state->window = window;
+    state->hash = rolling_hash_of(data, window);
+    state->out_factor = 1;
+    for (size_t i = 1; i < window; i++) {
+        state->out_factor = mod_mul(state->out_factor, RH_BASE);
+    }
+}
+
+uint64_t rolling_hash_roll(rolling_hash* state, unsigned char out, unsigned char in) {
+    uint64_t removed = mod_mul((uint64_t)out + 1, state->out_factor);
+    uint64_t hash = mod_add(state->hash, RH_MOD - removed);
+    state->hash = mod_add(mod_mul(hash, RH_BASE), (uint64_t)in + 1);
+    return state->hash;
+}
+
+error_code rolling_hash_windows(const void* data, size_t len, size_t window, uint64_t** hashes,
+                                size_t* count) {
+    debug_print("计算滑动窗口哈希");
+    if (hashes == NULL || count == NULL || (data == NULL && len > 0)) {
+        return error_raise(ERR_FINGERPRINT_NULL, "数据或输出参数为NULL");
+    }
+    *hashes = NULL;
+    *count = 0;
+    if (window == 0) {
+        return error_raise(ERR_FINGERPRINT_INVALID_ARGUMENT, "窗口长度为零");
+    }
+    if (len < window) {
+        return ERR_OK;
+    }
+
+    size_t windows = len - window + 1;
+    uint64_t* result = (uint64_t*)mem_alloc(windows * sizeof(uint64_t));
+    if (result == NULL) {
+        return error_raise(ERR_FINGERPRINT_ALLOC, "内存分配失败");
+    }
+    const unsigned char* p = (const unsigned char*)data;
+    rolling_hash state;
+    rolling_hash_init(&state, p, window);
+    result[0] = state.hash;
+    for (size_t i = 1; i < windows; i++) {
+        result[i] = rolling_hash_roll(&state, p[i - 1], p[i + window - 1]);
+    }
+    *hashes = result;
+    *count = windows;
+    return ERR_OK;
+}
+
+error_code rabin_karp_find_all(const void* text, size_t text_len, const void* pattern, size_t pattern_len,
+                               size_t** positions, size_t* count) {
+    debug_print("Rabin-Karp查找");
+    if (positions == NULL || count == NULL || pattern == NULL || (text == NULL && text_len > 0)) {
+        return error_raise(ERR_FINGERPRINT_NULL, "文本、模式或输出参数为NULL");
+    }
+    *positions = NULL;
+    *count = 0;
+    if (pattern_len == 0) {
+        return error_raise(ERR_FINGERPRINT_INVALID_ARGUMENT, "模式长度为零");
+    }
+    if (text_len < pattern_len) {
+        return ERR_OK;
+    }
+
+    const unsigned char* t = (const unsigned char*)text;
+    uint64_t target = rolling_hash_of(pattern, pattern_len);
+    size_t* found = NULL;
+    size_t found_count = 0;
+    size_t capacity = 0;
+    rolling_hash state;
+    rolling_hash_init(&state, t, pattern_len);
+    size_t last = text_len - pattern_len;
+    for (size_t i = 0;; i++) {
+        // 哈希相同时逐字节确认，排除哈希碰撞
+        if (state.hash == target && memcmp(t + i, pattern, pattern_len) == 0) {
+            if (found_count == capacity) {
+                capacity = capacity > 0 ? capacity * 2 : 16;
+                size_t* grown = (size_t*)mem_realloc(found, capacity * sizeof(size_t));
+                if (grown == NULL) {
+                    mem_free(found);
+                    return error_raise(ERR_FINGERPRINT_ALLOC, "内存分配失败");
+                }
+                found = grown;
+            }
+            found[found_count++] = i;
+        }
+        if (i == last) {
+            break;
+        }
+        rolling_hash_roll(&state, t[i], t[i + pattern_len]);
+    }
+    *positions = found;
+    *count = found_count;
+    return ERR_OK;
+}
+
+/* ---------- 内容定义分块（FastCDC） ---------- */
+
+static int floor_log2(size_t value) {
+    int bits = 0;
+    while (value > 1) {
+        value >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+int cdc_params_valid(const cdc_params* params) {
+    return params != NULL && params->min_size > 0 && params->avg_size >= 4 &&
+           params->min_size <= params->avg_size && params->avg_size <= params->max_size;
+}
+
+size_t cdc_next_boundary(const void* data, size_t len, const cdc_params* params) {
+    ensure_tables();
+    size_t limit = len < params->max_size ? len : params->max_size;
+    if (limit <= params->min_size) {
+        return limit;
+    }
+    // 平均长度之前用多1位的掩码（更难切分），之后用少1位的掩码（更容易切分），使块长集中在平均值附近
+    int bits = floor_log2(params->avg_size);
+    uint64_t mask_small = ~0ULL << (64 - (bits + 1));
+    uint64_t mask_large = ~0ULL << (64 - (bits - 1));
+    size_t normal = params->avg_size < limit ? params->avg_size : limit;
+
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t hash = 0;
+    size_t i = params->min_size;   // 最小块长度以内不可能切分，直接跳过
+    for (; i < normal; i++) {
+        hash = (hash << 1) + gear_table[p[i]];
+        if ((hash & mask_small) == 0) {
+            return i + 1;
+        }
+    }
+    for (; i < limit; i++) {
+        hash = (hash << 1) + gear_table[p[i]];
+        if ((hash & mask_large) == 0) {
+            return i + 1;
+        }
+    }
+    return limit;
+}
+
+error_code cdc_chunk(const void* data, size_t len, const cdc_params* params, size_t** chunk_sizes,
+                     size_t* count) {
+    debug_print("内容定义分块");
+    if (chunk_sizes == NULL || count == NULL || params == NULL || (data == NULL && len > 0)) {
+        return error_raise(ERR_FINGERPRINT_NULL, "数据、参数或输出参数为NULL");
+    }
+    *chunk_sizes = NULL;
+    *count = 0;
+    if (!cdc_params_valid(params)) {
+        return error_raise(ERR_FINGERPRINT_INVALID_ARGUMENT, "分块参数不合法");
+    }
+    if (len == 0) {
+        return ERR_OK;
+    }
+
+    // 块数不超过len / min_size + 1
+    size_t capacity = len / params->min_size + 1;
+    size_t* sizes = (size_t*)mem_alloc(capacity * sizeof(size_t));
+    if (sizes == NULL) {
+        return error_raise(ERR_FINGERPRINT_ALLOC, "内存分配失败");
+    }
+    const unsigned char* p = (const unsigned char*)data;
+    size_t offset = 0;
+    size_t chunks = 0;
+    while (offset < len) {
+        size_t size = cdc_next_boundary(p + offset, len - offset, params);
+        sizes[chunks++] = size;
+        offset += size;
+    }
+    *chunk_sizes = sizes;
+    *count = chunks;
+    return ERR_OK;
+}
+
+/* ---------- MinHash ---------- */
+
+/* 第i个哈希函数：x * a_i + b_i（a_i为奇数，是2^64上的置换）再混合高位 */
+static inline void minhash_update(uint64_t* signature, int num_hashes, uint64_t shingle) {
+    for (int i = 0; i < num_hashes; i++) {
+        uint64_t value = shingle * minhash_mul[i] + minhash_add[i];
+        value ^= value >> 29;
+        if (value < signature[i]) {
+            signature[i] = value;
+        }
+    }
+}
+
+static void compute_signature(const unsigned char* p, size_t len, size_t shingle_size, int num_hashes,
+                              uint64_t* signature) {
+    for (int i = 0; i < num_hashes; i++) {
+        signature[i] = UINT64_MAX;
+    }
+    if (len <= shingle_size) {
+        minhash_update(signature, num_hashes, rolling_hash_of(p, len));
+        return;
+    }
+    rolling_hash state;
+    rolling_hash_init(&state, p, shingle_size);
+    minhash_update(signature, num_hashes, state.hash);
+    for (size_t i = shingle_size; i < len; i++) {
+        minhash_update(signature, num_hashes, rolling_hash_roll(&state, p[i - shingle_size], p[i]));
+    }
+}
+
+static error_code check_minhash_arguments(size_t shingle_size, int num_hashes) {
+    if (shingle_size == 0 || num_hashes <= 0 || num_hashes > MINHASH_MAX_HASHES) {
+        return error_raise(ERR_FINGERPRINT_INVALID_ARGUMENT, "片段长度或签名长度不合法");
+    }
+    return ERR_OK;
+}
+
+error_code minhash_signature(const void* data, size_t len, size_t shingle_size, int num_hashes,
+                             uint64_t* signature) {
+    debug_print("计算MinHash签名");
+    if (signature == NULL || (data == NULL && len > 0)) {
+        return error_raise(ERR_FINGERPRINT_NULL, "数据或签名为NULL");
+    }
+    error_code code = check_minhash_arguments(shingle_size, num_hashes);
+    if (code != ERR_OK) {
+        return code;
+    }
+    ensure_tables();
+    compute_signature((const unsigned char*)data, len, shingle_size, num_hashes, signature);
+    return ERR_OK;
+}
+
+typedef struct {
+    const void* const* docs;
+    const size_t* lens;
+    size_t shingle_size;
+    int num_hashes;
+    uint64_t* signatures;
+} signature_job;
+
+static void signature_range(long begin, long end, void* ctx) {
+    signature_job* job = (signature_job*)ctx;
+    for (long i = begin; i < end; i++) {
+        compute_signature((const unsigned char*)job->docs[i], job->lens[i], job->shingle_size, job->num_hashes,
+                          job->signatures + (size_t)i * job->num_hashes);
+    }
+}
+
+error_code minhash_signatures(const void* const* docs, const size_t* lens, int count, size_t shingle_size,
+                              int num_hashes, uint64_t* signatures) {
+    debug_print("并行计算MinHash签名");
+    if (docs == NULL || lens == NULL || signatures == NULL || count < 0) {
+        return error_raise(ERR_FINGERPRINT_NULL, "文档数组或签名为NULL");
+    }
+    error_code code = check_minhash_arguments(shingle_size, num_hashes);
+    if (code != ERR_OK) {
+        return code;
+    }
+    for (int i = 0; i < count; i++) {
+        if (docs[i] == NULL && lens[i] > 0) {
+            return error_raise(ERR_FINGERPRINT_NULL, "文档为NULL");
+        }
+    }
+    ensure_tables();
+    signature_job job = {docs, lens, shingle_size, num_hashes, signatures};
+    if (count > 1) {
+        parallel_for(NULL, 0, count, 1, signature_range, &job);
+    } else {
+        signature_range(0, count, &job);
+    }
+    return ERR_OK;
+}
+
+double minhash_similarity(const uint64_t* a, const uint64_t* b, int num_hashes) {
+    if (a == NULL || b == NULL || num_hashes <= 0) {
+        return 0.0;
+    }
+    int equal = 0;
+    for (int i = 0; i < num_hashes; i++) {
+        equal += a[i] == b[i];
+    }
+    return (double)equal / num_hashes;
+}
+
+typedef struct {
+    uint64_t key;
+    int doc;
+} band_entry;
+
+static int compare_band_entries(const void* x, const void* y) {
+    const band_entry* a = (const band_entry*)x;
+    const band_entry* b = (const band_entry*)y;
+    if (a->key != b->key) {
+        return a->key < b->key ? -1 : 1;
+    }
+    return a->doc - b->doc;
+}
+
+static int compare_pairs(const void* x, const void* y) {
+    const fingerprint_pair* a = (const fingerprint_pair*)x;
+    const fingerprint_pair* b = (const fingerprint_pair*)y;
+    if (a->first != b->first) {
+        return a->first - b->first;
+    }
+    return a->second - b->second;
+}
+
+/* 一段签名的哈希值，作为LSH分桶的键；不同段内容偶尔碰撞只会多出候选对，随后按相似度筛掉 */
+static uint64_t band_key(const uint64_t* values, int rows) {
+    uint64_t key = 0x243F6A8885A308D3ULL;
+    for (int i = 0; i < rows; i++) {
+        key = (key ^ values[i]) * 0x9E3779B97F4A7C15ULL;
+        key ^= key >> 32;
+    }
+    return key;
+}
+
+static int append_pair(fingerprint_pair** pairs, size_t* count, size_t* capacity, int first, int second) {
+    if (*count == *capacity) {
+        size_t grown_capacity = *capacity > 0 ? *capacity * 2 : 64;
+        fingerprint_pair* grown = (fingerprint_pair*)mem_realloc(*pairs, grown_capacity * sizeof(fingerprint_pair));
+        if (grown == NULL) {
+            return 0;
+        }
+        *pairs = grown;
+        *capacity = grown_capacity;
+    }
+    (*pairs)[*count].first = first;
+    (*pairs)[*count].second = second;
+    (*pairs)[*count].similarity = 0.0;
+    (*count)++;
+    return 1;
+}
+
+error_code minhash_near_duplicates(const uint64_t* signatures, int count, int num_hashes, int bands,
+                                   double threshold, fingerprint_pair** pairs, int* pair_count) {
+    debug_print("近重复检测");
+    if (pairs == NULL || pair_count == NULL || (signatures == NULL && count > 0)) {
+        return error_raise(ERR_FINGERPRINT_NULL, "签名或输出参数为NULL");
+    }
+    *pairs = NULL;
+    *pair_count = 0;
+    if (count < 0 || num_hashes <= 0 || bands <= 0 || bands > num_hashes || threshold < 0.0 || threshold > 1.0) {
+        return error_raise(ERR_FINGERPRINT_INVALID_ARGUMENT, "文档数、分带数或阈值不合法");
+    }
+    if (count < 2) {
+        return ERR_OK;
+    }
+
+    int rows = num_hashes / bands;
+    band_entry* entries = (band_entry*)malloc((size_t)count * sizeof(band_entry));
+    if (entries == NULL) {
+        return error_raise(ERR_FINGERPRINT_ALLOC, "内存分配失败");
+    }
+    fingerprint_pair* candidates = NULL;
+    size_t candidate_count = 0;
+    size_t capacity = 0;
+    for (int band = 0; band < bands; band++) {
+        for (int doc = 0; doc < count; doc++) {
+            entries[doc].key = band_key(signatures + (size_t)doc * num_hashes + (size_t)band * rows, rows);
+            entries[doc].doc = doc;
+        }
+        qsort(entries, (size_t)count, sizeof(band_entry), compare_band_entries);
+        // 键相同的一组文档两两成为候选对
+        for (int start = 0; start < count;) {
+            int end = start + 1;
+            while (end < count && entries[end].key == entries[start].key) {
+                end++;
+            }
+            for (int i = start; i < end; i++) {
+                for (int j = i + 1; j < end; j++) {
+                    if (!append_pair(&candidates, &candidate_count, &capacity, entries[i].doc, entries[j].doc)) {
+                        free(entries);
+                        mem_free(candidates);
+                        return error_raise(ERR_FINGERPRINT_ALLOC, "内存分配失败");
+                    }
+                }
+            }
+            start = end;
+        }
+    }
+    free(entries);
+
+    // 去掉在多个分带中重复出现的候选对，再按整个签名的相似度筛选
+    qsort(candidates, candidate_count, sizeof(fingerprint_pair), compare_pairs);
+    size_t kept = 0;
+    for (size_t i = 0; i < candidate_count; i++) {
+        if (i > 0 && compare_pairs(&candidates[i], &candidates[i - 1]) == 0) {
+            continue;
+        }
+        const uint64_t* a = signatures + (size_t)candidates[i].first * num_hashes;
+        const uint64_t* b = signatures + (size_t)candidates[i].second * num_hashes;
+        double similarity = minhash_similarity(a, b, num_hashes);
+        if (similarity >= threshold) {
+            candidates[kept] = candidates[i];
+            candidates[kept].similarity = similarity;
+            kept++;
+        }
+    }
+    if (kept == 0) {
+        mem_free(candidates);
+        candidates = NULL;
+    }
+    *pairs = candidates;
+    *pair_count = (int)kept;
+    return ERR_OK;
+}
+
+/* ---------- Hamming距离 ---------- */
+
+__attribute__((target("avx2")))
+static size_t hamming_avx2(const uint8_t* a, const uint8_t* b, size_t len) {
+    size_t differ = 0;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        unsigned int equal = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        differ += 32 - (size_t)__builtin_popcount(equal);
+    }
+    for (; i < len; i++) {
+        differ += a[i] != b[i];
+    }
+    return differ;
+}
+
+static size_t hamming_sse2(const uint8_t* a, const uint8_t* b, size_t len) {
+    size_t differ = 0;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        unsigned int equal = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+        differ += 16 - (size_t)__builtin_popcount(equal);
+    }
+    for (; i < len; i++) {
+        differ += a[i] != b[i];
+    }
+    return differ;
+}
+
+size_t hamming_distance(const void* a, const void* b, size_t len) {
+    if (a == NULL || b == NULL) {
+        return 0;
+    }
+    ensure_tables();
+    if (has_avx2) {
+        return hamming_avx2((const uint8_t*)a, (const uint8_t*)b, len);
+    }
+    return hamming_sse2((const uint8_t*)a, (const uint8_t*)b, len);
+}
+
+static inline uint64_t load64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+__attribute__((target("popcnt")))
+static size_t hamming_bits_popcnt(const uint8_t* a, const uint8_t* b, size_t len) {
+    size_t differ = 0;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        differ += (size_t)__builtin_popcountll(load64(a + i) ^ load64(b + i));
+    }
+    for (; i < len; i++) {
+        differ += (size_t)__builtin_popcount((unsigned int)(a[i] ^ b[i]));
+    }
+    return differ;
+}
+
+static size_t hamming_bits_sw(const uint8_t* a, const uint8_t* b, size_t len) {
+    size_t differ = 0;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        differ += (size_t)__builtin_popcountll(load64(a + i) ^ load64(b + i));
+    }
+    for (; i < len; i++) {
+        differ += (size_t)__builtin_popcount((unsigned int)(a[i] ^ b[i]));
+    }
+    return differ;
+}
+
+size_t hamming_distance_bits(const void* a, const void* b, size_t len) {
+    if (a == NULL || b == NULL) {
+        return 0;
+    }
+    ensure_tables();
+    if (has_popcnt) {
+        return hamming_bits_popcnt((const uint8_t*)a, (const uint8_t*)b, len);
+    }
+    return hamming_bits_sw((const uint8_t*)a, (const uint8_t*)b, len);
+}
+
+/* ---------- Levenshtein编辑距离 ---------- */
+
+/*
+ * Myers/Hyyrö位并行算法：模式p按64个字符分块，每块用Pv/Mv两个位向量表示一列中相邻行的差值（+1/-1），
+ * 逐个处理文本字符，块之间传递最后一行的水平差值。p为较短的字符串，m > 0。
+ */
+static long myers_distance(const unsigned char* p, size_t m, const unsigned char* t, size_t n) {
+    size_t blocks = (m + 63) / 64;
+    uint64_t single[256 + 2];
+    uint64_t* buffer = single;
+    if (blocks > 1) {
+        buffer = (uint64_t*)malloc((256 * blocks + 2 * blocks) * sizeof(uint64_t));
+        if (buffer == NULL) {
+            error_log(ERR_FINGERPRINT_ALLOC, "内存分配失败");
+            return -1;
+        }
+    }
+    // peq[c * blocks + b]：第b块中等于字符c的位置
+    uint64_t* peq = buffer;
+    uint64_t* pv = buffer + 256 * blocks;
+    uint64_t* mv = pv + blocks;
+    memset(peq, 0, 256 * blocks * sizeof(uint64_t));
+    for (size_t i = 0; i < m; i++) {
+        peq[(size_t)p[i] * blocks + i / 64] |= 1ULL << (i % 64);
+    }
+    for (size_t b = 0; b < blocks; b++) {
+        pv[b] = ~0ULL;
+        mv[b] = 0;
+    }
+
+    uint64_t last_bit = 1ULL << ((m - 1) % 64);
+    long score = (long)m;
+    for (size_t j = 0; j < n; j++) {
+        const uint64_t* eq_column = peq + (size_t)t[j] * blocks;
+        int carry = 1;   // 第0行D[0][j] = j，进入第一块的水平差值恒为+1
+        for (size_t b = 0; b < blocks; b++) {
+            uint64_t eq = eq_column[b];
+            uint64_t pvb = pv[b];
+            uint64_t mvb = mv[b];
+            uint64_t xv = eq | mvb;
+            if (carry < 0) {
+                eq |= 1;
+            }
+            uint64_t xh = (((eq & pvb) + pvb) ^ pvb) | eq;
+            uint64_t ph = mvb | ~(xh | pvb);
+            uint64_t mh = pvb & xh;
+            uint64_t high = b + 1 == blocks ? last_bit : 1ULL << 63;
+            int carry_out = (ph & high) ? 1 : ((mh & high) ? -1 : 0);
+            ph <<= 1;
+            mh <<= 1;
+            if (carry < 0) {
+                mh |= 1;
+            } else if (carry > 0) {
+                ph |= 1;
+            }
+            pv[b] = mh | ~(xv | ph);
+            mv[b] = ph & xv;
+            carry = carry_out;
+        }
+        score += carry;
+    }
+    if (buffer != single) {
+        free(buffer);
+    }
+    return score;
+}
+
+/* 带状动态规划：只计算|j - i| <= k的单元格，某一行的最小值超过k时提前结束 */
+static long banded_distance(const unsigned char* a, size_t m, const unsigned char* b, size_t n, long k) {
+    size_t band = 2 * (size_t)k + 1;
+    long* rows = (long*)malloc(2 * band * sizeof(long));
+    if (rows == NULL) {
+        error_log(ERR_FINGERPRINT_ALLOC, "内存分配失败");
+        return -1;
+    }
+    long* prev = rows;
+    long* cur = rows + band;
+    long limit = k + 1;   // 超过k的值都记为k + 1
+
+    // 第d个单元对应列j = i + d - k
+    for (size_t d = 0; d < band; d++) {
+        long j = (long)d - k;
+        prev[d] = j < 0 || j > (long)n ? limit : (j < limit ? j : limit);
+    }
+    for (size_t i = 1; i <= m; i++) {
+        long row_min = limit;
+        for (size_t d = 0; d < band; d++) {
+            long j = (long)i + (long)d - k;
+            long value;
+            if (j < 0 || j > (long)n) {
+                value = limit;
+            } else if (j == 0) {
+                value = (long)i < limit ? (long)i : limit;
+            } else {
+                value = prev[d] + (a[i - 1] != b[j - 1]);
+                if (d + 1 < band && prev[d + 1] + 1 < value) {
+                    value = prev[d + 1] + 1;
+                }
+                if (d > 0 && cur[d - 1] + 1 < value) {
+                    value = cur[d - 1] + 1;
+                }
+                if (value > limit) {
+                    value = limit;
+                }
+            }
+            cur[d] = value;
+            if (value < row_min) {
+                row_min = value;
+            }
+        }
+        if (row_min > k) {
+            free(rows);
+            return -1;
+        }
+        long* tmp = prev;
+        prev = cur;
+        cur = tmp;
+    }
+    long result = prev[(long)n - (long)m + k];
+    free(rows);
+    return result <= k ? result : -1;
+}
+
+long levenshtein_distance(const char* a, size_t a_len, const char* b, size_t b_len) {
+    if ((a == NULL && a_len > 0) || (b == NULL && b_len > 0)) {
+        error_log(ERR_FINGERPRINT_NULL, "字符串为NULL");
+        return -1;
+    }
+    // 编辑距离对称，以较短的字符串作为位并行的模式
+    if (a_len > b_len) {
+        const char* tmp = a;
+        a = b;
+        b = tmp;
+        size_t tmp_len = a_len;
+        a_len = b_len;
+        b_len = tmp_len;
+    }
+    if (a_len == 0) {
+        return (long)b_len;
+    }
+    return myers_distance((const unsigned char*)a, a_len, (const unsigned char*)b, b_len);
+}
+
+long levenshtein_bounded(const char* a, size_t a_len, const char* b, size_t b_len, long max_distance) {
+    if ((a == NULL && a_len > 0) || (b == NULL && b_len > 0)) {
+        error_log(ERR_FINGERPRINT_NULL, "字符串为NULL");
+        return -1;
+    }
+    if (max_distance < 0) {
+        error_log(ERR_FINGERPRINT_INVALID_ARGUMENT, "距离上限为负数");
+        return -1;
+    }
+    size_t diff = a_len > b_len ? a_len - b_len : b_len - a_len;
+    if (diff > (size_t)max_distance) {
+        return -1;
+    }
+    if (a_len > b_len) {
+        const char* tmp = a;
+        a = b;
+        b = tmp;
+        size_t tmp_len = a_len;
+        a_len = b_len;
+        b_len = tmp_len;
+    }
+    if (a_len == 0) {
+        return (long)b_len;
+    }
+    // 带状算法每行计算2k + 1个单元格，位并行算法每列处理ceil(m / 64)个块，每块的运算量约为单元格的3倍
+    size_t blocks = (a_len + 63) / 64;
+    if ((size_t)max_distance < a_len && 2 * (size_t)max_distance + 1 <= 3 * blocks) {
+        return banded_distance((const unsigned char*)a, a_len, (const unsigned char*)b, b_len, max_distance);
+    }
+    long distance = myers_distance((const unsigned char*)a, a_len, (const unsigned char*)b, b_len);
+    return distance >= 0 && distance <= max_distance ? distance : -1;
+}
+
+static int module_init(void) {
+    ensure_tables();
+    debug_print(has_avx2 ? "Hamming距离使用AVX2指令" : "Hamming距离使用SSE2指令");
+    debug_print("指纹库初始化成功");
+    return 1;
+}
+
+int initialize_fingerprint_ops() {
+    return module_init_once(MODULE_FINGERPRINT, module_init);
+}
\ No newline at end of file
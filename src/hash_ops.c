@@ -0,0 +1,1037 @@
+/**
+ * @file hash_ops.c
+ * @brief 内容哈希与校验函数实现
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <cpuid.h>
+#include <immintrin.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/hash_ops.h"
+#include "../include/module.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+#include "../include/allocator.h"
+
+#define IO_BUFFER_SIZE (256 * 1024)
+#define COMPARE_CHUNK_SIZE (4 * 1024 * 1024)
+
+/* ---------- CPU特性检测 ---------- */
+
+static pthread_once_t cpu_once = PTHREAD_ONCE_INIT;
+static int has_sse42 = 0;
+static int has_sha_ni = 0;
+static uint32_t crc32c_table[8][256];
+
+static void detect_cpu_features(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        has_sse42 = (ecx & bit_SSE4_2) != 0;
+        int has_ssse3 = (ecx & bit_SSSE3) != 0;
+        int has_sse41 = (ecx & bit_SSE4_1) != 0;
+        if (has_ssse3 && has_sse41 && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            has_sha_ni = (ebx & bit_SHA) != 0;
+        }
+    }
+
+    // 软件CRC32C使用slicing-by-8查找表
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+        }
+        crc32c_table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+            uint32_t prev = crc32c_table[t - 1][i];
+            crc32c_table[t][i] = (prev >> 8) ^ crc32c_table[0][prev & 0xFF];
+        }
+    }
+}
+
+static inline void ensure_cpu_features(void) {
+    pthread_once(&cpu_once, detect_cpu_features);
+}
+
+static inline uint64_t read_le64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read_le32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void write_be32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static inline void write_be64(uint8_t* p, uint64_t v) {
+    write_be32(p, (uint32_t)(v >> 32));
+    write_be32(p + 4, (uint32_t)v);
+}
+
+/* ---------- CRC32C ---------- */
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t* p, size_t len) {
+    uint64_t c = crc;
+    while (len >= 8) {
+        c = _mm_crc32_u64(c, read_le64(p));
+        p += 8;
+        len -= 8;
+    }
+    uint32_t c32 = (uint32_t)c;
+    while (len-- > 0) {
+        c32 = _mm_crc32_u8(c32, *p++);
+    }
+    return c32;
+}
+
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t* p, size_t len) {
+    while (len >= 8) {
+        uint32_t lo = read_le32(p) ^ crc;
+        uint32_t hi = read_le32(p + 4);
+        crc = crc32c_table[7][lo & 0xFF] ^ crc32c_table[6][(lo >> 8) & 0xFF] ^
+              crc32c_table[5][(lo >> 16) & 0xFF] ^ crc32c_table[4][lo >> 24] ^
+              crc32c_table[3][hi & 0xFF] ^ crc32c_table[2][(hi >> 8) & 0xFF] ^
+              crc32c_table[1][(hi >> 16) & 0xFF] ^ crc32c_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t len) {
+    ensure_cpu_features();
+    crc = ~crc;
+    if (has_sse42) {
+        crc = crc32c_hw(crc, (const uint8_t*)data, len);
+    } else {
+        crc = crc32c_sw(crc, (const uint8_t*)data, len);
+    }
+    return ~crc;
+}
+
+/* ---------- xxHash32 ---------- */
+
+#define XXH_PRIME32_1 0x9E3779B1U
+#define XXH_PRIME32_2 0x85EBCA77U
+#define XXH_PRIME32_3 0xC2B2AE3DU
+#define XXH_PRIME32_4 0x27D4EB2FU
+#define XXH_PRIME32_5 0x165667B1U
+
+static inline uint32_t rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline uint32_t xxh32_round(uint32_t acc, uint32_t input) {
+    acc += input * XXH_PRIME32_2;
+    return rotl32(acc, 13) * XXH_PRIME32_1;
+}
+
+static void xxh32_init_lanes(uint32_t* v, uint32_t seed) {
+    v[0] = seed + XXH_PRIME32_1 + XXH_PRIME32_2;
+    v[1] = seed + XXH_PRIME32_2;
+    v[2] = seed;
+    v[3] = seed - XXH_PRIME32_1;
+}
+
+static const uint8_t* xxh32_stripes(uint32_t* v, const uint8_t* p, size_t len) {
+    const uint8_t* end = p + (len & ~(size_t)15);
+    while (p < end) {
+        v[0] = xxh32_round(v[0], read_le32(p));
+        v[1] = xxh32_round(v[1], read_le32(p + 4));
+        v[2] = xxh32_round(v[2], read_le32(p + 8));
+        v[3] = xxh32_round(v[3], read_le32(p + 12));
+        p += 16;
+    }
+    return p;
+}
+
+static uint32_t xxh32_finish(const uint32_t* v, uint64_t total_len, uint32_t seed,
+                             const uint8_t* p, size_t len) {
+    uint32_t h;
+    if (total_len >= 16) {
+        h = rotl32(v[0], 1) + rotl32(v[1], 7) + rotl32(v[2], 12) + rotl32(v[3], 18);
+    } else {
+        h = seed + XXH_PRIME32_5;
+    }
+    h += (uint32_t)total_len;
+
+    while (len >= 4) {
+        h += read_le32(p) * XXH_PRIME32_3;
+        h = rotl32(h, 17) * XXH_PRIME32_4;
+        p += 4;
+        len -= 4;
+    }
+    while (len-- > 0) {
+        h += (*p++) * XXH_PRIME32_5;
+        h = rotl32(h, 11) * XXH_PRIME32_1;
+    }
+
+    h ^= h >> 15;
+    h *= XXH_PRIME32_2;
+    h ^= h >> 13;
+    h *= XXH_PRIME32_3;
+    h ^= h >> 16;
+    return h;
+}
+
+uint32_t xxh32(const void* data, size_t len, uint32_t seed) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t v[4];
+    xxh32_init_lanes(v, seed);
+    const uint8_t* tail = xxh32_stripes(v, p, len);
+    return xxh32_finish(v, len, seed, tail, len - (size_t)(tail - p));
+}
+
+static void xxh32_stream_update(hash_state* state, const uint8_t* p, size_t len) {
+    uint8_t* buffer = state->u.xxh32.buffer;
+    size_t* buffered = &state->u.xxh32.buffered;
+
+    if (*buffered > 0) {
+        size_t fill = 16 - *buffered;
+        if (fill > len) {
+            fill = len;
+        }
+        memcpy(buffer + *buffered, p, fill);
+        *buffered += fill;
+        p += fill;
+        len -= fill;
+        if (*buffered < 16) {
+            return;
+        }
+        xxh32_stripes(state->u.xxh32.v, buffer, 16);
+        *buffered = 0;
+    }
+
+    const uint8_t* tail = xxh32_stripes(state->u.xxh32.v, p, len);
+    *buffered = len - (size_t)(tail - p);
+    memcpy(buffer, tail, *buffered);
+}
+
+/* ---------- xxHash3 (64位，种子为0) ---------- */
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+#define XXH_PRIME_MX1 0x165667919E3779F9ULL
+#define XXH_PRIME_MX2 0x9FB21C651E98DF25ULL
+
+#define XXH_SECRET_SIZE 192
+#define XXH_STRIPE_LEN 64
+#define XXH_STRIPES_PER_BLOCK ((XXH_SECRET_SIZE - XXH_STRIPE_LEN) / 8)
+#define XXH_BLOCK_LEN (XXH_STRIPE_LEN * XXH_STRIPES_PER_BLOCK)
+
+static const uint8_t xxh3_secret[XXH_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t mul128_fold64(uint64_t a, uint64_t b) {
+    unsigned __int128 product = (unsigned __int128)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+static inline uint64_t xxh64_avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+static inline uint64_t xxh3_avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= XXH_PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+static inline uint64_t xxh3_rrmxmx(uint64_t h, uint64_t len) {
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= XXH_PRIME_MX2;
+    h ^= (h >> 35) + len;
+    h *= XXH_PRIME_MX2;
+    return h ^ (h >> 28);
+}
+
+static inline uint64_t xxh3_mix16(const uint8_t* p, const uint8_t* secret) {
+    return mul128_fold64(read_le64(p) ^ read_le64(secret), read_le64(p + 8) ^ read_le64(secret + 8));
+}
+
+static uint64_t xxh3_len_0to16(const uint8_t* p, size_t len) {
+    const uint8_t* s = xxh3_secret;
+    if (len > 8) {
+        uint64_t lo = read_le64(p) ^ (read_le64(s + 24) ^ read_le64(s + 32));
+        uint64_t hi = read_le64(p + len - 8) ^ (read_le64(s + 40) ^ read_le64(s + 48));
+        uint64_t acc = len + __builtin_bswap64(lo) + hi + mul128_fold64(lo, hi);
+        return xxh3_avalanche(acc);
+    }
+    if (len >= 4) {
+        uint64_t input64 = read_le32(p + len - 4) + ((uint64_t)read_le32(p) << 32);
+        uint64_t keyed = input64 ^ (read_le64(s + 8) ^ read_le64(s + 16));
+        return xxh3_rrmxmx(keyed, len);
+    }
+    if (len > 0) {
+        uint32_t combined = ((uint32_t)p[0] << 16) | ((uint32_t)p[len >> 1] << 24) |
+                            (uint32_t)p[len - 1] | ((uint32_t)len << 8);
+        uint64_t keyed = (uint64_t)combined ^ (uint64_t)(read_le32(s) ^ read_le32(s + 4));
+        return xxh64_avalanche(keyed);
+    }
+    return xxh64_avalanche(read_le64(s + 56) ^ read_le64(s + 64));
+}
+
+static uint64_t xxh3_len_17to128(const uint8_t* p, size_t len) {
+    const uint8_t* s = xxh3_secret;
+    uint64_t acc = len * XXH_PRIME64_1;
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += xxh3_mix16(p + 48, s + 96);
+                acc += xxh3_mix16(p + len - 64, s + 112);
+            }
+            acc += xxh3_mix16(p + 32, s + 64);
+            acc += xxh3_mix16(p + len - 48, s + 80);
+        }
+        acc += xxh3_mix16(p + 16, s + 32);
+        acc += xxh3_mix16(p + len - 32, s + 48);
+    }
+    acc += xxh3_mix16(p, s);
+    acc += xxh3_mix16(p + len - 16, s + 16);
+    return xxh3_avalanche(acc);
+}
+
+static uint64_t xxh3_len_129to240(const uint8_t* p, size_t len) {
+    const uint8_t* s = xxh3_secret;
+    uint64_t acc = len * XXH_PRIME64_1;
+    int rounds = (int)len / 16;
+    for (int i = 0; i < 8; i++) {
+        acc += xxh3_mix16(p + 16 * i, s + 16 * i);
+    }
+    acc = xxh3_avalanche(acc);
+    for (int i = 8; i < rounds; i++) {
+        acc += xxh3_mix16(p + 16 * i, s + 16 * (i - 8) + 3);
+    }
+    acc += xxh3_mix16(p + len - 16, s + 136 - 17);
+    return xxh3_avalanche(acc);
+}
+
+static inline void xxh3_accumulate_512(uint64_t* acc, const uint8_t* p, const uint8_t* secret) {
+    for (int i = 0; i < 8; i++) {
+        uint64_t data_val = read_le64(p + 8 * i);
+        uint64_t data_key = data_val ^ read_le64(secret + 8 * i);
+        acc[i ^ 1] += data_val;
+        acc[i] += (uint64_t)(uint32_t)data_key * (data_key >> 32);
+    }
+}
+
+static inline void xxh3_scramble(uint64_t* acc) {
+    const uint8_t* secret = xxh3_secret + XXH_SECRET_SIZE - XXH_STRIPE_LEN;
+    for (int i = 0; i < 8; i++) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= read_le64(secret + 8 * i);
+        acc[i] = a * XXH_PRIME32_1;
+    }
+}
+
+static void xxh3_init_acc(uint64_t* acc) {
+    acc[0] = XXH_PRIME32_3;
+    acc[1] = XXH_PRIME64_1;
+    acc[2] = XXH_PRIME64_2;
+    acc[3] = XXH_PRIME64_3;
+    acc[4] = XXH_PRIME64_4;
+    acc[5] = XXH_PRIME32_2;
+    acc[6] = XXH_PRIME64_5;
+    acc[7] = XXH_PRIME32_1;
+}
+
+/* 按条带累加，每满一个块执行一次scramble */
+static void xxh3_consume_stripes(uint64_t* acc, size_t* stripes_so_far, const uint8_t* p, size_t stripes) {
+    for (size_t n = 0; n < stripes; n++) {
+        xxh3_accumulate_512(acc, p + n * XXH_STRIPE_LEN, xxh3_secret + *stripes_so_far * 8);
+        if (++*stripes_so_far == XXH_STRIPES_PER_BLOCK) {
+            xxh3_scramble(acc);
+            *stripes_so_far = 0;
+        }
+    }
+}
+
+static uint64_t xxh3_merge(const uint64_t* acc, const uint8_t* last_stripe, uint64_t total_len) {
+    uint64_t merged[8];
+    memcpy(merged, acc, sizeof(merged));
+    xxh3_accumulate_512(merged, last_stripe, xxh3_secret + XXH_SECRET_SIZE - XXH_STRIPE_LEN - 7);
+
+    uint64_t result = total_len * XXH_PRIME64_1;
+    for (int i = 0; i < 4; i++) {
+        result += mul128_fold64(merged[2 * i] ^ read_le64(xxh3_secret + 11 + 16 * i),
+                                merged[2 * i + 1] ^ read_le64(xxh3_secret + 11 + 16 * i + 8));
+    }
+    return xxh3_avalanche(result);
+}
+
+static uint64_t xxh3_long(const uint8_t* p, size_t len) {
+    uint64_t acc[8];
+    xxh3_init_acc(acc);
+    size_t stripes_so_far = 0;
+    xxh3_consume_stripes(acc, &stripes_so_far, p, (len - 1) / XXH_STRIPE_LEN);
+    return xxh3_merge(acc, p + len - XXH_STRIPE_LEN, len);
+}
+
+uint64_t xxh3_64(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    if (len <= 16) {
+        return xxh3_len_0to16(p, len);
+    }
+    if (len <= 128) {
+        return xxh3_len_17to128(p, len);
+    }
+    if (len <= 240) {
+        return xxh3_len_129to240(p, len);
+    }
+    return xxh3_long(p, len);
+}
+
+static void xxh3_stream_update(hash_state* state, const uint8_t* p, size_t len) {
+    uint8_t* buffer = state->u.xxh3.buffer;
+    size_t* buffered = &state->u.xxh3.buffered;
+    const size_t capacity = sizeof(state->u.xxh3.buffer);
+
+    if (len <= capacity - *buffered) {
+        memcpy(buffer + *buffered, p, len);
+        *buffered += len;
+        return;
+    }
+
+    // 缓冲区只有在确定后面还有数据时才被消费，保证最后一个条带留到结束时处理
+    if (*buffered > 0) {
+        size_t fill = capacity - *buffered;
+        memcpy(buffer + *buffered, p, fill);
+        p += fill;
+        len -= fill;
+        xxh3_consume_stripes(state->u.xxh3.acc, &state->u.xxh3.stripes_so_far, buffer,
+                             capacity / XXH_STRIPE_LEN);
+        *buffered = 0;
+    }
+
+    if (len > capacity) {
+        size_t stripes = (len - 1) / XXH_STRIPE_LEN;
+        xxh3_consume_stripes(state->u.xxh3.acc, &state->u.xxh3.stripes_so_far, p, stripes);
+        p += stripes * XXH_STRIPE_LEN;
+        len -= stripes * XXH_STRIPE_LEN;
+        memcpy(buffer + capacity - XXH_STRIPE_LEN, p - XXH_STRIPE_LEN, XXH_STRIPE_LEN);
+    }
+
+    memcpy(buffer, p, len);
+    *buffered = len;
+}
+
+static uint64_t xxh3_stream_digest(const hash_state* state) {
+    const uint8_t* buffer = state->u.xxh3.buffer;
+    size_t buffered = state->u.xxh3.buffered;
+    const size_t capacity = sizeof(state->u.xxh3.buffer);
+
+    if (state->total_len <= 240) {
+        return xxh3_64(buffer, (size_t)state->total_len);
+    }
+
+    uint64_t acc[8];
+    size_t stripes_so_far = state->u.xxh3.stripes_so_far;
+    memcpy(acc, state->u.xxh3.acc, sizeof(acc));
+
+    uint8_t last_stripe[XXH_STRIPE_LEN];
+    if (buffered >= XXH_STRIPE_LEN) {
+        xxh3_consume_stripes(acc, &stripes_so_far, buffer, (buffered - 1) / XXH_STRIPE_LEN);
+        memcpy(last_stripe, buffer + buffered - XXH_STRIPE_LEN, XXH_STRIPE_LEN);
+    } else {
+        size_t from_previous = XXH_STRIPE_LEN - buffered;
+        memcpy(last_stripe, buffer + capacity - from_previous, from_previous);
+        memcpy(last_stripe + from_previous, buffer, buffered);
+    }
+    return xxh3_merge(acc, last_stripe, state->total_len);
+}
+
+/* ---------- SHA-256 ---------- */
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr32(uint32_t x, int r) {
+    return (x >> r) | (x << (32 - r));
+}
+
+static void sha256_blocks_sw(uint32_t* state, const uint8_t* p, size_t blocks) {
+    while (blocks-- > 0) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = read_be32(p + 4 * i);
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + s1 + ch + sha256_k[i] + w[i];
+            uint32_t s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+        p += 64;
+    }
+}
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha256_blocks_ni(uint32_t* state, const uint8_t* p, size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // 状态重排为SHA-NI需要的ABEF/CDGH布局
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    while (blocks-- > 0) {
+        __m128i abef_save = state0;
+        __m128i cdgh_save = state1;
+        __m128i msgs[4];
+
+        for (int g = 0; g < 16; g++) {
+            __m128i* cur = &msgs[g & 3];
+            if (g < 4) {
+                *cur = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 16 * g)), mask);
+            } else {
+                __m128i prev1 = msgs[(g - 1) & 3];
+                __m128i prev2 = msgs[(g - 2) & 3];
+                __m128i w = _mm_sha256msg1_epu32(*cur, msgs[(g - 3) & 3]);
+                w = _mm_add_epi32(w, _mm_alignr_epi8(prev1, prev2, 4));
+                *cur = _mm_sha256msg2_epu32(w, prev1);
+            }
+            __m128i msg = _mm_add_epi32(*cur, _mm_loadu_si128((const __m128i*)&sha256_k[4 * g]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+        p += 64;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128((__m128i*)&state[0], state0);
+    _mm_storeu_si128((__m128i*)&state[4], state1);
+}
+
+static void sha256_blocks(uint32_t* state, const uint8_t* p, size_t blocks) {
+    if (has_sha_ni) {
+        sha256_blocks_ni(state, p, blocks);
+    } else {
+        sha256_blocks_sw(state, p, blocks);
+    }
+}
+
+static void sha256_stream_update(hash_state* state, const uint8_t* p, size_t len) {
+    uint8_t* buffer = state->u.sha256.buffer;
+    size_t* buffered = &state->u.sha256.buffered;
+
+    if (*buffered > 0) {
+        size_t fill = 64 - *buffered;
+        if (fill > len) {
+            fill = len;
+        }
+        memcpy(buffer + *buffered, p, fill);
+        *buffered += fill;
+        p += fill;
+        len -= fill;
+        if (*buffered < 64) {
+            return;
+        }
+        sha256_blocks(state->u.sha256.state, buffer, 1);
+        *buffered = 0;
+    }
+
+    if (len >= 64) {
+        sha256_blocks(state->u.sha256.state, p, len / 64);
+        p += len & ~(size_t)63;
+        len &= 63;
+    }
+
+    memcpy(buffer, p, len);
+    *buffered = len;
+}
+
+static void sha256_stream_final(hash_state* state, unsigned char* digest) {
+    uint8_t* buffer = state->u.sha256.buffer;
+    size_t buffered = state->u.sha256.buffered;
+    uint64_t bit_len = state->total_len * 8;
+
+    buffer[buffered++] = 0x80;
+    if (buffered > 56) {
+        memset(buffer + buffered, 0, 64 - buffered);
+        sha256_blocks(state->u.sha256.state, buffer, 1);
+        buffered = 0;
+    }
+    memset(buffer + buffered, 0, 56 - buffered);
+    write_be64(buffer + 56, bit_len);
+    sha256_blocks(state->u.sha256.state, buffer, 1);
+
+    for (int i = 0; i < 8; i++) {
+        write_be32(digest + 4 * i, state->u.sha256.state[i]);
+    }
+}
+
+/* ---------- 通用流式接口 ---------- */
+
+size_t hash_digest_size(hash_algorithm algorithm) {
+    switch (algorithm) {
+    case HASH_CRC32C:
+        return 4;
+    case HASH_XXH3:
+        return 8;
+    case HASH_SHA256:
+        return 32;
+    case HASH_XXH32:
+        return 4;
+    }
+    return 0;
+}
+
+void hash_init(hash_state* state, hash_algorithm algorithm) {
+    static const uint32_t sha256_iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+
+    ensure_cpu_features();
+    memset(state, 0, sizeof(*state));
+    state->algorithm = algorithm;
+    if (algorithm == HASH_XXH32) {
+        xxh32_init_lanes(state->u.xxh32.v, 0);
+    } else if (algorithm == HASH_XXH3) {
+        xxh3_init_acc(state->u.xxh3.acc);
+    } else if (algorithm == HASH_SHA256) {
+        memcpy(state->u.sha256.state, sha256_iv, sizeof(sha256_iv));
+    }
+}
+
+void hash_update(hash_state* state, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    state->total_len += len;
+    switch (state->algorithm) {
+    case HASH_CRC32C:
+        state->u.crc = crc32c(state->u.crc, p, len);
+        break;
+    case HASH_XXH3:
+        xxh3_stream_update(state, p, len);
+        break;
+    case HASH_SHA256:
+        sha256_stream_update(state, p, len);
+        break;
+    case HASH_XXH32:
+        xxh32_stream_update(state, p, len);
+        break;
+    }
+}
+
+size_t hash_final(hash_state* state, unsigned char* digest) {
+    switch (state->algorithm) {
+    case HASH_CRC32C:
+        write_be32(digest, state->u.crc);
+        break;
+    case HASH_XXH3:
+        write_be64(digest, xxh3_stream_digest(state));
+        break;
+    case HASH_SHA256:
+        sha256_stream_final(state, digest);
+        break;
+    case HASH_XXH32:
+        write_be32(digest, xxh32_finish(state->u.xxh32.v, state->total_len, 0,
+                                        state->u.xxh32.buffer, state->u.xxh32.buffered));
+        break;
+    }
+    return hash_digest_size(state->algorithm);
+}
+
+size_t hash_buffer(const void* data, size_t len, hash_algorithm algorithm, unsigned char* digest) {
+    switch (algorithm) {
+    case HASH_CRC32C:
+        write_be32(digest, crc32c(0, data, len));
+        return 4;
+    case HASH_XXH3:
+        write_be64(digest, xxh3_64(data, len));
+        return 8;
+    case HASH_SHA256:
+        sha256(data, len, digest);
+        return 32;
+    case HASH_XXH32:
+        write_be32(digest, xxh32(data, len, 0));
+        return 4;
+    }
+    return 0;
+}
+
+void sha256(const void* data, size_t len, unsigned char* digest) {
+    hash_state state;
+    hash_init(&state, HASH_SHA256);
+    hash_update(&state, data, len);
+    hash_final(&state, digest);
+}
+
+/* ---------- 文件接口 ---------- */
+
+int hash_fd(int fd, hash_algorithm algorithm, unsigned char* digest) {
+    debug_print("计算文件描述符摘要");
+    if (fd < 0 || digest == NULL) {
+        error_log(ERR_HASH_INVALID_ARGUMENT, "文件描述符或摘要缓冲区无效");
+        return 0;
+    }
+
+    char* buffer = (char*)malloc(IO_BUFFER_SIZE);
+    if (buffer == NULL) {
+        error_log(ERR_HASH_ALLOC, "内存分配失败");
+        return 0;
+    }
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    hash_state state;
+    hash_init(&state, algorithm);
+    for (;;) {
+        ssize_t n = read(fd, buffer, IO_BUFFER_SIZE);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            error_log(ERR_HASH_READ, "读取文件失败");
+            free(buffer);
+            return 0;
+        }
+        if (n == 0) {
+            break;
+        }
+        hash_update(&state, buffer, (size_t)n);
+    }
+    free(buffer);
+
+    hash_final(&state, digest);
+    return 1;
+}
+
+/* 将文件映射为只读视图，空文件返回NULL且size为0 */
+static int map_file(const char* filename, const void** data, size_t* size) {
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+
+    *size = (size_t)st.st_size;
+    *data = NULL;
+    if (*size > 0) {
+        void* mapped = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            return 0;
+        }
+        madvise(mapped, *size, MADV_SEQUENTIAL);
+        *data = mapped;
+    }
+    close(fd);
+    return 1;
+}
+
+int hash_file(const char* filename, hash_algorithm algorithm, unsigned char* digest) {
+    debug_print("计算文件摘要");
+    if (filename == NULL || digest == NULL) {
+        error_log(ERR_HASH_NULL, "文件名或摘要缓冲区为NULL");
+        return 0;
+    }
+
+    const void* data;
+    size_t size;
+    if (!map_file(filename, &data, &size)) {
+        error_log_detail(ERR_HASH_MAP, "无法映射文件", filename);
+        return 0;
+    }
+
+    hash_buffer(data, size, algorithm, digest);
+    if (data != NULL) {
+        munmap((void*)data, size);
+    }
+    return 1;
+}
+
+char* hash_to_hex(const unsigned char* digest, size_t len) {
+    static const char hex_digits[] = "0123456789abcdef";
+    if (digest == NULL) {
+        error_log(ERR_HASH_NULL, "摘要为NULL");
+        return NULL;
+    }
+
+    char* hex = (char*)mem_alloc(len * 2 + 1);
+    if (hex == NULL) {
+        error_log(ERR_HASH_ALLOC, "内存分配失败");
+        return NULL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        hex[2 * i] = hex_digits[digest[i] >> 4];
+        hex[2 * i + 1] = hex_digits[digest[i] & 0xF];
+    }
+    hex[len * 2] = '\0';
+    return hex;
+}
+
+static int write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return 0;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+int copy_file_hashed(const char* source, const char* destination, hash_algorithm algorithm,
+                     unsigned char* digest) {
+    debug_print("复制文件并计算摘要");
+    if (source == NULL || destination == NULL) {
+        error_log(ERR_HASH_COPY_NULL, "源文件或目标文件为NULL");
+        return 0;
+    }
+
+    int in_fd = open(source, O_RDONLY | O_CLOEXEC);
+    if (in_fd < 0) {
+        error_log_detail(ERR_HASH_COPY_OPEN, "无法打开文件", source);
+        return 0;
+    }
+    struct stat st;
+    if (fstat(in_fd, &st) != 0) {
+        error_log(ERR_HASH_COPY_OPEN, "无法获取源文件信息");
+        close(in_fd);
+        return 0;
+    }
+    int out_fd = open(destination, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777);
+    if (out_fd < 0) {
+        error_log_detail(ERR_HASH_COPY_OPEN, "无法打开文件", destination);
+        close(in_fd);
+        return 0;
+    }
+
+    char* buffer = (char*)malloc(IO_BUFFER_SIZE);
+    if (buffer == NULL) {
+        error_log(ERR_HASH_ALLOC, "内存分配失败");
+        close(in_fd);
+        close(out_fd);
+        return 0;
+    }
+
+    posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    hash_state state;
+    hash_init(&state, algorithm);
+    int ok = 1;
+    for (;;) {
+        ssize_t n = read(in_fd, buffer, IO_BUFFER_SIZE);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ok = n == 0;
+            break;
+        }
+        if (digest != NULL) {
+            hash_update(&state, buffer, (size_t)n);
+        }
+        if (!write_all(out_fd, buffer, (size_t)n)) {
+            ok = 0;
+            break;
+        }
+    }
+
+    free(buffer);
+    close(in_fd);
+    if (close(out_fd) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        error_log(ERR_HASH_COPY_FAILED, "复制文件失败");
+        return 0;
+    }
+
+    if (digest != NULL) {
+        hash_final(&state, digest);
+    }
+    return 1;
+}
+
+typedef struct {
+    const uint8_t* data1;
+    const uint8_t* data2;
+    size_t size;
+    atomic_int differ;
+} compare_job;
+
+static void compare_range(long begin, long end, void* ctx) {
+    compare_job* job = (compare_job*)ctx;
+    for (long chunk = begin; chunk < end; chunk++) {
+        if (atomic_load_explicit(&job->differ, memory_order_relaxed)) {
+            break;
+        }
+        size_t offset = (size_t)chunk * COMPARE_CHUNK_SIZE;
+        size_t len = job->size - offset < COMPARE_CHUNK_SIZE ? job->size - offset : COMPARE_CHUNK_SIZE;
+        // 两个文件都已映射，逐字节比较与计算两边的哈希读取的数据相同，结果是精确的
+        if (memcmp(job->data1 + offset, job->data2 + offset, len) != 0) {
+            atomic_store(&job->differ, 1);
+        }
+    }
+}
+
+int files_equal(const char* file1, const char* file2) {
+    debug_print("比较文件内容");
+    if (file1 == NULL || file2 == NULL) {
+        error_log(ERR_HASH_COMPARE_NULL, "文件名为NULL");
+        return -1;
+    }
+
+    struct stat st1, st2;
+    if (stat(file1, &st1) != 0 || stat(file2, &st2) != 0) {
+        error_log(ERR_HASH_COMPARE_STAT, "无法获取文件信息");
+        return -1;
+    }
+    // 目录等不是普通文件，不能用同一inode判断为相同
+    if (!S_ISREG(st1.st_mode) || !S_ISREG(st2.st_mode)) {
+        error_log(ERR_HASH_COMPARE_NOT_FILE, "不是普通文件");
+        return -1;
+    }
+    if (st1.st_size != st2.st_size) {
+        return 0;
+    }
+    if (st1.st_dev == st2.st_dev && st1.st_ino == st2.st_ino) {
+        return 1;
+    }
+
+    compare_job job;
+    size_t size1, size2;
+    if (!map_file(file1, (const void**)&job.data1, &size1)) {
+        error_log(ERR_HASH_MAP, "无法映射文件");
+        return -1;
+    }
+    if (!map_file(file2, (const void**)&job.data2, &size2)) {
+        if (job.data1 != NULL) {
+            munmap((void*)job.data1, size1);
+        }
+        error_log(ERR_HASH_MAP, "无法映射文件");
+        return -1;
+    }
+
+    int result = 1;
+    if (size1 != size2) {
+        result = 0;
+    } else if (size1 > 0) {
+        job.size = size1;
+        atomic_init(&job.differ, 0);
+        long chunks = (long)((size1 + COMPARE_CHUNK_SIZE - 1) / COMPARE_CHUNK_SIZE);
+        parallel_for(NULL, 0, chunks, 1, compare_range, &job);
+        result = !atomic_load(&job.differ);
+    }
+
+    if (job.data1 != NULL) {
+        munmap((void*)job.data1, size1);
+    }
+    if (job.data2 != NULL) {
+        munmap((void*)job.data2, size2);
+    }
+    return result;
+}
+
+static int module_init(void) {
+    ensure_cpu_features();
+    debug_print(has_sse42 ? "CRC32C使用SSE4.2指令" : "CRC32C使用查找表");
+    debug_print(has_sha_ni ? "SHA-256使用SHA-NI指令" : "SHA-256使用软件实现");
+    debug_print("哈希库初始化成功");
+    return 1;
+}
+
+int initialize_hash_ops() {
+    return module_init_once(MODULE_HASH, module_init);
+}
\ No newline at end of file
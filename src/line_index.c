@@ -0,0 +1,812 @@
+/**
+ * @file line_index.c
+ * @brief 行偏移索引实现：SIMD查找换行符、大文件分段并行扫描，行首位置保存为varint差值序列，
+ *        内存中每64行一个检查点，按行号查找时最多解码63个差值
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <immintrin.h>
+#include "../include/line_index.h"
+#include "../include/module.h"
+#include "../include/hash_ops.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+#include "../include/allocator.h"
+
+/* 每个检查点覆盖的行数 */
+#define BLOCK_LINES 64
+/* 判断文件是否只在末尾增长时比较的末尾字节数 */
+#define TAIL_BYTES 4096
+/* 超过该长度的范围分段并行扫描 */
+#define PARALLEL_THRESHOLD (4 << 20)
+#define MIN_CHUNK (1 << 20)
+/* 扫描一个64字节块最多写入的字节数：第一个差值不超过10字节，块内其余的差值都小于128 */
+#define BLOCK_RESERVE (64 + 10)
+/* 一个varint最多的字节数 */
+#define VARINT_MAX 10
+/* 索引文件路径的最大长度 */
+#define PATH_LIMIT 4096
+
+#define FLAG_ENDS_WITH_NEWLINE 1u
+
+static const char sidecar_magic[8] = {'L', 'I', 'N', 'E', 'I', 'D', 'X', '1'};
+
+/* 索引文件头，之后是stream_bytes字节的差值序列；按本机字节序保存 */
+typedef struct {
+    char magic[8];
+    uint64_t file_size;      /* 已索引的字节数 */
+    int64_t mtime_sec;       /* 建立或更新索引时文件的修改时间 */
+    int64_t mtime_nsec;
+    uint64_t lines;
+    uint64_t last_start;     /* 最后一行的行首 */
+    uint64_t stream_bytes;
+    uint64_t tail_hash;      /* 已索引范围末尾TAIL_BYTES字节的xxh3 */
+    uint32_t flags;          /* FLAG_ENDS_WITH_NEWLINE */
+    uint32_t reserved;
+    uint64_t header_hash;    /* 之前各字段的xxh3 */
+} sidecar_header;
+
+/* 行首位置的差值序列：第一个行首不编码（整个文件的第一行为0，分段扫描时记录在first中） */
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+    uint64_t lines;          /* 加入的行首数 */
+    uint64_t first;
+    uint64_t last;
+} delta_stream;
+
+struct line_index {
+    int fd;
+    int flags;
+    int valid;               /* 以下字段描述了文件的某个前缀 */
+    line_index_source source;
+    char* filename;
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint64_t tail_hash;
+    int ends_with_newline;
+    delta_stream stream;
+    uint64_t* block_offset;  /* 第BLOCK_LINES * k行的行首 */
+    size_t* block_pos;       /* 第BLOCK_LINES * k + 1行的差值在stream中的位置 */
+    size_t block_cap;
+};
+
+static pthread_once_t cpu_once = PTHREAD_ONCE_INIT;
+static int has_avx2 = 0;
+static atomic_uint temp_counter = 0;
+
+static void detect_cpu(void) {
+    __builtin_cpu_init();
+    has_avx2 = __builtin_cpu_supports("avx2");
+}
+
+/* ---------- 差值序列 ---------- */
+
+static int stream_reserve(delta_stream* s, size_t extra) {
+    if (s->cap - s->len >= extra) {
+        return 1;
+    }
+    size_t cap = s->cap * 2;
+    if (cap < s->len + extra) {
+        cap = s->len + extra;
+    }
+    if (cap < 256) {
+        cap = 256;
+    }
+    uint8_t* grown = (uint8_t*)realloc(s->data, cap);
+    if (grown == NULL) {
+        return 0;
+    }
+    s->data = grown;
+    s->cap = cap;
+    return 1;
+}
+
+/* 加入一个行首，调用者已预留VARINT_MAX字节 */
+static inline void stream_put(delta_stream* s, uint64_t start) {
+    if (s->lines == 0) {
+        s->first = start;
+    } else {
+        uint64_t v = start - s->last;
+        uint8_t* p = s->data + s->len;
+        while (v >= 0x80) {
+            *p++ = (uint8_t)(v | 0x80);
+            v >>= 7;
+        }
+        *p++ = (uint8_t)v;
+        s->len = (size_t)(p - s->data);
+    }
+    s->last = start;
+    s->lines++;
+}
+
+/* 解码一个已校验的varint */
+static inline uint64_t stream_get(const uint8_t* data, size_t* pos) {
+    uint64_t v = 0;
+    int shift = 0;
+    uint8_t b;
+    do {
+        b = data[(*pos)++];
+        v |= (uint64_t)(b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    return v;
+}
+
+/* 把分段扫描的结果接到s之后 */
+static int stream_merge(delta_stream* s, const delta_stream* part) {
+    if (part->lines == 0) {
+        return 1;
+    }
+    if (!stream_reserve(s, VARINT_MAX + part->len)) {
+        return 0;
+    }
+    stream_put(s, part->first);
+    memcpy(s->data + s->len, part->data, part->len);
+    s->len += part->len;
+    s->lines += part->lines - 1;
+    s->last = part->last;
+    return 1;
+}
+
+/* ---------- 换行符扫描 ---------- */
+
+static inline void emit_mask(delta_stream* s, uint64_t mask, uint64_t base) {
+    while (mask != 0) {
+        stream_put(s, base + (uint64_t)__builtin_ctzll(mask) + 1);
+        mask &= mask - 1;
+    }
+}
+
+/* 不足64字节的末尾逐字节扫描 */
+static int scan_tail(const uint8_t* p, size_t n, uint64_t base, delta_stream* s) {
+    if (!stream_reserve(s, n + VARINT_MAX)) {
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] == '\n') {
+            stream_put(s, base + i + 1);
+        }
+    }
+    return 1;
+}
+
+__attribute__((target("avx2")))
+static int scan_avx2(const uint8_t* p, size_t n, uint64_t base, delta_stream* s) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        if (!stream_reserve(s, BLOCK_RESERVE)) {
+            return 0;
+        }
+        __m256i lo = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i hi = _mm256_loadu_si256((const __m256i*)(p + i + 32));
+        uint64_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline)) |
+                        (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)) << 32;
+        emit_mask(s, mask, base + i);
+    }
+    return scan_tail(p + i, n - i, base + i, s);
+}
+
+static int scan_sse2(const uint8_t* p, size_t n, uint64_t base, delta_stream* s) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        if (!stream_reserve(s, BLOCK_RESERVE)) {
+            return 0;
+        }
+        uint64_t mask = 0;
+        for (int k = 0; k < 4; k++) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(p + i + 16 * k));
+            mask |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)) << (16 * k);
+        }
+        emit_mask(s, mask, base + i);
+    }
+    return scan_tail(p + i, n - i, base + i, s);
+}
+
+/* 把p[0, n)中每个换行符之后的位置（加上base）加入s */
+static int scan_newlines(const uint8_t* p, size_t n, uint64_t base, delta_stream* s) {
+    pthread_once(&cpu_once, detect_cpu);
+    return has_avx2 ? scan_avx2(p, n, base, s) : scan_sse2(p, n, base, s);
+}
+
+typedef struct {
+    const uint8_t* data;     /* data[0]对应文件偏移base */
+    uint64_t base;
+    size_t length;
+    size_t chunk;
+    delta_stream* parts;
+    atomic_int failed;
+} scan_job;
+
+static void scan_chunks(long begin, long end, void* ctx) {
+    scan_job* job = (scan_job*)ctx;
+    for (long c = begin; c < end; c++) {
+        size_t from = (size_t)c * job->chunk;
+        size_t to = from + job->chunk < job->length ? from + job->chunk : job->length;
+        if (!scan_newlines(job->data + from, to - from, job->base + from, &job->parts[c])) {
+            atomic_store(&job->failed, 1);
+        }
+    }
+}
+
+/* 把文件[begin, size)中换行符之后的位置加入s；size为文件大小，最后一个字节之后不算行首 */
+static int scan_file_range(int fd, uint64_t begin, uint64_t size, delta_stream* s) {
+    if (size - begin <= 1) {
+        return 1;
+    }
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t map_start = begin & ~(page - 1);
+    size_t map_len = (size_t)(size - map_start);
+    void* mapped = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, (off_t)map_start);
+    if (mapped == MAP_FAILED) {
+        return 0;
+    }
+    madvise(mapped, map_len, MADV_SEQUENTIAL);
+    madvise(mapped, map_len, MADV_WILLNEED);
+    const uint8_t* data = (const uint8_t*)mapped + (begin - map_start);
+    size_t length = (size_t)(size - 1 - begin);
+    int ok;
+    long count = thread_pool_size(NULL) * 4;
+    if (length / MIN_CHUNK < (size_t)count) {
+        count = (long)(length / MIN_CHUNK);
+    }
+    if (length < PARALLEL_THRESHOLD || count < 2) {
+        ok = scan_newlines(data, length, begin, s);
+    } else {
+        scan_job job = {data, begin, length, (length + (size_t)count - 1) / (size_t)count, NULL, 0};
+        job.parts = (delta_stream*)calloc((size_t)count, sizeof(delta_stream));
+        ok = job.parts != NULL;
+        if (ok) {
+            // 每段的差值序列约为段长的1/30，预先分配避免扫描中反复扩容
+            for (long c = 0; c < count; c++) {
+                stream_reserve(&job.parts[c], job.chunk / 32 + BLOCK_RESERVE);
+            }
+            parallel_for(NULL, 0, count, 1, scan_chunks, &job);
+            ok = !atomic_load(&job.failed);
+            for (long c = 0; c < count; c++) {
+                ok = ok && stream_merge(s, &job.parts[c]);
+                free(job.parts[c].data);
+            }
+            free(job.parts);
+        }
+    }
+    munmap(mapped, map_len);
+    return ok;
+}
+
+static int pread_all(int fd, void* buffer, size_t len, uint64_t offset) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t r = pread(fd, (char*)buffer + done, len - done, (off_t)(offset + done));
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            return 0;
+        }
+        done += (size_t)r;
+    }
+    return 1;
+}
+
+static int pwrite_all(int fd, const void* buffer, size_t len, uint64_t offset) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t r = pwrite(fd, (const char*)buffer + done, len - done, (off_t)(offset + done));
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            return 0;
+        }
+        done += (size_t)r;
+    }
+    return 1;
+}
+
+/* 读取文件[size - TAIL_BYTES, size)，计算哈希并取得最后一个字节 */
+static int read_tail(int fd, uint64_t size, uint64_t* hash, int* ends_with_newline) {
+    char buffer[TAIL_BYTES];
+    size_t n = size < TAIL_BYTES ? (size_t)size : TAIL_BYTES;
+    if (n == 0) {
+        buffer[0] = '\0';
+    } else if (!pread_all(fd, buffer, n, size - n)) {
+        return 0;
+    }
+    *hash = xxh3_64(buffer, n);
+    *ends_with_newline = n > 0 && buffer[n - 1] == '\n';
+    return 1;
+}
+
+/* 把文件从old_size增长到size的部分加入s，s中已有[0, old_size)的行首 */
+static int extend_stream(delta_stream* s, int fd, uint64_t old_size, int old_ends_with_newline, uint64_t size) {
+    if (size <= old_size) {
+        return 1;
+    }
+    if (!stream_reserve(s, VARINT_MAX)) {
+        return 0;
+    }
+    // 原来以换行符结尾时，新增部分的开头是新的一行
+    if (old_size == 0 || old_ends_with_newline) {
+        stream_put(s, old_size);
+    }
+    return scan_file_range(fd, old_size, size, s);
+}
+
+/* ---------- 检查点 ---------- */
+
+/* 从第from个检查点开始解码差值并建立之后的检查点，同时校验序列；返回1成功，0序列无效，-1内存不足 */
+static int build_blocks(line_index* idx, size_t from) {
+    const delta_stream* s = &idx->stream;
+    size_t needed = s->lines == 0 ? 0 : (size_t)((s->lines - 1) / BLOCK_LINES + 1);
+    if (needed > idx->block_cap) {
+        size_t cap = needed + needed / 4 + 16;
+        uint64_t* offsets = (uint64_t*)realloc(idx->block_offset, cap * sizeof(uint64_t));
+        if (offsets == NULL) {
+            return -1;
+        }
+        idx->block_offset = offsets;
+        size_t* positions = (size_t*)realloc(idx->block_pos, cap * sizeof(size_t));
+        if (positions == NULL) {
+            return -1;
+        }
+        idx->block_pos = positions;
+        idx->block_cap = cap;
+    }
+    if (needed == 0) {
+        return s->len == 0;
+    }
+    if (from == 0) {
+        idx->block_offset[0] = 0;
+        idx->block_pos[0] = 0;
+    }
+    uint64_t offset = idx->block_offset[from];
+    size_t pos = idx->block_pos[from];
+    for (uint64_t line = (uint64_t)from * BLOCK_LINES + 1; line < s->lines; line++) {
+        uint64_t delta = 0;
+        int shift = 0;
+        uint8_t b;
+        do {
+            if (pos >= s->len || shift > 63) {
+                return 0;
+            }
+            b = s->data[pos++];
+            delta |= (uint64_t)(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        if (delta == 0 || delta >= idx->size - offset) {
+            return 0;
+        }
+        offset += delta;
+        if (line % BLOCK_LINES == 0) {
+            idx->block_offset[line / BLOCK_LINES] = offset;
+            idx->block_pos[line / BLOCK_LINES] = pos;
+        }
+    }
+    return pos == s->len && offset == s->last;
+}
+
+/* ---------- 索引文件 ---------- */
+
+static int sidecar_path(const char* filename, char* path) {
+    int n = snprintf(path, PATH_LIMIT, "%s%s", filename, LINE_INDEX_SUFFIX);
+    return n > 0 && n < PATH_LIMIT;
+}
+
+static void seal_header(sidecar_header* h) {
+    h->header_hash = xxh3_64(h, offsetof(sidecar_header, header_hash));
+}
+
+static void make_header(const line_index* idx, sidecar_header* h) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, sidecar_magic, sizeof(h->magic));
+    h->file_size = idx->size;
+    h->mtime_sec = idx->mtime_sec;
+    h->mtime_nsec = idx->mtime_nsec;
+    h->lines = idx->stream.lines;
+    h->last_start = idx->stream.last;
+    h->stream_bytes = idx->stream.len;
+    h->tail_hash = idx->tail_hash;
+    h->flags = idx->ends_with_newline ? FLAG_ENDS_WITH_NEWLINE : 0;
+    seal_header(h);
+}
+
+/* 读取并校验文件头，差值序列必须完整地在文件中 */
+static int read_header(int sfd, sidecar_header* h) {
+    struct stat st;
+    if (!pread_all(sfd, h, sizeof(*h), 0) || memcmp(h->magic, sidecar_magic, sizeof(h->magic)) != 0 ||
+        h->header_hash != xxh3_64(h, offsetof(sidecar_header, header_hash)) || fstat(sfd, &st) != 0) {
+        return 0;
+    }
+    return (uint64_t)st.st_size >= sizeof(*h) && h->stream_bytes <= (uint64_t)st.st_size - sizeof(*h) &&
+           (h->lines == 0) == (h->file_size == 0) && h->last_start < h->file_size + (h->file_size == 0);
+}
+
+/* 载入索引文件中的索引，不检查是否与文件一致；索引文件不存在或无效返回0 */
+static int load_sidecar(line_index* idx) {
+    char path[PATH_LIMIT];
+    if (!sidecar_path(idx->filename, path)) {
+        return 0;
+    }
+    int sfd = open(path, O_RDONLY | O_CLOEXEC);
+    if (sfd < 0) {
+        return 0;
+    }
+    // 共享锁：不读到append_file正在写入的半个更新
+    flock(sfd, LOCK_SH);
+    sidecar_header h;
+    int ok = read_header(sfd, &h) && h.stream_bytes < SIZE_MAX - VARINT_MAX;
+    delta_stream* s = &idx->stream;
+    if (ok) {
+        ok = stream_reserve(s, (size_t)h.stream_bytes + VARINT_MAX) &&
+             pread_all(sfd, s->data, (size_t)h.stream_bytes, sizeof(h));
+    }
+    close(sfd);
+    if (!ok) {
+        return 0;
+    }
+    s->len = (size_t)h.stream_bytes;
+    s->lines = h.lines;
+    s->first = 0;
+    s->last = h.last_start;
+    idx->size = h.file_size;
+    idx->mtime_sec = h.mtime_sec;
+    idx->mtime_nsec = h.mtime_nsec;
+    idx->tail_hash = h.tail_hash;
+    idx->ends_with_newline = (h.flags & FLAG_ENDS_WITH_NEWLINE) != 0;
+    return build_blocks(idx, 0) == 1;
+}
+
+/* 写入完整的索引文件：先写临时文件再改名，读取者总是看到完整的文件 */
+static int save_full(const line_index* idx, const char* path) {
+    char temp[PATH_LIMIT + 32];
+    snprintf(temp, sizeof(temp), "%s.%ld.%u.tmp", path, (long)getpid(), atomic_fetch_add(&temp_counter, 1));
+    int sfd = open(temp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (sfd < 0) {
+        return 0;
+    }
+    sidecar_header h;
+    make_header(idx, &h);
+    int ok = pwrite_all(sfd, &h, sizeof(h), 0) && pwrite_all(sfd, idx->stream.data, idx->stream.len, sizeof(h));
+    close(sfd);
+    if (!ok || rename(temp, path) != 0) {
+        unlink(temp);
+        return 0;
+    }
+    return 1;
+}
+
+/* 在持有排他锁的索引文件中追加差值、再写新的文件头；中途失败时旧文件头仍然有效 */
+static int append_sidecar(int sfd, const sidecar_header* old, const uint8_t* bytes, size_t len,
+                          const sidecar_header* updated) {
+    return pwrite_all(sfd, bytes, len, sizeof(*old) + old->stream_bytes) &&
+           pwrite_all(sfd, updated, sizeof(*updated), 0);
+}
+
+/* 保存索引；previous不为NULL且索引文件仍是previous描述的状态时只追加新增的差值 */
+static void save_index(const line_index* idx, const sidecar_header* previous) {
+    char path[PATH_LIMIT];
+    if ((idx->flags & LINE_INDEX_NO_SAVE) || !sidecar_path(idx->filename, path)) {
+        return;
+    }
+    if (previous != NULL) {
+        int sfd = open(path, O_RDWR | O_CLOEXEC);
+        if (sfd >= 0) {
+            flock(sfd, LOCK_EX);
+            sidecar_header current;
+            int same = read_header(sfd, &current) && memcmp(&current, previous, sizeof(current)) == 0;
+            int ok = 0;
+            if (same) {
+                sidecar_header updated;
+                make_header(idx, &updated);
+                ok = append_sidecar(sfd, previous, idx->stream.data + previous->stream_bytes,
+                                    idx->stream.len - (size_t)previous->stream_bytes, &updated);
+            }
+            close(sfd);
+            if (ok) {
+                return;
+            }
+        }
+    }
+    if (!save_full(idx, path)) {
+        debug_print("无法写入行索引文件，只在内存中使用索引");
+    }
+}
+
+/* ---------- 打开与刷新 ---------- */
+
+static void reset_index(line_index* idx) {
+    free(idx->stream.data);
+    memset(&idx->stream, 0, sizeof(idx->stream));
+    idx->size = 0;
+    idx->ends_with_newline = 0;
+    idx->valid = 0;
+}
+
+/* 使索引与文件当前的内容一致：可能时载入索引文件或只扫描追加的部分，否则重新扫描整个文件 */
+static error_code sync_index(line_index* idx, int try_sidecar) {
+    struct stat st;
+    if (fstat(idx->fd, &st) != 0) {
+        error_log_detail(ERR_LINE_INDEX_OPEN, "无法获取文件信息", idx->filename);
+        return ERR_LINE_INDEX_OPEN;
+    }
+    uint64_t size = (uint64_t)st.st_size;
+    int64_t mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    int64_t mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+    if (!idx->valid && try_sidecar) {
+        idx->valid = load_sidecar(idx);
+        if (!idx->valid) {
+            reset_index(idx);
+        }
+        idx->source = LINE_INDEX_LOADED;
+    }
+    if (idx->valid) {
+        if (idx->size == size && idx->mtime_sec == mtime_sec && idx->mtime_nsec == mtime_nsec) {
+            return ERR_OK;
+        }
+        uint64_t hash = 0;
+        int ends = 0;
+        if (size > idx->size && read_tail(idx->fd, idx->size, &hash, &ends) && hash == idx->tail_hash) {
+            sidecar_header previous;
+            make_header(idx, &previous);
+            uint64_t old_lines = idx->stream.lines;
+            if (!extend_stream(&idx->stream, idx->fd, idx->size, idx->ends_with_newline, size) ||
+                !read_tail(idx->fd, size, &idx->tail_hash, &idx->ends_with_newline)) {
+                reset_index(idx);
+                return error_raise(ERR_LINE_INDEX_ALLOC, "扫描追加的内容失败");
+            }
+            idx->size = size;
+            idx->mtime_sec = mtime_sec;
+            idx->mtime_nsec = mtime_nsec;
+            if (build_blocks(idx, old_lines == 0 ? 0 : (size_t)((old_lines - 1) / BLOCK_LINES)) != 1) {
+                reset_index(idx);
+                return error_raise(ERR_LINE_INDEX_ALLOC, "内存分配失败");
+            }
+            idx->source = LINE_INDEX_EXTENDED;
+            save_index(idx, &previous);
+            return ERR_OK;
+        }
+        reset_index(idx);
+    }
+    if (!extend_stream(&idx->stream, idx->fd, 0, 0, size) ||
+        !read_tail(idx->fd, size, &idx->tail_hash, &idx->ends_with_newline)) {
+        reset_index(idx);
+        return error_raise(ERR_LINE_INDEX_ALLOC, "扫描文件失败");
+    }
+    idx->size = size;
+    idx->mtime_sec = mtime_sec;
+    idx->mtime_nsec = mtime_nsec;
+    if (build_blocks(idx, 0) != 1) {
+        reset_index(idx);
+        return error_raise(ERR_LINE_INDEX_ALLOC, "内存分配失败");
+    }
+    idx->valid = 1;
+    idx->source = LINE_INDEX_BUILT;
+    save_index(idx, NULL);
+    return ERR_OK;
+}
+
+error_code line_index_open(const char* filename, int flags, line_index** out) {
+    debug_print("打开行索引");
+    if (filename == NULL || out == NULL) {
+        return error_raise(ERR_LINE_INDEX_NULL, "文件名或输出参数为NULL");
+    }
+    *out = NULL;
+    line_index* idx = (line_index*)calloc(1, sizeof(line_index));
+    if (idx == NULL || (idx->filename = strdup(filename)) == NULL) {
+        free(idx);
+        return error_raise(ERR_LINE_INDEX_ALLOC, "内存分配失败");
+    }
+    idx->flags = flags;
+    idx->fd = open(filename, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (idx->fd < 0 || fstat(idx->fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        line_index_close(idx);
+        error_log_detail(ERR_LINE_INDEX_OPEN, "无法打开文件", filename);
+        return ERR_LINE_INDEX_OPEN;
+    }
+    error_code code = sync_index(idx, !(flags & LINE_INDEX_REBUILD));
+    if (code != ERR_OK) {
+        line_index_close(idx);
+        return code;
+    }
+    *out = idx;
+    return ERR_OK;
+}
+
+void line_index_close(line_index* index) {
+    if (index == NULL) {
+        return;
+    }
+    if (index->fd >= 0) {
+        close(index->fd);
+    }
+    free(index->stream.data);
+    free(index->block_offset);
+    free(index->block_pos);
+    free(index->filename);
+    free(index);
+}
+
+error_code line_index_refresh(line_index* index) {
+    debug_print("刷新行索引");
+    if (index == NULL) {
+        return error_raise(ERR_LINE_INDEX_NULL, "索引为NULL");
+    }
+    return sync_index(index, 0);
+}
+
+uint64_t line_index_count(const line_index* index) {
+    return index != NULL ? index->stream.lines : 0;
+}
+
+uint64_t line_index_size(const line_index* index) {
+    return index != NULL ? index->size : 0;
+}
+
+line_index_source line_index_get_source(const line_index* index) {
+    return index != NULL ? index->source : LINE_INDEX_BUILT;
+}
+
+/* ---------- 读取 ---------- */
+
+/* 求一行的范围，调用者已检查行号 */
+static void line_span(const line_index* idx, uint64_t line, uint64_t* offset, uint64_t* end) {
+    size_t pos = idx->block_pos[line / BLOCK_LINES];
+    uint64_t start = idx->block_offset[line / BLOCK_LINES];
+    for (uint64_t i = line % BLOCK_LINES; i > 0; i--) {
+        start += stream_get(idx->stream.data, &pos);
+    }
+    *offset = start;
+    if (line + 1 < idx->stream.lines) {
+        // 下一行的差值紧接在后面，下一行行首之前是本行的换行符
+        *end = start + stream_get(idx->stream.data, &pos) - 1;
+    } else {
+        *end = idx->size - (uint64_t)idx->ends_with_newline;
+    }
+}
+
+error_code line_index_span(const line_index* index, uint64_t line, uint64_t* offset, size_t* length) {
+    if (index == NULL || offset == NULL || length == NULL) {
+        return error_raise(ERR_LINE_INDEX_NULL, "索引或输出参数为NULL");
+    }
+    if (line >= index->stream.lines) {
+        return error_raise(ERR_LINE_INDEX_RANGE, "行号超出范围");
+    }
+    uint64_t end;
+    line_span(index, line, offset, &end);
+    *length = (size_t)(end - *offset);
+    return ERR_OK;
+}
+
+/* 读取[start, end)为以'\0'结尾的字符串 */
+static error_code read_range(const line_index* idx, uint64_t start, uint64_t end, char** text, size_t* length) {
+    size_t len = (size_t)(end - start);
+    char* buffer = (char*)mem_alloc(len + 1);
+    if (buffer == NULL) {
+        return error_raise(ERR_LINE_INDEX_ALLOC, "内存分配失败");
+    }
+    if (!pread_all(idx->fd, buffer, len, start)) {
+        mem_free(buffer);
+        return error_raise(ERR_LINE_INDEX_READ, "读取失败或文件已被截断");
+    }
+    buffer[len] = '\0';
+    *text = buffer;
+    if (length != NULL) {
+        *length = len;
+    }
+    return ERR_OK;
+}
+
+error_code line_index_read_line(const line_index* index, uint64_t line, char** text, size_t* length) {
+    if (index == NULL || text == NULL) {
+        return error_raise(ERR_LINE_INDEX_NULL, "索引或输出参数为NULL");
+    }
+    *text = NULL;
+    if (line >= index->stream.lines) {
+        return error_raise(ERR_LINE_INDEX_RANGE, "行号超出范围");
+    }
+    uint64_t start, end;
+    line_span(index, line, &start, &end);
+    return read_range(index, start, end, text, length);
+}
+
+error_code line_index_read_lines(const line_index* index, uint64_t first, uint64_t count, char** text,
+                                 size_t* length) {
+    if (index == NULL || text == NULL) {
+        return error_raise(ERR_LINE_INDEX_NULL, "索引或输出参数为NULL");
+    }
+    *text = NULL;
+    if (count == 0 || first >= index->stream.lines || count > index->stream.lines - first) {
+        return error_raise(ERR_LINE_INDEX_RANGE, "行的范围超出文件");
+    }
+    uint64_t start, end, last_start;
+    line_span(index, first, &start, &end);
+    if (count > 1) {
+        line_span(index, first + count - 1, &last_start, &end);
+    }
+    return read_range(index, start, end, text, length);
+}
+
+/* ---------- 追加后更新索引文件 ---------- */
+
+error_code line_index_update_sidecar(const char* filename) {
+    // 追加本身已经成功，这里的失败只返回错误代码，不用error_raise覆盖调用者线程的最近错误
+    if (filename == NULL) {
+        return ERR_LINE_INDEX_NULL;
+    }
+    char path[PATH_LIMIT];
+    if (!sidecar_path(filename, path)) {
+        return ERR_OK;
+    }
+    int sfd = open(path, O_RDWR | O_CLOEXEC);
+    if (sfd < 0) {
+        return ERR_OK;
+    }
+    debug_print("更新行索引文件");
+    // 排他锁使同时追加的多个线程或进程依次更新，每次都从文件头记录的位置继续
+    flock(sfd, LOCK_EX);
+    error_code code = ERR_OK;
+    sidecar_header h;
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    uint64_t hash = 0;
+    int ends = 0;
+    if (fd < 0 || fstat(fd, &st) != 0 || !read_header(sfd, &h) || (uint64_t)st.st_size <= h.file_size ||
+        !read_tail(fd, h.file_size, &hash, &ends) || hash != h.tail_hash) {
+        // 没有追加、索引文件无效或文件不是在末尾增长：留给下一次line_index_open处理
+        if (fd >= 0) {
+            close(fd);
+        }
+        close(sfd);
+        return ERR_OK;
+    }
+    delta_stream s = {NULL, 0, 0, h.lines, 0, h.last_start};
+    uint64_t size = (uint64_t)st.st_size;
+    sidecar_header updated = h;
+    if (!extend_stream(&s, fd, h.file_size, (h.flags & FLAG_ENDS_WITH_NEWLINE) != 0, size) ||
+        !read_tail(fd, size, &updated.tail_hash, &ends)) {
+        code = ERR_LINE_INDEX_ALLOC;
+    } else {
+        updated.file_size = size;
+        updated.mtime_sec = (int64_t)st.st_mtim.tv_sec;
+        updated.mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+        updated.lines = s.lines;
+        updated.last_start = s.last;
+        updated.stream_bytes = h.stream_bytes + s.len;
+        updated.flags = ends ? FLAG_ENDS_WITH_NEWLINE : 0;
+        seal_header(&updated);
+        if (!append_sidecar(sfd, &h, s.data, s.len, &updated)) {
+            code = ERR_LINE_INDEX_SAVE;
+        }
+    }
+    free(s.data);
+    close(fd);
+    close(sfd);
+    return code;
+}
+
+static int module_init(void) {
+    pthread_once(&cpu_once, detect_cpu);
+    debug_print(has_avx2 ? "行索引扫描使用AVX2指令" : "行索引扫描使用SSE2指令");
+    debug_print("行索引库初始化成功");
+    return 1;
+}
+
+int initialize_line_index() {
+    return module_init_once(MODULE_LINE_INDEX, module_init);
+}
\ No newline at end of file
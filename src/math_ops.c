@@ -5,91 +5,108 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include "../include/math_ops.h"
+#include "../include/module.h"
+#include "../include/thread_pool.h"
 #include "../include/utils.h"
+#include "../include/metrics.h"
+#include "../include/allocator.h"
 
-static int is_initialized = 0;
+/* 元素数（或区间长度）达到该值时使用线程池并行计算 */
+#define PARALLEL_THRESHOLD (1 << 16)
+/* 并行查找素数时每个分块覆盖的整数个数 */
+#define PRIME_CHUNK_SIZE (1 << 15)
+/* 素数计数的分段筛每段覆盖的整数个数 */
+#define COUNT_SIEVE_SEGMENT (1 << 18)
+/* Lucy_Hedgehog算法中一层的更新个数达到该值时并行更新 */
+#define LUCY_PARALLEL_WORK (1 << 15)
+/* 分解整数时试除的素数上界（不含） */
+#define FACTOR_TRIAL_LIMIT 1024
+/* Pollard-Brent rho每连乘这么多步的差做一次GCD */
+#define FACTOR_GCD_BATCH 128
+/* 批量分解的个数达到该值时并行 */
+#define FACTOR_PARALLEL_THRESHOLD 256
 
 int add(int a, int b) {
-    debug_print("执行加法运算");
-    return a + b;
+    int result = 0;
+    if (add_checked(a, b, &result) != ERR_OK) {
+        return 0;
+    }
+    return result;
 }
 
 int subtract(int a, int b) {
-    debug_print("执行减法运算");
-    return a - b;
+    int result = 0;
+    if (subtract_checked(a, b, &result) != ERR_OK) {
+        return 0;
+    }
+    return result;
 }
 
 int multiply(int a, int b) {
-    debug_print("执行乘法运算");
-    return a * b;
+    int result = 0;
+    if (multiply_checked(a, b, &result) != ERR_OK) {
+        return 0;
+    }
+    return result;
 }
 
 int divide(int a, int b) {
-    debug_print("执行除法运算");
-    if (b == 0) {
-        error_log(1001, "除数不能为零");
+    int result = 0;
+    if (divide_checked(a, b, &result) != ERR_OK) {
         return 0;
     }
-    return a / b;
+    return result;
 }
 
 int factorial(int n) {
-    debug_print("计算阶乘");
-    if (n < 0) {
-        error_log(1002, "阶乘不能用于负数");
+    int result = 0;
+    if (factorial_checked(n, &result) != ERR_OK) {
         return -1;
     }
-    
-    if (n == 0 || n == 1) {
-        return 1;
-    }
-    
-    return n * factorial(n - 1);
+    return result;
 }
 
 int fibonacci(int n) {
-    debug_print("计算斐波那契数");
-    if (n < 0) {
-        error_log(1003, "斐波那契数列索引不能为负数");
+    int result = 0;
+    if (fibonacci_checked(n, &result) != ERR_OK) {
         return -1;
     }
-    
-    if (n == 0) {
-        return 0;
-    }
-    
-    if (n == 1 || n == 2) {
-        return 1;
-    }
-    
-    return fibonacci(n - 1) + fibonacci(n - 2);
+    return result;
 }
 
 int gcd(int a, int b) {
-    debug_print("计算最大公约数");
-    int temp;
-    while (b != 0) {
-        temp = b;
-        b = a % b;
-        a = temp;
+    int result = 0;
+    if (gcd_checked(a, b, &result) != ERR_OK) {
+        return -1;
+    }
+    return result;
+}
+
+typedef struct {
+    const int* arr;
+    atomic_llong sum;
+} average_ctx;
+
+static void average_range(long begin, long end, void* ctx) {
+    average_ctx* avg = (average_ctx*)ctx;
+    long long sum = 0;
+    for (long i = begin; i < end; i++) {
+        sum += avg->arr[i];
     }
-    return a;
+    atomic_fetch_add(&avg->sum, sum);
 }
 
 double average(int arr[], int size) {
-    debug_print("计算平均值");
-    if (size <= 0) {
-        error_log(1004, "数组大小必须大于零");
+    double result = 0.0;
+    if (average_checked(arr, size, &result) != ERR_OK) {
         return 0.0;
     }
-    
-    int sum = 0;
-    for (int i = 0; i < size; i++) {
-        sum = add(sum, arr[i]);
-    }
-    
-    return (double)sum / size;
+    return result;
 }
 
 static int is_prime(int num) {
@@ -105,7 +122,8 @@ static int is_prime(int num) {
         return 0;
     }
     
-    for (int i = 5; i * i <= num; i += 6) {
+    // 用i <= num / i代替i * i <= num，num接近INT_MAX时i * i会溢出
+    for (int i = 5; i <= num / i; i += 6) {
         if (num % i == 0 || num % (i + 2) == 0) {
             return 0;
         }
@@ -114,54 +132,875 @@ static int is_prime(int num) {
     return 1;
 }
 
+typedef struct {
+    long start;
+    long end;
+    int** chunk_primes;
+    int* chunk_counts;
+    atomic_int failed;
+} primes_ctx;
+
+static void find_primes_range(long begin, long end, void* ctx) {
+    primes_ctx* pc = (primes_ctx*)ctx;
+    for (long chunk = begin; chunk < end; chunk++) {
+        long lo = pc->start + chunk * PRIME_CHUNK_SIZE;
+        long hi = lo + PRIME_CHUNK_SIZE - 1 < pc->end ? lo + PRIME_CHUNK_SIZE - 1 : pc->end;
+        int* primes = (int*)malloc((size_t)(hi - lo + 1) * sizeof(int));
+        if (primes == NULL) {
+            atomic_store(&pc->failed, 1);
+            continue;
+        }
+        int found = 0;
+        for (long i = lo; i <= hi; i++) {
+            if (is_prime((int)i)) {
+                primes[found++] = (int)i;
+            }
+        }
+        pc->chunk_primes[chunk] = primes;
+        pc->chunk_counts[chunk] = found;
+    }
+}
+
+/* 按分块并行筛选，各分块结果写入独立缓冲区后按顺序合并 */
+static error_code find_primes_parallel(int start, int end, int** out_primes, int* count) {
+    primes_ctx pc;
+    pc.start = start;
+    pc.end = end;
+    long chunks = ((long)end - start + PRIME_CHUNK_SIZE) / PRIME_CHUNK_SIZE;
+    pc.chunk_primes = (int**)calloc((size_t)chunks, sizeof(int*));
+    pc.chunk_counts = (int*)calloc((size_t)chunks, sizeof(int));
+    atomic_init(&pc.failed, 0);
+    if (pc.chunk_primes == NULL || pc.chunk_counts == NULL) {
+        free(pc.chunk_primes);
+        free(pc.chunk_counts);
+        return error_raise(ERR_MATH_ALLOC, "内存分配失败");
+    }
+
+    parallel_for(NULL, 0, chunks, 1, find_primes_range, &pc);
+
+    int prime_count = 0;
+    for (long i = 0; i < chunks; i++) {
+        prime_count += pc.chunk_counts[i];
+    }
+    int* primes = NULL;
+    if (!atomic_load(&pc.failed)) {
+        primes = (int*)mem_alloc((prime_count > 0 ? prime_count : 1) * sizeof(int));
+    }
+    int index = 0;
+    for (long i = 0; i < chunks; i++) {
+        if (primes != NULL && pc.chunk_counts[i] > 0) {
+            memcpy(primes + index, pc.chunk_primes[i], pc.chunk_counts[i] * sizeof(int));
+            index += pc.chunk_counts[i];
+        }
+        free(pc.chunk_primes[i]);
+    }
+    free(pc.chunk_primes);
+    free(pc.chunk_counts);
+
+    if (primes == NULL) {
+        return error_raise(ERR_MATH_ALLOC, "内存分配失败");
+    }
+    *out_primes = primes;
+    *count = prime_count;
+    return ERR_OK;
+}
+
 int* find_primes(int start, int end, int* count) {
+    int* primes = NULL;
+    int prime_count = 0;
+    find_primes_checked(start, end, &primes, &prime_count);
+    if (count != NULL) {
+        *count = prime_count;
+    }
+    return primes;
+}
+
+error_code add_checked(int a, int b, int* result) {
+    debug_print("执行加法运算");
+    metrics_count_call(METRIC_ADD);
+    if (result == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
+    int sum;
+    if (__builtin_add_overflow(a, b, &sum)) {
+        return error_raise(ERR_MATH_OVERFLOW, "加法结果溢出");
+    }
+    *result = sum;
+    return ERR_OK;
+}
+
+error_code subtract_checked(int a, int b, int* result) {
+    debug_print("执行减法运算");
+    metrics_count_call(METRIC_SUBTRACT);
+    if (result == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
+    int difference;
+    if (__builtin_sub_overflow(a, b, &difference)) {
+        return error_raise(ERR_MATH_OVERFLOW, "减法结果溢出");
+    }
+    *result = difference;
+    return ERR_OK;
+}
+
+error_code multiply_checked(int a, int b, int* result) {
+    debug_print("执行乘法运算");
+    metrics_count_call(METRIC_MULTIPLY);
+    if (result == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
+    int product;
+    if (__builtin_mul_overflow(a, b, &product)) {
+        return error_raise(ERR_MATH_OVERFLOW, "乘法结果溢出");
+    }
+    *result = product;
+    return ERR_OK;
+}
+
+error_code divide_checked(int a, int b, int* result) {
+    debug_print("执行除法运算");
+    metrics_count_call(METRIC_DIVIDE);
+    if (result == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
+    if (b == 0) {
+        return error_raise(ERR_MATH_DIVIDE_BY_ZERO, "除数不能为零");
+    }
+    if (a == INT_MIN && b == -1) {
+        return error_raise(ERR_MATH_OVERFLOW, "除法结果溢出");
+    }
+    *result = a / b;
+    return ERR_OK;
+}
+
+error_code factorial_checked(int n, int* result) {
+    debug_print("计算阶乘");
+    metrics_count_call(METRIC_FACTORIAL);
+    if (result == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
+    if (n < 0) {
+        return error_raise(ERR_MATH_NEGATIVE_FACTORIAL, "阶乘不能用于负数");
+    }
+    
+    int product = 1;
+    for (int i = 2; i <= n; i++) {
+        if (__builtin_mul_overflow(product, i, &product)) {
+            return error_raise(ERR_MATH_OVERFLOW, "阶乘结果溢出");
+        }
+    }
+    
+    *result = product;
+    return ERR_OK;
+}
+
+error_code fibonacci_checked(int n, int* result) {
+    debug_print("计算斐波那契数");
+    metrics_count_call(METRIC_FIBONACCI);
+    if (result == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
+    if (n < 0) {
+        return error_raise(ERR_MATH_NEGATIVE_FIBONACCI, "斐波那契数列索引不能为负数");
+    }
+    
+    // 迭代计算，第47项起超出int范围
+    int previous = 0;
+    int current = 0;
+    int next = 1;
+    for (int i = 0; i < n; i++) {
+        previous = current;
+        current = next;
+        if (__builtin_add_overflow(previous, current, &next) && i + 1 < n) {
+            return error_raise(ERR_MATH_OVERFLOW, "斐波那契数结果溢出");
+        }
+    }
+    
+    *result = current;
+    return ERR_OK;
+}
+
+error_code gcd_checked(int a, int b, int* result) {
+    debug_print("计算最大公约数");
+    metrics_count_call(METRIC_GCD);
+    if (result == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
+    
+    // 取绝对值后用无符号数计算，避免INT_MIN取负和INT_MIN % -1溢出
+    unsigned int x = a < 0 ? 0u - (unsigned int)a : (unsigned int)a;
+    unsigned int y = b < 0 ? 0u - (unsigned int)b : (unsigned int)b;
+    while (y != 0) {
+        unsigned int temp = y;
+        y = x % y;
+        x = temp;
+    }
+    if (x > INT_MAX) {
+        return error_raise(ERR_MATH_OVERFLOW, "最大公约数超出int范围");
+    }
+    
+    *result = (int)x;
+    return ERR_OK;
+}
+
+error_code average_checked(const int arr[], int size, double* result) {
+    debug_print("计算平均值");
+    metrics_count_call(METRIC_AVERAGE);
+    if (arr == NULL || result == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "数组或输出参数为NULL");
+    }
+    if (size <= 0) {
+        return error_raise(ERR_MATH_EMPTY_ARRAY, "数组大小必须大于零");
+    }
+    
+    if (size >= PARALLEL_THRESHOLD) {
+        // 大数组分块并行求部分和，用long long累加避免溢出
+        average_ctx avg;
+        avg.arr = arr;
+        atomic_init(&avg.sum, 0);
+        parallel_for(NULL, 0, size, 0, average_range, &avg);
+        *result = (double)atomic_load(&avg.sum) / size;
+        return ERR_OK;
+    }
+    
+    // 与并行路径一样用long long累加，int数组的和不会溢出
+    long long sum = 0;
+    for (int i = 0; i < size; i++) {
+        sum += arr[i];
+    }
+    
+    *result = (double)sum / size;
+    return ERR_OK;
+}
+
+error_code find_primes_checked(int start, int end, int** primes, int* count) {
     debug_print("查找素数");
+    metrics_count_call(METRIC_FIND_PRIMES);
+    if (primes == NULL || count == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
     if (start > end) {
-        error_log(1005, "起始值不能大于结束值");
-        *count = 0;
-        return NULL;
+        return error_raise(ERR_MATH_INVALID_RANGE, "起始值不能大于结束值");
+    }
+    
+    if ((long)end - start >= PARALLEL_THRESHOLD) {
+        return find_primes_parallel(start, end, primes, count);
     }
     
     // 计算素数的数量
+    // 循环变量用long，end为INT_MAX时i++不会溢出
     int prime_count = 0;
-    for (int i = start; i <= end; i++) {
-        if (is_prime(i)) {
+    for (long i = start; i <= end; i++) {
+        if (is_prime((int)i)) {
             prime_count++;
         }
     }
     
     // 分配内存
-    int* primes = (int*)malloc(prime_count * sizeof(int));
-    if (primes == NULL) {
-        error_log(1006, "内存分配失败");
-        *count = 0;
-        return NULL;
+    int* result = (int*)mem_alloc((prime_count > 0 ? prime_count : 1) * sizeof(int));
+    if (result == NULL) {
+        return error_raise(ERR_MATH_ALLOC, "内存分配失败");
     }
     
     // 填充素数数组
     int index = 0;
-    for (int i = start; i <= end; i++) {
-        if (is_prime(i)) {
-            primes[index++] = i;
+    for (long i = start; i <= end; i++) {
+        if (is_prime((int)i)) {
+            result[index++] = (int)i;
         }
     }
     
+    *primes = result;
     *count = prime_count;
+    return ERR_OK;
+}
+
+/* ---------- 素数计数 ---------- */
+
+/* 整数平方根（向下取整），逐位确定 */
+static uint64_t isqrt_u64(uint64_t n) {
+    uint64_t root = 0;
+    for (uint64_t bit = 1ULL << 62; bit != 0; bit >>= 2) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+    }
+    return root;
+}
+
+/* n / d：n < 2^53时先用浮点除法估计商（误差不超过1）再修正，比64位整数除法快 */
+static inline uint64_t quotient(uint64_t n, uint64_t d) {
+    uint64_t q = (uint64_t)((double)n / (double)d);
+    if (q * d > n) {
+        q--;
+    } else if (n - q * d >= d) {
+        q++;
+    }
+    return q;
+}
+
+/* 筛出不超过limit的素数 */
+static uint32_t* sieve_base_primes(uint32_t limit, size_t* count) {
+    uint8_t* composite = (uint8_t*)calloc((size_t)limit + 1, 1);
+    uint32_t* primes = (uint32_t*)malloc(((size_t)limit / 2 + 1) * sizeof(uint32_t));
+    if (composite == NULL || primes == NULL) {
+        free(composite);
+        free(primes);
+        return NULL;
+    }
+    size_t found = 0;
+    for (uint64_t i = 2; i <= limit; i++) {
+        if (composite[i]) {
+            continue;
+        }
+        primes[found++] = (uint32_t)i;
+        for (uint64_t m = i * i; m <= limit; m += i) {
+            composite[m] = 1;
+        }
+    }
+    free(composite);
+    *count = found;
     return primes;
 }
 
-int initialize_math_ops() {
-    if (is_initialized) {
-        debug_print("数学运算库已经初始化");
-        return 1;
+typedef struct {
+    uint64_t lo;
+    uint64_t hi;
+    const uint32_t* primes;      /* 不超过sqrt(hi)的素数 */
+    size_t prime_count;
+    atomic_ullong count;
+    atomic_int failed;
+} window_ctx;
+
+/* 分段筛统计第begin到end - 1段中的素数，每个调用使用自己的段缓冲区 */
+static void count_window_range(long begin, long end, void* ctx) {
+    window_ctx* wc = (window_ctx*)ctx;
+    uint8_t* composite = (uint8_t*)malloc(COUNT_SIEVE_SEGMENT);
+    if (composite == NULL) {
+        atomic_store(&wc->failed, 1);
+        return;
     }
-    
-    if (!initialize_utils()) {
-        error_log(1007, "初始化工具库失败");
+    uint64_t found = 0;
+    for (long s = begin; s < end; s++) {
+        uint64_t seg_lo = wc->lo + (uint64_t)s * COUNT_SIEVE_SEGMENT;
+        uint64_t seg_hi = wc->hi - seg_lo < COUNT_SIEVE_SEGMENT ? wc->hi : seg_lo + COUNT_SIEVE_SEGMENT - 1;
+        size_t len = (size_t)(seg_hi - seg_lo + 1);
+        memset(composite, 0, len);
+        for (size_t k = 0; k < wc->prime_count; k++) {
+            uint64_t p = wc->primes[k];
+            if (p * p > seg_hi) {
+                break;
+            }
+            uint64_t first = p * p >= seg_lo ? p * p : (seg_lo + p - 1) / p * p;
+            for (uint64_t m = first; m <= seg_hi; m += p) {
+                composite[m - seg_lo] = 1;
+            }
+        }
+        for (size_t i = 0; i < len; i++) {
+            found += !composite[i];
+        }
+    }
+    free(composite);
+    atomic_fetch_add(&wc->count, found);
+}
+
+/* 分段筛统计[lo, hi]（lo >= 2）中的素数 */
+static error_code count_primes_window(uint64_t lo, uint64_t hi, uint64_t* count) {
+    window_ctx wc;
+    wc.lo = lo;
+    wc.hi = hi;
+    wc.primes = sieve_base_primes((uint32_t)isqrt_u64(hi), &wc.prime_count);
+    if (wc.primes == NULL) {
+        return error_raise(ERR_MATH_ALLOC, "内存分配失败");
+    }
+    atomic_init(&wc.count, 0);
+    atomic_init(&wc.failed, 0);
+    long segments = (long)((hi - lo) / COUNT_SIEVE_SEGMENT + 1);
+    parallel_for(NULL, 0, segments, 1, count_window_range, &wc);
+    free((void*)wc.primes);
+    if (atomic_load(&wc.failed)) {
+        return error_raise(ERR_MATH_ALLOC, "内存分配失败");
+    }
+    *count = atomic_load(&wc.count);
+    return ERR_OK;
+}
+
+/*
+ * Lucy_Hedgehog算法。S(v)为[2, v]中不被已处理素数整除的数的个数（含这些素数本身），初值为v - 1。
+ * 依次处理素数p时，对所有v >= p^2有S(v) -= S(v / p) - S(p - 1)，处理完sqrt(n)以内的素数后S(v) = π(v)。
+ * 只需要v取⌊n / i⌋的值：v > sqrt(n)的存在large[i]中，v <= sqrt(n)的存在small[v]中。
+ */
+typedef struct {
+    uint64_t n;
+    uint64_t root;          /* ⌊sqrt(n)⌋ */
+    uint64_t* large;        /* large[i] = S(n / i)，1 <= i <= root */
+    uint32_t* small;        /* small[v] = S(v)，0 <= v <= root */
+    uint64_t p;             /* 当前素数 */
+    double inverse;         /* 1.0 / p */
+    uint64_t base;          /* S(p - 1) */
+} lucy_ctx;
+
+static void lucy_large_range(long begin, long end, void* ctx) {
+    lucy_ctx* lc = (lucy_ctx*)ctx;
+    for (long i = begin; i < end; i++) {
+        uint64_t d = (uint64_t)i * lc->p;
+        uint64_t sub = d <= lc->root ? lc->large[d] : lc->small[quotient(lc->n, d)];
+        lc->large[i] -= sub - lc->base;
+    }
+}
+
+static void lucy_small_range(long begin, long end, void* ctx) {
+    lucy_ctx* lc = (lucy_ctx*)ctx;
+    for (long v = begin; v < end; v++) {
+        // v <= sqrt(n) < 2^27，乘以倒数后的误差远小于1
+        uint64_t q = (uint64_t)((double)v * lc->inverse);
+        q -= q * lc->p > (uint64_t)v;
+        q += (uint64_t)v - q * lc->p >= lc->p;
+        lc->small[v] -= (uint32_t)(lc->small[q] - lc->base);
+    }
+}
+
+static void lucy_run(lucy_ctx* lc, long begin, long end, range_fn fn) {
+    if (end - begin >= LUCY_PARALLEL_WORK) {
+        parallel_for(NULL, begin, end, 0, fn, lc);
+    } else if (begin < end) {
+        fn(begin, end, lc);
+    }
+}
+
+/*
+ * 处理一个素数p。large[i]读取large[i * p]的旧值，small[v]读取small[v / p]的旧值，
+ * 按区间(root / p^(k+1), root / p^k]分层：large从最深的层开始，small从最高的层开始，
+ * 每层读取的都是尚未更新的层，层内各元素互不依赖，可以并行更新
+ */
+static void lucy_sieve_prime(lucy_ctx* lc, uint64_t p) {
+    lc->p = p;
+    lc->inverse = 1.0 / (double)p;
+    lc->base = lc->small[p - 1];
+    uint64_t square = p * p;
+    uint64_t large_end = lc->n / square < lc->root ? lc->n / square : lc->root;
+
+    uint64_t bounds[64];
+    int levels = 0;
+    for (uint64_t b = lc->root; b > 0 && levels < 64; b /= p) {
+        bounds[levels++] = b;
+    }
+    // bounds[k] = root / p^k，第k层为(bounds[k + 1], bounds[k]]，最后一层的下界为0
+    for (int k = levels - 1; k >= 0; k--) {
+        uint64_t lo = k + 1 < levels ? bounds[k + 1] : 0;
+        uint64_t hi = bounds[k] < large_end ? bounds[k] : large_end;
+        lucy_run(lc, (long)lo + 1, (long)hi + 1, lucy_large_range);
+    }
+    for (int k = 0; k < levels; k++) {
+        uint64_t lo = k + 1 < levels ? bounds[k + 1] : 0;
+        lo = lo + 1 > square ? lo + 1 : square;
+        lucy_run(lc, (long)lo, (long)bounds[k] + 1, lucy_small_range);
+    }
+}
+
+/* 计算π(n)（n >= 2）；needed不超过sqrt(n)时同时输出π(needed) */
+static error_code lucy_prime_pi(uint64_t n, uint64_t needed, uint64_t* pi_n, uint64_t* pi_needed) {
+    lucy_ctx lc;
+    lc.n = n;
+    lc.root = isqrt_u64(n);
+    lc.large = (uint64_t*)malloc((lc.root + 1) * sizeof(uint64_t));
+    lc.small = (uint32_t*)malloc((lc.root + 1) * sizeof(uint32_t));
+    if (lc.large == NULL || lc.small == NULL) {
+        free(lc.large);
+        free(lc.small);
+        return error_raise(ERR_MATH_ALLOC, "内存分配失败");
+    }
+    lc.small[0] = 0;
+    for (uint64_t v = 1; v <= lc.root; v++) {
+        lc.small[v] = (uint32_t)(v - 1);
+        lc.large[v] = n / v - 1;
+    }
+    for (uint64_t p = 2; p <= lc.root; p++) {
+        if (lc.small[p] != lc.small[p - 1]) {
+            lucy_sieve_prime(&lc, p);
+        }
+    }
+    *pi_n = lc.large[1];
+    if (pi_needed != NULL) {
+        *pi_needed = lc.small[needed];
+    }
+    free(lc.large);
+    free(lc.small);
+    return ERR_OK;
+}
+
+uint64_t count_primes(uint64_t lo, uint64_t hi) {
+    uint64_t count = 0;
+    if (count_primes_checked(lo, hi, &count) != ERR_OK) {
         return 0;
     }
-    
+    return count;
+}
+
+error_code count_primes_checked(uint64_t lo, uint64_t hi, uint64_t* count) {
+    debug_print("计算素数个数");
+    metrics_count_call(METRIC_COUNT_PRIMES);
+    if (count == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
+    if (lo > hi) {
+        return error_raise(ERR_MATH_INVALID_RANGE, "起始值不能大于结束值");
+    }
+    if (hi > COUNT_PRIMES_MAX) {
+        return error_raise(ERR_MATH_RANGE_TOO_LARGE, "结束值超过COUNT_PRIMES_MAX");
+    }
+    if (hi < 2) {
+        *count = 0;
+        return ERR_OK;
+    }
+    lo = lo < 2 ? 2 : lo;
+
+    // Lucy_Hedgehog的耗时约为hi^{3/4}，区间更短时分段筛更快
+    uint64_t root = isqrt_u64(hi);
+    if (hi - lo < root * isqrt_u64(root)) {
+        return count_primes_window(lo, hi, count);
+    }
+    uint64_t pi_hi = 0;
+    uint64_t pi_lo = 0;
+    error_code code;
+    if (lo - 1 <= root) {
+        code = lucy_prime_pi(hi, lo - 1, &pi_hi, &pi_lo);
+    } else {
+        code = lucy_prime_pi(hi, 0, &pi_hi, NULL);
+        if (code == ERR_OK) {
+            code = lucy_prime_pi(lo - 1, 0, &pi_lo, NULL);
+        }
+    }
+    if (code != ERR_OK) {
+        return code;
+    }
+    *count = pi_hi - pi_lo;
+    return ERR_OK;
+}
+
+/* ---------- 整数分解 ---------- */
+
+/* 试除用的小素数（3到FACTOR_TRIAL_LIMIT之间的奇素数），以乘法逆元判断整除 */
+typedef struct {
+    uint64_t inverse;    /* p在模2^64下的逆元 */
+    uint64_t limit;      /* UINT64_MAX / p：n * inverse不超过它时p整除n */
+    uint32_t prime;
+} trial_prime;
+
+static trial_prime trial_primes[FACTOR_TRIAL_LIMIT / 2];
+static int trial_prime_count = 0;
+static pthread_once_t trial_once = PTHREAD_ONCE_INIT;
+
+/* 奇数a在模2^64下的逆元，牛顿迭代每次使正确的位数加倍 */
+static uint64_t inverse_u64(uint64_t a) {
+    uint64_t x = a;    // a * a ≡ 1 (mod 8)，已有3位正确
+    for (int i = 0; i < 5; i++) {
+        x *= 2 - a * x;
+    }
+    return x;
+}
+
+static void init_trial_primes(void) {
+    for (uint32_t p = 3; p < FACTOR_TRIAL_LIMIT; p += 2) {
+        int prime = 1;
+        for (uint32_t d = 3; d * d <= p; d += 2) {
+            if (p % d == 0) {
+                prime = 0;
+                break;
+            }
+        }
+        if (prime) {
+            trial_primes[trial_prime_count].prime = p;
+            trial_primes[trial_prime_count].inverse = inverse_u64(p);
+            trial_primes[trial_prime_count].limit = UINT64_MAX / p;
+            trial_prime_count++;
+        }
+    }
+}
+
+/* 二进制GCD */
+static uint64_t gcd_u64(uint64_t a, uint64_t b) {
+    if (a == 0) {
+        return b;
+    }
+    if (b == 0) {
+        return a;
+    }
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0) {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            uint64_t t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+    }
+    return a << shift;
+}
+
+/* 奇数模n下的Montgomery运算，R = 2^64 */
+typedef struct {
+    uint64_t n;
+    uint64_t inverse;    /* n在模2^64下的逆元 */
+    uint64_t r2;         /* R^2 mod n */
+    uint64_t one;        /* R mod n，即1的Montgomery形式 */
+} montgomery;
+
+static void montgomery_init(montgomery* m, uint64_t n) {
+    m->n = n;
+    m->inverse = inverse_u64(n);
+    m->one = (0 - n) % n;
+    m->r2 = (uint64_t)(((unsigned __int128)m->one * m->one) % n);
+}
+
+/* a * b * R^-1 mod n：t - (t * n^-1 mod R) * n的低64位为0，结果为两者高64位之差 */
+static inline uint64_t montgomery_mul(const montgomery* m, uint64_t a, uint64_t b) {
+    unsigned __int128 t = (unsigned __int128)a * b;
+    uint64_t q = (uint64_t)t * m->inverse;
+    uint64_t high = (uint64_t)(t >> 64);
+    uint64_t qn_high = (uint64_t)(((unsigned __int128)q * m->n) >> 64);
+    return high >= qn_high ? high - qn_high : high - qn_high + m->n;
+}
+
+static inline uint64_t montgomery_from(const montgomery* m, uint64_t a) {
+    return montgomery_mul(m, a % m->n, m->r2);
+}
+
+static inline uint64_t montgomery_add(const montgomery* m, uint64_t a, uint64_t b) {
+    uint64_t s = a + b;
+    return (s < a || s >= m->n) ? s - m->n : s;
+}
+
+static uint64_t montgomery_pow(const montgomery* m, uint64_t base, uint64_t exponent) {
+    uint64_t result = m->one;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result = montgomery_mul(m, result, base);
+        }
+        base = montgomery_mul(m, base, base);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+/* 以这7个底数做Miller-Rabin检验对所有64位整数都是确定的 */
+static const uint64_t miller_rabin_bases[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+/* n为大于FACTOR_TRIAL_LIMIT的奇数 */
+static int miller_rabin(uint64_t n) {
+    montgomery m;
+    montgomery_init(&m, n);
+    int shift = __builtin_ctzll(n - 1);
+    uint64_t odd = (n - 1) >> shift;
+    uint64_t minus_one = m.n - m.one;
+    for (size_t i = 0; i < sizeof(miller_rabin_bases) / sizeof(miller_rabin_bases[0]); i++) {
+        uint64_t a = miller_rabin_bases[i] % n;
+        if (a == 0) {
+            continue;
+        }
+        uint64_t x = montgomery_pow(&m, montgomery_from(&m, a), odd);
+        if (x == m.one || x == minus_one) {
+            continue;
+        }
+        int composite = 1;
+        for (int s = 1; s < shift && composite; s++) {
+            x = montgomery_mul(&m, x, x);
+            composite = x != minus_one;
+        }
+        if (composite) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* n没有小于FACTOR_TRIAL_LIMIT的因子时判断素性 */
+static int is_prime_untrialed(uint64_t n) {
+    if (n < (uint64_t)FACTOR_TRIAL_LIMIT * FACTOR_TRIAL_LIMIT) {
+        return n > 1;
+    }
+    return miller_rabin(n);
+}
+
+/*
+ * Pollard-Brent rho：迭代f(y) = y^2 + c，每FACTOR_GCD_BATCH步把|x - y|连乘后做一次GCD；
+ * 乘积变为0（GCD为n）时从该批的起点逐步回溯。n为奇合数，返回n的一个非平凡因子
+ */
+static uint64_t pollard_brent(uint64_t n) {
+    montgomery m;
+    montgomery_init(&m, n);
+    for (uint64_t c0 = 1;; c0++) {
+        uint64_t c = montgomery_from(&m, c0);
+        uint64_t y = montgomery_from(&m, 2);
+        uint64_t x = y;
+        uint64_t saved = y;
+        uint64_t q = m.one;
+        uint64_t g = 1;
+        for (uint64_t r = 1; g == 1; r <<= 1) {
+            x = y;
+            for (uint64_t i = 0; i < r; i++) {
+                y = montgomery_add(&m, montgomery_mul(&m, y, y), c);
+            }
+            for (uint64_t k = 0; k < r && g == 1; k += FACTOR_GCD_BATCH) {
+                saved = y;
+                uint64_t steps = r - k < FACTOR_GCD_BATCH ? r - k : FACTOR_GCD_BATCH;
+                for (uint64_t i = 0; i < steps; i++) {
+                    y = montgomery_add(&m, montgomery_mul(&m, y, y), c);
+                    q = montgomery_mul(&m, q, x > y ? x - y : y - x);
+                }
+                g = gcd_u64(q, n);
+            }
+        }
+        if (g == n) {
+            do {
+                saved = montgomery_add(&m, montgomery_mul(&m, saved, saved), c);
+                g = gcd_u64(x > saved ? x - saved : saved - x, n);
+            } while (g == 1);
+        }
+        if (g != n) {
+            return g;
+        }
+    }
+}
+
+static void factors_add(prime_factors* result, uint64_t prime, int exponent) {
+    for (int i = 0; i < result->count; i++) {
+        if (result->primes[i] == prime) {
+            result->exponents[i] += exponent;
+            return;
+        }
+    }
+    // 按升序插入；64位整数至多有15个不同的素因子
+    int i = result->count++;
+    for (; i > 0 && result->primes[i - 1] > prime; i--) {
+        result->primes[i] = result->primes[i - 1];
+        result->exponents[i] = result->exponents[i - 1];
+    }
+    result->primes[i] = prime;
+    result->exponents[i] = exponent;
+}
+
+/* n >= 1 */
+static void factorize_core(uint64_t n, prime_factors* result) {
+    pthread_once(&trial_once, init_trial_primes);
+    result->count = 0;
+    if ((n & 1) == 0) {
+        int twos = __builtin_ctzll(n);
+        factors_add(result, 2, twos);
+        n >>= twos;
+    }
+    for (int i = 0; i < trial_prime_count && n > 1; i++) {
+        const trial_prime* tp = &trial_primes[i];
+        if ((uint64_t)tp->prime * tp->prime > n) {
+            break;
+        }
+        int exponent = 0;
+        while (n * tp->inverse <= tp->limit) {
+            n *= tp->inverse;    // p整除n时n * p^-1 mod 2^64就是n / p
+            exponent++;
+        }
+        if (exponent > 0) {
+            factors_add(result, tp->prime, exponent);
+        }
+    }
+
+    // 剩余部分没有小因子，合数的因子用rho拆开，每个64位整数至多64个素因子（含重复）
+    uint64_t stack[64];
+    int top = 0;
+    if (n > 1) {
+        stack[top++] = n;
+    }
+    while (top > 0) {
+        uint64_t value = stack[--top];
+        if (is_prime_untrialed(value)) {
+            factors_add(result, value, 1);
+            continue;
+        }
+        uint64_t d = pollard_brent(value);
+        stack[top++] = d;
+        stack[top++] = value / d;
+    }
+}
+
+int is_prime_u64(uint64_t n) {
+    if (n < 2) {
+        return 0;
+    }
+    if ((n & 1) == 0) {
+        return n == 2;
+    }
+    pthread_once(&trial_once, init_trial_primes);
+    for (int i = 0; i < trial_prime_count; i++) {
+        const trial_prime* tp = &trial_primes[i];
+        if (n * tp->inverse <= tp->limit) {
+            return n == tp->prime;
+        }
+    }
+    return is_prime_untrialed(n);
+}
+
+error_code factorize_u64(uint64_t n, prime_factors* result) {
+    debug_print("分解整数");
+    metrics_count_call(METRIC_FACTORIZE);
+    if (result == NULL) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "输出参数为NULL");
+    }
+    if (n == 0) {
+        return error_raise(ERR_MATH_FACTORIZE_ZERO, "0没有素因子分解");
+    }
+    factorize_core(n, result);
+    return ERR_OK;
+}
+
+typedef struct {
+    const uint64_t* values;
+    prime_factors* results;
+    atomic_int zero;
+} factorize_ctx;
+
+static void factorize_range(long begin, long end, void* ctx) {
+    factorize_ctx* fc = (factorize_ctx*)ctx;
+    for (long i = begin; i < end; i++) {
+        if (fc->values[i] == 0) {
+            fc->results[i].count = 0;
+            atomic_store(&fc->zero, 1);
+            continue;
+        }
+        factorize_core(fc->values[i], &fc->results[i]);
+    }
+}
+
+error_code factorize_u64_batch(const uint64_t* values, size_t count, prime_factors* results) {
+    debug_print("批量分解整数");
+    metrics_count_call(METRIC_FACTORIZE);
+    if ((values == NULL || results == NULL) && count > 0) {
+        return error_raise(ERR_MATH_NULL_ARGUMENT, "数组或输出参数为NULL");
+    }
+    factorize_ctx fc;
+    fc.values = values;
+    fc.results = results;
+    atomic_init(&fc.zero, 0);
+    if (count >= FACTOR_PARALLEL_THRESHOLD) {
+        parallel_for(NULL, 0, (long)count, 0, factorize_range, &fc);
+    } else {
+        factorize_range(0, (long)count, &fc);
+    }
+    if (atomic_load(&fc.zero)) {
+        return error_raise(ERR_MATH_FACTORIZE_ZERO, "数组中有0，0没有素因子分解");
+    }
+    return ERR_OK;
+}
+
+static int module_init(void) {
     debug_print("数学运算库初始化成功");
-    is_initialized = 1;
     return 1;
-} 
\ No newline at end of file
+}
+
+int initialize_math_ops() {
+    return module_init_once(MODULE_MATH, module_init);
+}
\ No newline at end of file
@@ -0,0 +1,814 @@
+/**
+ * @file matrix_ops.c
+ * @brief 稠密矩阵实现
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <immintrin.h>
+#include "../include/matrix_ops.h"
+#include "../include/module.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+
+/* 运算量m*n*k不超过该值时直接三重循环，打包的开销不划算 */
+#define SMALL_GEMM_WORK (48.0 * 48.0 * 48.0)
+/* 运算量超过该值时按C的分块并行 */
+#define PARALLEL_GEMM_WORK (128.0 * 128.0 * 128.0)
+/* 并行时C的分块数至少为线程数的该倍数，不足时缩小分块的列数 */
+#define TILES_PER_THREAD 4
+/* 微内核的最大行数与列数，边缘块的临时缓冲区按此分配 */
+#define MAX_MR 12
+#define MAX_NR 32
+
+/* ---------- 微内核 ---------- */
+
+/**
+ * 微内核计算C的mr行nr列：c[i * ldc + j] += sum(a[p * mr + i] * b[p * nr + j])，
+ * a、b为打包后的条带，b按MATRIX_ALIGNMENT对齐
+ */
+typedef void (*gemm_kernel)(size_t kc, const void* a, const void* b, void* c, size_t ldc);
+
+/**
+ * 一种元素类型的微内核与分块参数：kc行nr列的B条带留在L1，mc行kc列的A块留在L2，
+ * kc行nc列的B块留在L3
+ */
+typedef struct {
+    gemm_kernel kernel;
+    int mr;
+    int nr;
+    size_t kc;
+    size_t mc;
+    size_t nc;
+    const char* name;
+} gemm_config;
+
+/* 标量微内核，整数按无符号类型运算以回绕 */
+#define DEFINE_GENERIC_KERNEL(name, T)                                                   \
+    static void name(size_t kc, const void* ap, const void* bp, void* cp, size_t ldc) { \
+        const T* a = (const T*)ap;                                                       \
+        const T* b = (const T*)bp;                                                       \
+        T* c = (T*)cp;                                                                   \
+        T acc[4][4] = {{0}};                                                             \
+        for (size_t p = 0; p < kc; p++) {                                                \
+            for (int i = 0; i < 4; i++) {                                                \
+                for (int j = 0; j < 4; j++) {                                            \
+                    acc[i][j] += a[i] * b[j];                                            \
+                }                                                                        \
+            }                                                                            \
+            a += 4;                                                                      \
+            b += 4;                                                                      \
+        }                                                                                \
+        for (int i = 0; i < 4; i++) {                                                    \
+            for (int j = 0; j < 4; j++) {                                                \
+                c[(size_t)i * ldc + j] += acc[i][j];                                     \
+            }                                                                            \
+        }                                                                                \
+    }
+
+DEFINE_GENERIC_KERNEL(kernel_double_generic, double)
+DEFINE_GENERIC_KERNEL(kernel_int32_generic, uint32_t)
+DEFINE_GENERIC_KERNEL(kernel_int64_generic, uint64_t)
+
+/* 6行8列：12个累加寄存器，加上2个B向量和1个广播共15个ymm寄存器 */
+__attribute__((target("avx2,fma")))
+static void kernel_double_avx2(size_t kc, const void* ap, const void* bp, void* cp, size_t ldc) {
+    const double* a = (const double*)ap;
+    const double* b = (const double*)bp;
+    double* c = (double*)cp;
+    __m256d acc[6][2];
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; i++) {
+        acc[i][0] = _mm256_setzero_pd();
+        acc[i][1] = _mm256_setzero_pd();
+        _mm_prefetch((const char*)(c + (size_t)i * ldc), _MM_HINT_T0);
+        _mm_prefetch((const char*)(c + (size_t)i * ldc + 4), _MM_HINT_T0);
+    }
+    for (size_t p = 0; p < kc; p++) {
+        __m256d b0 = _mm256_load_pd(b);
+        __m256d b1 = _mm256_load_pd(b + 4);
+#pragma GCC unroll 6
+        for (int i = 0; i < 6; i++) {
+            __m256d ai = _mm256_broadcast_sd(a + i);
+            acc[i][0] = _mm256_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_pd(ai, b1, acc[i][1]);
+        }
+        a += 6;
+        b += 8;
+    }
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; i++) {
+        double* row = c + (size_t)i * ldc;
+        _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), acc[i][0]));
+        _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), acc[i][1]));
+    }
+}
+
+/* 12行16列：24个累加寄存器，A的元素直接作为FMA的广播内存操作数；开始时预取C块，结束时的读改写不必等待内存 */
+__attribute__((target("avx512f")))
+static void kernel_double_avx512(size_t kc, const void* ap, const void* bp, void* cp, size_t ldc) {
+    const double* a = (const double*)ap;
+    const double* b = (const double*)bp;
+    double* c = (double*)cp;
+    __m512d acc[12][2];
+#pragma GCC unroll 12
+    for (int i = 0; i < 12; i++) {
+        acc[i][0] = _mm512_setzero_pd();
+        acc[i][1] = _mm512_setzero_pd();
+        _mm_prefetch((const char*)(c + (size_t)i * ldc), _MM_HINT_T0);
+        _mm_prefetch((const char*)(c + (size_t)i * ldc + 8), _MM_HINT_T0);
+    }
+    for (size_t p = 0; p < kc; p++) {
+        __m512d b0 = _mm512_load_pd(b);
+        __m512d b1 = _mm512_load_pd(b + 8);
+#pragma GCC unroll 12
+        for (int i = 0; i < 12; i++) {
+            __m512d ai = _mm512_set1_pd(a[i]);
+            acc[i][0] = _mm512_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_pd(ai, b1, acc[i][1]);
+        }
+        a += 12;
+        b += 16;
+    }
+#pragma GCC unroll 12
+    for (int i = 0; i < 12; i++) {
+        double* row = c + (size_t)i * ldc;
+        _mm512_storeu_pd(row, _mm512_add_pd(_mm512_loadu_pd(row), acc[i][0]));
+        _mm512_storeu_pd(row + 8, _mm512_add_pd(_mm512_loadu_pd(row + 8), acc[i][1]));
+    }
+}
+
+/* 6行16列 */
+__attribute__((target("avx2")))
+static void kernel_int32_avx2(size_t kc, const void* ap, const void* bp, void* cp, size_t ldc) {
+    const int32_t* a = (const int32_t*)ap;
+    const int32_t* b = (const int32_t*)bp;
+    int32_t* c = (int32_t*)cp;
+    __m256i acc[6][2];
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; i++) {
+        acc[i][0] = _mm256_setzero_si256();
+        acc[i][1] = _mm256_setzero_si256();
+        _mm_prefetch((const char*)(c + (size_t)i * ldc), _MM_HINT_T0);
+        _mm_prefetch((const char*)(c + (size_t)i * ldc + 8), _MM_HINT_T0);
+    }
+    for (size_t p = 0; p < kc; p++) {
+        __m256i b0 = _mm256_load_si256((const __m256i*)b);
+        __m256i b1 = _mm256_load_si256((const __m256i*)(b + 8));
+#pragma GCC unroll 6
+        for (int i = 0; i < 6; i++) {
+            __m256i ai = _mm256_set1_epi32(a[i]);
+            acc[i][0] = _mm256_add_epi32(acc[i][0], _mm256_mullo_epi32(ai, b0));
+            acc[i][1] = _mm256_add_epi32(acc[i][1], _mm256_mullo_epi32(ai, b1));
+        }
+        a += 6;
+        b += 16;
+    }
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; i++) {
+        __m256i* row = (__m256i*)(c + (size_t)i * ldc);
+        _mm256_storeu_si256(row, _mm256_add_epi32(_mm256_loadu_si256(row), acc[i][0]));
+        _mm256_storeu_si256(row + 1, _mm256_add_epi32(_mm256_loadu_si256(row + 1), acc[i][1]));
+    }
+}
+
+/* 12行32列 */
+__attribute__((target("avx512f")))
+static void kernel_int32_avx512(size_t kc, const void* ap, const void* bp, void* cp, size_t ldc) {
+    const int32_t* a = (const int32_t*)ap;
+    const int32_t* b = (const int32_t*)bp;
+    int32_t* c = (int32_t*)cp;
+    __m512i acc[12][2];
+#pragma GCC unroll 12
+    for (int i = 0; i < 12; i++) {
+        acc[i][0] = _mm512_setzero_si512();
+        acc[i][1] = _mm512_setzero_si512();
+        _mm_prefetch((const char*)(c + (size_t)i * ldc), _MM_HINT_T0);
+        _mm_prefetch((const char*)(c + (size_t)i * ldc + 16), _MM_HINT_T0);
+    }
+    for (size_t p = 0; p < kc; p++) {
+        __m512i b0 = _mm512_load_si512(b);
+        __m512i b1 = _mm512_load_si512(b + 16);
+#pragma GCC unroll 12
+        for (int i = 0; i < 12; i++) {
+            __m512i ai = _mm512_set1_epi32(a[i]);
+            acc[i][0] = _mm512_add_epi32(acc[i][0], _mm512_mullo_epi32(ai, b0));
+            acc[i][1] = _mm512_add_epi32(acc[i][1], _mm512_mullo_epi32(ai, b1));
+        }
+        a += 12;
+        b += 32;
+    }
+#pragma GCC unroll 12
+    for (int i = 0; i < 12; i++) {
+        int32_t* row = c + (size_t)i * ldc;
+        _mm512_storeu_si512(row, _mm512_add_epi32(_mm512_loadu_si512(row), acc[i][0]));
+        _mm512_storeu_si512(row + 16, _mm512_add_epi32(_mm512_loadu_si512(row + 16), acc[i][1]));
+    }
+}
+
+/* 12行16列，64位乘法需要AVX-512DQ的vpmullq */
+__attribute__((target("avx512f,avx512dq")))
+static void kernel_int64_avx512(size_t kc, const void* ap, const void* bp, void* cp, size_t ldc) {
+    const int64_t* a = (const int64_t*)ap;
+    const int64_t* b = (const int64_t*)bp;
+    int64_t* c = (int64_t*)cp;
+    __m512i acc[12][2];
+#pragma GCC unroll 12
+    for (int i = 0; i < 12; i++) {
+        acc[i][0] = _mm512_setzero_si512();
+        acc[i][1] = _mm512_setzero_si512();
+        _mm_prefetch((const char*)(c + (size_t)i * ldc), _MM_HINT_T0);
+        _mm_prefetch((const char*)(c + (size_t)i * ldc + 8), _MM_HINT_T0);
+    }
+    for (size_t p = 0; p < kc; p++) {
+        __m512i b0 = _mm512_load_si512(b);
+        __m512i b1 = _mm512_load_si512(b + 8);
+#pragma GCC unroll 12
+        for (int i = 0; i < 12; i++) {
+            __m512i ai = _mm512_set1_epi64(a[i]);
+            acc[i][0] = _mm512_add_epi64(acc[i][0], _mm512_mullo_epi64(ai, b0));
+            acc[i][1] = _mm512_add_epi64(acc[i][1], _mm512_mullo_epi64(ai, b1));
+        }
+        a += 12;
+        b += 16;
+    }
+#pragma GCC unroll 12
+    for (int i = 0; i < 12; i++) {
+        int64_t* row = c + (size_t)i * ldc;
+        _mm512_storeu_si512(row, _mm512_add_epi64(_mm512_loadu_si512(row), acc[i][0]));
+        _mm512_storeu_si512(row + 8, _mm512_add_epi64(_mm512_loadu_si512(row + 8), acc[i][1]));
+    }
+}
+
+static pthread_once_t config_once = PTHREAD_ONCE_INIT;
+static gemm_config configs[3];
+
+static void init_configs(void) {
+    __builtin_cpu_init();
+    int has_avx512 = __builtin_cpu_supports("avx512f");
+    int has_avx512dq = has_avx512 && __builtin_cpu_supports("avx512dq");
+    int has_avx2 = __builtin_cpu_supports("avx2");
+    int has_fma = __builtin_cpu_supports("fma");
+    static const gemm_config double_avx512 = {kernel_double_avx512, 12, 16, 256, 96, 2048, "avx512 12x16"};
+    static const gemm_config double_avx2 = {kernel_double_avx2, 6, 8, 256, 96, 1024, "avx2/fma 6x8"};
+    static const gemm_config int32_avx512 = {kernel_int32_avx512, 12, 32, 256, 96, 2048, "avx512 12x32"};
+    static const gemm_config int32_avx2 = {kernel_int32_avx2, 6, 16, 256, 96, 1024, "avx2 6x16"};
+    static const gemm_config int64_avx512 = {kernel_int64_avx512, 12, 16, 256, 96, 2048, "avx512dq 12x16"};
+    static const gemm_config double_generic = {kernel_double_generic, 4, 4, 256, 64, 512, "scalar 4x4"};
+    static const gemm_config int32_generic = {kernel_int32_generic, 4, 4, 256, 64, 512, "scalar 4x4"};
+    static const gemm_config int64_generic = {kernel_int64_generic, 4, 4, 256, 64, 512, "scalar 4x4"};
+    configs[MATRIX_DOUBLE] = has_avx512 ? double_avx512 : has_avx2 && has_fma ? double_avx2 : double_generic;
+    configs[MATRIX_INT32] = has_avx512 ? int32_avx512 : has_avx2 ? int32_avx2 : int32_generic;
+    configs[MATRIX_INT64] = has_avx512dq ? int64_avx512 : int64_generic;
+}
+
+static inline const gemm_config* config_of(matrix_type type) {
+    pthread_once(&config_once, init_configs);
+    return &configs[type];
+}
+
+/* ---------- 打包缓冲区 ---------- */
+
+/* 打包缓冲区的用途：A块由各任务自己打包，B块在串行计算时由本线程打包 */
+enum {
+    PACK_A,
+    PACK_B,
+    PACK_SLOTS
+};
+
+/* 每个线程每种用途一块打包缓冲区，按需增长，线程退出时释放 */
+typedef struct {
+    void* data[PACK_SLOTS];
+    size_t capacity[PACK_SLOTS];
+} pack_buffer;
+
+static pthread_key_t pack_key;
+static pthread_once_t pack_once = PTHREAD_ONCE_INIT;
+static __thread pack_buffer* thread_pack = NULL;
+
+static void release_pack(void* arg) {
+    pack_buffer* pack = (pack_buffer*)arg;
+    for (int slot = 0; slot < PACK_SLOTS; slot++) {
+        free(pack->data[slot]);
+    }
+    free(pack);
+    thread_pack = NULL;
+}
+
+static void create_pack_key(void) {
+    pthread_key_create(&pack_key, release_pack);
+}
+
+/* 返回本线程某种用途至少size字节的对齐缓冲区，失败返回NULL */
+static void* pack_space(int slot, size_t size) {
+    if (thread_pack == NULL) {
+        pthread_once(&pack_once, create_pack_key);
+        thread_pack = (pack_buffer*)calloc(1, sizeof(pack_buffer));
+        if (thread_pack == NULL) {
+            return NULL;
+        }
+        pthread_setspecific(pack_key, thread_pack);
+    }
+    if (thread_pack->capacity[slot] < size) {
+        void* data = matrix_aligned_alloc(size);
+        if (data == NULL) {
+            return NULL;
+        }
+        free(thread_pack->data[slot]);
+        thread_pack->data[slot] = data;
+        thread_pack->capacity[slot] = size;
+    }
+    return thread_pack->data[slot];
+}
+
+/*
+ * A块（mc行kc列）按mr行一条打包：条带内按列存放，每列mr个元素，不足mr行补0；
+ * B块（kc行nc列）按nr列一条打包：条带内按行存放，每行nr个元素，不足nr列补0
+ */
+#define DEFINE_PACK(suffix, T)                                                                          \
+    static void pack_a_##suffix(const T* a, size_t lda, size_t mc, size_t kc, int mr, T* out) {        \
+        for (size_t ir = 0; ir < mc; ir += (size_t)mr) {                                               \
+            size_t rows = mc - ir < (size_t)mr ? mc - ir : (size_t)mr;                                 \
+            for (size_t p = 0; p < kc; p++) {                                                          \
+                size_t i = 0;                                                                          \
+                for (; i < rows; i++) {                                                                \
+                    out[i] = a[(ir + i) * lda + p];                                                    \
+                }                                                                                      \
+                for (; i < (size_t)mr; i++) {                                                          \
+                    out[i] = 0;                                                                        \
+                }                                                                                      \
+                out += mr;                                                                             \
+            }                                                                                          \
+        }                                                                                              \
+    }                                                                                                  \
+    static void pack_b_##suffix(const T* b, size_t ldb, size_t kc, size_t nc, int nr, T* out) {        \
+        for (size_t jr = 0; jr < nc; jr += (size_t)nr) {                                               \
+            size_t cols = nc - jr < (size_t)nr ? nc - jr : (size_t)nr;                                 \
+            for (size_t p = 0; p < kc; p++) {                                                          \
+                memcpy(out, b + p * ldb + jr, cols * sizeof(T));                                       \
+                memset(out + cols, 0, ((size_t)nr - cols) * sizeof(T));                                \
+                out += nr;                                                                             \
+            }                                                                                          \
+        }                                                                                              \
+    }
+
+DEFINE_PACK(32, uint32_t)
+DEFINE_PACK(64, uint64_t)
+
+/* ---------- 分块乘法 ---------- */
+
+typedef struct {
+    const gemm_config* config;
+    matrix_type type;
+    size_t elem;             /* 元素字节数 */
+    size_t m;
+    size_t n;
+    size_t k;
+    const char* a;
+    size_t lda;
+    const char* b;
+    size_t ldb;
+    char* c;
+    size_t ldc;
+    size_t jc;               /* 当前B块的起始列 */
+    size_t pc;               /* 当前B块的起始行 */
+    size_t nc;               /* 当前B块的列数 */
+    size_t kc;               /* 当前B块的行数 */
+    char* packed_b;
+    size_t tile_n;           /* 每个任务计算的列数，为nr的倍数 */
+    long tiles_m;            /* 行方向的任务数 */
+    atomic_int failed;       /* 打包缓冲区分配失败 */
+} gemm_job;
+
+static size_t element_size(matrix_type type) {
+    return type == MATRIX_INT32 ? sizeof(int32_t) : sizeof(int64_t);
+}
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+/* 把临时缓冲区中rows行cols列的结果加到C上 */
+static void add_block(matrix_type type, void* c, size_t ldc, const void* block, size_t ldb, int rows, int cols) {
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            size_t ci = (size_t)i * ldc + (size_t)j;
+            size_t bi = (size_t)i * ldb + (size_t)j;
+            if (type == MATRIX_DOUBLE) {
+                ((double*)c)[ci] += ((const double*)block)[bi];
+            } else if (type == MATRIX_INT32) {
+                ((uint32_t*)c)[ci] += ((const uint32_t*)block)[bi];
+            } else {
+                ((uint64_t*)c)[ci] += ((const uint64_t*)block)[bi];
+            }
+        }
+    }
+}
+
+/* 打包当前B块的第[begin, end)条 */
+static void pack_b_range(long begin, long end, void* ctx) {
+    gemm_job* job = (gemm_job*)ctx;
+    size_t nr = (size_t)job->config->nr;
+    size_t jr = (size_t)begin * nr;
+    size_t cols = (size_t)end * nr < job->nc ? (size_t)end * nr - jr : job->nc - jr;
+    const char* b = job->b + (job->pc * job->ldb + job->jc + jr) * job->elem;
+    char* out = job->packed_b + jr * job->kc * job->elem;
+    if (job->elem == 4) {
+        pack_b_32((const uint32_t*)b, job->ldb, job->kc, cols, (int)nr, (uint32_t*)out);
+    } else {
+        pack_b_64((const uint64_t*)b, job->ldb, job->kc, cols, (int)nr, (uint64_t*)out);
+    }
+}
+
+/* 打包A从第ic行起的mc行，再与当前B块的[jr_begin, jr_end)列相乘；B条带在内层的A条带循环中一直留在L1 */
+static void gemm_block(const gemm_job* job, size_t ic, size_t mc, size_t jr_begin, size_t jr_end, char* packed_a) {
+    const gemm_config* cfg = job->config;
+    size_t kc = job->kc;
+    const char* a = job->a + (ic * job->lda + job->pc) * job->elem;
+    if (job->elem == 4) {
+        pack_a_32((const uint32_t*)a, job->lda, mc, kc, cfg->mr, (uint32_t*)packed_a);
+    } else {
+        pack_a_64((const uint64_t*)a, job->lda, mc, kc, cfg->mr, (uint64_t*)packed_a);
+    }
+    _Alignas(MATRIX_ALIGNMENT) char edge[MAX_MR * MAX_NR * sizeof(int64_t)];
+    for (size_t jr = jr_begin; jr < jr_end; jr += (size_t)cfg->nr) {
+        int cols = jr_end - jr < (size_t)cfg->nr ? (int)(jr_end - jr) : cfg->nr;
+        const char* bp = job->packed_b + jr * kc * job->elem;
+        for (size_t ir = 0; ir < mc; ir += (size_t)cfg->mr) {
+            int rows = mc - ir < (size_t)cfg->mr ? (int)(mc - ir) : cfg->mr;
+            const char* ap = packed_a + ir * kc * job->elem;
+            char* cp = job->c + ((ic + ir) * job->ldc + job->jc + jr) * job->elem;
+            if (rows == cfg->mr && cols == cfg->nr) {
+                cfg->kernel(kc, ap, bp, cp, job->ldc);
+            } else {
+                memset(edge, 0, (size_t)cfg->mr * (size_t)cfg->nr * job->elem);
+                cfg->kernel(kc, ap, bp, edge, (size_t)cfg->nr);
+                add_block(job->type, cp, job->ldc, edge, (size_t)cfg->nr, rows, cols);
+            }
+        }
+    }
+}
+
+/* 第t个任务计算第t % tiles_m个A块与当前B块第t / tiles_m段列的乘积 */
+static void gemm_range(long begin, long end, void* ctx) {
+    gemm_job* job = (gemm_job*)ctx;
+    const gemm_config* cfg = job->config;
+    char* packed_a = (char*)pack_space(PACK_A, cfg->mc * job->kc * job->elem);
+    if (packed_a == NULL) {
+        atomic_store(&job->failed, 1);
+        return;
+    }
+    for (long t = begin; t < end; t++) {
+        size_t ic = (size_t)(t % job->tiles_m) * cfg->mc;
+        size_t jr = (size_t)(t / job->tiles_m) * job->tile_n;
+        size_t mc = job->m - ic < cfg->mc ? job->m - ic : cfg->mc;
+        size_t jr_end = job->nc - jr < job->tile_n ? job->nc : jr + job->tile_n;
+        gemm_block(job, ic, mc, jr, jr_end, packed_a);
+    }
+}
+
+/* 三重循环，整数按无符号类型运算以回绕 */
+#define SMALL_GEMM(T)                                                                   \
+    do {                                                                                \
+        const T* a = (const T*)job->a;                                                  \
+        const T* b = (const T*)job->b;                                                  \
+        T* c = (T*)job->c;                                                              \
+        for (size_t i = 0; i < job->m; i++) {                                           \
+            for (size_t p = 0; p < job->k; p++) {                                       \
+                T value = a[i * job->lda + p];                                          \
+                for (size_t j = 0; j < job->n; j++) {                                   \
+                    c[i * job->ldc + j] += value * b[p * job->ldb + j];                 \
+                }                                                                       \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
+
+static void gemm_small(const gemm_job* job) {
+    if (job->type == MATRIX_DOUBLE) {
+        SMALL_GEMM(double);
+    } else if (job->type == MATRIX_INT32) {
+        SMALL_GEMM(uint32_t);
+    } else {
+        SMALL_GEMM(uint64_t);
+    }
+}
+
+/*
+ * c += a * b，调用前已检查类型与形状。B按kc行nc列分块，每块只打包一次（并行时各线程分条打包），
+ * 再按A的mc行分块（列数较多时再按列分段）分给各线程
+ */
+static error_code gemm(matrix* c, const matrix* a, const matrix* b) {
+    size_t m = a->rows;
+    size_t k = a->cols;
+    size_t n = b->cols;
+    if (m == 0 || n == 0 || k == 0) {
+        return ERR_OK;
+    }
+    gemm_job job;
+    memset(&job, 0, sizeof(job));
+    job.config = config_of(a->type);
+    job.type = a->type;
+    job.elem = element_size(a->type);
+    job.m = m;
+    job.n = n;
+    job.k = k;
+    job.a = (const char*)a->data;
+    job.lda = a->stride;
+    job.b = (const char*)b->data;
+    job.ldb = b->stride;
+    job.c = (char*)c->data;
+    job.ldc = c->stride;
+    atomic_init(&job.failed, 0);
+
+    double work = (double)m * (double)n * (double)k;
+    if (work <= SMALL_GEMM_WORK) {
+        gemm_small(&job);
+        return ERR_OK;
+    }
+    const gemm_config* cfg = job.config;
+    size_t nr = (size_t)cfg->nr;
+    size_t panel_n = n < cfg->nc ? round_up(n, nr) : cfg->nc;
+    size_t panel_k = k < cfg->kc ? k : cfg->kc;
+    job.tiles_m = (long)((m + cfg->mc - 1) / cfg->mc);
+    int threads = work >= PARALLEL_GEMM_WORK ? thread_pool_size(NULL) : 1;
+    // 并行时本线程在等待中可能执行其他乘法任务，B块不能用线程缓存的缓冲区
+    size_t b_bytes = panel_k * panel_n * job.elem;
+    job.packed_b = (char*)(threads > 1 ? matrix_aligned_alloc(b_bytes) : pack_space(PACK_B, b_bytes));
+    if (job.packed_b == NULL) {
+        return error_raise(ERR_MATRIX_ALLOC, "打包缓冲区分配失败");
+    }
+    // 行方向的块太少时把B块的列分段，使各线程都有任务
+    job.tile_n = panel_n;
+    while (job.tile_n > nr * 4 &&
+           job.tiles_m * (long)((panel_n + job.tile_n - 1) / job.tile_n) < (long)threads * TILES_PER_THREAD) {
+        job.tile_n = round_up(job.tile_n / 2, nr);
+    }
+
+    for (job.jc = 0; job.jc < n; job.jc += cfg->nc) {
+        job.nc = n - job.jc < cfg->nc ? n - job.jc : cfg->nc;
+        long slivers = (long)((job.nc + nr - 1) / nr);
+        long tiles = job.tiles_m * (long)((job.nc + job.tile_n - 1) / job.tile_n);
+        for (job.pc = 0; job.pc < k; job.pc += cfg->kc) {
+            job.kc = k - job.pc < cfg->kc ? k - job.pc : cfg->kc;
+            if (threads > 1) {
+                parallel_for(NULL, 0, slivers, 0, pack_b_range, &job);
+                parallel_for(NULL, 0, tiles, 1, gemm_range, &job);
+            } else {
+                pack_b_range(0, slivers, &job);
+                gemm_range(0, tiles, &job);
+            }
+        }
+    }
+    if (threads > 1) {
+        free(job.packed_b);
+    }
+    if (atomic_load(&job.failed)) {
+        return error_raise(ERR_MATRIX_ALLOC, "打包缓冲区分配失败");
+    }
+    return ERR_OK;
+}
+
+/* ---------- 矩阵 ---------- */
+
+void* matrix_aligned_alloc(size_t size) {
+    void* p = NULL;
+    if (size == 0 || posix_memalign(&p, MATRIX_ALIGNMENT, size) != 0) {
+        return NULL;
+    }
+    return p;
+}
+
+void matrix_init(matrix* m) {
+    if (m != NULL) {
+        memset(m, 0, sizeof(*m));
+        m->type = MATRIX_DOUBLE;
+    }
+}
+
+void matrix_free(matrix* m) {
+    if (m != NULL) {
+        free(m->data);
+        matrix_init(m);
+    }
+}
+
+static int valid_type(matrix_type type) {
+    return type == MATRIX_INT32 || type == MATRIX_INT64 || type == MATRIX_DOUBLE;
+}
+
+/* 分配到局部变量，不改动调用者的矩阵 */
+static error_code allocate(matrix* m, matrix_type type, size_t rows, size_t cols) {
+    size_t elem = element_size(type);
+    size_t per_line = MATRIX_ALIGNMENT / elem;
+    matrix_init(m);
+    m->type = type;
+    m->rows = rows;
+    m->cols = cols;
+    if (rows == 0 || cols == 0) {
+        return ERR_OK;
+    }
+    if (cols > SIZE_MAX / elem - per_line) {
+        return error_raise(ERR_MATRIX_ALLOC, "矩阵过大");
+    }
+    m->stride = round_up(cols, per_line);
+    size_t bytes;
+    if (__builtin_mul_overflow(m->stride * elem, rows, &bytes)) {
+        return error_raise(ERR_MATRIX_ALLOC, "矩阵过大");
+    }
+    m->data = matrix_aligned_alloc(bytes);
+    if (m->data == NULL) {
+        return error_raise(ERR_MATRIX_ALLOC, "内存分配失败");
+    }
+    memset(m->data, 0, bytes);
+    return ERR_OK;
+}
+
+/* 用tmp替换m原有的内容 */
+static void replace(matrix* m, matrix* tmp) {
+    free(m->data);
+    *m = *tmp;
+}
+
+error_code matrix_create(matrix* m, matrix_type type, size_t rows, size_t cols) {
+    if (m == NULL) {
+        return error_raise(ERR_MATRIX_NULL, "矩阵为NULL");
+    }
+    if (!valid_type(type)) {
+        return error_raise(ERR_MATRIX_TYPE, "元素类型无效");
+    }
+    matrix tmp;
+    error_code code = allocate(&tmp, type, rows, cols);
+    if (code == ERR_OK) {
+        replace(m, &tmp);
+    }
+    return code;
+}
+
+static void set_identity(matrix* m) {
+    for (size_t i = 0; i < m->rows; i++) {
+        if (m->type == MATRIX_DOUBLE) {
+            MATRIX_AT(m, double, i, i) = 1.0;
+        } else if (m->type == MATRIX_INT32) {
+            MATRIX_AT(m, int32_t, i, i) = 1;
+        } else {
+            MATRIX_AT(m, int64_t, i, i) = 1;
+        }
+    }
+}
+
+error_code matrix_identity(matrix* m, matrix_type type, size_t n) {
+    error_code code = matrix_create(m, type, n, n);
+    if (code == ERR_OK) {
+        set_identity(m);
+    }
+    return code;
+}
+
+error_code matrix_copy(matrix* dst, const matrix* src) {
+    if (dst == NULL || src == NULL) {
+        return error_raise(ERR_MATRIX_NULL, "矩阵为NULL");
+    }
+    if (dst == src) {
+        return ERR_OK;
+    }
+    matrix tmp;
+    error_code code = allocate(&tmp, src->type, src->rows, src->cols);
+    if (code != ERR_OK) {
+        return code;
+    }
+    if (tmp.data != NULL) {
+        memcpy(tmp.data, src->data, src->rows * src->stride * element_size(src->type));
+    }
+    replace(dst, &tmp);
+    return ERR_OK;
+}
+
+static error_code check_operands(const matrix* c, const matrix* a, const matrix* b) {
+    if (c == NULL || a == NULL || b == NULL) {
+        return error_raise(ERR_MATRIX_NULL, "矩阵为NULL");
+    }
+    if (!valid_type(a->type) || a->type != b->type) {
+        return error_raise(ERR_MATRIX_TYPE, "两个矩阵的元素类型不同");
+    }
+    if (a->cols != b->rows) {
+        return error_raise(ERR_MATRIX_SHAPE, "左矩阵的列数与右矩阵的行数不同");
+    }
+    return ERR_OK;
+}
+
+/* c = a * b，不输出调试信息，供矩阵幂反复调用 */
+static error_code multiply(matrix* c, const matrix* a, const matrix* b) {
+    matrix tmp;
+    error_code code = allocate(&tmp, a->type, a->rows, b->cols);
+    if (code == ERR_OK) {
+        code = gemm(&tmp, a, b);
+    }
+    if (code != ERR_OK) {
+        free(tmp.data);
+        return code;
+    }
+    replace(c, &tmp);
+    return ERR_OK;
+}
+
+error_code matrix_multiply(matrix* c, const matrix* a, const matrix* b) {
+    debug_print("矩阵乘法");
+    error_code code = check_operands(c, a, b);
+    return code != ERR_OK ? code : multiply(c, a, b);
+}
+
+error_code matrix_multiply_add(matrix* c, const matrix* a, const matrix* b) {
+    debug_print("矩阵乘加");
+    error_code code = check_operands(c, a, b);
+    if (code != ERR_OK) {
+        return code;
+    }
+    if (c->type != a->type) {
+        return error_raise(ERR_MATRIX_TYPE, "累加矩阵的元素类型不同");
+    }
+    if (c->rows != a->rows || c->cols != b->cols) {
+        return error_raise(ERR_MATRIX_SHAPE, "累加矩阵的形状与乘积不同");
+    }
+    if (c == a || c == b) {
+        return error_raise(ERR_MATRIX_ALIAS, "累加矩阵与乘数是同一个矩阵");
+    }
+    return gemm(c, a, b);
+}
+
+error_code matrix_power(matrix* r, const matrix* a, uint64_t n) {
+    debug_print("计算矩阵幂");
+    if (r == NULL || a == NULL) {
+        return error_raise(ERR_MATRIX_NULL, "矩阵为NULL");
+    }
+    if (!valid_type(a->type)) {
+        return error_raise(ERR_MATRIX_TYPE, "元素类型无效");
+    }
+    if (a->rows != a->cols) {
+        return error_raise(ERR_MATRIX_SHAPE, "不是方阵");
+    }
+    matrix result;
+    matrix base;
+    matrix_init(&result);
+    matrix_init(&base);
+    error_code code = n == 0 ? matrix_identity(&result, a->type, a->rows) : matrix_copy(&base, a);
+    // 从低位起：base依次为a^(2^i)，第一个为1的位直接复制base，省去与单位矩阵相乘
+    int have_result = 0;
+    while (code == ERR_OK && n > 0) {
+        if (n & 1) {
+            code = have_result ? multiply(&result, &result, &base) : matrix_copy(&result, &base);
+            have_result = 1;
+        }
+        n >>= 1;
+        if (code == ERR_OK && n > 0) {
+            code = multiply(&base, &base, &base);
+        }
+    }
+    matrix_free(&base);
+    if (code != ERR_OK) {
+        matrix_free(&result);
+        return code;
+    }
+    replace(r, &result);
+    return ERR_OK;
+}
+
+error_code matrix_fibonacci(uint64_t n, uint64_t* result) {
+    debug_print("以矩阵幂计算斐波那契数");
+    if (result == NULL) {
+        return error_raise(ERR_MATRIX_NULL, "输出参数为NULL");
+    }
+    matrix q;
+    matrix_init(&q);
+    error_code code = matrix_create(&q, MATRIX_INT64, 2, 2);
+    if (code != ERR_OK) {
+        return code;
+    }
+    MATRIX_AT(&q, int64_t, 0, 0) = 1;
+    MATRIX_AT(&q, int64_t, 0, 1) = 1;
+    MATRIX_AT(&q, int64_t, 1, 0) = 1;
+    // [[1, 1], [1, 0]]^n = [[F(n+1), F(n)], [F(n), F(n-1)]]
+    code = matrix_power(&q, &q, n);
+    if (code == ERR_OK) {
+        *result = (uint64_t)MATRIX_AT(&q, int64_t, 0, 1);
+    }
+    matrix_free(&q);
+    return code;
+}
+
+const char* matrix_kernel_name(matrix_type type) {
+    return valid_type(type) ? config_of(type)->name : "unknown";
+}
+
+static int module_init(void) {
+    pthread_once(&config_once, init_configs);
+    debug_print(configs[MATRIX_DOUBLE].kernel == kernel_double_avx512 ? "矩阵乘法使用AVX-512微内核"
+                : configs[MATRIX_DOUBLE].kernel == kernel_double_avx2 ? "矩阵乘法使用AVX2/FMA微内核"
+                                                                     : "矩阵乘法使用标量微内核");
+    debug_print("矩阵模块初始化成功");
+    return 1;
+}
+
+int initialize_matrix_ops() {
+    return module_init_once(MODULE_MATRIX, module_init);
+}
\ No newline at end of file
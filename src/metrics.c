@@ -0,0 +1,460 @@
+/**
+ * @file metrics.c
+ * @brief 运行时指标实现：每个线程写自己的分片，读取时合并
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/metrics.h"
+#include "../include/module.h"
+#include "../include/utils.h"
+#include "../include/allocator.h"
+
+/* 错误代码按 模块(code/1000) * 64 + 序号(code%1000) 映射到计数槽，无法映射的计入槽0 */
+#define ERROR_MODULES 20
+#define ERROR_CODES_PER_MODULE 64
+#define ERROR_SLOTS (ERROR_MODULES * ERROR_CODES_PER_MODULE)
+
+/* HDR风格的对数-线性直方图：每个2的幂区间再分为16个子桶，相对误差约6%，最大约18分钟 */
+#define HIST_SUB_BITS 4
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_MAX_EXPONENT 40
+#define HIST_BUCKETS ((HIST_MAX_EXPONENT - HIST_SUB_BITS + 2) * HIST_SUB_COUNT)
+
+typedef struct {
+    atomic_ullong count;
+    atomic_ullong sum_ns;
+    atomic_ullong max_ns;
+    atomic_ullong buckets[HIST_BUCKETS];
+} latency_histogram;
+
+/* 每个线程独占一个分片，只有所有者线程写入，因此更新不需要加锁前缀的原子指令 */
+typedef struct metrics_shard {
+    struct metrics_shard* next;
+    atomic_int in_use;
+    atomic_ullong calls[METRIC_FUNCTION_COUNT];
+    atomic_ullong errors[ERROR_SLOTS];
+    latency_histogram latency[METRIC_FILE_OP_COUNT];
+} metrics_shard;
+
+static _Atomic(metrics_shard*) shards = NULL;
+static pthread_mutex_t shards_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t shard_key;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static __thread metrics_shard* thread_shard = NULL;
+static atomic_int metrics_enabled = 1;
+
+static const char* function_names[METRIC_FUNCTION_COUNT] = {
+    "add", "subtract", "multiply", "divide", "factorial", "fibonacci", "gcd", "average", "find_primes",
+    "count_primes", "factorize_u64",
+    "string_duplicate", "string_concatenate", "string_to_upper", "string_to_lower", "string_reverse",
+    "string_find", "string_replace", "string_split", "string_transform_batch", "string_encode", "string_decode",
+    "read_file", "write_file", "append_file", "file_exists", "get_file_size", "copy_file", "move_file",
+    "delete_file"
+};
+
+/* ---------- 分片管理 ---------- */
+
+static void release_shard(void* shard) {
+    // 线程退出后分片保留计数，交给之后创建的线程继续使用
+    atomic_store_explicit(&((metrics_shard*)shard)->in_use, 0, memory_order_release);
+}
+
+static void create_shard_key(void) {
+    pthread_key_create(&shard_key, release_shard);
+}
+
+static metrics_shard* acquire_shard(void) {
+    pthread_once(&key_once, create_shard_key);
+
+    metrics_shard* shard = NULL;
+    for (metrics_shard* s = atomic_load(&shards); s != NULL; s = s->next) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong_explicit(&s->in_use, &expected, 1, memory_order_acquire,
+                                                    memory_order_relaxed)) {
+            shard = s;
+            break;
+        }
+    }
+    if (shard == NULL) {
+        shard = (metrics_shard*)calloc(1, sizeof(metrics_shard));
+        if (shard == NULL) {
+            return NULL;
+        }
+        atomic_init(&shard->in_use, 1);
+        pthread_mutex_lock(&shards_lock);
+        shard->next = atomic_load(&shards);
+        atomic_store(&shards, shard);
+        pthread_mutex_unlock(&shards_lock);
+    }
+    pthread_setspecific(shard_key, shard);
+    thread_shard = shard;
+    return shard;
+}
+
+static inline metrics_shard* current_shard(void) {
+    if (!atomic_load_explicit(&metrics_enabled, memory_order_relaxed)) {
+        return NULL;
+    }
+    return thread_shard != NULL ? thread_shard : acquire_shard();
+}
+
+/* 单写者计数器：读-改-写不需要原子加法，读取方用原子读取不会看到撕裂的值 */
+static inline void shard_add(atomic_ullong* counter, unsigned long long value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+/* ---------- 直方图 ---------- */
+
+static int histogram_index(uint64_t value) {
+    if (value < HIST_SUB_COUNT) {
+        return (int)value;
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent > HIST_MAX_EXPONENT) {
+        return HIST_BUCKETS - 1;
+    }
+    int sub = (int)((value >> (exponent - HIST_SUB_BITS)) & (HIST_SUB_COUNT - 1));
+    return (exponent - HIST_SUB_BITS + 1) * HIST_SUB_COUNT + sub;
+}
+
+static uint64_t histogram_lower_bound(int index) {
+    if (index < HIST_SUB_COUNT) {
+        return (uint64_t)index;
+    }
+    int exponent = index / HIST_SUB_COUNT + HIST_SUB_BITS - 1;
+    uint64_t sub = (uint64_t)(index % HIST_SUB_COUNT);
+    return (HIST_SUB_COUNT + sub) << (exponent - HIST_SUB_BITS);
+}
+
+static uint64_t histogram_upper_bound(int index) {
+    return index + 1 < HIST_BUCKETS ? histogram_lower_bound(index + 1) - 1 : UINT64_MAX;
+}
+
+/* ---------- 记录 ---------- */
+
+void metrics_count_call(metric_function function) {
+    metrics_shard* shard = current_shard();
+    if (shard != NULL && (unsigned)function < METRIC_FUNCTION_COUNT) {
+        shard_add(&shard->calls[function], 1);
+    }
+}
+
+static int error_slot(int code) {
+    int module = code / 1000;
+    int offset = code % 1000;
+    if (code <= 0 || module >= ERROR_MODULES || offset >= ERROR_CODES_PER_MODULE) {
+        return 0;
+    }
+    return module * ERROR_CODES_PER_MODULE + offset;
+}
+
+void metrics_count_error(int code) {
+    metrics_shard* shard = current_shard();
+    if (shard != NULL) {
+        shard_add(&shard->errors[error_slot(code)], 1);
+    }
+}
+
+uint64_t metrics_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void metrics_record_latency(metric_function function, uint64_t start_ns) {
+    metrics_shard* shard = current_shard();
+    if (shard == NULL || function < METRIC_FIRST_FILE_OP || function >= METRIC_FUNCTION_COUNT) {
+        return;
+    }
+    uint64_t now = metrics_now_ns();
+    uint64_t elapsed = now > start_ns ? now - start_ns : 0;
+    latency_histogram* hist = &shard->latency[function - METRIC_FIRST_FILE_OP];
+    shard_add(&shard->calls[function], 1);
+    shard_add(&hist->count, 1);
+    shard_add(&hist->sum_ns, elapsed);
+    shard_add(&hist->buckets[histogram_index(elapsed)], 1);
+    if (elapsed > atomic_load_explicit(&hist->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&hist->max_ns, elapsed, memory_order_relaxed);
+    }
+}
+
+void metrics_set_enabled(int enabled) {
+    atomic_store(&metrics_enabled, enabled ? 1 : 0);
+}
+
+/* ---------- 读取（合并所有分片） ---------- */
+
+unsigned long long metrics_get_calls(metric_function function) {
+    if ((unsigned)function >= METRIC_FUNCTION_COUNT) {
+        return 0;
+    }
+    unsigned long long total = 0;
+    for (metrics_shard* s = atomic_load(&shards); s != NULL; s = s->next) {
+        total += atomic_load_explicit(&s->calls[function], memory_order_relaxed);
+    }
+    return total;
+}
+
+unsigned long long metrics_get_errors(int code) {
+    int slot = error_slot(code);
+    unsigned long long total = 0;
+    for (metrics_shard* s = atomic_load(&shards); s != NULL; s = s->next) {
+        total += atomic_load_explicit(&s->errors[slot], memory_order_relaxed);
+    }
+    return total;
+}
+
+typedef struct {
+    unsigned long long count;
+    unsigned long long sum_ns;
+    unsigned long long max_ns;
+    unsigned long long buckets[HIST_BUCKETS];
+} merged_histogram;
+
+static void merge_histogram(metric_function function, merged_histogram* merged) {
+    memset(merged, 0, sizeof(*merged));
+    int index = function - METRIC_FIRST_FILE_OP;
+    for (metrics_shard* s = atomic_load(&shards); s != NULL; s = s->next) {
+        latency_histogram* hist = &s->latency[index];
+        merged->count += atomic_load_explicit(&hist->count, memory_order_relaxed);
+        merged->sum_ns += atomic_load_explicit(&hist->sum_ns, memory_order_relaxed);
+        unsigned long long max = atomic_load_explicit(&hist->max_ns, memory_order_relaxed);
+        if (max > merged->max_ns) {
+            merged->max_ns = max;
+        }
+        for (int i = 0; i < HIST_BUCKETS; i++) {
+            merged->buckets[i] += atomic_load_explicit(&hist->buckets[i], memory_order_relaxed);
+        }
+    }
+}
+
+static uint64_t merged_quantile(const merged_histogram* merged, double quantile) {
+    // 按桶内计数求和，不依赖count，避免并发更新时两者短暂不一致
+    unsigned long long total = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        total += merged->buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    if (quantile < 0.0) {
+        quantile = 0.0;
+    } else if (quantile > 1.0) {
+        quantile = 1.0;
+    }
+    unsigned long long rank = (unsigned long long)(quantile * total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    unsigned long long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += merged->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = histogram_upper_bound(i);
+            return upper < merged->max_ns ? upper : merged->max_ns;
+        }
+    }
+    return merged->max_ns;
+}
+
+uint64_t metrics_latency_quantile(metric_function function, double quantile) {
+    if (function < METRIC_FIRST_FILE_OP || function >= METRIC_FUNCTION_COUNT) {
+        return 0;
+    }
+    merged_histogram* merged = (merged_histogram*)malloc(sizeof(merged_histogram));
+    if (merged == NULL) {
+        error_log(ERR_METRICS_ALLOC, "内存分配失败");
+        return 0;
+    }
+    merge_histogram(function, merged);
+    uint64_t result = merged_quantile(merged, quantile);
+    free(merged);
+    return result;
+}
+
+const char* metrics_function_name(metric_function function) {
+    return (unsigned)function < METRIC_FUNCTION_COUNT ? function_names[function] : "unknown";
+}
+
+/* ---------- Prometheus导出 ---------- */
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t capacity;
+    int failed;
+} text_buffer;
+
+static void buffer_printf(text_buffer* buf, const char* format, ...) {
+    if (buf->failed) {
+        return;
+    }
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf->data + buf->len, buf->capacity - buf->len, format, args);
+        va_end(args);
+        if (n < 0) {
+            buf->failed = 1;
+            return;
+        }
+        if (buf->len + (size_t)n < buf->capacity) {
+            buf->len += (size_t)n;
+            return;
+        }
+        size_t capacity = buf->capacity * 2 + (size_t)n;
+        char* data = (char*)mem_realloc(buf->data, capacity);
+        if (data == NULL) {
+            buf->failed = 1;
+            return;
+        }
+        buf->data = data;
+        buf->capacity = capacity;
+    }
+}
+
+static const char* function_module(metric_function function) {
+    if (function < METRIC_STRING_DUPLICATE) {
+        return "math";
+    }
+    return function < METRIC_FIRST_FILE_OP ? "string" : "file";
+}
+
+/* 导出的直方图边界（秒），由HDR桶按上界合并而来 */
+static const double export_bounds[] = {
+    1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3,
+    1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+static void dump_histogram(text_buffer* buf, metric_function function, merged_histogram* merged) {
+    const char* name = function_names[function];
+    merge_histogram(function, merged);
+
+    unsigned long long cumulative = 0;
+    int bucket = 0;
+    for (size_t b = 0; b < sizeof(export_bounds) / sizeof(export_bounds[0]); b++) {
+        double bound_ns = export_bounds[b] * 1e9;
+        while (bucket < HIST_BUCKETS && (double)histogram_upper_bound(bucket) <= bound_ns) {
+            cumulative += merged->buckets[bucket++];
+        }
+        buffer_printf(buf, "hello_file_op_latency_seconds_bucket{function=\"%s\",le=\"%g\"} %llu\n",
+                      name, export_bounds[b], cumulative);
+    }
+    unsigned long long total = cumulative;
+    while (bucket < HIST_BUCKETS) {
+        total += merged->buckets[bucket++];
+    }
+    buffer_printf(buf, "hello_file_op_latency_seconds_bucket{function=\"%s\",le=\"+Inf\"} %llu\n", name, total);
+    buffer_printf(buf, "hello_file_op_latency_seconds_sum{function=\"%s\"} %.9f\n", name, merged->sum_ns / 1e9);
+    buffer_printf(buf, "hello_file_op_latency_seconds_count{function=\"%s\"} %llu\n", name, total);
+}
+
+char* metrics_dump_prometheus() {
+    text_buffer buf = {NULL, 0, 0, 0};
+    buf.capacity = 16384;
+    buf.data = (char*)mem_alloc(buf.capacity);
+    merged_histogram* merged = (merged_histogram*)malloc(sizeof(merged_histogram));
+    if (buf.data == NULL || merged == NULL) {
+        mem_free(buf.data);
+        free(merged);
+        error_log(ERR_METRICS_ALLOC, "内存分配失败");
+        return NULL;
+    }
+    buf.data[0] = '\0';
+
+    buffer_printf(&buf, "# HELP hello_function_calls_total Number of calls to each public function.\n");
+    buffer_printf(&buf, "# TYPE hello_function_calls_total counter\n");
+    for (int f = 0; f < METRIC_FUNCTION_COUNT; f++) {
+        buffer_printf(&buf, "hello_function_calls_total{module=\"%s\",function=\"%s\"} %llu\n",
+                      function_module((metric_function)f), function_names[f],
+                      metrics_get_calls((metric_function)f));
+    }
+
+    buffer_printf(&buf, "# HELP hello_errors_total Number of errors reported through error_log, by code.\n");
+    buffer_printf(&buf, "# TYPE hello_errors_total counter\n");
+    for (int slot = 0; slot < ERROR_SLOTS; slot++) {
+        unsigned long long total = 0;
+        for (metrics_shard* s = atomic_load(&shards); s != NULL; s = s->next) {
+            total += atomic_load_explicit(&s->errors[slot], memory_order_relaxed);
+        }
+        if (total == 0) {
+            continue;
+        }
+        if (slot == 0) {
+            buffer_printf(&buf, "hello_errors_total{code=\"other\"} %llu\n", total);
+        } else {
+            buffer_printf(&buf, "hello_errors_total{code=\"%d\"} %llu\n",
+                          (slot / ERROR_CODES_PER_MODULE) * 1000 + slot % ERROR_CODES_PER_MODULE, total);
+        }
+    }
+
+    buffer_printf(&buf, "# HELP hello_file_op_latency_seconds Latency of file operations.\n");
+    buffer_printf(&buf, "# TYPE hello_file_op_latency_seconds histogram\n");
+    for (int f = METRIC_FIRST_FILE_OP; f < METRIC_FUNCTION_COUNT; f++) {
+        dump_histogram(&buf, (metric_function)f, merged);
+    }
+
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    buffer_printf(&buf, "# HELP hello_file_op_latency_quantile_seconds Latency quantiles estimated from the histogram.\n");
+    buffer_printf(&buf, "# TYPE hello_file_op_latency_quantile_seconds gauge\n");
+    for (int f = METRIC_FIRST_FILE_OP; f < METRIC_FUNCTION_COUNT; f++) {
+        merge_histogram((metric_function)f, merged);
+        for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+            buffer_printf(&buf, "hello_file_op_latency_quantile_seconds{function=\"%s\",quantile=\"%g\"} %.9f\n",
+                          function_names[f], quantiles[q], merged_quantile(merged, quantiles[q]) / 1e9);
+        }
+    }
+
+    free(merged);
+    if (buf.failed) {
+        mem_free(buf.data);
+        error_log(ERR_METRICS_ALLOC, "内存分配失败");
+        return NULL;
+    }
+    return buf.data;
+}
+
+int metrics_write_prometheus(const char* filename) {
+    debug_print("导出指标");
+    char* text = metrics_dump_prometheus();
+    if (text == NULL) {
+        return 0;
+    }
+
+    int ok = 1;
+    if (filename == NULL) {
+        fputs(text, stdout);
+    } else {
+        // 不使用file_ops，避免导出过程本身被计入文件操作指标
+        FILE* file = fopen(filename, "w");
+        if (file == NULL) {
+            error_log_detail(ERR_METRICS_OPEN, "无法打开文件", filename);
+            mem_free(text);
+            return 0;
+        }
+        size_t len = strlen(text);
+        ok = fwrite(text, 1, len, file) == len;
+        ok = fclose(file) == 0 && ok;
+        if (!ok) {
+            error_log(ERR_METRICS_WRITE, "写入指标文件失败");
+        }
+    }
+    mem_free(text);
+    return ok;
+}
+
+static int module_init(void) {
+    pthread_once(&key_once, create_shard_key);
+    debug_print("指标库初始化成功");
+    return 1;
+}
+
+int initialize_metrics() {
+    return module_init_once(MODULE_METRICS, module_init);
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+/**
+ * @file module.c
+ * @brief 模块注册表实现
+ */
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/module.h"
+#include "../include/utils.h"
+#include "../include/metrics.h"
+#include "../include/thread_pool.h"
+#include "../include/math_ops.h"
+#include "../include/string_ops.h"
+#include "../include/file_ops.h"
+#include "../include/dir_ops.h"
+#include "../include/hash_ops.h"
+#include "../include/compress_ops.h"
+#include "../include/number_ops.h"
+#include "../include/command.h"
+#include "../include/fingerprint_ops.h"
+#include "../include/csv_ops.h"
+#include "../include/bignum_ops.h"
+#include "../include/matrix_ops.h"
+#include "../include/array_ops.h"
+#include "../include/rope_ops.h"
+#include "../include/pattern_ops.h"
+#include "../include/allocator.h"
+#include "../include/line_index.h"
+
+#define MODULE_MAX_DEPS 5
+
+/* 模块状态 */
+#define MODULE_UNINITIALIZED 0
+#define MODULE_READY 1
+#define MODULE_FAILED -1
+
+typedef struct {
+    module_id module;
+    error_code error;        /* 依赖初始化失败时记录的错误代码 */
+} module_dependency;
+
+typedef struct {
+    const char* name;
+    int (*initialize)(void);  /* 模块的公开初始化函数，用于按编号初始化依赖 */
+    int dep_count;
+    module_dependency deps[MODULE_MAX_DEPS];
+} module_descriptor;
+
+typedef struct {
+    atomic_int state;
+    pthread_mutex_t lock;
+    uint64_t self_ns;         /* 模块自身初始化函数的耗时 */
+    uint64_t total_ns;        /* 包含依赖模块在内的耗时 */
+    int order;                /* 完成初始化的顺序 */
+} module_state;
+
+/* 依赖关系：每个模块只列出直接依赖，必须按模块编号排列 */
+static const module_descriptor descriptors[MODULE_COUNT] = {
+    {"utils", initialize_utils, 0, {{0, ERR_OK}}},
+    {"metrics", initialize_metrics, 1, {{MODULE_UTILS, ERR_METRICS_INIT_UTILS}}},
+    {"thread_pool", initialize_thread_pool, 1, {{MODULE_UTILS, ERR_POOL_INIT_UTILS}}},
+    {"math_ops", initialize_math_ops, 2,
+     {{MODULE_UTILS, ERR_MATH_INIT_UTILS}, {MODULE_THREAD_POOL, ERR_MATH_INIT_THREAD_POOL}}},
+    {"string_ops", initialize_string_ops, 2,
+     {{MODULE_UTILS, ERR_STRING_INIT_UTILS}, {MODULE_THREAD_POOL, ERR_STRING_INIT_THREAD_POOL}}},
+    {"file_ops", initialize_file_ops, 2,
+     {{MODULE_UTILS, ERR_FILE_INIT_UTILS}, {MODULE_STRING, ERR_FILE_INIT_STRING_OPS}}},
+    {"dir_ops", initialize_dir_ops, 3,
+     {{MODULE_FILE, ERR_DIR_INIT_FILE_OPS}, {MODULE_THREAD_POOL, ERR_DIR_INIT_THREAD_POOL},
+      {MODULE_PATTERN, ERR_DIR_INIT_PATTERN}}},
+    {"hash_ops", initialize_hash_ops, 2,
+     {{MODULE_UTILS, ERR_HASH_INIT_UTILS}, {MODULE_THREAD_POOL, ERR_HASH_INIT_THREAD_POOL}}},
+    {"compress_ops", initialize_compress_ops, 1, {{MODULE_HASH, ERR_COMPRESS_INIT_HASH}}},
+    {"number_ops", initialize_number_ops, 2,
+     {{MODULE_UTILS, ERR_NUMBER_INIT_UTILS}, {MODULE_THREAD_POOL, ERR_NUMBER_INIT_THREAD_POOL}}},
+    {"command", initialize_command, 5,
+     {{MODULE_MATH, ERR_COMMAND_INIT}, {MODULE_STRING, ERR_COMMAND_INIT},
+      {MODULE_FILE, ERR_COMMAND_INIT}, {MODULE_HASH, ERR_COMMAND_INIT}, {MODULE_NUMBER, ERR_COMMAND_INIT}}},
+    {"fingerprint_ops", initialize_fingerprint_ops, 2,
+     {{MODULE_UTILS, ERR_FINGERPRINT_INIT_UTILS}, {MODULE_THREAD_POOL, ERR_FINGERPRINT_INIT_THREAD_POOL}}},
+    {"csv_ops", initialize_csv_ops, 2,
+     {{MODULE_NUMBER, ERR_CSV_INIT_NUMBER}, {MODULE_THREAD_POOL, ERR_CSV_INIT_THREAD_POOL}}},
+    {"bignum_ops", initialize_bignum_ops, 1, {{MODULE_UTILS, ERR_BIGNUM_INIT_UTILS}}},
+    {"matrix_ops", initialize_matrix_ops, 2,
+     {{MODULE_UTILS, ERR_MATRIX_INIT_UTILS}, {MODULE_THREAD_POOL, ERR_MATRIX_INIT_THREAD_POOL}}},
+    {"array_ops", initialize_array_ops, 2,
+     {{MODULE_UTILS, ERR_ARRAY_INIT_UTILS}, {MODULE_THREAD_POOL, ERR_ARRAY_INIT_THREAD_POOL}}},
+    {"rope_ops", initialize_rope_ops, 1, {{MODULE_UTILS, ERR_ROPE_INIT_UTILS}}},
+    {"pattern_ops", initialize_pattern_ops, 1, {{MODULE_UTILS, ERR_PATTERN_INIT_UTILS}}},
+    {"allocator", initialize_allocator, 1, {{MODULE_UTILS, ERR_MEM_INIT_UTILS}}},
+    {"line_index", initialize_line_index, 2,
+     {{MODULE_HASH, ERR_LINE_INDEX_INIT_HASH}, {MODULE_THREAD_POOL, ERR_LINE_INDEX_INIT_THREAD_POOL}}},
+};
+
+static module_state states[MODULE_COUNT] = {
+    [0 ... MODULE_COUNT - 1] = {0, PTHREAD_MUTEX_INITIALIZER, 0, 0, 0}
+};
+
+static atomic_int init_counter = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int module_init_once(module_id id, module_init_fn init) {
+    if ((unsigned)id >= MODULE_COUNT || init == NULL) {
+        return 0;
+    }
+    module_state* m = &states[id];
+    // 快速路径：已初始化的模块只有一次原子读取
+    int state = atomic_load_explicit(&m->state, memory_order_acquire);
+    if (state != MODULE_UNINITIALIZED) {
+        return state == MODULE_READY;
+    }
+
+    // 先在锁外初始化依赖，依赖关系无环，不会在同一线程中重复获取同一把锁
+    uint64_t start = now_ns();
+    const module_descriptor* d = &descriptors[id];
+    error_code failure = ERR_OK;
+    for (int i = 0; i < d->dep_count; i++) {
+        if (!descriptors[d->deps[i].module].initialize()) {
+            failure = d->deps[i].error;
+            break;
+        }
+    }
+
+    pthread_mutex_lock(&m->lock);
+    state = atomic_load_explicit(&m->state, memory_order_relaxed);
+    if (state == MODULE_UNINITIALIZED) {
+        int ok = 0;
+        if (failure != ERR_OK) {
+            error_log(failure, "初始化依赖模块失败");
+        } else {
+            uint64_t self_start = now_ns();
+            ok = init();
+            m->self_ns = now_ns() - self_start;
+        }
+        m->total_ns = now_ns() - start;
+        m->order = atomic_fetch_add(&init_counter, 1);
+        state = ok ? MODULE_READY : MODULE_FAILED;
+        atomic_store_explicit(&m->state, state, memory_order_release);
+    }
+    pthread_mutex_unlock(&m->lock);
+    return state == MODULE_READY;
+}
+
+int module_require(module_id id) {
+    if ((unsigned)id >= MODULE_COUNT) {
+        return 0;
+    }
+    return descriptors[id].initialize();
+}
+
+int module_is_ready(module_id id) {
+    if ((unsigned)id >= MODULE_COUNT) {
+        return 0;
+    }
+    return atomic_load_explicit(&states[id].state, memory_order_acquire) == MODULE_READY;
+}
+
+const char* module_name(module_id id) {
+    return (unsigned)id < MODULE_COUNT ? descriptors[id].name : "unknown";
+}
+
+uint64_t module_init_time_ns(module_id id) {
+    return module_is_ready(id) ? states[id].self_ns : 0;
+}
+
+void module_print_startup_report() {
+    printf("模块初始化耗时（按完成顺序）:\n");
+    printf("  %-14s %12s %12s\n", "模块", "自身(us)", "含依赖(us)");
+    int count = atomic_load(&init_counter);
+    uint64_t total = 0;
+    for (int order = 0; order < count; order++) {
+        for (int id = 0; id < MODULE_COUNT; id++) {
+            module_state* m = &states[id];
+            int state = atomic_load_explicit(&m->state, memory_order_acquire);
+            if (state == MODULE_UNINITIALIZED || m->order != order) {
+                continue;
+            }
+            printf("  %-14s %12.1f %12.1f%s\n", descriptors[id].name, m->self_ns / 1000.0,
+                   m->total_ns / 1000.0, state == MODULE_FAILED ? "  失败" : "");
+            total += m->self_ns;
+        }
+    }
+    for (int id = 0; id < MODULE_COUNT; id++) {
+        if (atomic_load_explicit(&states[id].state, memory_order_acquire) == MODULE_UNINITIALIZED) {
+            printf("  %-14s %12s\n", descriptors[id].name, "未使用");
+        }
+    }
+    printf("  合计 %.1f us\n", total / 1000.0);
+}
\ No newline at end of file
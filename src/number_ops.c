@@ -0,0 +1,933 @@
+/**
+ * @file number_ops.c
+ * @brief 数值解析与格式化实现
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <immintrin.h>
+#include "../include/number_ops.h"
+#include "../include/module.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+#include "../include/allocator.h"
+
+/* 5的幂表覆盖的十进制指数范围：Eisel-Lemire需要[-342, 308]，Schubfach需要[-292, 326] */
+#define POW5_MIN_EXPONENT (-342)
+#define POW5_MAX_EXPONENT 326
+#define POW5_COUNT (POW5_MAX_EXPONENT - POW5_MIN_EXPONENT + 1)
+
+/* 生成幂表用的大整数：32位小端limb，共1280位；负指数从2^BIGNUM_RECIPROCAL_BITS开始整除 */
+#define BIGNUM_LIMBS 40
+#define BIGNUM_RECIPROCAL_BITS 1100
+
+/* 超过该长度的缓冲区由parse_int64_list分段并行解析 */
+#define LIST_PARALLEL_THRESHOLD (1 << 20)
+#define LIST_MIN_SEGMENT (256 * 1024)
+
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+} uint128_parts;
+
+/* ---------- 5的幂表 ---------- */
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+/* pow5_table[q - POW5_MIN_EXPONENT]：5^q的前128位（最高位为1），截断取整 */
+static uint128_parts pow5_table[POW5_COUNT];
+
+typedef struct {
+    uint32_t limbs[BIGNUM_LIMBS];
+} bignum;
+
+static int bignum_bit_length(const bignum* b) {
+    for (int i = BIGNUM_LIMBS - 1; i >= 0; i--) {
+        if (b->limbs[i] != 0) {
+            return i * 32 + 32 - __builtin_clz(b->limbs[i]);
+        }
+    }
+    return 0;
+}
+
+static int bignum_bit(const bignum* b, int bit) {
+    return bit >= 0 && ((b->limbs[bit / 32] >> (bit % 32)) & 1);
+}
+
+/* 取最高的128位：不足128位时左移补零，否则截断低位 */
+static uint128_parts bignum_top128(const bignum* b) {
+    int length = bignum_bit_length(b);
+    uint128_parts result = {0, 0};
+    for (int i = 0; i < 128; i++) {
+        int bit = bignum_bit(b, length - 1 - i);
+        if (i < 64) {
+            result.hi |= (uint64_t)bit << (63 - i);
+        } else {
+            result.lo |= (uint64_t)bit << (127 - i);
+        }
+    }
+    return result;
+}
+
+static void bignum_mul_small(bignum* b, uint32_t factor) {
+    uint64_t carry = 0;
+    for (int i = 0; i < BIGNUM_LIMBS; i++) {
+        uint64_t product = (uint64_t)b->limbs[i] * factor + carry;
+        b->limbs[i] = (uint32_t)product;
+        carry = product >> 32;
+    }
+}
+
+static void bignum_div_small(bignum* b, uint32_t divisor) {
+    uint64_t remainder = 0;
+    for (int i = BIGNUM_LIMBS - 1; i >= 0; i--) {
+        uint64_t current = (remainder << 32) | b->limbs[i];
+        b->limbs[i] = (uint32_t)(current / divisor);
+        remainder = current % divisor;
+    }
+}
+
+/*
+ * 正指数直接累乘5^q；负指数从X = 2^BIGNUM_RECIPROCAL_BITS开始反复整除5，
+ * floor(floor(X / 5^q) / 5) = floor(X / 5^(q+1))，每一步都是精确的截断值，不会累积误差。
+ */
+static void init_tables(void) {
+    bignum b;
+    memset(&b, 0, sizeof(b));
+    b.limbs[0] = 1;
+    for (int q = 0; q <= POW5_MAX_EXPONENT; q++) {
+        pow5_table[q - POW5_MIN_EXPONENT] = bignum_top128(&b);
+        bignum_mul_small(&b, 5);
+    }
+    memset(&b, 0, sizeof(b));
+    b.limbs[BIGNUM_RECIPROCAL_BITS / 32] = 1u << (BIGNUM_RECIPROCAL_BITS % 32);
+    for (int q = -1; q >= POW5_MIN_EXPONENT; q--) {
+        bignum_div_small(&b, 5);
+        pow5_table[q - POW5_MIN_EXPONENT] = bignum_top128(&b);
+    }
+}
+
+static inline void ensure_tables(void) {
+    pthread_once(&tables_once, init_tables);
+}
+
+/* ---------- 整数解析 ---------- */
+
+/* 从p开始连续数字字符的个数，可读字节不少于16时用SSE2每次检查16字节 */
+static inline size_t digit_run(const char* p, size_t available) {
+    size_t n = 0;
+    while (available - n >= 16) {
+        __m128i chars = _mm_loadu_si128((const __m128i*)(p + n));
+        __m128i offset = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        // 无符号的(c - '0') <= 9即为数字
+        __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(9)), offset);
+        unsigned int non_digits = ~(unsigned int)_mm_movemask_epi8(is_digit) & 0xFFFF;
+        if (non_digits != 0) {
+            return n + (size_t)__builtin_ctz(non_digits);
+        }
+        n += 16;
+    }
+    while (n < available && (unsigned char)(p[n] - '0') <= 9) {
+        n++;
+    }
+    return n;
+}
+
+/* SWAR：一次把8个数字字符转换为整数 */
+static inline uint32_t parse_eight_digits(const char* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    value = (value & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+    value = (value & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+    return (uint32_t)((value & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+}
+
+/* n不超过19位数字的值，不会溢出 */
+static inline uint64_t digits_value(const char* p, size_t n) {
+    uint64_t value = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        value = value * 100000000 + parse_eight_digits(p + i);
+    }
+    for (; i < n; i++) {
+        value = value * 10 + (uint64_t)(p[i] - '0');
+    }
+    return value;
+}
+
+/* 不记录错误的整数解析，供公开函数和批量解析使用 */
+static error_code parse_int64_core(const char* str, size_t len, int64_t* value, size_t* consumed) {
+    size_t pos = 0;
+    int negative = 0;
+    if (pos < len && (str[pos] == '-' || str[pos] == '+')) {
+        negative = str[pos] == '-';
+        pos++;
+    }
+    size_t digits = digit_run(str + pos, len - pos);
+    if (digits == 0) {
+        return ERR_NUMBER_INVALID;
+    }
+    const char* p = str + pos;
+    size_t end = pos + digits;
+    while (digits > 1 && *p == '0') {
+        p++;
+        digits--;
+    }
+    uint64_t magnitude;
+    if (digits <= 19) {
+        magnitude = digits_value(p, digits);
+    } else if (digits == 20) {
+        uint64_t head = digits_value(p, 19);
+        if (__builtin_mul_overflow(head, 10, &magnitude) ||
+            __builtin_add_overflow(magnitude, (uint64_t)(p[19] - '0'), &magnitude)) {
+            return ERR_NUMBER_OVERFLOW;
+        }
+    } else {
+        return ERR_NUMBER_OVERFLOW;
+    }
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    if (magnitude > limit) {
+        return ERR_NUMBER_OVERFLOW;
+    }
+    *value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    if (consumed != NULL) {
+        *consumed = end;
+    }
+    return ERR_OK;
+}
+
+error_code parse_int64(const char* str, size_t len, int64_t* value, size_t* consumed) {
+    if (str == NULL || value == NULL) {
+        return error_raise(ERR_NUMBER_NULL, "文本或输出参数为NULL");
+    }
+    error_code code = parse_int64_core(str, len, value, consumed);
+    if (code == ERR_NUMBER_INVALID) {
+        return error_raise(code, "不是整数");
+    }
+    if (code == ERR_NUMBER_OVERFLOW) {
+        return error_raise(code, "整数超出int64_t范围");
+    }
+    return ERR_OK;
+}
+
+error_code parse_int(const char* str, int* value) {
+    if (str == NULL || value == NULL) {
+        return error_raise(ERR_NUMBER_NULL, "文本或输出参数为NULL");
+    }
+    size_t len = strlen(str);
+    int64_t parsed = 0;
+    size_t consumed = 0;
+    error_code code = parse_int64_core(str, len, &parsed, &consumed);
+    if (code == ERR_NUMBER_INVALID || (code == ERR_OK && consumed != len)) {
+        return error_raise(ERR_NUMBER_INVALID, "不是整数");
+    }
+    if (code == ERR_NUMBER_OVERFLOW || parsed < INT_MIN || parsed > INT_MAX) {
+        return error_raise(ERR_NUMBER_OVERFLOW, "整数超出int范围");
+    }
+    *value = (int)parsed;
+    return ERR_OK;
+}
+
+/* ---------- 浮点解析 ---------- */
+
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static inline double make_double(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*
+ * Eisel-Lemire：w * 5^q的前64位（必要时再乘5^q的低64位修正）决定尾数与舍入，
+ * 2的幂部分直接加到指数上。结果无法确定时返回0，由调用者改用strtod。
+ */
+static int eisel_lemire(uint64_t w, int q, int negative, double* out) {
+    uint64_t sign = negative ? 1ULL << 63 : 0;
+    if (w == 0 || q < POW5_MIN_EXPONENT) {
+        *out = make_double(sign);
+        return 1;
+    }
+    if (q > 308) {
+        *out = make_double(sign | 0x7FF0000000000000ULL);
+        return 1;
+    }
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+    uint128_parts power = pow5_table[q - POW5_MIN_EXPONENT];
+    // 5^q < 2^64时表项取上舍入，使乘积落在精确值的同一侧
+    if (q >= -27 && q < 0) {
+        power.lo++;
+        power.hi += power.lo == 0;
+    }
+    __uint128_t first = (__uint128_t)w * power.hi;
+    uint64_t upper = (uint64_t)(first >> 64);
+    uint64_t lower = (uint64_t)first;
+    if ((upper & 0x1FF) == 0x1FF) {
+        uint64_t second = (uint64_t)(((__uint128_t)w * power.lo) >> 64);
+        lower += second;
+        upper += second > lower;
+        if (lower == UINT64_MAX && (q < -27 || q > 55)) {
+            return 0;
+        }
+    }
+    int upper_bit = (int)(upper >> 63);
+    uint64_t mantissa = upper >> (upper_bit + 9);
+    // ((152170 + 65536) * q) >> 16 = floor(q * log2(10))
+    int power2 = (((152170 + 65536) * q) >> 16) + 63 + upper_bit - lz + 1023;
+    if (power2 <= 0) {
+        // 次正规数
+        if (-power2 + 1 >= 64) {
+            *out = make_double(sign);
+            return 1;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < (1ULL << 52) ? 0 : 1;
+        *out = make_double(sign | mantissa | ((uint64_t)power2 << 52));
+        return 1;
+    }
+    // 恰好在两个可表示值中间时向偶数舍入
+    if (lower <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+        (mantissa << (upper_bit + 9)) == upper) {
+        mantissa &= ~1ULL;
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << 52)) {
+        mantissa = 1ULL << 52;
+        power2++;
+    }
+    mantissa &= ~(1ULL << 52);
+    if (power2 >= 0x7FF) {
+        *out = make_double(sign | 0x7FF0000000000000ULL);
+        return 1;
+    }
+    *out = make_double(sign | mantissa | ((uint64_t)power2 << 52));
+    return 1;
+}
+
+static int match_word(const char* str, size_t len, size_t pos, const char* word) {
+    size_t n = strlen(word);
+    if (len - pos < n) {
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if ((str[pos + i] | 0x20) != word[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static double strtod_fallback(const char* str, size_t len) {
+    char stack_buffer[128];
+    char* copy = len < sizeof(stack_buffer) ? stack_buffer : (char*)malloc(len + 1);
+    if (copy == NULL) {
+        return 0.0;
+    }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    double value = strtod(copy, NULL);
+    if (copy != stack_buffer) {
+        free(copy);
+    }
+    return value;
+}
+
+static error_code parse_double_core(const char* str, size_t len, double* value, size_t* consumed) {
+    size_t pos = 0;
+    int negative = 0;
+    if (pos < len && (str[pos] == '-' || str[pos] == '+')) {
+        negative = str[pos] == '-';
+        pos++;
+    }
+    if (match_word(str, len, pos, "inf") || match_word(str, len, pos, "nan")) {
+        int is_nan = (str[pos] | 0x20) == 'n';
+        pos += match_word(str, len, pos, "infinity") ? 8 : 3;
+        *value = is_nan ? (negative ? -__builtin_nan("") : __builtin_nan(""))
+                        : (negative ? -__builtin_inf() : __builtin_inf());
+        if (consumed != NULL) {
+            *consumed = pos;
+        }
+        return ERR_OK;
+    }
+
+    // 有效数字累积到w，q为十进制指数；有效数字超过19位时交给strtod
+    uint64_t w = 0;
+    int significant = 0;
+    int truncated = 0;
+    long exponent = 0;
+    size_t digits = 0;
+    for (; pos < len && (unsigned char)(str[pos] - '0') <= 9; pos++, digits++) {
+        if (w == 0 && str[pos] == '0') {
+            continue;
+        }
+        if (significant < 19) {
+            w = w * 10 + (uint64_t)(str[pos] - '0');
+            significant++;
+        } else {
+            truncated = 1;
+            exponent++;
+        }
+    }
+    if (pos < len && str[pos] == '.') {
+        size_t start = pos + 1;
+        size_t fraction = digit_run(str + start, len - start);
+        for (size_t i = 0; i < fraction; i++) {
+            char c = str[start + i];
+            if (w == 0 && c == '0') {
+                exponent--;
+                continue;
+            }
+            if (significant < 19) {
+                w = w * 10 + (uint64_t)(c - '0');
+                significant++;
+                exponent--;
+            } else {
+                truncated = 1;
+            }
+        }
+        digits += fraction;
+        if (digits > 0) {
+            pos = start + fraction;
+        }
+    }
+    if (digits == 0) {
+        return ERR_NUMBER_INVALID;
+    }
+    if (pos < len && (str[pos] | 0x20) == 'e') {
+        size_t p = pos + 1;
+        int exp_negative = 0;
+        if (p < len && (str[p] == '-' || str[p] == '+')) {
+            exp_negative = str[p] == '-';
+            p++;
+        }
+        if (p < len && (unsigned char)(str[p] - '0') <= 9) {
+            long written = 0;
+            for (; p < len && (unsigned char)(str[p] - '0') <= 9; p++) {
+                if (written < 100000) {
+                    written = written * 10 + (str[p] - '0');
+                }
+            }
+            exponent += exp_negative ? -written : written;
+            pos = p;
+        }
+    }
+    if (consumed != NULL) {
+        *consumed = pos;
+    }
+
+    if (truncated) {
+        *value = strtod_fallback(str, pos);
+        return ERR_OK;
+    }
+    // Clinger快速路径：w与10^|q|都能精确表示为double，一次乘除即为正确舍入的结果
+    if (exponent >= -22 && exponent <= 22 && w <= (1ULL << 53)) {
+        double result = (double)w;
+        result = exponent < 0 ? result / exact_powers_of_ten[-exponent] : result * exact_powers_of_ten[exponent];
+        *value = negative ? -result : result;
+        return ERR_OK;
+    }
+    // 超出[-342, 308]的指数在eisel_lemire中直接得到0或无穷大，限制范围只是为了转换为int
+    if (exponent < -100000) {
+        exponent = -100000;
+    } else if (exponent > 100000) {
+        exponent = 100000;
+    }
+    ensure_tables();
+    if (!eisel_lemire(w, (int)exponent, negative, value)) {
+        *value = strtod_fallback(str, pos);
+    }
+    return ERR_OK;
+}
+
+error_code parse_double(const char* str, size_t len, double* value, size_t* consumed) {
+    if (str == NULL || value == NULL) {
+        return error_raise(ERR_NUMBER_NULL, "文本或输出参数为NULL");
+    }
+    if (parse_double_core(str, len, value, consumed) != ERR_OK) {
+        return error_raise(ERR_NUMBER_INVALID, "不是浮点数");
+    }
+    return ERR_OK;
+}
+
+int try_parse_int64(const char* str, size_t len, int64_t* value) {
+    size_t consumed = 0;
+    return str != NULL && value != NULL && parse_int64_core(str, len, value, &consumed) == ERR_OK &&
+           consumed == len;
+}
+
+int try_parse_double(const char* str, size_t len, double* value) {
+    size_t consumed = 0;
+    return str != NULL && value != NULL && parse_double_core(str, len, value, &consumed) == ERR_OK &&
+           consumed == len;
+}
+
+/* ---------- 整数格式化 ---------- */
+
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static inline char* write_pair(char* p, uint32_t pair) {
+    memcpy(p, digit_pairs + 2 * pair, 2);
+    return p + 2;
+}
+
+/* 最高的一组数字：不足两位时只写一位 */
+static inline char* write_head(char* p, uint32_t head) {
+    if (head < 10) {
+        *p = (char)('0' + head);
+        return p + 1;
+    }
+    return write_pair(p, head);
+}
+
+/*
+ * jeaiii风格：把n / 10^k表示为32.32定点数，整数部分即最高两位，
+ * 小数部分每乘以100就得到下面两位。各常数已对整个输入范围逐一验证。
+ */
+static char* write_u32_below_1e8(char* p, uint32_t n) {
+    if (n < 100) {
+        return write_head(p, n);
+    }
+    if (n < 10000) {
+        uint64_t y = (uint64_t)n * 42949673;      // ceil(2^32 / 10^2)
+        p = write_head(p, (uint32_t)(y >> 32));
+        y = (uint64_t)(uint32_t)y * 100;
+        return write_pair(p, (uint32_t)(y >> 32));
+    }
+    if (n < 1000000) {
+        uint64_t y = (uint64_t)n * 429497;        // ceil(2^32 / 10^4)
+        p = write_head(p, (uint32_t)(y >> 32));
+        for (int i = 0; i < 2; i++) {
+            y = (uint64_t)(uint32_t)y * 100;
+            p = write_pair(p, (uint32_t)(y >> 32));
+        }
+        return p;
+    }
+    uint64_t y = ((uint64_t)n * 281474978 >> 16) + 1;  // 约2^48 / 10^6
+    p = write_head(p, (uint32_t)(y >> 32));
+    for (int i = 0; i < 3; i++) {
+        y = (uint64_t)(uint32_t)y * 100;
+        p = write_pair(p, (uint32_t)(y >> 32));
+    }
+    return p;
+}
+
+/* 写出8位数字，保留前导零 */
+static char* write_u32_8_digits(char* p, uint32_t n) {
+    uint64_t y = ((uint64_t)n * 281474978 >> 16) + 1;
+    p = write_pair(p, (uint32_t)(y >> 32));
+    for (int i = 0; i < 3; i++) {
+        y = (uint64_t)(uint32_t)y * 100;
+        p = write_pair(p, (uint32_t)(y >> 32));
+    }
+    return p;
+}
+
+static char* write_u64(char* p, uint64_t value) {
+    if (value < 100000000) {
+        return write_u32_below_1e8(p, (uint32_t)value);
+    }
+    if (value < 10000000000000000ULL) {
+        uint64_t high = value / 100000000;
+        p = write_u32_below_1e8(p, (uint32_t)high);
+        return write_u32_8_digits(p, (uint32_t)(value - high * 100000000));
+    }
+    uint64_t top = value / 10000000000000000ULL;
+    uint64_t rest = value - top * 10000000000000000ULL;
+    uint64_t middle = rest / 100000000;
+    p = write_u32_below_1e8(p, (uint32_t)top);
+    p = write_u32_8_digits(p, (uint32_t)middle);
+    return write_u32_8_digits(p, (uint32_t)(rest - middle * 100000000));
+}
+
+size_t format_uint64(uint64_t value, char* buffer) {
+    char* end = write_u64(buffer, value);
+    *end = '\0';
+    return (size_t)(end - buffer);
+}
+
+size_t format_int64(int64_t value, char* buffer) {
+    char* p = buffer;
+    uint64_t magnitude = (uint64_t)value;
+    if (value < 0) {
+        *p++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    char* end = write_u64(p, magnitude);
+    *end = '\0';
+    return (size_t)(end - buffer);
+}
+
+/* ---------- 浮点格式化（Schubfach） ---------- */
+
+static inline int floor_log2_pow10(int e) {
+    return (e * 1741647) >> 19;
+}
+
+static inline int floor_log10_pow2(int e) {
+    return (e * 1262611) >> 22;
+}
+
+static inline int floor_log10_three_quarters_pow2(int e) {
+    return (e * 1262611 - 524031) >> 22;
+}
+
+/* floor(g * cp / 2^128)，被截掉的部分非零时把最低位置1（向奇数舍入） */
+static inline uint64_t round_to_odd(uint128_parts g, uint64_t cp) {
+    __uint128_t x = (__uint128_t)g.lo * cp;
+    __uint128_t y = (__uint128_t)g.hi * cp + (uint64_t)(x >> 64);
+    uint64_t high = (uint64_t)(y >> 64);
+    uint64_t low = (uint64_t)y;
+    return high | (low > 1);
+}
+
+/*
+ * 求c * 2^q的最短十进制表示digits * 10^exponent：舍入区间的两端和中点乘以10^-k后，
+ * 先看区间内是否有10的倍数（少一位数字），再在两个相邻整数中选择区间内且最接近的一个。
+ */
+static void shortest_decimal(uint64_t fraction, int biased_exponent, uint64_t* digits, int* exponent) {
+    uint64_t c;
+    int q;
+    if (biased_exponent != 0) {
+        c = (1ULL << 52) | fraction;
+        q = biased_exponent - 1075;
+        // 小于2^53的整数直接输出
+        if (q <= 0 && -q < 53 && (c & ((1ULL << -q) - 1)) == 0) {
+            *digits = c >> -q;
+            *exponent = 0;
+            return;
+        }
+    } else {
+        c = fraction;
+        q = 1 - 1075;
+    }
+    int is_even = (c & 1) == 0;
+    int lower_closer = fraction == 0 && biased_exponent > 1;
+    uint64_t cbl = 4 * c - 2 + (uint64_t)lower_closer;
+    uint64_t cb = 4 * c;
+    uint64_t cbr = 4 * c + 2;
+    int k = lower_closer ? floor_log10_three_quarters_pow2(q) : floor_log10_pow2(q);
+    int h = q + floor_log2_pow10(-k) + 1;
+    // 10^-k的前128位向上取整（截断值加1）
+    uint128_parts g = pow5_table[-k - POW5_MIN_EXPONENT];
+    g.lo++;
+    g.hi += g.lo == 0;
+    uint64_t vbl = round_to_odd(g, cbl << h);
+    uint64_t vb = round_to_odd(g, cb << h);
+    uint64_t vbr = round_to_odd(g, cbr << h);
+    uint64_t lower = vbl + !is_even;
+    uint64_t upper = vbr - !is_even;
+
+    uint64_t s = vb / 4;
+    if (s >= 10) {
+        uint64_t sp = s / 10;
+        uint64_t up = sp * 40;
+        int up_inside = lower <= up;
+        int wp_inside = up + 40 <= upper;
+        if (up_inside != wp_inside) {
+            *digits = up_inside ? sp : sp + 1;
+            *exponent = k + 1;
+            return;
+        }
+    }
+    uint64_t u = s * 4;
+    int u_inside = lower <= u;
+    int w_inside = u + 4 <= upper;
+    if (u_inside != w_inside) {
+        *digits = u_inside ? s : s + 1;
+        *exponent = k;
+        return;
+    }
+    uint64_t mid = 4 * s + 2;
+    int round_up = vb > mid || (vb == mid && (s & 1) != 0);
+    *digits = round_up ? s + 1 : s;
+    *exponent = k;
+}
+
+size_t format_double(double value, char* buffer) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int negative = (int)(bits >> 63);
+    int biased_exponent = (int)((bits >> 52) & 0x7FF);
+    uint64_t fraction = bits & ((1ULL << 52) - 1);
+    char* p = buffer;
+    if (biased_exponent == 0x7FF && fraction != 0) {
+        memcpy(buffer, "nan", 4);
+        return 3;
+    }
+    if (negative) {
+        *p++ = '-';
+    }
+    if (biased_exponent == 0x7FF) {
+        memcpy(p, "inf", 4);
+        return (size_t)(p + 3 - buffer);
+    }
+    if (biased_exponent == 0 && fraction == 0) {
+        memcpy(p, "0", 2);
+        return (size_t)(p + 1 - buffer);
+    }
+
+    ensure_tables();
+    uint64_t digits;
+    int exponent;
+    shortest_decimal(fraction, biased_exponent, &digits, &exponent);
+    while (digits % 10 == 0) {
+        digits /= 10;
+        exponent++;
+    }
+    char text[24];
+    int count = (int)(write_u64(text, digits) - text);
+    int decimal_exponent = exponent + count - 1;
+
+    if (decimal_exponent >= -5 && decimal_exponent <= 16) {
+        if (exponent >= 0) {
+            // 整数：数字后补零
+            memcpy(p, text, (size_t)count);
+            p += count;
+            memset(p, '0', (size_t)exponent);
+            p += exponent;
+        } else if (decimal_exponent >= 0) {
+            int integer_digits = decimal_exponent + 1;
+            memcpy(p, text, (size_t)integer_digits);
+            p += integer_digits;
+            *p++ = '.';
+            memcpy(p, text + integer_digits, (size_t)(count - integer_digits));
+            p += count - integer_digits;
+        } else {
+            *p++ = '0';
+            *p++ = '.';
+            memset(p, '0', (size_t)(-decimal_exponent - 1));
+            p += -decimal_exponent - 1;
+            memcpy(p, text, (size_t)count);
+            p += count;
+        }
+    } else {
+        *p++ = text[0];
+        if (count > 1) {
+            *p++ = '.';
+            memcpy(p, text + 1, (size_t)(count - 1));
+            p += count - 1;
+        }
+        *p++ = 'e';
+        *p++ = decimal_exponent < 0 ? '-' : '+';
+        int magnitude = decimal_exponent < 0 ? -decimal_exponent : decimal_exponent;
+        if (magnitude >= 100) {
+            *p++ = (char)('0' + magnitude / 100);
+            magnitude %= 100;
+        }
+        p = write_pair(p, (uint32_t)magnitude);
+    }
+    *p = '\0';
+    return (size_t)(p - buffer);
+}
+
+/* ---------- 分隔文本的批量解析 ---------- */
+
+typedef struct {
+    int64_t* values;
+    size_t count;
+    size_t capacity;
+    error_code error;
+    size_t error_offset;     /* 出错字段在整个缓冲区中的偏移 */
+} number_list;
+
+/* 字段两侧可忽略的字符；制表符作分隔符时不算空白 */
+static inline int is_blank(char c, char delimiter) {
+    return (c == ' ' || c == '\t' || c == '\r') && c != delimiter;
+}
+
+static int list_append(number_list* list, int64_t value) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity > 0 ? list->capacity * 2 : 1024;
+        int64_t* grown = (int64_t*)mem_realloc(list->values, capacity * sizeof(int64_t));
+        if (grown == NULL) {
+            return 0;
+        }
+        list->values = grown;
+        list->capacity = capacity;
+    }
+    list->values[list->count++] = value;
+    return 1;
+}
+
+static void list_fail(number_list* list, error_code code, size_t offset) {
+    list->error = code;
+    list->error_offset = offset;
+}
+
+/* 解析[begin, end)，调用者保证begin是行首（或缓冲区开头） */
+static void parse_list_range(const char* buffer, size_t begin, size_t end, char delimiter, number_list* list) {
+    size_t pos = begin;
+    int expect_field = 0;    // 刚读过分隔符，后面必须有字段
+    for (;;) {
+        while (pos < end && is_blank(buffer[pos], delimiter)) {
+            pos++;
+        }
+        if (pos == end || buffer[pos] == '\n') {
+            if (expect_field) {
+                list_fail(list, ERR_NUMBER_INVALID, pos);
+                return;
+            }
+            if (pos == end) {
+                return;
+            }
+            pos++;
+            continue;
+        }
+        int64_t value;
+        size_t used = 0;
+        error_code code = parse_int64_core(buffer + pos, end - pos, &value, &used);
+        if (code != ERR_OK) {
+            list_fail(list, code, pos);
+            return;
+        }
+        if (!list_append(list, value)) {
+            list_fail(list, ERR_NUMBER_ALLOC, pos);
+            return;
+        }
+        pos += used;
+        while (pos < end && is_blank(buffer[pos], delimiter)) {
+            pos++;
+        }
+        expect_field = 0;
+        if (pos < end && buffer[pos] == delimiter) {
+            pos++;
+            expect_field = 1;
+        } else if (pos < end && buffer[pos] != '\n') {
+            list_fail(list, ERR_NUMBER_INVALID, pos);
+            return;
+        }
+    }
+}
+
+typedef struct {
+    const char* buffer;
+    const size_t* bounds;     /* 第i段为[bounds[i], bounds[i + 1]) */
+    char delimiter;
+    number_list* lists;
+} list_job;
+
+static void parse_list_segments(long begin, long end, void* ctx) {
+    list_job* job = (list_job*)ctx;
+    for (long i = begin; i < end; i++) {
+        parse_list_range(job->buffer, job->bounds[i], job->bounds[i + 1], job->delimiter, &job->lists[i]);
+    }
+}
+
+static error_code list_error(const number_list* list) {
+    char detail[64];
+    memcpy(detail, "偏移", sizeof("偏移") - 1);
+    format_uint64(list->error_offset, detail + sizeof("偏移") - 1);
+    const char* message = list->error == ERR_NUMBER_OVERFLOW ? "整数超出int64_t范围"
+                        : list->error == ERR_NUMBER_ALLOC ? "内存分配失败"
+                        : "空字段或非数字字段";
+    error_log_detail(list->error, message, detail);
+    return list->error;
+}
+
+error_code parse_int64_list(const char* buffer, size_t len, char delimiter, int64_t** values, size_t* count) {
+    debug_print("批量解析整数");
+    if (values == NULL || count == NULL || (buffer == NULL && len > 0)) {
+        return error_raise(ERR_NUMBER_NULL, "文本或输出参数为NULL");
+    }
+    *values = NULL;
+    *count = 0;
+    if ((unsigned char)(delimiter - '0') <= 9 || delimiter == '-' || delimiter == '+' || delimiter == '\n' ||
+        delimiter == ' ' || delimiter == '\r') {
+        return error_raise(ERR_NUMBER_INVALID, "分隔符不能是数字、符号、空格、'\\r'或换行");
+    }
+
+    int segments = 1;
+    if (len >= LIST_PARALLEL_THRESHOLD) {
+        segments = thread_pool_size(NULL) * 4;
+        if ((size_t)segments > len / LIST_MIN_SEGMENT) {
+            segments = (int)(len / LIST_MIN_SEGMENT);
+        }
+    }
+    size_t* bounds = (size_t*)malloc(((size_t)segments + 1) * sizeof(size_t));
+    number_list* lists = (number_list*)calloc((size_t)segments, sizeof(number_list));
+    if (bounds == NULL || lists == NULL) {
+        free(bounds);
+        free(lists);
+        return error_raise(ERR_NUMBER_ALLOC, "内存分配失败");
+    }
+    // 分段边界取在换行之后，字段不会跨段；很长的行使若干段为空
+    bounds[0] = 0;
+    for (int i = 1; i < segments; i++) {
+        size_t target = len / (size_t)segments * (size_t)i;
+        if (target < bounds[i - 1]) {
+            target = bounds[i - 1];
+        }
+        const char* newline = (const char*)memchr(buffer + target, '\n', len - target);
+        bounds[i] = newline != NULL ? (size_t)(newline - buffer) + 1 : len;
+    }
+    bounds[segments] = len;
+
+    list_job job = {buffer, bounds, delimiter, lists};
+    if (segments > 1) {
+        parallel_for(NULL, 0, segments, 1, parse_list_segments, &job);
+    } else {
+        parse_list_segments(0, 1, &job);
+    }
+
+    error_code code = ERR_OK;
+    size_t total = 0;
+    for (int i = 0; i < segments && code == ERR_OK; i++) {
+        if (lists[i].error != ERR_OK) {
+            code = list_error(&lists[i]);
+        }
+        total += lists[i].count;
+    }
+    int64_t* result = NULL;
+    if (code == ERR_OK && total > 0) {
+        if (segments == 1) {
+            // 只有一段时直接交出该段的数组
+            result = lists[0].values;
+            lists[0].values = NULL;
+        } else {
+            result = (int64_t*)mem_alloc(total * sizeof(int64_t));
+            if (result == NULL) {
+                code = error_raise(ERR_NUMBER_ALLOC, "内存分配失败");
+            } else {
+                size_t offset = 0;
+                for (int i = 0; i < segments; i++) {
+                    if (lists[i].count > 0) {
+                        memcpy(result + offset, lists[i].values, lists[i].count * sizeof(int64_t));
+                    }
+                    offset += lists[i].count;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < segments; i++) {
+        mem_free(lists[i].values);
+    }
+    free(lists);
+    free(bounds);
+    if (code != ERR_OK) {
+        return code;
+    }
+    *values = result;
+    *count = result != NULL ? total : 0;
+    return ERR_OK;
+}
+
+static int module_init(void) {
+    ensure_tables();
+    debug_print("数值库初始化成功");
+    return 1;
+}
+
+int initialize_number_ops() {
+    return module_init_once(MODULE_NUMBER, module_init);
+}
\ No newline at end of file
@@ -0,0 +1,1840 @@
+/**
+ * @file pattern_ops.c
+ * @brief 模式匹配实现
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <immintrin.h>
+#include "../include/pattern_ops.h"
+#include "../include/module.h"
+#include "../include/utils.h"
+
+/* NFA节点数上限，{m,n}按次数展开，过大的模式在编译时拒绝 */
+#define MAX_NFA_NODES 20000
+/* 语法树节点数上限，glob方括号表达式的分支会复制其余的模式，在解析时也要限制规模 */
+#define MAX_AST_NODES (2 * MAX_NFA_NODES)
+/* glob模式的长度上限，没有结束的方括号表达式每个都要扫描到模式末尾 */
+#define MAX_GLOB_LENGTH 4096
+/* {m,n}中次数的上限 */
+#define MAX_REPEAT 1000
+/* 括号与量词的嵌套层数上限，限制编译时的递归深度 */
+#define MAX_DEPTH 500
+/* 用于预筛选的字面前缀的最大长度 */
+#define MAX_PREFIX 64
+
+/* 每个DFA的状态数上限，达到后改为逐列表模拟 */
+#define MAX_STATES 4096
+#define HASH_BUCKETS 1024
+
+/* 状态标志：读入到当前位置时有匹配结束；在文本末尾时有匹配结束（$成立） */
+#define STATE_MATCH 0x1
+#define STATE_MATCH_END 0x2
+
+typedef struct {
+    uint64_t bits[4];
+} byte_set;
+
+/* ---------- 字节集合 ---------- */
+
+static inline int set_has(const byte_set* set, unsigned int c) {
+    return (int)((set->bits[c >> 6] >> (c & 63)) & 1);
+}
+
+static inline void set_add(byte_set* set, unsigned int c) {
+    set->bits[c >> 6] |= 1ULL << (c & 63);
+}
+
+static void set_add_range(byte_set* set, unsigned int lo, unsigned int hi) {
+    for (unsigned int c = lo; c <= hi; c++) {
+        set_add(set, c);
+    }
+}
+
+static void set_negate(byte_set* set) {
+    for (int i = 0; i < 4; i++) {
+        set->bits[i] = ~set->bits[i];
+    }
+}
+
+/* 加入集合中ASCII字母的另一种大小写 */
+static void set_fold_case(byte_set* set) {
+    for (unsigned int c = 'a'; c <= 'z'; c++) {
+        if (set_has(set, c) || set_has(set, c - 'a' + 'A')) {
+            set_add(set, c);
+            set_add(set, c - 'a' + 'A');
+        }
+    }
+}
+
+/* 集合只含一个字节时返回该字节，否则返回-1 */
+static int set_single(const byte_set* set) {
+    int found = -1;
+    for (int i = 0; i < 4; i++) {
+        uint64_t w = set->bits[i];
+        if (w == 0) {
+            continue;
+        }
+        if (found >= 0 || (w & (w - 1)) != 0) {
+            return -1;
+        }
+        found = i * 64 + __builtin_ctzll(w);
+    }
+    return found;
+}
+
+/* POSIX字符类，按ASCII定义，不受locale影响 */
+static int class_has(const char* name, size_t len, unsigned int c) {
+    int upper = c >= 'A' && c <= 'Z';
+    int lower = c >= 'a' && c <= 'z';
+    int digit = c >= '0' && c <= '9';
+    int graph = c > ' ' && c < 0x7f;
+#define CLASS_IS(s) (len == sizeof(s) - 1 && memcmp(name, s, len) == 0)
+    if (CLASS_IS("alpha")) return upper || lower;
+    if (CLASS_IS("digit")) return digit;
+    if (CLASS_IS("alnum")) return upper || lower || digit;
+    if (CLASS_IS("upper")) return upper;
+    if (CLASS_IS("lower")) return lower;
+    if (CLASS_IS("space")) return c == ' ' || (c >= '\t' && c <= '\r');
+    if (CLASS_IS("blank")) return c == ' ' || c == '\t';
+    if (CLASS_IS("punct")) return graph && !upper && !lower && !digit;
+    if (CLASS_IS("print")) return graph || c == ' ';
+    if (CLASS_IS("graph")) return graph;
+    if (CLASS_IS("cntrl")) return c < ' ' || c == 0x7f;
+    if (CLASS_IS("xdigit")) return digit || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+#undef CLASS_IS
+    return -1;
+}
+
+/* 按名称加入POSIX字符类，名称无效时返回0 */
+static int set_add_class(byte_set* set, const char* name, size_t len) {
+    if (class_has(name, len, 'a') < 0) {
+        return 0;
+    }
+    for (unsigned int c = 0; c < 256; c++) {
+        if (class_has(name, len, c) == 1) {
+            set_add(set, c);
+        }
+    }
+    return 1;
+}
+
+/* ---------- 语法树 ---------- */
+
+typedef enum {
+    AST_EMPTY,
+    AST_SET,           /* 一个字节，属于集合set */
+    AST_CONCAT,
+    AST_ALT,
+    AST_REPEAT,
+    AST_BOL,           /* 文本开头 */
+    AST_EOL            /* 文本结尾 */
+} ast_kind;
+
+typedef struct {
+    ast_kind kind;
+    int set;           /* AST_SET：集合下标 */
+    int first;         /* AST_CONCAT、AST_ALT：子节点在kids中的起始下标；AST_REPEAT：子节点 */
+    int count;         /* AST_CONCAT、AST_ALT：子节点数 */
+    int min;
+    int max;           /* AST_REPEAT：-1表示不限 */
+} ast_node;
+
+typedef struct {
+    const unsigned char* pos;
+    const unsigned char* end;
+    int icase;
+    int depth;
+    error_code error;
+    const char* message;
+    ast_node* nodes;
+    int node_count;
+    int node_cap;
+    int* kids;
+    int kid_count;
+    int kid_cap;
+    int* stack;        /* 正在解析的序列或分支的子节点 */
+    int stack_count;
+    int stack_cap;
+    byte_set* sets;
+    int set_count;
+    int set_cap;
+} parser;
+
+static int parse_fail(parser* ps, error_code code, const char* message) {
+    if (ps->error == ERR_OK) {
+        ps->error = code;
+        ps->message = message;
+    }
+    return -1;
+}
+
+static int reserve(parser* ps, void** data, int* cap, int need, size_t elem) {
+    if (need <= *cap) {
+        return 1;
+    }
+    int next = *cap > 0 ? *cap * 2 : 16;
+    while (next < need) {
+        next *= 2;
+    }
+    void* grown = realloc(*data, (size_t)next * elem);
+    if (grown == NULL) {
+        parse_fail(ps, ERR_PATTERN_ALLOC, "内存分配失败");
+        return 0;
+    }
+    *data = grown;
+    *cap = next;
+    return 1;
+}
+
+static int new_node(parser* ps, ast_kind kind) {
+    if (ps->node_count >= MAX_AST_NODES) {
+        return parse_fail(ps, ERR_PATTERN_TOO_LARGE, "模式过大");
+    }
+    if (!reserve(ps, (void**)&ps->nodes, &ps->node_cap, ps->node_count + 1, sizeof(ast_node))) {
+        return -1;
+    }
+    ast_node* node = &ps->nodes[ps->node_count];
+    memset(node, 0, sizeof(*node));
+    node->kind = kind;
+    return ps->node_count++;
+}
+
+static int new_set_node(parser* ps, byte_set set) {
+    if (!reserve(ps, (void**)&ps->sets, &ps->set_cap, ps->set_count + 1, sizeof(byte_set))) {
+        return -1;
+    }
+    int node = new_node(ps, AST_SET);
+    if (node < 0) {
+        return -1;
+    }
+    ps->sets[ps->set_count] = set;
+    ps->nodes[node].set = ps->set_count++;
+    return node;
+}
+
+static int new_byte_node(parser* ps, unsigned int c) {
+    byte_set set = {{0}};
+    set_add(&set, c);
+    if (ps->icase) {
+        set_fold_case(&set);
+    }
+    return new_set_node(ps, set);
+}
+
+static int push_item(parser* ps, int item) {
+    if (!reserve(ps, (void**)&ps->stack, &ps->stack_cap, ps->stack_count + 1, sizeof(int))) {
+        return 0;
+    }
+    ps->stack[ps->stack_count++] = item;
+    return 1;
+}
+
+/* 以stack[base..]为子节点生成序列或分支节点，并弹出这些子节点 */
+static int make_list(parser* ps, ast_kind kind, int base) {
+    int count = ps->stack_count - base;
+    if (count <= 1) {
+        ps->stack_count = base;
+        return count == 1 ? ps->stack[base] : new_node(ps, AST_EMPTY);
+    }
+    if (!reserve(ps, (void**)&ps->kids, &ps->kid_cap, ps->kid_count + count, sizeof(int))) {
+        return -1;
+    }
+    int node = new_node(ps, kind);
+    if (node < 0) {
+        return -1;
+    }
+    memcpy(ps->kids + ps->kid_count, ps->stack + base, (size_t)count * sizeof(int));
+    ps->nodes[node].first = ps->kid_count;
+    ps->nodes[node].count = count;
+    ps->kid_count += count;
+    ps->stack_count = base;
+    return node;
+}
+
+static int new_repeat(parser* ps, int child, int min, int max) {
+    int node = new_node(ps, AST_REPEAT);
+    if (node < 0) {
+        return -1;
+    }
+    ps->nodes[node].first = child;
+    ps->nodes[node].min = min;
+    ps->nodes[node].max = max;
+    return node;
+}
+
+/* ---------- 正则表达式解析 ---------- */
+
+static int parse_alternation(parser* ps);
+
+/* \d、\w、\s及其补集，c不是这些字母时返回0 */
+static int escape_class(unsigned int c, byte_set* set) {
+    switch (c) {
+    case 'd': case 'D':
+        set_add_range(set, '0', '9');
+        break;
+    case 'w': case 'W':
+        set_add_range(set, '0', '9');
+        set_add_range(set, 'a', 'z');
+        set_add_range(set, 'A', 'Z');
+        set_add(set, '_');
+        break;
+    case 's': case 'S':
+        set_add(set, ' ');
+        set_add_range(set, '\t', '\r');
+        break;
+    default:
+        return 0;
+    }
+    if (c == 'D' || c == 'W' || c == 'S') {
+        set_negate(set);
+    }
+    return 1;
+}
+
+static unsigned int escape_byte(unsigned int c) {
+    switch (c) {
+    case 'n': return '\n';
+    case 't': return '\t';
+    case 'r': return '\r';
+    case 'f': return '\f';
+    case 'v': return '\v';
+    default: return c;
+    }
+}
+
+/* 解析[...]中的一个元素的字节（用于范围的端点），返回-1表示元素不是单个字节 */
+static int bracket_endpoint(parser* ps) {
+    const unsigned char* p = ps->pos;
+    if (p + 1 < ps->end && p[0] == '[' && (p[1] == '.' || p[1] == '=')) {
+        // [.c.]与[=c=]只支持单个字节
+        if (p + 4 < ps->end && p[3] == p[1] && p[4] == ']') {
+            ps->pos = p + 5;
+            return p[2];
+        }
+        return -1;
+    }
+    if (p[0] == '\\' && p + 1 < ps->end) {
+        byte_set unused = {{0}};
+        if (escape_class(p[1], &unused)) {
+            return -1;
+        }
+        ps->pos = p + 2;
+        return (int)escape_byte(p[1]);
+    }
+    ps->pos = p + 1;
+    return p[0];
+}
+
+static int parse_bracket(parser* ps) {
+    byte_set set = {{0}};
+    int negate = 0;
+    ps->pos++;
+    if (ps->pos < ps->end && *ps->pos == '^') {
+        negate = 1;
+        ps->pos++;
+    }
+    int first = 1;
+    for (;;) {
+        if (ps->pos >= ps->end) {
+            return parse_fail(ps, ERR_PATTERN_SYNTAX, "方括号没有结束");
+        }
+        const unsigned char* p = ps->pos;
+        if (*p == ']' && !first) {
+            ps->pos++;
+            break;
+        }
+        first = 0;
+        if (p + 1 < ps->end && p[0] == '[' && p[1] == ':') {
+            const unsigned char* close = p + 2;
+            while (close + 1 < ps->end && !(close[0] == ':' && close[1] == ']')) {
+                close++;
+            }
+            if (close + 1 >= ps->end || !set_add_class(&set, (const char*)p + 2, (size_t)(close - p - 2))) {
+                return parse_fail(ps, ERR_PATTERN_SYNTAX, "无效的字符类");
+            }
+            ps->pos = close + 2;
+            continue;
+        }
+        if (p[0] == '\\' && p + 1 < ps->end && escape_class(p[1], &set)) {
+            ps->pos = p + 2;
+            continue;
+        }
+        int lo = bracket_endpoint(ps);
+        if (lo < 0) {
+            return parse_fail(ps, ERR_PATTERN_SYNTAX, "方括号中的元素无效");
+        }
+        if (ps->pos + 1 < ps->end && ps->pos[0] == '-' && ps->pos[1] != ']') {
+            ps->pos++;
+            int hi = bracket_endpoint(ps);
+            if (hi < 0 || hi < lo) {
+                return parse_fail(ps, ERR_PATTERN_SYNTAX, "无效的范围");
+            }
+            set_add_range(&set, (unsigned int)lo, (unsigned int)hi);
+        } else {
+            set_add(&set, (unsigned int)lo);
+        }
+    }
+    // 忽略大小写时先对肯定的集合补全大小写再取补集，[^a]不匹配A
+    if (ps->icase) {
+        set_fold_case(&set);
+    }
+    if (negate) {
+        set_negate(&set);
+    }
+    return new_set_node(ps, set);
+}
+
+static int parse_atom(parser* ps) {
+    const unsigned char c = *ps->pos;
+    switch (c) {
+    case '(': {
+        ps->pos++;
+        if (ps->pos + 1 < ps->end && ps->pos[0] == '?' && ps->pos[1] == ':') {
+            ps->pos += 2;
+        }
+        int inner = parse_alternation(ps);
+        if (inner < 0) {
+            return -1;
+        }
+        if (ps->pos >= ps->end || *ps->pos != ')') {
+            return parse_fail(ps, ERR_PATTERN_SYNTAX, "括号不匹配");
+        }
+        ps->pos++;
+        return inner;
+    }
+    case '[':
+        return parse_bracket(ps);
+    case '.': {
+        ps->pos++;
+        byte_set set = {{0}};
+        set_add_range(&set, 0, 255);
+        set.bits['\n' >> 6] &= ~(1ULL << ('\n' & 63));
+        return new_set_node(ps, set);
+    }
+    case '^':
+        ps->pos++;
+        return new_node(ps, AST_BOL);
+    case '$':
+        ps->pos++;
+        return new_node(ps, AST_EOL);
+    case '\\': {
+        if (ps->pos + 1 >= ps->end) {
+            return parse_fail(ps, ERR_PATTERN_SYNTAX, "模式以\\结尾");
+        }
+        unsigned int e = ps->pos[1];
+        ps->pos += 2;
+        byte_set set = {{0}};
+        if (escape_class(e, &set)) {
+            return new_set_node(ps, set);
+        }
+        return new_byte_node(ps, escape_byte(e));
+    }
+    case '*': case '+': case '?': case '{':
+        return parse_fail(ps, ERR_PATTERN_SYNTAX, "量词前没有可重复的内容");
+    default:
+        ps->pos++;
+        return new_byte_node(ps, c);
+    }
+}
+
+/* 解析{m}、{m,}、{m,n}、{,n}，pos指向'{' */
+static int parse_interval(parser* ps, int* min, int* max) {
+    const unsigned char* p = ps->pos + 1;
+    long lo = 0;
+    long hi = -1;
+    int digits = 0;
+    while (p < ps->end && *p >= '0' && *p <= '9') {
+        lo = lo < 100000 ? lo * 10 + (*p - '0') : lo;
+        p++;
+        digits++;
+    }
+    if (p < ps->end && *p == ',') {
+        p++;
+        int hi_digits = 0;
+        long value = 0;
+        while (p < ps->end && *p >= '0' && *p <= '9') {
+            value = value < 100000 ? value * 10 + (*p - '0') : value;
+            p++;
+            hi_digits++;
+        }
+        if (hi_digits > 0) {
+            hi = value;
+        } else if (digits == 0) {
+            return parse_fail(ps, ERR_PATTERN_SYNTAX, "重复次数格式错误");
+        }
+    } else if (digits > 0) {
+        hi = lo;
+    } else {
+        return parse_fail(ps, ERR_PATTERN_SYNTAX, "重复次数格式错误");
+    }
+    if (p >= ps->end || *p != '}') {
+        return parse_fail(ps, ERR_PATTERN_SYNTAX, "重复次数格式错误");
+    }
+    if (hi >= 0 && hi < lo) {
+        return parse_fail(ps, ERR_PATTERN_SYNTAX, "重复次数的下限大于上限");
+    }
+    if (lo > MAX_REPEAT || hi > MAX_REPEAT) {
+        return parse_fail(ps, ERR_PATTERN_TOO_LARGE, "重复次数过大");
+    }
+    ps->pos = p + 1;
+    *min = (int)lo;
+    *max = (int)hi;
+    return 0;
+}
+
+/* 连续的量词依次作用于前面的整体，a+?与(a+)?相同 */
+static int parse_repeat(parser* ps) {
+    int node = parse_atom(ps);
+    int wraps = 0;
+    while (node >= 0 && ps->pos < ps->end) {
+        int min;
+        int max;
+        unsigned char c = *ps->pos;
+        if (c == '*') {
+            min = 0;
+            max = -1;
+            ps->pos++;
+        } else if (c == '+') {
+            min = 1;
+            max = -1;
+            ps->pos++;
+        } else if (c == '?') {
+            min = 0;
+            max = 1;
+            ps->pos++;
+        } else if (c == '{') {
+            if (parse_interval(ps, &min, &max) < 0) {
+                return -1;
+            }
+        } else {
+            break;
+        }
+        if (ps->depth + ++wraps > MAX_DEPTH) {
+            return parse_fail(ps, ERR_PATTERN_TOO_LARGE, "嵌套层数过多");
+        }
+        node = new_repeat(ps, node, min, max);
+    }
+    return node;
+}
+
+static int parse_alternation(parser* ps) {
+    if (++ps->depth > MAX_DEPTH) {
+        return parse_fail(ps, ERR_PATTERN_TOO_LARGE, "嵌套层数过多");
+    }
+    int branches = ps->stack_count;
+    for (;;) {
+        int items = ps->stack_count;
+        while (ps->pos < ps->end && *ps->pos != '|' && *ps->pos != ')') {
+            int piece = parse_repeat(ps);
+            if (piece < 0 || !push_item(ps, piece)) {
+                return -1;
+            }
+        }
+        int branch = make_list(ps, AST_CONCAT, items);
+        if (branch < 0 || !push_item(ps, branch)) {
+            return -1;
+        }
+        if (ps->pos < ps->end && *ps->pos == '|') {
+            ps->pos++;
+        } else {
+            break;
+        }
+    }
+    ps->depth--;
+    return make_list(ps, AST_ALT, branches);
+}
+
+/* ---------- glob解析 ---------- */
+
+static inline unsigned int fold_byte(int icase, unsigned int c) {
+    return icase && c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+/* 大小写折叠后在[lo, hi]中的字节 */
+static void folded_range(byte_set* set, int icase, unsigned int lo, unsigned int hi) {
+    memset(set, 0, sizeof(*set));
+    for (unsigned int c = lo; c <= hi; c++) {
+        unsigned int folded = fold_byte(icase, c);
+        if (folded >= lo && folded <= hi) {
+            set_add(set, c);
+        }
+    }
+    for (unsigned int c = 'A'; icase && c <= 'Z'; c++) {
+        if (c - 'A' + 'a' >= lo && c - 'A' + 'a' <= hi) {
+            set_add(set, c);
+        }
+    }
+}
+
+/*
+ * 跳过已匹配的方括号表达式的其余部分。返回1表示*end为表达式之后的位置；返回0表示表达式无效；
+ * 返回-1表示表达式没有结束。
+ */
+static int glob_skip(const unsigned char* p, const unsigned char** end) {
+    unsigned int c;
+    while ((c = *p++) != ']') {
+        if (c == '\0') {
+            return -1;
+        }
+        if (c == '\\') {
+            if (*p == '\0') {
+                return 0;
+            }
+            p++;
+        } else if (c == '[' && *p == ':') {
+            const unsigned char* start = p;
+            for (;;) {
+                c = *++p;
+                if (*p == ':' && p[1] == ']') {
+                    p += 2;
+                    break;
+                }
+                if (c < 'a' || c >= 'z') {
+                    p = start;
+                    break;
+                }
+            }
+        } else if (c == '[' && *p == '=') {
+            if (p[1] == '\0' || p[2] != '=' || p[3] != ']') {
+                return 0;
+            }
+            p += 4;
+        } else if (c == '[' && *p == '.') {
+            for (;;) {
+                c = *++p;
+                if (c == '\0') {
+                    return 0;
+                }
+                if (c == '.' && p[1] == ']') {
+                    break;
+                }
+            }
+            p += 2;
+        }
+    }
+    *end = p;
+    return 1;
+}
+
+/*
+ * 方括号表达式中各字节的结果。每个字节的结果与glibc的fnmatch（C locale，icase时相当于FNM_CASEFOLD）
+ * 逐个元素检查该字节相同：在第一个包含它的元素处按已匹配跳过其余部分，不在任何元素中时在表达式结束处确定。
+ * 各元素对所有尚未确定的字节一起检查，所以只需扫描一遍表达式。
+ */
+typedef struct {
+    const unsigned char* start;            /* '['之后的位置 */
+    int icase;
+    int negate;
+    byte_set pending;                      /* 尚未确定结果的字节 */
+    const unsigned char* ends[256];        /* 匹配的字节：表达式之后的位置；'['按普通字符匹配时为start */
+} bracket_scan;
+
+static inline const unsigned char* bracket_end(const bracket_scan* bs, unsigned int c, int result,
+                                               const unsigned char* end) {
+    return result > 0 ? end : result < 0 && c == '[' ? bs->start : NULL;
+}
+
+/* set中尚未确定的字节在此元素处匹配，表达式的其余部分从after开始 */
+static void bracket_matched(bracket_scan* bs, const byte_set* set, const unsigned char* after) {
+    byte_set hit;
+    uint64_t any = 0;
+    for (int i = 0; i < 4; i++) {
+        hit.bits[i] = set->bits[i] & bs->pending.bits[i];
+        bs->pending.bits[i] &= ~set->bits[i];
+        any |= hit.bits[i];
+    }
+    if (any == 0) {
+        return;
+    }
+    const unsigned char* end = NULL;
+    int result = glob_skip(after, &end);
+    if (result > 0 && bs->negate) {
+        result = 0;
+    }
+    for (unsigned int c = 0; c < 256; c++) {
+        if (set_has(&hit, c)) {
+            bs->ends[c] = bracket_end(bs, c, result, end);
+        }
+    }
+}
+
+/* 表达式在此结束（result同glob_skip），确定其余字节的结果 */
+static void bracket_finish(bracket_scan* bs, int result, const unsigned char* end) {
+    for (unsigned int c = 0; c < 256; c++) {
+        if (set_has(&bs->pending, c)) {
+            bs->ends[c] = bracket_end(bs, c, result, end);
+        }
+    }
+    memset(&bs->pending, 0, sizeof(bs->pending));
+}
+
+static inline int bracket_done(const bracket_scan* bs) {
+    return (bs->pending.bits[0] | bs->pending.bits[1] | bs->pending.bits[2] | bs->pending.bits[3]) == 0;
+}
+
+/* 扫描p（'['之后）开始的方括号表达式，所有字节都确定后提前结束 */
+static void glob_bracket_scan(bracket_scan* bs, const unsigned char* p) {
+    const int icase = bs->icase;
+    byte_set set;
+    bs->negate = *p == '!' || *p == '^';
+    if (bs->negate) {
+        p++;
+    }
+    unsigned int c = *p++;
+    unsigned int cold;
+    while (!bracket_done(bs)) {
+        if (c == '\\') {
+            if (*p == '\0') {
+                bracket_finish(bs, 0, NULL);
+                return;
+            }
+            c = *p++;
+            goto normal;
+        } else if (c == '[' && *p == ':') {
+            const unsigned char* start = p;
+            size_t len = 0;
+            for (;;) {
+                c = *++p;
+                if (c == ':' && p[1] == ']') {
+                    p += 2;
+                    break;
+                }
+                if (c < 'a' || c >= 'z') {
+                    p = start;
+                    c = '[';
+                    goto normal;
+                }
+                len++;
+            }
+            memset(&set, 0, sizeof(set));
+            if (!set_add_class(&set, (const char*)start + 1, len)) {
+                bracket_finish(bs, 0, NULL);
+                return;
+            }
+            bracket_matched(bs, &set, p);
+            c = *p++;
+        } else if (c == '[' && *p == '=') {
+            if (p[1] == '\0' || p[2] != '=' || p[3] != ']') {
+                c = '[';
+                goto normal;
+            }
+            // 等价类与未折叠的字节比较
+            memset(&set, 0, sizeof(set));
+            set_add(&set, p[1]);
+            p += 4;
+            bracket_matched(bs, &set, p);
+            c = *p++;
+        } else if (c == '\0') {
+            bracket_finish(bs, -1, NULL);
+            return;
+        } else {
+            int is_range;
+            if (c == '[' && *p == '.') {
+                const unsigned char* start = p;
+                size_t len = 0;
+                for (;;) {
+                    c = *++p;
+                    if (c == '.' && p[1] == ']') {
+                        p += 2;
+                        break;
+                    }
+                    if (c == '\0') {
+                        bracket_finish(bs, 0, NULL);
+                        return;
+                    }
+                    len++;
+                }
+                if (len != 1) {
+                    bracket_finish(bs, 0, NULL);
+                    return;
+                }
+                is_range = *p == '-' && p[1] != '\0';
+                if (!is_range) {
+                    folded_range(&set, icase, start[1], start[1]);
+                    bracket_matched(bs, &set, p);
+                }
+                cold = start[1];
+                c = *p++;
+            } else {
+            normal:
+                c = fold_byte(icase, c);
+                is_range = *p == '-' && p[1] != '\0' && p[1] != ']';
+                if (!is_range) {
+                    folded_range(&set, icase, c, c);
+                    bracket_matched(bs, &set, p);
+                }
+                cold = c;
+                c = *p++;
+            }
+            if (c == '-' && *p != ']') {
+                unsigned int cend = *p++;
+                if (cend == '\\') {
+                    cend = *p++;
+                }
+                if (cend == '[' && *p == '.') {
+                    const unsigned char* start = p;
+                    size_t len = 0;
+                    for (;;) {
+                        c = *++p;
+                        if (c == '.' && p[1] == ']') {
+                            p += 2;
+                            break;
+                        }
+                        if (c == '\0') {
+                            bracket_finish(bs, 0, NULL);
+                            return;
+                        }
+                        len++;
+                    }
+                    if (len != 1) {
+                        bracket_finish(bs, 0, NULL);
+                        return;
+                    }
+                    cend = start[1];
+                } else if (cend == '\0') {
+                    bracket_finish(bs, 0, NULL);
+                    return;
+                }
+                cend = fold_byte(icase, cend);
+                if (cold <= cend) {
+                    folded_range(&set, icase, cold, cend);
+                    bracket_matched(bs, &set, p);
+                }
+                c = *p++;
+            }
+        }
+        if (c == ']') {
+            bracket_finish(bs, bs->negate ? 1 : 0, p);
+            return;
+        }
+    }
+}
+
+static int parse_glob_from(parser* ps, const unsigned char* p);
+
+/*
+ * 方括号表达式：按各字节能否匹配及表达式的结束位置分组。
+ * 通常只有一组；表达式没有结束时'['按普通字符匹配，从'['之后继续。
+ * 有多组时生成各组的分支，每个分支各自解析其余的模式，返回-2表示items已是整个模式。
+ */
+static int glob_bracket_node(parser* ps, const unsigned char* p) {
+    bracket_scan bs;
+    memset(&bs, 0, sizeof(bs));
+    bs.start = p;
+    bs.icase = ps->icase;
+    set_add_range(&bs.pending, 0, 255);
+    glob_bracket_scan(&bs, p);
+    const unsigned char* const* ends = bs.ends;
+    const unsigned char* groups[256];
+    int group_count = 0;
+    for (unsigned int ch = 0; ch < 256; ch++) {
+        const unsigned char* end = ends[ch];
+        int known = 0;
+        for (int g = 0; end != NULL && g < group_count; g++) {
+            known |= groups[g] == end;
+        }
+        if (end != NULL && !known) {
+            groups[group_count++] = end;
+        }
+    }
+    if (group_count <= 1) {
+        byte_set set = {{0}};
+        for (unsigned int ch = 0; ch < 256; ch++) {
+            if (ends[ch] != NULL) {
+                set_add(&set, ch);
+            }
+        }
+        int node = new_set_node(ps, set);
+        if (node < 0 || !push_item(ps, node)) {
+            return -1;
+        }
+        ps->pos = group_count == 1 ? groups[0] : ps->end;
+        return 0;
+    }
+    if (++ps->depth > MAX_DEPTH) {
+        return parse_fail(ps, ERR_PATTERN_TOO_LARGE, "嵌套层数过多");
+    }
+    int branches = ps->stack_count;
+    for (int g = 0; g < group_count; g++) {
+        byte_set set = {{0}};
+        for (unsigned int ch = 0; ch < 256; ch++) {
+            if (ends[ch] == groups[g]) {
+                set_add(&set, ch);
+            }
+        }
+        int items = ps->stack_count;
+        int node = new_set_node(ps, set);
+        if (node < 0 || !push_item(ps, node)) {
+            return -1;
+        }
+        int rest = parse_glob_from(ps, groups[g]);
+        if (rest < 0 || !push_item(ps, rest)) {
+            return -1;
+        }
+        int branch = make_list(ps, AST_CONCAT, items);
+        if (branch < 0 || !push_item(ps, branch)) {
+            return -1;
+        }
+    }
+    ps->depth--;
+    int alt = make_list(ps, AST_ALT, branches);
+    if (alt < 0 || !push_item(ps, alt)) {
+        return -1;
+    }
+    return -2;
+}
+
+/* 解析从p开始的其余glob模式，包括结尾的文本结束断言 */
+static int parse_glob_from(parser* ps, const unsigned char* p) {
+    int items = ps->stack_count;
+    ps->pos = p;
+    while (ps->pos < ps->end) {
+        unsigned int c = *ps->pos++;
+        int node;
+        if (c == '*') {
+            // 连续的*与一个相同
+            while (ps->pos < ps->end && *ps->pos == '*') {
+                ps->pos++;
+            }
+            byte_set any = {{0}};
+            set_add_range(&any, 0, 255);
+            int inner = new_set_node(ps, any);
+            node = inner < 0 ? -1 : new_repeat(ps, inner, 0, -1);
+        } else if (c == '?') {
+            byte_set any = {{0}};
+            set_add_range(&any, 0, 255);
+            node = new_set_node(ps, any);
+        } else if (c == '[') {
+            int result = glob_bracket_node(ps, ps->pos);
+            if (result == -2) {
+                return make_list(ps, AST_CONCAT, items);
+            }
+            if (result < 0) {
+                return -1;
+            }
+            continue;
+        } else if (c == '\\') {
+            // 模式末尾的\不匹配任何文本
+            if (ps->pos >= ps->end) {
+                byte_set none = {{0}};
+                node = new_set_node(ps, none);
+            } else {
+                node = new_byte_node(ps, *ps->pos++);
+            }
+        } else {
+            node = new_byte_node(ps, c);
+        }
+        if (node < 0 || !push_item(ps, node)) {
+            return -1;
+        }
+    }
+    int eol = new_node(ps, AST_EOL);
+    if (eol < 0 || !push_item(ps, eol)) {
+        return -1;
+    }
+    return make_list(ps, AST_CONCAT, items);
+}
+
+static int parse_glob(parser* ps) {
+    int items = ps->stack_count;
+    int bol = new_node(ps, AST_BOL);
+    if (bol < 0 || !push_item(ps, bol)) {
+        return -1;
+    }
+    int rest = parse_glob_from(ps, ps->pos);
+    if (rest < 0 || !push_item(ps, rest)) {
+        return -1;
+    }
+    return make_list(ps, AST_CONCAT, items);
+}
+
+/* ---------- NFA ---------- */
+
+typedef enum {
+    NFA_BYTES,         /* 读入属于集合set的字节后到out */
+    NFA_SPLIT,         /* 到out或out1，out优先 */
+    NFA_BOL,
+    NFA_EOL,
+    NFA_MATCH
+} nfa_kind;
+
+typedef struct {
+    nfa_kind kind;
+    int out;
+    int out1;
+    int set;
+} nfa_node;
+
+typedef struct {
+    nfa_node* nodes;
+    int count;
+    int cap;
+    int start;
+    int has_bol;       /* 含NFA_BOL节点，DFA状态需要区分是否在文本开头 */
+} nfa;
+
+static int nfa_add(nfa* g, nfa_kind kind, int out, int out1, int set) {
+    if (g->count >= MAX_NFA_NODES) {
+        return -1;
+    }
+    if (g->count == g->cap) {
+        int cap = g->cap > 0 ? g->cap * 2 : 64;
+        nfa_node* grown = (nfa_node*)realloc(g->nodes, (size_t)cap * sizeof(nfa_node));
+        if (grown == NULL) {
+            return -2;
+        }
+        g->nodes = grown;
+        g->cap = cap;
+    }
+    nfa_node* node = &g->nodes[g->count];
+    node->kind = kind;
+    node->out = out;
+    node->out1 = out1;
+    node->set = set;
+    g->has_bol |= kind == NFA_BOL;
+    return g->count++;
+}
+
+/*
+ * 从后向前构造：生成匹配ast后到next的片段，返回片段的入口；节点过多返回-1，内存不足返回-2。
+ * reverse时生成反向的NFA：序列倒序，文本开头与结尾的断言互换。
+ */
+static int nfa_build(nfa* g, const parser* ps, int ast, int next, int reverse) {
+    const ast_node* node = &ps->nodes[ast];
+    switch (node->kind) {
+    case AST_EMPTY:
+        return next;
+    case AST_SET:
+        return nfa_add(g, NFA_BYTES, next, -1, node->set);
+    case AST_BOL:
+        return nfa_add(g, reverse ? NFA_EOL : NFA_BOL, next, -1, 0);
+    case AST_EOL:
+        return nfa_add(g, reverse ? NFA_BOL : NFA_EOL, next, -1, 0);
+    case AST_CONCAT:
+        for (int i = 0; i < node->count; i++) {
+            int kid = ps->kids[node->first + (reverse ? i : node->count - 1 - i)];
+            next = nfa_build(g, ps, kid, next, reverse);
+            if (next < 0) {
+                return next;
+            }
+        }
+        return next;
+    case AST_ALT: {
+        // 从最后一个分支向前，每个分支之前加一个优先走该分支的SPLIT
+        int entry = nfa_build(g, ps, ps->kids[node->first + node->count - 1], next, reverse);
+        for (int i = node->count - 2; i >= 0 && entry >= 0; i--) {
+            int branch = nfa_build(g, ps, ps->kids[node->first + i], next, reverse);
+            if (branch < 0) {
+                return branch;
+            }
+            entry = nfa_add(g, NFA_SPLIT, branch, entry, 0);
+        }
+        return entry;
+    }
+    case AST_REPEAT: {
+        int cur = next;
+        if (node->max < 0) {
+            int loop = nfa_add(g, NFA_SPLIT, -1, next, 0);
+            if (loop < 0) {
+                return loop;
+            }
+            int body = nfa_build(g, ps, node->first, loop, reverse);
+            if (body < 0) {
+                return body;
+            }
+            g->nodes[loop].out = body;
+            cur = loop;
+        } else {
+            // x{0,k}展开为(x(x(...)?)?)?
+            for (int i = node->min; i < node->max; i++) {
+                int body = nfa_build(g, ps, node->first, cur, reverse);
+                if (body < 0) {
+                    return body;
+                }
+                cur = nfa_add(g, NFA_SPLIT, body, next, 0);
+                if (cur < 0) {
+                    return cur;
+                }
+            }
+        }
+        for (int i = 0; i < node->min; i++) {
+            cur = nfa_build(g, ps, node->first, cur, reverse);
+            if (cur < 0) {
+                return cur;
+            }
+        }
+        return cur;
+    }
+    }
+    return -1;
+}
+
+/* 模式是否以^开头：每个匹配都从文本开头开始，前向扫描不需要从每个位置开始尝试 */
+static int starts_anchored(const parser* ps, int ast) {
+    const ast_node* node = &ps->nodes[ast];
+    if (node->kind == AST_BOL) {
+        return 1;
+    }
+    if (node->kind == AST_CONCAT) {
+        return starts_anchored(ps, ps->kids[node->first]);
+    }
+    return 0;
+}
+
+/* 把每个匹配都以之开始的字面字节追加到buf，返回ast是否整个都是字面内容（之后可以继续追加） */
+static int literal_prefix(const parser* ps, int ast, unsigned char* buf, size_t* len) {
+    const ast_node* node = &ps->nodes[ast];
+    switch (node->kind) {
+    case AST_EMPTY:
+    case AST_BOL:
+    case AST_EOL:
+        return 1;
+    case AST_SET: {
+        int c = set_single(&ps->sets[node->set]);
+        if (c < 0 || *len >= MAX_PREFIX) {
+            return 0;
+        }
+        buf[(*len)++] = (unsigned char)c;
+        return 1;
+    }
+    case AST_CONCAT:
+        for (int i = 0; i < node->count; i++) {
+            if (!literal_prefix(ps, ps->kids[node->first + i], buf, len)) {
+                return 0;
+            }
+        }
+        return 1;
+    case AST_REPEAT:
+        if (node->min > 0) {
+            literal_prefix(ps, node->first, buf, len);
+        }
+        return 0;
+    case AST_ALT:
+        return 0;
+    }
+    return 0;
+}
+
+/* ---------- 惰性DFA ---------- */
+
+/* 扫描或构造状态时使用的临时空间 */
+typedef struct {
+    unsigned int* marks;
+    unsigned int generation;
+    int* stack;
+} scratch;
+
+/* 按优先级排列的线程，只含NFA_BYTES、NFA_EOL与NFA_MATCH节点 */
+typedef struct {
+    int* nodes;
+    int count;
+    int matched;
+    int stop;
+} thread_list;
+
+/*
+ * 状态分配后不再移动，除转移外也不再修改，读者可以不加锁地访问已发布的状态。
+ * 转移直接指向下一个状态并与状态放在一起，扫描每个字节只有一次相互依赖的读取。
+ */
+typedef struct dfa_state dfa_state;
+struct dfa_state {
+    int* nodes;
+    int count;
+    int at_start;
+    int flags;
+    uint32_t hash;
+    dfa_state* chain;          /* 同一散列桶中的下一个状态 */
+    dfa_state* all;            /* 所有状态的链表，用于释放 */
+    _Atomic(dfa_state*) next[];    /* 按字节类的转移，NULL为尚未计算 */
+};
+
+typedef struct {
+    const nfa* graph;
+    const byte_set* sets;
+    const uint8_t* reps;       /* 每个字节类的代表字节 */
+    int classes;
+    int start;
+    int first;                 /* 最左优先：线程到达MATCH后丢弃优先级更低的线程 */
+    pthread_mutex_t lock;
+    atomic_int full;
+    int count;
+    dfa_state* states;
+    dfa_state* dead;           /* 没有线程的状态，转移到它时扫描结束 */
+    dfa_state* buckets[HASH_BUCKETS];
+    scratch work;              /* 持有lock时使用 */
+    int* list_nodes;
+    dfa_state* init[2];        /* 不在/在文本开头时的初始状态 */
+} dfa;
+
+struct pattern {
+    int flags;
+    int anchored;
+    nfa forward;
+    nfa reverse;
+    byte_set* sets;
+    uint8_t classes[256];
+    uint8_t reps[256];
+    int class_count;
+    unsigned char prefix[MAX_PREFIX];
+    size_t prefix_len;
+    dfa scan;                  /* 前向、不锚定、最左优先：求最左匹配的某个结尾 */
+    dfa back;                  /* 反向、锚定、最长：由结尾求最左的起点 */
+    dfa longest;               /* 前向、锚定、最长：由起点求最长的结尾 */
+};
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+static int has_avx2 = 0;
+
+static void init_tables(void) {
+    __builtin_cpu_init();
+    has_avx2 = __builtin_cpu_supports("avx2");
+}
+
+static inline void ensure_tables(void) {
+    pthread_once(&tables_once, init_tables);
+}
+
+static int scratch_init(scratch* s, int nodes) {
+    s->marks = (unsigned int*)calloc((size_t)nodes, sizeof(unsigned int));
+    s->stack = (int*)malloc((size_t)(2 * nodes + 1) * sizeof(int));
+    s->generation = 0;
+    return s->marks != NULL && s->stack != NULL;
+}
+
+static void scratch_free(scratch* s) {
+    free(s->marks);
+    free(s->stack);
+}
+
+static void scratch_next(scratch* s, int nodes) {
+    if (++s->generation == 0) {
+        memset(s->marks, 0, (size_t)nodes * sizeof(unsigned int));
+        s->generation = 1;
+    }
+}
+
+/* 把从node经ε转移可达的节点按优先级追加到list */
+static void add_closure(const dfa* d, int node, int at_start, thread_list* list, scratch* s) {
+    const nfa_node* nodes = d->graph->nodes;
+    int top = 0;
+    s->stack[top++] = node;
+    while (top > 0) {
+        int n = s->stack[--top];
+        if (s->marks[n] == s->generation) {
+            continue;
+        }
+        s->marks[n] = s->generation;
+        switch (nodes[n].kind) {
+        case NFA_SPLIT:
+            s->stack[top++] = nodes[n].out1;
+            s->stack[top++] = nodes[n].out;
+            break;
+        case NFA_BOL:
+            if (at_start) {
+                s->stack[top++] = nodes[n].out;
+            }
+            break;
+        case NFA_MATCH:
+            list->nodes[list->count++] = n;
+            list->matched = 1;
+            if (d->first) {
+                list->stop = 1;
+                return;
+            }
+            break;
+        default:
+            list->nodes[list->count++] = n;
+            break;
+        }
+    }
+}
+
+/* in中的线程读入字节c后的线程 */
+static void step_threads(const dfa* d, const int* in, int count, unsigned int c, thread_list* out, scratch* s) {
+    const nfa_node* nodes = d->graph->nodes;
+    out->count = 0;
+    out->matched = 0;
+    out->stop = 0;
+    scratch_next(s, d->graph->count);
+    for (int i = 0; i < count && !out->stop; i++) {
+        const nfa_node* node = &nodes[in[i]];
+        if (node->kind == NFA_BYTES && set_has(&d->sets[node->set], c)) {
+            add_closure(d, node->out, 0, out, s);
+        }
+    }
+}
+
+/* 在文本结尾时是否有线程匹配：等待$的线程越过$后能否到达MATCH */
+static int match_at_end(const dfa* d, const int* list, int count, int at_start, scratch* s) {
+    const nfa_node* nodes = d->graph->nodes;
+    scratch_next(s, d->graph->count);
+    for (int i = 0; i < count; i++) {
+        if (nodes[list[i]].kind == NFA_MATCH) {
+            return 1;
+        }
+        if (nodes[list[i]].kind != NFA_EOL) {
+            continue;
+        }
+        int top = 0;
+        s->stack[top++] = list[i];
+        while (top > 0) {
+            int n = s->stack[--top];
+            if (s->marks[n] == s->generation) {
+                continue;
+            }
+            s->marks[n] = s->generation;
+            switch (nodes[n].kind) {
+            case NFA_MATCH:
+                return 1;
+            case NFA_SPLIT:
+                s->stack[top++] = nodes[n].out1;
+                s->stack[top++] = nodes[n].out;
+                break;
+            case NFA_EOL:
+                s->stack[top++] = nodes[n].out;
+                break;
+            case NFA_BOL:
+                if (at_start) {
+                    s->stack[top++] = nodes[n].out;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+static uint32_t list_hash(const int* nodes, int count, int at_start) {
+    uint32_t h = 2166136261u ^ (uint32_t)at_start;
+    for (int i = 0; i < count; i++) {
+        h = (h ^ (uint32_t)nodes[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* 分配状态并加入所有状态的链表，转移都尚未计算 */
+static dfa_state* new_state(dfa* d, const int* nodes, int count) {
+    dfa_state* s = (dfa_state*)malloc(sizeof(dfa_state) + (size_t)d->classes * sizeof(s->next[0]) +
+                                      (size_t)count * sizeof(int));
+    if (s == NULL) {
+        return NULL;
+    }
+    memset(s, 0, sizeof(*s));
+    for (int c = 0; c < d->classes; c++) {
+        atomic_init(&s->next[c], NULL);
+    }
+    s->nodes = (int*)(s->next + d->classes);
+    if (count > 0) {
+        memcpy(s->nodes, nodes, (size_t)count * sizeof(int));
+    }
+    s->count = count;
+    s->all = d->states;
+    d->states = s;
+    d->count++;
+    return s;
+}
+
+/* 查找或加入线程列表对应的状态，持有lock时调用；列表为空返回死状态，状态数达到上限返回NULL */
+static dfa_state* intern_state(dfa* d, const thread_list* list, int at_start) {
+    if (list->count == 0) {
+        return d->dead;
+    }
+    at_start = at_start && d->graph->has_bol;
+    uint32_t hash = list_hash(list->nodes, list->count, at_start);
+    dfa_state** bucket = &d->buckets[hash & (HASH_BUCKETS - 1)];
+    for (dfa_state* s = *bucket; s != NULL; s = s->chain) {
+        if (s->hash == hash && s->count == list->count && s->at_start == at_start &&
+            memcmp(s->nodes, list->nodes, (size_t)list->count * sizeof(int)) == 0) {
+            return s;
+        }
+    }
+    if (d->count >= MAX_STATES) {
+        return NULL;
+    }
+    dfa_state* s = new_state(d, list->nodes, list->count);
+    if (s == NULL) {
+        return NULL;
+    }
+    s->at_start = at_start;
+    s->hash = hash;
+    s->flags = list->matched ? STATE_MATCH | STATE_MATCH_END : 0;
+    if (match_at_end(d, list->nodes, list->count, at_start, &d->work)) {
+        s->flags |= STATE_MATCH_END;
+    }
+    s->chain = *bucket;
+    *bucket = s;
+    return s;
+}
+
+/* 计算并发布s读入字节类cls后的状态；缓存已满时返回NULL，由调用者改为逐列表模拟 */
+static dfa_state* dfa_fill(dfa* d, dfa_state* s, int cls) {
+    if (atomic_load_explicit(&d->full, memory_order_relaxed)) {
+        return NULL;
+    }
+    pthread_mutex_lock(&d->lock);
+    dfa_state* next = atomic_load_explicit(&s->next[cls], memory_order_relaxed);
+    if (next == NULL) {
+        thread_list list = {d->list_nodes, 0, 0, 0};
+        step_threads(d, s->nodes, s->count, d->reps[cls], &list, &d->work);
+        next = intern_state(d, &list, 0);
+        if (next != NULL) {
+            atomic_store_explicit(&s->next[cls], next, memory_order_release);
+        } else {
+            atomic_store_explicit(&d->full, 1, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&d->lock);
+    return next;
+}
+
+static inline dfa_state* dfa_next(dfa* d, dfa_state* s, int cls) {
+    dfa_state* next = atomic_load_explicit(&s->next[cls], memory_order_acquire);
+    return next != NULL ? next : dfa_fill(d, s, cls);
+}
+
+static int dfa_init(dfa* d, const pattern* p, const nfa* graph, int start, int first) {
+    memset(d, 0, sizeof(*d));
+    d->graph = graph;
+    d->sets = p->sets;
+    d->reps = p->reps;
+    d->classes = p->class_count;
+    d->start = start;
+    d->first = first;
+    pthread_mutex_init(&d->lock, NULL);
+    atomic_init(&d->full, 0);
+    d->list_nodes = (int*)malloc((size_t)graph->count * sizeof(int));
+    d->dead = new_state(d, NULL, 0);
+    if (d->list_nodes == NULL || d->dead == NULL || !scratch_init(&d->work, graph->count)) {
+        return 0;
+    }
+    for (int c = 0; c < d->classes; c++) {
+        atomic_init(&d->dead->next[c], d->dead);
+    }
+    for (int at_start = 0; at_start <= 1; at_start++) {
+        thread_list list = {d->list_nodes, 0, 0, 0};
+        scratch_next(&d->work, graph->count);
+        add_closure(d, start, at_start, &list, &d->work);
+        d->init[at_start] = intern_state(d, &list, at_start);
+        if (d->init[at_start] == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void dfa_destroy(dfa* d) {
+    while (d->states != NULL) {
+        dfa_state* next = d->states->all;
+        free(d->states);
+        d->states = next;
+    }
+    scratch_free(&d->work);
+    free(d->list_nodes);
+    pthread_mutex_destroy(&d->lock);
+}
+
+/*
+ * 缓存已满时从state的线程列表开始逐字节模拟NFA，direction为1时向前读text[pos]，为-1时向后读text[pos - 1]，
+ * 直到limit。found、last为已有的结果，返回是否找到匹配。
+ */
+static int simulate(dfa* d, const dfa_state* state, const unsigned char* text, size_t pos, size_t limit,
+                    int direction, int end_ok, int stop_first, size_t* last, int found) {
+    int nodes = d->graph->count;
+    scratch s;
+    int* lists = (int*)malloc((size_t)nodes * 2 * sizeof(int));
+    if (lists == NULL || !scratch_init(&s, nodes)) {
+        error_log(ERR_PATTERN_ALLOC, "内存分配失败");
+        free(lists);
+        scratch_free(&s);
+        return found;
+    }
+    thread_list cur = {lists, state->count, 0, 0};
+    thread_list next = {lists + nodes, 0, 0, 0};
+    memcpy(cur.nodes, state->nodes, (size_t)state->count * sizeof(int));
+    while (pos != limit) {
+        unsigned int c = direction > 0 ? text[pos] : text[pos - 1];
+        pos += (size_t)(ptrdiff_t)direction;
+        step_threads(d, cur.nodes, cur.count, c, &next, &s);
+        thread_list swap = cur;
+        cur = next;
+        next = swap;
+        if (cur.count == 0) {
+            break;
+        }
+        if (cur.matched) {
+            *last = pos;
+            found = 1;
+            if (stop_first) {
+                break;
+            }
+        }
+    }
+    if (pos == limit && cur.count > 0 && end_ok && !(stop_first && found) &&
+        match_at_end(d, cur.nodes, cur.count, 0, &s)) {
+        *last = pos;
+        found = 1;
+    }
+    free(lists);
+    scratch_free(&s);
+    return found;
+}
+
+/* ---------- 字面前缀查找 ---------- */
+
+static const unsigned char* find_prefix_scalar(const unsigned char* text, size_t len, const unsigned char* needle,
+                                               size_t m) {
+    const unsigned char* end = text + len;
+    while ((size_t)(end - text) >= m) {
+        const unsigned char* hit = (const unsigned char*)memchr(text, needle[0], (size_t)(end - text) - m + 1);
+        if (hit == NULL) {
+            return NULL;
+        }
+        if (memcmp(hit + 1, needle + 1, m - 1) == 0) {
+            return hit;
+        }
+        text = hit + 1;
+    }
+    return NULL;
+}
+
+/* 每次比较32个位置的首字节与末字节，两者都相同的位置再比较中间的字节 */
+__attribute__((target("avx2")))
+static const unsigned char* find_prefix_avx2(const unsigned char* text, size_t len, const unsigned char* needle,
+                                             size_t m) {
+    const __m256i first = _mm256_set1_epi8((char)needle[0]);
+    const __m256i last = _mm256_set1_epi8((char)needle[m - 1]);
+    size_t i = 0;
+    for (; i + m + 31 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(text + i + m - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+        while (mask != 0) {
+            size_t at = i + (size_t)__builtin_ctz(mask);
+            if (memcmp(text + at + 1, needle + 1, m - 2) == 0) {
+                return text + at;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return find_prefix_scalar(text + i, len - i, needle, m);
+}
+
+/* 查找字面前缀在text[0, len)中第一次出现的位置 */
+static inline const unsigned char* find_prefix(const pattern* p, const unsigned char* text, size_t len) {
+    if (p->prefix_len == 1) {
+        return (const unsigned char*)memchr(text, p->prefix[0], len);
+    }
+    if (has_avx2) {
+        return find_prefix_avx2(text, len, p->prefix, p->prefix_len);
+    }
+    return find_prefix_scalar(text, len, p->prefix, p->prefix_len);
+}
+
+/* ---------- 扫描 ---------- */
+
+/*
+ * 从pos向前扫描到len，*last记录最后一个匹配结束的位置，stop_first时找到第一个即返回。
+ * 扫描不锚定的前向DFA且处在初始状态时，用字面前缀跳到下一个可能开始匹配的位置。
+ */
+static int scan_forward(const pattern* p, dfa* d, const unsigned char* text, size_t pos, size_t len, int at_start,
+                        int stop_first, size_t* last) {
+    const uint8_t* classes = p->classes;
+    const dfa_state* skip_state = d == &p->scan && p->prefix_len > 0 && !p->anchored ? d->init[0] : NULL;
+    const dfa_state* dead = d->dead;
+    dfa_state* s = d->init[at_start ? 1 : 0];
+    int found = 0;
+    if (s == dead) {
+        return 0;
+    }
+    for (;;) {
+        if (s->flags & STATE_MATCH) {
+            *last = pos;
+            found = 1;
+            if (stop_first) {
+                return 1;
+            }
+        }
+        if (pos == len) {
+            break;
+        }
+        if (s == skip_state) {
+            const unsigned char* hit = find_prefix(p, text + pos, len - pos);
+            if (hit == NULL) {
+                return found;
+            }
+            pos = (size_t)(hit - text);
+        }
+        dfa_state* next = atomic_load_explicit(&s->next[classes[text[pos]]], memory_order_acquire);
+        if (next == NULL) {
+            next = dfa_fill(d, s, classes[text[pos]]);
+            if (next == NULL) {
+                return simulate(d, s, text, pos, len, 1, 1, stop_first, last, found);
+            }
+        }
+        pos++;
+        if (next == dead) {
+            return found;
+        }
+        s = next;
+    }
+    if (s->flags & STATE_MATCH_END) {
+        *last = len;
+        found = 1;
+    }
+    return found;
+}
+
+/* 从pos向后扫描到limit（读text[pos - 1]），*last记录最后一个匹配的位置；end_ok表示limit处$（原模式的^）成立 */
+static int scan_backward(const pattern* p, dfa* d, const unsigned char* text, size_t pos, size_t limit,
+                         int at_start, int end_ok, size_t* last) {
+    const uint8_t* classes = p->classes;
+    const dfa_state* dead = d->dead;
+    dfa_state* s = d->init[at_start ? 1 : 0];
+    int found = 0;
+    if (s == dead) {
+        return 0;
+    }
+    for (;;) {
+        if (s->flags & STATE_MATCH) {
+            *last = pos;
+            found = 1;
+        }
+        if (pos == limit) {
+            break;
+        }
+        dfa_state* next = dfa_next(d, s, classes[text[pos - 1]]);
+        if (next == NULL) {
+            return simulate(d, s, text, pos, limit, -1, end_ok, 0, last, found);
+        }
+        pos--;
+        if (next == dead) {
+            return found;
+        }
+        s = next;
+    }
+    if (end_ok && (s->flags & STATE_MATCH_END)) {
+        *last = limit;
+        found = 1;
+    }
+    return found;
+}
+
+/* ---------- 接口 ---------- */
+
+/* 按所有集合的成员边界把256个字节分为等价类，同一类中的字节在任何集合中的归属都相同 */
+static void build_classes(pattern* p, int set_count) {
+    int cls = 0;
+    p->classes[0] = 0;
+    p->reps[0] = 0;
+    for (unsigned int c = 1; c < 256; c++) {
+        int boundary = 0;
+        for (int i = 0; i < set_count && !boundary; i++) {
+            boundary = set_has(&p->sets[i], c) != set_has(&p->sets[i], c - 1);
+        }
+        if (boundary) {
+            p->reps[++cls] = (uint8_t)c;
+        }
+        p->classes[c] = (uint8_t)cls;
+    }
+    p->class_count = cls + 1;
+}
+
+static error_code build_nfa(nfa* g, const parser* ps, int root, int reverse, int unanchored) {
+    int match = nfa_add(g, NFA_MATCH, -1, -1, 0);
+    int start = match < 0 ? match : nfa_build(g, ps, root, match, reverse);
+    if (start >= 0 && unanchored) {
+        // 前面加一个非贪婪的任意字节循环，使匹配可以从任何位置开始，越早开始的线程优先
+        int loop = nfa_add(g, NFA_SPLIT, start, -1, ps->set_count);
+        int any = loop < 0 ? loop : nfa_add(g, NFA_BYTES, loop, -1, ps->set_count);
+        if (any >= 0) {
+            g->nodes[loop].out1 = any;
+        }
+        start = any < 0 ? any : loop;
+    }
+    if (start == -1) {
+        return ERR_PATTERN_TOO_LARGE;
+    }
+    if (start < 0) {
+        return ERR_PATTERN_ALLOC;
+    }
+    g->start = start;
+    return ERR_OK;
+}
+
+static void parser_free(parser* ps) {
+    free(ps->nodes);
+    free(ps->kids);
+    free(ps->stack);
+    free(ps->sets);
+}
+
+error_code pattern_compile(const char* source, int flags, pattern** out) {
+    debug_print("编译模式");
+    if (source == NULL || out == NULL) {
+        return error_raise(ERR_PATTERN_NULL, "参数为NULL");
+    }
+    *out = NULL;
+    parser ps;
+    memset(&ps, 0, sizeof(ps));
+    ps.pos = (const unsigned char*)source;
+    ps.end = ps.pos + strlen(source);
+    ps.icase = (flags & PATTERN_ICASE) != 0;
+    int root;
+    if ((flags & PATTERN_GLOB) && ps.end - ps.pos > MAX_GLOB_LENGTH) {
+        root = parse_fail(&ps, ERR_PATTERN_TOO_LARGE, "glob模式过长");
+    } else {
+        root = (flags & PATTERN_GLOB) ? parse_glob(&ps) : parse_alternation(&ps);
+    }
+    if (root >= 0 && ps.pos < ps.end) {
+        root = parse_fail(&ps, ERR_PATTERN_SYNTAX, "括号不匹配");
+    }
+    // 前向扫描的任意字节循环使用的集合放在最后
+    byte_set any = {{0}};
+    set_add_range(&any, 0, 255);
+    if (root >= 0 && reserve(&ps, (void**)&ps.sets, &ps.set_cap, ps.set_count + 1, sizeof(byte_set))) {
+        ps.sets[ps.set_count] = any;
+    }
+    if (ps.error != ERR_OK) {
+        error_log_detail(ps.error, ps.message, source);
+        error_code code = ps.error;
+        parser_free(&ps);
+        return code;
+    }
+
+    pattern* p = (pattern*)calloc(1, sizeof(pattern));
+    if (p == NULL) {
+        parser_free(&ps);
+        return error_raise(ERR_PATTERN_ALLOC, "内存分配失败");
+    }
+    p->flags = flags;
+    p->anchored = starts_anchored(&ps, root);
+    literal_prefix(&ps, root, p->prefix, &p->prefix_len);
+    p->sets = ps.sets;
+    ps.sets = NULL;
+    build_classes(p, ps.set_count);
+
+    error_code code = build_nfa(&p->forward, &ps, root, 0, !p->anchored);
+    if (code == ERR_OK) {
+        code = build_nfa(&p->reverse, &ps, root, 1, 0);
+    }
+    parser_free(&ps);
+    if (code != ERR_OK) {
+        free(p->forward.nodes);
+        free(p->reverse.nodes);
+        free(p->sets);
+        free(p);
+        return error_raise(code, code == ERR_PATTERN_TOO_LARGE ? "模式展开后过大" : "内存分配失败");
+    }
+
+    // 锚定的前向扫描从模式本身开始，不经过任意字节循环
+    int body = p->anchored ? p->forward.start : p->forward.nodes[p->forward.start].out;
+    int ok = dfa_init(&p->scan, p, &p->forward, p->forward.start, 1);
+    ok = dfa_init(&p->back, p, &p->reverse, p->reverse.start, 0) && ok;
+    ok = dfa_init(&p->longest, p, &p->forward, body, 0) && ok;
+    if (!ok) {
+        pattern_free(p);
+        return error_raise(ERR_PATTERN_ALLOC, "内存分配失败");
+    }
+    ensure_tables();
+    *out = p;
+    return ERR_OK;
+}
+
+void pattern_free(pattern* p) {
+    if (p == NULL) {
+        return;
+    }
+    dfa_destroy(&p->scan);
+    dfa_destroy(&p->back);
+    dfa_destroy(&p->longest);
+    free(p->forward.nodes);
+    free(p->reverse.nodes);
+    free(p->sets);
+    free(p);
+}
+
+int pattern_match(const pattern* p, const char* text, size_t len) {
+    if (p == NULL || (text == NULL && len > 0)) {
+        return 0;
+    }
+    size_t end;
+    return scan_forward(p, (dfa*)&p->scan, (const unsigned char*)text, 0, len, 1, 1, &end);
+}
+
+int pattern_search(const pattern* p, const char* text, size_t len, size_t from, pattern_span* span) {
+    if (p == NULL || (text == NULL && len > 0) || from > len) {
+        return 0;
+    }
+    const unsigned char* t = (const unsigned char*)text;
+    size_t end = from;
+    if (!scan_forward(p, (dfa*)&p->scan, t, from, len, from == 0, span == NULL, &end)) {
+        return 0;
+    }
+    if (span == NULL) {
+        return 1;
+    }
+    // end是最左开始的某个匹配的结尾，由它反向求最左的起点，再从起点求最长的结尾
+    size_t start = end;
+    scan_backward(p, (dfa*)&p->back, t, end, from, end == len, from == 0, &start);
+    size_t longest = end;
+    scan_forward(p, (dfa*)&p->longest, t, start, len, start == 0, 0, &longest);
+    span->start = start;
+    span->end = longest;
+    return 1;
+}
+
+error_code pattern_filter_lines(const pattern* p, const char* text, size_t len, pattern_line_fn fn, void* ctx,
+                                size_t* count) {
+    debug_print("逐行匹配文本");
+    if (count != NULL) {
+        *count = 0;
+    }
+    if (p == NULL || (text == NULL && len > 0)) {
+        return error_raise(ERR_PATTERN_NULL, "参数为NULL");
+    }
+    size_t matched = 0;
+    error_code code = ERR_OK;
+    size_t pos = 0;
+    while (pos < len) {
+        size_t line = pos;
+        if (p->prefix_len > 0) {
+            // 只检查含有字面前缀的行
+            const unsigned char* hit = find_prefix(p, (const unsigned char*)text + pos, len - pos);
+            if (hit == NULL) {
+                break;
+            }
+            const char* newline = (const char*)memrchr(text + pos, '\n', (size_t)((const char*)hit - text) - pos);
+            line = newline != NULL ? (size_t)(newline - text) + 1 : pos;
+        }
+        const char* newline = (const char*)memchr(text + line, '\n', len - line);
+        size_t line_end = newline != NULL ? (size_t)(newline - text) : len;
+        if (pattern_match(p, text + line, line_end - line)) {
+            matched++;
+            if (fn != NULL && (code = fn(text + line, line_end - line, ctx)) != ERR_OK) {
+                break;
+            }
+        }
+        pos = line_end + 1;
+    }
+    if (count != NULL) {
+        *count = matched;
+    }
+    return code;
+}
+
+static int module_init(void) {
+    ensure_tables();
+    debug_print(has_avx2 ? "模式匹配模块初始化成功，前缀查找使用AVX2" : "模式匹配模块初始化成功");
+    return 1;
+}
+
+int initialize_pattern_ops() {
+    return module_init_once(MODULE_PATTERN, module_init);
+}
\ No newline at end of file
@@ -0,0 +1,573 @@
+/**
+ * @file rope_ops.c
+ * @brief 文本编辑结构实现
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/uio.h>
+#include "../include/rope_ops.h"
+#include "../include/module.h"
+#include "../include/utils.h"
+#include "../include/allocator.h"
+
+/* 追加块的大小；不小于其一半的插入单独占一个块，不打断当前追加块 */
+#define CHUNK_SIZE (64 * 1024)
+/* writev一次提交的片段数，Linux的IOV_MAX */
+#define WRITE_BATCH 1024
+/* 短于该字节数的片段写出前先复制到连续的暂存区，避免writev逐项处理大量很短的片段 */
+#define SMALL_PIECE 512
+#define STAGING_SIZE (64 * 1024)
+
+/**
+ * 只读文本块：已写入的[0, used)不再改变，由片段与所属rope的tail按引用计数共享。
+ * 只有把它作为tail的rope会在used之后追加，所以不同rope之间不会写同一处。
+ */
+struct rope_chunk {
+    atomic_size_t refs;
+    size_t used;
+    size_t capacity;
+    char* data;            /* 内部块指向结构之后的空间，外部块指向rope_append_owned的缓冲区 */
+    int external;
+};
+
+/* treap节点：按中序为文本中的片段顺序，priority满足大根堆 */
+struct rope_node {
+    rope_node* left;
+    rope_node* right;
+    rope_chunk* chunk;
+    size_t offset;         /* 片段在块中的起始位置 */
+    size_t len;            /* 片段字节数，大于0 */
+    size_t total;          /* 子树的文本字节数 */
+    uint32_t priority;
+};
+
+/* ---------- 文本块 ---------- */
+
+static rope_chunk* chunk_create(size_t capacity) {
+    rope_chunk* chunk = (rope_chunk*)malloc(sizeof(rope_chunk) + capacity);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    atomic_init(&chunk->refs, 1);
+    chunk->used = 0;
+    chunk->capacity = capacity;
+    chunk->data = (char*)(chunk + 1);
+    chunk->external = 0;
+    return chunk;
+}
+
+static void chunk_retain(rope_chunk* chunk) {
+    atomic_fetch_add_explicit(&chunk->refs, 1, memory_order_relaxed);
+}
+
+static void chunk_release(rope_chunk* chunk) {
+    if (chunk != NULL && atomic_fetch_sub_explicit(&chunk->refs, 1, memory_order_acq_rel) == 1) {
+        if (chunk->external) {
+            mem_free(chunk->data);
+        }
+        free(chunk);
+    }
+}
+
+/* ---------- treap ---------- */
+
+static size_t subtree_total(const rope_node* node) {
+    return node != NULL ? node->total : 0;
+}
+
+static void update(rope_node* node) {
+    node->total = subtree_total(node->left) + node->len + subtree_total(node->right);
+}
+
+static uint32_t next_priority(rope* r) {
+    // xorshift64*
+    r->seed ^= r->seed >> 12;
+    r->seed ^= r->seed << 25;
+    r->seed ^= r->seed >> 27;
+    return (uint32_t)((r->seed * 0x2545f4914f6cdd1dULL) >> 32);
+}
+
+static rope_node* node_create(rope* r) {
+    rope_node* node = (rope_node*)malloc(sizeof(rope_node));
+    if (node != NULL) {
+        node->left = NULL;
+        node->right = NULL;
+        node->chunk = NULL;
+        node->priority = next_priority(r);
+    }
+    return node;
+}
+
+/* 释放子树及其片段对文本块的引用，返回片段数 */
+static size_t free_tree(rope_node* node) {
+    size_t count = 0;
+    while (node != NULL) {
+        count += free_tree(node->left);
+        rope_node* right = node->right;
+        chunk_release(node->chunk);
+        free(node);
+        node = right;
+        count++;
+    }
+    return count;
+}
+
+static rope_node* merge(rope_node* a, rope_node* b) {
+    if (a == NULL) {
+        return b;
+    }
+    if (b == NULL) {
+        return a;
+    }
+    if (a->priority >= b->priority) {
+        a->right = merge(a->right, b);
+        update(a);
+        return a;
+    }
+    b->left = merge(a, b->left);
+    update(b);
+    return b;
+}
+
+/**
+ * 按位置把子树分为[0, pos)与[pos, total)。pos落在片段内部时把片段切为两段，
+ * 后一段使用*spare（之后置为NULL），并以新的优先级合并到右侧，避免同一片段切出的节点优先级相同而退化成链。
+ */
+static void split(rope_node* node, size_t pos, rope_node** left, rope_node** right, rope_node** spare) {
+    if (node == NULL) {
+        *left = NULL;
+        *right = NULL;
+        return;
+    }
+    size_t before = subtree_total(node->left);
+    if (pos <= before) {
+        split(node->left, pos, left, &node->left, spare);
+        update(node);
+        *right = node;
+    } else if (pos >= before + node->len) {
+        split(node->right, pos - before - node->len, &node->right, right, spare);
+        update(node);
+        *left = node;
+    } else {
+        size_t cut = pos - before;
+        rope_node* tail = *spare;
+        *spare = NULL;
+        tail->chunk = node->chunk;
+        chunk_retain(tail->chunk);
+        tail->offset = node->offset + cut;
+        tail->len = node->len - cut;
+        update(tail);
+        rope_node* rest = node->right;
+        node->len = cut;
+        node->right = NULL;
+        update(node);
+        *left = node;
+        *right = merge(tail, rest);
+    }
+}
+
+/* 若在pos处结束的片段正好以tail的已写入部分结尾且tail还有len字节空间，就地延长该片段 */
+static int extend(rope_node* node, size_t pos, rope_chunk* tail, const char* text, size_t len) {
+    if (node == NULL) {
+        return 0;
+    }
+    size_t before = subtree_total(node->left);
+    int extended;
+    if (pos <= before) {
+        extended = extend(node->left, pos, tail, text, len);
+    } else if (pos < before + node->len) {
+        extended = 0;
+    } else if (pos == before + node->len) {
+        extended = node->chunk == tail && node->offset + node->len == tail->used &&
+                   tail->capacity - tail->used >= len;
+        if (extended) {
+            memcpy(tail->data + tail->used, text, len);
+            tail->used += len;
+            node->len += len;
+        }
+    } else {
+        extended = extend(node->right, pos - before - node->len, tail, text, len);
+    }
+    if (extended) {
+        node->total += len;
+    }
+    return extended;
+}
+
+/* 复制子树中[pos, pos + len)的文本 */
+static void copy_range(const rope_node* node, size_t pos, size_t len, char* out) {
+    while (node != NULL && len > 0) {
+        size_t before = subtree_total(node->left);
+        if (pos < before) {
+            size_t n = before - pos < len ? before - pos : len;
+            copy_range(node->left, pos, n, out);
+            out += n;
+            len -= n;
+            pos = before;
+        }
+        if (len == 0) {
+            return;
+        }
+        if (pos < before + node->len) {
+            size_t offset = pos - before;
+            size_t n = node->len - offset < len ? node->len - offset : len;
+            memcpy(out, node->chunk->data + node->offset + offset, n);
+            out += n;
+            len -= n;
+            pos += n;
+        }
+        pos -= before + node->len;
+        node = node->right;
+    }
+}
+
+static error_code visit(const rope_node* node, rope_piece_fn fn, void* ctx) {
+    while (node != NULL) {
+        error_code code = visit(node->left, fn, ctx);
+        if (code == ERR_OK) {
+            code = fn(node->chunk->data + node->offset, node->len, ctx);
+        }
+        if (code != ERR_OK) {
+            return code;
+        }
+        node = node->right;
+    }
+    return ERR_OK;
+}
+
+/* ---------- 编辑 ---------- */
+
+void rope_init(rope* r) {
+    r->root = NULL;
+    r->length = 0;
+    r->pieces = 0;
+    r->tail = NULL;
+    r->seed = 0x9e3779b97f4a7c15ULL ^ (uint64_t)(uintptr_t)r;
+}
+
+void rope_free(rope* r) {
+    if (r == NULL) {
+        return;
+    }
+    free_tree(r->root);
+    chunk_release(r->tail);
+    rope_init(r);
+}
+
+/* 在pos处插入已写入块中的片段，node与spare已分配 */
+static void insert_piece(rope* r, size_t pos, rope_node* node, rope_node* spare) {
+    rope_node* left;
+    rope_node* right;
+    split(r->root, pos, &left, &right, &spare);
+    r->root = merge(merge(left, node), right);
+    r->length += node->len;
+    r->pieces += spare == NULL ? 2 : 1;
+    free(spare);
+}
+
+error_code rope_insert(rope* r, size_t pos, const char* text, size_t len) {
+    if (r == NULL || (text == NULL && len > 0)) {
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    if (pos > r->length) {
+        return error_raise(ERR_ROPE_RANGE, "插入位置超出文本长度");
+    }
+    if (len == 0) {
+        return ERR_OK;
+    }
+    if (r->tail != NULL && extend(r->root, pos, r->tail, text, len)) {
+        r->length += len;
+        return ERR_OK;
+    }
+    rope_node* node = node_create(r);
+    rope_node* spare = node_create(r);
+    if (node == NULL || spare == NULL) {
+        free(node);
+        free(spare);
+        return error_raise(ERR_ROPE_ALLOC, "内存分配失败");
+    }
+    rope_chunk* chunk = r->tail;
+    if (chunk == NULL || chunk->capacity - chunk->used < len) {
+        chunk = chunk_create(len >= CHUNK_SIZE / 2 ? len : CHUNK_SIZE);
+        if (chunk == NULL) {
+            free(node);
+            free(spare);
+            return error_raise(ERR_ROPE_ALLOC, "内存分配失败");
+        }
+        if (len < CHUNK_SIZE / 2) {
+            // 换用新的追加块；旧块只由其中的片段引用
+            chunk_release(r->tail);
+            r->tail = chunk;
+            chunk_retain(chunk);
+        }
+    } else {
+        chunk_retain(chunk);
+    }
+    memcpy(chunk->data + chunk->used, text, len);
+    node->chunk = chunk;
+    node->offset = chunk->used;
+    node->len = len;
+    update(node);
+    chunk->used += len;
+    insert_piece(r, pos, node, spare);
+    return ERR_OK;
+}
+
+error_code rope_append(rope* r, const char* text, size_t len) {
+    if (r == NULL) {
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    return rope_insert(r, r->length, text, len);
+}
+
+error_code rope_append_owned(rope* r, char* text, size_t len) {
+    debug_print("追加文本缓冲区");
+    if (r == NULL || text == NULL) {
+        mem_free(text);
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    if (len == 0) {
+        mem_free(text);
+        return ERR_OK;
+    }
+    rope_chunk* chunk = (rope_chunk*)malloc(sizeof(rope_chunk));
+    rope_node* node = node_create(r);
+    if (chunk == NULL || node == NULL) {
+        free(chunk);
+        free(node);
+        mem_free(text);
+        return error_raise(ERR_ROPE_ALLOC, "内存分配失败");
+    }
+    atomic_init(&chunk->refs, 1);
+    chunk->used = len;
+    chunk->capacity = len + 1;
+    chunk->data = text;
+    chunk->external = 1;
+    node->chunk = chunk;
+    node->offset = 0;
+    node->len = len;
+    update(node);
+    r->root = merge(r->root, node);
+    r->length += len;
+    r->pieces++;
+    return ERR_OK;
+}
+
+error_code rope_delete(rope* r, size_t pos, size_t len) {
+    if (r == NULL) {
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    if (pos > r->length || len > r->length - pos) {
+        return error_raise(ERR_ROPE_RANGE, "删除范围超出文本长度");
+    }
+    if (len == 0) {
+        return ERR_OK;
+    }
+    rope_node* spares[2] = {node_create(r), node_create(r)};
+    if (spares[0] == NULL || spares[1] == NULL) {
+        free(spares[0]);
+        free(spares[1]);
+        return error_raise(ERR_ROPE_ALLOC, "内存分配失败");
+    }
+    rope_node* left;
+    rope_node* middle;
+    rope_node* right;
+    split(r->root, pos, &left, &right, &spares[0]);
+    split(right, len, &middle, &right, &spares[1]);
+    r->pieces += (spares[0] == NULL) + (spares[1] == NULL);
+    r->pieces -= free_tree(middle);
+    r->root = merge(left, right);
+    r->length -= len;
+    free(spares[0]);
+    free(spares[1]);
+    return ERR_OK;
+}
+
+error_code rope_concat(rope* dst, rope* src) {
+    if (dst == NULL || src == NULL) {
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    if (dst == src) {
+        return error_raise(ERR_ROPE_ALIAS, "不能把文本拼接到自身");
+    }
+    dst->root = merge(dst->root, src->root);
+    dst->length += src->length;
+    dst->pieces += src->pieces;
+    // src的追加块中已有的片段现在属于dst，src之后另用新块
+    chunk_release(src->tail);
+    src->root = NULL;
+    src->length = 0;
+    src->pieces = 0;
+    src->tail = NULL;
+    return ERR_OK;
+}
+
+/* ---------- 读取与写出 ---------- */
+
+error_code rope_extract(const rope* r, size_t pos, size_t len, char* out) {
+    if (r == NULL || (out == NULL && len > 0)) {
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    if (pos > r->length || len > r->length - pos) {
+        return error_raise(ERR_ROPE_RANGE, "读取范围超出文本长度");
+    }
+    copy_range(r->root, pos, len, out);
+    return ERR_OK;
+}
+
+error_code rope_flatten(rope* r, const char** text) {
+    debug_print("展平文本");
+    if (r == NULL || text == NULL) {
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    if (r->root == NULL) {
+        *text = "";
+        return ERR_OK;
+    }
+    rope_node* root = r->root;
+    rope_chunk* chunk = root->chunk;
+    // 唯一的片段以块中已写入的部分结尾且块还有空间时，就地补'\0'
+    if (r->pieces == 1 && root->offset + root->len == chunk->used && chunk->used < chunk->capacity) {
+        chunk->data[chunk->used] = '\0';
+        *text = chunk->data + root->offset;
+        return ERR_OK;
+    }
+    rope_node* node = node_create(r);
+    chunk = chunk_create(r->length + 1);
+    if (node == NULL || chunk == NULL) {
+        free(node);
+        free(chunk);
+        return error_raise(ERR_ROPE_ALLOC, "内存分配失败");
+    }
+    copy_range(r->root, 0, r->length, chunk->data);
+    chunk->data[r->length] = '\0';
+    chunk->used = r->length;
+    free_tree(r->root);
+    node->chunk = chunk;
+    node->offset = 0;
+    node->len = r->length;
+    update(node);
+    r->root = node;
+    r->pieces = 1;
+    *text = chunk->data;
+    return ERR_OK;
+}
+
+error_code rope_for_each_piece(const rope* r, rope_piece_fn fn, void* ctx) {
+    if (r == NULL || fn == NULL) {
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    return visit(r->root, fn, ctx);
+}
+
+typedef struct {
+    int fd;
+    int count;
+    size_t staged;                      /* staging中已用的字节数 */
+    struct iovec iov[WRITE_BATCH];
+    char staging[STAGING_SIZE];
+} write_batch;
+
+/* 写出攒下的片段，部分写入时从未写完的片段继续 */
+static error_code flush_batch(write_batch* batch) {
+    struct iovec* iov = batch->iov;
+    int count = batch->count;
+    batch->count = 0;
+    batch->staged = 0;
+    while (count > 0) {
+        ssize_t n = writev(batch->fd, iov, count);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return error_raise(ERR_ROPE_WRITE, "写入失败");
+        }
+        size_t written = (size_t)n;
+        while (count > 0 && written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return ERR_OK;
+}
+
+/* 短片段复制到staging中与相邻的短片段合为一项，长片段直接引用 */
+static error_code add_to_batch(const char* data, size_t len, void* ctx) {
+    write_batch* batch = (write_batch*)ctx;
+    if (len < SMALL_PIECE) {
+        if (batch->staged + len > STAGING_SIZE) {
+            error_code code = flush_batch(batch);
+            if (code != ERR_OK) {
+                return code;
+            }
+        }
+        char* dst = batch->staging + batch->staged;
+        memcpy(dst, data, len);
+        batch->staged += len;
+        struct iovec* last = batch->count > 0 ? &batch->iov[batch->count - 1] : NULL;
+        if (last != NULL && (char*)last->iov_base + last->iov_len == dst) {
+            last->iov_len += len;
+            return ERR_OK;
+        }
+        data = dst;
+    }
+    batch->iov[batch->count].iov_base = (void*)data;
+    batch->iov[batch->count].iov_len = len;
+    batch->count++;
+    return batch->count == WRITE_BATCH ? flush_batch(batch) : ERR_OK;
+}
+
+error_code rope_write_fd(const rope* r, int fd) {
+    debug_print("写出文本");
+    if (r == NULL) {
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    write_batch* batch = (write_batch*)malloc(sizeof(write_batch));
+    if (batch == NULL) {
+        return error_raise(ERR_ROPE_ALLOC, "内存分配失败");
+    }
+    batch->fd = fd;
+    batch->count = 0;
+    batch->staged = 0;
+    error_code code = visit(r->root, add_to_batch, batch);
+    if (code == ERR_OK) {
+        code = flush_batch(batch);
+    }
+    free(batch);
+    return code;
+}
+
+error_code rope_write_file(const rope* r, const char* filename) {
+    debug_print("写入文件内容");
+    if (r == NULL || filename == NULL) {
+        return error_raise(ERR_ROPE_NULL, "参数为NULL");
+    }
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        error_log_detail(ERR_ROPE_OPEN, "无法打开文件", filename);
+        return ERR_ROPE_OPEN;
+    }
+    error_code code = rope_write_fd(r, fd);
+    if (close(fd) != 0 && code == ERR_OK) {
+        code = error_raise(ERR_ROPE_WRITE, "写入失败");
+    }
+    return code;
+}
+
+static int module_init(void) {
+    debug_print("文本编辑模块初始化成功");
+    return 1;
+}
+
+int initialize_rope_ops() {
+    return module_init_once(MODULE_ROPE, module_init);
+}
\ No newline at end of file
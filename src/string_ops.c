@@ -6,135 +6,224 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <immintrin.h>
 #include "../include/string_ops.h"
+#include "../include/module.h"
+#include "../include/thread_pool.h"
 #include "../include/utils.h"
+#include "../include/metrics.h"
+#include "../include/allocator.h"
 
-static int is_initialized = 0;
+/* 字符串长度达到该值时大小写转换分块并行执行 */
+#define PARALLEL_CASE_THRESHOLD (1 << 20)
+
+typedef struct {
+    char* str;
+    int upper;
+} case_ctx;
+
+static void case_range(long begin, long end, void* ctx) {
+    case_ctx* cc = (case_ctx*)ctx;
+    for (long i = begin; i < end; i++) {
+        unsigned char c = (unsigned char)cc->str[i];
+        cc->str[i] = (char)(cc->upper ? toupper(c) : tolower(c));
+    }
+}
+
+static void convert_case(char* str, int upper) {
+    size_t len = strlen(str);
+    case_ctx cc = {str, upper};
+    if (len >= PARALLEL_CASE_THRESHOLD) {
+        parallel_for(NULL, 0, (long)len, 0, case_range, &cc);
+    } else {
+        case_range(0, (long)len, &cc);
+    }
+}
 
 char* string_duplicate(const char* source) {
+    char* result = NULL;
+    string_duplicate_checked(source, &result);
+    return result;
+}
+
+char* string_concatenate(const char* str1, const char* str2) {
+    char* result = NULL;
+    string_concatenate_checked(str1, str2, &result);
+    return result;
+}
+
+char* string_to_upper(const char* str) {
+    char* result = NULL;
+    string_to_upper_checked(str, &result);
+    return result;
+}
+
+char* string_to_lower(const char* str) {
+    char* result = NULL;
+    string_to_lower_checked(str, &result);
+    return result;
+}
+
+char* string_reverse(const char* str) {
+    char* result = NULL;
+    string_reverse_checked(str, &result);
+    return result;
+}
+
+int string_find(const char* str, const char* substr) {
+    int index = -1;
+    string_find_checked(str, substr, &index);
+    return index;
+}
+
+char* string_replace(const char* str, const char* old_substr, const char* new_substr) {
+    char* result = NULL;
+    string_replace_checked(str, old_substr, new_substr, &result);
+    return result;
+}
+
+char** string_split(const char* str, const char* delimiter, int* count) {
+    char** parts = NULL;
+    string_split_checked(str, delimiter, &parts, count);
+    return parts;
+}
+
+char** string_transform_batch(const char* const* strs, int count, string_transform_fn fn) {
+    char** results = NULL;
+    string_transform_batch_checked(strs, count, fn, &results);
+    return results;
+}
+
+error_code string_duplicate_checked(const char* source, char** result) {
     debug_print("复制字符串");
-    if (source == NULL) {
-        error_log(2001, "源字符串为NULL");
-        return NULL;
+    metrics_count_call(METRIC_STRING_DUPLICATE);
+    if (source == NULL || result == NULL) {
+        return error_raise(ERR_STRING_DUPLICATE_NULL, "源字符串为NULL");
     }
+    *result = NULL;
     
     size_t len = strlen(source) + 1;
-    char* result = (char*)malloc(len);
-    if (result == NULL) {
-        error_log(2002, "内存分配失败");
-        return NULL;
+    char* copy = (char*)mem_alloc(len);
+    if (copy == NULL) {
+        return error_raise(ERR_STRING_DUPLICATE_ALLOC, "内存分配失败");
     }
     
-    strcpy(result, source);
-    return result;
+    memcpy(copy, source, len);
+    *result = copy;
+    return ERR_OK;
 }
 
-char* string_concatenate(const char* str1, const char* str2) {
+error_code string_concatenate_checked(const char* str1, const char* str2, char** result) {
     debug_print("连接字符串");
-    if (str1 == NULL || str2 == NULL) {
-        error_log(2003, "源字符串为NULL");
-        return NULL;
+    metrics_count_call(METRIC_STRING_CONCATENATE);
+    if (str1 == NULL || str2 == NULL || result == NULL) {
+        return error_raise(ERR_STRING_CONCATENATE_NULL, "源字符串为NULL");
     }
+    *result = NULL;
     
     size_t len1 = strlen(str1);
     size_t len2 = strlen(str2);
-    char* result = (char*)malloc(len1 + len2 + 1);
-    if (result == NULL) {
-        error_log(2004, "内存分配失败");
-        return NULL;
+    char* joined = (char*)mem_alloc(len1 + len2 + 1);
+    if (joined == NULL) {
+        return error_raise(ERR_STRING_CONCATENATE_ALLOC, "内存分配失败");
     }
     
-    strcpy(result, str1);
-    strcat(result, str2);
-    return result;
+    memcpy(joined, str1, len1);
+    memcpy(joined + len1, str2, len2 + 1);
+    *result = joined;
+    return ERR_OK;
 }
 
-char* string_to_upper(const char* str) {
+error_code string_to_upper_checked(const char* str, char** result) {
     debug_print("转换为大写");
-    if (str == NULL) {
-        error_log(2005, "源字符串为NULL");
-        return NULL;
+    metrics_count_call(METRIC_STRING_TO_UPPER);
+    if (str == NULL || result == NULL) {
+        return error_raise(ERR_STRING_TO_UPPER_NULL, "源字符串为NULL");
     }
     
-    char* result = string_duplicate(str);
-    if (result == NULL) {
-        return NULL;
+    error_code code = string_duplicate_checked(str, result);
+    if (code != ERR_OK) {
+        return code;
     }
     
-    for (size_t i = 0; result[i]; i++) {
-        result[i] = (char)toupper(result[i]);
-    }
+    convert_case(*result, 1);
     
-    return result;
+    return ERR_OK;
 }
 
-char* string_to_lower(const char* str) {
+error_code string_to_lower_checked(const char* str, char** result) {
     debug_print("转换为小写");
-    if (str == NULL) {
-        error_log(2006, "源字符串为NULL");
-        return NULL;
+    metrics_count_call(METRIC_STRING_TO_LOWER);
+    if (str == NULL || result == NULL) {
+        return error_raise(ERR_STRING_TO_LOWER_NULL, "源字符串为NULL");
     }
     
-    char* result = string_duplicate(str);
-    if (result == NULL) {
-        return NULL;
+    error_code code = string_duplicate_checked(str, result);
+    if (code != ERR_OK) {
+        return code;
     }
     
-    for (size_t i = 0; result[i]; i++) {
-        result[i] = (char)tolower(result[i]);
-    }
+    convert_case(*result, 0);
     
-    return result;
+    return ERR_OK;
 }
 
-char* string_reverse(const char* str) {
+error_code string_reverse_checked(const char* str, char** result) {
     debug_print("翻转字符串");
-    if (str == NULL) {
-        error_log(2007, "源字符串为NULL");
-        return NULL;
+    metrics_count_call(METRIC_STRING_REVERSE);
+    if (str == NULL || result == NULL) {
+        return error_raise(ERR_STRING_REVERSE_NULL, "源字符串为NULL");
     }
+    *result = NULL;
     
     size_t len = strlen(str);
-    char* result = (char*)malloc(len + 1);
-    if (result == NULL) {
-        error_log(2008, "内存分配失败");
-        return NULL;
+    char* reversed = (char*)mem_alloc(len + 1);
+    if (reversed == NULL) {
+        return error_raise(ERR_STRING_REVERSE_ALLOC, "内存分配失败");
     }
     
     for (size_t i = 0; i < len; i++) {
-        result[i] = str[len - 1 - i];
+        reversed[i] = str[len - 1 - i];
     }
-    result[len] = '\0';
+    reversed[len] = '\0';
     
-    return result;
+    *result = reversed;
+    return ERR_OK;
 }
 
-int string_find(const char* str, const char* substr) {
+error_code string_find_checked(const char* str, const char* substr, int* index) {
     debug_print("查找子字符串");
-    if (str == NULL || substr == NULL) {
-        error_log(2009, "源字符串或子字符串为NULL");
-        return -1;
-    }
-    
-    char* ptr = strstr(str, substr);
-    if (ptr == NULL) {
-        return -1;
+    metrics_count_call(METRIC_STRING_FIND);
+    if (str == NULL || substr == NULL || index == NULL) {
+        return error_raise(ERR_STRING_FIND_NULL, "源字符串或子字符串为NULL");
     }
     
-    return (int)(ptr - str);
+    const char* ptr = strstr(str, substr);
+    *index = ptr != NULL ? (int)(ptr - str) : -1;
+    return ERR_OK;
 }
 
-char* string_replace(const char* str, const char* old_substr, const char* new_substr) {
+error_code string_replace_checked(const char* str, const char* old_substr, const char* new_substr,
+                                  char** result) {
     debug_print("替换子字符串");
-    if (str == NULL || old_substr == NULL || new_substr == NULL) {
-        error_log(2010, "源字符串、旧子字符串或新子字符串为NULL");
-        return NULL;
+    metrics_count_call(METRIC_STRING_REPLACE);
+    if (str == NULL || old_substr == NULL || new_substr == NULL || result == NULL) {
+        return error_raise(ERR_STRING_REPLACE_NULL, "源字符串、旧子字符串或新子字符串为NULL");
     }
+    *result = NULL;
     
     size_t str_len = strlen(str);
     size_t old_len = strlen(old_substr);
     size_t new_len = strlen(new_substr);
     
+    // 空的旧子字符串不匹配任何位置，否则strstr会在同一位置无限匹配
+    if (old_len == 0) {
+        return string_duplicate_checked(str, result);
+    }
+    
     // 计算替换后的字符串长度
     size_t count = 0;
     const char* tmp = str;
@@ -144,17 +233,16 @@ char* string_replace(const char* str, const char* old_substr, const char* new_su
     }
     
     if (count == 0) {
-        return string_duplicate(str);
+        return string_duplicate_checked(str, result);
     }
     
     size_t result_len = str_len + count * (new_len - old_len) + 1;
-    char* result = (char*)malloc(result_len);
-    if (result == NULL) {
-        error_log(2011, "内存分配失败");
-        return NULL;
+    char* replaced = (char*)mem_alloc(result_len);
+    if (replaced == NULL) {
+        return error_raise(ERR_STRING_REPLACE_ALLOC, "内存分配失败");
     }
     
-    char* dest = result;
+    char* dest = replaced;
     const char* src = str;
     const char* match;
     
@@ -171,83 +259,998 @@ char* string_replace(const char* str, const char* old_substr, const char* new_su
     
     strcpy(dest, src);
     
-    return result;
+    *result = replaced;
+    return ERR_OK;
 }
 
-char** string_split(const char* str, const char* delimiter, int* count) {
+error_code string_split_checked(const char* str, const char* delimiter, char*** parts, int* count) {
     debug_print("分割字符串");
-    if (str == NULL || delimiter == NULL || count == NULL) {
-        error_log(2012, "源字符串、分隔符或计数为NULL");
-        return NULL;
+    metrics_count_call(METRIC_STRING_SPLIT);
+    if (count != NULL) {
+        *count = 0;
+    }
+    if (str == NULL || delimiter == NULL || parts == NULL || count == NULL) {
+        return error_raise(ERR_STRING_SPLIT_NULL, "源字符串、分隔符或计数为NULL");
     }
+    *parts = NULL;
     
-    // 计算分割后的部分数量
-    *count = 0;
-    const char* tmp = str;
     size_t delimiter_len = strlen(delimiter);
-    
     if (delimiter_len == 0) {
-        error_log(2013, "分隔符长度为零");
-        return NULL;
+        return error_raise(ERR_STRING_SPLIT_EMPTY_DELIMITER, "分隔符长度为零");
     }
     
+    // 计算分割后的部分数量
+    int part_count = 1; // 最后一部分
+    const char* tmp = str;
     while ((tmp = strstr(tmp, delimiter)) != NULL) {
-        (*count)++;
+        part_count++;
         tmp += delimiter_len;
     }
-    (*count)++; // 最后一部分
     
     // 分配数组内存
-    char** result = (char**)malloc(*count * sizeof(char*));
+    char** result = (char**)mem_alloc(part_count * sizeof(char*));
     if (result == NULL) {
-        error_log(2014, "内存分配失败");
-        *count = 0;
-        return NULL;
-    }
-    
-    // 填充数组
-    char* copy = string_duplicate(str);
-    if (copy == NULL) {
-        free(result);
-        *count = 0;
-        return NULL;
+        return error_raise(ERR_STRING_SPLIT_ALLOC, "内存分配失败");
     }
     
-    char* token = strtok(copy, delimiter);
-    int i = 0;
-    
-    while (token != NULL) {
-        result[i] = string_duplicate(token);
+    // 填充数组：直接按分隔符位置切分，不修改源字符串，也不使用strtok的全局状态
+    const char* start = str;
+    for (int i = 0; i < part_count; i++) {
+        const char* end = strstr(start, delimiter);
+        size_t part_len = end != NULL ? (size_t)(end - start) : strlen(start);
+        result[i] = (char*)mem_alloc(part_len + 1);
         if (result[i] == NULL) {
             // 释放已分配的内存
             for (int j = 0; j < i; j++) {
-                free(result[j]);
+                mem_free(result[j]);
             }
-            free(result);
-            free(copy);
-            *count = 0;
-            return NULL;
+            mem_free(result);
+            return error_raise(ERR_STRING_SPLIT_ALLOC, "内存分配失败");
         }
-        i++;
-        token = strtok(NULL, delimiter);
+        memcpy(result[i], start, part_len);
+        result[i][part_len] = '\0';
+        start = end != NULL ? end + delimiter_len : start + part_len;
     }
     
-    free(copy);
-    return result;
+    *parts = result;
+    *count = part_count;
+    return ERR_OK;
 }
 
-int initialize_string_ops() {
-    if (is_initialized) {
-        debug_print("字符串操作库已经初始化");
-        return 1;
+typedef struct {
+    const char* const* strs;
+    char** results;
+    string_transform_fn fn;
+} batch_ctx;
+
+static void batch_range(long begin, long end, void* ctx) {
+    batch_ctx* bc = (batch_ctx*)ctx;
+    for (long i = begin; i < end; i++) {
+        bc->results[i] = bc->strs[i] != NULL ? bc->fn(bc->strs[i]) : NULL;
     }
+}
+
+error_code string_transform_batch_checked(const char* const* strs, int count, string_transform_fn fn,
+                                          char*** results) {
+    debug_print("批量转换字符串");
+    metrics_count_call(METRIC_STRING_TRANSFORM_BATCH);
+    if (strs == NULL || fn == NULL || count < 0 || results == NULL) {
+        return error_raise(ERR_STRING_BATCH_INVALID, "字符串数组或转换函数无效");
+    }
+    *results = NULL;
     
-    if (!initialize_utils()) {
-        error_log(2015, "初始化工具库失败");
-        return 0;
+    char** converted = (char**)mem_calloc(count > 0 ? count : 1, sizeof(char*));
+    if (converted == NULL) {
+        return error_raise(ERR_STRING_BATCH_ALLOC, "内存分配失败");
     }
     
+    batch_ctx bc = {strs, converted, fn};
+    parallel_for(NULL, 0, count, 0, batch_range, &bc);
+    *results = converted;
+    return ERR_OK;
+}
+
+/* ---------- 编码与解码 ---------- */
+
+/* 一次编码或解码的输入达到该字节数时分段并行；百分号编码的输出长度不定，不分段 */
+#define PARALLEL_CODEC_THRESHOLD (4 << 20)
+/* 并行时每段的输入字节数，是3和4的倍数，各段的输出位置可以直接算出 */
+#define CODEC_CHUNK (3 << 18)
+
+#define CODEC_ENCODE 1
+#define CODEC_DECODE 2
+/* 解码表中无效字符与base64的'='的值，最高位为1 */
+#define INVALID_CHAR 0xff
+#define PAD_CHAR 0xfe
+
+static pthread_once_t codec_once = PTHREAD_ONCE_INIT;
+static int has_avx2 = 0;
+static int has_ssse3 = 0;
+static const char base64_std_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char base64_url_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+static const char hex_lower[] = "0123456789abcdef";
+static const char hex_upper[] = "0123456789ABCDEF";
+/* 字符的值：base64为0~63，十六进制为0~15，'='为PAD_CHAR，其他为INVALID_CHAR */
+static uint8_t base64_std_values[256];
+static uint8_t base64_url_values[256];
+static uint8_t hex_values[256];
+/* 百分号编码中原样输出的字节 */
+static uint8_t percent_unreserved[256];
+
+static void init_codec(void) {
+    __builtin_cpu_init();
+    has_avx2 = __builtin_cpu_supports("avx2");
+    has_ssse3 = __builtin_cpu_supports("ssse3");
+    memset(base64_std_values, INVALID_CHAR, sizeof(base64_std_values));
+    memset(base64_url_values, INVALID_CHAR, sizeof(base64_url_values));
+    memset(hex_values, INVALID_CHAR, sizeof(hex_values));
+    for (int i = 0; i < 64; i++) {
+        base64_std_values[(uint8_t)base64_std_alphabet[i]] = (uint8_t)i;
+        base64_url_values[(uint8_t)base64_url_alphabet[i]] = (uint8_t)i;
+    }
+    base64_std_values['='] = PAD_CHAR;
+    base64_url_values['='] = PAD_CHAR;
+    for (int i = 0; i < 16; i++) {
+        hex_values[(uint8_t)hex_lower[i]] = (uint8_t)i;
+        hex_values[(uint8_t)hex_upper[i]] = (uint8_t)i;
+    }
+    for (int c = 0; c < 256; c++) {
+        percent_unreserved[c] = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                                c == '-' || c == '.' || c == '_' || c == '~';
+    }
+}
+
+static int valid_encoding(string_encoding encoding) {
+    return encoding == STRING_BASE64 || encoding == STRING_BASE64_URL || encoding == STRING_HEX ||
+           encoding == STRING_PERCENT;
+}
+
+/* base64编码时按6位的值查表：0~25加'A'，26~51加'a'-26，52~61加'0'-52，62、63为两个特殊字符 */
+static inline __m128i base64_offsets(int url) {
+    return _mm_setr_epi8(71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, url ? '-' - 62 : '+' - 62,
+                         url ? '_' - 63 : '/' - 63, 65, 0, 0);
+}
+
+/* 每次读取28字节、编码其中的24字节；返回编码的字节数（24的倍数） */
+__attribute__((target("avx2")))
+static size_t base64_encode_avx2(const uint8_t* in, size_t n, char* out, int url) {
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i offsets = _mm256_broadcastsi128_si256(base64_offsets(url));
+    size_t i = 0;
+    for (; n - i >= 28; i += 24) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(in + i + 12));
+        // 每个32位字为[b1, b0, b2, b1]，两次16位乘法把4个6位的值移到各自的字节
+        __m256i v = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuffle);
+        __m256i a = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)),
+                                       _mm256_set1_epi32(0x04000040));
+        __m256i b = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)),
+                                       _mm256_set1_epi32(0x01000010));
+        __m256i idx = _mm256_or_si256(a, b);
+        __m256i sel = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+        sel = _mm256_or_si256(sel, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx),
+                                                    _mm256_set1_epi8(13)));
+        _mm256_storeu_si256((__m256i*)(out + i / 3 * 4), _mm256_add_epi8(idx, _mm256_shuffle_epi8(offsets, sel)));
+    }
+    return i;
+}
+
+/* 每次读取16字节、编码其中的12字节 */
+__attribute__((target("ssse3")))
+static size_t base64_encode_ssse3(const uint8_t* in, size_t n, char* out, int url) {
+    const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m128i offsets = base64_offsets(url);
+    size_t i = 0;
+    for (; n - i >= 16; i += 12) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + i)), shuffle);
+        __m128i a = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i b = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i idx = _mm_or_si128(a, b);
+        __m128i sel = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+        sel = _mm_or_si128(sel, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx), _mm_set1_epi8(13)));
+        _mm_storeu_si128((__m128i*)(out + i / 3 * 4), _mm_add_epi8(idx, _mm_shuffle_epi8(offsets, sel)));
+    }
+    return i;
+}
+
+/* 编码开头的完整三字节组，返回编码的字节数（3的倍数），输出为其4/3 */
+static size_t base64_encode_blocks(const uint8_t* in, size_t n, char* out, int url) {
+    const char* alphabet = url ? base64_url_alphabet : base64_std_alphabet;
+    size_t i = 0;
+    if (has_avx2) {
+        i = base64_encode_avx2(in, n, out, url);
+    } else if (has_ssse3) {
+        i = base64_encode_ssse3(in, n, out, url);
+    }
+    char* p = out + i / 3 * 4;
+    for (; n - i >= 3; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+        p[0] = alphabet[v >> 18];
+        p[1] = alphabet[(v >> 12) & 63];
+        p[2] = alphabet[(v >> 6) & 63];
+        p[3] = alphabet[v & 63];
+        p += 4;
+    }
+    return i;
+}
+
+static size_t base64_encode_run(string_codec* codec, const uint8_t* in, size_t n, char* out) {
+    int url = codec->encoding == STRING_BASE64_URL;
+    size_t i = 0;
+    size_t o = 0;
+    if (codec->pending_len > 0) {
+        while (codec->pending_len < 3 && i < n) {
+            codec->pending[codec->pending_len++] = in[i++];
+        }
+        if (codec->pending_len < 3) {
+            return 0;
+        }
+        o = base64_encode_blocks(codec->pending, 3, out, url) / 3 * 4;
+        codec->pending_len = 0;
+    }
+    size_t used = base64_encode_blocks(in + i, n - i, out + o, url);
+    i += used;
+    o += used / 3 * 4;
+    while (i < n) {
+        codec->pending[codec->pending_len++] = in[i++];
+    }
+    return o;
+}
+
+static size_t base64_encode_tail(string_codec* codec, char* out) {
+    const char* alphabet = codec->encoding == STRING_BASE64_URL ? base64_url_alphabet : base64_std_alphabet;
+    size_t len = codec->pending_len;
+    if (len == 0) {
+        return 0;
+    }
+    uint32_t v = (uint32_t)codec->pending[0] << 16 | (len > 1 ? (uint32_t)codec->pending[1] << 8 : 0);
+    size_t o = 0;
+    out[o++] = alphabet[v >> 18];
+    out[o++] = alphabet[(v >> 12) & 63];
+    if (len > 1) {
+        out[o++] = alphabet[(v >> 6) & 63];
+    }
+    while (codec->encoding == STRING_BASE64 && o < 4) {
+        out[o++] = '=';
+    }
+    codec->pending_len = 0;
+    return o;
+}
+
+/* 以比较求出各字符的值并检查是否都在字母表中，两次乘加把4个6位的值拼成3字节 */
+__attribute__((target("avx2")))
+static size_t base64_decode_avx2(const uint8_t* in, size_t n, uint8_t* out, int url) {
+    const __m256i c62 = _mm256_set1_epi8(url ? '-' : '+');
+    const __m256i c63 = _mm256_set1_epi8(url ? '_' : '/');
+    const __m256i d62 = _mm256_set1_epi8(url ? 62 - '-' : 62 - '+');
+    const __m256i d63 = _mm256_set1_epi8(url ? 63 - '_' : 63 - '/');
+    const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    size_t i = 0;
+    // 每次写入32字节、其中24字节有效，留下至少16个字符使多写的字节仍在输出缓冲区内
+    for (; n - i >= 48; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+        __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+        __m256i is62 = _mm256_cmpeq_epi8(v, c62);
+        __m256i is63 = _mm256_cmpeq_epi8(v, c63);
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                        _mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+        if (_mm256_movemask_epi8(valid) != -1) {
+            break;
+        }
+        __m256i delta = _mm256_or_si256(
+            _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+                            _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a'))),
+            _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')),
+                            _mm256_or_si256(_mm256_and_si256(is62, d62), _mm256_and_si256(is63, d63))));
+        __m256i values = _mm256_add_epi8(v, delta);
+        __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        merged = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, pack), lanes);
+        _mm256_storeu_si256((__m256i*)(out + i / 4 * 3), merged);
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t base64_decode_ssse3(const uint8_t* in, size_t n, uint8_t* out, int url) {
+    const __m128i c62 = _mm_set1_epi8(url ? '-' : '+');
+    const __m128i c63 = _mm_set1_epi8(url ? '_' : '/');
+    const __m128i d62 = _mm_set1_epi8(url ? 62 - '-' : 62 - '+');
+    const __m128i d63 = _mm_set1_epi8(url ? 63 - '_' : 63 - '/');
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+    // 每次写入16字节、其中12字节有效，留下至少8个字符
+    for (; n - i >= 24; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                      _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), v));
+        __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)),
+                                      _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), v));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+        __m128i is62 = _mm_cmpeq_epi8(v, c62);
+        __m128i is63 = _mm_cmpeq_epi8(v, c63);
+        __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+        if (_mm_movemask_epi8(valid) != 0xffff) {
+            break;
+        }
+        __m128i delta = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')), _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+            _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+                         _mm_or_si128(_mm_and_si128(is62, d62), _mm_and_si128(is63, d63))));
+        __m128i merged = _mm_maddubs_epi16(_mm_add_epi8(v, delta), _mm_set1_epi32(0x01400140));
+        merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128((__m128i*)(out + i / 4 * 3), _mm_shuffle_epi8(merged, pack));
+    }
+    return i;
+}
+
+/* 解码开头的完整四字符组，遇到无效字符或'='的组时停下；返回解码的字符数（4的倍数），输出为其3/4 */
+static size_t base64_decode_blocks(const uint8_t* in, size_t n, uint8_t* out, int url) {
+    const uint8_t* table = url ? base64_url_values : base64_std_values;
+    size_t i = 0;
+    if (has_avx2) {
+        i = base64_decode_avx2(in, n, out, url);
+    } else if (has_ssse3) {
+        i = base64_decode_ssse3(in, n, out, url);
+    }
+    uint8_t* p = out + i / 4 * 3;
+    for (; n - i >= 4; i += 4) {
+        uint32_t a = table[in[i]];
+        uint32_t b = table[in[i + 1]];
+        uint32_t c = table[in[i + 2]];
+        uint32_t d = table[in[i + 3]];
+        if ((a | b | c | d) & 0x80) {
+            break;
+        }
+        uint32_t v = a << 18 | b << 12 | c << 6 | d;
+        p[0] = (uint8_t)(v >> 16);
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)v;
+        p += 3;
+    }
+    return i;
+}
+
+static int codec_fail(string_codec* codec, uint64_t offset) {
+    codec->failed = 1;
+    codec->error_offset = offset;
+    return 0;
+}
+
+/* 输出四字符组（不足的值为0）的前bytes字节，多余的位不为0时返回0 */
+static int base64_emit(const uint8_t* values, size_t bytes, uint8_t* out) {
+    uint32_t v = (uint32_t)values[0] << 18 | (uint32_t)values[1] << 12 | (uint32_t)values[2] << 6 | values[3];
+    if ((bytes == 1 && (v & 0xffff) != 0) || (bytes == 2 && (v & 0xff) != 0)) {
+        return 0;
+    }
+    for (size_t k = 0; k < bytes; k++) {
+        out[k] = (uint8_t)(v >> (16 - 8 * k));
+    }
+    return 1;
+}
+
+static int base64_decode_run(string_codec* codec, const uint8_t* in, size_t n, uint8_t* out, size_t* out_len) {
+    int url = codec->encoding == STRING_BASE64_URL;
+    const uint8_t* table = url ? base64_url_values : base64_std_values;
+    size_t i = 0;
+    size_t o = 0;
+    while (i < n) {
+        if (codec->pending_len == 0 && !codec->finished) {
+            size_t used = base64_decode_blocks(in + i, n - i, out + o, url);
+            i += used;
+            o += used / 4 * 3;
+            if (i == n) {
+                break;
+            }
+        }
+        // 逐个字符处理不完整的组、'='与无效字符
+        uint8_t v = table[in[i]];
+        if (codec->finished || v == INVALID_CHAR || (v != PAD_CHAR && codec->padding > 0) ||
+            (v == PAD_CHAR && codec->pending_len < 2)) {
+            *out_len = o;
+            return codec_fail(codec, codec->position + i);
+        }
+        if (v == PAD_CHAR) {
+            codec->padding++;
+            v = 0;
+        }
+        codec->pending[codec->pending_len++] = v;
+        i++;
+        if (codec->pending_len == 4) {
+            size_t bytes = 3 - (size_t)codec->padding;
+            if (!base64_emit(codec->pending, bytes, out + o)) {
+                *out_len = o;
+                return codec_fail(codec, codec->position + i - 1 - (size_t)codec->padding);
+            }
+            o += bytes;
+            codec->pending_len = 0;
+            codec->finished = codec->padding > 0;
+        }
+    }
+    codec->position += n;
+    *out_len = o;
+    return 1;
+}
+
+/* 每个字节的高低4位查表后交错 */
+__attribute__((target("avx2")))
+static size_t hex_encode_avx2(const uint8_t* in, size_t n, char* out) {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)hex_lower));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; n - i >= 32; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+        __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, mask));
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i*)(out + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i*)(out + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t hex_encode_ssse3(const uint8_t* in, size_t n, char* out) {
+    const __m128i digits = _mm_loadu_si128((const __m128i*)hex_lower);
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; n - i >= 16; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, mask));
+        _mm_storeu_si128((__m128i*)(out + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i*)(out + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+static size_t hex_encode_run(const uint8_t* in, size_t n, char* out) {
+    size_t i = 0;
+    if (has_avx2) {
+        i = hex_encode_avx2(in, n, out);
+    } else if (has_ssse3) {
+        i = hex_encode_ssse3(in, n, out);
+    }
+    for (; i < n; i++) {
+        out[2 * i] = hex_lower[in[i] >> 4];
+        out[2 * i + 1] = hex_lower[in[i] & 15];
+    }
+    return 2 * n;
+}
+
+/* 数字减'0'、字母转小写后减'a'，无符号比较检查范围；乘加把两个4位的值拼成一个字节 */
+__attribute__((target("avx2")))
+static size_t hex_decode_avx2(const uint8_t* in, size_t n, uint8_t* out) {
+    size_t i = 0;
+    for (; n - i >= 32; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+        __m256i a = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+        __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(a, _mm256_set1_epi8(5)), a);
+        if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)) != -1) {
+            break;
+        }
+        __m256i values = _mm256_blendv_epi8(_mm256_add_epi8(a, _mm256_set1_epi8(10)), d, is_digit);
+        __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0110));
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs, pairs), 0x08);
+        _mm_storeu_si128((__m128i*)(out + i / 2), _mm256_castsi256_si128(packed));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t hex_decode_ssse3(const uint8_t* in, size_t n, uint8_t* out) {
+    size_t i = 0;
+    for (; n - i >= 16; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+        __m128i a = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+        __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(a, _mm_set1_epi8(5)), a);
+        if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xffff) {
+            break;
+        }
+        __m128i values = _mm_or_si128(_mm_and_si128(is_digit, d),
+                                      _mm_andnot_si128(is_digit, _mm_add_epi8(a, _mm_set1_epi8(10))));
+        __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+        _mm_storel_epi64((__m128i*)(out + i / 2), _mm_packus_epi16(pairs, pairs));
+    }
+    return i;
+}
+
+static int hex_decode_run(string_codec* codec, const uint8_t* in, size_t n, uint8_t* out, size_t* out_len) {
+    size_t i = 0;
+    size_t o = 0;
+    if (codec->pending_len == 1 && n > 0) {
+        uint8_t lo = hex_values[in[0]];
+        if (lo & 0x80) {
+            *out_len = 0;
+            return codec_fail(codec, codec->position);
+        }
+        out[o++] = (uint8_t)(codec->pending[0] << 4 | lo);
+        codec->pending_len = 0;
+        i = 1;
+    }
+    size_t used = 0;
+    if (has_avx2) {
+        used = hex_decode_avx2(in + i, n - i, out + o);
+    } else if (has_ssse3) {
+        used = hex_decode_ssse3(in + i, n - i, out + o);
+    }
+    i += used;
+    o += used / 2;
+    for (; n - i >= 2; i += 2) {
+        uint8_t hi = hex_values[in[i]];
+        uint8_t lo = hex_values[in[i + 1]];
+        if ((hi | lo) & 0x80) {
+            *out_len = o;
+            return codec_fail(codec, codec->position + i + ((hi & 0x80) ? 0 : 1));
+        }
+        out[o++] = (uint8_t)(hi << 4 | lo);
+    }
+    if (i < n) {
+        uint8_t hi = hex_values[in[i]];
+        if (hi & 0x80) {
+            *out_len = o;
+            return codec_fail(codec, codec->position + i);
+        }
+        codec->pending[0] = hi;
+        codec->pending_len = 1;
+    }
+    codec->position += n;
+    *out_len = o;
+    return 1;
+}
+
+/* 百分号编码中原样输出的字节：字母、数字和"-._~" */
+__attribute__((target("avx2")))
+static size_t percent_plain_avx2(const uint8_t* in, size_t n) {
+    size_t i = 0;
+    for (; n - i >= 32; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i letter = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(letter, _mm256_set1_epi8('a' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), letter));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+        __m256i marks = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')),
+                                                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'))),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')),
+                                                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('~'))));
+        uint32_t escaped = ~(uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(alpha, digit), marks));
+        if (escaped != 0) {
+            return i + (size_t)__builtin_ctz(escaped);
+        }
+    }
+    return i;
+}
+
+static size_t percent_plain_sse2(const uint8_t* in, size_t n) {
+    size_t i = 0;
+    for (; n - i >= 16; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i letter = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(letter, _mm_set1_epi8('a' - 1)),
+                                      _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), letter));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+        __m128i marks = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')),
+                                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))),
+                                     _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')),
+                                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('~'))));
+        uint32_t escaped = ~(uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), marks)) & 0xffff;
+        if (escaped != 0) {
+            return i + (size_t)__builtin_ctz(escaped);
+        }
+    }
+    return i;
+}
+
+static size_t percent_encode_run(const uint8_t* in, size_t n, char* out) {
+    size_t i = 0;
+    size_t o = 0;
+    while (i < n) {
+        // 不需要编码的字节整段复制；遇到需要编码的字节后逐个处理32字节，以免每个字节都重新检查一次
+        size_t plain = has_avx2 ? percent_plain_avx2(in + i, n - i) : percent_plain_sse2(in + i, n - i);
+        memcpy(out + o, in + i, plain);
+        i += plain;
+        o += plain;
+        size_t stop = n - i < 32 ? n : i + 32;
+        for (; i < stop; i++) {
+            // 总是写3字节再按是否编码前进，没有难以预测的分支；多写的字节仍在3 * n的上界以内
+            uint8_t c = in[i];
+            out[o] = percent_unreserved[c] ? (char)c : '%';
+            out[o + 1] = hex_upper[c >> 4];
+            out[o + 2] = hex_upper[c & 15];
+            o += percent_unreserved[c] ? 1 : 3;
+        }
+    }
+    return o;
+}
+
+/* pending[0]标记读到了'%'，之后是已读到的十六进制数字的值 */
+static int percent_decode_run(string_codec* codec, const uint8_t* in, size_t n, uint8_t* out, size_t* out_len) {
+    size_t i = 0;
+    size_t o = 0;
+    while (i < n) {
+        if (codec->pending_len > 0) {
+            uint8_t v = hex_values[in[i]];
+            if (v & 0x80) {
+                *out_len = o;
+                return codec_fail(codec, codec->position + i);
+            }
+            codec->pending[codec->pending_len++] = v;
+            i++;
+            if (codec->pending_len == 3) {
+                out[o++] = (uint8_t)(codec->pending[1] << 4 | codec->pending[2]);
+                codec->pending_len = 0;
+            }
+            continue;
+        }
+        // 先逐个检查几个字节，没有'%'时再由memchr（glibc中为SIMD实现）查找，之间的部分整段复制
+        size_t limit = n - i < 8 ? n - i : 8;
+        size_t plain = 0;
+        while (plain < limit && in[i + plain] != '%') {
+            plain++;
+        }
+        if (plain == limit && plain < n - i) {
+            const uint8_t* escape = (const uint8_t*)memchr(in + i + plain, '%', n - i - plain);
+            plain = escape != NULL ? (size_t)(escape - (in + i)) : n - i;
+        }
+        memcpy(out + o, in + i, plain);
+        i += plain;
+        o += plain;
+        if (i == n) {
+            break;
+        }
+        if (n - i >= 3) {
+            uint8_t hi = hex_values[in[i + 1]];
+            uint8_t lo = hex_values[in[i + 2]];
+            if ((hi | lo) & 0x80) {
+                *out_len = o;
+                return codec_fail(codec, codec->position + i + ((hi & 0x80) ? 1 : 2));
+            }
+            out[o++] = (uint8_t)(hi << 4 | lo);
+            i += 3;
+        } else {
+            codec->pending[0] = '%';
+            codec->pending_len = 1;
+            i++;
+        }
+    }
+    codec->position += n;
+    *out_len = o;
+    return 1;
+}
+
+static int decode_run(string_codec* codec, const uint8_t* in, size_t n, uint8_t* out, size_t* out_len) {
+    switch (codec->encoding) {
+        case STRING_HEX:
+            return hex_decode_run(codec, in, n, out, out_len);
+        case STRING_PERCENT:
+            return percent_decode_run(codec, in, n, out, out_len);
+        default:
+            return base64_decode_run(codec, in, n, out, out_len);
+    }
+}
+
+/* 检查输入在完整的一组处结束；URL安全的base64省略'='时输出最后不完整的一组 */
+static int decode_finish(string_codec* codec, uint8_t* out, size_t* out_len) {
+    *out_len = 0;
+    if (codec->pending_len == 0) {
+        return 1;
+    }
+    if (codec->encoding == STRING_BASE64_URL && codec->padding == 0 && codec->pending_len >= 2) {
+        size_t bytes = codec->pending_len - 1;
+        memset(codec->pending + codec->pending_len, 0, 4 - codec->pending_len);
+        if (!base64_emit(codec->pending, bytes, out)) {
+            return codec_fail(codec, codec->position - 1);
+        }
+        codec->pending_len = 0;
+        *out_len = bytes;
+        return 1;
+    }
+    return codec_fail(codec, codec->position);
+}
+
+static size_t encode_run(string_codec* codec, const uint8_t* in, size_t n, char* out) {
+    switch (codec->encoding) {
+        case STRING_HEX:
+            return hex_encode_run(in, n, out);
+        case STRING_PERCENT:
+            return percent_encode_run(in, n, out);
+        default:
+            return base64_encode_run(codec, in, n, out);
+    }
+}
+
+/* 检查状态可以用于direction方向，第一次使用时记录方向 */
+static int codec_begin(string_codec* codec, int direction) {
+    if (codec == NULL || !valid_encoding(codec->encoding) ||
+        (codec->direction != 0 && codec->direction != direction)) {
+        return 0;
+    }
+    codec->direction = direction;
+    pthread_once(&codec_once, init_codec);
+    return 1;
+}
+
+size_t string_encode_bound(string_encoding encoding, size_t len) {
+    switch (encoding) {
+        case STRING_BASE64:
+        case STRING_BASE64_URL:
+            return (len + 2) / 3 * 4;
+        case STRING_HEX:
+            return len * 2;
+        case STRING_PERCENT:
+            return len * 3;
+        default:
+            return 0;
+    }
+}
+
+size_t string_decode_bound(string_encoding encoding, size_t len) {
+    switch (encoding) {
+        case STRING_BASE64:
+        case STRING_BASE64_URL:
+            return (len + 3) / 4 * 3;
+        case STRING_HEX:
+            return (len + 1) / 2;
+        case STRING_PERCENT:
+            return len;
+        default:
+            return 0;
+    }
+}
+
+void string_codec_init(string_codec* codec, string_encoding encoding) {
+    if (codec != NULL) {
+        memset(codec, 0, sizeof(*codec));
+        codec->encoding = encoding;
+    }
+}
+
+error_code string_encode_update(string_codec* codec, const void* data, size_t len, char* out, size_t* out_len) {
+    if (out_len != NULL) {
+        *out_len = 0;
+    }
+    if (!codec_begin(codec, CODEC_ENCODE) || (data == NULL && len > 0) || out == NULL || out_len == NULL) {
+        return error_raise(ERR_STRING_CODEC_INVALID, "编码状态、数据或输出参数无效");
+    }
+    *out_len = encode_run(codec, (const uint8_t*)data, len, out);
+    codec->position += len;
+    return ERR_OK;
+}
+
+error_code string_encode_final(string_codec* codec, char* out, size_t* out_len) {
+    if (out_len != NULL) {
+        *out_len = 0;
+    }
+    if (!codec_begin(codec, CODEC_ENCODE) || out == NULL || out_len == NULL) {
+        return error_raise(ERR_STRING_CODEC_INVALID, "编码状态或输出参数无效");
+    }
+    *out_len = codec->encoding == STRING_HEX || codec->encoding == STRING_PERCENT ? 0
+                                                                                 : base64_encode_tail(codec, out);
+    return ERR_OK;
+}
+
+error_code string_decode_update(string_codec* codec, const char* text, size_t len, void* out, size_t* out_len) {
+    if (out_len != NULL) {
+        *out_len = 0;
+    }
+    if (!codec_begin(codec, CODEC_DECODE) || (text == NULL && len > 0) || out == NULL || out_len == NULL) {
+        return error_raise(ERR_STRING_CODEC_INVALID, "解码状态、文本或输出参数无效");
+    }
+    if (codec->failed || !decode_run(codec, (const uint8_t*)text, len, (uint8_t*)out, out_len)) {
+        return error_raise(ERR_STRING_DECODE_INVALID, "输入不是有效的编码");
+    }
+    return ERR_OK;
+}
+
+error_code string_decode_final(string_codec* codec, void* out, size_t* out_len) {
+    if (out_len != NULL) {
+        *out_len = 0;
+    }
+    if (!codec_begin(codec, CODEC_DECODE) || out == NULL || out_len == NULL) {
+        return error_raise(ERR_STRING_CODEC_INVALID, "解码状态或输出参数无效");
+    }
+    if (codec->failed || !decode_finish(codec, (uint8_t*)out, out_len)) {
+        return error_raise(ERR_STRING_DECODE_INVALID, "输入不是有效的编码");
+    }
+    return ERR_OK;
+}
+
+typedef struct {
+    string_encoding encoding;
+    int decode;
+    const uint8_t* in;
+    size_t len;
+    uint8_t* out;
+    string_codec* codecs;
+    size_t* produced;
+    int* ok;
+} codec_job;
+
+/* 每段用独立的状态编码或解码，输出位置由输入位置直接算出 */
+static void codec_chunks(long begin, long end, void* ctx) {
+    codec_job* job = (codec_job*)ctx;
+    for (long k = begin; k < end; k++) {
+        size_t start = (size_t)k * CODEC_CHUNK;
+        size_t n = job->len - start < CODEC_CHUNK ? job->len - start : CODEC_CHUNK;
+        string_codec* codec = &job->codecs[k];
+        string_codec_init(codec, job->encoding);
+        if (job->decode) {
+            uint8_t* out = job->out + string_decode_bound(job->encoding, start);
+            // 除最后一段外都必须在完整的组处结束，否则交给顺序解码求出准确的结果或错误位置
+            job->ok[k] = decode_run(codec, job->in + start, n, out, &job->produced[k]) &&
+                         (start + n == job->len || (codec->pending_len == 0 && !codec->finished));
+        } else {
+            char* out = (char*)job->out + string_encode_bound(job->encoding, start);
+            job->produced[k] = encode_run(codec, job->in + start, n, out);
+            job->ok[k] = 1;
+        }
+    }
+}
+
+/* 分段并行编码或解码，返回输出的字节数；有一段失败时返回0并设置*ok为0 */
+static size_t codec_parallel(string_encoding encoding, int decode, const uint8_t* in, size_t len, uint8_t* out,
+                             int* ok) {
+    long chunks = (long)((len + CODEC_CHUNK - 1) / CODEC_CHUNK);
+    string_codec* codecs = (string_codec*)malloc((size_t)chunks * sizeof(string_codec));
+    size_t* produced = (size_t*)calloc((size_t)chunks, sizeof(size_t));
+    int* chunk_ok = (int*)calloc((size_t)chunks, sizeof(int));
+    *ok = 0;
+    if (codecs == NULL || produced == NULL || chunk_ok == NULL) {
+        free(codecs);
+        free(produced);
+        free(chunk_ok);
+        return 0;
+    }
+    codec_job job = {encoding, decode, in, len, out, codecs, produced, chunk_ok};
+    parallel_for(NULL, 0, chunks, 1, codec_chunks, &job);
+    int all_ok = 1;
+    for (long k = 0; k < chunks; k++) {
+        all_ok &= chunk_ok[k];
+    }
+    size_t total = 0;
+    if (all_ok) {
+        size_t start = (size_t)(chunks - 1) * CODEC_CHUNK;
+        total = (decode ? string_decode_bound(encoding, start) : string_encode_bound(encoding, start)) +
+                produced[chunks - 1];
+        size_t tail = 0;
+        string_codec* last = &codecs[chunks - 1];
+        if (decode) {
+            all_ok = decode_finish(last, out + total, &tail);
+        } else {
+            tail = base64_encode_tail(last, (char*)out + total);
+        }
+        total += tail;
+    }
+    free(codecs);
+    free(produced);
+    free(chunk_ok);
+    *ok = all_ok;
+    return all_ok ? total : 0;
+}
+
+char* string_encode(string_encoding encoding, const void* data, size_t len) {
+    char* result = NULL;
+    string_encode_checked(encoding, data, len, &result, NULL);
+    return result;
+}
+
+char* string_decode(string_encoding encoding, const char* text, size_t len, size_t* result_len) {
+    char* result = NULL;
+    string_decode_checked(encoding, text, len, &result, result_len);
+    return result;
+}
+
+error_code string_encode_checked(string_encoding encoding, const void* data, size_t len, char** result,
+                                 size_t* result_len) {
+    debug_print("编码");
+    metrics_count_call(METRIC_STRING_ENCODE);
+    if (result != NULL) {
+        *result = NULL;
+    }
+    if (result_len != NULL) {
+        *result_len = 0;
+    }
+    if (!valid_encoding(encoding) || (data == NULL && len > 0) || result == NULL) {
+        return error_raise(ERR_STRING_CODEC_INVALID, "数据或输出参数为NULL，或编码方式无效");
+    }
+    pthread_once(&codec_once, init_codec);
+    if (len > (SIZE_MAX - STRING_CODEC_FINAL_BYTES - 1) / 3) {
+        return error_raise(ERR_STRING_CODEC_ALLOC, "输入过长");
+    }
+    char* out = (char*)mem_alloc(string_encode_bound(encoding, len) + STRING_CODEC_FINAL_BYTES + 1);
+    if (out == NULL) {
+        return error_raise(ERR_STRING_CODEC_ALLOC, "内存分配失败");
+    }
+    size_t n = 0;
+    int ok = 0;
+    if (len >= PARALLEL_CODEC_THRESHOLD && encoding != STRING_PERCENT) {
+        n = codec_parallel(encoding, 0, (const uint8_t*)data, len, (uint8_t*)out, &ok);
+    }
+    if (!ok) {
+        string_codec codec;
+        string_codec_init(&codec, encoding);
+        n = encode_run(&codec, (const uint8_t*)data, len, out);
+        n += encoding == STRING_HEX || encoding == STRING_PERCENT ? 0 : base64_encode_tail(&codec, out + n);
+    }
+    out[n] = '\0';
+    *result = out;
+    if (result_len != NULL) {
+        *result_len = n;
+    }
+    return ERR_OK;
+}
+
+error_code string_decode_checked(string_encoding encoding, const char* text, size_t len, char** result,
+                                 size_t* result_len) {
+    debug_print("解码");
+    metrics_count_call(METRIC_STRING_DECODE);
+    if (result != NULL) {
+        *result = NULL;
+    }
+    if (result_len != NULL) {
+        *result_len = 0;
+    }
+    if (!valid_encoding(encoding) || (text == NULL && len > 0) || result == NULL) {
+        return error_raise(ERR_STRING_CODEC_INVALID, "文本或输出参数为NULL，或编码方式无效");
+    }
+    pthread_once(&codec_once, init_codec);
+    if (len > SIZE_MAX - STRING_CODEC_FINAL_BYTES - 1) {
+        return error_raise(ERR_STRING_CODEC_ALLOC, "输入过长");
+    }
+    char* out = (char*)mem_alloc(string_decode_bound(encoding, len) + STRING_CODEC_FINAL_BYTES + 1);
+    if (out == NULL) {
+        return error_raise(ERR_STRING_CODEC_ALLOC, "内存分配失败");
+    }
+    const uint8_t* in = (const uint8_t*)text;
+    size_t n = 0;
+    int ok = 0;
+    if (len >= PARALLEL_CODEC_THRESHOLD && encoding != STRING_PERCENT) {
+        n = codec_parallel(encoding, 1, in, len, (uint8_t*)out, &ok);
+    }
+    if (!ok) {
+        string_codec codec;
+        string_codec_init(&codec, encoding);
+        size_t tail = 0;
+        if (!decode_run(&codec, in, len, (uint8_t*)out, &n) || !decode_finish(&codec, (uint8_t*)out + n, &tail)) {
+            mem_free(out);
+            if (result_len != NULL) {
+                *result_len = (size_t)codec.error_offset;
+            }
+            return error_raise(ERR_STRING_DECODE_INVALID, "输入不是有效的编码");
+        }
+        n += tail;
+    }
+    out[n] = '\0';
+    *result = out;
+    if (result_len != NULL) {
+        *result_len = n;
+    }
+    return ERR_OK;
+}
+
+static int module_init(void) {
+    pthread_once(&codec_once, init_codec);
+    debug_print(has_avx2 ? "编码与解码使用AVX2指令" : has_ssse3 ? "编码与解码使用SSSE3指令" : "编码与解码使用标量实现");
     debug_print("字符串操作库初始化成功");
-    is_initialized = 1;
     return 1;
-} 
\ No newline at end of file
+}
+
+int initialize_string_ops() {
+    return module_init_once(MODULE_STRING, module_init);
+}
\ No newline at end of file
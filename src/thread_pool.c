@@ -0,0 +1,527 @@
+/**
+ * @file thread_pool.c
+ * @brief 工作窃取线程池实现
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/thread_pool.h"
+#include "../include/module.h"
+#include "../include/utils.h"
+
+typedef struct {
+    task_fn fn;
+    void* arg;
+    wait_group* wg;
+} pool_task;
+
+/* 每个工作线程一个双端队列：自己从尾部取，其他线程从头部窃取 */
+typedef struct {
+    pthread_mutex_t lock;
+    pool_task* items;
+    size_t head;
+    size_t tail;
+    size_t capacity;
+    char padding[64];
+} task_deque;
+
+struct thread_pool {
+    int num_threads;
+    pthread_t* threads;
+    task_deque* deques;      /* num_threads个工作队列，最后一个为外部线程提交用的注入队列 */
+    atomic_long queued;      /* 已入队但尚未被取走的任务数 */
+    atomic_int sleepers;
+    atomic_int stopping;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    thread_pool_options options;
+};
+
+struct task_future {
+    wait_group wg;
+    thread_pool* pool;
+    future_fn fn;
+    void* arg;
+    void* result;
+};
+
+typedef struct {
+    thread_pool* pool;
+    int index;
+} worker_start;
+
+static __thread thread_pool* current_pool = NULL;
+static __thread int current_index = -1;
+
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+static thread_pool* default_pool = NULL;
+static atomic_int default_shutdown = 0;
+
+/* ---------- 双端队列 ---------- */
+
+static int deque_push(task_deque* dq, pool_task task) {
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail == dq->capacity) {
+        if (dq->head > 0) {
+            memmove(dq->items, dq->items + dq->head, (dq->tail - dq->head) * sizeof(pool_task));
+            dq->tail -= dq->head;
+            dq->head = 0;
+        } else {
+            size_t new_capacity = dq->capacity ? dq->capacity * 2 : 64;
+            pool_task* items = (pool_task*)realloc(dq->items, new_capacity * sizeof(pool_task));
+            if (items == NULL) {
+                pthread_mutex_unlock(&dq->lock);
+                return 0;
+            }
+            dq->items = items;
+            dq->capacity = new_capacity;
+        }
+    }
+    dq->items[dq->tail++] = task;
+    pthread_mutex_unlock(&dq->lock);
+    return 1;
+}
+
+static int deque_take(task_deque* dq, pool_task* task, int from_bottom, int blocking) {
+    if (blocking) {
+        pthread_mutex_lock(&dq->lock);
+    } else if (pthread_mutex_trylock(&dq->lock) != 0) {
+        return 0;
+    }
+    int found = 0;
+    if (dq->tail > dq->head) {
+        *task = from_bottom ? dq->items[--dq->tail] : dq->items[dq->head++];
+        found = 1;
+        if (dq->tail == dq->head) {
+            dq->head = dq->tail = 0;
+        }
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return found;
+}
+
+/* 依次尝试：自己的队列尾部、注入队列、窃取其他工作线程的队列头部 */
+static int take_task(thread_pool* pool, int index, pool_task* task) {
+    if (atomic_load_explicit(&pool->queued, memory_order_relaxed) <= 0) {
+        return 0;
+    }
+    int found = 0;
+    if (index >= 0 && deque_take(&pool->deques[index], task, 1, 1)) {
+        found = 1;
+    } else if (deque_take(&pool->deques[pool->num_threads], task, 0, 1)) {
+        found = 1;
+    } else {
+        int start = index >= 0 ? index + 1 : 0;
+        for (int i = 0; i < pool->num_threads && !found; i++) {
+            int victim = (start + i) % pool->num_threads;
+            if (victim != index && deque_take(&pool->deques[victim], task, 0, 0)) {
+                found = 1;
+            }
+        }
+    }
+    if (found) {
+        atomic_fetch_sub(&pool->queued, 1);
+    }
+    return found;
+}
+
+static void run_task(pool_task* task) {
+    task->fn(task->arg);
+    if (task->wg != NULL) {
+        wait_group_done(task->wg);
+    }
+}
+
+/* ---------- 工作线程 ---------- */
+
+static void pin_worker(thread_pool* pool, int index) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return;
+    }
+    int available = CPU_COUNT(&allowed);
+    if (available <= 0) {
+        return;
+    }
+    int target = (pool->options.cpu_offset + index) % available;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            return;
+        }
+    }
+}
+
+static void* worker_main(void* arg) {
+    worker_start* start = (worker_start*)arg;
+    thread_pool* pool = start->pool;
+    int index = start->index;
+    free(start);
+
+    current_pool = pool;
+    current_index = index;
+    if (pool->options.pin_threads) {
+        pin_worker(pool, index);
+    }
+
+    for (;;) {
+        pool_task task;
+        if (take_task(pool, index, &task)) {
+            run_task(&task);
+            continue;
+        }
+        if (atomic_load(&pool->stopping) && atomic_load(&pool->queued) <= 0) {
+            break;
+        }
+
+        // 先登记为休眠者再检查队列，与submit中的先入队再检查休眠者配对，避免丢失唤醒
+        pthread_mutex_lock(&pool->idle_lock);
+        atomic_fetch_add(&pool->sleepers, 1);
+        while (atomic_load(&pool->queued) <= 0 && !atomic_load(&pool->stopping)) {
+            pthread_cond_wait(&pool->idle_cond, &pool->idle_lock);
+        }
+        atomic_fetch_sub(&pool->sleepers, 1);
+        pthread_mutex_unlock(&pool->idle_lock);
+    }
+    return NULL;
+}
+
+/* ---------- 线程池 ---------- */
+
+thread_pool* thread_pool_create(const thread_pool_options* options) {
+    debug_print("创建线程池");
+    thread_pool* pool = (thread_pool*)calloc(1, sizeof(thread_pool));
+    if (pool == NULL) {
+        error_log(ERR_POOL_ALLOC, "内存分配失败");
+        return NULL;
+    }
+    if (options != NULL) {
+        pool->options = *options;
+    }
+    pool->num_threads = pool->options.num_threads;
+    if (pool->num_threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        pool->num_threads = online > 0 ? (int)online : 1;
+    }
+
+    pool->threads = (pthread_t*)calloc((size_t)pool->num_threads, sizeof(pthread_t));
+    pool->deques = (task_deque*)calloc((size_t)pool->num_threads + 1, sizeof(task_deque));
+    if (pool->threads == NULL || pool->deques == NULL) {
+        error_log(ERR_POOL_ALLOC, "内存分配失败");
+        free(pool->threads);
+        free(pool->deques);
+        free(pool);
+        return NULL;
+    }
+    for (int i = 0; i <= pool->num_threads; i++) {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+    }
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->sleepers, 0);
+    atomic_init(&pool->stopping, 0);
+    pthread_mutex_init(&pool->idle_lock, NULL);
+    pthread_cond_init(&pool->idle_cond, NULL);
+
+    int started = 0;
+    for (int i = 0; i < pool->num_threads; i++) {
+        worker_start* start = (worker_start*)malloc(sizeof(worker_start));
+        if (start == NULL) {
+            break;
+        }
+        start->pool = pool;
+        start->index = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_main, start) != 0) {
+            free(start);
+            break;
+        }
+        started++;
+    }
+    if (started < pool->num_threads) {
+        error_log(ERR_POOL_THREAD_CREATE, "创建工作线程失败");
+        pool->num_threads = started;
+        if (started == 0) {
+            thread_pool_destroy(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void thread_pool_destroy(thread_pool* pool) {
+    if (pool == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&pool->idle_lock);
+    atomic_store(&pool->stopping, 1);
+    pthread_cond_broadcast(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    // 没有工作线程时，剩余任务在当前线程执行完
+    pool_task task;
+    while (take_task(pool, -1, &task)) {
+        run_task(&task);
+    }
+
+    for (int i = 0; i < pool->num_threads + 1; i++) {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].items);
+    }
+    pthread_mutex_destroy(&pool->idle_lock);
+    pthread_cond_destroy(&pool->idle_cond);
+    free(pool->deques);
+    free(pool->threads);
+    free(pool);
+}
+
+static void create_default_pool(void) {
+    if (!atomic_load(&default_shutdown)) {
+        default_pool = thread_pool_create(NULL);
+    }
+}
+
+thread_pool* thread_pool_default() {
+    pthread_once(&default_once, create_default_pool);
+    return atomic_load(&default_shutdown) ? NULL : default_pool;
+}
+
+void thread_pool_shutdown_default() {
+    if (!atomic_exchange(&default_shutdown, 1)) {
+        // 先标记关闭：从未使用过默认线程池时pthread_once不会再创建它
+        pthread_once(&default_once, create_default_pool);
+        if (default_pool != NULL) {
+            thread_pool_destroy(default_pool);
+            default_pool = NULL;
+        }
+    }
+}
+
+static thread_pool* resolve_pool(thread_pool* pool) {
+    return pool != NULL ? pool : thread_pool_default();
+}
+
+int thread_pool_size(thread_pool* pool) {
+    pool = resolve_pool(pool);
+    return pool != NULL ? pool->num_threads : 1;
+}
+
+int thread_pool_submit(thread_pool* pool, task_fn fn, void* arg, wait_group* wg) {
+    pool = resolve_pool(pool);
+    if (pool == NULL || fn == NULL) {
+        error_log(ERR_POOL_INVALID_ARGUMENT, "线程池或任务函数为NULL");
+        return 0;
+    }
+
+    pool_task task = {fn, arg, wg};
+    if (wg != NULL) {
+        wait_group_add(wg, 1);
+    }
+    int index = current_pool == pool ? current_index : pool->num_threads;
+    if (!deque_push(&pool->deques[index], task)) {
+        error_log(ERR_POOL_ALLOC, "内存分配失败");
+        if (wg != NULL) {
+            wait_group_done(wg);
+        }
+        return 0;
+    }
+
+    atomic_fetch_add(&pool->queued, 1);
+    if (atomic_load(&pool->sleepers) > 0) {
+        pthread_mutex_lock(&pool->idle_lock);
+        pthread_cond_signal(&pool->idle_cond);
+        pthread_mutex_unlock(&pool->idle_lock);
+    }
+    return 1;
+}
+
+void thread_pool_wait(thread_pool* pool, wait_group* wg) {
+    pool = resolve_pool(pool);
+    int index = current_pool == pool ? current_index : -1;
+
+    while (atomic_load(&wg->count) > 0) {
+        pool_task task;
+        if (pool != NULL && take_task(pool, index, &task)) {
+            run_task(&task);
+            continue;
+        }
+
+        pthread_mutex_lock(&wg->lock);
+        if (atomic_load(&wg->count) > 0) {
+            if (index < 0) {
+                pthread_cond_wait(&wg->cond, &wg->lock);
+            } else {
+                // 工作线程不能无限期阻塞，否则所有线程都在等待时没人执行新任务
+                struct timespec deadline;
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                deadline.tv_nsec += 200000;
+                if (deadline.tv_nsec >= 1000000000L) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000L;
+                }
+                pthread_cond_timedwait(&wg->cond, &wg->lock, &deadline);
+            }
+        }
+        pthread_mutex_unlock(&wg->lock);
+    }
+}
+
+/* ---------- parallel_for ---------- */
+
+typedef struct {
+    atomic_long next;
+    long end;
+    long grain;
+    range_fn fn;
+    void* ctx;
+} parallel_range;
+
+static void parallel_range_task(void* arg) {
+    parallel_range* range = (parallel_range*)arg;
+    for (;;) {
+        long begin = atomic_fetch_add(&range->next, range->grain);
+        if (begin >= range->end) {
+            break;
+        }
+        long end = range->end - begin > range->grain ? begin + range->grain : range->end;
+        range->fn(begin, end, range->ctx);
+    }
+}
+
+int parallel_for(thread_pool* pool, long begin, long end, long grain, range_fn fn, void* ctx) {
+    if (fn == NULL) {
+        error_log(ERR_POOL_INVALID_ARGUMENT, "区间处理函数为NULL");
+        return 0;
+    }
+    if (end <= begin) {
+        return 1;
+    }
+
+    pool = resolve_pool(pool);
+    long n = end - begin;
+    int threads = pool != NULL ? pool->num_threads : 1;
+    if (grain <= 0) {
+        grain = n / ((long)threads * 8);
+        if (grain < 1) {
+            grain = 1;
+        }
+    }
+
+    parallel_range range;
+    atomic_init(&range.next, begin);
+    range.end = end;
+    range.grain = grain;
+    range.fn = fn;
+    range.ctx = ctx;
+
+    long chunks = (n + grain - 1) / grain;
+    long helpers = chunks - 1 < threads ? chunks - 1 : threads;
+    if (current_pool == pool && helpers > 0) {
+        helpers--; // 调用者本身就是工作线程之一
+    }
+
+    wait_group wg;
+    wait_group_init(&wg);
+    int ok = 1;
+    for (long i = 0; i < helpers && pool != NULL; i++) {
+        if (!thread_pool_submit(pool, parallel_range_task, &range, &wg)) {
+            ok = 0;
+            break;
+        }
+    }
+    parallel_range_task(&range);
+    thread_pool_wait(pool, &wg);
+    wait_group_destroy(&wg);
+    return ok || atomic_load(&range.next) >= end;
+}
+
+/* ---------- future ---------- */
+
+static void future_task(void* arg) {
+    task_future* future = (task_future*)arg;
+    future->result = future->fn(future->arg);
+}
+
+task_future* thread_pool_async(thread_pool* pool, future_fn fn, void* arg) {
+    if (fn == NULL) {
+        error_log(ERR_POOL_INVALID_ARGUMENT, "任务函数为NULL");
+        return NULL;
+    }
+    task_future* future = (task_future*)malloc(sizeof(task_future));
+    if (future == NULL) {
+        error_log(ERR_POOL_ALLOC, "内存分配失败");
+        return NULL;
+    }
+    wait_group_init(&future->wg);
+    future->pool = resolve_pool(pool);
+    future->fn = fn;
+    future->arg = arg;
+    future->result = NULL;
+
+    if (future->pool == NULL || !thread_pool_submit(future->pool, future_task, future, &future->wg)) {
+        future_task(future); // 线程池不可用时同步执行
+    }
+    return future;
+}
+
+void* task_future_get(task_future* future) {
+    if (future == NULL) {
+        return NULL;
+    }
+    thread_pool_wait(future->pool, &future->wg);
+    void* result = future->result;
+    wait_group_destroy(&future->wg);
+    free(future);
+    return result;
+}
+
+/* ---------- 等待组 ---------- */
+
+void wait_group_init(wait_group* wg) {
+    atomic_init(&wg->count, 0);
+    pthread_mutex_init(&wg->lock, NULL);
+    pthread_cond_init(&wg->cond, NULL);
+}
+
+void wait_group_add(wait_group* wg, long n) {
+    atomic_fetch_add(&wg->count, n);
+}
+
+void wait_group_done(wait_group* wg) {
+    // 计数归零的通知必须在持锁时发出，否则等待者返回并销毁wg后这里仍可能访问它
+    pthread_mutex_lock(&wg->lock);
+    if (atomic_fetch_sub(&wg->count, 1) == 1) {
+        pthread_cond_broadcast(&wg->cond);
+    }
+    pthread_mutex_unlock(&wg->lock);
+}
+
+void wait_group_destroy(wait_group* wg) {
+    // 等待最后一个wait_group_done释放锁
+    pthread_mutex_lock(&wg->lock);
+    pthread_mutex_unlock(&wg->lock);
+    pthread_mutex_destroy(&wg->lock);
+    pthread_cond_destroy(&wg->cond);
+}
+
+/* ---------- 初始化 ---------- */
+
+static int module_init(void) {
+    // 默认线程池在第一次并行计算时才创建，不使用线程池的命令不必创建工作线程
+    debug_print("线程池初始化成功");
+    return 1;
+}
+
+int initialize_thread_pool() {
+    return module_init_once(MODULE_THREAD_POOL, module_init);
+}
\ No newline at end of file
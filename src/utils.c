@@ -6,50 +6,122 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include "../include/utils.h"
+#include "../include/module.h"
+#include "../include/metrics.h"
 #include "../include/string_ops.h"
+#include "../include/allocator.h"
 
-static int is_initialized = 0;
+#define TIMESTAMP_SIZE 26
+
+/* 每个线程独立的状态，热路径上不需要任何全局锁 */
+static __thread error_code last_error_code = ERR_OK;
+static __thread const char* last_error_message = "";
+static __thread time_t cached_second = (time_t)-1;
+static __thread char cached_timestamp[TIMESTAMP_SIZE];
+
+static atomic_int log_flags = LOG_DEBUG | LOG_ERROR;
+
+/* 同一秒内重复使用已格式化的时间戳，避免每条日志都调用localtime_r */
+static const char* thread_timestamp(void) {
+    time_t now = time(NULL);
+    if (now != cached_second) {
+        struct tm tm_now;
+        localtime_r(&now, &tm_now);
+        strftime(cached_timestamp, sizeof(cached_timestamp), "%Y-%m-%d %H:%M:%S", &tm_now);
+        cached_second = now;
+    }
+    return cached_timestamp;
+}
 
 void debug_print(const char* message) {
-    char* timestamp = get_timestamp();
-    printf("[DEBUG] %s: %s\n", timestamp, message);
-    free(timestamp);
+    if (!(atomic_load_explicit(&log_flags, memory_order_relaxed) & LOG_DEBUG)) {
+        return;
+    }
+    // 单次printf调用输出整行，多线程输出不会交错
+    printf("[DEBUG] %s: %s\n", thread_timestamp(), message);
+}
+
+void error_log(error_code code, const char* message) {
+    error_log_detail(code, message, NULL);
+}
+
+void error_log_detail(error_code code, const char* message, const char* detail) {
+    metrics_count_error(code);
+    last_error_code = code;
+    last_error_message = message != NULL ? message : "";
+    // 只有真正输出时才格式化，探测不存在的文件等高频错误路径不产生格式化开销
+    if (atomic_load_explicit(&log_flags, memory_order_relaxed) & LOG_ERROR) {
+        if (detail != NULL) {
+            fprintf(stderr, "[ERROR] %s: [%d] %s: %s\n", thread_timestamp(), code, last_error_message, detail);
+        } else {
+            fprintf(stderr, "[ERROR] %s: [%d] %s\n", thread_timestamp(), code, last_error_message);
+        }
+    }
+}
+
+error_code error_raise(error_code code, const char* message) {
+    error_log_detail(code, message, NULL);
+    return code;
+}
+
+error_code get_last_error() {
+    return last_error_code;
 }
 
-void error_log(int error_code, const char* message) {
-    char* timestamp = get_timestamp();
-    fprintf(stderr, "[ERROR] %s: [%d] %s\n", timestamp, error_code, message);
-    free(timestamp);
+const char* get_last_error_message() {
+    return last_error_message;
+}
+
+void clear_last_error() {
+    last_error_code = ERR_OK;
+    last_error_message = "";
+}
+
+const char* error_code_name(error_code code) {
+#define ERROR_CODE_NAME_CASE(name, value) case name: return #name;
+    switch (code) {
+    case ERR_OK: return "ERR_OK";
+    ERROR_CODE_LIST(ERROR_CODE_NAME_CASE)
+    }
+#undef ERROR_CODE_NAME_CASE
+    return "ERR_UNKNOWN";
+}
+
+void set_log_flags(int flags) {
+    atomic_store(&log_flags, flags);
+}
+
+int get_log_flags() {
+    return atomic_load(&log_flags);
 }
 
 char* get_timestamp() {
-    time_t now = time(NULL);
-    char* timestamp = (char*)malloc(26);
+    char* timestamp = (char*)mem_alloc(TIMESTAMP_SIZE);
     if (timestamp == NULL) {
         fprintf(stderr, "内存分配失败\n");
         return NULL;
     }
     
-    strftime(timestamp, 26, "%Y-%m-%d %H:%M:%S", localtime(&now));
+    memcpy(timestamp, thread_timestamp(), TIMESTAMP_SIZE);
     return timestamp;
 }
 
 void cleanup_resources(void* resource) {
     if (resource != NULL) {
-        free(resource);
+        mem_free(resource);
         debug_print("资源已释放");
     }
 }
 
-int initialize_utils() {
-    if (is_initialized) {
-        debug_print("工具库已经初始化");
-        return 1;
-    }
-    
+static int module_init(void) {
     srand((unsigned int)time(NULL));
     debug_print("工具库初始化成功");
-    is_initialized = 1;
     return 1;
-} 
+}
+
+int initialize_utils() {
+    return module_init_once(MODULE_UTILS, module_init);
+}
\ No newline at end of file